@@ -0,0 +1,61 @@
+"""Measures the time until N fresh workers are ready on a single node, with
+workers started from scratch and with workers forked from a zygote."""
+import json
+import os
+import time
+
+import ray
+
+if "SMOKE_TEST" in os.environ:
+    NUM_WORKERS = 16
+else:
+    NUM_WORKERS = 256
+
+# Time for the zygote to finish its own startup before we start measuring.
+ZYGOTE_WARMUP_S = 5
+
+
+@ray.remote(num_cpus=0)
+class Worker:
+    def ready(self):
+        return os.getpid()
+
+
+def time_to_ready_workers(zygote_enabled: bool) -> float:
+    ray.init(
+        _system_config={
+            "worker_zygote_enabled": zygote_enabled,
+            "num_workers_soft_limit": 0,
+        }
+    )
+    # Start one worker first so that the zygote (if enabled) comes up.
+    warmup = Worker.remote()
+    ray.get(warmup.ready.remote())
+    ray.kill(warmup)
+    time.sleep(ZYGOTE_WARMUP_S)
+
+    start = time.perf_counter()
+    workers = [Worker.remote() for _ in range(NUM_WORKERS)]
+    pids = ray.get([w.ready.remote() for w in workers])
+    elapsed = time.perf_counter() - start
+    assert len(set(pids)) == NUM_WORKERS, pids
+    ray.shutdown()
+    return elapsed
+
+
+exec_time = time_to_ready_workers(zygote_enabled=False)
+zygote_time = time_to_ready_workers(zygote_enabled=True)
+
+print(f"Time to {NUM_WORKERS} ready workers (exec): {exec_time}s")
+print(f"Time to {NUM_WORKERS} ready workers (zygote): {zygote_time}s")
+print(f"Speedup: {exec_time / zygote_time}x")
+
+if "TEST_OUTPUT_JSON" in os.environ:
+    out_file = open(os.environ["TEST_OUTPUT_JSON"], "w")
+    results = {
+        "num_workers": NUM_WORKERS,
+        "exec_time": exec_time,
+        "zygote_time": zygote_time,
+        "success": "1",
+    }
+    json.dump(results, out_file)
@@ -0,0 +1,92 @@
+"""Zygote mode for Python worker processes.
+
+A zygote is a worker process that has finished interpreter startup and imports
+but never connects to the raylet. Instead, it listens on a unix socket and forks
+a new worker for every request it gets from the raylet, so that new workers
+skip the startup cost. See `src/ray/raylet/worker_zygote.h` for the protocol.
+"""
+import json
+import logging
+import os
+import signal
+import socket
+
+logger = logging.getLogger(__name__)
+
+# How often the zygote checks whether the raylet is still alive.
+RAYLET_CHECK_INTERVAL_S = 1
+
+
+def _raylet_alive(raylet_pid: int) -> bool:
+    try:
+        os.kill(raylet_pid, 0)
+    except ProcessLookupError:
+        return False
+    except PermissionError:
+        pass
+    return True
+
+
+def _read_request(conn: socket.socket) -> dict:
+    data = b""
+    while not data.endswith(b"\n"):
+        chunk = conn.recv(65536)
+        if not chunk:
+            raise ConnectionError("Raylet closed the connection mid-request.")
+        data += chunk
+    return json.loads(data)
+
+
+def serve(socket_path: str, parser):
+    """Serve fork requests from the raylet until it exits.
+
+    This only returns in forked children, with the command line arguments of the
+    new worker parsed by `parser`. The zygote itself exits once the raylet is gone.
+    """
+    # Forked workers are reaped by the kernel, like the ones the raylet starts.
+    signal.signal(signal.SIGCHLD, signal.SIG_IGN)
+    raylet_pid = int(os.environ.get("RAY_RAYLET_PID", os.getppid()))
+
+    if os.path.exists(socket_path):
+        os.unlink(socket_path)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    server.bind(socket_path)
+    server.listen(128)
+    server.settimeout(RAYLET_CHECK_INTERVAL_S)
+    logger.info(f"Worker zygote {os.getpid()} is listening on {socket_path}.")
+
+    while True:
+        try:
+            conn, _ = server.accept()
+        except socket.timeout:
+            if not _raylet_alive(raylet_pid):
+                server.close()
+                os.unlink(socket_path)
+                os._exit(0)
+            continue
+
+        try:
+            conn.settimeout(None)
+            request = _read_request(conn)
+        except (ConnectionError, ValueError) as e:
+            logger.warning(f"Dropping malformed fork request: {e}")
+            conn.close()
+            continue
+
+        pid = os.fork()
+        if pid == 0:
+            # Child: become the worker described by the request.
+            server.close()
+            conn.close()
+            signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+            os.environ.update(request["env"])
+            args, _ = parser.parse_known_args(request["args"])
+            args.zygote_socket = None
+            return args
+
+        try:
+            conn.sendall(f"{pid}\n".encode())
+        except OSError as e:
+            logger.warning(f"Failed to reply to fork request for worker {pid}: {e}")
+        finally:
+            conn.close()
@@ -735,6 +735,59 @@ def test_scheduling_class_depth(ray_start_regular):
     wait_for_condition(make_condition(4))
 
 
+@pytest.mark.parametrize("region_size", [0, 2])
+def test_resource_dissemination_regions(ray_start_cluster, region_size):
+    cluster = ray_start_cluster
+    cluster.add_node(
+        num_cpus=1,
+        _system_config={"resource_dissemination_region_size": region_size},
+    )
+    ray.init(address=cluster.address)
+    num_nodes = 4
+    nodes = [
+        cluster.add_node(num_cpus=1, resources={f"node_{i}": 1})
+        for i in range(num_nodes)
+    ]
+    cluster.wait_for_nodes()
+
+    @ray.remote(num_cpus=0)
+    class Actor:
+        def ping(self):
+            pass
+
+    def wait_for_available(expected):
+        start = time.time()
+        wait_for_condition(
+            lambda: all(
+                ray.available_resources().get(f"node_{i}", 0) == expected[i]
+                for i in expected
+            )
+        )
+        return time.time() - start
+
+    # The actors are scheduled by the local raylet, which only knows the resources
+    # of the other nodes from resource broadcasts.
+    actors = [
+        Actor.options(resources={f"node_{i}": 1}).remote() for i in range(num_nodes)
+    ]
+    ray.get([actor.ping.remote() for actor in actors])
+    elapsed = wait_for_available({i: 0 for i in range(num_nodes)})
+    logger.info(f"Resources converged in {elapsed}s with region size {region_size}")
+
+    # Nodes join regions in order, so the second worker node aggregates the region of
+    # the third one. The resources of the third one are still pulled and broadcast
+    # once the second one leaves.
+    cluster.remove_node(nodes[1])
+    ray.kill(actors[2])
+    elapsed = wait_for_available({2: 1, 3: 0})
+    logger.info(
+        f"Resources converged in {elapsed}s with region size {region_size} after "
+        "an aggregator left"
+    )
+    actor = Actor.options(resources={"node_2": 1}).remote()
+    ray.get(actor.ping.remote())
+
+
 if __name__ == "__main__":
     import pytest
 
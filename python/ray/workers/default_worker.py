@@ -139,6 +139,14 @@ parser.add_argument(
     action="store_true",
     help="True if Ray debugger is made available externally.",
 )
+parser.add_argument(
+    "--zygote-socket",
+    required=False,
+    type=str,
+    default=None,
+    help="If set, run as a zygote that forks new workers on request from the "
+    "raylet through this unix socket instead of connecting as a worker.",
+)
 
 if __name__ == "__main__":
     # NOTE(sang): For some reason, if we move the code below
@@ -148,6 +156,12 @@ if __name__ == "__main__":
     args = parser.parse_args()
     ray._private.ray_logging.setup_logger(args.logging_level, args.logging_format)
 
+    if args.zygote_socket:
+        from ray._private import worker_zygote
+
+        # Only returns in forked workers, with their own arguments.
+        args = worker_zygote.serve(args.zygote_socket, parser)
+
     if args.worker_type == "WORKER":
         mode = ray.WORKER_MODE
     elif args.worker_type == "SPILL_WORKER":
@@ -40,6 +40,10 @@ class MockActorInfoAccessor : public ActorInfoAccessor {
               (const TaskSpecification &task_spec, const StatusCallback &callback,
                int64_t timeout_ms),
               (override));
+  MOCK_METHOD(Status, AsyncRegisterActors,
+              (const std::vector<TaskSpecification> &task_specs,
+               std::vector<StatusCallback> callbacks),
+              (override));
   MOCK_METHOD(Status, SyncRegisterActor, (const TaskSpecification &task_spec),
               (override));
   MOCK_METHOD(Status, AsyncKillActor,
@@ -50,6 +54,10 @@ class MockActorInfoAccessor : public ActorInfoAccessor {
               (const TaskSpecification &task_spec,
                const rpc::ClientCallback<rpc::CreateActorReply> &callback),
               (override));
+  MOCK_METHOD(Status, AsyncCreateActors,
+              (const std::vector<TaskSpecification> &task_specs,
+               std::vector<rpc::ClientCallback<rpc::CreateActorReply>> callbacks),
+              (override));
   MOCK_METHOD(Status, AsyncSubscribe,
               (const ActorID &actor_id,
                (const SubscribeCallback<ActorID, rpc::ActorTableData> &subscribe),
@@ -270,6 +278,22 @@ class MockInternalKVAccessor : public InternalKVAccessor {
               (const std::string &ns, const std::string &key, bool del_by_prefix,
                const StatusCallback &callback),
               (override));
+  MOCK_METHOD(Status, AsyncInternalKVMultiGet,
+              (const std::string &ns, const std::vector<std::string> &keys,
+               (const OptionalItemCallback<absl::flat_hash_map<std::string, std::string>>
+                    &callback)),
+              (override));
+  MOCK_METHOD(Status, AsyncInternalKVMultiPut,
+              (const std::string &ns,
+               (const std::vector<std::pair<std::string, std::string>> &entries),
+               bool overwrite, const OptionalItemCallback<int> &callback),
+              (override));
+  MOCK_METHOD(Status, AsyncInternalKVWatch,
+              (const std::string &ns, const std::string &prefix, int64_t since_version,
+               (const std::function<void(Status, int64_t,
+                                         std::vector<rpc::InternalKVChange> &&)>
+                    &callback)),
+              (override));
 };
 
 }  // namespace gcs
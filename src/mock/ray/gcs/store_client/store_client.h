@@ -26,6 +26,9 @@ class MockStoreClient : public StoreClient {
                const std::string &index_key, const std::string &data,
                const StatusCallback &callback),
               (override));
+  MOCK_METHOD(Status, AsyncBatchPut,
+              (const std::vector<BatchPutEntry> &entries, const StatusCallback &callback),
+              (override));
   MOCK_METHOD(Status, AsyncGet,
               (const std::string &table_name, const std::string &key,
                const OptionalItemCallback<std::string> &callback),
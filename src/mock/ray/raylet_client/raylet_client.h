@@ -35,6 +35,11 @@ class MockWorkerLeaseInterface : public WorkerLeaseInterface {
        const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
        const int64_t backlog_size, const bool is_selected_based_on_locality),
       (override));
+  MOCK_METHOD(
+      void, RequestWorkerLeases,
+      (const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+       std::vector<ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply>> callbacks),
+      (override));
   MOCK_METHOD(ray::Status, ReturnWorker,
               (int worker_port, const WorkerID &worker_id, bool disconnect_worker,
                bool worker_exiting),
@@ -98,7 +103,8 @@ class MockResourceTrackingInterface : public ResourceTrackingInterface {
                const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback),
               (override));
   MOCK_METHOD(void, RequestResourceReport,
-              (const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback),
+              (const rpc::RequestResourceReportRequest &request,
+               const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback),
               (override));
 };
 
@@ -121,6 +127,11 @@ class MockRayletClientInterface : public RayletClientInterface {
        const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
        const int64_t backlog_size, const bool is_selected_based_on_locality),
       (override));
+  MOCK_METHOD(
+      void, RequestWorkerLeases,
+      (const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+       std::vector<ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply>> callbacks),
+      (override));
 
   MOCK_METHOD(ray::Status, ReturnWorker,
               (int worker_port, const WorkerID &worker_id, bool disconnect_worker,
@@ -169,7 +180,8 @@ class MockRayletClientInterface : public RayletClientInterface {
                const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback),
               (override));
   MOCK_METHOD(void, RequestResourceReport,
-              (const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback),
+              (const rpc::RequestResourceReportRequest &request,
+               const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback),
               (override));
   MOCK_METHOD(void, ShutdownRaylet,
               (const NodeID &node_id, bool graceful,
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <functional>
 #include <memory>
 
@@ -171,4 +172,98 @@ class SharedMemoryBuffer : public Buffer {
   std::shared_ptr<Buffer> parent_;
 };
 
+/// Represents a byte buffer that is stored in the allocation of the object it's handed
+/// out with, see `CopyToInlineBuffers`.
+class InlineBuffer : public Buffer {
+ public:
+  InlineBuffer(uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  uint8_t *Data() const override { return data_; }
+
+  size_t Size() const override { return size_; }
+
+  bool OwnsData() const override { return true; }
+
+  bool IsPlasmaBuffer() const override { return false; }
+
+ private:
+  InlineBuffer &operator=(const InlineBuffer &) = delete;
+  InlineBuffer(const InlineBuffer &) = delete;
+
+  /// Pointer to the data.
+  uint8_t *data_;
+  /// Size of the buffer.
+  size_t size_;
+};
+
+/// The total size of two buffers up to which `CopyToInlineBuffers` copies them.
+constexpr size_t kMaxInlineBuffersSize = 256;
+
+namespace internal {
+
+/// The allocation that `CopyToInlineBuffers` copies two buffers into. The copies are
+/// handed out as shared pointers that share its ownership.
+template <size_t kCapacity>
+struct InlineBufferPair {
+  InlineBufferPair(size_t first_size, size_t second_size)
+      : first(bytes, first_size), second(bytes + first_size, second_size) {}
+
+  InlineBuffer first;
+  InlineBuffer second;
+  alignas(BUFFER_ALIGNMENT) uint8_t bytes[kCapacity];
+};
+
+template <size_t kCapacity>
+void CopyToInlineBufferPair(const Buffer *first, const Buffer *second,
+                            std::shared_ptr<Buffer> *first_copy,
+                            std::shared_ptr<Buffer> *second_copy) {
+  size_t first_size = first != nullptr ? first->Size() : 0;
+  size_t second_size = second != nullptr ? second->Size() : 0;
+  auto pair = std::make_shared<InlineBufferPair<kCapacity>>(first_size, second_size);
+  if (first != nullptr) {
+    if (first_size > 0) {
+      std::memcpy(pair->first.Data(), first->Data(), first_size);
+    }
+    *first_copy = std::shared_ptr<Buffer>(pair, &pair->first);
+  }
+  if (second != nullptr) {
+    if (second_size > 0) {
+      std::memcpy(pair->second.Data(), second->Data(), second_size);
+    }
+    *second_copy = std::shared_ptr<Buffer>(pair, &pair->second);
+  }
+}
+
+}  // namespace internal
+
+/// Copy two small buffers, such as the data and metadata of an object, into one
+/// allocation instead of two buffers and two copies of their bytes. Each copy is an
+/// `InlineBuffer` that keeps the allocation alive. The copy of the first buffer starts
+/// at an aligned address, like the data of a LocalMemoryBuffer.
+///
+/// \param first The first buffer to copy, or null to only copy the second.
+/// \param second The second buffer to copy, or null to only copy the first.
+/// \param[out] first_copy Set to the copy of the first buffer, if it's not null.
+/// \param[out] second_copy Set to the copy of the second buffer, if it's not null.
+/// \return Whether the buffers were copied. False if their total size is over
+/// `kMaxInlineBuffersSize`, and nothing is copied then.
+inline bool CopyToInlineBuffers(const Buffer *first, const Buffer *second,
+                                std::shared_ptr<Buffer> *first_copy,
+                                std::shared_ptr<Buffer> *second_copy) {
+  size_t size = (first != nullptr ? first->Size() : 0) +
+                (second != nullptr ? second->Size() : 0);
+  if (size > kMaxInlineBuffersSize) {
+    return false;
+  }
+  // Most inlined values are a few bytes, so they get a smaller allocation.
+  if (size <= BUFFER_ALIGNMENT) {
+    internal::CopyToInlineBufferPair<BUFFER_ALIGNMENT>(first, second, first_copy,
+                                                       second_copy);
+  } else {
+    internal::CopyToInlineBufferPair<kMaxInlineBuffersSize>(first, second, first_copy,
+                                                            second_copy);
+  }
+  return true;
+}
+
 }  // namespace ray
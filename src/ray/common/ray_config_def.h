@@ -254,6 +254,15 @@ RAY_CONFIG(uint32_t, maximum_gcs_deletion_batch_size, 1000)
 /// Maximum number of items in one batch to scan/get/delete from GCS storage.
 RAY_CONFIG(uint32_t, maximum_gcs_storage_operation_batch_size, 1000)
 
+/// The window in microseconds over which the GCS groups the writes to Redis into one
+/// batch. The callback of a write is only called once its batch is written. 0 means
+/// that every write is sent on its own.
+RAY_CONFIG(int64_t, gcs_storage_group_commit_window_us, 0)
+
+/// The maximum number of writes of a group commit of the GCS storage. A batch is
+/// written as soon as it has this many writes, without waiting for the window to end.
+RAY_CONFIG(uint32_t, gcs_storage_group_commit_max_entries, 1000)
+
 /// Maximum number of rows in GCS profile table.
 RAY_CONFIG(int32_t, maximum_profile_table_rows_count, 10 * 1000)
 
@@ -264,6 +273,18 @@ RAY_CONFIG(uint32_t, object_store_get_max_ids_to_print_in_warning, 20)
 RAY_CONFIG(uint32_t, gcs_server_rpc_server_thread_num, 1)
 /// Number of threads used by rpc server in gcs server.
 RAY_CONFIG(uint32_t, gcs_server_rpc_client_thread_num, 1)
+/// Whether the gcs server handles the internal KV requests on a thread of their own,
+/// instead of on the main thread with the actor, node and placement group managers, so
+/// that KV traffic doesn't delay scheduling. The managers on the main thread then reach
+/// the KV by posting to its thread.
+RAY_CONFIG(bool, gcs_server_kv_dedicated_thread, false)
+/// The number of the most recent changes to the in-memory internal KV that are kept,
+/// so that a watcher that polls again gets the changes it missed in between. Only the
+/// keys that changed are kept, and their current values are sent to the watcher.
+RAY_CONFIG(uint64_t, gcs_kv_watch_history_size, 10000)
+/// The time after which a watch of the internal KV returns without changes, so that the
+/// watcher polls again.
+RAY_CONFIG(int64_t, gcs_kv_watch_timeout_ms, 30000)
 /// Allow up to 5 seconds for connecting to gcs service.
 /// Note: this only takes effect when gcs service is enabled.
 RAY_CONFIG(int64_t, gcs_service_connect_retries, 50)
@@ -274,12 +295,22 @@ RAY_CONFIG(int64_t, internal_gcs_service_connect_wait_milliseconds, 100)
 RAY_CONFIG(uint64_t, gcs_redis_heartbeat_interval_milliseconds, 100)
 /// Duration to wait between retries for leasing worker in gcs server.
 RAY_CONFIG(uint32_t, gcs_lease_worker_retry_interval_ms, 200)
+/// The maximum number of actor workers that gcs server leases from a raylet with a
+/// single request when creating many actors at once.
+RAY_CONFIG(uint64_t, gcs_actor_lease_batch_size, 100)
 /// Duration to wait between retries for creating actor in gcs server.
 RAY_CONFIG(uint32_t, gcs_create_actor_retry_interval_ms, 200)
 /// Exponential backoff params for gcs to retry creating a placement group
 RAY_CONFIG(uint64_t, gcs_create_placement_group_retry_min_interval_ms, 100)
 RAY_CONFIG(uint64_t, gcs_create_placement_group_retry_max_interval_ms, 1000)
 RAY_CONFIG(double, gcs_create_placement_group_retry_multiplier, 1.5);
+
+/// The number of times GCS reschedules and prepares again only the bundles of a
+/// placement group that failed to prepare, while the other bundles stay prepared,
+/// before rescheduling the whole placement group. 0 means that the whole placement
+/// group is rescheduled as soon as a bundle fails to prepare.
+RAY_CONFIG(uint32_t, gcs_placement_group_prepare_retry_rounds, 0)
+
 /// Maximum number of destroyed actors in GCS server memory cache.
 RAY_CONFIG(uint32_t, maximum_gcs_destroyed_actor_cached_count, 100000)
 /// Maximum number of dead nodes in GCS server memory cache.
@@ -288,10 +319,20 @@ RAY_CONFIG(uint32_t, maximum_gcs_dead_node_cached_count, 1000)
 RAY_CONFIG(int, gcs_resource_report_poll_period_ms, 100)
 // The number of concurrent polls to polls to GCS.
 RAY_CONFIG(uint64_t, gcs_max_concurrent_resource_pulls, 100)
+// The number of pulls from a raylet after which GCS asks for a full resource report
+// instead of the changes since the last one it applied. 0 means always pull full
+// reports.
+RAY_CONFIG(uint64_t, gcs_resource_report_full_pull_interval, 50)
 // Feature flag to enable grpc based pubsub in GCS.
 RAY_CONFIG(bool, gcs_grpc_based_pubsub, true)
-// The storage backend to use for the GCS. It can be either 'redis' or 'memory'.
+// The storage backend to use for the GCS. It can be 'redis', 'memory' or 'file'.
 RAY_CONFIG(std::string, gcs_storage, "memory")
+// The directory that the GCS persists its tables to, when `gcs_storage` is 'file'.
+RAY_CONFIG(std::string, gcs_storage_file_dir, "")
+// The size in bytes that the log of the 'file' GCS storage grows to before a snapshot of
+// the tables is written and the log is started again. 0 means that snapshots are only
+// written on demand.
+RAY_CONFIG(uint64_t, gcs_file_storage_snapshot_threshold_bytes, 64 * 1024 * 1024)
 // Feature flag to enable GCS based bootstrapping.
 RAY_CONFIG(bool, bootstrap_with_gcs, true)
 
@@ -340,6 +381,44 @@ RAY_CONFIG(int64_t, task_rpc_inlined_bytes_limit, 10 * 1024 * 1024)
 /// Maximum number of pending lease requests per scheduling category
 RAY_CONFIG(uint64_t, max_pending_lease_requests_per_scheduling_category, 10)
 
+/// Maximum number of normal tasks that are pushed to a leased worker before the
+/// earlier ones finish. The worker queues the tasks and runs them one at a time, so
+/// a value over 1 hides the round trip between tasks, which pays off for tasks that
+/// are short compared to it. A new lease is only requested once the pipelines to all
+/// the leased workers of a scheduling class are full.
+RAY_CONFIG(uint32_t, max_tasks_in_flight_per_worker, 1)
+
+/// Maximum number of worker leases that a scheduling class requests for the tasks
+/// whose dependencies are still being created, so that the lease round trip overlaps
+/// with the wait instead of following it. The dependencies are inlined once they are
+/// created, and the task is then pushed to a worker leased ahead of time. At most as
+/// many idle workers as there are waiting tasks, up to this limit, are kept for them,
+/// and each only until its lease expires. A task whose arguments stay in plasma can't
+/// use these leases. 0 disables this.
+RAY_CONFIG(uint32_t, max_speculative_leases_per_scheduling_category, 0)
+
+/// Maximum number of tasks that are pushed to a worker in one PushTasks RPC, when
+/// more than one task to the worker is ready to be sent at once. Every task is still
+/// replied to on its own as soon as it finishes. 1 disables batching.
+RAY_CONFIG(uint32_t, max_push_task_batch_size, 1)
+
+/// The time that a batch of requests, such as a PushTasks RPC, is kept waiting for its
+/// caller to poll for the rest of its replies. The batch is dropped after that, since
+/// its caller is likely dead, and the replies to its remaining requests are discarded.
+RAY_CONFIG(int64_t, batched_request_unpolled_timeout_ms, 60000)
+
+/// Maximum number of task spec templates a worker registers with each worker it pushes
+/// tasks to. A template holds the fields that are the same for many tasks, such as the
+/// function descriptor, resources and runtime env, so that the tasks pushed after it is
+/// registered only carry its ID. The least recently used template is evicted to make
+/// room for another one. 0, the default, disables templates.
+RAY_CONFIG(uint32_t, max_task_spec_templates_per_worker, 0)
+
+/// How long a worker keeps the task spec templates of a worker that pushes no tasks to
+/// it, such as one that died. Workers send their templates again after half of that,
+/// in case they were dropped.
+RAY_CONFIG(int64_t, task_spec_template_idle_timeout_ms, 600000)
+
 /// Interval to restart dashboard agent after the process exit.
 RAY_CONFIG(uint32_t, agent_restart_interval_ms, 1000)
 
@@ -377,6 +456,39 @@ RAY_CONFIG(int64_t, idle_worker_killing_time_threshold_ms, 1000)
 /// -1 means using num_cpus instead.
 RAY_CONFIG(int64_t, num_workers_soft_limit, -1)
 
+/// Whether to fork new Python workers from a pre-initialized zygote process (one per
+/// runtime env) instead of starting every worker process from scratch.
+RAY_CONFIG(bool, worker_zygote_enabled, false)
+
+/// The timeout for a zygote to reply to a fork request. If it doesn't reply in time,
+/// the worker process is started from scratch instead.
+RAY_CONFIG(int64_t, worker_zygote_fork_timeout_ms, 1000)
+
+/// Whether to keep a warm pool of idle workers sized to the forecasted demand of each
+/// scheduling class and runtime env, instead of only prestarting workers for the
+/// backlog of the current lease request.
+RAY_CONFIG(bool, enable_adaptive_worker_prestart, false)
+
+/// The length of the window over which worker demand is aggregated before it's folded
+/// into the moving average that the warm pool is sized to.
+RAY_CONFIG(uint64_t, adaptive_worker_prestart_window_ms, 10000)
+
+/// The weight of the latest window in the exponentially weighted moving average of
+/// worker demand. Lower values remember periodic load for longer.
+RAY_CONFIG(double, adaptive_worker_prestart_ewma_alpha, 0.3)
+
+/// The maximum number of workers kept warm for forecasted demand, across all scheduling
+/// classes. Warm workers aren't killed when idle, even above the soft limit of the
+/// number of workers.
+/// -1 means no limit other than the forecast itself.
+RAY_CONFIG(int64_t, adaptive_worker_prestart_max_warm_workers, -1)
+
+/// How long to wait before creating the runtime env of a warm worker again after it
+/// failed to be created. The backoff doubles with every consecutive failure, up to
+/// `adaptive_worker_prestart_max_runtime_env_backoff_ms`.
+RAY_CONFIG(uint64_t, adaptive_worker_prestart_runtime_env_backoff_ms, 1000)
+RAY_CONFIG(uint64_t, adaptive_worker_prestart_max_runtime_env_backoff_ms, 60000)
+
 // The interval where metrics are exported in milliseconds.
 RAY_CONFIG(uint64_t, metrics_report_interval_ms, 10000)
 
@@ -470,6 +582,11 @@ RAY_CONFIG(uint64_t, gcs_actor_table_min_duration_ms, /*  5 min */ 60 * 1000 * 5
 /// Whether to enable GCS-based actor scheduling.
 RAY_CONFIG(bool, gcs_actor_scheduling_enabled, false);
 
+/// Whether GCS places the bundles of placement groups with the bin-packing engine,
+/// which keeps the free resources of the cluster on fewer nodes, rather than by
+/// scoring the nodes for every bundle.
+RAY_CONFIG(bool, gcs_placement_group_bin_packing, false)
+
 RAY_CONFIG(uint32_t, max_error_msg_size_bytes, 512 * 1024)
 
 /// If enabled, raylet will report resources only when resources are changed.
@@ -497,6 +614,22 @@ RAY_CONFIG(std::string, custom_unit_instance_resources, "")
 // Maximum size of the batches when broadcasting resources to raylet.
 RAY_CONFIG(uint64_t, resource_broadcast_batch_size, 512);
 
+// The number of resource broadcasts to a raylet after which it is sent a snapshot of
+// the resources of every node instead of the changes since the version it
+// acknowledged. 0 means always broadcast snapshots.
+RAY_CONFIG(uint64_t, resource_broadcast_snapshot_interval, 50);
+
+// If set, raylets are grouped into regions of up to this many nodes, and GCS only
+// exchanges resources with one aggregator raylet per region, which pulls the resource
+// reports of its region and forwards resource broadcasts to it. 0 means GCS exchanges
+// resources with every raylet.
+RAY_CONFIG(uint64_t, resource_dissemination_region_size, 0);
+
+// The time an aggregator raylet waits for the members of its region to reply to a
+// resource broadcast or report pull. The members that haven't replied by then are
+// treated as failed, and GCS follows up with them.
+RAY_CONFIG(int64_t, resource_dissemination_member_timeout_ms, 1000);
+
 // If enabled and worker stated in container, the container will add
 // resource limit.
 RAY_CONFIG(bool, worker_resource_limits_enabled, false)
@@ -539,6 +672,11 @@ RAY_CONFIG(std::string, event_level, "warning")
 /// Whether to avoid scheduling cpu requests on gpu nodes
 RAY_CONFIG(bool, scheduler_avoid_gpu_nodes, true)
 
+/// Queues of at least this many tasks of the same scheduling class are placed on the
+/// cluster in one batch, instead of making one scheduling decision per task. 0, the
+/// default, always schedules tasks one by one.
+RAY_CONFIG(uint64_t, scheduler_batch_scheduling_min_tasks, 0)
+
 /// Whether to skip running local GC in runtime env.
 RAY_CONFIG(bool, runtime_env_skip_local_gc, false)
 
@@ -137,14 +137,21 @@ class RayObject {
     if (has_data_copy_) {
       // If this object is required to hold a copy of the data,
       // make a copy if the passed in buffers don't already have a copy.
-      if (data_ && !data_->OwnsData()) {
-        data_ = std::make_shared<LocalMemoryBuffer>(data_->Data(), data_->Size(),
-                                                    /*copy_data=*/true);
-      }
-
-      if (metadata_ && !metadata_->OwnsData()) {
-        metadata_ = std::make_shared<LocalMemoryBuffer>(
-            metadata_->Data(), metadata_->Size(), /*copy_data=*/true);
+      const Buffer *data_to_copy = (data_ && !data_->OwnsData()) ? data_.get() : nullptr;
+      const Buffer *metadata_to_copy =
+          (metadata_ && !metadata_->OwnsData()) ? metadata_.get() : nullptr;
+      // Small values, which most task returns are, are copied into one allocation.
+      if ((data_to_copy || metadata_to_copy) &&
+          !CopyToInlineBuffers(data_to_copy, metadata_to_copy, &data_, &metadata_)) {
+        if (data_to_copy) {
+          data_ = std::make_shared<LocalMemoryBuffer>(data_->Data(), data_->Size(),
+                                                      /*copy_data=*/true);
+        }
+
+        if (metadata_to_copy) {
+          metadata_ = std::make_shared<LocalMemoryBuffer>(
+              metadata_->Data(), metadata_->Size(), /*copy_data=*/true);
+        }
       }
     }
 
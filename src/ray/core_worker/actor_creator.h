@@ -15,6 +15,8 @@
 #pragma once
 #include <memory>
 
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/ray_config.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
 
@@ -64,8 +66,12 @@ class ActorCreatorInterface {
 
 class DefaultActorCreator : public ActorCreatorInterface {
  public:
-  explicit DefaultActorCreator(std::shared_ptr<gcs::GcsClient> gcs_client)
-      : gcs_client_(std::move(gcs_client)) {}
+  /// \param gcs_client The GCS client to register and create the actors with.
+  /// \param io_service If set, the actors registered or created asynchronously before it
+  /// gets to run are sent to GCS together, with a single request.
+  explicit DefaultActorCreator(std::shared_ptr<gcs::GcsClient> gcs_client,
+                               instrumented_io_context *io_service = nullptr)
+      : gcs_client_(std::move(gcs_client)), io_service_(io_service) {}
 
   Status RegisterActor(const TaskSpecification &task_spec) const override {
     const auto status = gcs_client_->Actors().SyncRegisterActor(task_spec);
@@ -86,15 +92,25 @@ class DefaultActorCreator : public ActorCreatorInterface {
       if (callback != nullptr) {
         (*registering_actors_)[actor_id].emplace_back(std::move(callback));
       }
-      return gcs_client_->Actors().AsyncRegisterActor(
-          task_spec, [actor_id, this](Status status) {
-            std::vector<ray::gcs::StatusCallback> cbs;
-            cbs = std::move((*registering_actors_)[actor_id]);
-            registering_actors_->erase(actor_id);
-            for (auto &cb : cbs) {
-              cb(status);
-            }
-          });
+      auto on_registered = [actor_id, this](Status status) {
+        std::vector<ray::gcs::StatusCallback> cbs;
+        cbs = std::move((*registering_actors_)[actor_id]);
+        registering_actors_->erase(actor_id);
+        for (auto &cb : cbs) {
+          cb(status);
+        }
+      };
+      if (io_service_ == nullptr) {
+        return gcs_client_->Actors().AsyncRegisterActor(task_spec, on_registered);
+      }
+      absl::MutexLock lock(&mu_);
+      if (pending_registrations_.task_specs.empty()) {
+        io_service_->post([this]() { FlushRegistrations(); },
+                          "ActorCreator.FlushRegistrations");
+      }
+      pending_registrations_.task_specs.push_back(task_spec);
+      pending_registrations_.callbacks.push_back(std::move(on_registered));
+      return Status::OK();
     } else {
       callback(RegisterActor(task_spec));
       return Status::OK();
@@ -115,11 +131,64 @@ class DefaultActorCreator : public ActorCreatorInterface {
   Status AsyncCreateActor(
       const TaskSpecification &task_spec,
       const rpc::ClientCallback<rpc::CreateActorReply> &callback) override {
-    return gcs_client_->Actors().AsyncCreateActor(task_spec, callback);
+    if (io_service_ == nullptr) {
+      return gcs_client_->Actors().AsyncCreateActor(task_spec, callback);
+    }
+    absl::MutexLock lock(&mu_);
+    if (pending_creations_.task_specs.empty()) {
+      io_service_->post([this]() { FlushCreations(); }, "ActorCreator.FlushCreations");
+    }
+    pending_creations_.task_specs.push_back(task_spec);
+    pending_creations_.callbacks.push_back(callback);
+    return Status::OK();
   }
 
  private:
+  /// Actors waiting to be sent to GCS together.
+  template <typename Callback>
+  struct PendingActors {
+    std::vector<TaskSpecification> task_specs;
+    std::vector<Callback> callbacks;
+  };
+
+  /// Register the pending actors, with a single request if there are several.
+  void FlushRegistrations() LOCKS_EXCLUDED(mu_) {
+    PendingActors<gcs::StatusCallback> actors;
+    {
+      absl::MutexLock lock(&mu_);
+      std::swap(actors, pending_registrations_);
+    }
+    if (actors.task_specs.size() == 1) {
+      RAY_CHECK_OK(gcs_client_->Actors().AsyncRegisterActor(actors.task_specs[0],
+                                                            actors.callbacks[0]));
+    } else if (!actors.task_specs.empty()) {
+      RAY_CHECK_OK(gcs_client_->Actors().AsyncRegisterActors(
+          actors.task_specs, std::move(actors.callbacks)));
+    }
+  }
+
+  /// Create the pending actors, with a single request if there are several.
+  void FlushCreations() LOCKS_EXCLUDED(mu_) {
+    PendingActors<rpc::ClientCallback<rpc::CreateActorReply>> actors;
+    {
+      absl::MutexLock lock(&mu_);
+      std::swap(actors, pending_creations_);
+    }
+    if (actors.task_specs.size() == 1) {
+      RAY_CHECK_OK(gcs_client_->Actors().AsyncCreateActor(actors.task_specs[0],
+                                                          actors.callbacks[0]));
+    } else if (!actors.task_specs.empty()) {
+      RAY_CHECK_OK(gcs_client_->Actors().AsyncCreateActors(actors.task_specs,
+                                                           std::move(actors.callbacks)));
+    }
+  }
+
   std::shared_ptr<gcs::GcsClient> gcs_client_;
+  instrumented_io_context *io_service_;
+  absl::Mutex mu_;
+  PendingActors<gcs::StatusCallback> pending_registrations_ GUARDED_BY(mu_);
+  PendingActors<rpc::ClientCallback<rpc::CreateActorReply>> pending_creations_
+      GUARDED_BY(mu_);
   using RegisteringActorType =
       absl::flat_hash_map<ActorID, std::vector<ray::gcs::StatusCallback>>;
   ThreadPrivate<RegisteringActorType> registering_actors_;
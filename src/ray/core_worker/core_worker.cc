@@ -230,6 +230,11 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
         return std::shared_ptr<rpc::CoreWorkerClient>(
             new rpc::CoreWorkerClient(addr, *client_call_manager_));
       });
+  // Publish the borrowed objects that go out of scope in a burst in one message.
+  reference_counter_->SetRefsRemovedFlushScheduler([this]() {
+    io_service_.post([this]() { reference_counter_->FlushRefsRemoved(); },
+                     "CoreWorker.FlushRefsRemoved");
+  });
 
   if (options_.worker_type == WorkerType::WORKER) {
     periodical_runner_.RunFnPeriodically(
@@ -333,7 +338,7 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
         PushError(options_.job_id, "excess_queueing_warning", stream.str(), timestamp));
   };
 
-  actor_creator_ = std::make_shared<DefaultActorCreator>(gcs_client_);
+  actor_creator_ = std::make_shared<DefaultActorCreator>(gcs_client_, &io_service_);
 
   direct_actor_submitter_ = std::shared_ptr<CoreWorkerDirectActorTaskSubmitter>(
       new CoreWorkerDirectActorTaskSubmitter(*core_worker_client_pool_, *memory_store_,
@@ -364,7 +369,10 @@ CoreWorker::CoreWorker(const CoreWorkerOptions &options, const WorkerID &worker_
       GetWorkerType(), RayConfig::instance().worker_lease_timeout_milliseconds(),
       actor_creator_, worker_context_.GetCurrentJobID(),
       boost::asio::steady_timer(io_service_),
-      RayConfig::instance().max_pending_lease_requests_per_scheduling_category());
+      RayConfig::instance().max_pending_lease_requests_per_scheduling_category(),
+      RayConfig::instance().max_tasks_in_flight_per_worker(),
+      RayConfig::instance().max_speculative_leases_per_scheduling_category(),
+      boost::asio::steady_timer(io_service_));
   auto report_locality_data_callback =
       [this](const ObjectID &object_id, const absl::flat_hash_set<NodeID> &locations,
              uint64_t object_size) {
@@ -2420,6 +2428,17 @@ void CoreWorker::HandlePushTask(const rpc::PushTaskRequest &request,
     return;
   }
 
+  // Fill in the fields of the task spec that were left out for its template. The
+  // request is decoded in place, like the task spec is moved out of it later, so that
+  // its args aren't copied.
+  auto status =
+      task_spec_templates_.Decode(&const_cast<rpc::PushTaskRequest &>(request));
+  if (!status.ok()) {
+    RAY_LOG(ERROR) << status.ToString();
+    send_reply_callback(status, nullptr, nullptr);
+    return;
+  }
+
   // Increment the task_queue_length and per function counter.
   task_queue_length_ += 1;
   std::string func_name =
@@ -2456,6 +2475,24 @@ void CoreWorker::HandlePushTask(const rpc::PushTaskRequest &request,
   }
 }
 
+void CoreWorker::HandlePushTasks(const rpc::PushTasksRequest &request,
+                                 rpc::PushTasksReply *reply,
+                                 rpc::SendReplyCallback send_reply_callback) {
+  // The tasks of a batch are checked one by one, but a poll for the rest of a batch
+  // only carries the worker ID.
+  if (request.batch_id() != 0 &&
+      HandleWrongRecipient(WorkerID::FromBinary(request.intended_worker_id()),
+                           send_reply_callback)) {
+    return;
+  }
+  push_tasks_batches_.HandleBatch(
+      request, reply, std::move(send_reply_callback),
+      [this](const rpc::PushTaskRequest &request, rpc::PushTaskReply *reply,
+             rpc::SendReplyCallback send_reply_callback) {
+        HandlePushTask(request, reply, std::move(send_reply_callback));
+      });
+}
+
 void CoreWorker::HandleDirectActorCallArgWaitComplete(
     const rpc::DirectActorCallArgWaitCompleteRequest &request,
     rpc::DirectActorCallArgWaitCompleteReply *reply,
@@ -2633,6 +2670,9 @@ void CoreWorker::ProcessSubscribeMessage(const rpc::SubMessage &sub_message,
     ProcessSubscribeForObjectEviction(sub_message.worker_object_eviction_message());
   } else if (sub_message.has_worker_ref_removed_message()) {
     ProcessSubscribeForRefRemoved(sub_message.worker_ref_removed_message());
+  } else if (sub_message.has_worker_refs_removed_message()) {
+    reference_counter_->SetRefsRemovedCallback(key_id,
+                                               sub_message.worker_refs_removed_message());
   } else if (sub_message.has_worker_object_locations_message()) {
     ProcessSubscribeObjectLocations(sub_message.worker_object_locations_message());
   } else {
@@ -39,6 +39,7 @@
 #include "ray/pubsub/publisher.h"
 #include "ray/pubsub/subscriber.h"
 #include "ray/raylet_client/raylet_client.h"
+#include "ray/rpc/batched_request_handler.h"
 #include "ray/rpc/node_manager/node_manager_client.h"
 #include "ray/rpc/worker/core_worker_client.h"
 #include "ray/rpc/worker/core_worker_server.h"
@@ -649,6 +650,12 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   void HandlePushTask(const rpc::PushTaskRequest &request, rpc::PushTaskReply *reply,
                       rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Implements gRPC server handler. Every task of the batch is handled like it was
+  /// pushed on its own. The batch is replied to as soon as any of its tasks is, and the
+  /// caller then polls for the replies to the rest of the tasks.
+  void HandlePushTasks(const rpc::PushTasksRequest &request, rpc::PushTasksReply *reply,
+                       rpc::SendReplyCallback send_reply_callback) override;
+
   /// Implements gRPC server handler.
   void HandleDirectActorCallArgWaitComplete(
       const rpc::DirectActorCallArgWaitCompleteRequest &request,
@@ -1147,6 +1154,16 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   // Interface that receives tasks from direct actor calls.
   std::unique_ptr<CoreWorkerDirectTaskReceiver> direct_task_receiver_;
 
+  /// The task spec templates registered by the workers that push tasks to this one.
+  /// Only accessed on the io_service_ thread.
+  rpc::TaskSpecTemplateDecoder task_spec_templates_;
+
+  /// The PushTasks batches pushed to this worker whose tasks haven't all been sent
+  /// back yet.
+  rpc::BatchedRequestHandler<rpc::PushTaskRequest, rpc::PushTaskReply,
+                             rpc::PushTasksRequest, rpc::PushTasksReply>
+      push_tasks_batches_;
+
   /// Event loop where tasks are processed.
   /// task_execution_service_ should be destructed first to avoid
   /// issues like https://github.com/ray-project/ray/issues/18857
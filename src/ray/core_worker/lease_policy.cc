@@ -17,6 +17,27 @@
 namespace ray {
 namespace core {
 
+void LocalityDataIndex::Erase(const ObjectID &object_id) {
+  auto &shard = GetShard(object_id);
+  absl::MutexLock lock(&shard.mutex);
+  shard.objects.erase(object_id);
+}
+
+absl::optional<LocalityData> LocalityDataIndex::GetLocalityData(
+    const ObjectID &object_id) {
+  auto &shard = GetShard(object_id);
+  absl::MutexLock lock(&shard.mutex);
+  auto it = shard.objects.find(object_id);
+  if (it == shard.objects.end()) {
+    // Either we don't have any information about this object, or we don't know its
+    // size, so we can't return valid locality data.
+    RAY_LOG(DEBUG) << "Object " << object_id
+                   << " has no known size, locality data not available";
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
 std::pair<rpc::Address, bool> LocalityAwareLeasePolicy::GetBestNodeForTask(
     const TaskSpecification &spec) {
   if (spec.GetMessage().scheduling_strategy().scheduling_strategy_case() ==
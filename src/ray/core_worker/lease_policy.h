@@ -14,9 +14,12 @@
 
 #pragma once
 
+#include <array>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task_spec.h"
 #include "src/ray/protobuf/common.pb.h"
@@ -37,6 +40,53 @@ class LocalityDataProviderInterface {
   virtual ~LocalityDataProviderInterface() {}
 };
 
+/// An index of the locality data of the objects known to a worker, which its reference
+/// counter updates as the sizes and locations of the objects change. Lookups only lock
+/// the shard of the object, so the lease policy doesn't contend with the reference
+/// counter for every argument of every task it submits.
+/// This class is thread-safe.
+class LocalityDataIndex : public LocalityDataProviderInterface {
+ public:
+  /// Set the size and locations of an object. An object of unknown size has no
+  /// locality data.
+  ///
+  /// \param[in] object_id The object to update.
+  /// \param[in] object_size The size of the object, or -1 if unknown.
+  /// \param[in] node_ids The nodes that have the object local.
+  template <typename NodeIds>
+  void Update(const ObjectID &object_id, int64_t object_size, const NodeIds &node_ids) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mutex);
+    if (object_size < 0) {
+      shard.objects.erase(object_id);
+      return;
+    }
+    auto &locality_data = shard.objects[object_id];
+    locality_data.object_size = object_size;
+    locality_data.nodes_containing_object.clear();
+    locality_data.nodes_containing_object.insert(node_ids.begin(), node_ids.end());
+  }
+
+  /// Remove the locality data of an object that went out of scope.
+  void Erase(const ObjectID &object_id);
+
+  absl::optional<LocalityData> GetLocalityData(const ObjectID &object_id) override;
+
+ private:
+  static constexpr size_t kNumShards = 16;
+
+  struct Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<ObjectID, LocalityData> objects GUARDED_BY(mutex);
+  };
+
+  Shard &GetShard(const ObjectID &object_id) {
+    return shards_[object_id.Hash() % kNumShards];
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
 /// Interface for mocking the lease policy.
 class LeasePolicyInterface {
  public:
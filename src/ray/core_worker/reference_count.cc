@@ -14,15 +14,20 @@
 
 #include "ray/core_worker/reference_count.h"
 
-#define PRINT_REF_COUNT(it)                                                              \
-  RAY_LOG(DEBUG) << "REF " << it->first << " borrowers: " << it->second.borrowers.size() \
-                 << " local_ref_count: " << it->second.local_ref_count                   \
-                 << " submitted_count: " << it->second.submitted_task_ref_count          \
-                 << " contained_in_owned: " << it->second.contained_in_owned.size()      \
-                 << " contained_in_borrowed: "                                           \
-                 << (it)->second.contained_in_borrowed_ids.size()                        \
-                 << " contains: " << it->second.contains.size()                          \
-                 << " stored_in: " << it->second.stored_in_objects.size()                \
+#include <algorithm>
+#include <cstring>
+
+#define PRINT_REF_COUNT(it)                                                        \
+  RAY_LOG(DEBUG) << "REF " << it->first                                            \
+                 << " borrowers: " << it->second.rare().borrowers.size()           \
+                 << " local_ref_count: " << it->second.local_ref_count             \
+                 << " submitted_count: " << it->second.submitted_task_ref_count    \
+                 << " contained_in_owned: "                                        \
+                 << it->second.rare().contained_in_owned.size()                    \
+                 << " contained_in_borrowed: "                                     \
+                 << (it)->second.rare().contained_in_borrowed_ids.size()           \
+                 << " contains: " << it->second.rare().contains.size()             \
+                 << " stored_in: " << it->second.rare().stored_in_objects.size()   \
                  << " lineage_ref_count: " << it->second.lineage_ref_count;
 
 namespace {}  // namespace
@@ -30,13 +35,56 @@ namespace {}  // namespace
 namespace ray {
 namespace core {
 
+namespace {
+
+/// Encode the IDs of objects created by the same task as ranges of their indices.
+void ObjectIdsToProto(const std::vector<ObjectID> &object_ids,
+                      rpc::TaskObjectIds *proto) {
+  RAY_CHECK(!object_ids.empty());
+  const auto task_id = object_ids.front().TaskId();
+  proto->set_task_id(task_id.Binary());
+  std::vector<ObjectIDIndexType> indices;
+  indices.reserve(object_ids.size());
+  for (const auto &object_id : object_ids) {
+    RAY_DCHECK(object_id.TaskId() == task_id);
+    indices.push_back(object_id.ObjectIndex());
+  }
+  std::sort(indices.begin(), indices.end());
+  size_t start = 0;
+  for (size_t i = 1; i <= indices.size(); i++) {
+    if (i == indices.size() || indices[i] - indices[i - 1] > 1) {
+      proto->add_index_ranges(indices[start]);
+      proto->add_index_ranges(indices[i - 1]);
+      start = i;
+    }
+  }
+}
+
+std::vector<ObjectID> ObjectIdsFromProto(const rpc::TaskObjectIds &proto) {
+  std::vector<ObjectID> object_ids;
+  std::string binary = proto.task_id();
+  binary.resize(ObjectID::Size());
+  for (int i = 0; i + 1 < proto.index_ranges_size(); i += 2) {
+    for (uint64_t index = proto.index_ranges(i); index <= proto.index_ranges(i + 1);
+         index++) {
+      const auto object_index = static_cast<ObjectIDIndexType>(index);
+      std::memcpy(&binary[TaskID::Size()], &object_index, sizeof(object_index));
+      object_ids.push_back(ObjectID::FromBinary(binary));
+    }
+  }
+  return object_ids;
+}
+
+}  // namespace
+
 bool ReferenceCounter::OwnObjects() const {
   absl::MutexLock lock(&mutex_);
   return !object_id_refs_.empty();
 }
 
 bool ReferenceCounter::OwnedByUs(const ObjectID &object_id) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
+  absl::MutexLock shard_lock(&object_id_refs_.GetShard(object_id).mutex);
   auto it = object_id_refs_.find(object_id);
   if (it != object_id_refs_.end()) {
     return it->second.owned_by_us;
@@ -64,6 +112,28 @@ void ReferenceCounter::ShutdownIfNeeded() {
   }
 }
 
+std::shared_ptr<const rpc::Address> ReferenceCounter::InternOwnerAddress(
+    const rpc::Address &owner_address) {
+  absl::MutexLock owned_objects_lock(&owned_objects_mutex_);
+  auto &interned = owner_addresses_[rpc::WorkerAddress(owner_address)];
+  if (interned == nullptr) {
+    interned = std::make_shared<const rpc::Address>(owner_address);
+    if (owner_addresses_.size() >= owner_addresses_gc_threshold_) {
+      // Drop the addresses of the owners that no Reference refers to anymore.
+      for (auto it = owner_addresses_.begin(); it != owner_addresses_.end();) {
+        if (it->second.use_count() == 1 && it->second != interned) {
+          owner_addresses_.erase(it++);
+        } else {
+          it++;
+        }
+      }
+      owner_addresses_gc_threshold_ =
+          std::max(kMinOwnerAddressesGcThreshold, 2 * owner_addresses_.size());
+    }
+  }
+  return interned;
+}
+
 ReferenceCounter::ReferenceTable ReferenceCounter::ReferenceTableFromProto(
     const ReferenceTableProto &proto) {
   ReferenceTable refs;
@@ -102,7 +172,7 @@ bool ReferenceCounter::AddBorrowedObjectInternal(const ObjectID &object_id,
   }
 
   RAY_LOG(DEBUG) << "Adding borrowed object " << object_id;
-  it->second.owner_address = owner_address;
+  it->second.owner_address = InternOwnerAddress(owner_address);
   it->second.foreign_owner_already_monitoring |= foreign_owner_already_monitoring;
 
   if (!outer_id.IsNil()) {
@@ -110,8 +180,8 @@ bool ReferenceCounter::AddBorrowedObjectInternal(const ObjectID &object_id,
     if (outer_it != object_id_refs_.end() && !outer_it->second.owned_by_us) {
       RAY_LOG(DEBUG) << "Setting borrowed inner ID " << object_id
                      << " contained_in_borrowed: " << outer_id;
-      it->second.contained_in_borrowed_ids.insert(outer_id);
-      outer_it->second.contains.insert(object_id);
+      it->second.mutable_rare().contained_in_borrowed_ids.insert(outer_id);
+      outer_it->second.mutable_rare().contains.insert(object_id);
       // The inner object ref is in use. We must report our ref to the object's
       // owner.
       if (it->second.RefCount() > 0) {
@@ -148,7 +218,7 @@ void ReferenceCounter::AddObjectRefStats(
         ref_proto->set_call_site(it->second.second);
       }
     }
-    for (const auto &obj_id : ref.second.contained_in_owned) {
+    for (const auto &obj_id : ref.second.rare().contained_in_owned) {
       ref_proto->add_contained_in_owned(obj_id.Binary());
     }
 
@@ -178,32 +248,54 @@ void ReferenceCounter::AddOwnedObject(const ObjectID &object_id,
                                       bool add_local_ref,
                                       const absl::optional<NodeID> &pinned_at_raylet_id) {
   RAY_LOG(DEBUG) << "Adding owned object " << object_id;
+  if (inner_ids.empty()) {
+    // Only the object's own Reference is added, so it's added in its shard.
+    absl::ReaderMutexLock lock(&mutex_);
+    object_id_refs_.TryUpdate(object_id, [&](ReferenceTable &refs, const ObjectID &id) {
+      mutex_.AssertReaderHeld();
+      AddOwnedReference(refs, id, owner_address, call_site, object_size,
+                        is_reconstructable, add_local_ref, pinned_at_raylet_id);
+      return true;
+    });
+    return;
+  }
   absl::MutexLock lock(&mutex_);
-  RAY_CHECK(object_id_refs_.count(object_id) == 0)
+  AddOwnedReference(object_id_refs_.GetShard(object_id).refs, object_id, owner_address,
+                    call_site, object_size, is_reconstructable, add_local_ref,
+                    pinned_at_raylet_id);
+  // Mark that this object ID contains other inner IDs. Then, we will not GC
+  // the inner objects until the outer object ID goes out of scope.
+  AddNestedObjectIdsInternal(object_id, inner_ids, rpc_address_);
+}
+
+void ReferenceCounter::AddOwnedReference(
+    ReferenceTable &refs, const ObjectID &object_id, const rpc::Address &owner_address,
+    const std::string &call_site, const int64_t object_size, bool is_reconstructable,
+    bool add_local_ref, const absl::optional<NodeID> &pinned_at_raylet_id) {
+  RAY_CHECK(refs.count(object_id) == 0)
       << "Tried to create an owned object that already exists: " << object_id;
   // If the entry doesn't exist, we initialize the direct reference count to zero
   // because this corresponds to a submitted task whose return ObjectID will be created
   // in the frontend language, incrementing the reference count.
   // TODO(swang): Objects that are not reconstructable should not increment
   // their arguments' lineage ref counts.
-  auto it = object_id_refs_
-                .emplace(object_id, Reference(owner_address, call_site, object_size,
-                                              is_reconstructable, pinned_at_raylet_id))
+  auto it = refs.emplace(object_id,
+                         Reference(InternOwnerAddress(owner_address), call_site,
+                                   object_size, is_reconstructable, pinned_at_raylet_id))
                 .first;
-  if (!inner_ids.empty()) {
-    // Mark that this object ID contains other inner IDs. Then, we will not GC
-    // the inner objects until the outer object ID goes out of scope.
-    AddNestedObjectIdsInternal(object_id, inner_ids, rpc_address_);
-  }
+  UpdateLocalityIndex(it);
   if (pinned_at_raylet_id.has_value()) {
     // We eagerly add the pinned location to the set of object locations.
     AddObjectLocationInternal(it, pinned_at_raylet_id.value());
   }
 
-  reconstructable_owned_objects_.emplace_back(object_id);
-  auto back_it = reconstructable_owned_objects_.end();
-  back_it--;
-  RAY_CHECK(reconstructable_owned_objects_index_.emplace(object_id, back_it).second);
+  {
+    absl::MutexLock owned_objects_lock(&owned_objects_mutex_);
+    reconstructable_owned_objects_.emplace_back(object_id);
+    auto back_it = reconstructable_owned_objects_.end();
+    back_it--;
+    RAY_CHECK(reconstructable_owned_objects_index_.emplace(object_id, back_it).second);
+  }
 
   if (add_local_ref) {
     it->second.local_ref_count++;
@@ -215,6 +307,7 @@ void ReferenceCounter::UpdateObjectSize(const ObjectID &object_id, int64_t objec
   auto it = object_id_refs_.find(object_id);
   if (it != object_id_refs_.end()) {
     it->second.object_size = object_size;
+    UpdateLocalityIndex(it);
     PushToLocationSubscribers(it);
   }
 }
@@ -224,6 +317,16 @@ void ReferenceCounter::AddLocalReference(const ObjectID &object_id,
   if (object_id.IsNil()) {
     return;
   }
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    if (object_id_refs_.TryUpdate(
+            object_id, [this, &call_site](ReferenceTable &refs, const ObjectID &id) {
+              mutex_.AssertReaderHeld();
+              return TryAddLocalReference(refs, id, call_site);
+            })) {
+      return;
+    }
+  }
   absl::MutexLock lock(&mutex_);
   auto it = object_id_refs_.find(object_id);
   if (it == object_id_refs_.end()) {
@@ -239,9 +342,128 @@ void ReferenceCounter::AddLocalReference(const ObjectID &object_id,
   }
 }
 
+bool ReferenceCounter::TryAddLocalReference(ReferenceTable &refs,
+                                            const ObjectID &object_id,
+                                            const std::string &call_site) {
+  auto it = refs.find(object_id);
+  if (it == refs.end()) {
+    // NOTE: ownership info for these objects must be added later via AddBorrowedObject.
+    it = refs.emplace(object_id, Reference(call_site, -1)).first;
+  } else if (it->second.RefCount() == 0 &&
+             !it->second.rare().contained_in_borrowed_ids.empty()) {
+    // The objects that contain this one must be marked as having nested refs in use.
+    return false;
+  }
+  it->second.local_ref_count++;
+  RAY_LOG(DEBUG) << "Add local reference " << object_id;
+  PRINT_REF_COUNT(it);
+  return true;
+}
+
+bool ReferenceCounter::TryRemoveLocalReference(
+    ReferenceTable &refs, const ObjectID &object_id, std::vector<ObjectID> *deleted,
+    std::vector<ObjectID> *lineage_argument_ids) {
+  auto it = refs.find(object_id);
+  // The count is already 0, which is logged, or the reference can't be deleted here.
+  if (it == refs.end() || it->second.local_ref_count == 0 ||
+      (it->second.RefCount() == 1 && !CanDeleteInShard(it))) {
+    return false;
+  }
+  it->second.local_ref_count--;
+  RAY_LOG(DEBUG) << "Remove local reference " << object_id;
+  PRINT_REF_COUNT(it);
+  if (it->second.RefCount() == 0) {
+    DeleteReferenceInShard(refs, it, deleted, lineage_argument_ids);
+  }
+  return true;
+}
+
+bool ReferenceCounter::TryAddSubmittedTaskReference(ReferenceTable &refs,
+                                                    const ObjectID &object_id) {
+  auto it = refs.find(object_id);
+  if (it == refs.end()) {
+    // This happens if a large argument is transparently passed by reference
+    // because we don't hold a Python reference to its ObjectID.
+    it = refs.emplace(object_id, Reference()).first;
+  } else if (it->second.RefCount() == 0 &&
+             !it->second.rare().contained_in_borrowed_ids.empty()) {
+    return false;
+  }
+  RAY_LOG(DEBUG) << "Increment ref count for submitted task argument " << object_id;
+  it->second.submitted_task_ref_count++;
+  // The lineage ref will get released once the task finishes and cannot be
+  // retried again.
+  it->second.lineage_ref_count++;
+  return true;
+}
+
+bool ReferenceCounter::TryRemoveSubmittedTaskReference(
+    ReferenceTable &refs, const ObjectID &object_id, bool release_lineage,
+    std::vector<ObjectID> *deleted, std::vector<ObjectID> *lineage_argument_ids) {
+  auto it = refs.find(object_id);
+  if (it == refs.end() || it->second.submitted_task_ref_count == 0 ||
+      (it->second.RefCount() == 1 && !CanDeleteInShard(it))) {
+    return false;
+  }
+  RAY_LOG(DEBUG) << "Releasing ref for submitted task argument " << object_id;
+  it->second.submitted_task_ref_count--;
+  if (release_lineage && it->second.lineage_ref_count > 0) {
+    it->second.lineage_ref_count--;
+  }
+  if (it->second.RefCount() == 0) {
+    DeleteReferenceInShard(refs, it, deleted, lineage_argument_ids);
+  }
+  return true;
+}
+
+bool ReferenceCounter::CanDeleteInShard(ReferenceTable::iterator it) const {
+  // Deleting a Reference that other References point to, that has a callback to call
+  // once it's unused, or that was freed, or the last Reference before shutting down,
+  // touches more than the shard.
+  return it->second.rare_fields.ptr == nullptr &&
+         !it->second.has_nested_refs_to_report && shutdown_hook_ == nullptr &&
+         freed_objects_.count(it->first) == 0;
+}
+
+void ReferenceCounter::DeleteReferenceInShard(
+    ReferenceTable &refs, ReferenceTable::iterator it, std::vector<ObjectID> *deleted,
+    std::vector<ObjectID> *lineage_argument_ids) {
+  const ObjectID id = it->first;
+  RAY_LOG(DEBUG) << "Attempting to delete object " << id;
+  if (it->second.OutOfScope(lineage_pinning_enabled_)) {
+    ReleasePlasmaObject(it);
+    if (deleted) {
+      deleted->push_back(id);
+    }
+    EraseReconstructableOwnedObject(id);
+  }
+
+  if (it->second.ShouldDelete(lineage_pinning_enabled_)) {
+    RAY_LOG(DEBUG) << "Deleting Reference to object " << id;
+    // The lineage of the arguments is released by the caller, since their References
+    // may be in other shards.
+    if (on_lineage_released_ && it->second.owned_by_us) {
+      on_lineage_released_(id, lineage_argument_ids);
+    }
+    object_info_publisher_->PublishFailure(
+        rpc::ChannelType::WORKER_OBJECT_LOCATIONS_CHANNEL, id.Binary());
+    locality_index_.Erase(id);
+    refs.erase(it);
+  }
+}
+
+void ReferenceCounter::EraseReconstructableOwnedObject(const ObjectID &object_id) {
+  absl::MutexLock owned_objects_lock(&owned_objects_mutex_);
+  auto index_it = reconstructable_owned_objects_index_.find(object_id);
+  if (index_it != reconstructable_owned_objects_index_.end()) {
+    reconstructable_owned_objects_.erase(index_it->second);
+    reconstructable_owned_objects_index_.erase(index_it);
+  }
+}
+
 void ReferenceCounter::SetNestedRefInUseRecursive(ReferenceTable::iterator inner_ref_it) {
   for (const auto &contained_in_borrowed_id :
-       inner_ref_it->second.contained_in_borrowed_ids) {
+       inner_ref_it->second.rare().contained_in_borrowed_ids) {
     auto contained_in_it = object_id_refs_.find(contained_in_borrowed_id);
     RAY_CHECK(contained_in_it != object_id_refs_.end());
     if (!contained_in_it->second.has_nested_refs_to_report) {
@@ -269,7 +491,25 @@ void ReferenceCounter::RemoveLocalReference(const ObjectID &object_id,
   if (object_id.IsNil()) {
     return;
   }
+  std::vector<ObjectID> lineage_argument_ids;
+  bool removed;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    removed = object_id_refs_.TryUpdate(
+        object_id, [this, deleted, &lineage_argument_ids](ReferenceTable &refs,
+                                                          const ObjectID &id) {
+          mutex_.AssertReaderHeld();
+          return TryRemoveLocalReference(refs, id, deleted, &lineage_argument_ids);
+        });
+  }
+  if (removed && lineage_argument_ids.empty()) {
+    return;
+  }
   absl::MutexLock lock(&mutex_);
+  if (removed) {
+    ReleaseArgumentsLineage(lineage_argument_ids);
+    return;
+  }
   RemoveLocalReferenceInternal(object_id, deleted);
 }
 
@@ -302,11 +542,48 @@ void ReferenceCounter::UpdateSubmittedTaskReferences(
     const std::vector<ObjectID> return_ids,
     const std::vector<ObjectID> &argument_ids_to_add,
     const std::vector<ObjectID> &argument_ids_to_remove, std::vector<ObjectID> *deleted) {
-  absl::MutexLock lock(&mutex_);
-  for (const auto &return_id : return_ids) {
-    UpdateObjectPendingCreation(return_id, true);
+  // Update what we can shard by shard, and the rest while holding the whole table.
+  std::vector<ObjectID> remaining_ids_to_add;
+  std::vector<ObjectID> remaining_ids_to_remove;
+  std::vector<ObjectID> lineage_argument_ids;
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    std::vector<ObjectID> not_updated;
+    object_id_refs_.TryUpdateEach(
+        return_ids,
+        [this](ReferenceTable &refs, const ObjectID &id) {
+          mutex_.AssertReaderHeld();
+          return UpdateObjectPendingCreation(refs, id, true);
+        },
+        &not_updated);
+    RAY_CHECK(not_updated.empty());
+    object_id_refs_.TryUpdateEach(
+        argument_ids_to_add,
+        [this](ReferenceTable &refs, const ObjectID &id) {
+          mutex_.AssertReaderHeld();
+          return TryAddSubmittedTaskReference(refs, id);
+        },
+        &remaining_ids_to_add);
+    // Release the submitted task ref and the lineage ref for any argument IDs
+    // whose values were inlined.
+    object_id_refs_.TryUpdateEach(
+        argument_ids_to_remove,
+        [this, deleted, &lineage_argument_ids](ReferenceTable &refs,
+                                               const ObjectID &id) {
+          mutex_.AssertReaderHeld();
+          return TryRemoveSubmittedTaskReference(refs, id, /*release_lineage=*/true,
+                                                 deleted, &lineage_argument_ids);
+        },
+        &remaining_ids_to_remove);
+    if (remaining_ids_to_add.empty() && remaining_ids_to_remove.empty() &&
+        lineage_argument_ids.empty()) {
+      return;
+    }
   }
-  for (const ObjectID &argument_id : argument_ids_to_add) {
+
+  absl::MutexLock lock(&mutex_);
+  ReleaseArgumentsLineage(lineage_argument_ids);
+  for (const ObjectID &argument_id : remaining_ids_to_add) {
     RAY_LOG(DEBUG) << "Increment ref count for submitted task argument " << argument_id;
     auto it = object_id_refs_.find(argument_id);
     if (it == object_id_refs_.end()) {
@@ -323,9 +600,7 @@ void ReferenceCounter::UpdateSubmittedTaskReferences(
       SetNestedRefInUseRecursive(it);
     }
   }
-  // Release the submitted task ref and the lineage ref for any argument IDs
-  // whose values were inlined.
-  RemoveSubmittedTaskReferences(argument_ids_to_remove, /*release_lineage=*/true,
+  RemoveSubmittedTaskReferences(remaining_ids_to_remove, /*release_lineage=*/true,
                                 deleted);
 }
 
@@ -333,7 +608,8 @@ void ReferenceCounter::UpdateResubmittedTaskReferences(
     const std::vector<ObjectID> return_ids, const std::vector<ObjectID> &argument_ids) {
   absl::MutexLock lock(&mutex_);
   for (const auto &return_id : return_ids) {
-    UpdateObjectPendingCreation(return_id, true);
+    UpdateObjectPendingCreation(object_id_refs_.GetShard(return_id).refs, return_id,
+                                true);
   }
   for (const ObjectID &argument_id : argument_ids) {
     auto it = object_id_refs_.find(argument_id);
@@ -350,9 +626,45 @@ void ReferenceCounter::UpdateFinishedTaskReferences(
     const std::vector<ObjectID> return_ids, const std::vector<ObjectID> &argument_ids,
     bool release_lineage, const rpc::Address &worker_addr,
     const ReferenceTableProto &borrowed_refs, std::vector<ObjectID> *deleted) {
+  if (borrowed_refs.empty()) {
+    // There are no borrowers to merge, so update what we can shard by shard, and the
+    // rest while holding the whole table.
+    std::vector<ObjectID> remaining_ids;
+    std::vector<ObjectID> lineage_argument_ids;
+    {
+      absl::ReaderMutexLock lock(&mutex_);
+      std::vector<ObjectID> not_updated;
+      object_id_refs_.TryUpdateEach(
+          return_ids,
+          [this](ReferenceTable &refs, const ObjectID &id) {
+            mutex_.AssertReaderHeld();
+            return UpdateObjectPendingCreation(refs, id, false);
+          },
+          &not_updated);
+      RAY_CHECK(not_updated.empty());
+      object_id_refs_.TryUpdateEach(
+          argument_ids,
+          [this, release_lineage, deleted, &lineage_argument_ids](ReferenceTable &refs,
+                                                                  const ObjectID &id) {
+            mutex_.AssertReaderHeld();
+            return TryRemoveSubmittedTaskReference(refs, id, release_lineage, deleted,
+                                                   &lineage_argument_ids);
+          },
+          &remaining_ids);
+      if (remaining_ids.empty() && lineage_argument_ids.empty()) {
+        return;
+      }
+    }
+    absl::MutexLock lock(&mutex_);
+    ReleaseArgumentsLineage(lineage_argument_ids);
+    RemoveSubmittedTaskReferences(remaining_ids, release_lineage, deleted);
+    return;
+  }
+
   absl::MutexLock lock(&mutex_);
   for (const auto &return_id : return_ids) {
-    UpdateObjectPendingCreation(return_id, false);
+    UpdateObjectPendingCreation(object_id_refs_.GetShard(return_id).refs, return_id,
+                                false);
   }
   // Must merge the borrower refs before decrementing any ref counts. This is
   // to make sure that for serialized IDs, we increment the borrower count for
@@ -365,6 +677,7 @@ void ReferenceCounter::UpdateFinishedTaskReferences(
   for (const ObjectID &argument_id : argument_ids) {
     MergeRemoteBorrowers(argument_id, worker_addr, refs);
   }
+  FlushRefRemovedWaits();
 
   RemoveSubmittedTaskReferences(argument_ids, release_lineage, deleted);
 }
@@ -384,7 +697,12 @@ int64_t ReferenceCounter::ReleaseLineageReferences(ReferenceTable::iterator ref)
       ref->second.is_reconstructable = false;
     }
   }
+  return lineage_bytes_evicted + ReleaseArgumentsLineage(argument_ids);
+}
 
+int64_t ReferenceCounter::ReleaseArgumentsLineage(
+    const std::vector<ObjectID> &argument_ids) {
+  int64_t lineage_bytes_evicted = 0;
   for (const ObjectID &argument_id : argument_ids) {
     auto arg_it = object_id_refs_.find(argument_id);
     if (arg_it == object_id_refs_.end()) {
@@ -400,7 +718,7 @@ int64_t ReferenceCounter::ReleaseLineageReferences(ReferenceTable::iterator ref)
     if (arg_it->second.ShouldDelete(lineage_pinning_enabled_)) {
       // We only decremented the lineage ref count, so the argument value
       // should already be released.
-      RAY_CHECK(arg_it->second.on_ref_removed == nullptr);
+      RAY_CHECK(arg_it->second.rare().on_ref_removed == nullptr);
       lineage_bytes_evicted += ReleaseLineageReferences(arg_it);
       EraseReference(arg_it);
     }
@@ -434,7 +752,8 @@ void ReferenceCounter::RemoveSubmittedTaskReferences(
 
 bool ReferenceCounter::GetOwner(const ObjectID &object_id,
                                 rpc::Address *owner_address) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
+  absl::MutexLock shard_lock(&object_id_refs_.GetShard(object_id).mutex);
   return GetOwnerInternal(object_id, owner_address);
 }
 
@@ -455,11 +774,15 @@ bool ReferenceCounter::GetOwnerInternal(const ObjectID &object_id,
 
 std::vector<rpc::Address> ReferenceCounter::GetOwnerAddresses(
     const std::vector<ObjectID> object_ids) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
   std::vector<rpc::Address> owner_addresses;
   for (const auto &object_id : object_ids) {
     rpc::Address owner_addr;
-    bool has_owner = GetOwnerInternal(object_id, &owner_addr);
+    bool has_owner;
+    {
+      absl::MutexLock shard_lock(&object_id_refs_.GetShard(object_id).mutex);
+      has_owner = GetOwnerInternal(object_id, &owner_addr);
+    }
     if (!has_owner) {
       RAY_LOG(WARNING)
           << " Object IDs generated randomly (ObjectID.from_random()) or out-of-band "
@@ -479,7 +802,7 @@ std::vector<rpc::Address> ReferenceCounter::GetOwnerAddresses(
 }
 
 bool ReferenceCounter::IsPlasmaObjectFreed(const ObjectID &object_id) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
   return freed_objects_.find(object_id) != freed_objects_.end();
 }
 
@@ -511,16 +834,16 @@ void ReferenceCounter::DeleteReferenceInternal(ReferenceTable::iterator it,
                                                std::vector<ObjectID> *deleted) {
   const ObjectID id = it->first;
   RAY_LOG(DEBUG) << "Attempting to delete object " << id;
-  if (it->second.RefCount() == 0 && it->second.on_ref_removed) {
+  if (it->second.RefCount() == 0 && it->second.rare().on_ref_removed) {
     RAY_LOG(DEBUG) << "Calling on_ref_removed for object " << id;
-    it->second.on_ref_removed(id);
-    it->second.on_ref_removed = nullptr;
+    it->second.rare().on_ref_removed(id);
+    it->second.mutable_rare().on_ref_removed = nullptr;
   }
   PRINT_REF_COUNT(it);
 
   // Whether it is safe to unpin the value.
   if (it->second.OutOfScope(lineage_pinning_enabled_)) {
-    for (const auto &inner_id : it->second.contains) {
+    for (const auto &inner_id : it->second.rare().contains) {
       auto inner_it = object_id_refs_.find(inner_id);
       if (inner_it != object_id_refs_.end()) {
         RAY_LOG(DEBUG) << "Try to delete inner object " << inner_id;
@@ -528,9 +851,9 @@ void ReferenceCounter::DeleteReferenceInternal(ReferenceTable::iterator it,
           // If this object ID was nested in an owned object, make sure that
           // the outer object counted towards the ref count for the inner
           // object.
-          RAY_CHECK(inner_it->second.contained_in_owned.erase(id));
+          RAY_CHECK(inner_it->second.mutable_rare().contained_in_owned.erase(id));
         } else {
-          RAY_CHECK(inner_it->second.contained_in_borrowed_ids.erase(id));
+          RAY_CHECK(inner_it->second.mutable_rare().contained_in_borrowed_ids.erase(id));
         }
         DeleteReferenceInternal(inner_it, deleted);
       }
@@ -540,12 +863,7 @@ void ReferenceCounter::DeleteReferenceInternal(ReferenceTable::iterator it,
     if (deleted) {
       deleted->push_back(id);
     }
-
-    auto index_it = reconstructable_owned_objects_index_.find(id);
-    if (index_it != reconstructable_owned_objects_index_.end()) {
-      reconstructable_owned_objects_.erase(index_it->second);
-      reconstructable_owned_objects_index_.erase(index_it);
-    }
+    EraseReconstructableOwnedObject(id);
   }
 
   if (it->second.ShouldDelete(lineage_pinning_enabled_)) {
@@ -563,12 +881,9 @@ void ReferenceCounter::EraseReference(ReferenceTable::iterator it) {
       rpc::ChannelType::WORKER_OBJECT_LOCATIONS_CHANNEL, it->first.Binary());
 
   RAY_CHECK(it->second.ShouldDelete(lineage_pinning_enabled_));
-  auto index_it = reconstructable_owned_objects_index_.find(it->first);
-  if (index_it != reconstructable_owned_objects_index_.end()) {
-    reconstructable_owned_objects_.erase(index_it->second);
-    reconstructable_owned_objects_index_.erase(index_it);
-  }
+  EraseReconstructableOwnedObject(it->first);
   freed_objects_.erase(it->first);
+  locality_index_.Erase(it->first);
   object_id_refs_.erase(it);
   ShutdownIfNeeded();
 }
@@ -576,11 +891,19 @@ void ReferenceCounter::EraseReference(ReferenceTable::iterator it) {
 int64_t ReferenceCounter::EvictLineage(int64_t min_bytes_to_evict) {
   absl::MutexLock lock(&mutex_);
   int64_t lineage_bytes_evicted = 0;
-  while (!reconstructable_owned_objects_.empty() &&
-         lineage_bytes_evicted < min_bytes_to_evict) {
-    ObjectID object_id = std::move(reconstructable_owned_objects_.front());
-    reconstructable_owned_objects_.pop_front();
-    reconstructable_owned_objects_index_.erase(object_id);
+  while (lineage_bytes_evicted < min_bytes_to_evict) {
+    ObjectID object_id;
+    {
+      // Releasing the lineage may erase the References of other objects from the
+      // queue, so it's only locked to pop the next object.
+      absl::MutexLock owned_objects_lock(&owned_objects_mutex_);
+      if (reconstructable_owned_objects_.empty()) {
+        break;
+      }
+      object_id = std::move(reconstructable_owned_objects_.front());
+      reconstructable_owned_objects_.pop_front();
+      reconstructable_owned_objects_index_.erase(object_id);
+    }
 
     auto it = object_id_refs_.find(object_id);
     RAY_CHECK(it != object_id_refs_.end());
@@ -596,14 +919,14 @@ void ReferenceCounter::ReleasePlasmaObject(ReferenceTable::iterator it) {
     it->second.on_delete = nullptr;
   }
   it->second.pinned_at_raylet_id.reset();
-  if (it->second.spilled && !it->second.spilled_node_id.IsNil()) {
+  if (it->second.spilled && !it->second.rare().spilled_node_id.IsNil()) {
     // The spilled copy of the object should get deleted during the on_delete
     // callback, so reset the spill location metadata here.
     // NOTE(swang): Spilled copies in cloud storage are not GCed, so we do not
     // reset the spilled metadata.
     it->second.spilled = false;
-    it->second.spilled_url = "";
-    it->second.spilled_node_id = NodeID::Nil();
+    it->second.mutable_rare().spilled_url = "";
+    it->second.mutable_rare().spilled_node_id = NodeID::Nil();
   }
 }
 
@@ -639,7 +962,7 @@ void ReferenceCounter::ResetObjectsOnRemovedNode(const NodeID &raylet_id) {
   for (auto it = object_id_refs_.begin(); it != object_id_refs_.end(); it++) {
     const auto &object_id = it->first;
     if (it->second.pinned_at_raylet_id.value_or(NodeID::Nil()) == raylet_id ||
-        it->second.spilled_node_id == raylet_id) {
+        it->second.rare().spilled_node_id == raylet_id) {
       ReleasePlasmaObject(it);
       if (!it->second.OutOfScope(lineage_pinning_enabled_)) {
         objects_to_recover_.push_back(object_id);
@@ -706,7 +1029,8 @@ bool ReferenceCounter::IsPlasmaObjectPinnedOrSpilled(const ObjectID &object_id,
 }
 
 bool ReferenceCounter::HasReference(const ObjectID &object_id) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
+  absl::MutexLock shard_lock(&object_id_refs_.GetShard(object_id).mutex);
   return object_id_refs_.find(object_id) != object_id_refs_.end();
 }
 
@@ -719,7 +1043,7 @@ std::unordered_set<ObjectID> ReferenceCounter::GetAllInScopeObjectIDs() const {
   absl::MutexLock lock(&mutex_);
   std::unordered_set<ObjectID> in_scope_object_ids;
   in_scope_object_ids.reserve(object_id_refs_.size());
-  for (auto it : object_id_refs_) {
+  for (const auto &it : object_id_refs_) {
     in_scope_object_ids.insert(it.first);
   }
   return in_scope_object_ids;
@@ -730,7 +1054,7 @@ ReferenceCounter::GetAllReferenceCounts() const {
   absl::MutexLock lock(&mutex_);
   std::unordered_map<ObjectID, std::pair<size_t, size_t>> all_ref_counts;
   all_ref_counts.reserve(object_id_refs_.size());
-  for (auto it : object_id_refs_) {
+  for (const auto &it : object_id_refs_) {
     all_ref_counts.emplace(it.first,
                            std::pair<size_t, size_t>(it.second.local_ref_count,
                                                      it.second.submitted_task_ref_count));
@@ -803,17 +1127,21 @@ bool ReferenceCounter::GetAndClearLocalBorrowersInternal(const ObjectID &object_
 
   if (for_ref_removed || !it->second.foreign_owner_already_monitoring) {
     borrowed_refs->emplace(object_id, it->second);
-    // Clear the local list of borrowers that we have accumulated. The receiver
-    // of the returned borrowed_refs must merge this list into their own list
-    // until all active borrowers are merged into the owner.
-    it->second.borrowers.clear();
-    // If a foreign owner process is waiting for this ref to be removed already,
-    // then don't clear its stored metadata. Clearing this will prevent the
-    // foreign owner from learning about the parent task borrowing this value.
-    it->second.stored_in_objects.clear();
+    // Don't allocate the rare fields just to clear them.
+    if (it->second.rare_fields.ptr) {
+      auto &rare = *it->second.rare_fields.ptr;
+      // Clear the local list of borrowers that we have accumulated. The receiver
+      // of the returned borrowed_refs must merge this list into their own list
+      // until all active borrowers are merged into the owner.
+      rare.borrowers.clear();
+      // If a foreign owner process is waiting for this ref to be removed already,
+      // then don't clear its stored metadata. Clearing this will prevent the
+      // foreign owner from learning about the parent task borrowing this value.
+      rare.stored_in_objects.clear();
+    }
   }
   // Attempt to pop children.
-  for (const auto &contained_id : it->second.contains) {
+  for (const auto &contained_id : it->second.rare().contains) {
     GetAndClearLocalBorrowersInternal(contained_id, for_ref_removed, borrowed_refs);
   }
   // We've reported our nested refs.
@@ -832,11 +1160,13 @@ void ReferenceCounter::MergeRemoteBorrowers(const ObjectID &object_id,
   }
   const auto &borrower_ref = borrower_it->second;
   RAY_LOG(DEBUG) << "Borrower ref " << object_id << " has "
-                 << borrower_ref.borrowers.size() << " borrowers"
+                 << borrower_ref.rare().borrowers.size() << " borrowers"
                  << ", local: " << borrower_ref.local_ref_count
                  << ", submitted: " << borrower_ref.submitted_task_ref_count
-                 << ", contained_in_owned: " << borrower_ref.contained_in_owned.size()
-                 << ", stored_in_objects: " << borrower_ref.stored_in_objects.size();
+                 << ", contained_in_owned: "
+                 << borrower_ref.rare().contained_in_owned.size()
+                 << ", stored_in_objects: "
+                 << borrower_ref.rare().stored_in_objects.size();
 
   auto it = object_id_refs_.find(object_id);
   if (it == object_id_refs_.end()) {
@@ -846,7 +1176,7 @@ void ReferenceCounter::MergeRemoteBorrowers(const ObjectID &object_id,
 
   // The worker is still using the reference, so it is still a borrower.
   if (borrower_ref.RefCount() > 0) {
-    auto inserted = it->second.borrowers.insert(worker_addr).second;
+    auto inserted = it->second.mutable_rare().borrowers.insert(worker_addr).second;
     // If we are the owner of id, then send WaitForRefRemoved to borrower.
     if (inserted) {
       RAY_LOG(DEBUG) << "Adding borrower " << worker_addr.ip_address << ":"
@@ -856,8 +1186,8 @@ void ReferenceCounter::MergeRemoteBorrowers(const ObjectID &object_id,
   }
 
   // Add any other workers that this worker passed the ID to as new borrowers.
-  for (const auto &nested_borrower : borrower_ref.borrowers) {
-    auto inserted = it->second.borrowers.insert(nested_borrower).second;
+  for (const auto &nested_borrower : borrower_ref.rare().borrowers) {
+    auto inserted = it->second.mutable_rare().borrowers.insert(nested_borrower).second;
     if (inserted) {
       RAY_LOG(DEBUG) << "Adding borrower " << nested_borrower.ip_address << ":"
                      << nested_borrower.port << " to id " << object_id;
@@ -868,7 +1198,7 @@ void ReferenceCounter::MergeRemoteBorrowers(const ObjectID &object_id,
   // This ref was nested inside another object. Copy this information to our
   // local table.
   for (const auto &contained_in_borrowed_id :
-       borrower_it->second.contained_in_borrowed_ids) {
+       borrower_it->second.rare().contained_in_borrowed_ids) {
     RAY_CHECK(borrower_ref.owner_address);
     AddBorrowedObjectInternal(object_id, contained_in_borrowed_id,
                               *borrower_ref.owner_address,
@@ -889,14 +1219,14 @@ void ReferenceCounter::MergeRemoteBorrowers(const ObjectID &object_id,
 
   // If the borrower stored this object ID inside another object ID that it did
   // not own, then mark that the object ID is nested inside another.
-  for (const auto &stored_in_object : borrower_ref.stored_in_objects) {
+  for (const auto &stored_in_object : borrower_ref.rare().stored_in_objects) {
     AddNestedObjectIdsInternal(stored_in_object.first, {object_id},
                                stored_in_object.second);
   }
 
   // Recursively merge any references that were contained in this object, to
   // handle any borrowers of nested objects.
-  for (const auto &inner_id : borrower_ref.contains) {
+  for (const auto &inner_id : borrower_ref.rare().contains) {
     MergeRemoteBorrowers(inner_id, worker_addr, borrowed_refs);
   }
   PRINT_REF_COUNT(it);
@@ -912,19 +1242,91 @@ void ReferenceCounter::CleanupBorrowersOnRefRemoved(
   // Erase the previous borrower.
   auto it = object_id_refs_.find(object_id);
   RAY_CHECK(it != object_id_refs_.end()) << object_id;
-  RAY_CHECK(it->second.borrowers.erase(borrower_addr));
+  RAY_CHECK(it->second.mutable_rare().borrowers.erase(borrower_addr));
   DeleteReferenceInternal(it, nullptr);
+  FlushRefRemovedWaits();
+}
+
+bool ReferenceCounter::CleanupBorrowersOnRefsRemoved(
+    const ReferenceTable &new_borrower_refs, const std::string &batch_key,
+    const std::vector<ObjectID> *removed_ids, const rpc::WorkerAddress &borrower_addr) {
+  absl::MutexLock lock(&mutex_);
+  auto batch_it = waited_ref_batches_.find(batch_key);
+  if (batch_it == waited_ref_batches_.end()) {
+    // A message that was delivered after the batch was done.
+    return false;
+  }
+  auto &waiting_ids = batch_it->second;
+  const std::vector<ObjectID> object_ids =
+      removed_ids != nullptr
+          ? *removed_ids
+          : std::vector<ObjectID>(waiting_ids.begin(), waiting_ids.end());
+  for (const auto &object_id : object_ids) {
+    if (!waiting_ids.erase(object_id)) {
+      continue;
+    }
+    // Merge in any new borrowers that the previous borrower learned of.
+    MergeRemoteBorrowers(object_id, borrower_addr, new_borrower_refs);
+
+    // Erase the previous borrower.
+    auto it = object_id_refs_.find(object_id);
+    RAY_CHECK(it != object_id_refs_.end()) << object_id;
+    RAY_CHECK(it->second.mutable_rare().borrowers.erase(borrower_addr));
+    DeleteReferenceInternal(it, nullptr);
+  }
+  const bool done = waiting_ids.empty();
+  if (done) {
+    waited_ref_batches_.erase(batch_it);
+  }
+  FlushRefRemovedWaits();
+  return done;
 }
 
 void ReferenceCounter::WaitForRefRemoved(const ReferenceTable::iterator &ref_it,
                                          const rpc::WorkerAddress &addr,
                                          const ObjectID &contained_in_id) {
-  const ObjectID &object_id = ref_it->first;
+  // Only the owner should send requests to borrowers.
+  RAY_CHECK(ref_it->second.owned_by_us);
+  ref_removed_waits_.push_back(RefRemovedWait{ref_it->first, addr, contained_in_id});
+}
+
+void ReferenceCounter::FlushRefRemovedWaits() {
+  if (ref_removed_waits_.empty()) {
+    return;
+  }
+  std::vector<RefRemovedWait> waits;
+  waits.swap(ref_removed_waits_);
+  // Group the waits by borrower, outer object, and the task that created the objects.
+  absl::flat_hash_map<std::string, std::vector<const RefRemovedWait *>> batches;
+  for (const auto &wait : waits) {
+    batches[wait.borrower_address.worker_id.Binary() + wait.contained_in_id.Binary() +
+            wait.object_id.TaskId().Binary()]
+        .push_back(&wait);
+  }
+  for (const auto &batch : batches) {
+    const auto &first = *batch.second.front();
+    if (batch.second.size() == 1) {
+      SubscribeRefRemoved(first.object_id, first.borrower_address,
+                          first.contained_in_id);
+      continue;
+    }
+    std::vector<ObjectID> object_ids;
+    object_ids.reserve(batch.second.size());
+    for (const auto *wait : batch.second) {
+      object_ids.push_back(wait->object_id);
+    }
+    SubscribeRefsRemoved(object_ids, first.borrower_address, first.contained_in_id);
+  }
+}
+
+void ReferenceCounter::SubscribeRefRemoved(const ObjectID &object_id,
+                                           const rpc::WorkerAddress &addr,
+                                           const ObjectID &contained_in_id) {
   RAY_LOG(DEBUG) << "WaitForRefRemoved " << object_id << ", dest=" << addr.worker_id;
+  auto ref_it = object_id_refs_.find(object_id);
+  RAY_CHECK(ref_it != object_id_refs_.end()) << object_id;
   auto sub_message = std::make_unique<rpc::SubMessage>();
   auto *request = sub_message->mutable_worker_ref_removed_message();
-  // Only the owner should send requests to borrowers.
-  RAY_CHECK(ref_it->second.owned_by_us);
   request->mutable_reference()->set_object_id(object_id.Binary());
   request->mutable_reference()->mutable_owner_address()->CopyFrom(
       *ref_it->second.owner_address);
@@ -965,11 +1367,64 @@ void ReferenceCounter::WaitForRefRemoved(const ReferenceTable::iterator &ref_it,
       message_published_callback, publisher_failed_callback));
 }
 
+void ReferenceCounter::SubscribeRefsRemoved(const std::vector<ObjectID> &object_ids,
+                                            const rpc::WorkerAddress &addr,
+                                            const ObjectID &contained_in_id) {
+  // The key of a batch is the ID of the task that created the objects, plus a sequence
+  // number, so it never collides with the key of an object.
+  std::string batch_key = object_ids.front().TaskId().Binary();
+  const uint64_t seq_no = ++last_ref_batch_seq_no_;
+  batch_key.append(reinterpret_cast<const char *>(&seq_no), sizeof(seq_no));
+  RAY_LOG(DEBUG) << "WaitForRefRemoved " << object_ids.size() << " objects of task "
+                 << object_ids.front().TaskId() << ", dest=" << addr.worker_id;
+  auto sub_message = std::make_unique<rpc::SubMessage>();
+  auto *request = sub_message->mutable_worker_refs_removed_message();
+  ObjectIdsToProto(object_ids, request->mutable_object_ids());
+  request->mutable_owner_address()->CopyFrom(rpc_address_.ToProto());
+  request->set_contained_in_id(contained_in_id.Binary());
+  request->set_intended_worker_id(addr.worker_id.Binary());
+  request->set_subscriber_worker_id(rpc_address_.ToProto().worker_id());
+  waited_ref_batches_.emplace(
+      batch_key, absl::flat_hash_set<ObjectID>(object_ids.begin(), object_ids.end()));
+
+  // This callback is invoked whenever the borrower stops borrowing some of the
+  // objects.
+  const auto message_published_callback = [this, addr,
+                                           batch_key](const rpc::PubMessage &msg) {
+    RAY_CHECK(msg.has_worker_refs_removed_message());
+    const auto &message = msg.worker_refs_removed_message();
+    const ReferenceTable new_borrower_refs =
+        ReferenceTableFromProto(message.borrowed_refs());
+    const auto removed_ids = ObjectIdsFromProto(message.object_ids());
+    RAY_LOG(DEBUG) << "WaitForRefRemoved returned for " << removed_ids.size()
+                   << " objects, dest=" << addr.worker_id;
+    if (CleanupBorrowersOnRefsRemoved(new_borrower_refs, batch_key, &removed_ids,
+                                      addr)) {
+      // Unsubscribe the batch once all of its objects are removed.
+      RAY_CHECK(object_info_subscriber_->Unsubscribe(
+          rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL, addr.ToProto(), batch_key));
+    }
+  };
+
+  // If the borrower is failed, this callback will be called.
+  const auto publisher_failed_callback = [this, addr](const std::string &batch_key,
+                                                      const Status &) {
+    RAY_LOG(DEBUG) << "WaitForRefRemoved failed for a batch, dest=" << addr.worker_id;
+    CleanupBorrowersOnRefsRemoved({}, batch_key, /*removed_ids=*/nullptr, addr);
+  };
+
+  RAY_CHECK(object_info_subscriber_->Subscribe(
+      std::move(sub_message), rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL,
+      addr.ToProto(), batch_key, /*subscribe_done_callback=*/nullptr,
+      message_published_callback, publisher_failed_callback));
+}
+
 void ReferenceCounter::AddNestedObjectIds(const ObjectID &object_id,
                                           const std::vector<ObjectID> &inner_ids,
                                           const rpc::WorkerAddress &owner_address) {
   absl::MutexLock lock(&mutex_);
   AddNestedObjectIdsInternal(object_id, inner_ids, owner_address);
+  FlushRefRemovedWaits();
 }
 
 void ReferenceCounter::AddNestedObjectIdsInternal(
@@ -986,7 +1441,7 @@ void ReferenceCounter::AddNestedObjectIdsInternal(
       // contained in the outer object ID so we do not GC the inner objects
       // until the outer object goes out of scope.
       for (const auto &inner_id : inner_ids) {
-        it->second.contains.insert(inner_id);
+        it->second.mutable_rare().contains.insert(inner_id);
         RAY_LOG(DEBUG) << "Setting inner ID " << inner_id
                        << " contained_in_owned: " << object_id;
       }
@@ -995,7 +1450,7 @@ void ReferenceCounter::AddNestedObjectIdsInternal(
       for (const auto &inner_id : inner_ids) {
         auto inner_it = object_id_refs_.emplace(inner_id, Reference()).first;
         bool was_in_use = inner_it->second.RefCount() > 0;
-        inner_it->second.contained_in_owned.insert(object_id);
+        inner_it->second.mutable_rare().contained_in_owned.insert(object_id);
         if (!was_in_use && inner_it->second.RefCount() > 0) {
           SetNestedRefInUseRecursive(inner_it);
         }
@@ -1014,14 +1469,16 @@ void ReferenceCounter::AddNestedObjectIdsInternal(
       }
       // Add the task's caller as a borrower.
       if (inner_it->second.owned_by_us) {
-        auto inserted = inner_it->second.borrowers.insert(owner_address).second;
+        auto inserted =
+            inner_it->second.mutable_rare().borrowers.insert(owner_address).second;
         if (inserted) {
           // Wait for it to remove its reference.
           WaitForRefRemoved(inner_it, owner_address, object_id);
         }
       } else {
-        auto inserted =
-            inner_it->second.stored_in_objects.emplace(object_id, owner_address).second;
+        auto inserted = inner_it->second.mutable_rare()
+                            .stored_in_objects.emplace(object_id, owner_address)
+                            .second;
         // This should be the first time that we have stored this object ID
         // inside this return ID.
         RAY_CHECK(inserted);
@@ -1041,8 +1498,9 @@ void ReferenceCounter::HandleRefRemoved(const ObjectID &object_id) {
   RAY_UNUSED(GetAndClearLocalBorrowersInternal(object_id,
                                                /*for_ref_removed=*/true, &borrowed_refs));
   for (const auto &pair : borrowed_refs) {
-    RAY_LOG(DEBUG) << pair.first << " has " << pair.second.borrowers.size()
-                   << " borrowers, stored in " << pair.second.stored_in_objects.size();
+    RAY_LOG(DEBUG) << pair.first << " has " << pair.second.rare().borrowers.size()
+                   << " borrowers, stored in "
+                   << pair.second.rare().stored_in_objects.size();
   }
 
   // Send the owner information about any new borrowers.
@@ -1064,6 +1522,14 @@ void ReferenceCounter::SetRefRemovedCallback(
     const rpc::Address &owner_address,
     const ReferenceCounter::ReferenceRemovedCallback &ref_removed_callback) {
   absl::MutexLock lock(&mutex_);
+  SetRefRemovedCallbackInternal(object_id, contained_in_id, owner_address,
+                                ref_removed_callback);
+}
+
+void ReferenceCounter::SetRefRemovedCallbackInternal(
+    const ObjectID &object_id, const ObjectID &contained_in_id,
+    const rpc::Address &owner_address,
+    const ReferenceCounter::ReferenceRemovedCallback &ref_removed_callback) {
   RAY_LOG(DEBUG) << "Received WaitForRefRemoved " << object_id << " contained in "
                  << contained_in_id;
 
@@ -1089,7 +1555,7 @@ void ReferenceCounter::SetRefRemovedCallback(
   } else {
     // We are still borrowing the object ID. Respond to the owner once we have
     // stopped borrowing it.
-    if (it->second.on_ref_removed != nullptr) {
+    if (it->second.rare().on_ref_removed != nullptr) {
       // TODO(swang): If the owner of an object dies and and is re-executed, it
       // is possible that we will receive a duplicate request to set
       // on_ref_removed. If messages are delayed and we overwrite the
@@ -1099,7 +1565,124 @@ void ReferenceCounter::SetRefRemovedCallback(
       RAY_LOG(WARNING) << "on_ref_removed already set for " << object_id
                        << ". The owner task must have died and been re-executed.";
     }
-    it->second.on_ref_removed = ref_removed_callback;
+    it->second.mutable_rare().on_ref_removed = ref_removed_callback;
+  }
+}
+
+void ReferenceCounter::SetRefsRemovedCallback(
+    const std::string &batch_key, const rpc::WorkerRefsRemovedSubMessage &message) {
+  absl::MutexLock lock(&mutex_);
+  const auto object_ids = ObjectIdsFromProto(message.object_ids());
+  auto inserted = borrowed_ref_batches_.emplace(batch_key, BorrowedRefBatch());
+  if (!inserted.second) {
+    RAY_LOG(WARNING) << "Received a duplicate WaitForRefRemoved for a batch of "
+                     << object_ids.size() << " objects, ignoring it.";
+    return;
+  }
+  inserted.first->second.num_borrowed = object_ids.size();
+  RAY_LOG(DEBUG) << "Received WaitForRefRemoved for " << object_ids.size()
+                 << " objects";
+
+  const auto intended_worker_id = WorkerID::FromBinary(message.intended_worker_id());
+  if (intended_worker_id != rpc_address_.worker_id) {
+    RAY_LOG(INFO) << "The WaitForRefRemoved message is for " << intended_worker_id
+                  << ", but the current worker id is " << rpc_address_.worker_id
+                  << ". The RPC will be no-op.";
+    for (const auto &object_id : object_ids) {
+      HandleRefRemovedInBatch(batch_key, object_id);
+    }
+    return;
+  }
+
+  const auto contained_in_id = ObjectID::FromBinary(message.contained_in_id());
+  for (const auto &object_id : object_ids) {
+    SetRefRemovedCallbackInternal(
+        object_id, contained_in_id, message.owner_address(),
+        [this, batch_key](const ObjectID &object_id) {
+          HandleRefRemovedInBatch(batch_key, object_id);
+        });
+  }
+}
+
+void ReferenceCounter::SetRefsRemovedFlushScheduler(
+    std::function<void()> schedule_flush) {
+  schedule_refs_removed_flush_ = std::move(schedule_flush);
+}
+
+void ReferenceCounter::FlushRefsRemoved() {
+  absl::MutexLock lock(&mutex_);
+  refs_removed_flush_scheduled_ = false;
+  PublishRefsRemovedInternal();
+}
+
+void ReferenceCounter::HandleRefRemovedInBatch(const std::string &batch_key,
+                                               const ObjectID &object_id) {
+  RAY_LOG(DEBUG) << "HandleRefRemoved " << object_id << " in a batch";
+  auto batch_it = borrowed_ref_batches_.find(batch_key);
+  RAY_CHECK(batch_it != borrowed_ref_batches_.end());
+  auto &batch = batch_it->second;
+  ReferenceTable borrowed_refs;
+  RAY_UNUSED(GetAndClearLocalBorrowersInternal(object_id,
+                                               /*for_ref_removed=*/true, &borrowed_refs));
+  MergeBorrowedRefs(std::move(borrowed_refs), &batch.borrowed_refs);
+  batch.removed.push_back(object_id);
+  RAY_CHECK(batch.num_borrowed > 0);
+  batch.num_borrowed--;
+  borrowed_ref_batches_to_publish_.insert(batch_key);
+
+  if (!schedule_refs_removed_flush_) {
+    PublishRefsRemovedInternal();
+  } else if (!refs_removed_flush_scheduled_) {
+    refs_removed_flush_scheduled_ = true;
+    schedule_refs_removed_flush_();
+  }
+}
+
+void ReferenceCounter::PublishRefsRemovedInternal() {
+  for (const auto &batch_key : borrowed_ref_batches_to_publish_) {
+    auto batch_it = borrowed_ref_batches_.find(batch_key);
+    RAY_CHECK(batch_it != borrowed_ref_batches_.end());
+    auto &batch = batch_it->second;
+
+    // Send the owner the removed objects and any new borrowers.
+    rpc::PubMessage pub_message;
+    pub_message.set_key_id(batch_key);
+    pub_message.set_channel_type(rpc::ChannelType::WORKER_REF_REMOVED_CHANNEL);
+    auto *refs_removed_message = pub_message.mutable_worker_refs_removed_message();
+    ObjectIdsToProto(batch.removed, refs_removed_message->mutable_object_ids());
+    ReferenceTableToProto(batch.borrowed_refs,
+                          refs_removed_message->mutable_borrowed_refs());
+    RAY_LOG(DEBUG) << "Publishing WaitForRefRemoved message for "
+                   << batch.removed.size() << " objects, message has "
+                   << refs_removed_message->borrowed_refs().size()
+                   << " borrowed references.";
+    object_info_publisher_->Publish(pub_message);
+
+    if (batch.num_borrowed == 0) {
+      borrowed_ref_batches_.erase(batch_it);
+    } else {
+      batch.removed.clear();
+      batch.borrowed_refs.clear();
+    }
+  }
+  borrowed_ref_batches_to_publish_.clear();
+}
+
+void ReferenceCounter::MergeBorrowedRefs(ReferenceTable &&from, ReferenceTable *to) {
+  for (auto &pair : from) {
+    auto it = to->find(pair.first);
+    if (it == to->end()) {
+      to->emplace(pair.first, std::move(pair.second));
+      continue;
+    }
+    Reference previous = std::move(it->second);
+    it->second = std::move(pair.second);
+    for (const auto &borrower : previous.rare().borrowers) {
+      it->second.mutable_rare().borrowers.insert(borrower);
+    }
+    for (const auto &stored_in_object : previous.rare().stored_in_objects) {
+      it->second.mutable_rare().stored_in_objects.insert(stored_in_object);
+    }
   }
 }
 
@@ -1130,6 +1713,7 @@ void ReferenceCounter::AddObjectLocationInternal(ReferenceTable::iterator it,
     // Only push to subscribers if we added a new location. We eagerly add the pinned
     // location without waiting for the object store notification to trigger a location
     // report, so there's a chance that we already knew about the node_id location.
+    UpdateLocalityIndex(it);
     PushToLocationSubscribers(it);
   }
 }
@@ -1152,20 +1736,23 @@ bool ReferenceCounter::RemoveObjectLocation(const ObjectID &object_id,
 void ReferenceCounter::RemoveObjectLocationInternal(ReferenceTable::iterator it,
                                                     const NodeID &node_id) {
   it->second.locations.erase(node_id);
+  UpdateLocalityIndex(it);
   PushToLocationSubscribers(it);
 }
 
-void ReferenceCounter::UpdateObjectPendingCreation(const ObjectID &object_id,
+bool ReferenceCounter::UpdateObjectPendingCreation(ReferenceTable &refs,
+                                                   const ObjectID &object_id,
                                                    bool pending_creation) {
-  auto it = object_id_refs_.find(object_id);
+  auto it = refs.find(object_id);
   bool push = false;
-  if (it != object_id_refs_.end()) {
+  if (it != refs.end()) {
     push = (it->second.pending_creation != pending_creation);
     it->second.pending_creation = pending_creation;
   }
   if (push) {
     PushToLocationSubscribers(it);
   }
+  return true;
 }
 
 absl::optional<absl::flat_hash_set<NodeID>> ReferenceCounter::GetObjectLocations(
@@ -1177,11 +1764,13 @@ absl::optional<absl::flat_hash_set<NodeID>> ReferenceCounter::GetObjectLocations
                    << " that doesn't exist in the reference table";
     return absl::nullopt;
   }
-  return it->second.locations;
+  return absl::flat_hash_set<NodeID>(it->second.locations.begin(),
+                                     it->second.locations.end());
 }
 
 size_t ReferenceCounter::GetObjectSize(const ObjectID &object_id) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
+  absl::MutexLock shard_lock(&object_id_refs_.GetShard(object_id).mutex);
   auto it = object_id_refs_.find(object_id);
   if (it == object_id_refs_.end()) {
     return 0;
@@ -1211,13 +1800,14 @@ bool ReferenceCounter::HandleObjectSpilled(const ObjectID &object_id,
       spilled_node_id.IsNil() || check_node_alive_(spilled_node_id);
   if (spilled_location_alive) {
     if (spilled_url != "") {
-      it->second.spilled_url = spilled_url;
+      it->second.mutable_rare().spilled_url = spilled_url;
     }
     if (!spilled_node_id.IsNil()) {
-      it->second.spilled_node_id = spilled_node_id;
+      it->second.mutable_rare().spilled_node_id = spilled_node_id;
     }
     if (size > 0) {
       it->second.object_size = size;
+      UpdateLocalityIndex(it);
     }
     PushToLocationSubscribers(it);
   } else {
@@ -1231,38 +1821,11 @@ bool ReferenceCounter::HandleObjectSpilled(const ObjectID &object_id,
 
 absl::optional<LocalityData> ReferenceCounter::GetLocalityData(
     const ObjectID &object_id) {
-  absl::MutexLock lock(&mutex_);
-  // Uses the reference table to return locality data for an object.
-  auto it = object_id_refs_.find(object_id);
-  if (it == object_id_refs_.end()) {
-    // We don't have any information about this object so we can't return valid locality
-    // data.
-    RAY_LOG(DEBUG) << "Object " << object_id
-                   << " not in reference table, locality data not available";
-    return absl::nullopt;
-  }
-
-  // The size of this object.
-  const auto object_size = it->second.object_size;
-  if (object_size < 0) {
-    // We don't know the object size so we can't returned valid locality data.
-    RAY_LOG(DEBUG) << "Reference [" << it->second.call_site << "] for object "
-                   << object_id
-                   << " has an unknown object size, locality data not available";
-    return absl::nullopt;
-  }
-
-  // The locations of this object.
-  // - If we own this object, this will contain the complete up-to-date set of object
-  //   locations.
-  // - If we don't own this object, this will contain a snapshot of the object locations
-  //   at future resolution time.
-  const auto &node_ids = it->second.locations;
-
-  // We should only reach here if we have valid locality data to return.
-  absl::optional<LocalityData> locality_data(
-      {static_cast<uint64_t>(object_size), node_ids});
-  return locality_data;
+  // The locations in the index are:
+  // - If we own this object, the complete up-to-date set of object locations.
+  // - If we don't own this object, a snapshot of the object locations at future
+  //   resolution time.
+  return locality_index_.GetLocalityData(object_id);
 }
 
 bool ReferenceCounter::ReportLocalityData(const ObjectID &object_id,
@@ -1284,9 +1847,14 @@ bool ReferenceCounter::ReportLocalityData(const ObjectID &object_id,
   if (object_size > 0) {
     it->second.object_size = object_size;
   }
+  UpdateLocalityIndex(it);
   return true;
 }
 
+void ReferenceCounter::UpdateLocalityIndex(ReferenceTable::iterator it) {
+  locality_index_.Update(it->first, it->second.object_size, it->second.locations);
+}
+
 void ReferenceCounter::AddBorrowerAddress(const ObjectID &object_id,
                                           const rpc::Address &borrower_address) {
   absl::MutexLock lock(&mutex_);
@@ -1302,9 +1870,11 @@ void ReferenceCounter::AddBorrowerAddress(const ObjectID &object_id,
 
   RAY_LOG(DEBUG) << "Add borrower " << borrower_address.DebugString() << " for object "
                  << object_id;
-  auto inserted = it->second.borrowers.insert(borrower_worker_address).second;
+  auto inserted =
+      it->second.mutable_rare().borrowers.insert(borrower_worker_address).second;
   if (inserted) {
     WaitForRefRemoved(it, borrower_worker_address);
+    FlushRefRemovedWaits();
   }
 }
 
@@ -1323,7 +1893,8 @@ bool ReferenceCounter::IsObjectReconstructable(const ObjectID &object_id,
 }
 
 bool ReferenceCounter::IsObjectPendingCreation(const ObjectID &object_id) const {
-  absl::MutexLock lock(&mutex_);
+  absl::ReaderMutexLock lock(&mutex_);
+  absl::MutexLock shard_lock(&object_id_refs_.GetShard(object_id).mutex);
   auto it = object_id_refs_.find(object_id);
   if (it == object_id_refs_.end()) {
     return false;
@@ -1335,8 +1906,8 @@ void ReferenceCounter::PushToLocationSubscribers(ReferenceTable::iterator it) {
   const auto &object_id = it->first;
   const auto &locations = it->second.locations;
   auto object_size = it->second.object_size;
-  const auto &spilled_url = it->second.spilled_url;
-  const auto &spilled_node_id = it->second.spilled_node_id;
+  const auto &spilled_url = it->second.rare().spilled_url;
+  const auto &spilled_node_id = it->second.rare().spilled_node_id;
   const auto &optional_primary_node_id = it->second.pinned_at_raylet_id;
   const auto &primary_node_id = optional_primary_node_id.value_or(NodeID::Nil());
   RAY_LOG(DEBUG) << "Published message for " << object_id << ", " << locations.size()
@@ -1376,8 +1947,8 @@ void ReferenceCounter::FillObjectInformationInternal(
     object_info->add_node_ids(node_id.Binary());
   }
   object_info->set_object_size(it->second.object_size);
-  object_info->set_spilled_url(it->second.spilled_url);
-  object_info->set_spilled_node_id(it->second.spilled_node_id.Binary());
+  object_info->set_spilled_url(it->second.rare().spilled_url);
+  object_info->set_spilled_node_id(it->second.rare().spilled_node_id.Binary());
   auto primary_node_id = it->second.pinned_at_raylet_id.value_or(NodeID::Nil());
   object_info->set_primary_node_id(primary_node_id.Binary());
   object_info->set_pending_creation(it->second.pending_creation);
@@ -1411,23 +1982,27 @@ void ReferenceCounter::PublishObjectLocationSnapshot(const ObjectID &object_id)
 ReferenceCounter::Reference ReferenceCounter::Reference::FromProto(
     const rpc::ObjectReferenceCount &ref_count) {
   Reference ref;
-  ref.owner_address = ref_count.reference().owner_address();
+  ref.owner_address =
+      std::make_shared<const rpc::Address>(ref_count.reference().owner_address());
   ref.local_ref_count = ref_count.has_local_ref() ? 1 : 0;
 
   for (const auto &borrower : ref_count.borrowers()) {
-    ref.borrowers.insert(rpc::WorkerAddress(borrower));
+    ref.mutable_rare().borrowers.insert(rpc::WorkerAddress(borrower));
   }
   for (const auto &object : ref_count.stored_in_objects()) {
     const auto &object_id = ObjectID::FromBinary(object.object_id());
-    ref.stored_in_objects.emplace(object_id, rpc::WorkerAddress(object.owner_address()));
+    ref.mutable_rare().stored_in_objects.emplace(
+        object_id, rpc::WorkerAddress(object.owner_address()));
   }
   for (const auto &id : ref_count.contains()) {
-    ref.contains.insert(ObjectID::FromBinary(id));
+    ref.mutable_rare().contains.insert(ObjectID::FromBinary(id));
   }
   const auto contained_in_borrowed_ids =
       IdVectorFromProtobuf<ObjectID>(ref_count.contained_in_borrowed_ids());
-  ref.contained_in_borrowed_ids.insert(contained_in_borrowed_ids.begin(),
-                                       contained_in_borrowed_ids.end());
+  if (!contained_in_borrowed_ids.empty()) {
+    ref.mutable_rare().contained_in_borrowed_ids.insert(
+        contained_in_borrowed_ids.begin(), contained_in_borrowed_ids.end());
+  }
   return ref;
 }
 
@@ -1437,18 +2012,18 @@ void ReferenceCounter::Reference::ToProto(rpc::ObjectReferenceCount *ref) const
   }
   bool has_local_ref = RefCount() > 0;
   ref->set_has_local_ref(has_local_ref);
-  for (const auto &borrower : borrowers) {
+  for (const auto &borrower : rare().borrowers) {
     ref->add_borrowers()->CopyFrom(borrower.ToProto());
   }
-  for (const auto &object : stored_in_objects) {
+  for (const auto &object : rare().stored_in_objects) {
     auto ref_object = ref->add_stored_in_objects();
     ref_object->set_object_id(object.first.Binary());
     ref_object->mutable_owner_address()->CopyFrom(object.second.ToProto());
   }
-  for (const auto &contained_in_borrowed_id : contained_in_borrowed_ids) {
+  for (const auto &contained_in_borrowed_id : rare().contained_in_borrowed_ids) {
     ref->add_contained_in_borrowed_ids(contained_in_borrowed_id.Binary());
   }
-  for (const auto &contains_id : contains) {
+  for (const auto &contains_id : rare().contains) {
     ref->add_contains(contains_id.Binary());
   }
 }
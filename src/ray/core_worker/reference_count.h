@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <array>
+#include <bitset>
+
 #include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
@@ -25,6 +29,7 @@
 #include "ray/rpc/grpc_server.h"
 #include "ray/rpc/worker/core_worker_client.h"
 #include "ray/rpc/worker/core_worker_client_pool.h"
+#include "ray/util/container_util.h"
 #include "ray/util/logging.h"
 #include "src/ray/protobuf/common.pb.h"
 
@@ -53,6 +58,12 @@ class ReferenceCounterInterface {
 
 /// Class used by the core worker to keep track of ObjectID reference counts for garbage
 /// collection. This class is thread safe.
+///
+/// The reference table is sharded by ObjectID. The common count updates, which only
+/// touch one Reference that stays in scope, lock only the shard of that Reference, so
+/// that threads updating the counts of different objects don't contend. Everything
+/// else, such as creating nested references or deleting a Reference, locks the whole
+/// table.
 class ReferenceCounter : public ReferenceCounterInterface,
                          public LocalityDataProviderInterface {
  public:
@@ -256,6 +267,28 @@ class ReferenceCounter : public ReferenceCounterInterface,
                              const ReferenceRemovedCallback &ref_removed_callback)
       LOCKS_EXCLUDED(mutex_);
 
+  /// Wait for us to stop borrowing a batch of objects that the owner waits for in one
+  /// subscription, instead of one per object. Whenever we stop borrowing some of the
+  /// objects, their IDs are published to the owner in one message, together with the
+  /// borrowers that we accumulated for them.
+  ///
+  /// \param[in] batch_key The key of the owner's subscription.
+  /// \param[in] message The owner's request.
+  void SetRefsRemovedCallback(const std::string &batch_key,
+                              const rpc::WorkerRefsRemovedSubMessage &message)
+      LOCKS_EXCLUDED(mutex_);
+
+  /// Set the callback that schedules a call to FlushRefsRemoved, so that the objects of
+  /// a batch that we stop borrowing in a burst are published in one message. If it
+  /// isn't set, each object is published as soon as we stop borrowing it.
+  ///
+  /// \param[in] schedule_flush The callback. It must not call FlushRefsRemoved
+  /// synchronously.
+  void SetRefsRemovedFlushScheduler(std::function<void()> schedule_flush);
+
+  /// Publish the objects of batches that we stopped borrowing since the last flush.
+  void FlushRefsRemoved() LOCKS_EXCLUDED(mutex_);
+
   /// Set a callback to call whenever a Reference that we own is deleted. A
   /// Reference can only be deleted if:
   /// 1. The ObjectID's ref count is 0 on all workers.
@@ -438,7 +471,8 @@ class ReferenceCounter : public ReferenceCounterInterface,
                            const NodeID &spilled_node_id, int64_t size);
 
   /// Get locality data for object. This is used by the leasing policy to implement
-  /// locality-aware leasing.
+  /// locality-aware leasing. It's read from `locality_index_`, so it doesn't take
+  /// `mutex_`.
   ///
   /// \param[in] object_id Object whose locality data we want.
   /// \return Locality data.
@@ -481,20 +515,88 @@ class ReferenceCounter : public ReferenceCounterInterface,
 
  private:
   struct Reference {
+    /// The fields that most References don't use, which are only allocated once one of
+    /// them is set: the ones of nested refs, of refs that we lent to other processes and
+    /// of spilled objects.
+    struct RareFields {
+      /// Object IDs that we own and that contain this object ID.
+      /// ObjectIDs are added to this field when we discover that this object
+      /// contains other IDs. This can happen in 2 cases:
+      ///  1. We call ray.put() and store the inner ID(s) in the outer object.
+      ///  2. A task that we submitted returned an ID(s).
+      /// ObjectIDs are erased from this field when their Reference is deleted.
+      absl::flat_hash_set<ObjectID> contained_in_owned;
+      /// Object IDs that we borrowed and that contain this object ID.
+      /// ObjectIDs are added to this field when we get the value of an ObjectRef
+      /// (either by deserializing the object or receiving the GetObjectStatus
+      /// reply for inlined objects) and it contains another ObjectRef.
+      absl::flat_hash_set<ObjectID> contained_in_borrowed_ids;
+      /// Reverse pointer for contained_in_owned and contained_in_borrowed_ids.
+      /// The object IDs contained in this object. These could be objects that we
+      /// own or are borrowing. This field is updated in 2 cases:
+      ///  1. We call ray.put() on this ID and store the contained IDs.
+      ///  2. We call ray.get() on an ID whose contents we do not know and we
+      ///     discover that it contains these IDs.
+      absl::flat_hash_set<ObjectID> contains;
+      /// A list of processes that are we gave a reference to that are still
+      /// borrowing the ID. This field is updated in 2 cases:
+      ///  1. If we are a borrower of the ID, then we add a process to this list
+      ///     if we passed that process a copy of the ID via task submission and
+      ///     the process is still using the ID by the time it finishes its task.
+      ///     Borrowers are removed from the list when we recursively merge our
+      ///     list into the owner.
+      ///  2. If we are the owner of the ID, then either the above case, or when
+      ///     we hear from a borrower that it has passed the ID to other
+      ///     borrowers. A borrower is removed from the list when it responds
+      ///     that it is no longer using the reference.
+      absl::flat_hash_set<rpc::WorkerAddress> borrowers;
+      /// When a process that is borrowing an object ID stores the ID inside the
+      /// return value of a task that it executes, the caller of the task is also
+      /// considered a borrower for as long as its reference to the task's return
+      /// ID stays in scope. Thus, the borrower must notify the owner that the
+      /// task's caller is also a borrower. The key is the task's return ID, and
+      /// the value is the task ID and address of the task's caller.
+      absl::flat_hash_map<ObjectID, rpc::WorkerAddress> stored_in_objects;
+      /// For objects that have been spilled to external storage, the URL from which
+      /// they can be retrieved.
+      std::string spilled_url = "";
+      /// The ID of the node that spilled the object.
+      /// This will be Nil if the object has not been spilled or if it is spilled
+      /// distributed external storage.
+      NodeID spilled_node_id = NodeID::Nil();
+      /// Callback that is called when this process is no longer a borrower
+      /// (RefCount() == 0).
+      std::function<void(const ObjectID &)> on_ref_removed;
+    };
+
+    /// Owns the rare fields of a Reference, and copies them along with it.
+    struct RareFieldsPtr {
+      RareFieldsPtr() = default;
+      RareFieldsPtr(const RareFieldsPtr &other)
+          : ptr(other.ptr ? std::make_unique<RareFields>(*other.ptr) : nullptr) {}
+      RareFieldsPtr(RareFieldsPtr &&other) = default;
+      RareFieldsPtr &operator=(RareFieldsPtr other) {
+        ptr = std::move(other.ptr);
+        return *this;
+      }
+
+      std::unique_ptr<RareFields> ptr;
+    };
+
     /// Constructor for a reference whose origin is unknown.
     Reference() {}
     Reference(std::string call_site, const int64_t object_size)
         : call_site(call_site), object_size(object_size) {}
     /// Constructor for a reference that we created.
-    Reference(const rpc::Address &owner_address, std::string call_site,
+    Reference(std::shared_ptr<const rpc::Address> owner_address, std::string call_site,
               const int64_t object_size, bool is_reconstructable,
               const absl::optional<NodeID> &pinned_at_raylet_id)
         : call_site(call_site),
           object_size(object_size),
+          owner_address(std::move(owner_address)),
+          pinned_at_raylet_id(pinned_at_raylet_id),
           owned_by_us(true),
           foreign_owner_already_monitoring(false),
-          owner_address(owner_address),
-          pinned_at_raylet_id(pinned_at_raylet_id),
           is_reconstructable(is_reconstructable),
           pending_creation(!pinned_at_raylet_id.has_value()) {}
 
@@ -504,13 +606,28 @@ class ReferenceCounter : public ReferenceCounterInterface,
     /// Serialize to a protobuf.
     void ToProto(rpc::ObjectReferenceCount *ref) const;
 
+    /// The rare fields, which are empty if they aren't allocated.
+    const RareFields &rare() const {
+      static const RareFields empty_rare_fields;
+      return rare_fields.ptr ? *rare_fields.ptr : empty_rare_fields;
+    }
+
+    /// The rare fields, which are allocated if they aren't yet.
+    RareFields &mutable_rare() {
+      if (!rare_fields.ptr) {
+        rare_fields.ptr = std::make_unique<RareFields>();
+      }
+      return *rare_fields.ptr;
+    }
+
     /// The reference count. This number includes:
     /// - Python references to the ObjectID.
     /// - Pending submitted tasks that depend on the object.
     /// - ObjectIDs containing this ObjectID that we own and that are still in
     /// scope.
     size_t RefCount() const {
-      return local_ref_count + submitted_task_ref_count + contained_in_owned.size();
+      return local_ref_count + submitted_task_ref_count +
+             rare().contained_in_owned.size();
     }
 
     /// Whether this reference is no longer in scope. A reference is in scope
@@ -521,9 +638,9 @@ class ReferenceCounter : public ReferenceCounterInterface,
     /// - We gave the reference to at least one other process.
     bool OutOfScope(bool lineage_pinning_enabled) const {
       bool in_scope = RefCount() > 0;
-      bool is_nested = contained_in_borrowed_ids.size();
-      bool has_borrowers = borrowers.size() > 0;
-      bool was_stored_in_objects = stored_in_objects.size() > 0;
+      bool is_nested = rare().contained_in_borrowed_ids.size();
+      bool has_borrowers = rare().borrowers.size() > 0;
+      bool was_stored_in_objects = rare().stored_in_objects.size() > 0;
 
       bool has_lineage_references = false;
       if (lineage_pinning_enabled && owned_by_us && !is_reconstructable) {
@@ -551,6 +668,34 @@ class ReferenceCounter : public ReferenceCounterInterface,
     std::string call_site = "<unknown>";
     /// Object size if known, otherwise -1;
     int64_t object_size = -1;
+    /// The object's owner's address, if we know it. If this process is the
+    /// owner, then this is added during creation of the Reference. If this is
+    /// process is a borrower, the borrower must add the owner's address before
+    /// using the ObjectID. The References of the objects of the same owner share
+    /// the address, see `ReferenceCounter::InternOwnerAddress`.
+    std::shared_ptr<const rpc::Address> owner_address;
+    /// If this object is owned by us and stored in plasma, and reference
+    /// counting is enabled, then some raylet must be pinning the object value.
+    /// This is the address of that raylet.
+    absl::optional<NodeID> pinned_at_raylet_id;
+    /// If this object is owned by us and stored in plasma, this contains all
+    /// object locations.
+    InlinedSet<NodeID, 2> locations;
+
+    /// The local ref count for the ObjectID in the language frontend.
+    size_t local_ref_count = 0;
+    /// The ref count for submitted tasks that depend on the ObjectID.
+    size_t submitted_task_ref_count = 0;
+    /// The number of tasks that depend on this object that may be retried in
+    /// the future (pending execution or finished but retryable). If the object
+    /// is inlined (not stored in plasma), then its lineage ref count is 0
+    /// because any dependent task will already have the value of the object.
+    size_t lineage_ref_count = 0;
+
+    /// Callback that will be called when this ObjectID no longer has
+    /// references.
+    std::function<void(const ObjectID &)> on_delete;
+    RareFieldsPtr rare_fields;
 
     /// Whether we own the object. If we own the object, then we are
     /// responsible for tracking the state of the task that creates the object
@@ -562,110 +707,271 @@ class ReferenceCounter : public ReferenceCounterInterface,
     /// metadata to the parent of the current task.
     /// See https://github.com/ray-project/ray/pull/19910 for more context.
     bool foreign_owner_already_monitoring = false;
-    /// The object's owner's address, if we know it. If this process is the
-    /// owner, then this is added during creation of the Reference. If this is
-    /// process is a borrower, the borrower must add the owner's address before
-    /// using the ObjectID.
-    absl::optional<rpc::Address> owner_address;
-    /// If this object is owned by us and stored in plasma, and reference
-    /// counting is enabled, then some raylet must be pinning the object value.
-    /// This is the address of that raylet.
-    absl::optional<NodeID> pinned_at_raylet_id;
-    /// If this object is owned by us and stored in plasma, this contains all
-    /// object locations.
-    absl::flat_hash_set<NodeID> locations;
     // Whether this object can be reconstructed via lineage. If false, then the
     // object's value will be pinned as long as it is referenced by any other
     // object's lineage. This should be set to false if the object was created
     // by ray.put(), a task that cannot be retried, or its lineage was evicted.
     bool is_reconstructable = false;
-
-    /// The local ref count for the ObjectID in the language frontend.
-    size_t local_ref_count = 0;
-    /// The ref count for submitted tasks that depend on the ObjectID.
-    size_t submitted_task_ref_count = 0;
-    /// Object IDs that we own and that contain this object ID.
-    /// ObjectIDs are added to this field when we discover that this object
-    /// contains other IDs. This can happen in 2 cases:
-    ///  1. We call ray.put() and store the inner ID(s) in the outer object.
-    ///  2. A task that we submitted returned an ID(s).
-    /// ObjectIDs are erased from this field when their Reference is deleted.
-    absl::flat_hash_set<ObjectID> contained_in_owned;
-    /// Object IDs that we borrowed and that contain this object ID.
-    /// ObjectIDs are added to this field when we get the value of an ObjectRef
-    /// (either by deserializing the object or receiving the GetObjectStatus
-    /// reply for inlined objects) and it contains another ObjectRef.
-    absl::flat_hash_set<ObjectID> contained_in_borrowed_ids;
-    /// Reverse pointer for contained_in_owned and contained_in_borrowed_ids.
-    /// The object IDs contained in this object. These could be objects that we
-    /// own or are borrowing. This field is updated in 2 cases:
-    ///  1. We call ray.put() on this ID and store the contained IDs.
-    ///  2. We call ray.get() on an ID whose contents we do not know and we
-    ///     discover that it contains these IDs.
-    absl::flat_hash_set<ObjectID> contains;
     /// ObjectRefs nested in this object that are or were in use. These objects
     /// are not owned by us, and we need to report that we are borrowing them
     /// to their owner. Nesting is transitive, so this flag is set as long as
     /// any child object is in scope.
     bool has_nested_refs_to_report = false;
-    /// A list of processes that are we gave a reference to that are still
-    /// borrowing the ID. This field is updated in 2 cases:
-    ///  1. If we are a borrower of the ID, then we add a process to this list
-    ///     if we passed that process a copy of the ID via task submission and
-    ///     the process is still using the ID by the time it finishes its task.
-    ///     Borrowers are removed from the list when we recursively merge our
-    ///     list into the owner.
-    ///  2. If we are the owner of the ID, then either the above case, or when
-    ///     we hear from a borrower that it has passed the ID to other
-    ///     borrowers. A borrower is removed from the list when it responds
-    ///     that it is no longer using the reference.
-    absl::flat_hash_set<rpc::WorkerAddress> borrowers;
-    /// When a process that is borrowing an object ID stores the ID inside the
-    /// return value of a task that it executes, the caller of the task is also
-    /// considered a borrower for as long as its reference to the task's return
-    /// ID stays in scope. Thus, the borrower must notify the owner that the
-    /// task's caller is also a borrower. The key is the task's return ID, and
-    /// the value is the task ID and address of the task's caller.
-    absl::flat_hash_map<ObjectID, rpc::WorkerAddress> stored_in_objects;
-    /// The number of tasks that depend on this object that may be retried in
-    /// the future (pending execution or finished but retryable). If the object
-    /// is inlined (not stored in plasma), then its lineage ref count is 0
-    /// because any dependent task will already have the value of the object.
-    size_t lineage_ref_count = 0;
     /// Whether the lineage of this object was evicted due to memory pressure.
     bool lineage_evicted = false;
     /// Whether this object has been spilled to external storage.
     bool spilled = false;
-    /// For objects that have been spilled to external storage, the URL from which
-    /// they can be retrieved.
-    std::string spilled_url = "";
-    /// The ID of the node that spilled the object.
-    /// This will be Nil if the object has not been spilled or if it is spilled
-    /// distributed external storage.
-    NodeID spilled_node_id = NodeID::Nil();
     /// Whether the task that creates this object is scheduled/executing.
     bool pending_creation = false;
-    /// Callback that will be called when this ObjectID no longer has
-    /// references.
-    std::function<void(const ObjectID &)> on_delete;
-    /// Callback that is called when this process is no longer a borrower
-    /// (RefCount() == 0).
-    std::function<void(const ObjectID &)> on_ref_removed;
   };
 
   using ReferenceTable = absl::flat_hash_map<ObjectID, Reference>;
 
+  /// The table of References, sharded by ObjectID. It has the interface of the
+  /// ReferenceTable that it's made of, and its iterators convert to the iterators of the
+  /// shards, which is what the helpers that use a single Reference take.
+  class ShardedReferenceTable {
+   public:
+    static constexpr size_t kNumShards = 16;
+
+    struct Shard {
+      /// Protects the shard while `ReferenceCounter::mutex_` is only held in shared
+      /// mode.
+      mutable absl::Mutex mutex;
+      ReferenceTable refs;
+    };
+    using Shards = std::array<Shard, kNumShards>;
+
+    template <typename ShardsType, typename ShardIterator>
+    class Iterator {
+     public:
+      Iterator(ShardsType *shards, size_t shard_index, ShardIterator it)
+          : shards_(shards), shard_index_(shard_index), it_(it) {
+        SkipEmptyShards();
+      }
+
+      operator ShardIterator() const { return it_; }
+      auto &operator*() const { return *it_; }
+      auto *operator->() const { return &*it_; }
+
+      Iterator &operator++() {
+        ++it_;
+        SkipEmptyShards();
+        return *this;
+      }
+
+      Iterator operator++(int) {
+        auto copy = *this;
+        ++*this;
+        return copy;
+      }
+
+      bool operator==(const Iterator &other) const {
+        return shard_index_ == other.shard_index_ &&
+               (shard_index_ == kNumShards || it_ == other.it_);
+      }
+
+      bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+     private:
+      /// Move to the next shard once the end of the current one is reached.
+      void SkipEmptyShards() {
+        while (shard_index_ < kNumShards && it_ == (*shards_)[shard_index_].refs.end()) {
+          if (++shard_index_ < kNumShards) {
+            it_ = (*shards_)[shard_index_].refs.begin();
+          }
+        }
+      }
+
+      ShardsType *shards_;
+      size_t shard_index_;
+      ShardIterator it_;
+    };
+
+    using iterator = Iterator<Shards, ReferenceTable::iterator>;
+    using const_iterator = Iterator<const Shards, ReferenceTable::const_iterator>;
+
+    static size_t ShardIndex(const ObjectID &object_id) {
+      return object_id.Hash() % kNumShards;
+    }
+
+    Shard &GetShard(const ObjectID &object_id) { return shards_[ShardIndex(object_id)]; }
+    const Shard &GetShard(const ObjectID &object_id) const {
+      return shards_[ShardIndex(object_id)];
+    }
+
+    iterator begin() { return iterator(&shards_, 0, shards_[0].refs.begin()); }
+    const_iterator begin() const {
+      return const_iterator(&shards_, 0, shards_[0].refs.begin());
+    }
+    iterator end() { return iterator(&shards_, kNumShards, {}); }
+    const_iterator end() const { return const_iterator(&shards_, kNumShards, {}); }
+
+    iterator find(const ObjectID &object_id) {
+      auto index = ShardIndex(object_id);
+      auto it = shards_[index].refs.find(object_id);
+      return it == shards_[index].refs.end() ? end() : iterator(&shards_, index, it);
+    }
+
+    const_iterator find(const ObjectID &object_id) const {
+      auto index = ShardIndex(object_id);
+      auto it = shards_[index].refs.find(object_id);
+      return it == shards_[index].refs.end() ? end()
+                                             : const_iterator(&shards_, index, it);
+    }
+
+    size_t count(const ObjectID &object_id) const {
+      return GetShard(object_id).refs.count(object_id);
+    }
+
+    std::pair<iterator, bool> emplace(const ObjectID &object_id, Reference reference) {
+      auto index = ShardIndex(object_id);
+      auto result = shards_[index].refs.emplace(object_id, std::move(reference));
+      return {iterator(&shards_, index, result.first), result.second};
+    }
+
+    void erase(ReferenceTable::iterator it) { GetShard(it->first).refs.erase(it); }
+
+    size_t size() const {
+      size_t size = 0;
+      for (const auto &shard : shards_) {
+        size += shard.refs.size();
+      }
+      return size;
+    }
+
+    bool empty() const {
+      for (const auto &shard : shards_) {
+        if (!shard.refs.empty()) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Lock the shard of an object and update the object in it.
+    ///
+    /// \param update Called with the shard's table and the object ID. It returns
+    /// whether the object was updated. The thread safety analysis checks it on its
+    /// own, so it must assert that `ReferenceCounter::mutex_` is held with
+    /// `AssertReaderHeld` before it calls the helpers that require it.
+    /// \return Whether the object was updated.
+    template <typename Update>
+    bool TryUpdate(const ObjectID &object_id, const Update &update) {
+      auto &shard = GetShard(object_id);
+      absl::MutexLock lock(&shard.mutex);
+      return update(shard.refs, object_id);
+    }
+
+    /// Update a batch of objects, locking each of their shards only once.
+    ///
+    /// \param update Called with the shard's table and the object ID of each object, as
+    /// for TryUpdate. It returns whether the object was updated.
+    /// \param[out] not_updated The objects that weren't updated, in the order they
+    /// are in `object_ids`.
+    template <typename Update>
+    void TryUpdateEach(const std::vector<ObjectID> &object_ids, const Update &update,
+                       std::vector<ObjectID> *not_updated) {
+      absl::InlinedVector<size_t, 8> shard_indices;
+      std::bitset<kNumShards> shards_to_update;
+      for (const auto &object_id : object_ids) {
+        shard_indices.push_back(ShardIndex(object_id));
+        shards_to_update.set(shard_indices.back());
+      }
+      absl::InlinedVector<bool, 8> updated(object_ids.size(), false);
+      for (size_t index = 0; index < kNumShards; index++) {
+        if (!shards_to_update.test(index)) {
+          continue;
+        }
+        auto &shard = shards_[index];
+        absl::MutexLock lock(&shard.mutex);
+        for (size_t i = 0; i < object_ids.size(); i++) {
+          if (shard_indices[i] == index) {
+            updated[i] = update(shard.refs, object_ids[i]);
+          }
+        }
+      }
+      for (size_t i = 0; i < object_ids.size(); i++) {
+        if (!updated[i]) {
+          not_updated->push_back(object_ids[i]);
+        }
+      }
+    }
+
+   private:
+    Shards shards_;
+  };
+
+  /// The count updates that can be made while holding `mutex_` in shared mode and the
+  /// lock of the object's shard, because they only touch the object's Reference, and
+  /// delete it only if CanDeleteInShard. Each returns false, without changing
+  /// anything, if the update needs more than that, in which case it must be made while
+  /// holding `mutex_`.
+  ///
+  /// \param refs The table of the object's shard.
+  /// \param[out] deleted The object is added if its value was released.
+  /// \param[out] lineage_argument_ids The arguments whose lineage the caller must
+  /// release with ReleaseArgumentsLineage, because the object's Reference was erased.
+  bool TryAddLocalReference(ReferenceTable &refs, const ObjectID &object_id,
+                            const std::string &call_site) SHARED_LOCKS_REQUIRED(mutex_);
+  bool TryRemoveLocalReference(ReferenceTable &refs, const ObjectID &object_id,
+                               std::vector<ObjectID> *deleted,
+                               std::vector<ObjectID> *lineage_argument_ids)
+      SHARED_LOCKS_REQUIRED(mutex_);
+  bool TryAddSubmittedTaskReference(ReferenceTable &refs, const ObjectID &object_id)
+      SHARED_LOCKS_REQUIRED(mutex_);
+  bool TryRemoveSubmittedTaskReference(ReferenceTable &refs, const ObjectID &object_id,
+                                       bool release_lineage,
+                                       std::vector<ObjectID> *deleted,
+                                       std::vector<ObjectID> *lineage_argument_ids)
+      SHARED_LOCKS_REQUIRED(mutex_);
+
+  /// Whether the Reference can be deleted while holding only `mutex_` in shared mode
+  /// and the lock of its shard, once it has no references left. That's the case if no
+  /// other Reference points to it and it has none of the rare fields.
+  bool CanDeleteInShard(ReferenceTable::iterator it) const SHARED_LOCKS_REQUIRED(mutex_);
+
+  /// The part of DeleteReferenceInternal for a Reference that CanDeleteInShard.
+  ///
+  /// \param refs The table of the Reference's shard.
+  void DeleteReferenceInShard(ReferenceTable &refs, ReferenceTable::iterator it,
+                              std::vector<ObjectID> *deleted,
+                              std::vector<ObjectID> *lineage_argument_ids)
+      SHARED_LOCKS_REQUIRED(mutex_);
+
+  /// Add the Reference of a new object that we own, see AddOwnedObject. If `mutex_` is
+  /// only held in shared mode, the lock of the object's shard must be held too.
+  ///
+  /// \param refs The table of the object's shard.
+  void AddOwnedReference(ReferenceTable &refs, const ObjectID &object_id,
+                         const rpc::Address &owner_address, const std::string &call_site,
+                         const int64_t object_size, bool is_reconstructable,
+                         bool add_local_ref,
+                         const absl::optional<NodeID> &pinned_at_raylet_id)
+      SHARED_LOCKS_REQUIRED(mutex_);
+
+  /// Remove the object from the queue of objects whose lineage may be evicted.
+  void EraseReconstructableOwnedObject(const ObjectID &object_id)
+      LOCKS_EXCLUDED(owned_objects_mutex_);
+
   void SetNestedRefInUseRecursive(ReferenceTable::iterator inner_ref_it)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// If `mutex_` is only held in shared mode, the lock of the object's shard must be
+  /// held too.
   bool GetOwnerInternal(const ObjectID &object_id,
                         rpc::Address *owner_address = nullptr) const
-      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+      SHARED_LOCKS_REQUIRED(mutex_);
 
   /// Release the pinned plasma object, if any. Also unsets the raylet address
   /// that the object was pinned at, if the address was set.
   void ReleasePlasmaObject(ReferenceTable::iterator it);
 
+  /// Intern the address of an owner, so that the References of the objects of the
+  /// same owner share one copy of it.
+  std::shared_ptr<const rpc::Address> InternOwnerAddress(
+      const rpc::Address &owner_address) LOCKS_EXCLUDED(owned_objects_mutex_);
+
   /// Shutdown if all references have gone out of scope and shutdown
   /// is scheduled.
   void ShutdownIfNeeded() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -748,11 +1054,30 @@ class ReferenceCounter : public ReferenceCounterInterface,
   /// ID. This is used in cases where we return an object ID that we own inside
   /// an object that we do not own. Then, we must notify the owner of the outer
   /// object that they are borrowing the inner.
+  ///
+  /// The waits added by one update are only sent by FlushRefRemovedWaits, which
+  /// coalesces the waits on objects created by the same task into one subscription.
   void WaitForRefRemoved(const ReferenceTable::iterator &reference_it,
                          const rpc::WorkerAddress &addr,
                          const ObjectID &contained_in_id = ObjectID::Nil())
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Send the waits added by WaitForRefRemoved. This must be called at the end of every
+  /// update that may add a borrower to an object that we own.
+  void FlushRefRemovedWaits() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Subscribe to the removal of one object by a borrower.
+  void SubscribeRefRemoved(const ObjectID &object_id, const rpc::WorkerAddress &addr,
+                           const ObjectID &contained_in_id)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Subscribe to the removal of a batch of objects created by the same task by a
+  /// borrower.
+  void SubscribeRefsRemoved(const std::vector<ObjectID> &object_ids,
+                            const rpc::WorkerAddress &addr,
+                            const ObjectID &contained_in_id)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Helper method to add an object that we are borrowing. This is used when
   /// deserializing IDs from a task's arguments, or when deserializing an ID
   /// during ray.get().
@@ -781,13 +1106,19 @@ class ReferenceCounter : public ReferenceCounterInterface,
   int64_t ReleaseLineageReferences(ReferenceTable::iterator entry)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Release the lineage ref that a released task held on each of its arguments,
+  /// garbage-collecting the lineage of the arguments that are no longer referenced.
+  int64_t ReleaseArgumentsLineage(const std::vector<ObjectID> &argument_ids)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Add a new location for the given object. The owner must have the object ref in
-  /// scope, and the caller must have already acquired mutex_.
+  /// scope, and the caller must have already acquired mutex_. If `mutex_` is only held
+  /// in shared mode, the lock of the object's shard must be held too.
   ///
   /// \param[in] it The reference iterator for the object.
   /// \param[in] node_id The new object location to be added.
   void AddObjectLocationInternal(ReferenceTable::iterator it, const NodeID &node_id)
-      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+      SHARED_LOCKS_REQUIRED(mutex_);
 
   /// Remove a location for the given object. The owner must have the object ref in
   /// scope, and the caller must have already acquired mutex_.
@@ -797,19 +1128,32 @@ class ReferenceCounter : public ReferenceCounterInterface,
   void RemoveObjectLocationInternal(ReferenceTable::iterator it, const NodeID &node_id)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
-  void UpdateObjectPendingCreation(const ObjectID &object_id, bool pending_creation)
-      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  /// If `mutex_` is only held in shared mode, the lock of the object's shard must be
+  /// held too.
+  ///
+  /// \param refs The table of the object's shard.
+  /// \return Always true, so that it can be used as an update of the shard.
+  bool UpdateObjectPendingCreation(ReferenceTable &refs, const ObjectID &object_id,
+                                   bool pending_creation) SHARED_LOCKS_REQUIRED(mutex_);
+
+  /// Update the object's entry in `locality_index_` after its size or locations
+  /// changed. If `mutex_` is only held in shared mode, the lock of the object's shard
+  /// must be held too.
+  ///
+  /// \param[in] it The reference iterator for the object.
+  void UpdateLocalityIndex(ReferenceTable::iterator it) SHARED_LOCKS_REQUIRED(mutex_);
 
-  /// Publish object locations to all subscribers.
+  /// Publish object locations to all subscribers. If `mutex_` is only held in shared
+  /// mode, the lock of the object's shard must be held too.
   ///
   /// \param[in] it The reference iterator for the object.
   void PushToLocationSubscribers(ReferenceTable::iterator it)
-      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+      SHARED_LOCKS_REQUIRED(mutex_);
 
   /// Fill up the object information for the given iterator.
   void FillObjectInformationInternal(ReferenceTable::iterator it,
                                      rpc::WorkerObjectLocationsPubMessage *object_info)
-      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+      SHARED_LOCKS_REQUIRED(mutex_);
 
   /// Clean up borrowers and references when the reference is removed from borrowers.
   /// It should be used as a WaitForRefRemoved callback.
@@ -817,6 +1161,39 @@ class ReferenceCounter : public ReferenceCounterInterface,
                                     const ObjectID &object_id,
                                     const rpc::WorkerAddress &borrower_addr);
 
+  /// Like CleanupBorrowersOnRefRemoved, for the objects of a batch subscription. The
+  /// objects that were already removed are ignored.
+  ///
+  /// \param[in] removed_ids The removed objects, or nullptr if the borrower failed and
+  /// every object of the batch is removed.
+  /// \return True if every object of the batch is removed, and it must be unsubscribed.
+  bool CleanupBorrowersOnRefsRemoved(const ReferenceTable &new_borrower_refs,
+                                     const std::string &batch_key,
+                                     const std::vector<ObjectID> *removed_ids,
+                                     const rpc::WorkerAddress &borrower_addr)
+      LOCKS_EXCLUDED(mutex_);
+
+  /// SetRefRemovedCallback without taking the lock.
+  void SetRefRemovedCallbackInternal(
+      const ObjectID &object_id, const ObjectID &contained_in_id,
+      const rpc::Address &owner_address,
+      const ReferenceRemovedCallback &ref_removed_callback)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Record that we stopped borrowing an object of a batch, and publish it or schedule
+  /// it to be published.
+  void HandleRefRemovedInBatch(const std::string &batch_key, const ObjectID &object_id)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Publish the objects of batches that we stopped borrowing and that aren't published
+  /// yet.
+  void PublishRefsRemovedInternal() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Merge the borrowed refs returned by GetAndClearLocalBorrowersInternal into refs
+  /// that were returned earlier. A ref in both keeps its latest counts, and the
+  /// borrowers of both, since they were cleared from our table.
+  static void MergeBorrowedRefs(ReferenceTable &&from, ReferenceTable *to);
+
   /// Decrease the local reference count for the ObjectID by one.
   /// This method is internal and not thread-safe. mutex_ lock must be held before
   /// calling this method.
@@ -843,11 +1220,67 @@ class ReferenceCounter : public ReferenceCounterInterface,
   /// borrower's ref count for the ID goes to 0.
   rpc::CoreWorkerClientPool borrower_pool_;
 
-  /// Protects access to the reference counting state.
+  /// Protects access to the reference counting state. While it is held exclusively,
+  /// every shard of `object_id_refs_` can be used without locking it. The count updates
+  /// that only touch one Reference, and the reads of one Reference, hold it in shared
+  /// mode plus the lock of the Reference's shard, so that they run in parallel with the
+  /// ones in other shards.
   mutable absl::Mutex mutex_;
 
   /// Holds all reference counts and dependency information for tracked ObjectIDs.
-  ReferenceTable object_id_refs_ GUARDED_BY(mutex_);
+  ShardedReferenceTable object_id_refs_ GUARDED_BY(mutex_);
+
+  /// The size and locations of the objects in `object_id_refs_` whose size is known.
+  /// It has its own locks, so that it can be read without `mutex_`.
+  LocalityDataIndex locality_index_;
+
+  /// Protects the state that the References of different shards share, so that owned
+  /// objects can be added and deleted in their shard. It's acquired after `mutex_` and
+  /// the lock of a shard.
+  mutable absl::Mutex owned_objects_mutex_ ACQUIRED_AFTER(mutex_);
+
+  /// The owner addresses that References share, see `InternOwnerAddress`.
+  absl::flat_hash_map<rpc::WorkerAddress, std::shared_ptr<const rpc::Address>>
+      owner_addresses_ GUARDED_BY(owned_objects_mutex_);
+  static constexpr size_t kMinOwnerAddressesGcThreshold = 1024;
+  /// The number of interned owner addresses at which the ones that no Reference uses
+  /// anymore are dropped.
+  size_t owner_addresses_gc_threshold_ GUARDED_BY(owned_objects_mutex_) =
+      kMinOwnerAddressesGcThreshold;
+
+  /// A borrower that we wait on to stop borrowing an object, see WaitForRefRemoved.
+  struct RefRemovedWait {
+    ObjectID object_id;
+    rpc::WorkerAddress borrower_address;
+    ObjectID contained_in_id;
+  };
+  /// The waits added by the current update, which aren't sent yet.
+  std::vector<RefRemovedWait> ref_removed_waits_ GUARDED_BY(mutex_);
+  /// The objects of each batch subscription that the borrower hasn't stopped borrowing
+  /// yet, by the key of the subscription.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<ObjectID>> waited_ref_batches_
+      GUARDED_BY(mutex_);
+  /// The sequence number of the last batch subscription, which makes its key unique.
+  uint64_t last_ref_batch_seq_no_ GUARDED_BY(mutex_) = 0;
+
+  /// A batch of objects that we borrow and that the owner waits for in one
+  /// subscription, see SetRefsRemovedCallback.
+  struct BorrowedRefBatch {
+    /// The number of objects of the batch that we still borrow.
+    size_t num_borrowed = 0;
+    /// The objects that we stopped borrowing since the last message was published.
+    std::vector<ObjectID> removed;
+    /// The borrowed refs of the removed objects.
+    ReferenceTable borrowed_refs;
+  };
+  /// The batches that we borrow, by the key of the owner's subscription.
+  absl::flat_hash_map<std::string, BorrowedRefBatch> borrowed_ref_batches_
+      GUARDED_BY(mutex_);
+  /// The keys of the batches with removed objects that aren't published yet.
+  absl::flat_hash_set<std::string> borrowed_ref_batches_to_publish_ GUARDED_BY(mutex_);
+  /// Schedules a call to FlushRefsRemoved, see SetRefsRemovedFlushScheduler.
+  std::function<void()> schedule_refs_removed_flush_;
+  bool refs_removed_flush_scheduled_ GUARDED_BY(mutex_) = false;
 
   /// Objects whose values have been freed by the language frontend.
   /// The values in plasma will not be pinned. An object ID is
@@ -877,13 +1310,13 @@ class ReferenceCounter : public ReferenceCounterInterface,
   /// that may be reconstructed. These objects may have pinned lineage that
   /// should be evicted on memory pressure. The queue is in FIFO order, based
   /// on ObjectRef creation time.
-  std::list<ObjectID> reconstructable_owned_objects_ GUARDED_BY(mutex_);
+  std::list<ObjectID> reconstructable_owned_objects_ GUARDED_BY(owned_objects_mutex_);
 
   /// We keep a FIFO queue of objects in scope so that we can choose lineage to
   /// evict under memory pressure. This is an index from ObjectID to the
   /// object's place in the queue.
   absl::flat_hash_map<ObjectID, std::list<ObjectID>::iterator>
-      reconstructable_owned_objects_index_ GUARDED_BY(mutex_);
+      reconstructable_owned_objects_index_ GUARDED_BY(owned_objects_mutex_);
 
   /// Called to check whether a raylet is still alive. This is used when adding
   /// the primary or spilled location of an object. If the node is dead, then
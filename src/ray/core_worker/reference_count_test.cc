@@ -14,6 +14,10 @@
 
 #include "ray/core_worker/reference_count.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
 #include <vector>
 
 #include "absl/functional/bind_front.h"
@@ -87,10 +91,12 @@ class ReferenceCountLineageEnabledTest : public ::testing::Test {
 class MockDistributedSubscriber;
 class MockDistributedPublisher;
 
+// The callbacks are keyed by the key that is subscribed, which is either an object ID
+// or the key of a batch of objects.
 using ObjectToCallbackMap =
-    std::unordered_map<ObjectID, pubsub::SubscriptionItemCallback>;
+    std::unordered_map<std::string, pubsub::SubscriptionItemCallback>;
 using ObjectToFailureCallbackMap =
-    std::unordered_map<ObjectID, pubsub::SubscriptionFailureCallback>;
+    std::unordered_map<std::string, pubsub::SubscriptionFailureCallback>;
 using SubscriptionCallbackMap = std::unordered_map<std::string, ObjectToCallbackMap>;
 using SubscriptionFailureCallbackMap =
     std::unordered_map<std::string, ObjectToFailureCallbackMap>;
@@ -109,6 +115,8 @@ class MockCoreWorkerClientInterface : public rpc::CoreWorkerClientInterface {
   ~MockCoreWorkerClientInterface() = default;
   virtual void WaitForRefRemoved(const ObjectID object_id, const ObjectID contained_in_id,
                                  rpc::Address owner_address) = 0;
+  virtual void WaitForRefsRemoved(const std::string &batch_key,
+                                  const rpc::WorkerRefsRemovedSubMessage &message) = 0;
 };
 
 using PublisherFactoryFn =
@@ -136,15 +144,23 @@ class MockDistributedSubscriber : public pubsub::SubscriberInterface {
       pubsub::SubscribeDoneCallback subscribe_done_callback,
       pubsub::SubscriptionItemCallback subscription_callback,
       pubsub::SubscriptionFailureCallback subscription_failure_callback) override {
-    const auto &request = sub_message->worker_ref_removed_message();
     // Register the borrower callback first. It will be flushable by
     // FlushBorrowerCallbacks from mock core worker client.
-    const auto object_id = ObjectID::FromBinary(request.reference().object_id());
-    const auto contained_in_id = ObjectID::FromBinary(request.contained_in_id());
-    const auto owner_address = request.reference().owner_address();
-    if (client_factory_) {
-      client_factory_(publisher_address)
-          ->WaitForRefRemoved(object_id, contained_in_id, owner_address);
+    if (sub_message->has_worker_refs_removed_message()) {
+      if (client_factory_) {
+        client_factory_(publisher_address)
+            ->WaitForRefsRemoved(key_id_binary,
+                                 sub_message->worker_refs_removed_message());
+      }
+    } else {
+      const auto &request = sub_message->worker_ref_removed_message();
+      const auto object_id = ObjectID::FromBinary(request.reference().object_id());
+      const auto contained_in_id = ObjectID::FromBinary(request.contained_in_id());
+      const auto owner_address = request.reference().owner_address();
+      if (client_factory_) {
+        client_factory_(publisher_address)
+            ->WaitForRefRemoved(object_id, contained_in_id, owner_address);
+      }
     }
     // Due to the test env, there are times that the same message id from the same
     // subscriber is subscribed twice. We should just no-op in this case.
@@ -166,9 +182,10 @@ class MockDistributedSubscriber : public pubsub::SubscriberInterface {
               .first;
     }
 
-    const auto oid = ObjectID::FromBinary(key_id_binary);
-    callback_it->second.emplace(oid, subscription_callback);
-    return failure_callback_it->second.emplace(oid, subscription_failure_callback).second;
+    callback_it->second.emplace(key_id_binary, subscription_callback);
+    return failure_callback_it->second
+        .emplace(key_id_binary, subscription_failure_callback)
+        .second;
   }
 
   bool SubscribeChannel(
@@ -240,12 +257,11 @@ class MockDistributedPublisher : public pubsub::PublisherInterface {
       return;
     }
     const auto subscribers = directory_->GetSubscriberIdsByKeyId(pub_message.key_id());
-    const auto oid = ObjectID::FromBinary(pub_message.key_id());
     for (const auto &subscriber_id : subscribers) {
       const auto id = GenerateID(publisher_id_, subscriber_id);
       const auto it = subscription_callback_map_->find(id);
       if (it != subscription_callback_map_->end()) {
-        const auto callback_it = it->second.find(oid);
+        const auto callback_it = it->second.find(pub_message.key_id());
         RAY_CHECK(callback_it != it->second.end());
         callback_it->second(pub_message);
       }
@@ -309,6 +325,14 @@ class MockWorkerClient : public MockCoreWorkerClientInterface {
     num_requests_++;
   }
 
+  void WaitForRefsRemoved(const std::string &batch_key,
+                          const rpc::WorkerRefsRemovedSubMessage &message) override {
+    borrower_callbacks_[num_requests_] = [this, batch_key, message]() {
+      rc_.SetRefsRemovedCallback(batch_key, message);
+    };
+    num_requests_++;
+  }
+
   bool FlushBorrowerCallbacks() {
     // Flush all the borrower callbacks. This means that after this function is invoked,
     // all of ref_counts will be tracked.
@@ -326,16 +350,22 @@ class MockWorkerClient : public MockCoreWorkerClientInterface {
   }
 
   void FailAllWaitForRefRemovedRequests() {
-    // Invoke all failure callbacks so that we can simulate the borrower failure scenario.
-    for (const auto &it : subscription_failure_callback_map) {
-      auto &callback_map = it.second;
-      for (const auto &callback_it : callback_map) {
-        const auto object_id = callback_it.first;
+    // Invoke the failure callbacks of the requests sent to this worker so that we can
+    // simulate the borrower failure scenario. The callbacks of requests sent to other
+    // workers are left alone, since their subscribers may be gone.
+    for (auto it = subscription_failure_callback_map.begin();
+         it != subscription_failure_callback_map.end();) {
+      if (it->first.compare(0, address_.worker_id().size(), address_.worker_id()) != 0) {
+        it++;
+        continue;
+      }
+      for (const auto &callback_it : it->second) {
+        const auto &key_id = callback_it.first;
         const auto failure_callback = callback_it.second;
-        failure_callback(object_id.Binary(), Status::UnknownError("Test failure"));
+        failure_callback(key_id, Status::UnknownError("Test failure"));
       }
+      subscription_failure_callback_map.erase(it++);
     }
-    subscription_failure_callback_map.clear();
     failed_ = true;
   }
 
@@ -921,6 +951,135 @@ TEST(DistributedReferenceCountTest, TestSimpleBorrowerFailure) {
   ASSERT_FALSE(owner->rc_.HasReference(outer_id));
 }
 
+// A borrower is given references to many objects created by the same task, and
+// keeps them past the task's lifetime. The owner waits for all of them in one
+// subscription, and the borrower publishes the ones that it removes in a burst in
+// one message.
+//
+// @ray.remote
+// class Borrower:
+//     def __init__(self, inner_ids):
+//        self.inner_ids = inner_ids
+//
+// inner_ids = [ray.put(i) for i in range(10)]
+// outer_id = ray.put(inner_ids)
+// res = Borrower.remote(outer_id)
+TEST(DistributedReferenceCountTest, TestBatchedBorrowerReferenceRemoved) {
+  auto borrower = std::make_shared<MockWorkerClient>("1");
+  auto owner = std::make_shared<MockWorkerClient>(
+      "2", [&](const rpc::Address &addr) { return borrower; });
+  int num_flushes_scheduled = 0;
+  borrower->rc_.SetRefsRemovedFlushScheduler(
+      [&num_flushes_scheduled]() { num_flushes_scheduled++; });
+
+  // The owner creates the inner objects, with a gap in their indices, and wraps them.
+  const auto task_id = TaskID::ForDriverTask(JobID::FromInt(1));
+  std::vector<ObjectID> inner_ids;
+  for (int i = 1; i <= 11; i++) {
+    if (i != 5) {
+      inner_ids.push_back(ObjectID::FromIndex(task_id, i));
+    }
+  }
+  auto outer_id = ObjectID::FromRandom();
+  for (const auto &inner_id : inner_ids) {
+    owner->Put(inner_id);
+  }
+  owner->rc_.AddOwnedObject(outer_id, inner_ids, owner->address_, "", 0, false,
+                            /*add_local_ref=*/true);
+
+  // The owner submits a task that depends on the outer object, and its references go
+  // out of scope.
+  auto return_id = owner->SubmitTaskWithArg(outer_id);
+  owner->rc_.RemoveLocalReference(outer_id, nullptr);
+  for (const auto &inner_id : inner_ids) {
+    owner->rc_.RemoveLocalReference(inner_id, nullptr);
+  }
+
+  // The borrower is given references to the inner objects and keeps them.
+  borrower->rc_.AddLocalReference(outer_id, "");
+  for (const auto &inner_id : inner_ids) {
+    borrower->GetSerializedObjectId(outer_id, inner_id, owner->address_);
+  }
+  auto borrower_refs = borrower->FinishExecutingTask(outer_id, ObjectID::Nil());
+
+  // The owner merges the borrower's ref counts, and waits for all of the inner
+  // objects in one request.
+  owner->HandleSubmittedTaskFinished(return_id, outer_id, {}, borrower->address_,
+                                     borrower_refs);
+  ASSERT_EQ(borrower->num_requests_, 1);
+  ASSERT_TRUE(borrower->FlushBorrowerCallbacks());
+  ASSERT_FALSE(owner->rc_.HasReference(outer_id));
+  for (const auto &inner_id : inner_ids) {
+    ASSERT_TRUE(owner->rc_.HasReference(inner_id));
+  }
+
+  // The borrower removes half of the references. They are published together once
+  // the scheduled flush runs.
+  for (size_t i = 0; i < inner_ids.size() / 2; i++) {
+    borrower->rc_.RemoveLocalReference(inner_ids[i], nullptr);
+  }
+  ASSERT_EQ(num_flushes_scheduled, 1);
+  ASSERT_TRUE(owner->rc_.HasReference(inner_ids.front()));
+  borrower->rc_.FlushRefsRemoved();
+  for (size_t i = 0; i < inner_ids.size(); i++) {
+    ASSERT_EQ(owner->rc_.HasReference(inner_ids[i]), i >= inner_ids.size() / 2);
+  }
+
+  // The borrower removes the rest of the references.
+  for (size_t i = inner_ids.size() / 2; i < inner_ids.size(); i++) {
+    borrower->rc_.RemoveLocalReference(inner_ids[i], nullptr);
+  }
+  ASSERT_EQ(num_flushes_scheduled, 2);
+  borrower->rc_.FlushRefsRemoved();
+  for (const auto &inner_id : inner_ids) {
+    ASSERT_FALSE(owner->rc_.HasReference(inner_id));
+    ASSERT_FALSE(borrower->rc_.HasReference(inner_id));
+  }
+}
+
+// Same as above, but the borrower fails while it borrows the batch.
+TEST(DistributedReferenceCountTest, TestBatchedBorrowerFailure) {
+  auto borrower = std::make_shared<MockWorkerClient>("1");
+  auto owner = std::make_shared<MockWorkerClient>(
+      "2", [&](const rpc::Address &addr) { return borrower; });
+
+  const auto task_id = TaskID::ForDriverTask(JobID::FromInt(1));
+  std::vector<ObjectID> inner_ids;
+  for (int i = 1; i <= 10; i++) {
+    inner_ids.push_back(ObjectID::FromIndex(task_id, i));
+  }
+  auto outer_id = ObjectID::FromRandom();
+  for (const auto &inner_id : inner_ids) {
+    owner->Put(inner_id);
+  }
+  owner->rc_.AddOwnedObject(outer_id, inner_ids, owner->address_, "", 0, false,
+                            /*add_local_ref=*/true);
+  auto return_id = owner->SubmitTaskWithArg(outer_id);
+  owner->rc_.RemoveLocalReference(outer_id, nullptr);
+  for (const auto &inner_id : inner_ids) {
+    owner->rc_.RemoveLocalReference(inner_id, nullptr);
+  }
+
+  borrower->rc_.AddLocalReference(outer_id, "");
+  for (const auto &inner_id : inner_ids) {
+    borrower->GetSerializedObjectId(outer_id, inner_id, owner->address_);
+  }
+  auto borrower_refs = borrower->FinishExecutingTask(outer_id, ObjectID::Nil());
+  owner->HandleSubmittedTaskFinished(return_id, outer_id, {}, borrower->address_,
+                                     borrower_refs);
+  ASSERT_EQ(borrower->num_requests_, 1);
+  ASSERT_TRUE(borrower->FlushBorrowerCallbacks());
+  // The borrower removes one of the references before it fails.
+  borrower->rc_.RemoveLocalReference(inner_ids.front(), nullptr);
+  ASSERT_FALSE(owner->rc_.HasReference(inner_ids.front()));
+
+  // The borrower fails. The owner's ref count should go to 0 for the whole batch.
+  borrower->FailAllWaitForRefRemovedRequests();
+  for (const auto &inner_id : inner_ids) {
+    ASSERT_FALSE(owner->rc_.HasReference(inner_id));
+  }
+}
+
 // A borrower is given a reference to an object ID, keeps the reference past
 // the task's lifetime, then deletes the reference before it hears from the
 // owner.
@@ -2776,6 +2935,198 @@ TEST_F(ReferenceCountTest, TestForwardNestedRefs) {
   borrower2->rc_.RemoveLocalReference(inner_id, nullptr);
 }
 
+// Tests that concurrent count updates, which are made shard by shard while the
+// references stay in scope and on the whole table otherwise, don't lose any update.
+TEST_F(ReferenceCountTest, TestConcurrentUpdates) {
+  const int num_threads = 8;
+  const int num_iterations = 2000;
+  std::vector<ObjectID> held_ids;
+  for (int i = 0; i < 16; i++) {
+    held_ids.push_back(ObjectID::FromRandom());
+    rc->AddLocalReference(held_ids.back(), "");
+  }
+  std::vector<ObjectID> shared_ids;
+  for (int i = 0; i < 4; i++) {
+    shared_ids.push_back(ObjectID::FromRandom());
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<ObjectID> deleted;
+      for (int i = 0; i < num_iterations; i++) {
+        const auto &held_id = held_ids[(t + i) % held_ids.size()];
+        const auto &shared_id = shared_ids[i % shared_ids.size()];
+        rc->AddLocalReference(held_id, "");
+        rc->AddLocalReference(shared_id, "");
+        rc->UpdateSubmittedTaskReferences({}, {held_id, shared_id});
+        rc->RemoveLocalReference(held_id, &deleted);
+        rc->RemoveLocalReference(shared_id, &deleted);
+        rc->UpdateFinishedTaskReferences({}, {held_id, shared_id}, false, empty_borrower,
+                                         empty_refs, &deleted);
+      }
+      for (const auto &id : deleted) {
+        ASSERT_TRUE(std::find(held_ids.begin(), held_ids.end(), id) == held_ids.end());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto counts = rc->GetAllReferenceCounts();
+  ASSERT_EQ(counts.size(), held_ids.size());
+  for (const auto &id : held_ids) {
+    ASSERT_EQ(counts[id].first, 1);
+    ASSERT_EQ(counts[id].second, 0);
+  }
+  std::vector<ObjectID> deleted;
+  for (const auto &id : held_ids) {
+    rc->RemoveLocalReference(id, &deleted);
+  }
+  ASSERT_EQ(deleted.size(), held_ids.size());
+}
+
+TEST_F(ReferenceCountTest, BenchmarkConcurrentUpdates) {
+  const int num_iterations = 200000;
+  for (int num_threads : {1, 2, 4, 8}) {
+    // Every thread updates the counts of its own objects, which stay in scope.
+    std::vector<std::vector<ObjectID>> thread_ids(num_threads);
+    for (auto &ids : thread_ids) {
+      for (int i = 0; i < 100; i++) {
+        ids.push_back(ObjectID::FromRandom());
+        rc->AddLocalReference(ids.back(), "");
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (const auto &ids : thread_ids) {
+      threads.emplace_back([&]() {
+        for (int i = 0; i < num_iterations; i++) {
+          const auto &id = ids[i % ids.size()];
+          rc->AddLocalReference(id, "");
+          rc->RemoveLocalReference(id, nullptr);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    RAY_LOG(INFO) << num_threads << " threads: "
+                  << 2.0 * num_iterations * num_threads / elapsed_us
+                  << " million count updates per second.";
+    for (const auto &ids : thread_ids) {
+      for (const auto &id : ids) {
+        rc->RemoveLocalReference(id, nullptr);
+      }
+    }
+  }
+}
+
+TEST_F(ReferenceCountTest, BenchmarkCreateUseDrop) {
+  EXPECT_CALL(*publisher_, PublishFailure(::testing::_, ::testing::_))
+      .Times(::testing::AnyNumber());
+  const int num_objects = 100000;
+  rpc::Address owner_address;
+  owner_address.set_worker_id(WorkerID::FromRandom().Binary());
+  for (int num_threads : {1, 2, 4, 8}) {
+    // Every thread creates its own objects, uses each of them once and drops them.
+    std::vector<std::vector<ObjectID>> thread_ids(num_threads);
+    for (auto &ids : thread_ids) {
+      for (int i = 0; i < num_objects; i++) {
+        ids.push_back(ObjectID::FromRandom());
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (const auto &ids : thread_ids) {
+      threads.emplace_back([&]() {
+        for (const auto &id : ids) {
+          rc->AddOwnedObject(id, {}, owner_address, "", 100, /*is_reconstructable=*/true,
+                             /*add_local_ref=*/true);
+          rc->AddLocalReference(id, "");
+          rc->RemoveLocalReference(id, nullptr);
+          rc->RemoveLocalReference(id, nullptr);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    RAY_LOG(INFO) << num_threads << " threads: "
+                  << 1.0 * num_objects * num_threads / elapsed_us
+                  << " million objects created, used and dropped per second.";
+    ASSERT_EQ(rc->NumObjectIDsInScope(), 0);
+  }
+}
+
+/// The resident memory of this process, or 0 if it isn't known.
+static int64_t ResidentMemoryBytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::stoll(line.substr(6)) * 1024;
+    }
+  }
+  return 0;
+}
+
+// Measures the resident memory per tracked object, which includes its Reference, its
+// entry in the locality index and its share of the interned owner addresses.
+TEST_F(ReferenceCountTest, BenchmarkMemoryPerReference) {
+  EXPECT_CALL(*publisher_, Publish(::testing::_)).Times(::testing::AnyNumber());
+  EXPECT_CALL(*publisher_, PublishFailure(::testing::_, ::testing::_))
+      .Times(::testing::AnyNumber());
+  const int num_refs = 200000;
+  rpc::Address owner_address;
+  owner_address.set_raylet_id(NodeID::FromRandom().Binary());
+  owner_address.set_ip_address("10.0.0.1");
+  owner_address.set_port(10001);
+  owner_address.set_worker_id(WorkerID::FromRandom().Binary());
+  rpc::Address borrowed_owner_address = owner_address;
+  borrowed_owner_address.set_worker_id(WorkerID::FromRandom().Binary());
+  const auto node_id = NodeID::FromRandom();
+
+  std::vector<ObjectID> owned_ids;
+  std::vector<ObjectID> borrowed_ids;
+  for (int i = 0; i < num_refs; i++) {
+    owned_ids.push_back(ObjectID::FromRandom());
+    borrowed_ids.push_back(ObjectID::FromRandom());
+  }
+
+  auto start_bytes = ResidentMemoryBytes();
+  for (const auto &id : owned_ids) {
+    rc->AddOwnedObject(id, {}, owner_address, "", 100, /*is_reconstructable=*/true,
+                       /*add_local_ref=*/true);
+    rc->AddObjectLocation(id, node_id);
+  }
+  auto owned_bytes = ResidentMemoryBytes();
+  for (const auto &id : borrowed_ids) {
+    rc->AddLocalReference(id, "");
+    rc->AddBorrowedObject(id, ObjectID::Nil(), borrowed_owner_address);
+  }
+  auto borrowed_bytes = ResidentMemoryBytes();
+  if (start_bytes > 0) {
+    RAY_LOG(INFO) << "Owned references: " << (owned_bytes - start_bytes) / num_refs
+                  << " bytes per reference, borrowed references: "
+                  << (borrowed_bytes - owned_bytes) / num_refs << " bytes per reference.";
+  }
+
+  for (const auto &id : owned_ids) {
+    rc->RemoveLocalReference(id, nullptr);
+  }
+  for (const auto &id : borrowed_ids) {
+    rc->RemoveLocalReference(id, nullptr);
+  }
+}
+
 }  // namespace core
 }  // namespace ray
 
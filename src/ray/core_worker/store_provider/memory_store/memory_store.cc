@@ -161,12 +161,13 @@ void CoreWorkerMemoryStore::GetAsync(
     const ObjectID &object_id, std::function<void(std::shared_ptr<RayObject>)> callback) {
   std::shared_ptr<RayObject> ptr;
   {
-    absl::MutexLock lock(&mu_);
-    auto iter = objects_.find(object_id);
-    if (iter != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto iter = shard.objects.find(object_id);
+    if (iter != shard.objects.end()) {
       ptr = iter->second;
     } else {
-      object_async_get_requests_[object_id].push_back(callback);
+      shard.waiters[object_id].async_callbacks.push_back(callback);
     }
     if (ptr != nullptr) {
       ptr->SetAccessed();
@@ -181,9 +182,10 @@ void CoreWorkerMemoryStore::GetAsync(
 std::shared_ptr<RayObject> CoreWorkerMemoryStore::GetIfExists(const ObjectID &object_id) {
   std::shared_ptr<RayObject> ptr;
   {
-    absl::MutexLock lock(&mu_);
-    auto iter = objects_.find(object_id);
-    if (iter != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto iter = shard.objects.find(object_id);
+    if (iter != shard.objects.end()) {
       ptr = iter->second;
     }
     if (ptr != nullptr) {
@@ -208,31 +210,30 @@ bool CoreWorkerMemoryStore::Put(const RayObject &object, const ObjectID &object_
   // TODO(edoakes): we should instead return a flag to the caller to put the object in
   // plasma.
   {
-    absl::MutexLock lock(&mu_);
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
 
-    auto iter = objects_.find(object_id);
-    if (iter != objects_.end()) {
+    auto iter = shard.objects.find(object_id);
+    if (iter != shard.objects.end()) {
       return true;  // Object already exists in the store, which is fine.
     }
 
-    auto async_callback_it = object_async_get_requests_.find(object_id);
-    if (async_callback_it != object_async_get_requests_.end()) {
-      auto &callbacks = async_callback_it->second;
-      async_callbacks = std::move(callbacks);
-      object_async_get_requests_.erase(async_callback_it);
-    }
-
     bool should_add_entry = true;
-    auto object_request_iter = object_get_requests_.find(object_id);
-    if (object_request_iter != object_get_requests_.end()) {
-      auto &get_requests = object_request_iter->second;
-      for (auto &get_request : get_requests) {
+    auto waiters_it = shard.waiters.find(object_id);
+    if (waiters_it != shard.waiters.end()) {
+      async_callbacks = std::move(waiters_it->second.async_callbacks);
+      waiters_it->second.async_callbacks.clear();
+      // The get requests remove themselves from the waiters once they are done.
+      for (auto &get_request : waiters_it->second.get_requests) {
         get_request->Set(object_id, object_entry);
         // If ref counting is enabled, override the removal behaviour.
         if (get_request->ShouldRemoveObjects() && ref_counter_ == nullptr) {
           should_add_entry = false;
         }
       }
+      if (waiters_it->second.get_requests.empty()) {
+        shard.waiters.erase(waiters_it);
+      }
     }
     // Don't put it in the store, since we won't get a callback for deletion.
     if (ref_counter_ != nullptr && !ref_counter_->HasReference(object_id)) {
@@ -241,7 +242,7 @@ bool CoreWorkerMemoryStore::Put(const RayObject &object, const ObjectID &object_
 
     if (should_add_entry) {
       // If there is no existing get request, then add the `RayObject` to map.
-      EmplaceObjectAndUpdateStats(object_id, object_entry);
+      EmplaceObjectAndUpdateStats(shard, object_id, object_entry);
     } else {
       // It is equivalent to the object being added and immediately deleted from the
       // store.
@@ -283,16 +284,18 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     absl::flat_hash_set<ObjectID> remaining_ids;
     absl::flat_hash_set<ObjectID> ids_to_remove;
 
-    absl::MutexLock lock(&mu_);
-    // Check for existing objects and see if this get request can be fullfilled.
+    // Check for existing objects and see if this get request can be fullfilled. This
+    // only locks the shard of each object.
     for (size_t i = 0; i < object_ids.size() && count < num_objects; i++) {
       const auto &object_id = object_ids[i];
-      auto iter = objects_.find(object_id);
-      if (iter != objects_.end()) {
+      auto &shard = GetShard(object_id);
+      absl::MutexLock lock(&shard.mu);
+      auto iter = shard.objects.find(object_id);
+      if (iter != shard.objects.end()) {
         iter->second->SetAccessed();
         (*results)[i] = iter->second;
         if (remove_after_get) {
-          // Note that we cannot remove the object_id from `objects_` now,
+          // Note that we cannot remove the object_id from the store now,
           // because `object_ids` might have duplicate ids.
           ids_to_remove.insert(object_id);
         }
@@ -306,7 +309,9 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     // Clean up the objects if ref counting is off.
     if (ref_counter_ == nullptr) {
       for (const auto &object_id : ids_to_remove) {
-        EraseObjectAndUpdateStats(object_id);
+        auto &shard = GetShard(object_id);
+        absl::MutexLock lock(&shard.mu);
+        EraseObjectAndUpdateStats(shard, object_id);
       }
     }
 
@@ -321,8 +326,20 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     get_request =
         std::make_shared<GetRequest>(std::move(remaining_ids), required_objects,
                                      remove_after_get, abort_if_any_object_is_exception);
+    // Wait for the remaining objects. An object that was put since it was looked up
+    // above is set on the request right away.
     for (const auto &object_id : get_request->ObjectIds()) {
-      object_get_requests_[object_id].push_back(get_request);
+      auto &shard = GetShard(object_id);
+      absl::MutexLock lock(&shard.mu);
+      auto iter = shard.objects.find(object_id);
+      if (iter != shard.objects.end()) {
+        get_request->Set(object_id, iter->second);
+        if (remove_after_get && ref_counter_ == nullptr) {
+          EraseObjectAndUpdateStats(shard, object_id);
+        }
+      } else {
+        shard.waiters[object_id].get_requests.push_back(get_request);
+      }
     }
   }
 
@@ -366,32 +383,19 @@ Status CoreWorkerMemoryStore::GetImpl(const std::vector<ObjectID> &object_ids,
     RAY_CHECK_OK(raylet_client_->NotifyDirectCallTaskUnblocked());
   }
 
-  {
-    absl::MutexLock lock(&mu_);
-    // Populate results.
-    for (size_t i = 0; i < object_ids.size(); i++) {
-      const auto &object_id = object_ids[i];
-      if ((*results)[i] == nullptr) {
-        (*results)[i] = get_request->Get(object_id);
-      }
+  // Populate results.
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    const auto &object_id = object_ids[i];
+    if ((*results)[i] == nullptr) {
+      (*results)[i] = get_request->Get(object_id);
     }
+  }
 
-    // Remove get request.
-    for (const auto &object_id : get_request->ObjectIds()) {
-      auto object_request_iter = object_get_requests_.find(object_id);
-      if (object_request_iter != object_get_requests_.end()) {
-        auto &get_requests = object_request_iter->second;
-        // Erase get_request from the vector.
-        auto it = std::find(get_requests.begin(), get_requests.end(), get_request);
-        if (it != get_requests.end()) {
-          get_requests.erase(it);
-          // If the vector is empty, remove the object ID from the map.
-          if (get_requests.empty()) {
-            object_get_requests_.erase(object_request_iter);
-          }
-        }
-      }
-    }
+  // Remove get request.
+  for (const auto &object_id : get_request->ObjectIds()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    RemoveGetRequest(shard, object_id, get_request);
   }
 
   if (!signal_status.ok()) {
@@ -452,35 +456,38 @@ Status CoreWorkerMemoryStore::Wait(const absl::flat_hash_set<ObjectID> &object_i
 
 void CoreWorkerMemoryStore::Delete(const absl::flat_hash_set<ObjectID> &object_ids,
                                    absl::flat_hash_set<ObjectID> *plasma_ids_to_delete) {
-  absl::MutexLock lock(&mu_);
   for (const auto &object_id : object_ids) {
-    auto it = objects_.find(object_id);
-    if (it != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto it = shard.objects.find(object_id);
+    if (it != shard.objects.end()) {
       if (it->second->IsInPlasmaError()) {
         plasma_ids_to_delete->insert(object_id);
       } else {
         OnDelete(it->second);
-        EraseObjectAndUpdateStats(object_id);
+        EraseObjectAndUpdateStats(shard, object_id);
       }
     }
   }
 }
 
 void CoreWorkerMemoryStore::Delete(const std::vector<ObjectID> &object_ids) {
-  absl::MutexLock lock(&mu_);
   for (const auto &object_id : object_ids) {
-    auto it = objects_.find(object_id);
-    if (it != objects_.end()) {
+    auto &shard = GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    auto it = shard.objects.find(object_id);
+    if (it != shard.objects.end()) {
       OnDelete(it->second);
-      EraseObjectAndUpdateStats(object_id);
+      EraseObjectAndUpdateStats(shard, object_id);
     }
   }
 }
 
 bool CoreWorkerMemoryStore::Contains(const ObjectID &object_id, bool *in_plasma) {
-  absl::MutexLock lock(&mu_);
-  auto it = objects_.find(object_id);
-  if (it != objects_.end()) {
+  auto &shard = GetShard(object_id);
+  absl::MutexLock lock(&shard.mu);
+  auto it = shard.objects.find(object_id);
+  if (it != shard.objects.end()) {
     if (it->second->IsInPlasmaError()) {
       *in_plasma = true;
     }
@@ -489,6 +496,15 @@ bool CoreWorkerMemoryStore::Contains(const ObjectID &object_id, bool *in_plasma)
   return false;
 }
 
+int CoreWorkerMemoryStore::Size() {
+  int size = 0;
+  for (auto &shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    size += shard.objects.size();
+  }
+  return size;
+}
+
 inline bool IsUnhandledError(const std::shared_ptr<RayObject> &obj) {
   rpc::ErrorType error_type;
   // TODO(ekl) note that this doesn't warn on errors that are stored in plasma.
@@ -506,60 +522,84 @@ void CoreWorkerMemoryStore::OnDelete(std::shared_ptr<RayObject> obj) {
 }
 
 void CoreWorkerMemoryStore::NotifyUnhandledErrors() {
-  absl::MutexLock lock(&mu_);
   int64_t threshold = absl::GetCurrentTimeNanos() - kUnhandledErrorGracePeriodNanos;
-  auto it = objects_.begin();
   int count = 0;
-  while (it != objects_.end() && count < kMaxUnhandledErrorScanItems) {
-    const auto &obj = it->second;
-    if (IsUnhandledError(obj) && obj->CreationTimeNanos() < threshold &&
-        unhandled_exception_handler_ != nullptr) {
-      obj->SetAccessed();
-      unhandled_exception_handler_(*obj);
+  for (auto &shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    auto it = shard.objects.begin();
+    while (it != shard.objects.end() && count < kMaxUnhandledErrorScanItems) {
+      const auto &obj = it->second;
+      if (IsUnhandledError(obj) && obj->CreationTimeNanos() < threshold &&
+          unhandled_exception_handler_ != nullptr) {
+        obj->SetAccessed();
+        unhandled_exception_handler_(*obj);
+      }
+      it++;
+      count++;
     }
-    it++;
-    count++;
   }
 }
 
-inline void CoreWorkerMemoryStore::EraseObjectAndUpdateStats(const ObjectID &object_id) {
-  auto it = objects_.find(object_id);
-  if (it == objects_.end()) {
+inline void CoreWorkerMemoryStore::EraseObjectAndUpdateStats(Shard &shard,
+                                                             const ObjectID &object_id) {
+  auto it = shard.objects.find(object_id);
+  if (it == shard.objects.end()) {
     return;
   }
 
   if (it->second->IsInPlasmaError()) {
-    num_in_plasma_ -= 1;
+    shard.num_in_plasma -= 1;
   } else {
-    num_local_objects_ -= 1;
-    used_object_store_memory_ -= it->second->GetSize();
+    shard.num_local_objects -= 1;
+    shard.used_object_store_memory -= it->second->GetSize();
   }
-  RAY_CHECK(num_in_plasma_ >= 0 && num_local_objects_ >= 0 &&
-            used_object_store_memory_ >= 0);
-  objects_.erase(it);
+  RAY_CHECK(shard.num_in_plasma >= 0 && shard.num_local_objects >= 0 &&
+            shard.used_object_store_memory >= 0);
+  shard.objects.erase(it);
 }
 
 inline void CoreWorkerMemoryStore::EmplaceObjectAndUpdateStats(
-    const ObjectID &object_id, std::shared_ptr<RayObject> &object_entry) {
-  auto inserted = objects_.emplace(object_id, object_entry).second;
+    Shard &shard, const ObjectID &object_id, std::shared_ptr<RayObject> &object_entry) {
+  auto inserted = shard.objects.emplace(object_id, object_entry).second;
   if (inserted) {
     if (object_entry->IsInPlasmaError()) {
-      num_in_plasma_ += 1;
+      shard.num_in_plasma += 1;
     } else {
-      num_local_objects_ += 1;
-      used_object_store_memory_ += object_entry->GetSize();
+      shard.num_local_objects += 1;
+      shard.used_object_store_memory += object_entry->GetSize();
+    }
+  }
+  RAY_CHECK(shard.num_in_plasma >= 0 && shard.num_local_objects >= 0 &&
+            shard.used_object_store_memory >= 0);
+}
+
+void CoreWorkerMemoryStore::RemoveGetRequest(
+    Shard &shard, const ObjectID &object_id,
+    const std::shared_ptr<GetRequest> &get_request) {
+  auto waiters_it = shard.waiters.find(object_id);
+  if (waiters_it == shard.waiters.end()) {
+    return;
+  }
+  auto &get_requests = waiters_it->second.get_requests;
+  // Erase get_request from the vector.
+  auto it = std::find(get_requests.begin(), get_requests.end(), get_request);
+  if (it != get_requests.end()) {
+    get_requests.erase(it);
+    // If the object has no waiters left, remove the object ID from the map.
+    if (get_requests.empty() && waiters_it->second.async_callbacks.empty()) {
+      shard.waiters.erase(waiters_it);
     }
   }
-  RAY_CHECK(num_in_plasma_ >= 0 && num_local_objects_ >= 0 &&
-            used_object_store_memory_ >= 0);
 }
 
 MemoryStoreStats CoreWorkerMemoryStore::GetMemoryStoreStatisticalData() {
-  absl::MutexLock lock(&mu_);
   MemoryStoreStats item;
-  item.num_in_plasma = num_in_plasma_;
-  item.num_local_objects = num_local_objects_;
-  item.used_object_store_memory = used_object_store_memory_;
+  for (auto &shard : shards_) {
+    absl::MutexLock lock(&shard.mu);
+    item.num_in_plasma += shard.num_in_plasma;
+    item.num_local_objects += shard.num_local_objects;
+    item.used_object_store_memory += shard.used_object_store_memory;
+  }
   return item;
 }
 
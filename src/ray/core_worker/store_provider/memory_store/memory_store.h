@@ -16,6 +16,8 @@
 
 #include <gtest/gtest_prod.h>
 
+#include <array>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
@@ -40,6 +42,10 @@ class CoreWorkerMemoryStore;
 /// The class provides implementations for local process memory store.
 /// An example usage for this is to retrieve the returned objects from direct
 /// actor call (see direct_actor_transport.cc).
+///
+/// The objects are sharded by ObjectID, and every shard has its own lock and keeps the
+/// waiters of its objects next to them, so that getting an object that is present only
+/// locks its shard, and putting an object only wakes up the waiters of that object.
 class CoreWorkerMemoryStore {
  public:
   /// Create a memory store.
@@ -136,10 +142,7 @@ class CoreWorkerMemoryStore {
   /// Returns the number of objects in this store.
   ///
   /// \return Count of objects in the store.
-  int Size() {
-    absl::MutexLock lock(&mu_);
-    return objects_.size();
-  }
+  int Size();
 
   /// Returns stats data of memory usage.
   ///
@@ -159,6 +162,8 @@ class CoreWorkerMemoryStore {
 
  private:
   FRIEND_TEST(TestMemoryStore, TestMemoryStoreStats);
+  FRIEND_TEST(TestMemoryStore, TestGetWaitsOnlyOnItsObject);
+  FRIEND_TEST(TestMemoryStore, TestGetReturnsObjectPutBeforeItWaits);
 
   /// See the public version of `Get` for meaning of the other arguments.
   /// \param[in] abort_if_any_object_is_exception Whether we should abort if any object
@@ -171,14 +176,56 @@ class CoreWorkerMemoryStore {
   /// Called when an object is deleted from the store.
   void OnDelete(std::shared_ptr<RayObject> obj);
 
+  /// The requests that wait for an object that isn't in the store yet.
+  struct ObjectWaiters {
+    std::vector<std::shared_ptr<GetRequest>> get_requests;
+    std::vector<std::function<void(std::shared_ptr<RayObject>)>> async_callbacks;
+  };
+
+  static constexpr size_t kNumShards = 16;
+
+  struct Shard {
+    /// Protects the data structures below.
+    mutable absl::Mutex mu;
+
+    /// Map from object ID to `RayObject`.
+    /// NOTE: This map should be modified by EmplaceObjectAndUpdateStats and
+    /// EraseObjectAndUpdateStats.
+    absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> objects GUARDED_BY(mu);
+
+    /// Map from object ID to the requests that wait for it.
+    absl::flat_hash_map<ObjectID, ObjectWaiters> waiters GUARDED_BY(mu);
+
+    ///
+    /// Below information is stats of the objects of this shard.
+    ///
+    /// Number of objects in the plasma store.
+    int32_t num_in_plasma GUARDED_BY(mu) = 0;
+    /// Number of objects that don't exist in the plasma store.
+    int32_t num_local_objects GUARDED_BY(mu) = 0;
+    /// Number of object store memory used. (It doesn't include plasma store memory
+    /// usage).
+    int64_t used_object_store_memory GUARDED_BY(mu) = 0;
+  };
+
+  Shard &GetShard(const ObjectID &object_id) {
+    return shards_[object_id.Hash() % kNumShards];
+  }
+
   /// Emplace the given object entry to the in-memory-store and update stats properly.
-  void EmplaceObjectAndUpdateStats(const ObjectID &object_id,
-                                   std::shared_ptr<RayObject> &object_entry)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  static void EmplaceObjectAndUpdateStats(Shard &shard, const ObjectID &object_id,
+                                          std::shared_ptr<RayObject> &object_entry)
+      EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
 
   /// Erase the object of the object id from the in memory store and update stats
   /// properly.
-  void EraseObjectAndUpdateStats(const ObjectID &object_id) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  static void EraseObjectAndUpdateStats(Shard &shard, const ObjectID &object_id)
+      EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
+
+  /// Remove a get request from the waiters of the given object.
+  static void RemoveGetRequest(Shard &shard, const ObjectID &object_id,
+                               const std::shared_ptr<GetRequest> &get_request)
+      EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
 
   /// If enabled, holds a reference to local worker ref counter. TODO(ekl) make this
   /// mandatory once Java is supported.
@@ -187,22 +234,8 @@ class CoreWorkerMemoryStore {
   // If set, this will be used to notify worker blocked / unblocked on get calls.
   std::shared_ptr<raylet::RayletClient> raylet_client_ = nullptr;
 
-  /// Protects the data structures below.
-  mutable absl::Mutex mu_;
-
-  /// Map from object ID to `RayObject`.
-  /// NOTE: This map should be modified by EmplaceObjectAndUpdateStats and
-  /// EraseObjectAndUpdateStats.
-  absl::flat_hash_map<ObjectID, std::shared_ptr<RayObject>> objects_ GUARDED_BY(mu_);
-
-  /// Map from object ID to its get requests.
-  absl::flat_hash_map<ObjectID, std::vector<std::shared_ptr<GetRequest>>>
-      object_get_requests_ GUARDED_BY(mu_);
-
-  /// Map from object ID to its async get requests.
-  absl::flat_hash_map<ObjectID,
-                      std::vector<std::function<void(std::shared_ptr<RayObject>)>>>
-      object_async_get_requests_ GUARDED_BY(mu_);
+  /// The objects of this store and their waiters, sharded by object ID.
+  std::array<Shard, kNumShards> shards_;
 
   /// Function passed in to be called to check for signals (e.g., Ctrl-C).
   std::function<Status()> check_signals_;
@@ -210,17 +243,6 @@ class CoreWorkerMemoryStore {
   /// Function called to report unhandled exceptions.
   std::function<void(const RayObject &)> unhandled_exception_handler_;
 
-  ///
-  /// Below information is stats.
-  ///
-  /// Number of objects in the plasma store for this memory store.
-  int32_t num_in_plasma_ GUARDED_BY(mu_) = 0;
-  /// Number of objects that don't exist in the plasma store.
-  int32_t num_local_objects_ GUARDED_BY(mu_) = 0;
-  /// Number of object store memory used by this memory store. (It doesn't include plasma
-  /// store memory usage).
-  int64_t used_object_store_memory_ GUARDED_BY(mu_) = 0;
-
   /// This lambda is used to allow language frontend to allocate the objects
   /// in the memory store.
   std::function<std::shared_ptr<RayObject>(const RayObject &object,
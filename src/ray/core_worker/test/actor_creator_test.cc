@@ -21,6 +21,7 @@
 
 namespace ray {
 namespace core {
+using namespace ::testing;
 
 class ActorCreatorTest : public ::testing::Test {
  public:
@@ -79,6 +80,70 @@ TEST_F(ActorCreatorTest, AsyncWaitForFinish) {
   ASSERT_EQ(101, cnt);
 }
 
+TEST_F(ActorCreatorTest, BatchActors) {
+  instrumented_io_context io_service;
+  actor_creator = std::make_unique<DefaultActorCreator>(gcs_client, &io_service);
+  std::vector<TaskSpecification> task_specs;
+  for (int i = 0; i < 3; i++) {
+    task_specs.push_back(GetTaskSpec(ActorID::Of(JobID::FromInt(1), TaskID::Nil(), i)));
+  }
+
+  // The actors registered in the same turn of the event loop are sent together.
+  std::vector<std::function<void(Status)>> register_cbs;
+  EXPECT_CALL(*gcs_client->mock_actor_accessor, AsyncRegisterActors(task_specs, _))
+      .WillOnce(DoAll(SaveArg<1>(&register_cbs), Return(Status::OK())));
+  int num_registered = 0;
+  for (const auto &task_spec : task_specs) {
+    ASSERT_TRUE(actor_creator
+                    ->AsyncRegisterActor(task_spec,
+                                         [&num_registered](Status status) {
+                                           ASSERT_TRUE(status.ok());
+                                           num_registered++;
+                                         })
+                    .ok());
+    ASSERT_TRUE(actor_creator->IsActorInRegistering(task_spec.ActorCreationId()));
+  }
+  io_service.poll();
+  ASSERT_EQ(register_cbs.size(), 3);
+  for (auto &cb : register_cbs) {
+    cb(Status::OK());
+  }
+  ASSERT_EQ(num_registered, 3);
+  ASSERT_FALSE(actor_creator->IsActorInRegistering(task_specs[0].ActorCreationId()));
+
+  // So are the actors created in the same turn of the event loop.
+  std::vector<rpc::ClientCallback<rpc::CreateActorReply>> create_cbs;
+  EXPECT_CALL(*gcs_client->mock_actor_accessor, AsyncCreateActors(task_specs, _))
+      .WillOnce(DoAll(SaveArg<1>(&create_cbs), Return(Status::OK())));
+  int num_created = 0;
+  for (const auto &task_spec : task_specs) {
+    ASSERT_TRUE(
+        actor_creator
+            ->AsyncCreateActor(task_spec,
+                               [&num_created](Status status,
+                                              const rpc::CreateActorReply &reply) {
+                                 ASSERT_TRUE(status.ok());
+                                 num_created++;
+                               })
+            .ok());
+  }
+  io_service.poll();
+  ASSERT_EQ(create_cbs.size(), 3);
+  for (auto &cb : create_cbs) {
+    cb(Status::OK(), rpc::CreateActorReply());
+  }
+  ASSERT_EQ(num_created, 3);
+
+  // A single actor is sent on its own.
+  EXPECT_CALL(*gcs_client->mock_actor_accessor, AsyncCreateActor(task_specs[0], _))
+      .WillOnce(Return(Status::OK()));
+  ASSERT_TRUE(actor_creator
+                  ->AsyncCreateActor(task_specs[0], [](Status status,
+                                                       const rpc::CreateActorReply &) {})
+                  .ok());
+  io_service.poll();
+}
+
 }  // namespace core
 }  // namespace ray
 
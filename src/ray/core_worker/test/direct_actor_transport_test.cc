@@ -81,6 +81,11 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
     callbacks.push_back(callback);
   }
 
+  void PushActorTasks(std::vector<rpc::PushTaskRequestAndCallback> requests) override {
+    batch_sizes.push_back(requests.size());
+    rpc::CoreWorkerClientInterface::PushActorTasks(std::move(requests));
+  }
+
   int64_t ClientProcessedUpToSeqno() override { return acked_seqno; }
 
   bool ReplyPushTask(Status status = Status::OK(), size_t index = 0) {
@@ -96,6 +101,7 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
   rpc::Address addr;
   std::vector<rpc::ClientCallback<rpc::PushTaskReply>> callbacks;
   std::vector<uint64_t> received_seq_nos;
+  std::vector<size_t> batch_sizes;
   int64_t acked_seqno = 0;
 };
 
@@ -172,6 +178,43 @@ TEST_P(DirectActorSubmitterTest, TestSubmitTask) {
   ASSERT_THAT(worker_client_->received_seq_nos, ElementsAre(0, 1));
 }
 
+TEST_P(DirectActorSubmitterTest, TestSubmitTasksInBatch) {
+  auto &max_push_task_batch_size = RayConfig::instance().max_push_task_batch_size();
+  auto original_max_push_task_batch_size = max_push_task_batch_size;
+  max_push_task_batch_size = 4;
+
+  auto execute_out_of_order = GetParam();
+  rpc::Address addr;
+  auto worker_id = WorkerID::FromRandom();
+  addr.set_worker_id(worker_id.Binary());
+  ActorID actor_id = ActorID::Of(JobID::FromInt(0), TaskID::Nil(), 0);
+  submitter_.AddActorQueueIfNotExists(actor_id, -1, execute_out_of_order);
+  submitter_.ConnectActor(actor_id, addr, 0);
+
+  // The tasks that are resolved in the same run of the event loop are pushed together.
+  for (int i = 0; i < 6; i++) {
+    auto task = CreateActorTaskHelper(actor_id, worker_id, i);
+    ASSERT_TRUE(submitter_.SubmitTask(task).ok());
+  }
+  ASSERT_EQ(io_context.poll(), 7);
+  ASSERT_THAT(worker_client_->batch_sizes, ElementsAre(6));
+  ASSERT_THAT(worker_client_->received_seq_nos, ElementsAre(0, 1, 2, 3, 4, 5));
+
+  // Every task is still replied to on its own.
+  EXPECT_CALL(*task_finisher_, CompletePendingTask(_, _, _)).Times(6);
+  EXPECT_CALL(*task_finisher_, FailOrRetryPendingTask(_, _, _, _, _)).Times(0);
+  while (!worker_client_->callbacks.empty()) {
+    ASSERT_TRUE(worker_client_->ReplyPushTask());
+  }
+
+  // A task resolved on its own is pushed on its own.
+  ASSERT_TRUE(CheckSubmitTask(CreateActorTaskHelper(actor_id, worker_id, 6)));
+  ASSERT_EQ(io_context.poll(), 1);
+  ASSERT_THAT(worker_client_->batch_sizes, ElementsAre(6, 1));
+
+  max_push_task_batch_size = original_max_push_task_batch_size;
+}
+
 TEST_P(DirectActorSubmitterTest, TestQueueingWarning) {
   auto execute_out_of_order = GetParam();
   rpc::Address addr;
@@ -15,6 +15,7 @@
 #include "ray/core_worker/transport/direct_task_transport.h"
 
 #include "gtest/gtest.h"
+#include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/task/task_util.h"
 #include "ray/common/test_util.h"
@@ -52,6 +53,11 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
     callbacks.push_back(callback);
   }
 
+  void PushNormalTasks(std::vector<rpc::PushTaskRequestAndCallback> requests) override {
+    batch_sizes.push_back(requests.size());
+    rpc::CoreWorkerClientInterface::PushNormalTasks(std::move(requests));
+  }
+
   bool ReplyPushTask(Status status = Status::OK(), bool exit = false,
                      bool is_application_level_error = false) {
     if (callbacks.size() == 0) {
@@ -77,6 +83,7 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
 
   std::list<rpc::ClientCallback<rpc::PushTaskReply>> callbacks;
   std::list<rpc::CancelTaskRequest> kill_requests;
+  std::vector<size_t> batch_sizes;
 };
 
 class MockTaskFinisher : public TaskFinisherInterface {
@@ -177,6 +184,11 @@ class MockRayletClient : public WorkerLeaseInterface {
     callbacks.push_back(callback);
   }
 
+  void RequestWorkerLeases(
+      const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+      std::vector<ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply>> callbacks)
+      override {}
+
   void ReleaseUnusedWorkers(
       const std::vector<WorkerID> &workers_in_use,
       const rpc::ClientCallback<rpc::ReleaseUnusedWorkersReply> &callback) override {}
@@ -1154,6 +1166,166 @@ TEST(DirectTaskTransportTest, TestWorkerNotReusedOnError) {
   ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
 }
 
+TEST(DirectTaskTransportTest, TestPipelineTasksToWorker) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 1, /*max_tasks_in_flight_per_worker=*/3);
+
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+  }
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+
+  // Tasks 1 to 3 are pushed to the worker together. Its pipeline is full, so another
+  // worker is requested for task 4.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 3);
+  ASSERT_EQ(worker_client->batch_sizes, std::vector<size_t>({3}));
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 0);
+
+  // Task 1 finishes, task 4 is pushed to the same worker and the lease request that is
+  // no longer needed is canceled.
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(worker_client->callbacks.size(), 3);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 1);
+  ASSERT_TRUE(raylet_client->ReplyCancelWorkerLease());
+
+  // The worker is only returned once all the tasks in flight to it finish.
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+
+  // The second lease request is returned immediately.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 0);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 4);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+
+  // Check that there are no entries left in the scheduling_key_entries_ hashmap. These
+  // would otherwise cause a memory leak.
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST(DirectTaskTransportTest, TestPipelinedWorkerNotReusedOnError) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 1, /*max_tasks_in_flight_per_worker=*/2);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+  }
+
+  // Tasks 1 and 2 are pushed to the first worker.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 2);
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+  // Task 1 fails. Task 3 isn't pushed to the worker, and the worker is only
+  // disconnected once task 2 finishes.
+  ASSERT_TRUE(worker_client->ReplyPushTask(Status::IOError("worker dead")));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 0);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 1);
+
+  // Task 3 runs on the second worker.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 1);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 2);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 1);
+
+  // Check that there are no entries left in the scheduling_key_entries_ hashmap. These
+  // would otherwise cause a memory leak.
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+/// Run tiny tasks on one leased worker, with a fixed round trip to the worker. Every
+/// round trip, the worker replies to all the tasks that were pushed to it before the
+/// round trip started, since it runs them quicker than the round trip takes.
+void BenchmarkTinyTasks(uint32_t max_tasks_in_flight_per_worker) {
+  const int num_tasks = 2000;
+  const auto round_trip = std::chrono::microseconds(100);
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 1, max_tasks_in_flight_per_worker);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_tasks; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildEmptyTaskSpec()).ok());
+  }
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, NodeID::Nil()));
+  int num_round_trips = 0;
+  while (!worker_client->callbacks.empty()) {
+    size_t num_replies = worker_client->callbacks.size();
+    std::this_thread::sleep_for(round_trip);
+    for (size_t i = 0; i < num_replies; i++) {
+      ASSERT_TRUE(worker_client->ReplyPushTask());
+    }
+    num_round_trips++;
+  }
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  ASSERT_EQ(task_finisher->num_tasks_complete, num_tasks);
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  RAY_LOG(INFO) << "max_tasks_in_flight_per_worker=" << max_tasks_in_flight_per_worker
+                << ": ran " << num_tasks << " tasks in " << num_round_trips
+                << " round trips and " << elapsed_ms << " ms ("
+                << num_tasks * 1000 / std::max<int64_t>(elapsed_ms, 1) << " tasks/s).";
+
+  // Return the workers of the lease requests that were made while the pipeline was
+  // full.
+  while (raylet_client->GrantWorkerLease("localhost", 1001, NodeID::Nil())) {
+  }
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST(DirectTaskTransportTest, BenchmarkPipelinedTinyTasks) {
+  BenchmarkTinyTasks(1);
+  BenchmarkTinyTasks(4);
+  BenchmarkTinyTasks(16);
+}
+
 TEST(DirectTaskTransportTest, TestWorkerNotReturnedOnExit) {
   rpc::Address address;
   auto raylet_client = std::make_shared<MockRayletClient>();
@@ -1710,6 +1882,278 @@ TEST(DirectTaskTransportTest, TestKillResolvingTask) {
   ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
 }
 
+TEST(DirectTaskTransportTest, TestSpeculativeLeaseForPendingDependency) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 10, 1, 1);
+  TaskSpecification task = BuildEmptyTaskSpec();
+  ObjectID obj1 = ObjectID::FromRandom();
+  task.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(obj1.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  // The lease is requested before the dependency is created.
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  // The worker is kept for the task.
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+
+  // The task is pushed to the worker once its dependency is inlined.
+  auto data = GenerateRandomObject();
+  ASSERT_TRUE(store->Put(*data, obj1));
+  ASSERT_EQ(task_finisher->num_inlined_dependencies, 1);
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 0);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+
+  // A dependency that is already created doesn't need a lease ahead of time.
+  TaskSpecification task2 = BuildEmptyTaskSpec();
+  task2.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+      obj1.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task2).ok());
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 2);
+
+  // Check that there are no entries left in the scheduling_key_entries_ hashmap. These
+  // would otherwise cause a memory leak.
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST(DirectTaskTransportTest, TestSpeculativeLeaseReleased) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 10, 1, 1);
+
+  // The worker leased for a task is returned if the task is canceled.
+  TaskSpecification task = BuildEmptyTaskSpec();
+  ObjectID obj1 = ObjectID::FromRandom();
+  task.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(obj1.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  ASSERT_TRUE(submitter.CancelTask(task, true, false).ok());
+  ASSERT_TRUE(store->Put(*GenerateRandomObject(), obj1));
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 1);
+
+  // The lease request for a task is canceled if its dependency is put in plasma, since
+  // the task then needs a lease with the dependency.
+  TaskSpecification task2 = BuildEmptyTaskSpec();
+  ObjectID obj2 = ObjectID::FromRandom();
+  task2.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+      obj2.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task2).ok());
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+  std::string meta = std::to_string(static_cast<int>(rpc::ErrorType::OBJECT_IN_PLASMA));
+  auto metadata = const_cast<uint8_t *>(reinterpret_cast<const uint8_t *>(meta.data()));
+  auto meta_buffer = std::make_shared<LocalMemoryBuffer>(metadata, meta.size());
+  ASSERT_TRUE(store->Put(RayObject(nullptr, meta_buffer, {}), obj2));
+  ASSERT_EQ(raylet_client->num_workers_requested, 3);
+  ASSERT_EQ(raylet_client->num_leases_canceled, 1);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("", 0, NodeID::Nil(), /*cancel=*/true));
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+
+  // No lease is requested ahead of time for a task with a dependency in plasma.
+  TaskSpecification task3 = BuildEmptyTaskSpec();
+  ObjectID obj3 = ObjectID::FromRandom();
+  task3.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+      obj2.Binary());
+  task3.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+      obj3.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task3).ok());
+  ASSERT_EQ(raylet_client->num_workers_requested, 3);
+  ASSERT_TRUE(store->Put(*GenerateRandomObject(), obj3));
+  ASSERT_EQ(raylet_client->num_workers_requested, 4);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 3);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 2);
+
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST(DirectTaskTransportTest, TestSpeculativeLeasesKeptPerResolvingTask) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 10, 1, 2);
+  TaskSpecification task1 = BuildEmptyTaskSpec();
+  TaskSpecification task2 = BuildEmptyTaskSpec();
+  ObjectID obj1 = ObjectID::FromRandom();
+  ObjectID obj2 = ObjectID::FromRandom();
+  task1.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+      obj1.Binary());
+  task2.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+      obj2.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task1).ok());
+  ASSERT_TRUE(submitter.SubmitTask(task2).ok());
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1235, NodeID::Nil()));
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+
+  // One of the workers runs the first task, and the other one is kept for the second.
+  ASSERT_TRUE(store->Put(*GenerateRandomObject(), obj1));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  // Once the first task finishes, its worker isn't needed for the second one.
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+
+  ASSERT_TRUE(store->Put(*GenerateRandomObject(), obj2));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 2);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST(DirectTaskTransportTest, TestSpeculativeLeaseExpires) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  instrumented_io_context io_context;
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, /*lease_timeout_ms=*/5, actor_creator,
+      JobID::Nil(), absl::nullopt, 10, 1, 1, boost::asio::steady_timer(io_context));
+  TaskSpecification task = BuildEmptyTaskSpec();
+  ObjectID obj1 = ObjectID::FromRandom();
+  task.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(obj1.Binary());
+  ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1234, NodeID::Nil()));
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+
+  // The idle worker is returned once its lease expires, and a new lease is requested
+  // for the task.
+  io_context.run_one();
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+  ASSERT_TRUE(store->Put(*GenerateRandomObject(), obj1));
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1235, NodeID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 2);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 1);
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+void BenchmarkTaskChain(uint32_t max_speculative_leases_per_scheduling_category) {
+  const int num_tasks = 100;
+  const auto round_trip = std::chrono::microseconds(500);
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto client_pool = std::make_shared<rpc::CoreWorkerClientPool>(
+      [&](const rpc::Address &addr) { return worker_client; });
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  auto actor_creator = std::make_shared<MockActorCreator>();
+  auto lease_policy = std::make_shared<MockLeasePolicy>();
+  CoreWorkerDirectTaskSubmitter submitter(
+      address, raylet_client, client_pool, nullptr, lease_policy, store, task_finisher,
+      NodeID::Nil(), WorkerType::WORKER, kLongTimeout, actor_creator, JobID::Nil(),
+      absl::nullopt, 10, 1, max_speculative_leases_per_scheduling_category);
+
+  // Each task takes the return value of the one before it.
+  std::vector<ObjectID> return_ids;
+  for (int i = 0; i < num_tasks; i++) {
+    return_ids.push_back(ObjectID::FromRandom());
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_tasks; i++) {
+    TaskSpecification task = BuildEmptyTaskSpec();
+    if (i > 0) {
+      task.GetMutableMessage().add_args()->mutable_object_ref()->set_object_id(
+          return_ids[i - 1].Binary());
+    }
+    ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  }
+  int num_tasks_done = 0;
+  int num_round_trips = 0;
+  int port = 1000;
+  while (num_tasks_done < num_tasks) {
+    // The lease requests and the task pushes that are in flight at the same time
+    // finish after the same round trip.
+    size_t num_lease_replies = raylet_client->callbacks.size();
+    size_t num_push_replies = worker_client->callbacks.size();
+    ASSERT_GT(num_lease_replies + num_push_replies, 0);
+    std::this_thread::sleep_for(round_trip);
+    for (size_t i = 0; i < num_lease_replies; i++) {
+      ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", port++, NodeID::Nil()));
+    }
+    for (size_t i = 0; i < num_push_replies; i++) {
+      ASSERT_TRUE(worker_client->ReplyPushTask());
+      ASSERT_TRUE(store->Put(*GenerateRandomObject(), return_ids[num_tasks_done]));
+      num_tasks_done++;
+    }
+    num_round_trips++;
+  }
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  ASSERT_EQ(task_finisher->num_tasks_complete, num_tasks);
+  ASSERT_EQ(raylet_client->num_workers_returned, port - 1000);
+  RAY_LOG(INFO) << "max_speculative_leases_per_scheduling_category="
+                << max_speculative_leases_per_scheduling_category << ": ran a chain of "
+                << num_tasks << " tasks in " << num_round_trips << " round trips, "
+                << port - 1000 << " leases and " << elapsed_ms << " ms.";
+  ASSERT_TRUE(submitter.CheckNoSchedulingKeyEntriesPublic());
+}
+
+TEST(DirectTaskTransportTest, BenchmarkTaskChain) {
+  BenchmarkTaskChain(0);
+  BenchmarkTaskChain(1);
+}
+
 }  // namespace core
 }  // namespace ray
 
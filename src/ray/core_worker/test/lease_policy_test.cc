@@ -254,5 +254,43 @@ TEST(LocalityAwareLeasePolicyTest, TestBestLocalityFallbackAddrFetchFail) {
   ASSERT_FALSE(is_selected_based_on_locality);
 }
 
+TEST(LocalityAwareLeasePolicyTest, TestBestLocalityFromLocalityDataIndex) {
+  NodeID fallback_node = NodeID::FromRandom();
+  rpc::Address fallback_rpc_address = MockNodeAddrFactory(fallback_node).value();
+  NodeID node1 = NodeID::FromRandom();
+  NodeID node2 = NodeID::FromRandom();
+  ObjectID obj1 = ObjectID::FromRandom();
+  ObjectID obj2 = ObjectID::FromRandom();
+  auto locality_data_index = std::make_shared<LocalityDataIndex>();
+  LocalityAwareLeasePolicy locality_lease_policy(locality_data_index, MockNodeAddrFactory,
+                                                 fallback_rpc_address);
+  auto task_spec = CreateFakeTask({obj1, obj2});
+  auto best_node_id = [&]() {
+    auto [best_node_address, is_selected_based_on_locality] =
+        locality_lease_policy.GetBestNodeForTask(task_spec);
+    return NodeID::FromBinary(best_node_address.raylet_id());
+  };
+
+  // Objects of unknown size have no locality data.
+  locality_data_index->Update(obj1, -1, std::vector<NodeID>{node1});
+  ASSERT_FALSE(locality_data_index->GetLocalityData(obj1).has_value());
+  ASSERT_EQ(best_node_id(), fallback_node);
+
+  locality_data_index->Update(obj1, 8, std::vector<NodeID>{node1});
+  locality_data_index->Update(obj2, 16, std::vector<NodeID>{node2});
+  ASSERT_EQ(best_node_id(), node2);
+
+  // The locations of an update replace the previous ones.
+  locality_data_index->Update(obj2, 16, std::vector<NodeID>{node1});
+  ASSERT_EQ(locality_data_index->GetLocalityData(obj2)->nodes_containing_object,
+            absl::flat_hash_set<NodeID>{node1});
+  locality_data_index->Update(obj1, 8, std::vector<NodeID>{node2});
+  ASSERT_EQ(best_node_id(), node1);
+
+  locality_data_index->Erase(obj2);
+  ASSERT_FALSE(locality_data_index->GetLocalityData(obj2).has_value());
+  ASSERT_EQ(best_node_id(), node2);
+}
+
 }  // namespace core
 }  // namespace ray
@@ -14,6 +14,9 @@
 
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 
+#include <future>
+#include <thread>
+
 #include "absl/synchronization/mutex.h"
 #include "gtest/gtest.h"
 #include "ray/common/test_util.h"
@@ -84,9 +87,9 @@ TEST(TestMemoryStore, TestMemoryStoreStats) {
   // Iterate through the memory store and compare the values that are obtained by
   // GetMemoryStoreStatisticalData.
   auto fill_expected_memory_stats = [&](MemoryStoreStats &expected_item) {
-    {
-      absl::MutexLock lock(&provider->mu_);
-      for (const auto &it : provider->objects_) {
+    for (auto &shard : provider->shards_) {
+      absl::MutexLock lock(&shard.mu);
+      for (const auto &it : shard.objects) {
         if (it.second->IsInPlasmaError()) {
           expected_item.num_in_plasma += 1;
         } else {
@@ -203,6 +206,198 @@ TEST(TestMemoryStore, TestObjectAllocator) {
   ASSERT_EQ(max_rounds * hello.size(), mock_buffer_manager.GetBuferPressureInBytes());
 }
 
+TEST(TestMemoryStore, TestSmallObjectsAreInlined) {
+  auto provider = std::make_shared<CoreWorkerMemoryStore>();
+  auto put = [&](std::string data, std::string metadata) {
+    auto id = ObjectID::FromRandom();
+    auto data_buffer = std::make_shared<LocalMemoryBuffer>(
+        reinterpret_cast<uint8_t *>(data.data()), data.size());
+    auto metadata_buffer = std::make_shared<LocalMemoryBuffer>(
+        reinterpret_cast<uint8_t *>(metadata.data()), metadata.size());
+    RAY_CHECK(provider->Put(RayObject(data_buffer, metadata_buffer, {}), id));
+    // The store holds a copy of the buffers.
+    std::fill(data.begin(), data.end(), 'x');
+    std::fill(metadata.begin(), metadata.end(), 'x');
+    return id;
+  };
+
+  auto small_id = put("hello", "meta");
+  auto small_object = provider->GetIfExists(small_id);
+  auto data = small_object->GetData();
+  ASSERT_TRUE(dynamic_cast<InlineBuffer *>(data.get()) != nullptr);
+  ASSERT_TRUE(dynamic_cast<InlineBuffer *>(small_object->GetMetadata().get()) != nullptr);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(data->Data()) % BUFFER_ALIGNMENT, 0);
+  ASSERT_EQ(*data, *MakeLocalMemoryBufferFromString("hello"));
+  ASSERT_EQ(*small_object->GetMetadata(), *MakeLocalMemoryBufferFromString("meta"));
+  ASSERT_EQ(small_object->GetSize(), 9);
+  // The data outlives the object.
+  small_object.reset();
+  provider->Delete({small_id});
+  ASSERT_TRUE(provider->GetIfExists(small_id) == nullptr);
+  ASSERT_EQ(*data, *MakeLocalMemoryBufferFromString("hello"));
+
+  std::string large_data(kMaxInlineBuffersSize, 'a');
+  auto large_object = provider->GetIfExists(put(large_data, "meta"));
+  ASSERT_TRUE(dynamic_cast<LocalMemoryBuffer *>(large_object->GetData().get()) !=
+              nullptr);
+  ASSERT_EQ(*large_object->GetData(), *MakeLocalMemoryBufferFromString(large_data));
+}
+
+TEST(TestMemoryStore, TestGetWaitsOnlyOnItsObject) {
+  WorkerContext context(WorkerType::WORKER, WorkerID::FromRandom(), JobID::FromInt(0));
+  auto provider = std::make_shared<CoreWorkerMemoryStore>();
+  RayObject obj(rpc::ErrorType::TASK_EXECUTION_EXCEPTION);
+  auto id1 = ObjectID::FromRandom();
+  auto id2 = ObjectID::FromRandom();
+  while (&provider->GetShard(id2) == &provider->GetShard(id1)) {
+    id2 = ObjectID::FromRandom();
+  }
+  auto num_waiters = [&provider]() {
+    size_t num_waiters = 0;
+    for (auto &shard : provider->shards_) {
+      absl::MutexLock lock(&shard.mu);
+      num_waiters += shard.waiters.size();
+    }
+    return num_waiters;
+  };
+  auto is_waited_on = [&provider](const ObjectID &object_id) {
+    auto &shard = provider->GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    return shard.waiters.contains(object_id);
+  };
+
+  // A get of a missing object waits on the shard of that object only.
+  std::vector<std::shared_ptr<RayObject>> results;
+  auto status = std::async(std::launch::async, [&]() {
+    return provider->Get({id1}, 1, -1, context, false, &results);
+  });
+  while (!is_waited_on(id1)) {
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(num_waiters(), 1);
+
+  // Putting another object leaves it waiting, and putting its object wakes it up.
+  RAY_CHECK(provider->Put(obj, id2));
+  ASSERT_TRUE(is_waited_on(id1));
+  ASSERT_EQ(status.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+  RAY_CHECK(provider->Put(obj, id1));
+  ASSERT_TRUE(status.get().ok());
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_TRUE(results[0] != nullptr);
+  ASSERT_EQ(num_waiters(), 0);
+
+  // An object that's present is returned without waiting.
+  results.clear();
+  ASSERT_TRUE(provider->Get({id1, id2}, 2, 0, context, false, &results).ok());
+  ASSERT_TRUE(results[0] != nullptr && results[1] != nullptr);
+  ASSERT_EQ(provider->Size(), 2);
+}
+
+TEST(TestMemoryStore, TestGetReturnsObjectPutBeforeItWaits) {
+  WorkerContext context(WorkerType::WORKER, WorkerID::FromRandom(), JobID::FromInt(0));
+  auto provider = std::make_shared<CoreWorkerMemoryStore>();
+  RayObject obj(rpc::ErrorType::TASK_EXECUTION_EXCEPTION);
+  // The get looks up `missing_id`, then `present_id`, then `blocked_id`, which are in
+  // different shards.
+  std::vector<ObjectID> ids;
+  while (ids.size() < 3) {
+    auto id = ObjectID::FromRandom();
+    bool same_shard = false;
+    for (const auto &other_id : ids) {
+      same_shard |= &provider->GetShard(id) == &provider->GetShard(other_id);
+    }
+    if (!same_shard) {
+      ids.push_back(id);
+    }
+  }
+  const auto &missing_id = ids[0];
+  const auto &present_id = ids[1];
+  const auto &blocked_id = ids[2];
+  RAY_CHECK(provider->Put(obj, present_id));
+  auto was_accessed = [&provider](const ObjectID &object_id) {
+    auto &shard = provider->GetShard(object_id);
+    absl::MutexLock lock(&shard.mu);
+    return shard.objects[object_id]->WasAccessed();
+  };
+
+  // Hold the lock of the shard of `blocked_id`, so that the get stops after finding
+  // `missing_id` missing, which it does before marking `present_id` as accessed.
+  auto &blocked_shard = provider->GetShard(blocked_id);
+  blocked_shard.mu.Lock();
+  std::vector<std::shared_ptr<RayObject>> results;
+  auto status = std::async(std::launch::async, [&]() {
+    return provider->Get(ids, 2, -1, context, false, &results);
+  });
+  while (!was_accessed(present_id)) {
+    std::this_thread::yield();
+  }
+
+  // The object that is put before the get waits for it is returned, instead of the get
+  // waiting for the next put of it.
+  RAY_CHECK(provider->Put(obj, missing_id));
+  blocked_shard.mu.Unlock();
+  ASSERT_TRUE(status.get().ok());
+  ASSERT_TRUE(results[0] != nullptr);
+  ASSERT_TRUE(results[1] != nullptr);
+  ASSERT_TRUE(results[2] == nullptr);
+  for (const auto &id : ids) {
+    auto &shard = provider->GetShard(id);
+    absl::MutexLock lock(&shard.mu);
+    ASSERT_FALSE(shard.waiters.contains(id));
+  }
+}
+
+TEST(TestMemoryStore, BenchmarkConcurrentPutAndGet) {
+  WorkerContext context(WorkerType::WORKER, WorkerID::FromRandom(), JobID::FromInt(0));
+  auto provider = std::make_shared<CoreWorkerMemoryStore>();
+  const int num_threads = 8;
+  const int num_objects_per_thread = 20000;
+  auto buffer = MakeLocalMemoryBufferFromString("hello");
+  RayObject obj(buffer, nullptr, std::vector<rpc::ObjectReference>());
+
+  std::vector<std::vector<ObjectID>> object_ids(num_threads);
+  for (auto &ids : object_ids) {
+    for (int i = 0; i < num_objects_per_thread; i++) {
+      ids.push_back(ObjectID::FromRandom());
+    }
+  }
+
+  // Every thread gets the objects that the next thread puts, half of them with an
+  // async get before the put, and half of them with a blocking get after it.
+  std::atomic<int> num_async_gets(0);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      const auto &get_ids = object_ids[(t + 1) % num_threads];
+      for (int i = 0; i < num_objects_per_thread; i += 2) {
+        provider->GetAsync(get_ids[i],
+                           [&](std::shared_ptr<RayObject> obj) { num_async_gets++; });
+      }
+      for (const auto &id : object_ids[t]) {
+        RAY_CHECK(provider->Put(obj, id));
+      }
+      std::vector<std::shared_ptr<RayObject>> results;
+      for (int i = 1; i < num_objects_per_thread; i += 2) {
+        RAY_CHECK_OK(provider->Get({get_ids[i]}, 1, -1, context, false, &results));
+        RAY_CHECK(results[0] != nullptr);
+        results.clear();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  ASSERT_EQ(num_async_gets, num_threads * num_objects_per_thread / 2);
+  ASSERT_EQ(provider->Size(), num_threads * num_objects_per_thread);
+  RAY_LOG(INFO) << num_threads << " threads put and got "
+                << num_threads * num_objects_per_thread << " objects in " << elapsed_ms
+                << " ms.";
+}
+
 }  // namespace core
 }  // namespace ray
 
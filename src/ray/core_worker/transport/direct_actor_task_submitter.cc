@@ -107,7 +107,7 @@ Status CoreWorkerDirectActorTaskSubmitter::SubmitTask(TaskSpecification task_spe
                 if (actor_submit_queue->Contains(send_pos)) {
                   if (status.ok()) {
                     actor_submit_queue->MarkDependencyResolved(send_pos);
-                    SendPendingTasks(actor_id);
+                    SendPendingTasksBatched(actor_id);
                   } else {
                     auto task_id = actor_submit_queue->Get(send_pos).first.TaskId();
                     actor_submit_queue->MarkDependencyFailed(send_pos);
@@ -343,14 +343,43 @@ void CoreWorkerDirectActorTaskSubmitter::SendPendingTasks(const ActorID &actor_i
   // Submit all pending actor_submit_queue->
   auto &actor_submit_queue = client_queue.actor_submit_queue;
 
+  // The tasks that don't skip the queue are pushed together, so that the client can
+  // send them in fewer RPCs.
+  std::vector<rpc::PushTaskRequestAndCallback> batch;
   while (true) {
     auto task = actor_submit_queue->PopNextTaskToSend();
     if (!task.has_value()) {
       break;
     }
     RAY_CHECK(!client_queue.worker_id.empty());
-    PushActorTask(client_queue, task.value().first, task.value().second);
+    PushActorTask(client_queue, task.value().first, task.value().second, &batch);
   }
+  if (!batch.empty()) {
+    client_queue.rpc_client->PushActorTasks(std::move(batch));
+  }
+}
+
+void CoreWorkerDirectActorTaskSubmitter::SendPendingTasksBatched(
+    const ActorID &actor_id) {
+  if (::RayConfig::instance().max_push_task_batch_size() <= 1) {
+    SendPendingTasks(actor_id);
+    return;
+  }
+  auto it = client_queues_.find(actor_id);
+  RAY_CHECK(it != client_queues_.end());
+  if (it->second.send_pending_tasks_posted) {
+    return;
+  }
+  it->second.send_pending_tasks_posted = true;
+  io_service_.post(
+      [this, actor_id]() {
+        absl::MutexLock lock(&mu_);
+        auto it = client_queues_.find(actor_id);
+        RAY_CHECK(it != client_queues_.end());
+        it->second.send_pending_tasks_posted = false;
+        SendPendingTasks(actor_id);
+      },
+      "CoreWorkerDirectActorTaskSubmitter::SendPendingTasksBatched");
 }
 
 void CoreWorkerDirectActorTaskSubmitter::ResendOutOfOrderTasks(const ActorID &actor_id) {
@@ -372,9 +401,9 @@ void CoreWorkerDirectActorTaskSubmitter::ResendOutOfOrderTasks(const ActorID &ac
   }
 }
 
-void CoreWorkerDirectActorTaskSubmitter::PushActorTask(ClientQueue &queue,
-                                                       const TaskSpecification &task_spec,
-                                                       bool skip_queue) {
+void CoreWorkerDirectActorTaskSubmitter::PushActorTask(
+    ClientQueue &queue, const TaskSpecification &task_spec, bool skip_queue,
+    std::vector<rpc::PushTaskRequestAndCallback> *batch) {
   auto request = std::make_unique<rpc::PushTaskRequest>();
   // NOTE(swang): CopyFrom is needed because if we use Swap here and the task
   // fails, then the task data will be gone when the TaskManager attempts to
@@ -479,6 +508,10 @@ void CoreWorkerDirectActorTaskSubmitter::PushActorTask(ClientQueue &queue,
         reply_callback(status, reply);
       };
 
+  if (batch != nullptr && !skip_queue) {
+    batch->emplace_back(std::move(request), std::move(wrapped_callback));
+    return;
+  }
   queue.rpc_client->PushActorTask(std::move(request), skip_queue, wrapped_callback);
 }
 
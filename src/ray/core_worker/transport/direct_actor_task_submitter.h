@@ -201,6 +201,10 @@ class CoreWorkerDirectActorTaskSubmitter
     /// The current task number in this client queue.
     int32_t cur_pending_calls = 0;
 
+    /// Whether sending the pending tasks is posted to the event loop, so that the tasks
+    /// that are resolved before then are sent together.
+    bool send_pending_tasks_posted = false;
+
     /// Returns debug string for class.
     ///
     /// \return string.
@@ -220,9 +224,13 @@ class CoreWorkerDirectActorTaskSubmitter
   /// \param[in] task_spec The task to send.
   /// \param[in] skip_queue Whether to skip the task queue. This will send the
   /// task for execution immediately.
+  /// \param[in] batch If set and the task doesn't skip the queue, the task is added to
+  /// this batch instead of being sent, and the caller sends the batch.
   /// \return Void.
   void PushActorTask(ClientQueue &queue, const TaskSpecification &task_spec,
-                     bool skip_queue) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+                     bool skip_queue,
+                     std::vector<rpc::PushTaskRequestAndCallback> *batch = nullptr)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   /// Send all pending tasks for an actor.
   ///
@@ -230,6 +238,13 @@ class CoreWorkerDirectActorTaskSubmitter
   /// \return Void.
   void SendPendingTasks(const ActorID &actor_id) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Send all pending tasks for an actor once the handlers already posted to the event
+  /// loop have run, so that the tasks they resolve are sent in fewer RPCs. The tasks
+  /// are sent right away if push task batching is disabled.
+  ///
+  /// \param[in] actor_id Actor ID.
+  void SendPendingTasksBatched(const ActorID &actor_id) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Resend all previously-received, out-of-order, received tasks for an actor.
   /// When sending these tasks, the tasks will have the flag skip_execution=true.
   ///
@@ -23,10 +23,34 @@ Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
   RAY_LOG(DEBUG) << "Submit task " << task_spec.TaskId();
   num_tasks_submitted_++;
 
-  resolver_.ResolveDependencies(task_spec, [this, task_spec](Status status) {
+  // Request a lease for the task while its dependencies are created, so that the task
+  // can be pushed as soon as they are resolved.
+  const bool speculative = ShouldRequestSpeculativeLease(task_spec);
+  if (speculative) {
+    absl::MutexLock lock(&mu_);
+    const auto scheduling_key = SpeculativeSchedulingKey(task_spec);
+    auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
+    scheduling_key_entry.num_resolving_tasks++;
+    if (scheduling_key_entry.task_queue.empty()) {
+      // The lease is requested without the arguments, so that the raylet doesn't wait
+      // for them.
+      rpc::TaskSpec resource_spec = task_spec.GetMessage();
+      resource_spec.clear_args();
+      scheduling_key_entry.resource_spec = TaskSpecification(std::move(resource_spec));
+    }
+    RequestNewWorkerIfNeeded(scheduling_key);
+  }
+
+  resolver_.ResolveDependencies(task_spec, [this, task_spec, speculative](Status status) {
     task_finisher_->MarkDependenciesResolved(task_spec.TaskId());
     if (!status.ok()) {
       RAY_LOG(WARNING) << "Resolving task dependencies failed " << status.ToString();
+      if (speculative) {
+        absl::MutexLock lock(&mu_);
+        const auto speculative_key = SpeculativeSchedulingKey(task_spec);
+        scheduling_key_entries_[speculative_key].num_resolving_tasks--;
+        ReleaseSpeculativeLeasesIfNeeded(speculative_key);
+      }
       RAY_UNUSED(task_finisher_->FailOrRetryPendingTask(
           task_spec.TaskId(), rpc::ErrorType::DEPENDENCY_RESOLUTION_FAILED, &status));
       return;
@@ -63,6 +87,10 @@ Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
     bool keep_executing = true;
     {
       absl::MutexLock lock(&mu_);
+      if (speculative) {
+        scheduling_key_entries_[SpeculativeSchedulingKey(task_spec)]
+            .num_resolving_tasks--;
+      }
       if (cancelled_tasks_.find(task_spec.TaskId()) != cancelled_tasks_.end()) {
         cancelled_tasks_.erase(task_spec.TaskId());
         keep_executing = false;
@@ -79,15 +107,16 @@ Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
         scheduling_key_entry.task_queue.push_back(task_spec);
         scheduling_key_entry.resource_spec = task_spec;
 
-        if (!scheduling_key_entry.AllWorkersBusy()) {
-          // There are idle workers, so we don't need more
+        if (!scheduling_key_entry.AllPipelinesToWorkersFull(
+                max_tasks_in_flight_per_worker_)) {
+          // The pipelines to some workers are not full yet, so we don't need more
           // workers.
 
           for (auto active_worker_addr : scheduling_key_entry.active_workers) {
             RAY_CHECK(worker_to_lease_entry_.find(active_worker_addr) !=
                       worker_to_lease_entry_.end());
             auto &lease_entry = worker_to_lease_entry_[active_worker_addr];
-            if (!lease_entry.is_busy) {
+            if (!lease_entry.PipelineToWorkerFull(max_tasks_in_flight_per_worker_)) {
               OnWorkerIdle(active_worker_addr, scheduling_key, /*was_error*/ false,
                            /*worker_exiting*/ false, lease_entry.assigned_resources);
               break;
@@ -96,6 +125,9 @@ Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
         }
         RequestNewWorkerIfNeeded(scheduling_key);
       }
+      if (speculative) {
+        ReleaseSpeculativeLeasesIfNeeded(SpeculativeSchedulingKey(task_spec));
+      }
     }
     if (!keep_executing) {
       RAY_UNUSED(task_finisher_->FailOrRetryPendingTask(
@@ -105,6 +137,121 @@ Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
   return Status::OK();
 }
 
+bool CoreWorkerDirectTaskSubmitter::ShouldRequestSpeculativeLease(
+    const TaskSpecification &task_spec) {
+  if (max_speculative_leases_per_scheduling_category_ == 0 ||
+      task_spec.IsActorCreationTask()) {
+    return false;
+  }
+  bool has_pending_dependency = false;
+  for (size_t i = 0; i < task_spec.NumArgs(); i++) {
+    if (!task_spec.ArgByRef(i)) {
+      continue;
+    }
+    bool is_in_plasma = false;
+    if (!in_memory_store_->Contains(task_spec.ArgId(i), &is_in_plasma)) {
+      has_pending_dependency = true;
+    } else if (is_in_plasma) {
+      // The task keeps this argument, so its scheduling key differs from the one of
+      // the speculative leases.
+      return false;
+    }
+  }
+  return has_pending_dependency;
+}
+
+void CoreWorkerDirectTaskSubmitter::ReleaseSpeculativeLeasesIfNeeded(
+    const SchedulingKey &scheduling_key) {
+  auto it = scheduling_key_entries_.find(scheduling_key);
+  if (it == scheduling_key_entries_.end() || !it->second.task_queue.empty()) {
+    return;
+  }
+  if (it->second.num_resolving_tasks == 0) {
+    CancelWorkerLeaseIfNeeded(scheduling_key);
+  }
+  std::vector<rpc::WorkerAddress> idle_workers;
+  for (const auto &addr : it->second.active_workers) {
+    if (worker_to_lease_entry_[addr].WorkerIsDoingNothing()) {
+      idle_workers.push_back(addr);
+    }
+  }
+  const size_t num_to_keep = NumIdleWorkersToKeep(scheduling_key);
+  // Returning the last worker erases the entry.
+  for (size_t i = 0; i + num_to_keep < idle_workers.size(); i++) {
+    const auto &addr = idle_workers[i];
+    const auto &lease_entry = worker_to_lease_entry_[addr];
+    ReturnWorker(addr, lease_entry.was_error, lease_entry.worker_exiting, scheduling_key);
+  }
+  it = scheduling_key_entries_.find(scheduling_key);
+  if (it != scheduling_key_entries_.end() && it->second.CanDelete()) {
+    scheduling_key_entries_.erase(it);
+  }
+}
+
+size_t CoreWorkerDirectTaskSubmitter::NumIdleWorkersToKeep(
+    const SchedulingKey &scheduling_key) {
+  return std::min<size_t>(scheduling_key_entries_[scheduling_key].num_resolving_tasks,
+                          max_speculative_leases_per_scheduling_category_);
+}
+
+size_t CoreWorkerDirectTaskSubmitter::NumIdleWorkers(
+    const SchedulingKey &scheduling_key) {
+  size_t num_idle_workers = 0;
+  for (const auto &addr : scheduling_key_entries_[scheduling_key].active_workers) {
+    num_idle_workers += worker_to_lease_entry_[addr].WorkerIsDoingNothing();
+  }
+  return num_idle_workers;
+}
+
+void CoreWorkerDirectTaskSubmitter::ScheduleIdleLeaseExpiry(
+    int64_t lease_expiration_time) {
+  if (!idle_lease_timer_.has_value() ||
+      (idle_lease_timer_expiration_time_ >= 0 &&
+       idle_lease_timer_expiration_time_ <= lease_expiration_time)) {
+    return;
+  }
+  idle_lease_timer_expiration_time_ = lease_expiration_time;
+  // A lease is expired once the current time is past its expiration time.
+  idle_lease_timer_->expires_after(boost::asio::chrono::milliseconds(
+      std::max<int64_t>(lease_expiration_time - current_time_ms() + 1, 0)));
+  idle_lease_timer_->async_wait([this](const boost::system::error_code &error) {
+    if (error != boost::asio::error::operation_aborted) {
+      ReturnExpiredIdleWorkers();
+    }
+  });
+}
+
+void CoreWorkerDirectTaskSubmitter::ReturnExpiredIdleWorkers() {
+  absl::MutexLock lock(&mu_);
+  idle_lease_timer_expiration_time_ = -1;
+  const int64_t now = current_time_ms();
+  int64_t next_expiration_time = -1;
+  std::vector<rpc::WorkerAddress> expired_workers;
+  for (const auto &entry : worker_to_lease_entry_) {
+    const auto &lease_entry = entry.second;
+    if (!lease_entry.lease_client || !lease_entry.WorkerIsDoingNothing()) {
+      continue;
+    }
+    if (now > lease_entry.lease_expiration_time) {
+      expired_workers.push_back(entry.first);
+    } else if (next_expiration_time < 0 ||
+               lease_entry.lease_expiration_time < next_expiration_time) {
+      next_expiration_time = lease_entry.lease_expiration_time;
+    }
+  }
+  for (const auto &addr : expired_workers) {
+    RAY_LOG(DEBUG) << "Returning idle worker " << addr.worker_id
+                   << " whose lease expired";
+    const auto lease_entry = worker_to_lease_entry_[addr];
+    ReturnWorker(addr, lease_entry.was_error, lease_entry.worker_exiting,
+                 lease_entry.scheduling_key);
+    RequestNewWorkerIfNeeded(lease_entry.scheduling_key);
+  }
+  if (next_expiration_time >= 0) {
+    ScheduleIdleLeaseExpiry(next_expiration_time);
+  }
+}
+
 void CoreWorkerDirectTaskSubmitter::AddWorkerLeaseClient(
     const rpc::WorkerAddress &addr, std::shared_ptr<WorkerLeaseInterface> lease_client,
     const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources,
@@ -129,7 +276,7 @@ void CoreWorkerDirectTaskSubmitter::ReturnWorker(const rpc::WorkerAddress addr,
   RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
   auto &lease_entry = worker_to_lease_entry_[addr];
   RAY_CHECK(lease_entry.lease_client);
-  RAY_CHECK(!lease_entry.is_busy);
+  RAY_CHECK(lease_entry.WorkerIsDoingNothing());
 
   // Decrement the number of active workers consuming tasks from the queue associated
   // with the current scheduling_key
@@ -157,37 +304,57 @@ void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
     return;
   }
 
+  // Remember an error or exit, so that no more tasks are pushed to the worker while
+  // the other tasks in flight to it finish.
+  lease_entry.was_error |= was_error;
+  lease_entry.worker_exiting |= worker_exiting;
+
   auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
   auto &current_queue = scheduling_key_entry.task_queue;
   // Return the worker if there was an error executing the previous task,
   // the lease is expired; Return the worker if there are no more applicable
   // queued tasks.
-  if ((was_error || worker_exiting ||
-       current_time_ms() > lease_entry.lease_expiration_time) ||
-      current_queue.empty()) {
+  const bool lease_usable = !lease_entry.was_error && !lease_entry.worker_exiting &&
+                            current_time_ms() <= lease_entry.lease_expiration_time;
+  if (!lease_usable || current_queue.empty()) {
     RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
 
-    // Return the worker only if there are no tasks to do.
-    if (!lease_entry.is_busy) {
-      ReturnWorker(addr, was_error, worker_exiting, scheduling_key);
+    // Return the worker only if there are no tasks to do. As many idle workers as
+    // there are tasks whose dependencies are being resolved, up to the limit, are
+    // kept for them until their leases expire.
+    if (lease_entry.WorkerIsDoingNothing()) {
+      if (lease_usable &&
+          NumIdleWorkers(scheduling_key) <= NumIdleWorkersToKeep(scheduling_key)) {
+        ScheduleIdleLeaseExpiry(lease_entry.lease_expiration_time);
+      } else {
+        ReturnWorker(addr, lease_entry.was_error, lease_entry.worker_exiting,
+                     scheduling_key);
+      }
     }
   } else {
     auto &client = *client_cache_->GetOrConnect(addr.ToProto());
 
-    while (!current_queue.empty() && !lease_entry.is_busy) {
+    // The tasks are pushed together, so that the client can send them in fewer RPCs.
+    std::vector<rpc::PushTaskRequestAndCallback> batch;
+    while (!current_queue.empty() &&
+           !lease_entry.PipelineToWorkerFull(max_tasks_in_flight_per_worker_)) {
       auto task_spec = current_queue.front();
-      lease_entry.is_busy = true;
+      lease_entry.tasks_in_flight++;
 
       // Increment the total number of tasks in flight to any worker associated with the
       // current scheduling_key
 
       RAY_CHECK(scheduling_key_entry.active_workers.size() >= 1);
-      scheduling_key_entry.num_busy_workers++;
+      scheduling_key_entry.total_tasks_in_flight++;
 
       executing_tasks_.emplace(task_spec.TaskId(), addr);
-      PushNormalTask(addr, client, scheduling_key, task_spec, assigned_resources);
+      PushNormalTask(addr, client, scheduling_key, task_spec, assigned_resources,
+                     &batch);
       current_queue.pop_front();
     }
+    if (!batch.empty()) {
+      client.PushNormalTasks(std::move(batch));
+    }
 
     CancelWorkerLeaseIfNeeded(scheduling_key);
   }
@@ -202,6 +369,11 @@ void CoreWorkerDirectTaskSubmitter::CancelWorkerLeaseIfNeeded(
     // There are still pending tasks so let the worker lease request succeed.
     return;
   }
+  if (scheduling_key_entry.num_resolving_tasks > 0 &&
+      max_speculative_leases_per_scheduling_category_ > 0) {
+    // The lease requests are for the tasks whose dependencies are being resolved.
+    return;
+  }
 
   RAY_LOG(DEBUG) << "Task queue is empty; canceling lease request";
 
@@ -308,20 +480,26 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
   RAY_CHECK(scheduling_key_entry.pending_lease_requests.size() <
             max_pending_lease_requests_per_scheduling_category_);
 
-  if (!scheduling_key_entry.AllWorkersBusy()) {
-    // There are idle workers, so we don't need more.
+  if (!scheduling_key_entry.AllPipelinesToWorkersFull(max_tasks_in_flight_per_worker_)) {
+    // The pipelines to some workers are not full yet, so we don't need more workers.
     return;
   }
 
   const auto &task_queue = scheduling_key_entry.task_queue;
-  if (task_queue.empty()) {
+  // The tasks whose dependencies are being resolved get a lease ahead of time, up to
+  // the limit.
+  const size_t num_tasks_needing_workers =
+      task_queue.size() +
+      std::min<size_t>(scheduling_key_entry.num_resolving_tasks,
+                       max_speculative_leases_per_scheduling_category_);
+  if (num_tasks_needing_workers == 0) {
     if (scheduling_key_entry.CanDelete()) {
       // We can safely remove the entry keyed by scheduling_key from the
       // scheduling_key_entries_ hashmap.
       scheduling_key_entries_.erase(scheduling_key);
     }
     return;
-  } else if (scheduling_key_entry.task_queue.size() <=
+  } else if (num_tasks_needing_workers <=
              scheduling_key_entry.pending_lease_requests.size()) {
     // All tasks have corresponding pending leases, no need to request more
     return;
@@ -492,7 +670,8 @@ void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
 void CoreWorkerDirectTaskSubmitter::PushNormalTask(
     const rpc::WorkerAddress &addr, rpc::CoreWorkerClientInterface &client,
     const SchedulingKey &scheduling_key, const TaskSpecification &task_spec,
-    const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources) {
+    const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources,
+    std::vector<rpc::PushTaskRequestAndCallback> *batch) {
   RAY_LOG(DEBUG) << "Pushing task " << task_spec.TaskId() << " to worker "
                  << addr.worker_id << " of raylet " << addr.raylet_id;
   auto task_id = task_spec.TaskId();
@@ -506,8 +685,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
   request->mutable_task_spec()->CopyFrom(task_spec.GetMessage());
   request->mutable_resource_mapping()->CopyFrom(assigned_resources);
   request->set_intended_worker_id(addr.worker_id.Binary());
-  client.PushNormalTask(
-      std::move(request),
+  rpc::ClientCallback<rpc::PushTaskReply> reply_callback =
       [this, task_spec, task_id, is_actor, is_actor_creation, scheduling_key, addr,
        assigned_resources](Status status, const rpc::PushTaskReply &reply) {
         {
@@ -518,15 +696,15 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
 
           // Decrement the number of tasks in flight to the worker
           auto &lease_entry = worker_to_lease_entry_[addr];
-          RAY_CHECK(lease_entry.is_busy);
-          lease_entry.is_busy = false;
+          RAY_CHECK_GE(lease_entry.tasks_in_flight, 1u);
+          lease_entry.tasks_in_flight--;
 
           // Decrement the total number of tasks in flight to any worker with the current
           // scheduling_key.
           auto &scheduling_key_entry = scheduling_key_entries_[scheduling_key];
           RAY_CHECK_GE(scheduling_key_entry.active_workers.size(), 1u);
-          RAY_CHECK_GE(scheduling_key_entry.num_busy_workers, 1u);
-          scheduling_key_entry.num_busy_workers--;
+          RAY_CHECK_GE(scheduling_key_entry.total_tasks_in_flight, 1u);
+          scheduling_key_entry.total_tasks_in_flight--;
 
           if (!status.ok() || !is_actor_creation || reply.worker_exiting()) {
             // Successful actor creation leases the worker indefinitely from the raylet.
@@ -551,7 +729,12 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
             task_finisher_->CompletePendingTask(task_id, reply, addr.ToProto());
           }
         }
-      });
+      };
+  if (batch != nullptr) {
+    batch->emplace_back(std::move(request), std::move(reply_callback));
+    return;
+  }
+  client.PushNormalTask(std::move(request), reply_callback);
 }
 
 Status CoreWorkerDirectTaskSubmitter::CancelTask(TaskSpecification task_spec,
@@ -67,11 +67,17 @@ class CoreWorkerDirectTaskSubmitter {
       std::shared_ptr<ActorCreatorInterface> actor_creator, const JobID &job_id,
       absl::optional<boost::asio::steady_timer> cancel_timer = absl::nullopt,
       uint64_t max_pending_lease_requests_per_scheduling_category =
-          ::RayConfig::instance().max_pending_lease_requests_per_scheduling_category())
+          ::RayConfig::instance().max_pending_lease_requests_per_scheduling_category(),
+      uint32_t max_tasks_in_flight_per_worker =
+          ::RayConfig::instance().max_tasks_in_flight_per_worker(),
+      uint32_t max_speculative_leases_per_scheduling_category =
+          ::RayConfig::instance().max_speculative_leases_per_scheduling_category(),
+      absl::optional<boost::asio::steady_timer> idle_lease_timer = absl::nullopt)
       : rpc_address_(rpc_address),
         local_lease_client_(lease_client),
         lease_client_factory_(lease_client_factory),
         lease_policy_(std::move(lease_policy)),
+        in_memory_store_(store),
         resolver_(*store, *task_finisher, *actor_creator),
         task_finisher_(task_finisher),
         lease_timeout_ms_(lease_timeout_ms),
@@ -82,7 +88,11 @@ class CoreWorkerDirectTaskSubmitter {
         job_id_(job_id),
         max_pending_lease_requests_per_scheduling_category_(
             max_pending_lease_requests_per_scheduling_category),
-        cancel_retry_timer_(std::move(cancel_timer)) {}
+        max_tasks_in_flight_per_worker_(max_tasks_in_flight_per_worker),
+        max_speculative_leases_per_scheduling_category_(
+            max_speculative_leases_per_scheduling_category),
+        cancel_retry_timer_(std::move(cancel_timer)),
+        idle_lease_timer_(std::move(idle_lease_timer)) {}
 
   /// Schedule a task for direct submission to a worker.
   ///
@@ -117,9 +127,10 @@ class CoreWorkerDirectTaskSubmitter {
   void ReportWorkerBacklog();
 
  private:
-  /// Schedule more work onto an idle worker or return it back to the raylet if
-  /// no more tasks are queued for submission. If an error was encountered
-  /// processing the worker, we don't attempt to re-use the worker.
+  /// Schedule more work onto a worker whose pipeline isn't full, or return it back to
+  /// the raylet once no more tasks are queued for submission and none are in flight to
+  /// it. If an error was encountered processing the worker, we don't attempt to re-use
+  /// the worker, and it's returned once the tasks in flight to it finish.
   ///
   /// \param[in] addr The address of the worker.
   /// \param[in] task_queue_key The scheduling class of the worker.
@@ -174,18 +185,55 @@ class CoreWorkerDirectTaskSubmitter {
   void ReturnWorker(const rpc::WorkerAddress addr, bool was_error, bool worker_exiting,
                     const SchedulingKey &scheduling_key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Whether to request a lease for a task while its dependencies are resolved. This is
+  /// the case if some of them are not created yet, and none of them is in plasma.
+  bool ShouldRequestSpeculativeLease(const TaskSpecification &task_spec);
+
+  /// The scheduling key of the leases that are requested for a task while its
+  /// dependencies are resolved. It's the key of the task if none of its arguments stay
+  /// in plasma.
+  static SchedulingKey SpeculativeSchedulingKey(const TaskSpecification &task_spec) {
+    return SchedulingKey(task_spec.GetSchedulingClass(), std::vector<ObjectID>(),
+                         ActorID::Nil(), task_spec.GetRuntimeEnvHash());
+  }
+
+  /// Cancel the pending lease requests of a scheduling key once no task waits for its
+  /// dependencies to be resolved to use them, and return the idle workers that are no
+  /// longer needed for such tasks.
+  void ReleaseSpeculativeLeasesIfNeeded(const SchedulingKey &scheduling_key)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// The number of idle workers of a scheduling key that are kept for the tasks whose
+  /// dependencies are being resolved.
+  size_t NumIdleWorkersToKeep(const SchedulingKey &scheduling_key)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// The number of idle workers of a scheduling key.
+  size_t NumIdleWorkers(const SchedulingKey &scheduling_key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Set the idle lease timer to return the idle workers whose leases expire by the
+  /// given time, unless it's already set to an earlier time.
+  void ScheduleIdleLeaseExpiry(int64_t lease_expiration_time)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Return the idle workers whose leases expired, and set the idle lease timer for the
+  /// next one to expire.
+  void ReturnExpiredIdleWorkers() LOCKS_EXCLUDED(mu_);
+
   /// Check that the scheduling_key_entries_ hashmap is empty.
   inline bool CheckNoSchedulingKeyEntries() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     return scheduling_key_entries_.empty();
   }
 
-  /// Push a task to a specific worker.
+  /// Push a task to a specific worker. If a batch is given, the task is added to it
+  /// instead of being sent, and the caller sends the batch.
   void PushNormalTask(const rpc::WorkerAddress &addr,
                       rpc::CoreWorkerClientInterface &client,
                       const SchedulingKey &task_queue_key,
                       const TaskSpecification &task_spec,
                       const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry>
-                          &assigned_resources);
+                          &assigned_resources,
+                      std::vector<rpc::PushTaskRequestAndCallback> *batch = nullptr);
 
   /// Address of our RPC server.
   rpc::Address rpc_address_;
@@ -204,6 +252,9 @@ class CoreWorkerDirectTaskSubmitter {
   /// spillback).
   std::shared_ptr<LeasePolicyInterface> lease_policy_;
 
+  /// The in-memory store, to check whether the dependencies of a task are created.
+  std::shared_ptr<CoreWorkerMemoryStore> in_memory_store_;
+
   /// Resolve local and remote dependencies;
   LocalDependencyResolver resolver_;
 
@@ -236,16 +287,28 @@ class CoreWorkerDirectTaskSubmitter {
   // Max number of pending lease requests per SchedulingKey.
   const uint64_t max_pending_lease_requests_per_scheduling_category_;
 
+  // Max number of tasks pushed to a leased worker that haven't finished yet.
+  const uint32_t max_tasks_in_flight_per_worker_;
+
+  // Max number of leases per SchedulingKey that are requested for tasks whose
+  // dependencies are being resolved.
+  const uint32_t max_speculative_leases_per_scheduling_category_;
+
   /// A LeaseEntry struct is used to condense the metadata about a single executor:
   /// (1) The lease client through which the worker should be returned
   /// (2) The expiration time of a worker's lease.
-  /// (3) Whether the worker has assigned task to do.
+  /// (3) The number of tasks that are currently in flight to the worker
+  /// (4) Whether the worker is returned once those tasks finish, and how
   /// (5) The resources assigned to the worker
   /// (6) The SchedulingKey assigned to tasks that will be sent to the worker
   struct LeaseEntry {
     std::shared_ptr<WorkerLeaseInterface> lease_client;
     int64_t lease_expiration_time;
-    bool is_busy = false;
+    uint32_t tasks_in_flight = 0;
+    // Set once a task pushed to the worker failed or the worker said it's exiting.
+    // No more tasks are pushed to the worker after that.
+    bool was_error = false;
+    bool worker_exiting = false;
     google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> assigned_resources;
     SchedulingKey scheduling_key;
 
@@ -260,6 +323,14 @@ class CoreWorkerDirectTaskSubmitter {
           lease_expiration_time(lease_expiration_time),
           assigned_resources(assigned_resources),
           scheduling_key(scheduling_key) {}
+
+    // Check whether the pipeline to the worker is full.
+    inline bool PipelineToWorkerFull(uint32_t max_tasks_in_flight_per_worker) const {
+      return tasks_in_flight >= max_tasks_in_flight_per_worker;
+    }
+
+    // Check whether the worker has no tasks to do.
+    inline bool WorkerIsDoingNothing() const { return tasks_in_flight == 0; }
   };
 
   // Map from worker address to a LeaseEntry struct containing the lease's metadata.
@@ -277,25 +348,31 @@ class CoreWorkerDirectTaskSubmitter {
     // room for more tasks in flight
     absl::flat_hash_set<rpc::WorkerAddress> active_workers =
         absl::flat_hash_set<rpc::WorkerAddress>();
-    // Keep track of how many workers have tasks to do.
-    uint32_t num_busy_workers = 0;
+    // Keep track of how many tasks are in flight to all the workers.
+    uint32_t total_tasks_in_flight = 0;
     int64_t last_reported_backlog_size = 0;
+    // Number of tasks whose dependencies are being resolved, that are expected to have
+    // this key afterwards. Leases are requested for them ahead of time.
+    uint32_t num_resolving_tasks = 0;
 
     // Check whether it's safe to delete this SchedulingKeyEntry from the
     // scheduling_key_entries_ hashmap.
     inline bool CanDelete() const {
       if (pending_lease_requests.empty() && task_queue.empty() &&
-          active_workers.size() == 0 && num_busy_workers == 0) {
+          active_workers.size() == 0 && total_tasks_in_flight == 0 &&
+          num_resolving_tasks == 0) {
         return true;
       }
 
       return false;
     }
 
-    // Check whether all workers are busy.
-    inline bool AllWorkersBusy() const {
-      RAY_CHECK_LE(num_busy_workers, active_workers.size());
-      return num_busy_workers == active_workers.size();
+    // Check whether the pipelines to all workers are full.
+    inline bool AllPipelinesToWorkersFull(uint32_t max_tasks_in_flight_per_worker) const {
+      RAY_CHECK_LE(total_tasks_in_flight,
+                   active_workers.size() * max_tasks_in_flight_per_worker);
+      return total_tasks_in_flight ==
+             active_workers.size() * max_tasks_in_flight_per_worker;
     }
 
     // Get the current backlog size for this scheduling key
@@ -325,6 +402,11 @@ class CoreWorkerDirectTaskSubmitter {
   // Retries cancelation requests if they were not successful.
   absl::optional<boost::asio::steady_timer> cancel_retry_timer_;
 
+  /// Timer to return the idle workers kept for the tasks whose dependencies are being
+  /// resolved once their leases expire, and the time it's set to, or -1 if it isn't.
+  absl::optional<boost::asio::steady_timer> idle_lease_timer_;
+  int64_t idle_lease_timer_expiration_time_ GUARDED_BY(mu_) = -1;
+
   int64_t num_tasks_submitted_ = 0;
   int64_t num_leases_requested_ GUARDED_BY(mu_) = 0;
 };
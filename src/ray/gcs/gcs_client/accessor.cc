@@ -17,12 +17,59 @@
 #include <future>
 
 #include "ray/gcs/gcs_client/gcs_client.h"
+#include "ray/rpc/batched_request_handler.h"
 
 namespace {
 inline int64_t GetGcsTimeoutMs() {
   return absl::ToInt64Milliseconds(
       absl::Seconds(RayConfig::instance().gcs_server_request_timeout_seconds()));
 }
+
+/// Send a `CreateActors` request, and then poll for the replies to the actors of it
+/// that are still being created.
+///
+/// \param client_impl The GCS client to send the request with.
+/// \param request The request, or the poll for the rest of it.
+/// \param actors The request that created the actors, to create them again with if
+/// the GCS forgot the batch because it restarted.
+/// \param callbacks The callbacks of the actors of `actors`.
+void SendCreateActorsRequest(
+    ray::gcs::GcsClient *client_impl, const ray::rpc::CreateActorsRequest &request,
+    std::shared_ptr<ray::rpc::CreateActorsRequest> actors,
+    std::shared_ptr<std::vector<ray::rpc::ClientCallback<ray::rpc::CreateActorReply>>>
+        callbacks) {
+  client_impl->GetGcsRpcClient().CreateActors(
+      request, [client_impl, actors, callbacks](
+                   const ray::Status &status, const ray::rpc::CreateActorsReply &reply) {
+        if (status.ok() && reply.batch_id() != 0) {
+          ray::rpc::CreateActorsRequest poll_request;
+          poll_request.set_batch_id(reply.batch_id());
+          SendCreateActorsRequest(client_impl, poll_request, actors, callbacks);
+        }
+        ray::rpc::CallBackBatchedRequests(status, reply, callbacks.get());
+        if (!status.ok() || reply.batch_id() != 0) {
+          return;
+        }
+        // The actors that weren't replied to were forgotten by a GCS that restarted.
+        // Creating an actor again is a no-op for the GCS if it already is.
+        auto retry_request = std::make_shared<ray::rpc::CreateActorsRequest>();
+        auto retry_callbacks = std::make_shared<
+            std::vector<ray::rpc::ClientCallback<ray::rpc::CreateActorReply>>>();
+        for (size_t i = 0; i < callbacks->size(); i++) {
+          if ((*callbacks)[i]) {
+            retry_request->add_requests()->Swap(actors->mutable_requests(i));
+            retry_callbacks->push_back(std::move((*callbacks)[i]));
+            (*callbacks)[i] = nullptr;
+          }
+        }
+        if (!retry_callbacks->empty()) {
+          RAY_LOG(INFO) << "Creating " << retry_callbacks->size()
+                        << " actors again after the GCS lost their requests.";
+          SendCreateActorsRequest(client_impl, *retry_request, retry_request,
+                                  retry_callbacks);
+        }
+      });
+}
 }  // namespace
 
 namespace ray {
@@ -274,6 +321,35 @@ Status ActorInfoAccessor::AsyncRegisterActor(const ray::TaskSpecification &task_
   return Status::OK();
 }
 
+Status ActorInfoAccessor::AsyncRegisterActors(
+    const std::vector<TaskSpecification> &task_specs,
+    std::vector<StatusCallback> callbacks) {
+  RAY_CHECK(task_specs.size() == callbacks.size());
+  rpc::RegisterActorsRequest request;
+  for (const auto &task_spec : task_specs) {
+    RAY_CHECK(task_spec.IsActorCreationTask());
+    request.add_task_specs()->CopyFrom(task_spec.GetMessage());
+  }
+  client_impl_->GetGcsRpcClient().RegisterActors(
+      request, [callbacks = std::move(callbacks)](const Status &status,
+                                                  const rpc::RegisterActorsReply &reply) {
+        for (size_t i = 0; i < callbacks.size(); i++) {
+          if (!status.ok()) {
+            callbacks[i](status);
+          } else if (i >= static_cast<size_t>(reply.statuses_size())) {
+            callbacks[i](Status::Invalid("The GCS didn't reply to the registration."));
+          } else {
+            const auto &actor_status = reply.statuses(i);
+            callbacks[i](actor_status.code() == (int)StatusCode::OK
+                             ? Status()
+                             : Status(StatusCode(actor_status.code()),
+                                      actor_status.message()));
+          }
+        }
+      });
+  return Status::OK();
+}
+
 Status ActorInfoAccessor::SyncRegisterActor(const ray::TaskSpecification &task_spec) {
   RAY_CHECK(task_spec.IsActorCreationTask());
   rpc::RegisterActorRequest request;
@@ -322,6 +398,35 @@ Status ActorInfoAccessor::AsyncCreateActor(
   return Status::OK();
 }
 
+Status ActorInfoAccessor::AsyncCreateActors(
+    const std::vector<TaskSpecification> &task_specs,
+    std::vector<rpc::ClientCallback<rpc::CreateActorReply>> callbacks) {
+  RAY_CHECK(task_specs.size() == callbacks.size());
+  auto request = std::make_shared<rpc::CreateActorsRequest>();
+  auto reply_callbacks =
+      std::make_shared<std::vector<rpc::ClientCallback<rpc::CreateActorReply>>>();
+  reply_callbacks->reserve(callbacks.size());
+  for (size_t i = 0; i < task_specs.size(); i++) {
+    RAY_CHECK(task_specs[i].IsActorCreationTask() && callbacks[i]);
+    request->add_requests()->mutable_task_spec()->CopyFrom(task_specs[i].GetMessage());
+    reply_callbacks->push_back(
+        [callback = std::move(callbacks[i])](const Status &status,
+                                             const rpc::CreateActorReply &reply) {
+          if (!status.ok()) {
+            callback(status, reply);
+            return;
+          }
+          callback(reply.status().code() == (int)StatusCode::OK
+                       ? Status()
+                       : Status(StatusCode(reply.status().code()),
+                                reply.status().message()),
+                   reply);
+        });
+  }
+  SendCreateActorsRequest(client_impl_, *request, request, reply_callbacks);
+  return Status::OK();
+}
+
 Status ActorInfoAccessor::AsyncSubscribe(
     const ActorID &actor_id,
     const SubscribeCallback<ActorID, rpc::ActorTableData> &subscribe,
@@ -1155,6 +1260,69 @@ Status InternalKVAccessor::AsyncInternalKVKeys(
   return Status::OK();
 }
 
+Status InternalKVAccessor::AsyncInternalKVMultiGet(
+    const std::string &ns, const std::vector<std::string> &keys,
+    const OptionalItemCallback<absl::flat_hash_map<std::string, std::string>>
+        &callback) {
+  rpc::InternalKVMultiGetRequest req;
+  req.set_namespace_(ns);
+  for (const auto &key : keys) {
+    req.add_keys(key);
+  }
+  client_impl_->GetGcsRpcClient().InternalKVMultiGet(
+      req,
+      [callback](const Status &status, const rpc::InternalKVMultiGetReply &reply) {
+        if (!status.ok()) {
+          callback(status, boost::none);
+        } else {
+          absl::flat_hash_map<std::string, std::string> results;
+          for (const auto &entry : reply.results()) {
+            results.emplace(entry.key(), entry.value());
+          }
+          callback(status, std::move(results));
+        }
+      },
+      /*timeout_ms*/ GetGcsTimeoutMs());
+  return Status::OK();
+}
+
+Status InternalKVAccessor::AsyncInternalKVMultiPut(
+    const std::string &ns,
+    const std::vector<std::pair<std::string, std::string>> &entries, bool overwrite,
+    const OptionalItemCallback<int> &callback) {
+  rpc::InternalKVMultiPutRequest req;
+  req.set_namespace_(ns);
+  req.set_overwrite(overwrite);
+  for (const auto &entry : entries) {
+    auto req_entry = req.add_entries();
+    req_entry->set_key(entry.first);
+    req_entry->set_value(entry.second);
+  }
+  client_impl_->GetGcsRpcClient().InternalKVMultiPut(
+      req,
+      [callback](const Status &status, const rpc::InternalKVMultiPutReply &reply) {
+        callback(status, reply.added_num());
+      },
+      /*timeout_ms*/ GetGcsTimeoutMs());
+  return Status::OK();
+}
+
+Status InternalKVAccessor::AsyncInternalKVWatch(
+    const std::string &ns, const std::string &prefix, int64_t since_version,
+    const std::function<void(Status, int64_t, std::vector<rpc::InternalKVChange> &&)>
+        &callback) {
+  rpc::InternalKVWatchRequest req;
+  req.set_namespace_(ns);
+  req.set_prefix(prefix);
+  req.set_since_version(since_version);
+  // The watch is a long poll, so it isn't bounded by the GCS RPC timeout.
+  client_impl_->GetGcsRpcClient().InternalKVWatch(
+      req, [callback](const Status &status, const rpc::InternalKVWatchReply &reply) {
+        callback(status, reply.version(), VectorFromProtobuf(reply.changes()));
+      });
+  return Status::OK();
+}
+
 Status InternalKVAccessor::Put(const std::string &ns, const std::string &key,
                                const std::string &value, bool overwrite, bool &added) {
   std::promise<Status> ret_promise;
@@ -114,6 +114,15 @@ class ActorInfoAccessor {
                                     const StatusCallback &callback,
                                     int64_t timeout_ms = -1);
 
+  /// Register many actors to GCS asynchronously, with a single request.
+  ///
+  /// \param task_specs The specifications for the actor creation tasks.
+  /// \param callbacks The callback of every actor, in the order of `task_specs`, that
+  /// will be called after its actor info is written to GCS.
+  /// \return Status
+  virtual Status AsyncRegisterActors(const std::vector<TaskSpecification> &task_specs,
+                                     std::vector<StatusCallback> callbacks);
+
   /// Register actor to GCS synchronously.
   ///
   /// The RPC will timeout after the default GCS RPC timeout is exceeded.
@@ -147,6 +156,18 @@ class ActorInfoAccessor {
       const TaskSpecification &task_spec,
       const rpc::ClientCallback<rpc::CreateActorReply> &callback);
 
+  /// Asynchronously request GCS to create many actors, with a single request.
+  ///
+  /// Every actor is called back as soon as it is created, like with
+  /// `AsyncCreateActor`, without waiting for the other actors.
+  ///
+  /// \param task_specs The specifications for the actor creation tasks.
+  /// \param callbacks The callback of every actor, in the order of `task_specs`.
+  /// \return Status
+  virtual Status AsyncCreateActors(
+      const std::vector<TaskSpecification> &task_specs,
+      std::vector<rpc::ClientCallback<rpc::CreateActorReply>> callbacks);
+
   /// Subscribe to any update operations of an actor.
   ///
   /// \param actor_id The ID of actor to be subscribed to.
@@ -761,6 +782,49 @@ class InternalKVAccessor {
   virtual Status AsyncInternalKVDel(const std::string &ns, const std::string &key,
                                     bool del_by_prefix, const StatusCallback &callback);
 
+  /// Asynchronously get the values for the given keys, with one RPC.
+  ///
+  /// \param ns The namespace to lookup.
+  /// \param keys The keys to lookup.
+  /// \param callback Callback that will be called with the keys that exist and their
+  /// values.
+  /// \return Status
+  virtual Status AsyncInternalKVMultiGet(
+      const std::string &ns, const std::vector<std::string> &keys,
+      const OptionalItemCallback<absl::flat_hash_map<std::string, std::string>>
+          &callback);
+
+  /// Asynchronously set the values for the given keys, with one RPC.
+  ///
+  /// \param ns The namespace to put the keys.
+  /// \param entries The <key, value> pairs.
+  /// \param overwrite If it's true, it'll overwrite the values of existing keys.
+  /// \param callback Callback that will be called with the number of keys added.
+  /// \return Status
+  virtual Status AsyncInternalKVMultiPut(
+      const std::string &ns,
+      const std::vector<std::pair<std::string, std::string>> &entries, bool overwrite,
+      const OptionalItemCallback<int> &callback);
+
+  /// Asynchronously watch the keys with a prefix for changes, as a long poll.
+  ///
+  /// The callback is called once there are changes to the keys after `since_version`,
+  /// or with no changes once the poll times out. Watch again from the version the
+  /// callback is called with. A negative `since_version` returns the current version
+  /// right away. If the status is `Invalid`, the changes after `since_version` are no
+  /// longer kept, and the keys need to be read again.
+  ///
+  /// \param ns The namespace to watch.
+  /// \param prefix The prefix of the keys to watch.
+  /// \param since_version The version after which changes are returned.
+  /// \param callback Callback that will be called with the status, the version to watch
+  /// from next and the changes.
+  /// \return Status
+  virtual Status AsyncInternalKVWatch(
+      const std::string &ns, const std::string &prefix, int64_t since_version,
+      const std::function<void(Status, int64_t, std::vector<rpc::InternalKVChange> &&)>
+          &callback);
+
   // These are sync functions of the async above
 
   /// List keys with prefix stored in internal kv
@@ -0,0 +1,546 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/bundle_placement_engine.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace gcs {
+
+BundlePlacementEngine::BundlePlacementEngine(
+    const absl::flat_hash_map<NodeID, std::shared_ptr<Node>> &cluster_resources)
+    : cluster_resources_(cluster_resources) {}
+
+std::vector<SchedulingResult> BundlePlacementEngine::PlaceAll(
+    const std::vector<Request> &requests) {
+  std::vector<const Request *> request_ptrs;
+  request_ptrs.reserve(requests.size());
+  for (const auto &request : requests) {
+    request_ptrs.push_back(&request);
+  }
+  BuildMatrix(request_ptrs);
+  MarkRequestedColumns(request_ptrs);
+  std::vector<SchedulingResult> results;
+  results.reserve(requests.size());
+  for (const auto &request : requests) {
+    results.emplace_back(Place(request));
+  }
+  InvalidateRows(results);
+  return results;
+}
+
+SchedulingResult BundlePlacementEngine::PlaceNext(const Request &request) {
+  UpdateMatrix({&request});
+  MarkRequestedColumns({&request});
+  auto result = Place(request);
+  InvalidateRows({result});
+  return result;
+}
+
+void BundlePlacementEngine::BuildMatrix(const std::vector<const Request *> &requests) {
+  for (const auto *request : requests) {
+    for (const auto &bundle : request->bundles) {
+      for (const auto &entry : bundle.custom_resources) {
+        if (custom_column_index_.emplace(entry.first, custom_columns_.size()).second) {
+          custom_columns_.push_back(entry.first);
+        }
+      }
+    }
+  }
+  // Only the custom resources that are requested get a column, so that the matrix
+  // stays small no matter how many custom resources (e.g. node IPs) the cluster has.
+  num_columns_ = PredefinedResources_MAX + custom_columns_.size();
+
+  node_ids_.clear();
+  node_ids_.reserve(cluster_resources_.size());
+  nodes_.clear();
+  nodes_.reserve(cluster_resources_.size());
+  row_index_.clear();
+  row_index_.reserve(cluster_resources_.size());
+  for (const auto &entry : cluster_resources_) {
+    row_index_.emplace(entry.first, node_ids_.size());
+    node_ids_.push_back(entry.first);
+    nodes_.push_back(entry.second);
+  }
+  row_versions_.assign(node_ids_.size(), kStaleRow);
+  available_.assign(node_ids_.size() * num_columns_, 0);
+  total_.assign(node_ids_.size() * num_columns_, 0);
+  max_total_.assign(num_columns_, 0);
+  for (size_t row = 0; row < node_ids_.size(); row++) {
+    ReadRow(row);
+    for (size_t i = 0; i < num_columns_; i++) {
+      max_total_[i] = std::max(max_total_[i], total_[row * num_columns_ + i]);
+    }
+  }
+}
+
+void BundlePlacementEngine::UpdateMatrix(const std::vector<const Request *> &requests) {
+  bool rebuild = node_ids_.size() != cluster_resources_.size();
+  for (size_t r = 0; r < requests.size() && !rebuild; r++) {
+    for (const auto &bundle : requests[r]->bundles) {
+      for (const auto &entry : bundle.custom_resources) {
+        rebuild = rebuild || !custom_column_index_.contains(entry.first);
+      }
+    }
+  }
+  if (rebuild) {
+    BuildMatrix(requests);
+    return;
+  }
+
+  bool totals_changed = false;
+  for (const auto &entry : cluster_resources_) {
+    auto it = row_index_.find(entry.first);
+    if (it == row_index_.end() || nodes_[it->second] != entry.second) {
+      // A node was removed and another one added.
+      BuildMatrix(requests);
+      return;
+    }
+    if (row_versions_[it->second] != entry.second->GetLocalViewVersion()) {
+      totals_changed = ReadRow(it->second) || totals_changed;
+    }
+  }
+  if (totals_changed) {
+    max_total_.assign(num_columns_, 0);
+    for (size_t i = 0; i < total_.size(); i++) {
+      max_total_[i % num_columns_] = std::max(max_total_[i % num_columns_], total_[i]);
+    }
+  }
+}
+
+bool BundlePlacementEngine::ReadRow(size_t row) {
+  row_versions_[row] = nodes_[row]->GetLocalViewVersion();
+  const auto &node_resources = nodes_[row]->GetLocalView();
+  int64_t *available = &available_[row * num_columns_];
+  int64_t *total = &total_[row * num_columns_];
+  bool totals_changed = false;
+  for (size_t i = 0; i < num_columns_; i++) {
+    const ResourceCapacity *capacity = nullptr;
+    if (i < PredefinedResources_MAX) {
+      if (i < node_resources.predefined_resources.size()) {
+        capacity = &node_resources.predefined_resources[i];
+      }
+    } else {
+      auto it = node_resources.custom_resources.find(
+          custom_columns_[i - PredefinedResources_MAX]);
+      if (it != node_resources.custom_resources.end()) {
+        capacity = &it->second;
+      }
+    }
+    const int64_t new_total = capacity == nullptr ? 0 : capacity->total.Raw();
+    totals_changed = totals_changed || total[i] != new_total;
+    total[i] = new_total;
+    available[i] = capacity == nullptr ? 0 : capacity->available.Raw();
+  }
+  return totals_changed;
+}
+
+void BundlePlacementEngine::MarkRequestedColumns(
+    const std::vector<const Request *> &requests) {
+  requested_columns_.assign(num_columns_, false);
+  for (const auto *request : requests) {
+    for (const auto &bundle : request->bundles) {
+      const auto demand = GetDemand(bundle);
+      for (size_t i = 0; i < num_columns_; i++) {
+        requested_columns_[i] = requested_columns_[i] || demand[i] > 0;
+      }
+    }
+  }
+}
+
+void BundlePlacementEngine::InvalidateRows(const std::vector<SchedulingResult> &results) {
+  for (const auto &result : results) {
+    for (const auto &node_id : result.second) {
+      row_versions_[row_index_.at(node_id)] = kStaleRow;
+    }
+  }
+}
+
+std::vector<int64_t> BundlePlacementEngine::GetDemand(
+    const ResourceRequest &resource_request) const {
+  std::vector<int64_t> demand(num_columns_, 0);
+  for (size_t i = 0; i < std::min<size_t>(resource_request.predefined_resources.size(),
+                                          PredefinedResources_MAX);
+       i++) {
+    demand[i] = resource_request.predefined_resources[i].Raw();
+  }
+  for (const auto &entry : resource_request.custom_resources) {
+    auto it = custom_column_index_.find(entry.first);
+    RAY_CHECK(it != custom_column_index_.end());
+    demand[PredefinedResources_MAX + it->second] = entry.second.Raw();
+  }
+  return demand;
+}
+
+SchedulingResult BundlePlacementEngine::Place(const Request &request) {
+  std::vector<size_t> candidates;
+  for (size_t node = 0; node < node_ids_.size(); node++) {
+    if (request.node_filter_func == nullptr ||
+        request.node_filter_func(node_ids_[node])) {
+      candidates.push_back(node);
+    }
+  }
+  if (candidates.empty()) {
+    RAY_LOG(DEBUG) << "The candidate nodes is empty, return directly.";
+    return std::make_pair(SchedulingResultStatus::INFEASIBLE, std::vector<NodeID>());
+  }
+
+  std::vector<std::vector<int64_t>> demands;
+  demands.reserve(request.bundles.size());
+  for (const auto &bundle : request.bundles) {
+    demands.emplace_back(GetDemand(bundle));
+  }
+  if (request.scheduling_type == STRICT_PACK) {
+    // All the bundles go to one node, so they are placed as a single one.
+    std::vector<int64_t> aggregated_demand(num_columns_, 0);
+    for (const auto &demand : demands) {
+      for (size_t i = 0; i < num_columns_; i++) {
+        aggregated_demand[i] += demand[i];
+      }
+    }
+    demands.assign(1, std::move(aggregated_demand));
+  } else if (request.scheduling_type == STRICT_SPREAD &&
+             demands.size() > candidates.size()) {
+    RAY_LOG(DEBUG) << "The number of required resources " << demands.size()
+                   << " is greater than the number of candidate nodes "
+                   << candidates.size() << ", scheduling fails.";
+    return std::make_pair(SchedulingResultStatus::INFEASIBLE, std::vector<NodeID>());
+  }
+  // A bundle that is bigger than every candidate node can never be placed, whatever
+  // is released.
+  for (const auto &demand : demands) {
+    if (std::none_of(candidates.begin(), candidates.end(),
+                     [this, &demand](size_t node) { return IsFeasible(node, demand); })) {
+      RAY_LOG(DEBUG) << "The required resource is bigger than the maximum resource in "
+                        "the whole cluster, schedule failed.";
+      return std::make_pair(SchedulingResultStatus::INFEASIBLE, std::vector<NodeID>());
+    }
+  }
+
+  // Place the bundles with the largest dominant share first, since they have the
+  // fewest nodes to go to.
+  std::vector<double> dominant_shares(demands.size(), 0);
+  for (size_t i = 0; i < demands.size(); i++) {
+    for (size_t j = 0; j < num_columns_; j++) {
+      if (max_total_[j] > 0) {
+        dominant_shares[i] = std::max(
+            dominant_shares[i], static_cast<double>(demands[i][j]) / max_total_[j]);
+      }
+    }
+  }
+  std::vector<size_t> order(demands.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&dominant_shares](size_t a, size_t b) {
+    return dominant_shares[a] > dominant_shares[b];
+  });
+
+  std::vector<int64_t> assignment(demands.size(), -1);
+  bool placed = false;
+  switch (request.scheduling_type) {
+  case PACK:
+  case STRICT_PACK:
+    placed = PlacePack(demands, order, candidates, &assignment);
+    break;
+  case SPREAD:
+    placed = PlaceSpread(demands, order, candidates, /*strict=*/false, &assignment);
+    break;
+  case STRICT_SPREAD:
+    placed = PlaceSpread(demands, order, candidates, /*strict=*/true, &assignment);
+    break;
+  default:
+    RAY_LOG(FATAL) << "Unsupported scheduling type: " << request.scheduling_type;
+    break;
+  }
+  if (!placed) {
+    // Can't meet the scheduling requirements temporarily.
+    return std::make_pair(SchedulingResultStatus::FAILED, std::vector<NodeID>());
+  }
+
+  std::vector<NodeID> result_nodes;
+  result_nodes.reserve(request.bundles.size());
+  for (size_t i = 0; i < request.bundles.size(); i++) {
+    // The bundles of a STRICT_PACK group were placed as one.
+    result_nodes.push_back(node_ids_[assignment[assignment.size() == 1 ? 0 : i]]);
+  }
+  return std::make_pair(SchedulingResultStatus::SUCCESS, std::move(result_nodes));
+}
+
+bool BundlePlacementEngine::Fits(size_t node, const std::vector<int64_t> &demand) const {
+  const int64_t *available = &available_[node * num_columns_];
+  for (size_t i = 0; i < num_columns_; i++) {
+    if (demand[i] > 0 && available[i] < demand[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BundlePlacementEngine::IsFeasible(size_t node,
+                                       const std::vector<int64_t> &demand) const {
+  const int64_t *total = &total_[node * num_columns_];
+  for (size_t i = 0; i < num_columns_; i++) {
+    if (demand[i] > 0 && total[i] < demand[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BundlePlacementEngine::Allocate(size_t node, const std::vector<int64_t> &demand) {
+  int64_t *available = &available_[node * num_columns_];
+  for (size_t i = 0; i < num_columns_; i++) {
+    available[i] -= demand[i];
+  }
+}
+
+void BundlePlacementEngine::Release(size_t node, const std::vector<int64_t> &demand) {
+  int64_t *available = &available_[node * num_columns_];
+  for (size_t i = 0; i < num_columns_; i++) {
+    available[i] += demand[i];
+  }
+}
+
+double BundlePlacementEngine::FreeFractionAfter(
+    size_t node, const std::vector<int64_t> &demand) const {
+  const int64_t *available = &available_[node * num_columns_];
+  const int64_t *total = &total_[node * num_columns_];
+  double free_fraction = 0;
+  int num_demanded = 0;
+  for (size_t i = 0; i < num_columns_; i++) {
+    if (demand[i] > 0) {
+      free_fraction += static_cast<double>(available[i] - demand[i]) / total[i];
+      num_demanded++;
+    }
+  }
+  return num_demanded == 0 ? 1 : free_fraction / num_demanded;
+}
+
+int64_t BundlePlacementEngine::FindNode(const std::vector<int64_t> &demand,
+                                        const std::vector<size_t> &nodes, bool tightest,
+                                        const std::vector<bool> &excluded) const {
+  int64_t best_node = -1;
+  double best_score = 0;
+  for (size_t node : nodes) {
+    if ((!excluded.empty() && excluded[node]) || !Fits(node, demand)) {
+      continue;
+    }
+    const double score = FreeFractionAfter(node, demand);
+    if (best_node == -1 || (tightest ? score < best_score : score > best_score)) {
+      best_node = node;
+      best_score = score;
+    }
+  }
+  return best_node;
+}
+
+bool BundlePlacementEngine::PlacePack(const std::vector<std::vector<int64_t>> &demands,
+                                      const std::vector<size_t> &order,
+                                      const std::vector<size_t> &candidates,
+                                      std::vector<int64_t> *assignment) {
+  std::vector<size_t> used_nodes;
+  for (size_t i : order) {
+    // Stay on the nodes the group already uses as long as the bundles fit there, and
+    // otherwise take the node the bundle fits most tightly, so that the free resources
+    // of the cluster are kept together for the groups to come.
+    int64_t node = FindNode(demands[i], used_nodes, /*tightest=*/true);
+    if (node == -1) {
+      node = FindNode(demands[i], candidates, /*tightest=*/true);
+      if (node == -1) {
+        for (size_t j = 0; j < demands.size(); j++) {
+          if ((*assignment)[j] != -1) {
+            Release((*assignment)[j], demands[j]);
+            (*assignment)[j] = -1;
+          }
+        }
+        return false;
+      }
+      used_nodes.push_back(node);
+    }
+    Allocate(node, demands[i]);
+    (*assignment)[i] = node;
+  }
+  CompactPack(demands, assignment);
+  return true;
+}
+
+void BundlePlacementEngine::CompactPack(const std::vector<std::vector<int64_t>> &demands,
+                                        std::vector<int64_t> *assignment) {
+  absl::flat_hash_map<size_t, std::vector<size_t>> bundles_by_node;
+  for (size_t i = 0; i < demands.size(); i++) {
+    bundles_by_node[(*assignment)[i]].push_back(i);
+  }
+
+  bool evacuated = true;
+  while (evacuated && bundles_by_node.size() > 1) {
+    evacuated = false;
+    std::vector<size_t> used_nodes;
+    for (const auto &entry : bundles_by_node) {
+      used_nodes.push_back(entry.first);
+    }
+    std::sort(used_nodes.begin(), used_nodes.end(),
+              [&bundles_by_node](size_t a, size_t b) {
+                const size_t num_a = bundles_by_node[a].size();
+                const size_t num_b = bundles_by_node[b].size();
+                return num_a != num_b ? num_a < num_b : a < b;
+              });
+    for (size_t source : used_nodes) {
+      // Try to move every bundle of the node to the other nodes of the group.
+      std::vector<size_t> targets;
+      for (size_t node : used_nodes) {
+        if (node != source) {
+          targets.push_back(node);
+        }
+      }
+      const auto &bundles = bundles_by_node[source];
+      std::vector<int64_t> moved_to;
+      for (size_t i : bundles) {
+        const int64_t target = FindNode(demands[i], targets, /*tightest=*/true);
+        if (target == -1) {
+          break;
+        }
+        Allocate(target, demands[i]);
+        moved_to.push_back(target);
+      }
+      if (moved_to.size() < bundles.size()) {
+        for (size_t j = 0; j < moved_to.size(); j++) {
+          Release(moved_to[j], demands[bundles[j]]);
+        }
+        continue;
+      }
+      for (size_t j = 0; j < bundles.size(); j++) {
+        Release(source, demands[bundles[j]]);
+        (*assignment)[bundles[j]] = moved_to[j];
+        bundles_by_node[moved_to[j]].push_back(bundles[j]);
+      }
+      bundles_by_node.erase(source);
+      evacuated = true;
+      break;
+    }
+  }
+}
+
+bool BundlePlacementEngine::PlaceSpread(const std::vector<std::vector<int64_t>> &demands,
+                                        const std::vector<size_t> &order,
+                                        const std::vector<size_t> &candidates,
+                                        bool strict, std::vector<int64_t> *assignment) {
+  std::vector<bool> used(node_ids_.size(), false);
+  std::vector<size_t> used_nodes;
+  // The bundle placed on every used node, for STRICT_SPREAD groups.
+  absl::flat_hash_map<size_t, size_t> bundle_of_node;
+  for (size_t i : order) {
+    // Take the unused node with the most resources left.
+    int64_t node = FindNode(demands[i], candidates, /*tightest=*/false, used);
+    if (node == -1 && !strict) {
+      node = FindNode(demands[i], used_nodes, /*tightest=*/false);
+    }
+    if (node == -1 && strict) {
+      // Make room for the bundle on a used node by moving the bundle of that node to an
+      // unused one.
+      int64_t target = -1;
+      for (size_t used_node : used_nodes) {
+        const size_t other = bundle_of_node[used_node];
+        Release(used_node, demands[other]);
+        if (Fits(used_node, demands[i])) {
+          target = FindNode(demands[other], candidates, /*tightest=*/false, used);
+          if (target != -1) {
+            node = used_node;
+            break;
+          }
+        }
+        Allocate(used_node, demands[other]);
+      }
+      if (node != -1) {
+        const size_t other = bundle_of_node[node];
+        Allocate(target, demands[other]);
+        (*assignment)[other] = target;
+        used[target] = true;
+        used_nodes.push_back(target);
+        bundle_of_node[target] = other;
+      }
+    }
+    if (node == -1) {
+      for (size_t j = 0; j < demands.size(); j++) {
+        if ((*assignment)[j] != -1) {
+          Release((*assignment)[j], demands[j]);
+          (*assignment)[j] = -1;
+        }
+      }
+      return false;
+    }
+    Allocate(node, demands[i]);
+    (*assignment)[i] = node;
+    if (!used[node]) {
+      used[node] = true;
+      used_nodes.push_back(node);
+    }
+    bundle_of_node[node] = i;
+  }
+  return true;
+}
+
+FragmentationStats BundlePlacementEngine::GetFragmentation() const {
+  FragmentationStats stats;
+  int num_columns = 0;
+  int num_free_columns = 0;
+  for (size_t i = 0; i < num_columns_; i++) {
+    if (!requested_columns_[i]) {
+      continue;
+    }
+    int64_t total = 0;
+    int64_t free = 0;
+    int64_t max_free = 0;
+    for (size_t node = 0; node < node_ids_.size(); node++) {
+      total += total_[node * num_columns_ + i];
+      free += available_[node * num_columns_ + i];
+      max_free = std::max(max_free, available_[node * num_columns_ + i]);
+    }
+    if (total <= 0) {
+      continue;
+    }
+    stats.free_fraction += static_cast<double>(free) / total;
+    num_columns++;
+    if (free > 0) {
+      stats.fragmentation += 1 - static_cast<double>(max_free) / free;
+      num_free_columns++;
+    }
+  }
+  if (num_columns > 0) {
+    stats.free_fraction /= num_columns;
+  }
+  if (num_free_columns > 0) {
+    stats.fragmentation /= num_free_columns;
+  }
+
+  for (size_t node = 0; node < node_ids_.size(); node++) {
+    bool used = false;
+    bool free = false;
+    for (size_t i = 0; i < num_columns_; i++) {
+      const size_t cell = node * num_columns_ + i;
+      if (!requested_columns_[i] || total_[cell] <= 0) {
+        continue;
+      }
+      used = used || available_[cell] < total_[cell];
+      free = free || available_[cell] > 0;
+    }
+    stats.num_partially_used_nodes += used && free;
+  }
+  return stats;
+}
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,166 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/id.h"
+#include "ray/gcs/gcs_server/gcs_resource_scheduler.h"
+#include "ray/raylet/scheduling/cluster_resource_data.h"
+
+namespace ray {
+namespace gcs {
+
+/// How scattered the free resources of the cluster are.
+struct FragmentationStats {
+  /// The fraction of the total capacity that is free, averaged over the resources.
+  double free_fraction = 0;
+  /// One minus the fraction of the free capacity that is on the node with the most of
+  /// it, averaged over the resources with free capacity. 0 means that the free
+  /// capacity of every resource is on a single node.
+  double fragmentation = 0;
+  /// The number of nodes with some, but not all, of their capacity in use.
+  int64_t num_partially_used_nodes = 0;
+};
+
+/// Places the bundles of placement groups on a compact matrix of the resources of the
+/// cluster, with a row of fixed-point capacities per node and a column per resource
+/// that is requested.
+///
+/// Bundles are placed greedily, largest first: PACK and STRICT_PACK bundles on the
+/// node they fit most tightly (preferring nodes the group already uses), SPREAD and
+/// STRICT_SPREAD bundles on the node with the most free resources. A local search then
+/// tries to empty the least used nodes of PACK groups by moving their bundles to the
+/// other nodes of the group, and to make room for STRICT_SPREAD bundles that didn't
+/// fit by moving a placed bundle to a free node.
+///
+/// This class is not thread safe.
+class BundlePlacementEngine {
+ public:
+  /// The bundles of a placement group to place.
+  struct Request {
+    std::vector<ResourceRequest> bundles;
+    SchedulingType scheduling_type;
+    /// If set, only the nodes it returns true for are used.
+    std::function<bool(const NodeID &)> node_filter_func;
+  };
+
+  /// \param cluster_resources The resources of every node. They must outlive the
+  /// engine, and aren't modified by it.
+  explicit BundlePlacementEngine(
+      const absl::flat_hash_map<NodeID, std::shared_ptr<Node>> &cluster_resources);
+
+  /// Place the bundles of every request, one request after the other. The resources of
+  /// the bundles placed for a request aren't available to the requests after it.
+  ///
+  /// \return The result of every request, where the selected nodes correspond to the
+  /// bundles of the request one by one.
+  std::vector<SchedulingResult> PlaceAll(const std::vector<Request> &requests);
+
+  /// Place the bundles of a request on the resources of the cluster as they are now.
+  /// Unlike `PlaceAll`, the matrix is kept from the previous call and only the rows of
+  /// the nodes whose resources changed since then are read again, so an engine that
+  /// places one request after the other should be kept around. The resources of the
+  /// selected nodes are read again on the next call too, since it's up to the caller
+  /// to acquire them.
+  SchedulingResult PlaceNext(const Request &request);
+
+  /// The fragmentation of the resources left after the last `PlaceAll` or `PlaceNext`,
+  /// over the resources that were requested.
+  FragmentationStats GetFragmentation() const;
+
+ private:
+  /// Build the matrix with the resources requested by the requests, and the ones that
+  /// already have a column.
+  void BuildMatrix(const std::vector<const Request *> &requests);
+
+  /// Read the rows of the nodes whose resources changed since they were last read, or
+  /// build the matrix again if the nodes changed or a request needs a new column.
+  void UpdateMatrix(const std::vector<const Request *> &requests);
+
+  /// Read the resources of the node of a row. Returns whether its totals changed.
+  bool ReadRow(size_t row);
+
+  /// Mark the columns of the resources the requests ask for.
+  void MarkRequestedColumns(const std::vector<const Request *> &requests);
+
+  /// Read the rows of the nodes selected by the results again on the next update.
+  void InvalidateRows(const std::vector<SchedulingResult> &results);
+
+  /// The demand of a bundle for every column of the matrix.
+  std::vector<int64_t> GetDemand(const ResourceRequest &resource_request) const;
+
+  SchedulingResult Place(const Request &request);
+
+  bool Fits(size_t node, const std::vector<int64_t> &demand) const;
+  bool IsFeasible(size_t node, const std::vector<int64_t> &demand) const;
+  void Allocate(size_t node, const std::vector<int64_t> &demand);
+  void Release(size_t node, const std::vector<int64_t> &demand);
+  /// The fraction of the capacity of the node that would be left free of the demanded
+  /// resources after placing the demand.
+  double FreeFractionAfter(size_t node, const std::vector<int64_t> &demand) const;
+
+  /// The node among `nodes`, but not among the `excluded` ones (indexed by row, may be
+  /// empty), that the demand fits most tightly (`tightest`) or most loosely, or -1 if
+  /// it fits none.
+  int64_t FindNode(const std::vector<int64_t> &demand, const std::vector<size_t> &nodes,
+                   bool tightest, const std::vector<bool> &excluded = {}) const;
+
+  /// Place the demands on the candidate nodes by `assignment` (a node per demand).
+  /// Returns false, with nothing allocated, if they can't be placed.
+  bool PlacePack(const std::vector<std::vector<int64_t>> &demands,
+                 const std::vector<size_t> &order, const std::vector<size_t> &candidates,
+                 std::vector<int64_t> *assignment);
+  bool PlaceSpread(const std::vector<std::vector<int64_t>> &demands,
+                   const std::vector<size_t> &order,
+                   const std::vector<size_t> &candidates, bool strict,
+                   std::vector<int64_t> *assignment);
+
+  /// Try to empty the used nodes with the fewest bundles by moving their bundles to
+  /// the other used nodes.
+  void CompactPack(const std::vector<std::vector<int64_t>> &demands,
+                   std::vector<int64_t> *assignment);
+
+  const absl::flat_hash_map<NodeID, std::shared_ptr<Node>> &cluster_resources_;
+
+  /// The nodes of the rows of the matrix.
+  std::vector<NodeID> node_ids_;
+  std::vector<std::shared_ptr<Node>> nodes_;
+  absl::flat_hash_map<NodeID, size_t> row_index_;
+  /// The version of the local view of the node of every row when it was read, or
+  /// `kStaleRow` if it must be read again.
+  std::vector<uint64_t> row_versions_;
+  static constexpr uint64_t kStaleRow = std::numeric_limits<uint64_t>::max();
+  /// The resource ID of every column after the predefined resources.
+  std::vector<int64_t> custom_columns_;
+  /// The column of every custom resource ID in `custom_columns_`.
+  absl::flat_hash_map<int64_t, size_t> custom_column_index_;
+  size_t num_columns_ = 0;
+  /// The available and total capacity of every column of every row, row by row.
+  std::vector<int64_t> available_;
+  std::vector<int64_t> total_;
+  /// The largest total capacity of every column, which bundle sizes are relative to.
+  std::vector<int64_t> max_total_;
+  /// Whether any bundle of the last `PlaceAll` or `PlaceNext` requested the resource
+  /// of every column.
+  std::vector<bool> requested_columns_;
+};
+
+}  // namespace gcs
+}  // namespace ray
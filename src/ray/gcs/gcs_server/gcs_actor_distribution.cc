@@ -14,6 +14,8 @@
 
 #include "ray/gcs/gcs_server/gcs_actor_distribution.h"
 
+#include <algorithm>
+
 #include "ray/util/event.h"
 
 namespace ray {
@@ -62,6 +64,64 @@ NodeID GcsBasedActorScheduler::SelectNode(std::shared_ptr<GcsActor> actor) {
   return NodeID::Nil();
 }
 
+std::vector<NodeID> GcsBasedActorScheduler::SelectNodes(
+    const std::vector<std::shared_ptr<GcsActor>> &actors) {
+  // Group the actors by the resources they require, in the order in which each shape
+  // is first seen. There are usually few shapes, so they are compared one by one.
+  std::vector<ResourceSet> shapes;
+  std::vector<std::vector<size_t>> shape_actors;
+  for (size_t i = 0; i < actors.size(); i++) {
+    const auto &resources =
+        actors[i]->GetCreationTaskSpecification().GetRequiredPlacementResources();
+    auto it = std::find(shapes.begin(), shapes.end(), resources);
+    if (it == shapes.end()) {
+      shapes.push_back(resources);
+      shape_actors.emplace_back();
+      it = shapes.end() - 1;
+    }
+    shape_actors[it - shapes.begin()].push_back(i);
+  }
+
+  std::vector<NodeID> node_ids(actors.size(), NodeID::Nil());
+  for (size_t shape = 0; shape < shapes.size(); shape++) {
+    const auto &indexes = shape_actors[shape];
+    if (indexes.size() == 1) {
+      node_ids[indexes[0]] = SelectNode(actors[indexes[0]]);
+      continue;
+    }
+
+    for (auto index : indexes) {
+      if (actors[index]->GetActorWorkerAssignment()) {
+        ResetActorWorkerAssignment(actors[index].get());
+      }
+    }
+    auto required_resources = ResourceMapToResourceRequest(
+        shapes[shape].GetResourceMap(), /*requires_object_store_memory=*/false);
+    auto selected_nodes =
+        gcs_resource_scheduler_
+            ->Schedule(std::vector<ResourceRequest>(indexes.size(), required_resources),
+                       SchedulingType::SPREAD)
+            .second;
+    if (selected_nodes.size() != indexes.size()) {
+      // Not all of the actors fit at once, so place as many of them as possible.
+      for (auto index : indexes) {
+        node_ids[index] = SelectNode(actors[index]);
+      }
+      continue;
+    }
+
+    for (size_t j = 0; j < indexes.size(); j++) {
+      const auto &actor = actors[indexes[j]];
+      RAY_CHECK(gcs_resource_manager_->AcquireResources(selected_nodes[j],
+                                                        required_resources));
+      actor->SetActorWorkerAssignment(std::make_unique<GcsActorWorkerAssignment>(
+          selected_nodes[j], required_resources, /*is_shared=*/false));
+      node_ids[indexes[j]] = selected_nodes[j];
+    }
+  }
+  return node_ids;
+}
+
 std::unique_ptr<GcsActorWorkerAssignment>
 GcsBasedActorScheduler::SelectOrAllocateActorWorkerAssignment(
     std::shared_ptr<GcsActor> actor, bool need_sole_actor_worker_assignment) {
@@ -106,6 +106,16 @@ class GcsBasedActorScheduler : public GcsActorScheduler {
   /// \return The selected node's ID. If the selection fails, NodeID::Nil() is returned.
   NodeID SelectNode(std::shared_ptr<GcsActor> actor) override;
 
+  /// Select nodes for the actors based on cluster resources. The actors that require
+  /// the same resources are spread over the cluster with a single pass of the resource
+  /// scheduler. If they don't fit at once, nodes are selected for them one by one.
+  ///
+  /// \param actors The actors to be scheduled.
+  /// \return The selected node's ID of every actor, in the order of the actors. It is
+  /// NodeID::Nil() for the actors for which the selection fails.
+  std::vector<NodeID> SelectNodes(
+      const std::vector<std::shared_ptr<GcsActor>> &actors) override;
+
   /// Handler to process a worker lease reply.
   /// If a rejection is received, it means resources were preempted by normal
   /// tasks. Then update the the cluster resource view and reschedule immediately.
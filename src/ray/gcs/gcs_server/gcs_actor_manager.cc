@@ -274,6 +274,134 @@ void GcsActorManager::HandleCreateActor(const rpc::CreateActorRequest &request,
   ++counts_[CountType::CREATE_ACTOR_REQUEST];
 }
 
+void GcsActorManager::HandleRegisterActors(const rpc::RegisterActorsRequest &request,
+                                           rpc::RegisterActorsReply *reply,
+                                           rpc::SendReplyCallback send_reply_callback) {
+  const int num_actors = request.task_specs_size();
+  RAY_LOG(INFO) << "Registering " << num_actors << " actors";
+  for (int i = 0; i < num_actors; i++) {
+    reply->add_statuses();
+  }
+  // The reply is sent once every actor is registered or has failed.
+  auto num_pending = std::make_shared<int>(num_actors + 1);
+  auto on_done = [reply, send_reply_callback, num_pending, num_actors]() {
+    if (--(*num_pending) == 0) {
+      RAY_LOG(INFO) << "Registered " << num_actors << " actors";
+      GCS_RPC_SEND_REPLY(send_reply_callback, reply, Status::OK());
+    }
+  };
+
+  std::vector<std::shared_ptr<GcsActor>> actors_to_persist;
+  for (int i = 0; i < num_actors; i++) {
+    const auto &task_spec = request.task_specs(i);
+    RAY_CHECK(task_spec.type() == TaskType::ACTOR_CREATION_TASK);
+    auto actor_id = ActorID::FromBinary(task_spec.actor_creation_task_spec().actor_id());
+    auto done = std::make_shared<bool>(false);
+    auto actor_status = reply->mutable_statuses(i);
+    auto fail = [done, actor_status, on_done](const Status &status) {
+      if (!*done) {
+        *done = true;
+        actor_status->set_code((int)status.code());
+        actor_status->set_message(status.message());
+        on_done();
+      }
+    };
+
+    rpc::RegisterActorRequest actor_request;
+    actor_request.mutable_task_spec()->CopyFrom(task_spec);
+    Status status = RegisterActor(
+        actor_request,
+        [done, on_done](const std::shared_ptr<gcs::GcsActor> &actor) {
+          if (!*done) {
+            *done = true;
+            on_done();
+          }
+        },
+        &actors_to_persist);
+    if (!status.ok()) {
+      RAY_LOG(WARNING) << "Failed to register actor: " << status.ToString()
+                       << ", job id = " << actor_id.JobId()
+                       << ", actor id = " << actor_id;
+      fail(status);
+    } else if (!*done) {
+      actor_to_register_abort_callbacks_[actor_id].emplace_back([fail]() {
+        fail(Status::Invalid("Actor was destroyed before it was registered."));
+      });
+    }
+    ++counts_[CountType::REGISTER_ACTOR_REQUEST];
+  }
+
+  if (!actors_to_persist.empty()) {
+    std::vector<std::pair<ActorID, rpc::ActorTableData>> entries;
+    entries.reserve(actors_to_persist.size());
+    for (const auto &actor : actors_to_persist) {
+      entries.emplace_back(actor->GetActorID(), actor->GetActorTableData());
+    }
+    // The backend storage is supposed to be reliable, so the status must be ok.
+    RAY_CHECK_OK(gcs_table_storage_->ActorTable().BatchPut(
+        entries, [this, actors_to_persist](const Status &status) {
+          RAY_CHECK_OK(status);
+          for (const auto &actor : actors_to_persist) {
+            OnActorRegistered(actor);
+          }
+        }));
+  }
+  on_done();
+}
+
+void GcsActorManager::HandleCreateActors(const rpc::CreateActorsRequest &request,
+                                         rpc::CreateActorsReply *reply,
+                                         rpc::SendReplyCallback send_reply_callback) {
+  std::vector<std::shared_ptr<GcsActor>> actors_to_schedule;
+  create_actors_batches_.HandleBatch(
+      request, reply, std::move(send_reply_callback),
+      [this, &actors_to_schedule](const rpc::CreateActorRequest &actor_request,
+                                  rpc::CreateActorReply *actor_reply,
+                                  rpc::SendReplyCallback send_actor_reply_callback) {
+        RAY_CHECK(actor_request.task_spec().type() == TaskType::ACTOR_CREATION_TASK);
+        auto actor_id = ActorID::FromBinary(
+            actor_request.task_spec().actor_creation_task_spec().actor_id());
+        auto done = std::make_shared<bool>(false);
+        auto fail = [done, actor_reply, send_actor_reply_callback](const Status &status) {
+          if (!*done) {
+            *done = true;
+            GCS_RPC_SEND_REPLY(send_actor_reply_callback, actor_reply, status);
+          }
+        };
+
+        Status status = CreateActor(
+            actor_request,
+            [done, actor_reply, send_actor_reply_callback](
+                const std::shared_ptr<gcs::GcsActor> &actor,
+                const rpc::PushTaskReply &task_reply) {
+              if (!*done) {
+                *done = true;
+                actor_reply->mutable_actor_address()->CopyFrom(actor->GetAddress());
+                actor_reply->mutable_borrowed_refs()->CopyFrom(
+                    task_reply.borrowed_refs());
+                GCS_RPC_SEND_REPLY(send_actor_reply_callback, actor_reply, Status::OK());
+              }
+            },
+            &actors_to_schedule);
+        if (!status.ok()) {
+          RAY_LOG(WARNING) << "Failed to create actor, job id = " << actor_id.JobId()
+                           << ", actor id = " << actor_id
+                           << ", status: " << status.ToString();
+          fail(status);
+        } else if (!*done) {
+          actor_to_create_abort_callbacks_[actor_id].emplace_back([fail]() {
+            fail(Status::Invalid("Actor was destroyed before it was created."));
+          });
+        }
+        ++counts_[CountType::CREATE_ACTOR_REQUEST];
+      });
+
+  if (!actors_to_schedule.empty()) {
+    RAY_LOG(INFO) << "Scheduling " << actors_to_schedule.size() << " actors";
+    gcs_actor_scheduler_->ScheduleBatch(actors_to_schedule);
+  }
+}
+
 void GcsActorManager::HandleGetActorInfo(const rpc::GetActorInfoRequest &request,
                                          rpc::GetActorInfoReply *reply,
                                          rpc::SendReplyCallback send_reply_callback) {
@@ -403,8 +531,9 @@ void GcsActorManager::HandleKillActorViaGcs(const rpc::KillActorViaGcsRequest &r
   ++counts_[CountType::KILL_ACTOR_REQUEST];
 }
 
-Status GcsActorManager::RegisterActor(const ray::rpc::RegisterActorRequest &request,
-                                      RegisterActorCallback success_callback) {
+Status GcsActorManager::RegisterActor(
+    const ray::rpc::RegisterActorRequest &request, RegisterActorCallback success_callback,
+    std::vector<std::shared_ptr<GcsActor>> *actors_to_persist) {
   // NOTE: After the abnormal recovery of the network between GCS client and GCS server or
   // the GCS server is restarted, it is required to continue to register actor
   // successfully.
@@ -487,42 +616,53 @@ Status GcsActorManager::RegisterActor(const ray::rpc::RegisterActorRequest &requ
                                          request.task_spec().runtime_env_info());
   }
 
+  if (actors_to_persist != nullptr) {
+    actors_to_persist->push_back(actor);
+    return Status::OK();
+  }
+
   // The backend storage is supposed to be reliable, so the status must be ok.
   RAY_CHECK_OK(gcs_table_storage_->ActorTable().Put(
       actor->GetActorID(), *actor->GetMutableActorTableData(),
       [this, actor](const Status &status) {
         // The backend storage is supposed to be reliable, so the status must be ok.
         RAY_CHECK_OK(status);
-        // If a creator dies before this callback is called, the actor could have been
-        // already destroyed. It is okay not to invoke a callback because we don't need
-        // to reply to the creator as it is already dead.
-        auto registered_actor_it = registered_actors_.find(actor->GetActorID());
-        if (registered_actor_it == registered_actors_.end()) {
-          // NOTE(sang): This logic assumes that the ordering of backend call is
-          // guaranteed. It is currently true because we use a single TCP socket to call
-          // the default Redis backend. If ordering is not guaranteed, we should overwrite
-          // the actor state to DEAD to avoid race condition.
-          return;
-        }
-        RAY_CHECK_OK(gcs_publisher_->PublishActor(actor->GetActorID(),
-                                                  actor->GetActorTableData(), nullptr));
-        // Invoke all callbacks for all registration requests of this actor (duplicated
-        // requests are included) and remove all of them from
-        // actor_to_register_callbacks_.
-        // Reply to the owner to indicate that the actor has been registered.
-        auto iter = actor_to_register_callbacks_.find(actor->GetActorID());
-        RAY_CHECK(iter != actor_to_register_callbacks_.end() && !iter->second.empty());
-        auto callbacks = std::move(iter->second);
-        actor_to_register_callbacks_.erase(iter);
-        for (auto &callback : callbacks) {
-          callback(actor);
-        }
+        OnActorRegistered(actor);
       }));
   return Status::OK();
 }
 
-Status GcsActorManager::CreateActor(const ray::rpc::CreateActorRequest &request,
-                                    CreateActorCallback callback) {
+void GcsActorManager::OnActorRegistered(const std::shared_ptr<GcsActor> &actor) {
+  // If a creator dies before this callback is called, the actor could have been
+  // already destroyed. It is okay not to invoke a callback because we don't need
+  // to reply to the creator as it is already dead.
+  auto registered_actor_it = registered_actors_.find(actor->GetActorID());
+  if (registered_actor_it == registered_actors_.end()) {
+    // NOTE(sang): This logic assumes that the ordering of backend call is
+    // guaranteed. It is currently true because we use a single TCP socket to call
+    // the default Redis backend. If ordering is not guaranteed, we should overwrite
+    // the actor state to DEAD to avoid race condition.
+    return;
+  }
+  RAY_CHECK_OK(gcs_publisher_->PublishActor(actor->GetActorID(),
+                                            actor->GetActorTableData(), nullptr));
+  // Invoke all callbacks for all registration requests of this actor (duplicated
+  // requests are included) and remove all of them from
+  // actor_to_register_callbacks_.
+  // Reply to the owner to indicate that the actor has been registered.
+  auto iter = actor_to_register_callbacks_.find(actor->GetActorID());
+  RAY_CHECK(iter != actor_to_register_callbacks_.end() && !iter->second.empty());
+  auto callbacks = std::move(iter->second);
+  actor_to_register_callbacks_.erase(iter);
+  actor_to_register_abort_callbacks_.erase(actor->GetActorID());
+  for (auto &callback : callbacks) {
+    callback(actor);
+  }
+}
+
+Status GcsActorManager::CreateActor(
+    const ray::rpc::CreateActorRequest &request, CreateActorCallback callback,
+    std::vector<std::shared_ptr<GcsActor>> *actors_to_schedule) {
   // NOTE: After the abnormal recovery of the network between GCS client and GCS server or
   // the GCS server is restarted, it is required to continue to create actor
   // successfully.
@@ -591,7 +731,11 @@ Status GcsActorManager::CreateActor(const ray::rpc::CreateActorRequest &request,
   registered_actors_[actor_id] = actor;
 
   // Schedule the actor.
-  gcs_actor_scheduler_->Schedule(actor);
+  if (actors_to_schedule != nullptr) {
+    actors_to_schedule->push_back(actor);
+  } else {
+    gcs_actor_scheduler_->Schedule(actor);
+  }
   return Status::OK();
 }
 
@@ -700,6 +844,17 @@ void GcsActorManager::DestroyActor(const ActorID &actor_id,
                 << ", job id = " << actor_id.JobId();
   actor_to_register_callbacks_.erase(actor_id);
   actor_to_create_callbacks_.erase(actor_id);
+  for (auto *abort_callbacks :
+       {&actor_to_register_abort_callbacks_, &actor_to_create_abort_callbacks_}) {
+    auto abort_iter = abort_callbacks->find(actor_id);
+    if (abort_iter != abort_callbacks->end()) {
+      auto callbacks = std::move(abort_iter->second);
+      abort_callbacks->erase(abort_iter);
+      for (auto &callback : callbacks) {
+        callback();
+      }
+    }
+  }
   auto it = registered_actors_.find(actor_id);
   if (it == registered_actors_.end()) {
     RAY_LOG(INFO) << "Tried to destroy actor that does not exist " << actor_id;
@@ -1106,6 +1261,7 @@ void GcsActorManager::OnActorCreationSuccess(const std::shared_ptr<GcsActor> &ac
           }
           actor_to_create_callbacks_.erase(iter);
         }
+        actor_to_create_abort_callbacks_.erase(actor_id);
       }));
 }
 
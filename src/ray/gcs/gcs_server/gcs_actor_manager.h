@@ -26,6 +26,7 @@
 #include "ray/gcs/gcs_server/gcs_init_data.h"
 #include "ray/gcs/gcs_server/gcs_table_storage.h"
 #include "ray/gcs/pubsub/gcs_pub_sub.h"
+#include "ray/rpc/batched_request_handler.h"
 #include "ray/rpc/gcs_server/gcs_rpc_server.h"
 #include "ray/rpc/worker/core_worker_client.h"
 #include "src/ray/protobuf/gcs_service.pb.h"
@@ -216,6 +217,14 @@ class GcsActorManager : public rpc::ActorInfoHandler {
                          rpc::CreateActorReply *reply,
                          rpc::SendReplyCallback send_reply_callback) override;
 
+  void HandleRegisterActors(const rpc::RegisterActorsRequest &request,
+                            rpc::RegisterActorsReply *reply,
+                            rpc::SendReplyCallback send_reply_callback) override;
+
+  void HandleCreateActors(const rpc::CreateActorsRequest &request,
+                          rpc::CreateActorsReply *reply,
+                          rpc::SendReplyCallback send_reply_callback) override;
+
   void HandleGetActorInfo(const rpc::GetActorInfoRequest &request,
                           rpc::GetActorInfoReply *reply,
                           rpc::SendReplyCallback send_reply_callback) override;
@@ -242,11 +251,15 @@ class GcsActorManager : public rpc::ActorInfoHandler {
   /// \param success_callback Will be invoked after the actor is created successfully or
   /// be invoked immediately if the actor is already registered to `registered_actors_`
   /// and its state is `ALIVE`.
+  /// \param actors_to_persist If set, a newly registered actor is added to it instead
+  /// of being written to the storage, and the caller must write it and then call
+  /// `OnActorRegistered`.
   /// \return Status::Invalid if this is a named actor and an
   /// actor with the specified name already exists. The callback will not be called in
   /// this case.
-  Status RegisterActor(const rpc::RegisterActorRequest &request,
-                       RegisterActorCallback success_callback);
+  Status RegisterActor(
+      const rpc::RegisterActorRequest &request, RegisterActorCallback success_callback,
+      std::vector<std::shared_ptr<GcsActor>> *actors_to_persist = nullptr);
 
   /// Create actor asynchronously.
   ///
@@ -254,10 +267,13 @@ class GcsActorManager : public rpc::ActorInfoHandler {
   /// \param callback Will be invoked after the actor is created successfully or be
   /// invoked immediately if the actor is already registered to `registered_actors_` and
   /// its state is `ALIVE`.
+  /// \param actors_to_schedule If set, an actor that is ready to be scheduled is added
+  /// to it instead of being scheduled, and the caller must schedule it.
   /// \return Status::Invalid if this is a named actor and an actor with the specified
   /// name already exists. The callback will not be called in this case.
-  Status CreateActor(const rpc::CreateActorRequest &request,
-                     CreateActorCallback callback);
+  Status CreateActor(
+      const rpc::CreateActorRequest &request, CreateActorCallback callback,
+      std::vector<std::shared_ptr<GcsActor>> *actors_to_schedule = nullptr);
 
   /// Get the actor ID for the named actor. Returns nil if the actor was not found.
   /// \param name The name of the detached actor to look up.
@@ -379,6 +395,10 @@ class GcsActorManager : public rpc::ActorInfoHandler {
   /// called for detached actors.
   void PollOwnerForActorOutOfScope(const std::shared_ptr<GcsActor> &actor);
 
+  /// Publish a registered actor once it is written to the storage, and invoke the
+  /// callbacks of its `RegisterActor` requests.
+  void OnActorRegistered(const std::shared_ptr<GcsActor> &actor);
+
   /// Destroy an actor that has gone out of scope. This cleans up all local
   /// state associated with the actor and marks the actor as dead. For owned
   /// actors, this should be called when all actor handles have gone out of
@@ -487,6 +507,17 @@ class GcsActorManager : public rpc::ActorInfoHandler {
   /// messages come from a Driver/Worker caused by some network problems.
   absl::flat_hash_map<ActorID, std::vector<CreateActorCallback>>
       actor_to_create_callbacks_;
+  /// The `CreateActors` requests whose actors haven't all been replied to.
+  rpc::BatchedRequestHandler<rpc::CreateActorRequest, rpc::CreateActorReply,
+                             rpc::CreateActorsRequest, rpc::CreateActorsReply>
+      create_actors_batches_;
+  /// Callbacks of the actors of pending `RegisterActors` and `CreateActors` requests,
+  /// which are invoked if an actor is destroyed before it is registered or created, so
+  /// that the reply to the rest of the batch is still sent.
+  absl::flat_hash_map<ActorID, std::vector<std::function<void()>>>
+      actor_to_register_abort_callbacks_;
+  absl::flat_hash_map<ActorID, std::vector<std::function<void()>>>
+      actor_to_create_abort_callbacks_;
   /// All registered actors (unresoved and pending actors are also included).
   /// TODO(swang): Use unique_ptr instead of shared_ptr.
   absl::flat_hash_map<ActorID, std::shared_ptr<GcsActor>> registered_actors_;
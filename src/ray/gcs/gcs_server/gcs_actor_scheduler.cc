@@ -69,6 +69,71 @@ void GcsActorScheduler::Schedule(std::shared_ptr<GcsActor> actor) {
   LeaseWorkerFromNode(actor, node.value());
 }
 
+void GcsActorScheduler::ScheduleBatch(
+    const std::vector<std::shared_ptr<GcsActor>> &actors) {
+  if (actors.size() <= 1) {
+    for (const auto &actor : actors) {
+      Schedule(actor);
+    }
+    return;
+  }
+
+  for (const auto &actor : actors) {
+    RAY_CHECK(actor->GetNodeID().IsNil() && actor->GetWorkerID().IsNil());
+  }
+  auto node_ids = SelectNodes(actors);
+  RAY_CHECK(node_ids.size() == actors.size());
+
+  // Group the actors by the selected node, keeping the order in which the nodes were
+  // first selected so that the leases are requested in a deterministic order.
+  std::vector<std::shared_ptr<rpc::GcsNodeInfo>> nodes;
+  absl::flat_hash_map<NodeID, std::vector<std::shared_ptr<GcsActor>>> node_to_actors;
+  for (size_t i = 0; i < actors.size(); i++) {
+    const auto &actor = actors[i];
+    auto node = gcs_node_manager_.GetAliveNode(node_ids[i]);
+    if (!node.has_value()) {
+      schedule_failure_handler_(actor, rpc::RequestWorkerLeaseReply::SCHEDULING_FAILED,
+                                "No available nodes to schedule the actor");
+      continue;
+    }
+
+    rpc::Address address;
+    address.set_raylet_id(node.value()->node_id());
+    actor->UpdateAddress(address);
+
+    RAY_CHECK(node_to_actors_when_leasing_[actor->GetNodeID()]
+                  .emplace(actor->GetActorID())
+                  .second);
+
+    auto &node_actors = node_to_actors[actor->GetNodeID()];
+    if (node_actors.empty()) {
+      nodes.push_back(node.value());
+    }
+    node_actors.push_back(actor);
+  }
+
+  const size_t batch_size =
+      std::max<uint64_t>(RayConfig::instance().gcs_actor_lease_batch_size(), 1);
+  for (const auto &node : nodes) {
+    const auto &node_actors = node_to_actors[NodeID::FromBinary(node->node_id())];
+    for (size_t begin = 0; begin < node_actors.size(); begin += batch_size) {
+      const size_t end = std::min(begin + batch_size, node_actors.size());
+      LeaseWorkersFromNode({node_actors.begin() + begin, node_actors.begin() + end},
+                           node);
+    }
+  }
+}
+
+std::vector<NodeID> GcsActorScheduler::SelectNodes(
+    const std::vector<std::shared_ptr<GcsActor>> &actors) {
+  std::vector<NodeID> node_ids;
+  node_ids.reserve(actors.size());
+  for (const auto &actor : actors) {
+    node_ids.push_back(SelectNode(actor));
+  }
+  return node_ids;
+}
+
 void GcsActorScheduler::Reschedule(std::shared_ptr<GcsActor> actor) {
   if (!actor->GetWorkerID().IsNil()) {
     RAY_LOG(INFO) << "Actor " << actor->GetActorID()
@@ -238,6 +303,50 @@ void GcsActorScheduler::LeaseWorkerFromNode(std::shared_ptr<GcsActor> actor,
       0);
 }
 
+void GcsActorScheduler::LeaseWorkersFromNode(
+    const std::vector<std::shared_ptr<GcsActor>> &actors,
+    std::shared_ptr<rpc::GcsNodeInfo> node) {
+  RAY_CHECK(node);
+
+  auto node_id = NodeID::FromBinary(node->node_id());
+  // A lease that has to wait for the release of unused workers is retried on its own.
+  if (actors.size() == 1 || nodes_of_releasing_unused_workers_.contains(node_id)) {
+    for (const auto &actor : actors) {
+      LeaseWorkerFromNode(actor, node);
+    }
+    return;
+  }
+
+  RAY_LOG(INFO) << "Start leasing " << actors.size() << " workers from node " << node_id
+                << ", job id = " << actors.front()->GetActorID().JobId();
+
+  std::vector<const rpc::TaskSpec *> task_specs;
+  task_specs.reserve(actors.size());
+  for (const auto &actor : actors) {
+    task_specs.push_back(&actor->GetActorTableData().task_spec());
+  }
+
+  rpc::Address remote_address;
+  remote_address.set_raylet_id(node->node_id());
+  remote_address.set_ip_address(node->node_manager_address());
+  remote_address.set_port(node->node_manager_port());
+  auto lease_client = GetOrConnectLeaseClient(remote_address);
+  // Every lease is handled as soon as the raylet replies to it, as if it was requested
+  // on its own.
+  std::vector<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>> callbacks;
+  callbacks.reserve(actors.size());
+  for (const auto &actor : actors) {
+    callbacks.emplace_back(
+        [this, actor, node](const Status &status,
+                            const rpc::RequestWorkerLeaseReply &reply) {
+          HandleWorkerLeaseReply(actor, node, status, reply);
+        });
+  }
+  lease_client->RequestWorkerLeases(
+      task_specs, RayConfig::instance().gcs_actor_scheduling_enabled(),
+      std::move(callbacks));
+}
+
 void GcsActorScheduler::RetryLeasingWorkerFromNode(
     std::shared_ptr<GcsActor> actor, std::shared_ptr<rpc::GcsNodeInfo> node) {
   RAY_UNUSED(execute_after(
@@ -48,6 +48,12 @@ class GcsActorSchedulerInterface {
   /// \param actor to be scheduled.
   virtual void Schedule(std::shared_ptr<GcsActor> actor) = 0;
 
+  /// Schedule many actors at once. The actors may share node selection and the lease
+  /// requests sent to each node.
+  ///
+  /// \param actors The actors to be scheduled.
+  virtual void ScheduleBatch(const std::vector<std::shared_ptr<GcsActor>> &actors) = 0;
+
   /// Reschedule the specified actor after gcs server restarts.
   ///
   /// \param actor to be scheduled.
@@ -121,6 +127,14 @@ class GcsActorScheduler : public GcsActorSchedulerInterface {
   /// \param actor to be scheduled.
   void Schedule(std::shared_ptr<GcsActor> actor) override;
 
+  /// Schedule many actors at once. Nodes are selected for all of the actors first, and
+  /// then the workers of the actors selected for the same node are leased from it with
+  /// a single `RequestWorkerLeases`, in batches of at most
+  /// `gcs_actor_lease_batch_size`.
+  ///
+  /// \param actors The actors to be scheduled.
+  void ScheduleBatch(const std::vector<std::shared_ptr<GcsActor>> &actors) override;
+
   /// Reschedule the specified actor after gcs server restarts.
   ///
   /// \param actor to be scheduled.
@@ -221,6 +235,15 @@ class GcsActorScheduler : public GcsActorSchedulerInterface {
   /// \return The selected node's ID. If the selection fails, NodeID::Nil() is returned.
   virtual NodeID SelectNode(std::shared_ptr<GcsActor> actor) = 0;
 
+  /// Select a node for each of the actors. By default the nodes are selected one actor
+  /// after the other.
+  ///
+  /// \param actors The actors to be scheduled.
+  /// \return The selected node's ID of every actor, in the order of the actors. It is
+  /// NodeID::Nil() for the actors for which the selection fails.
+  virtual std::vector<NodeID> SelectNodes(
+      const std::vector<std::shared_ptr<GcsActor>> &actors);
+
   /// Lease a worker from the specified node for the specified actor.
   ///
   /// \param actor A description of the actor to create. This object has the resource
@@ -229,6 +252,15 @@ class GcsActorScheduler : public GcsActorSchedulerInterface {
   void LeaseWorkerFromNode(std::shared_ptr<GcsActor> actor,
                            std::shared_ptr<rpc::GcsNodeInfo> node);
 
+  /// Lease workers from the specified node for the specified actors with a single
+  /// request. Falls back to leasing them one by one if there is a single actor or the
+  /// node is releasing unused workers.
+  ///
+  /// \param actors The actors to create, which are already in the leasing map.
+  /// \param node The node that the workers will be leased from.
+  void LeaseWorkersFromNode(const std::vector<std::shared_ptr<GcsActor>> &actors,
+                            std::shared_ptr<rpc::GcsNodeInfo> node);
+
   /// Handler to process a worker lease reply.
   ///
   /// \param actor The actor to be scheduled.
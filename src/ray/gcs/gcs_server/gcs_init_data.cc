@@ -14,11 +14,12 @@
 
 #include "ray/gcs/gcs_server/gcs_init_data.h"
 
+#include "ray/common/ray_config.h"
+
 namespace ray {
 namespace gcs {
 void GcsInitData::AsyncLoad(const EmptyCallback &on_done) {
-  // There are 6 kinds of table data need to be loaded.
-  auto count_down = std::make_shared<int>(5);
+  auto count_down = std::make_shared<int>(2);
   auto on_load_finished = [count_down, on_done] {
     if (--(*count_down) == 0) {
       if (on_done) {
@@ -27,9 +28,31 @@ void GcsInitData::AsyncLoad(const EmptyCallback &on_done) {
     }
   };
 
-  AsyncLoadJobTableData(on_load_finished);
+  AsyncLoadNodes(on_load_finished);
+
+  AsyncLoadOtherTables(on_load_finished);
+}
+
+void GcsInitData::AsyncLoadNodes(const EmptyCallback &on_done) {
+  AsyncLoadNodeTableData([on_done] {
+    if (on_done) {
+      on_done();
+    }
+  });
+}
+
+void GcsInitData::AsyncLoadOtherTables(const EmptyCallback &on_done) {
+  // There are 4 kinds of table data need to be loaded besides the nodes.
+  auto count_down = std::make_shared<int>(4);
+  auto on_load_finished = [count_down, on_done] {
+    if (--(*count_down) == 0) {
+      if (on_done) {
+        on_done();
+      }
+    }
+  };
 
-  AsyncLoadNodeTableData(on_load_finished);
+  AsyncLoadJobTableData(on_load_finished);
 
   AsyncLoadResourceTableData(on_load_finished);
 
@@ -40,66 +63,109 @@ void GcsInitData::AsyncLoad(const EmptyCallback &on_done) {
 
 void GcsInitData::AsyncLoadJobTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading job table data.";
-  auto load_job_table_data_callback =
-      [this, on_done](absl::flat_hash_map<JobID, rpc::JobTableData> &&result) {
-        job_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading job table data, size = "
-                      << job_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->JobTable().GetAll(load_job_table_data_callback));
+  auto on_page = [this](absl::flat_hash_map<JobID, rpc::JobTableData> &&page) {
+    job_table_data_.insert(std::make_move_iterator(page.begin()),
+                           std::make_move_iterator(page.end()));
+  };
+  auto on_loaded = [this, on_done](const Status &status) {
+    RAY_CHECK_OK(status);
+    RAY_LOG(INFO) << "Finished loading job table data, size = " << job_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->JobTable().GetAllPaged(on_page, on_loaded));
 }
 
 void GcsInitData::AsyncLoadNodeTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading node table data.";
-  auto load_node_table_data_callback =
-      [this, on_done](absl::flat_hash_map<NodeID, rpc::GcsNodeInfo> &&result) {
-        node_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading node table data, size = "
-                      << node_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->NodeTable().GetAll(load_node_table_data_callback));
+  auto on_page = [this](absl::flat_hash_map<NodeID, rpc::GcsNodeInfo> &&page) {
+    node_table_data_.insert(std::make_move_iterator(page.begin()),
+                            std::make_move_iterator(page.end()));
+  };
+  auto on_loaded = [this, on_done](const Status &status) {
+    RAY_CHECK_OK(status);
+    RAY_LOG(INFO) << "Finished loading node table data, size = "
+                  << node_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->NodeTable().GetAllPaged(on_page, on_loaded));
 }
 
 void GcsInitData::AsyncLoadResourceTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading cluster resources table data.";
-  auto load_resource_table_data_callback =
-      [this, on_done](absl::flat_hash_map<NodeID, rpc::ResourceMap> &&result) {
-        resource_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading cluster resources table data, size = "
-                      << resource_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(
-      gcs_table_storage_->NodeResourceTable().GetAll(load_resource_table_data_callback));
+  auto on_page = [this](absl::flat_hash_map<NodeID, rpc::ResourceMap> &&page) {
+    resource_table_data_.insert(std::make_move_iterator(page.begin()),
+                                std::make_move_iterator(page.end()));
+  };
+  auto on_loaded = [this, on_done](const Status &status) {
+    RAY_CHECK_OK(status);
+    RAY_LOG(INFO) << "Finished loading cluster resources table data, size = "
+                  << resource_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->NodeResourceTable().GetAllPaged(on_page, on_loaded));
 }
 
 void GcsInitData::AsyncLoadPlacementGroupTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading placement group table data.";
-  auto load_placement_group_table_data_callback =
-      [this, on_done](
-          absl::flat_hash_map<PlacementGroupID, rpc::PlacementGroupTableData> &&result) {
-        placement_group_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading placement group table data, size = "
-                      << placement_group_table_data_.size();
-        on_done();
+  auto on_page =
+      [this](absl::flat_hash_map<PlacementGroupID, rpc::PlacementGroupTableData> &&page) {
+        placement_group_table_data_.insert(std::make_move_iterator(page.begin()),
+                                           std::make_move_iterator(page.end()));
       };
-  RAY_CHECK_OK(gcs_table_storage_->PlacementGroupTable().GetAll(
-      load_placement_group_table_data_callback));
+  auto on_loaded = [this, on_done](const Status &status) {
+    RAY_CHECK_OK(status);
+    RAY_LOG(INFO) << "Finished loading placement group table data, size = "
+                  << placement_group_table_data_.size();
+    on_done();
+  };
+  RAY_CHECK_OK(
+      gcs_table_storage_->PlacementGroupTable().GetAllPaged(on_page, on_loaded));
 }
 
 void GcsInitData::AsyncLoadActorTableData(const EmptyCallback &on_done) {
   RAY_LOG(INFO) << "Loading actor table data.";
-  auto load_actor_table_data_callback =
-      [this, on_done](absl::flat_hash_map<ActorID, ActorTableData> &&result) {
-        actor_table_data_ = std::move(result);
-        RAY_LOG(INFO) << "Finished loading actor table data, size = "
-                      << actor_table_data_.size();
-        on_done();
-      };
-  RAY_CHECK_OK(gcs_table_storage_->ActorTable().GetAll(load_actor_table_data_callback));
+  // Dead actors are only kept up to the size of the cache of destroyed actors, so only
+  // the most recent ones are loaded. The others are deleted from the storage, like the
+  // cache does when it evicts them.
+  const size_t max_dead_actors =
+      RayConfig::instance().maximum_gcs_destroyed_actor_cached_count();
+  auto skipped_actor_ids = std::make_shared<std::vector<ActorID>>();
+  auto on_page = [this, max_dead_actors,
+                  skipped_actor_ids](absl::flat_hash_map<ActorID, ActorTableData> &&page) {
+    for (auto &entry : page) {
+      if (entry.second.state() == rpc::ActorTableData::DEAD) {
+        if (actor_table_data_.contains(entry.first)) {
+          continue;
+        }
+        dead_actors_by_time_.emplace(entry.second.timestamp(), entry.first);
+        if (dead_actors_by_time_.size() > max_dead_actors) {
+          auto oldest = dead_actors_by_time_.top();
+          dead_actors_by_time_.pop();
+          skipped_actor_ids->push_back(oldest.second);
+          if (oldest.second == entry.first) {
+            continue;
+          }
+          actor_table_data_.erase(oldest.second);
+        }
+      }
+      actor_table_data_[entry.first] = std::move(entry.second);
+    }
+  };
+  auto on_loaded = [this, on_done, skipped_actor_ids](const Status &status) {
+    RAY_CHECK_OK(status);
+    dead_actors_by_time_ = {};
+    RAY_LOG(INFO) << "Finished loading actor table data, size = "
+                  << actor_table_data_.size() << ", deleting "
+                  << skipped_actor_ids->size()
+                  << " dead actors beyond the destroyed actor cache.";
+    if (!skipped_actor_ids->empty()) {
+      RAY_CHECK_OK(
+          gcs_table_storage_->ActorTable().BatchDelete(*skipped_actor_ids, nullptr));
+    }
+    on_done();
+  };
+  RAY_CHECK_OK(gcs_table_storage_->ActorTable().GetAllPaged(on_page, on_loaded));
 }
 
 }  // namespace gcs
-}  // namespace ray
\ No newline at end of file
+}  // namespace ray
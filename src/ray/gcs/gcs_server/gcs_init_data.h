@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <queue>
+#include <utility>
+#include <vector>
+
 #include "ray/common/id.h"
 #include "ray/gcs/callback.h"
 #include "ray/gcs/gcs_server/gcs_table_storage.h"
@@ -25,7 +29,8 @@ namespace gcs {
 /// `GcsInitData` is used to initialize all modules which need to recovery status when GCS
 /// server restarts.
 /// It loads all required metadata from the store into memory at once, so that the next
-/// initialization process can be synchronized.
+/// initialization process can be synchronized. The tables are loaded in parallel, a
+/// page at a time, and only the most recent dead actors are kept.
 class GcsInitData {
  public:
   /// Create a GcsInitData.
@@ -39,6 +44,17 @@ class GcsInitData {
   /// \param on_done The callback when all metadatas are loaded successfully.
   void AsyncLoad(const EmptyCallback &on_done);
 
+  /// Load the node metadata only, so that nodes can be served while the other metadata
+  /// is loaded with `AsyncLoadOtherTables`.
+  ///
+  /// \param on_done The callback when node metadata is loaded successfully.
+  void AsyncLoadNodes(const EmptyCallback &on_done);
+
+  /// Load all required metadata but the node metadata asynchronously.
+  ///
+  /// \param on_done The callback when the metadata is loaded successfully.
+  void AsyncLoadOtherTables(const EmptyCallback &on_done);
+
   /// Get job metadata.
   const absl::flat_hash_map<JobID, rpc::JobTableData> &Jobs() const {
     return job_table_data_;
@@ -110,6 +126,18 @@ class GcsInitData {
 
   /// Actor metadata.
   absl::flat_hash_map<ActorID, rpc::ActorTableData> actor_table_data_;
+
+  /// Orders dead actors by their time of death, the oldest first.
+  struct DiedLater {
+    bool operator()(const std::pair<double, ActorID> &left,
+                    const std::pair<double, ActorID> &right) const {
+      return left.first > right.first;
+    }
+  };
+  /// The dead actors loaded so far, while the actor table is loaded.
+  std::priority_queue<std::pair<double, ActorID>, std::vector<std::pair<double, ActorID>>,
+                      DiedLater>
+      dead_actors_by_time_;
 };
 
 }  // namespace gcs
@@ -14,10 +14,14 @@
 
 #include "ray/gcs/gcs_server/gcs_kv_manager.h"
 
+#include <algorithm>
 #include <string_view>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
+#include "ray/common/asio/asio_util.h"
+#include "ray/common/ray_config.h"
 
 namespace ray {
 namespace gcs {
@@ -51,6 +55,68 @@ std::string ExtractKey(const std::string &key) {
 }
 }  // namespace
 
+void InternalKVInterface::MultiGet(
+    const std::string &ns, const std::vector<std::string> &keys,
+    std::function<void(absl::flat_hash_map<std::string, std::string>)> callback) {
+  if (keys.empty()) {
+    if (callback != nullptr) {
+      GetEventLoop().post(
+          std::bind(std::move(callback), absl::flat_hash_map<std::string, std::string>()),
+          "InternalKV.MultiGet");
+    }
+    return;
+  }
+  // The callbacks of the gets are called on the event loop of the kv, one at a time.
+  auto results = std::make_shared<absl::flat_hash_map<std::string, std::string>>();
+  auto num_pending = std::make_shared<size_t>(keys.size());
+  for (const auto &key : keys) {
+    Get(ns, key, [key, results, num_pending, callback](std::optional<std::string> value) {
+      if (value) {
+        (*results)[key] = std::move(*value);
+      }
+      if (--*num_pending == 0 && callback != nullptr) {
+        callback(std::move(*results));
+      }
+    });
+  }
+}
+
+void InternalKVInterface::MultiPut(
+    const std::string &ns,
+    const std::vector<std::pair<std::string, std::string>> &entries,
+    bool overwrite, std::function<void(int64_t)> callback) {
+  if (entries.empty()) {
+    if (callback != nullptr) {
+      GetEventLoop().post(std::bind(std::move(callback), 0), "InternalKV.MultiPut");
+    }
+    return;
+  }
+  auto num_added = std::make_shared<int64_t>(0);
+  auto num_pending = std::make_shared<size_t>(entries.size());
+  for (const auto &entry : entries) {
+    Put(ns, entry.first, entry.second, overwrite,
+        [num_added, num_pending, callback](bool added) {
+          if (added) {
+            ++*num_added;
+          }
+          if (--*num_pending == 0 && callback != nullptr) {
+            callback(*num_added);
+          }
+        });
+  }
+}
+
+void InternalKVInterface::Watch(
+    const std::string &ns, const std::string &prefix, int64_t since_version,
+    std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback) {
+  GetEventLoop().post(
+      [callback = std::move(callback)]() {
+        callback(Status::NotImplemented("Watching isn't supported by this internal kv."),
+                 0, {});
+      },
+      "InternalKV.Watch");
+}
+
 RedisInternalKV::RedisInternalKV(const RedisClientOptions &redis_options)
     : redis_options_(redis_options), work_(io_service_) {
   io_thread_ = std::make_unique<std::thread>([this] {
@@ -174,52 +240,141 @@ void MemoryInternalKV::Get(const std::string &ns, const std::string &key,
   }
 }
 
-void MemoryInternalKV::Put(const std::string &ns, const std::string &key,
-                           const std::string &value, bool overwrite,
-                           std::function<void(bool)> callback) {
+MemoryInternalKV::MemoryInternalKV(
+    instrumented_io_context &io_context, std::shared_ptr<StoreClient> store_client,
+    absl::flat_hash_map<std::string, std::string> persisted_keys)
+    : io_context_(io_context),
+      store_client_(std::move(store_client)),
+      max_history_size_(RayConfig::instance().gcs_kv_watch_history_size()),
+      watch_timeout_ms_(RayConfig::instance().gcs_kv_watch_timeout_ms()),
+      map_(std::make_move_iterator(persisted_keys.begin()),
+           std::make_move_iterator(persisted_keys.end())) {}
+
+MemoryInternalKV::~MemoryInternalKV() {
   absl::WriterMutexLock _(&mu_);
-  auto true_key = MakeKey(ns, key);
+  for (auto &entry : watchers_) {
+    entry.second.timeout_timer->cancel();
+  }
+}
+
+bool MemoryInternalKV::PutLocked(const std::string &true_key, const std::string &value,
+                                 bool overwrite, std::vector<std::string> *changed_keys) {
   auto it = map_.find(true_key);
-  bool inserted = false;
   if (it != map_.end()) {
     if (overwrite) {
       it->second = value;
+      RecordChange(true_key, value);
+      changed_keys->push_back(true_key);
+    }
+    return false;
+  }
+  map_.emplace(true_key, value);
+  RecordChange(true_key, value);
+  changed_keys->push_back(true_key);
+  return true;
+}
+
+void MemoryInternalKV::Persist(const std::vector<std::string> &changed_keys,
+                               bool deleted, std::function<void()> callback,
+                               const std::string &name) {
+  if (store_client_ == nullptr || changed_keys.empty()) {
+    if (callback != nullptr) {
+      io_context_.post(std::move(callback), name);
+    }
+    return;
+  }
+  // The writes are issued with the lock held, so the store client gets them in the
+  // order of the changes. As for the GCS tables, a failed write is fatal, because the
+  // change is already visible in memory and can't be rolled back.
+  auto on_done = [&io_context = io_context_, callback = std::move(callback),
+                  name](const Status &status) {
+    RAY_CHECK_OK(status);
+    if (callback != nullptr) {
+      io_context.post(callback, name);
     }
+  };
+  if (deleted) {
+    RAY_CHECK_OK(store_client_->AsyncBatchDelete(kStoreTableName, changed_keys, on_done));
   } else {
-    map_[true_key] = value;
-    inserted = true;
+    std::vector<BatchPutEntry> entries;
+    entries.reserve(changed_keys.size());
+    for (const auto &true_key : changed_keys) {
+      entries.push_back(BatchPutEntry{kStoreTableName, true_key, "", map_.at(true_key)});
+    }
+    RAY_CHECK_OK(store_client_->AsyncBatchPut(entries, on_done));
   }
-  if (callback != nullptr) {
-    io_context_.post(std::bind(std::move(callback), inserted), "MemoryInternalKV.Put");
+}
+
+void MemoryInternalKV::RecordChange(const std::string &true_key,
+                                    std::optional<std::string> value) {
+  ++version_;
+  if (max_history_size_ > 0) {
+    history_.push_back(KeyChange{true_key, version_});
+    if (history_.size() > max_history_size_) {
+      history_.pop_front();
+    }
+  }
+  for (auto it = watchers_.begin(); it != watchers_.end();) {
+    if (!absl::StartsWith(true_key, it->second.true_prefix)) {
+      ++it;
+      continue;
+    }
+    std::vector<InternalKVChange> changes{
+        InternalKVChange{ExtractKey(true_key), value, version_}};
+    io_context_.post(
+        [callback = std::move(it->second.callback),
+         timeout_timer = std::move(it->second.timeout_timer), version = version_,
+         changes = std::move(changes)]() {
+          timeout_timer->cancel();
+          callback(Status::OK(), version, std::move(changes));
+        },
+        "MemoryInternalKV.Watch");
+    watchers_.erase(it++);
   }
 }
 
+void MemoryInternalKV::Put(const std::string &ns, const std::string &key,
+                           const std::string &value, bool overwrite,
+                           std::function<void(bool)> callback) {
+  absl::WriterMutexLock _(&mu_);
+  std::vector<std::string> changed_keys;
+  bool inserted = PutLocked(MakeKey(ns, key), value, overwrite, &changed_keys);
+  Persist(changed_keys, /*deleted=*/false,
+          callback == nullptr ? std::function<void()>()
+                              : std::bind(std::move(callback), inserted),
+          "MemoryInternalKV.Put");
+}
+
 void MemoryInternalKV::Del(const std::string &ns, const std::string &key,
                            bool del_by_prefix, std::function<void(int64_t)> callback) {
   absl::WriterMutexLock _(&mu_);
   auto true_key = MakeKey(ns, key);
   auto it = map_.lower_bound(true_key);
-  int64_t del_num = 0;
+  std::vector<std::string> deleted_keys;
   while (it != map_.end()) {
     if (!del_by_prefix) {
       if (it->first == true_key) {
+        RecordChange(it->first, std::nullopt);
+        deleted_keys.push_back(it->first);
         map_.erase(it);
-        ++del_num;
       }
       break;
     }
 
     if (absl::StartsWith(it->first, true_key)) {
+      RecordChange(it->first, std::nullopt);
+      deleted_keys.push_back(it->first);
       it = map_.erase(it);
-      ++del_num;
     } else {
       break;
     }
   }
 
-  if (callback != nullptr) {
-    io_context_.post(std::bind(std::move(callback), del_num), "MemoryInternalKV.Del");
-  }
+  int64_t del_num = deleted_keys.size();
+  Persist(deleted_keys, /*deleted=*/true,
+          callback == nullptr ? std::function<void()>()
+                              : std::bind(std::move(callback), del_num),
+          "MemoryInternalKV.Del");
 }
 
 void MemoryInternalKV::Exists(const std::string &ns, const std::string &key,
@@ -248,6 +403,214 @@ void MemoryInternalKV::Keys(const std::string &ns, const std::string &prefix,
   }
 }
 
+template <typename T>
+std::function<void(T)> ForwardingInternalKV::OnEventLoop(std::function<void(T)> callback,
+                                                         const std::string &name) {
+  if (callback == nullptr) {
+    return nullptr;
+  }
+  return [this, callback = std::move(callback), name](T result) {
+    io_context_.post(std::bind(callback, std::move(result)), name);
+  };
+}
+
+void MemoryInternalKV::MultiGet(
+    const std::string &ns, const std::vector<std::string> &keys,
+    std::function<void(absl::flat_hash_map<std::string, std::string>)> callback) {
+  absl::ReaderMutexLock lock(&mu_);
+  absl::flat_hash_map<std::string, std::string> results;
+  for (const auto &key : keys) {
+    auto it = map_.find(MakeKey(ns, key));
+    if (it != map_.end()) {
+      results.emplace(key, it->second);
+    }
+  }
+  if (callback != nullptr) {
+    io_context_.post(std::bind(std::move(callback), std::move(results)),
+                     "MemoryInternalKV.MultiGet");
+  }
+}
+
+void MemoryInternalKV::MultiPut(
+    const std::string &ns,
+    const std::vector<std::pair<std::string, std::string>> &entries,
+    bool overwrite, std::function<void(int64_t)> callback) {
+  absl::WriterMutexLock _(&mu_);
+  int64_t num_added = 0;
+  std::vector<std::string> changed_keys;
+  for (const auto &entry : entries) {
+    if (PutLocked(MakeKey(ns, entry.first), entry.second, overwrite, &changed_keys)) {
+      ++num_added;
+    }
+  }
+  Persist(changed_keys, /*deleted=*/false,
+          callback == nullptr ? std::function<void()>()
+                              : std::bind(std::move(callback), num_added),
+          "MemoryInternalKV.MultiPut");
+}
+
+void MemoryInternalKV::Watch(
+    const std::string &ns, const std::string &prefix, int64_t since_version,
+    std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback) {
+  absl::WriterMutexLock _(&mu_);
+  auto reply = [this, &callback](Status status, std::vector<InternalKVChange> changes) {
+    io_context_.post(
+        [callback = std::move(callback), status, version = version_,
+         changes = std::move(changes)]() {
+          callback(status, version, std::move(changes));
+        },
+        "MemoryInternalKV.Watch");
+  };
+  if (since_version < 0) {
+    reply(Status::OK(), {});
+    return;
+  }
+  // The version of the oldest change that is kept.
+  int64_t oldest_version = history_.empty() ? version_ + 1 : history_.front().version;
+  if (since_version > version_ || since_version + 1 < oldest_version) {
+    reply(Status::Invalid(absl::StrCat("The changes after version ", since_version,
+                                       " aren't kept, the current version is ",
+                                       version_, ".")),
+          {});
+    return;
+  }
+
+  auto true_prefix = MakeKey(ns, prefix);
+  // Only the last change of a key is returned, with the current value of the key.
+  std::vector<InternalKVChange> changes;
+  absl::flat_hash_set<std::string_view> changed_keys;
+  for (auto it = history_.rbegin();
+       it != history_.rend() && it->version > since_version; ++it) {
+    if (!absl::StartsWith(it->true_key, true_prefix) ||
+        !changed_keys.insert(it->true_key).second) {
+      continue;
+    }
+    auto map_it = map_.find(it->true_key);
+    changes.push_back(InternalKVChange{
+        ExtractKey(it->true_key),
+        map_it == map_.end() ? std::nullopt : std::make_optional(map_it->second),
+        it->version});
+  }
+  std::reverse(changes.begin(), changes.end());
+  if (!changes.empty()) {
+    reply(Status::OK(), std::move(changes));
+    return;
+  }
+
+  auto watcher_id = next_watcher_id_++;
+  auto timeout_timer = execute_after(
+      io_context_, [this, watcher_id]() { TimeoutWatcher(watcher_id); },
+      watch_timeout_ms_);
+  watchers_.emplace(watcher_id, Watcher{std::move(true_prefix), std::move(callback),
+                                        std::move(timeout_timer)});
+}
+
+void MemoryInternalKV::TimeoutWatcher(uint64_t watcher_id) {
+  std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback;
+  int64_t version;
+  {
+    absl::WriterMutexLock _(&mu_);
+    auto it = watchers_.find(watcher_id);
+    if (it == watchers_.end()) {
+      return;
+    }
+    callback = std::move(it->second.callback);
+    version = version_;
+    watchers_.erase(it);
+  }
+  callback(Status::OK(), version, {});
+}
+
+void ForwardingInternalKV::Get(const std::string &ns, const std::string &key,
+                               std::function<void(std::optional<std::string>)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.Get");
+  kv_.GetEventLoop().post(
+      [this, ns, key, on_done = std::move(on_done)]() { kv_.Get(ns, key, on_done); },
+      "ForwardingInternalKV.Get");
+}
+
+void ForwardingInternalKV::Put(const std::string &ns, const std::string &key,
+                               const std::string &value, bool overwrite,
+                               std::function<void(bool)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.Put");
+  kv_.GetEventLoop().post(
+      [this, ns, key, value, overwrite, on_done = std::move(on_done)]() {
+        kv_.Put(ns, key, value, overwrite, on_done);
+      },
+      "ForwardingInternalKV.Put");
+}
+
+void ForwardingInternalKV::Del(const std::string &ns, const std::string &key,
+                               bool del_by_prefix,
+                               std::function<void(int64_t)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.Del");
+  kv_.GetEventLoop().post(
+      [this, ns, key, del_by_prefix, on_done = std::move(on_done)]() {
+        kv_.Del(ns, key, del_by_prefix, on_done);
+      },
+      "ForwardingInternalKV.Del");
+}
+
+void ForwardingInternalKV::Exists(const std::string &ns, const std::string &key,
+                                  std::function<void(bool)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.Exists");
+  kv_.GetEventLoop().post(
+      [this, ns, key, on_done = std::move(on_done)]() { kv_.Exists(ns, key, on_done); },
+      "ForwardingInternalKV.Exists");
+}
+
+void ForwardingInternalKV::Keys(const std::string &ns, const std::string &prefix,
+                                std::function<void(std::vector<std::string>)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.Keys");
+  kv_.GetEventLoop().post(
+      [this, ns, prefix, on_done = std::move(on_done)]() {
+        kv_.Keys(ns, prefix, on_done);
+      },
+      "ForwardingInternalKV.Keys");
+}
+
+void ForwardingInternalKV::MultiGet(
+    const std::string &ns, const std::vector<std::string> &keys,
+    std::function<void(absl::flat_hash_map<std::string, std::string>)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.MultiGet");
+  kv_.GetEventLoop().post(
+      [this, ns, keys, on_done = std::move(on_done)]() {
+        kv_.MultiGet(ns, keys, on_done);
+      },
+      "ForwardingInternalKV.MultiGet");
+}
+
+void ForwardingInternalKV::MultiPut(
+    const std::string &ns,
+    const std::vector<std::pair<std::string, std::string>> &entries,
+    bool overwrite, std::function<void(int64_t)> callback) {
+  auto on_done = OnEventLoop(std::move(callback), "ForwardingInternalKV.MultiPut");
+  kv_.GetEventLoop().post(
+      [this, ns, entries, overwrite, on_done = std::move(on_done)]() {
+        kv_.MultiPut(ns, entries, overwrite, on_done);
+      },
+      "ForwardingInternalKV.MultiPut");
+}
+
+void ForwardingInternalKV::Watch(
+    const std::string &ns, const std::string &prefix, int64_t since_version,
+    std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback) {
+  auto on_done = [this, callback = std::move(callback)](
+                     Status status, int64_t version,
+                     std::vector<InternalKVChange> changes) {
+    io_context_.post(
+        [callback, status, version, changes = std::move(changes)]() {
+          callback(status, version, std::move(changes));
+        },
+        "ForwardingInternalKV.Watch");
+  };
+  kv_.GetEventLoop().post(
+      [this, ns, prefix, since_version, on_done = std::move(on_done)]() {
+        kv_.Watch(ns, prefix, since_version, on_done);
+      },
+      "ForwardingInternalKV.Watch");
+}
+
 void GcsInternalKVManager::HandleInternalKVGet(
     const rpc::InternalKVGetRequest &request, rpc::InternalKVGetReply *reply,
     rpc::SendReplyCallback send_reply_callback) {
@@ -333,5 +696,79 @@ void GcsInternalKVManager::HandleInternalKVKeys(
   }
 }
 
+void GcsInternalKVManager::HandleInternalKVMultiGet(
+    const rpc::InternalKVMultiGetRequest &request, rpc::InternalKVMultiGetReply *reply,
+    rpc::SendReplyCallback send_reply_callback) {
+  std::vector<std::string> keys;
+  keys.reserve(request.keys_size());
+  for (const auto &key : request.keys()) {
+    auto status = ValidateKey(key);
+    if (!status.ok()) {
+      GCS_RPC_SEND_REPLY(send_reply_callback, reply, status);
+      return;
+    }
+    keys.push_back(key);
+  }
+  auto callback = [reply, send_reply_callback](
+                      absl::flat_hash_map<std::string, std::string> results) {
+    for (auto &result : results) {
+      auto entry = reply->add_results();
+      entry->set_key(result.first);
+      entry->set_value(std::move(result.second));
+    }
+    GCS_RPC_SEND_REPLY(send_reply_callback, reply, Status::OK());
+  };
+  kv_instance_->MultiGet(request.namespace_(), keys, std::move(callback));
+}
+
+void GcsInternalKVManager::HandleInternalKVMultiPut(
+    const rpc::InternalKVMultiPutRequest &request, rpc::InternalKVMultiPutReply *reply,
+    rpc::SendReplyCallback send_reply_callback) {
+  std::vector<std::pair<std::string, std::string>> entries;
+  entries.reserve(request.entries_size());
+  for (const auto &entry : request.entries()) {
+    auto status = ValidateKey(entry.key());
+    if (!status.ok()) {
+      GCS_RPC_SEND_REPLY(send_reply_callback, reply, status);
+      return;
+    }
+    entries.emplace_back(entry.key(), entry.value());
+  }
+  auto callback = [reply, send_reply_callback](int64_t added_num) {
+    reply->set_added_num(added_num);
+    GCS_RPC_SEND_REPLY(send_reply_callback, reply, Status::OK());
+  };
+  kv_instance_->MultiPut(request.namespace_(), entries, request.overwrite(),
+                         std::move(callback));
+}
+
+void GcsInternalKVManager::HandleInternalKVWatch(
+    const rpc::InternalKVWatchRequest &request, rpc::InternalKVWatchReply *reply,
+    rpc::SendReplyCallback send_reply_callback) {
+  auto status = ValidateKey(request.prefix());
+  if (!status.ok()) {
+    GCS_RPC_SEND_REPLY(send_reply_callback, reply, status);
+  } else {
+    auto callback = [reply, send_reply_callback](
+                        Status status, int64_t version,
+                        std::vector<InternalKVChange> changes) {
+      reply->set_version(version);
+      for (auto &change : changes) {
+        auto reply_change = reply->add_changes();
+        reply_change->set_key(std::move(change.key));
+        if (change.value) {
+          reply_change->set_value(std::move(*change.value));
+        } else {
+          reply_change->set_deleted(true);
+        }
+        reply_change->set_version(change.version);
+      }
+      GCS_RPC_SEND_REPLY(send_reply_callback, reply, status);
+    };
+    kv_instance_->Watch(request.namespace_(), request.prefix(), request.since_version(),
+                        std::move(callback));
+  }
+}
+
 }  // namespace gcs
 }  // namespace ray
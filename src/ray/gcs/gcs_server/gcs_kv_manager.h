@@ -13,9 +13,11 @@
 // limitations under the License.
 
 #pragma once
+#include <deque>
 #include <memory>
 
 #include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/gcs/redis_client.h"
 #include "ray/gcs/store_client/redis_store_client.h"
@@ -24,6 +26,16 @@
 namespace ray {
 namespace gcs {
 
+/// A change made to a key of the internal kv, which is sent to the watchers of the key.
+struct InternalKVChange {
+  /// The key that changed.
+  std::string key;
+  /// The new value of the key, or nullopt if the key was deleted.
+  std::optional<std::string> value;
+  /// The version of the kv right after the change.
+  int64_t version;
+};
+
 /// \class InternalKVInterface
 /// The interface for internal kv implementation. Ideally we should merge this
 /// with store client, but due to compatibility issue, we keep them separated
@@ -76,6 +88,54 @@ class InternalKVInterface {
   virtual void Keys(const std::string &ns, const std::string &prefix,
                     std::function<void(std::vector<std::string>)> callback) = 0;
 
+  /// Get the values associated with `keys`, in one operation.
+  ///
+  /// By default, this gets the keys one by one.
+  ///
+  /// \param ns The namespace of the keys.
+  /// \param keys The keys to fetch.
+  /// \param callback Callback function, called with the keys that exist and their
+  /// values.
+  virtual void MultiGet(
+      const std::string &ns, const std::vector<std::string> &keys,
+      std::function<void(absl::flat_hash_map<std::string, std::string>)> callback);
+
+  /// Associate each key of `entries` with its value, in one operation.
+  ///
+  /// By default, this puts the keys one by one.
+  ///
+  /// \param ns The namespace of the keys.
+  /// \param entries The key-value pairs.
+  /// \param overwrite Whether to overwrite existing values. Otherwise, the update
+  ///   of a key that exists will be ignored.
+  /// \param callback Callback function, called with the number of keys added.
+  virtual void MultiPut(const std::string &ns,
+                        const std::vector<std::pair<std::string, std::string>> &entries,
+                        bool overwrite, std::function<void(int64_t)> callback);
+
+  /// Watch the keys with a prefix for changes, as a long poll.
+  ///
+  /// The callback is called with the changes made to the keys after `since_version`, as
+  /// soon as there is one, or with no changes when the poll times out. The changes that
+  /// were made before the watch are returned with the current value of their key, once
+  /// per key. The caller watches again from the version the callback is called with. A
+  /// negative `since_version` returns the current version right away, so that the
+  /// caller can read the keys and then watch them from that version without missing a
+  /// change.
+  ///
+  /// By default, watching isn't supported and the callback is called with
+  /// `Status::NotImplemented`.
+  ///
+  /// \param ns The namespace of the prefix.
+  /// \param prefix The prefix of the keys to watch.
+  /// \param since_version The version after which changes are returned.
+  /// \param callback Callback function, called with the status, the current version
+  /// of the kv and the changes. The status is `Status::Invalid` if the changes after
+  /// `since_version` are no longer kept, in which case the caller reads the keys again.
+  virtual void Watch(
+      const std::string &ns, const std::string &prefix, int64_t since_version,
+      std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback);
+
   /// Return the event loop associated with the instance. This is where the
   /// callback is called.
   virtual instrumented_io_context &GetEventLoop() = 0;
@@ -120,9 +180,27 @@ class RedisInternalKV : public InternalKVInterface {
   boost::asio::io_service::work work_;
 };
 
+/// An internal kv that keeps the data in an ordered map in memory, so that the prefix
+/// operations cost O(log n + k) for k matching keys. It keeps a bounded history of the
+/// keys that changed to serve watchers, without their values.
+///
+/// If it's given a store client, the keys are persisted to it too: every change is
+/// written to the store client, and its callback is called once the write is done.
 class MemoryInternalKV : public InternalKVInterface {
  public:
-  MemoryInternalKV(instrumented_io_context &io_context) : io_context_(io_context) {}
+  /// The table of the store client that the keys are persisted to.
+  static constexpr char kStoreTableName[] = "InternalKV";
+
+  /// \param io_context The event loop that the callbacks are called on.
+  /// \param store_client The store client that the keys are persisted to, or nullptr if
+  /// they are only kept in memory.
+  /// \param persisted_keys The keys that were persisted to the store client before,
+  /// read from its `kStoreTableName` table.
+  MemoryInternalKV(instrumented_io_context &io_context,
+                   std::shared_ptr<StoreClient> store_client = nullptr,
+                   absl::flat_hash_map<std::string, std::string> persisted_keys = {});
+
+  ~MemoryInternalKV();
   void Get(const std::string &ns, const std::string &key,
            std::function<void(std::optional<std::string>)> callback) override;
 
@@ -138,12 +216,128 @@ class MemoryInternalKV : public InternalKVInterface {
   void Keys(const std::string &ns, const std::string &prefix,
             std::function<void(std::vector<std::string>)> callback) override;
 
+  void MultiGet(const std::string &ns, const std::vector<std::string> &keys,
+                std::function<void(absl::flat_hash_map<std::string, std::string>)>
+                    callback) override;
+
+  void MultiPut(const std::string &ns,
+                const std::vector<std::pair<std::string, std::string>> &entries,
+                bool overwrite, std::function<void(int64_t)> callback) override;
+
+  void Watch(const std::string &ns, const std::string &prefix, int64_t since_version,
+             std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback)
+      override;
+
   instrumented_io_context &GetEventLoop() override { return io_context_; }
 
  private:
+  /// A change in the history. The value is read from the map when the change is
+  /// returned, so that the history doesn't keep values that were overwritten or
+  /// deleted.
+  struct KeyChange {
+    /// The key that changed, including the namespace.
+    std::string true_key;
+    /// The version of the kv right after the change.
+    int64_t version;
+  };
+
+  struct Watcher {
+    /// The prefix that is watched, including the namespace.
+    std::string true_prefix;
+    std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback;
+    /// The timer that ends the poll.
+    std::shared_ptr<boost::asio::deadline_timer> timeout_timer;
+  };
+
+  /// Put a key, and record the change if there is one.
+  ///
+  /// \param changed_keys The key is appended to it if it's changed.
+  /// \return Whether the key was added.
+  bool PutLocked(const std::string &true_key, const std::string &value, bool overwrite,
+                 std::vector<std::string> *changed_keys) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Write the changed keys to the store client, if there is one, then post the
+  /// callback of the operation that changed them.
+  ///
+  /// \param changed_keys The keys that were put or deleted.
+  /// \param deleted Whether the keys were deleted.
+  void Persist(const std::vector<std::string> &changed_keys, bool deleted,
+               std::function<void()> callback, const std::string &name)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Record a change to a key in the history, and reply to the watchers of the key.
+  void RecordChange(const std::string &true_key, std::optional<std::string> value)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Reply to a watcher with no changes, if it's still waiting.
+  void TimeoutWatcher(uint64_t watcher_id) LOCKS_EXCLUDED(mu_);
+
   instrumented_io_context &io_context_;
+  const std::shared_ptr<StoreClient> store_client_;
+  /// The maximum number of changes kept in the history.
+  const size_t max_history_size_;
+  const int64_t watch_timeout_ms_;
   absl::Mutex mu_;
   absl::btree_map<std::string, std::string> map_ GUARDED_BY(mu_);
+  /// The version of the kv, which is increased by every change.
+  int64_t version_ GUARDED_BY(mu_) = 0;
+  /// The most recent changes, in the order they were made. The versions of the changes
+  /// are consecutive.
+  std::deque<KeyChange> history_ GUARDED_BY(mu_);
+  /// The watchers that wait for a change, by their ID. There are few watchers, so
+  /// every change is checked against all of them.
+  absl::flat_hash_map<uint64_t, Watcher> watchers_ GUARDED_BY(mu_);
+  uint64_t next_watcher_id_ GUARDED_BY(mu_) = 0;
+};
+
+/// An internal kv that sends every operation to the event loop of another internal kv,
+/// and calls the callbacks on its own event loop. It lets a manager that runs on one
+/// event loop use the kv that is served on another one, by passing messages between the
+/// two loops instead of sharing the state of the manager between threads.
+class ForwardingInternalKV : public InternalKVInterface {
+ public:
+  /// \param kv The internal kv that the operations are sent to.
+  /// \param io_context The event loop that the callbacks are called on.
+  ForwardingInternalKV(InternalKVInterface &kv, instrumented_io_context &io_context)
+      : kv_(kv), io_context_(io_context) {}
+
+  void Get(const std::string &ns, const std::string &key,
+           std::function<void(std::optional<std::string>)> callback) override;
+
+  void Put(const std::string &ns, const std::string &key, const std::string &value,
+           bool overwrite, std::function<void(bool)> callback) override;
+
+  void Del(const std::string &ns, const std::string &key, bool del_by_prefix,
+           std::function<void(int64_t)> callback) override;
+
+  void Exists(const std::string &ns, const std::string &key,
+              std::function<void(bool)> callback) override;
+
+  void Keys(const std::string &ns, const std::string &prefix,
+            std::function<void(std::vector<std::string>)> callback) override;
+
+  void MultiGet(const std::string &ns, const std::vector<std::string> &keys,
+                std::function<void(absl::flat_hash_map<std::string, std::string>)>
+                    callback) override;
+
+  void MultiPut(const std::string &ns,
+                const std::vector<std::pair<std::string, std::string>> &entries,
+                bool overwrite, std::function<void(int64_t)> callback) override;
+
+  void Watch(const std::string &ns, const std::string &prefix, int64_t since_version,
+             std::function<void(Status, int64_t, std::vector<InternalKVChange>)> callback)
+      override;
+
+  instrumented_io_context &GetEventLoop() override { return io_context_; }
+
+ private:
+  /// Wrap a callback so that it's posted to `io_context_` when it's called.
+  template <typename T>
+  std::function<void(T)> OnEventLoop(std::function<void(T)> callback,
+                                     const std::string &name);
+
+  InternalKVInterface &kv_;
+  instrumented_io_context &io_context_;
 };
 
 /// This implementation class of `InternalKVHandler`.
@@ -172,6 +366,18 @@ class GcsInternalKVManager : public rpc::InternalKVHandler {
                             rpc::InternalKVKeysReply *reply,
                             rpc::SendReplyCallback send_reply_callback) override;
 
+  void HandleInternalKVMultiGet(const rpc::InternalKVMultiGetRequest &request,
+                                rpc::InternalKVMultiGetReply *reply,
+                                rpc::SendReplyCallback send_reply_callback) override;
+
+  void HandleInternalKVMultiPut(const rpc::InternalKVMultiPutRequest &request,
+                                rpc::InternalKVMultiPutReply *reply,
+                                rpc::SendReplyCallback send_reply_callback) override;
+
+  void HandleInternalKVWatch(const rpc::InternalKVWatchRequest &request,
+                             rpc::InternalKVWatchReply *reply,
+                             rpc::SendReplyCallback send_reply_callback) override;
+
   InternalKVInterface &GetInstance() { return *kv_instance_; }
 
   instrumented_io_context &GetEventLoop() { return kv_instance_->GetEventLoop(); }
@@ -14,7 +14,11 @@
 
 #include "ray/gcs/gcs_server/gcs_placement_group_scheduler.h"
 
+#include <cmath>
+
+#include "ray/common/asio/asio_util.h"
 #include "ray/gcs/gcs_server/gcs_placement_group_manager.h"
+#include "ray/stats/metric_defs.h"
 #include "src/ray/protobuf/gcs.pb.h"
 
 namespace {
@@ -52,7 +56,8 @@ GcsPlacementGroupScheduler::GcsPlacementGroupScheduler(
     GcsResourceScheduler &gcs_resource_scheduler,
     std::shared_ptr<rpc::NodeManagerClientPool> raylet_client_pool,
     syncer::RaySyncer &ray_syncer)
-    : return_timer_(io_context),
+    : io_context_(io_context),
+      return_timer_(io_context),
       gcs_table_storage_(std::move(gcs_table_storage)),
       gcs_node_manager_(gcs_node_manager),
       gcs_resource_manager_(gcs_resource_manager),
@@ -196,7 +201,17 @@ void GcsPlacementGroupScheduler::ScheduleUnplacedBundles(
                 .emplace(placement_group->GetPlacementGroupID(), lease_status_tracker)
                 .second);
 
-  const auto &pending_bundles = GetUnplacedBundlesPerNode(bundles, selected_nodes);
+  PrepareBundles(lease_status_tracker, bundles, selected_nodes, failure_callback,
+                 success_callback);
+}
+
+void GcsPlacementGroupScheduler::PrepareBundles(
+    const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
+    const std::vector<std::shared_ptr<const BundleSpecification>> &bundles,
+    const ScheduleMap &schedule_map,
+    const PGSchedulingFailureCallback &schedule_failure_handler,
+    const PGSchedulingSuccessfulCallback &schedule_success_handler) {
+  const auto &pending_bundles = GetUnplacedBundlesPerNode(bundles, schedule_map);
   for (const auto &node_to_bundles : pending_bundles) {
     const auto &node_id = node_to_bundles.first;
     const auto &bundles_per_node = node_to_bundles.second;
@@ -208,20 +223,83 @@ void GcsPlacementGroupScheduler::ScheduleUnplacedBundles(
     // handle this case properly.
     PrepareResources(bundles_per_node, gcs_node_manager_.GetAliveNode(node_id),
                      [this, bundles_per_node, node_id, lease_status_tracker,
-                      failure_callback, success_callback](const Status &status) {
+                      schedule_failure_handler,
+                      schedule_success_handler](const Status &status) {
                        for (const auto &bundle : bundles_per_node) {
                          lease_status_tracker->MarkPrepareRequestReturned(node_id, bundle,
                                                                           status);
                        }
 
                        if (lease_status_tracker->AllPrepareRequestsReturned()) {
-                         OnAllBundlePrepareRequestReturned(
-                             lease_status_tracker, failure_callback, success_callback);
+                         OnAllBundlePrepareRequestReturned(lease_status_tracker,
+                                                           schedule_failure_handler,
+                                                           schedule_success_handler);
                        }
                      });
   }
 }
 
+bool GcsPlacementGroupScheduler::CanRescheduleUnpreparedBundles(
+    const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker) const {
+  // The bundles of a STRICT_PACK placement group have to be on the same node, so the
+  // unprepared ones can't be moved on their own.
+  return lease_status_tracker->GetPrepareRetryCount() <
+             RayConfig::instance().gcs_placement_group_prepare_retry_rounds() &&
+         lease_status_tracker->GetLeasingState() != LeasingState::CANCELLED &&
+         lease_status_tracker->GetPlacementGroup()->GetStrategy() !=
+             rpc::PlacementStrategy::STRICT_PACK;
+}
+
+bool GcsPlacementGroupScheduler::RescheduleUnpreparedBundles(
+    const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
+    const PGSchedulingFailureCallback &schedule_failure_handler,
+    const PGSchedulingSuccessfulCallback &schedule_success_handler) {
+  const auto &placement_group = lease_status_tracker->GetPlacementGroup();
+  const auto &placement_group_id = placement_group->GetPlacementGroupID();
+  // The placement group may have been removed during the backoff.
+  if (!CanRescheduleUnpreparedBundles(lease_status_tracker)) {
+    return false;
+  }
+
+  const auto &unprepared_bundles = lease_status_tracker->GetUnpreparedBundles();
+  const auto &prepared_bundle_locations =
+      lease_status_tracker->GetPreparedBundleLocations();
+
+  // The prepared bundles hold their resources, and count as bundles of the placement
+  // group, while the unprepared ones are rescheduled.
+  auto held_bundle_locations = std::make_shared<BundleLocations>();
+  for (const auto &iter : *prepared_bundle_locations) {
+    if (gcs_resource_manager_.AcquireResources(
+            iter.second.first, iter.second.second->GetRequiredResources())) {
+      held_bundle_locations->insert(iter);
+    }
+  }
+  auto context = GetScheduleContext(placement_group_id);
+  auto bundle_locations = std::make_shared<BundleLocations>(*prepared_bundle_locations);
+  if (context->bundle_locations_.has_value()) {
+    bundle_locations->insert(context->bundle_locations_.value()->begin(),
+                             context->bundle_locations_.value()->end());
+  }
+  auto retry_context = std::unique_ptr<ScheduleContext>(
+      new ScheduleContext(context->node_to_bundles_, bundle_locations));
+  auto scheduling_result =
+      scheduler_strategies_[placement_group->GetStrategy()]->Schedule(
+          unprepared_bundles, retry_context, gcs_resource_scheduler_);
+  ReturnBundleResources(held_bundle_locations);
+  if (scheduling_result.first != SchedulingResultStatus::SUCCESS) {
+    return false;
+  }
+
+  RAY_LOG(DEBUG) << "Preparing " << unprepared_bundles.size()
+                 << " bundles of placement group " << placement_group_id
+                 << " again, while the other "
+                 << prepared_bundle_locations->size() << " stay prepared.";
+  lease_status_tracker->MarkPrepareRetryStarted(scheduling_result.second);
+  PrepareBundles(lease_status_tracker, unprepared_bundles, scheduling_result.second,
+                 schedule_failure_handler, schedule_success_handler);
+  return true;
+}
+
 void GcsPlacementGroupScheduler::DestroyPlacementGroupBundleResourcesIfExists(
     const PlacementGroupID &placement_group_id) {
   auto &bundle_locations =
@@ -416,19 +494,37 @@ void GcsPlacementGroupScheduler::OnAllBundlePrepareRequestReturned(
   const auto &placement_group_id = placement_group->GetPlacementGroupID();
 
   if (!lease_status_tracker->AllPrepareRequestsSuccessful()) {
-    // Erase the status tracker from a in-memory map if exists.
-    // NOTE: A placement group may be scheduled several times to succeed.
-    // If a prepare failure occurs during scheduling, we just need to release the prepared
-    // bundle resources of this scheduling.
-    DestroyPlacementGroupPreparedBundleResources(placement_group_id);
-    auto it = placement_group_leasing_in_progress_.find(placement_group_id);
-    RAY_CHECK(it != placement_group_leasing_in_progress_.end());
-    placement_group_leasing_in_progress_.erase(it);
-    ReturnBundleResources(lease_status_tracker->GetBundleLocations());
-    schedule_failure_handler(placement_group, /*is_feasible*/ true);
+    if (!CanRescheduleUnpreparedBundles(lease_status_tracker)) {
+      OnPrepareFailed(lease_status_tracker, schedule_failure_handler);
+      return;
+    }
+    // Only reschedule the bundles that failed to prepare, after backing off the same way
+    // the whole placement group would, so that the nodes that just rejected them
+    // aren't asked again right away.
+    const auto delay_ms = std::min<double>(
+        RayConfig::instance().gcs_create_placement_group_retry_min_interval_ms() *
+            std::pow(RayConfig::instance().gcs_create_placement_group_retry_multiplier(),
+                     lease_status_tracker->GetPrepareRetryCount()),
+        RayConfig::instance().gcs_create_placement_group_retry_max_interval_ms());
+    RAY_UNUSED(execute_after(
+        io_context_,
+        [this, lease_status_tracker, schedule_failure_handler,
+         schedule_success_handler] {
+          if (!RescheduleUnpreparedBundles(lease_status_tracker, schedule_failure_handler,
+                                           schedule_success_handler)) {
+            OnPrepareFailed(lease_status_tracker, schedule_failure_handler);
+          }
+        },
+        static_cast<int64_t>(delay_ms)));
     return;
   }
 
+  ray::stats::STATS_gcs_placement_group_two_phase_commit_latency_ms.Record(
+      absl::Nanoseconds(absl::GetCurrentTimeNanos() -
+                        lease_status_tracker->GetPrepareStartedTimeNs()) /
+          absl::Milliseconds(1),
+      "Prepare");
+
   // If the prepare requests succeed, update the bundle location.
   for (const auto &iter : *prepared_bundle_locations) {
     const auto &location = iter.second;
@@ -453,6 +549,23 @@ void GcsPlacementGroupScheduler::OnAllBundlePrepareRequestReturned(
       }));
 }
 
+void GcsPlacementGroupScheduler::OnPrepareFailed(
+    const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
+    const PGSchedulingFailureCallback &schedule_failure_handler) {
+  const auto &placement_group = lease_status_tracker->GetPlacementGroup();
+  const auto &placement_group_id = placement_group->GetPlacementGroupID();
+  // Erase the status tracker from a in-memory map if exists.
+  // NOTE: A placement group may be scheduled several times to succeed.
+  // If a prepare failure occurs during scheduling, we just need to release the prepared
+  // bundle resources of this scheduling.
+  DestroyPlacementGroupPreparedBundleResources(placement_group_id);
+  auto it = placement_group_leasing_in_progress_.find(placement_group_id);
+  RAY_CHECK(it != placement_group_leasing_in_progress_.end());
+  placement_group_leasing_in_progress_.erase(it);
+  ReturnBundleResources(lease_status_tracker->GetBundleLocations());
+  schedule_failure_handler(placement_group, /*is_feasible*/ true);
+}
+
 void GcsPlacementGroupScheduler::OnAllBundleCommitRequestReturned(
     const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
     const PGSchedulingFailureCallback &schedule_failure_handler,
@@ -462,6 +575,12 @@ void GcsPlacementGroupScheduler::OnAllBundleCommitRequestReturned(
       lease_status_tracker->GetPreparedBundleLocations();
   const auto &placement_group_id = placement_group->GetPlacementGroupID();
 
+  ray::stats::STATS_gcs_placement_group_two_phase_commit_latency_ms.Record(
+      absl::Nanoseconds(absl::GetCurrentTimeNanos() -
+                        lease_status_tracker->GetCommitStartedTimeNs()) /
+          absl::Milliseconds(1),
+      "Commit");
+
   // Clean up the leasing progress map.
   auto it = placement_group_leasing_in_progress_.find(placement_group_id);
   RAY_CHECK(it != placement_group_leasing_in_progress_.end());
@@ -501,6 +620,14 @@ void GcsPlacementGroupScheduler::OnAllBundleCommitRequestReturned(
     ReturnBundleResources(uncommitted_bundle_locations);
     schedule_failure_handler(placement_group, /*is_feasible*/ true);
   } else {
+    const auto creation_request_received_ns =
+        placement_group->GetStats().creation_request_received_ns();
+    if (creation_request_received_ns > 0) {
+      ray::stats::STATS_gcs_placement_group_two_phase_commit_latency_ms.Record(
+          absl::Nanoseconds(absl::GetCurrentTimeNanos() - creation_request_received_ns) /
+              absl::Milliseconds(1),
+          "CreationToCommit");
+    }
     schedule_success_handler(placement_group);
   }
 }
@@ -757,7 +884,9 @@ LeaseStatusTracker::LeaseStatusTracker(
     std::shared_ptr<GcsPlacementGroup> placement_group,
     const std::vector<std::shared_ptr<const BundleSpecification>> &unplaced_bundles,
     const ScheduleMap &schedule_map)
-    : placement_group_(placement_group), bundles_to_schedule_(unplaced_bundles) {
+    : placement_group_(placement_group),
+      prepare_started_time_ns_(absl::GetCurrentTimeNanos()),
+      bundles_to_schedule_(unplaced_bundles) {
   preparing_bundle_locations_ = std::make_shared<BundleLocations>();
   uncommitted_bundle_locations_ = std::make_shared<BundleLocations>();
   committed_bundle_locations_ = std::make_shared<BundleLocations>();
@@ -809,6 +938,29 @@ bool LeaseStatusTracker::AllPrepareRequestsSuccessful() const {
          (leasing_state_ != LeasingState::CANCELLED);
 }
 
+std::vector<std::shared_ptr<const BundleSpecification>>
+LeaseStatusTracker::GetUnpreparedBundles() const {
+  std::vector<std::shared_ptr<const BundleSpecification>> unprepared_bundles;
+  for (const auto &bundle : bundles_to_schedule_) {
+    if (!preparing_bundle_locations_->contains(bundle->BundleId())) {
+      unprepared_bundles.push_back(bundle);
+    }
+  }
+  return unprepared_bundles;
+}
+
+void LeaseStatusTracker::MarkPrepareRetryStarted(const ScheduleMap &schedule_map) {
+  RAY_CHECK(AllPrepareRequestsReturned());
+  for (const auto &iter : schedule_map) {
+    auto &location = (*bundle_locations_)[iter.first];
+    RAY_CHECK(location.second != nullptr);
+    location.first = iter.second;
+  }
+  // Only the requests of the unprepared bundles are outstanding again.
+  prepare_request_returned_count_ = preparing_bundle_locations_->size();
+  prepare_retry_count_++;
+}
+
 void LeaseStatusTracker::MarkCommitRequestReturned(
     const NodeID &node_id, const std::shared_ptr<const BundleSpecification> &bundle,
     const Status &status) {
@@ -879,6 +1031,7 @@ bool LeaseStatusTracker::UpdateLeasingState(LeasingState leasing_state) {
 
 void LeaseStatusTracker::MarkCommitPhaseStarted() {
   UpdateLeasingState(LeasingState::COMMITTING);
+  commit_started_time_ns_ = absl::GetCurrentTimeNanos();
 }
 
 }  // namespace gcs
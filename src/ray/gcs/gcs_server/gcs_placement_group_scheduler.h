@@ -232,6 +232,27 @@ class LeaseStatusTracker {
   /// \return True if all prepare requests were successful.
   bool AllPrepareRequestsSuccessful() const;
 
+  /// Return the bundles whose prepare requests failed.
+  ///
+  /// \return List of bundle specification that were not prepared on any node.
+  std::vector<std::shared_ptr<const BundleSpecification>> GetUnpreparedBundles() const;
+
+  /// Indicate the tracker that the bundles whose prepare requests failed are prepared
+  /// again, on the nodes they are rescheduled to. The bundles that were prepared stay
+  /// prepared.
+  ///
+  /// \param schedule_map The nodes the unprepared bundles are rescheduled to.
+  void MarkPrepareRetryStarted(const ScheduleMap &schedule_map);
+
+  /// Return how many times the unprepared bundles were prepared again.
+  size_t GetPrepareRetryCount() const { return prepare_retry_count_; }
+
+  /// Return the time the prepare phase started at, in nanoseconds.
+  int64_t GetPrepareStartedTimeNs() const { return prepare_started_time_ns_; }
+
+  /// Return the time the commit phase started at, in nanoseconds.
+  int64_t GetCommitStartedTimeNs() const { return commit_started_time_ns_; }
+
   /// Indicate the tracker that the commit request of a bundle from a node has returned.
   ///
   /// \param node_id Id of a node where commit request is returned.
@@ -317,6 +338,13 @@ class LeaseStatusTracker {
   /// Number of prepare requests that are returned.
   size_t prepare_request_returned_count_ = 0;
 
+  /// Number of times the unprepared bundles were prepared again.
+  size_t prepare_retry_count_ = 0;
+
+  /// The time the prepare and the commit phases started at, in nanoseconds.
+  int64_t prepare_started_time_ns_;
+  int64_t commit_started_time_ns_ = 0;
+
   /// Number of commit requests that are returned.
   size_t commit_request_returned_count_ = 0;
 
@@ -523,6 +551,36 @@ class GcsPlacementGroupScheduler : public GcsPlacementGroupSchedulerInterface {
       const PGSchedulingFailureCallback &schedule_failure_handler,
       const PGSchedulingSuccessfulCallback &schedule_success_handler);
 
+  /// Send the prepare requests of bundles to the nodes they are scheduled to, with the
+  /// bundles of a node in one request, and to all the nodes at once.
+  void PrepareBundles(
+      const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
+      const std::vector<std::shared_ptr<const BundleSpecification>> &bundles,
+      const ScheduleMap &schedule_map,
+      const PGSchedulingFailureCallback &schedule_failure_handler,
+      const PGSchedulingSuccessfulCallback &schedule_success_handler);
+
+  /// Whether the bundles whose prepare requests failed can be rescheduled on their own,
+  /// i.e. the retries aren't exhausted, the placement group isn't removed and isn't
+  /// STRICT_PACK.
+  bool CanRescheduleUnpreparedBundles(
+      const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker) const;
+
+  /// Reschedule the bundles whose prepare requests failed, and prepare them again while
+  /// the other bundles stay prepared.
+  ///
+  /// \return False if the bundles can't be rescheduled, in which case the whole
+  /// placement group should be.
+  bool RescheduleUnpreparedBundles(
+      const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
+      const PGSchedulingFailureCallback &schedule_failure_handler,
+      const PGSchedulingSuccessfulCallback &schedule_success_handler);
+
+  /// Give up on the prepared bundles of the placement group so that the whole placement
+  /// group is rescheduled.
+  void OnPrepareFailed(const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
+                       const PGSchedulingFailureCallback &schedule_failure_handler);
+
   /// Called when all commit requests are returned from nodes.
   void OnAllBundleCommitRequestReturned(
       const std::shared_ptr<LeaseStatusTracker> &lease_status_tracker,
@@ -562,6 +620,9 @@ class GcsPlacementGroupScheduler : public GcsPlacementGroupSchedulerInterface {
   std::unique_ptr<ScheduleContext> GetScheduleContext(
       const PlacementGroupID &placement_group_id);
 
+  /// The main event loop, to back off before preparing bundles again.
+  instrumented_io_context &io_context_;
+
   /// A timer that ticks every cancel resource failure milliseconds.
   boost::asio::deadline_timer return_timer_;
 
@@ -23,6 +23,7 @@ GcsResourceReportPoller::GcsResourceReportPoller(
     std::function<int64_t(void)> get_current_time_milli,
     std::function<void(
         const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+        const rpc::RequestResourceReportRequest &,
         std::function<void(const Status &, const rpc::RequestResourceReportReply &)>)>
         request_report)
     : ticker_(polling_service_),
@@ -32,7 +33,9 @@ GcsResourceReportPoller::GcsResourceReportPoller(
       handle_resource_report_(handle_resource_report),
       get_current_time_milli_(get_current_time_milli),
       request_report_(request_report),
-      poll_period_ms_(RayConfig::instance().gcs_resource_report_poll_period_ms()) {}
+      poll_period_ms_(RayConfig::instance().gcs_resource_report_poll_period_ms()),
+      full_pull_interval_(RayConfig::instance().gcs_resource_report_full_pull_interval()),
+      regions_(RayConfig::instance().resource_dissemination_region_size()) {}
 
 GcsResourceReportPoller::~GcsResourceReportPoller() { Stop(); }
 
@@ -84,7 +87,10 @@ void GcsResourceReportPoller::HandleNodeAdded(const rpc::GcsNodeInfo &node_info)
   RAY_CHECK(!nodes_.count(node_id)) << "Node with id: " << node_id << " was added twice!";
 
   nodes_[node_id] = state;
-  to_pull_queue_.push_front(state);
+  // Other nodes are pulled from by the aggregator of their region.
+  if (regions_.AddNode(node_id) == node_id) {
+    to_pull_queue_.push_front(state);
+  }
   RAY_LOG(DEBUG) << "Node was added with id: " << node_id;
 
   polling_service_.post([this]() { TryPullResourceReport(); },
@@ -97,6 +103,16 @@ void GcsResourceReportPoller::HandleNodeRemoved(const rpc::GcsNodeInfo &node_inf
     absl::MutexLock guard(&mutex_);
     nodes_.erase(node_id);
     RAY_CHECK(!nodes_.count(node_id));
+    const bool was_aggregator = regions_.IsAggregator(node_id);
+    const auto aggregator_id = regions_.RemoveNode(node_id);
+    if (was_aggregator && !aggregator_id.IsNil()) {
+      // The new aggregator of the region takes over pulling from it.
+      auto state = nodes_.at(aggregator_id);
+      state->next_pull_time = get_current_time_milli_();
+      to_pull_queue_.push_front(state);
+      polling_service_.post([this]() { TryPullResourceReport(); },
+                            "GcsResourceReportPoller.TryPullResourceReport");
+    }
     RAY_LOG(DEBUG) << "Node removed (node_id: " << node_id
                    << ")# of remaining nodes: " << nodes_.size();
   }
@@ -119,6 +135,9 @@ void GcsResourceReportPoller::TryPullResourceReport() {
           << "Update finished, but node was already removed from the cluster. Ignoring.";
       continue;
     }
+    if (!regions_.IsAggregator(to_pull->node_id)) {
+      continue;
+    }
 
     PullResourceReport(to_pull);
   }
@@ -127,27 +146,72 @@ void GcsResourceReportPoller::TryPullResourceReport() {
 void GcsResourceReportPoller::PullResourceReport(const std::shared_ptr<PullState> state) {
   inflight_pulls_++;
 
+  rpc::RequestResourceReportRequest request;
+  request.set_known_version(state->NextKnownVersion(full_pull_interval_));
+  std::vector<NodeID> member_ids;
+  for (const auto &member_id : regions_.GetMembers(state->node_id)) {
+    if (member_id == state->node_id) {
+      continue;
+    }
+    auto &member_state = nodes_.at(member_id);
+    auto member = request.add_region_members();
+    member->mutable_address()->CopyFrom(member_state->address);
+    member->set_known_version(member_state->NextKnownVersion(full_pull_interval_));
+    member_ids.push_back(member_id);
+  }
+
   request_report_(
-      state->address, raylet_client_pool_,
-      [this, state](const Status &status, const rpc::RequestResourceReportReply &reply) {
+      state->address, raylet_client_pool_, request,
+      [this, state, member_ids](const Status &status,
+                                const rpc::RequestResourceReportReply &reply) {
+        // Nothing else touches the pull state of the node while the pull is in flight.
+        // The versions of the rest of the region are applied on the polling thread,
+        // since their pull states are shared with the other aggregators they may move to.
+        std::vector<std::pair<NodeID, int64_t>> member_versions;
         if (status.ok()) {
+          state->known_version = reply.version();
           // TODO (Alex): This callback is always posted onto the main thread. Since most
           // of the work is in the callback we should move this callback's execution to
           // the polling thread. We will need to implement locking once we switch threads.
           handle_resource_report_(reply.resources());
+          for (size_t i = 0; i < member_ids.size(); i++) {
+            int64_t version = 0;
+            if (static_cast<int>(i) < reply.region_reports_size() &&
+                reply.region_reports(i).version() != 0) {
+              version = reply.region_reports(i).version();
+              handle_resource_report_(reply.region_reports(i).resources());
+            }
+            member_versions.emplace_back(member_ids[i], version);
+          }
         } else {
           RAY_LOG(INFO) << "Couldn't get resource request from raylet " << state->node_id
                         << ": " << status.ToString();
+          // The raylet may have sent a report that never arrived, so the next report
+          // can't be relative to the last one that did.
+          state->known_version = 0;
+          for (const auto &member_id : member_ids) {
+            member_versions.emplace_back(member_id, 0);
+          }
         }
-        polling_service_.post([this, state]() { NodeResourceReportReceived(state); },
-                              "GcsResourceReportPoller.PullResourceReport");
+        polling_service_.post(
+            [this, state, member_versions]() {
+              NodeResourceReportReceived(state, member_versions);
+            },
+            "GcsResourceReportPoller.PullResourceReport");
       });
 }
 
 void GcsResourceReportPoller::NodeResourceReportReceived(
-    const std::shared_ptr<PullState> state) {
+    const std::shared_ptr<PullState> state,
+    const std::vector<std::pair<NodeID, int64_t>> &member_versions) {
   absl::MutexLock guard(&mutex_);
   inflight_pulls_--;
+  for (const auto &member_version : member_versions) {
+    auto it = nodes_.find(member_version.first);
+    if (it != nodes_.end()) {
+      it->second->known_version = member_version.second;
+    }
+  }
 
   // Schedule the next pull. The scheduling `TryPullResourceReport` loop will handle
   // validating that this node is still in the cluster.
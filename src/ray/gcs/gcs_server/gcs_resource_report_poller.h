@@ -15,6 +15,7 @@
 
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/gcs/gcs_server/gcs_resource_manager.h"
+#include "ray/gcs/gcs_server/resource_regions.h"
 #include "ray/rpc/node_manager/node_manager_client_pool.h"
 
 namespace ray {
@@ -26,7 +27,9 @@ namespace gcs {
 class GcsResourceReportPoller {
   /*
   This class roughly polls each node independently (with the exception of max
-  concurrency). The process for polling a single node is as follows:
+  concurrency). Every pull asks for the changes since the last report of the node that
+  was applied, except for periodic (or after a failed pull) full reports. The process
+  for polling a single node is as follows:
 
   A new node joins the cluster.
   1. (Main thread) Begin tracking the node, and begin the polling process.
@@ -44,6 +47,10 @@ class GcsResourceReportPoller {
   The node leaves the cluster.
   7. Untrack the node. The next time the main polling procedure comes across the node, it
   should be dropped from the system.
+
+  When `resource_dissemination_region_size` is set, only the aggregator of every region
+  of nodes is queued. Its pull carries the rest of its region and the report versions
+  of their nodes, and the aggregator pulls their reports and replies with them all.
    */
 
  public:
@@ -55,15 +62,17 @@ class GcsResourceReportPoller {
           []() { return absl::GetCurrentTimeNanos() / (1000 * 1000); },
       std::function<void(
           const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &,
           std::function<void(const Status &, const rpc::RequestResourceReportReply &)>)>
           request_report =
               [](const rpc::Address &address,
                  std::shared_ptr<rpc::NodeManagerClientPool> &raylet_client_pool,
+                 const rpc::RequestResourceReportRequest &request,
                  std::function<void(const Status &,
                                     const rpc::RequestResourceReportReply &)>
                      callback) {
                 auto raylet_client = raylet_client_pool->GetOrConnectByAddress(address);
-                raylet_client->RequestResourceReport(callback);
+                raylet_client->RequestResourceReport(request, callback);
               });
 
   ~GcsResourceReportPoller();
@@ -106,16 +115,24 @@ class GcsResourceReportPoller {
   // Send the `RequestResourceReport` RPC.
   std::function<void(
       const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+      const rpc::RequestResourceReportRequest &,
       std::function<void(const Status &, const rpc::RequestResourceReportReply &)>)>
       request_report_;
   // The minimum delay between two pull requests to the same thread.
   const int64_t poll_period_ms_;
+  // The number of pulls from a node after which a full report is requested.
+  const uint64_t full_pull_interval_;
 
   struct PullState {
     NodeID node_id;
     rpc::Address address;
     int64_t last_pull_time;
     int64_t next_pull_time;
+    // The version of the last report of the node that was applied, or 0 if a full
+    // report should be requested.
+    int64_t known_version = 0;
+    // The number of pulls since the last full report.
+    uint64_t pulls_since_full_report = 0;
 
     PullState(NodeID _node_id, rpc::Address _address, int64_t _last_pull_time,
               int64_t _next_pull_time)
@@ -125,6 +142,20 @@ class GcsResourceReportPoller {
           next_pull_time(_next_pull_time) {}
 
     ~PullState() {}
+
+    // Return the version to request the next report of the node relative to, which is
+    // 0 for a full report.
+    int64_t NextKnownVersion(uint64_t full_pull_interval) {
+      if (pulls_since_full_report >= full_pull_interval) {
+        known_version = 0;
+      }
+      if (known_version == 0) {
+        pulls_since_full_report = 0;
+      } else {
+        pulls_since_full_report++;
+      }
+      return known_version;
+    }
   };
 
   // A global lock for internal operations. This lock is shared between the main thread
@@ -136,15 +167,23 @@ class GcsResourceReportPoller {
   // from this list immediately because we limit the number of concurrent pulls. This
   // queue should be sorted by time. The front should contain the first item to pull.
   std::deque<std::shared_ptr<PullState>> to_pull_queue_ GUARDED_BY(mutex_);
+  // The regions of the nodes. Only the aggregators of the regions are pulled from.
+  ResourceRegions regions_ GUARDED_BY(mutex_);
 
   /// Try to pull from the node. We may not be able to if it violates max concurrent
   /// pulls. This method is thread safe.
   void TryPullResourceReport() LOCKS_EXCLUDED(mutex_);
   /// Pull resource report without validation.
-  void PullResourceReport(const std::shared_ptr<PullState> state);
+  void PullResourceReport(const std::shared_ptr<PullState> state)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   /// A resource report was successfully pulled (and the resource manager was already
   /// updated). This method is thread safe.
-  void NodeResourceReportReceived(const std::shared_ptr<PullState> state)
+  ///
+  /// \param member_versions The versions of the reports of the rest of the region that
+  /// were pulled along, 0 for the ones that weren't.
+  void NodeResourceReportReceived(
+      const std::shared_ptr<PullState> state,
+      const std::vector<std::pair<NodeID, int64_t>> &member_versions)
       LOCKS_EXCLUDED(mutex_);
 
   friend class GcsResourceReportPollerTest;
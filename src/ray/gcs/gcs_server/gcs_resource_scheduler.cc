@@ -14,6 +14,9 @@
 
 #include "ray/gcs/gcs_server/gcs_resource_scheduler.h"
 
+#include "ray/gcs/gcs_server/bundle_placement_engine.h"
+#include "ray/stats/metric_defs.h"
+
 namespace ray {
 namespace gcs {
 
@@ -77,10 +80,28 @@ double LeastResourceScorer::Calculate(const FixedPoint &requested,
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
+GcsResourceScheduler::GcsResourceScheduler(GcsResourceManager &gcs_resource_manager)
+    : gcs_resource_manager_(gcs_resource_manager),
+      node_scorer_(new LeastResourceScorer()) {}
+
+GcsResourceScheduler::~GcsResourceScheduler() = default;
+
 SchedulingResult GcsResourceScheduler::Schedule(
     const std::vector<ResourceRequest> &required_resources_list,
     const SchedulingType &scheduling_type,
     const std::function<bool(const NodeID &)> &node_filter_func) {
+  if (RayConfig::instance().gcs_placement_group_bin_packing()) {
+    if (bundle_placement_engine_ == nullptr) {
+      bundle_placement_engine_ =
+          std::make_unique<BundlePlacementEngine>(GetResourceView());
+    }
+    auto result = bundle_placement_engine_->PlaceNext(
+        {required_resources_list, scheduling_type, node_filter_func});
+    ray::stats::STATS_gcs_placement_group_resource_fragmentation.Record(
+        bundle_placement_engine_->GetFragmentation().fragmentation);
+    return result;
+  }
+
   // Filter candidate nodes.
   auto candidate_nodes = FilterCandidateNodes(node_filter_func);
   if (candidate_nodes.empty()) {
@@ -37,6 +37,8 @@ enum SchedulingType {
   SchedulingType_MAX = 4,
 };
 
+class BundlePlacementEngine;
+
 // Status of resource scheduling result.
 enum class SchedulingResultStatus {
   // Scheduling failed but retryable.
@@ -86,11 +88,9 @@ class LeastResourceScorer : public NodeScorer {
 /// Non-thread safe.
 class GcsResourceScheduler {
  public:
-  GcsResourceScheduler(GcsResourceManager &gcs_resource_manager)
-      : gcs_resource_manager_(gcs_resource_manager),
-        node_scorer_(new LeastResourceScorer()) {}
+  GcsResourceScheduler(GcsResourceManager &gcs_resource_manager);
 
-  virtual ~GcsResourceScheduler() = default;
+  virtual ~GcsResourceScheduler();
 
   /// Schedule the specified resources to the cluster nodes.
   ///
@@ -211,6 +211,10 @@ class GcsResourceScheduler {
 
   /// Scorer to make a grade to the node.
   std::unique_ptr<NodeScorer> node_scorer_;
+
+  /// Places the bundles when `gcs_placement_group_bin_packing` is set. It's kept
+  /// across the calls so that only the nodes whose resources changed are read again.
+  std::unique_ptr<BundlePlacementEngine> bundle_placement_engine_;
 };
 
 }  // namespace gcs
@@ -55,11 +55,18 @@ GcsServer::GcsServer(const ray::gcs::GcsServerConfig &config,
                 << (RayConfig::instance().gcs_grpc_based_pubsub() ? " " : " not ")
                 << "enabled";
   if (storage_type_ == "redis") {
-    gcs_table_storage_ = std::make_shared<gcs::RedisGcsTableStorage>(GetOrConnectRedis());
+    gcs_table_storage_ =
+        std::make_shared<gcs::RedisGcsTableStorage>(GetOrConnectRedis(), main_service_);
   } else if (storage_type_ == "memory") {
     RAY_CHECK(RayConfig::instance().gcs_grpc_based_pubsub())
         << " grpc pubsub has to be enabled when using storage other than redis";
     gcs_table_storage_ = std::make_shared<InMemoryGcsTableStorage>(main_service_);
+  } else if (storage_type_ == "file") {
+    RAY_CHECK(RayConfig::instance().gcs_grpc_based_pubsub())
+        << " grpc pubsub has to be enabled when using storage other than redis";
+    kv_store_client_ = std::make_shared<FileStoreClient>(
+        main_service_, RayConfig::instance().gcs_storage_file_dir());
+    gcs_table_storage_ = std::make_shared<FileGcsTableStorage>(kv_store_client_);
   }
 
   auto on_done = [this](const ray::Status &status) {
@@ -80,6 +87,20 @@ GcsServer::GcsServer(const ray::gcs::GcsServerConfig &config,
   // will be called.
   main_service_.restart();
 
+  if (kv_store_client_) {
+    // Read the internal KV persisted to the store in the same sync way.
+    RAY_CHECK_OK(kv_store_client_->AsyncGetAll(
+        MemoryInternalKV::kStoreTableName,
+        [this](absl::flat_hash_map<std::string, std::string> &&result) {
+          persisted_kv_ = std::move(result);
+          main_service_.stop();
+        }));
+    main_service_.run();
+    main_service_.restart();
+    RAY_LOG(INFO) << "Loaded " << persisted_kv_.size()
+                  << " keys of the internal KV from the GCS storage.";
+  }
+
   // Init GCS publisher instance.
   std::unique_ptr<pubsub::Publisher> inner_publisher;
   if (config_.grpc_pubsub_enabled) {
@@ -115,17 +136,22 @@ RedisClientOptions GcsServer::GetRedisClientOptions() const {
 }
 
 void GcsServer::Start() {
-  // Load gcs tables data asynchronously.
+  // Load gcs tables data asynchronously. The node table is loaded first so that
+  // raylets can register and heartbeat while the other tables are loading.
   auto gcs_init_data = std::make_shared<GcsInitData>(gcs_table_storage_);
-  gcs_init_data->AsyncLoad([this, gcs_init_data] { DoStart(*gcs_init_data); });
+  gcs_init_data->AsyncLoadNodes([this, gcs_init_data] {
+    StartNodeServices(*gcs_init_data);
+    gcs_init_data->AsyncLoadOtherTables(
+        [this, gcs_init_data] { DoStart(*gcs_init_data); });
+  });
 }
 
-void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
+void GcsServer::StartNodeServices(const GcsInitData &gcs_init_data) {
   // Init gcs resource manager.
-  InitGcsResourceManager(gcs_init_data);
+  InitGcsResourceManager();
 
   // Init synchronization service
-  InitRaySyncer(gcs_init_data);
+  InitRaySyncer();
 
   // Init gcs resource scheduler.
   InitGcsResourceScheduler();
@@ -149,13 +175,13 @@ void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
   InitRuntimeEnvManager();
 
   // Init gcs job manager.
-  InitGcsJobManager(gcs_init_data);
+  InitGcsJobManager();
 
   // Init gcs placement group manager.
-  InitGcsPlacementGroupManager(gcs_init_data);
+  InitGcsPlacementGroupManager();
 
   // Init gcs actor manager.
-  InitGcsActorManager(gcs_init_data);
+  InitGcsActorManager();
 
   // Init gcs worker manager.
   InitGcsWorkerManager();
@@ -163,11 +189,23 @@ void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
   // Init stats handler.
   InitStatsHandler();
 
-  // Install event listeners.
-  InstallEventListeners();
+  // The other managers don't know about the nodes until the other tables are
+  // loaded, so the node changes until then are replayed to them in `DoStart`.
+  gcs_node_manager_->AddNodeAddedListener([this](std::shared_ptr<rpc::GcsNodeInfo> node) {
+    if (!other_tables_loaded_) {
+      pending_node_changes_.emplace_back(std::move(node), /*added=*/true);
+    }
+  });
+  gcs_node_manager_->AddNodeRemovedListener(
+      [this](std::shared_ptr<rpc::GcsNodeInfo> node) {
+        if (!other_tables_loaded_) {
+          pending_node_changes_.emplace_back(std::move(node), /*added=*/false);
+        }
+      });
 
-  // Start RPC server when all tables have finished loading initial
-  // data.
+  // Start RPC server when the node table has finished loading initial data. Only the
+  // node info and heartbeat services handle requests until the other tables are
+  // loaded too; requests to the other services wait until then.
   rpc_server_.Run();
 
   if (!RayConfig::instance().bootstrap_with_gcs()) {
@@ -179,6 +217,33 @@ void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
   // some living nodes as dead as the timer inside node failure
   // detector is already run.
   gcs_heartbeat_manager_->Start();
+}
+
+void GcsServer::DoStart(const GcsInitData &gcs_init_data) {
+  // Initialize by gcs tables data.
+  gcs_resource_manager_->Initialize(gcs_init_data);
+  ray_syncer_->Initialize(gcs_init_data);
+  ray_syncer_->Start();
+  gcs_job_manager_->Initialize(gcs_init_data);
+  gcs_placement_group_manager_->Initialize(gcs_init_data);
+  gcs_actor_manager_->Initialize(gcs_init_data);
+
+  // Install event listeners.
+  InstallEventListeners();
+
+  // Replay the node changes made while the other tables were loading.
+  other_tables_loaded_ = true;
+  for (auto &node_change : pending_node_changes_) {
+    if (node_change.second) {
+      OnNodeAdded(std::move(node_change.first));
+    } else {
+      OnNodeRemoved(std::move(node_change.first));
+    }
+  }
+  pending_node_changes_.clear();
+
+  // Handle the requests to the other services.
+  rpc_server_.AcceptDeferredRequests();
 
   RecordMetrics();
 
@@ -214,6 +279,10 @@ void GcsServer::Stop() {
     rpc_server_.Shutdown();
 
     pubsub_handler_->Stop();
+    if (kv_io_service_thread_) {
+      kv_io_service_.stop();
+      kv_io_service_thread_->join();
+    }
     kv_manager_.reset();
 
     is_stopped_ = true;
@@ -244,23 +313,24 @@ void GcsServer::InitGcsHeartbeatManager(const GcsInitData &gcs_init_data) {
       });
   // Initialize by gcs tables data.
   gcs_heartbeat_manager_->Initialize(gcs_init_data);
+  gcs_node_manager_->AddNodeAddedListener([this](std::shared_ptr<rpc::GcsNodeInfo> node) {
+    gcs_heartbeat_manager_->AddNode(NodeID::FromBinary(node->node_id()));
+  });
   // Register service.
   heartbeat_info_service_.reset(new rpc::HeartbeatInfoGrpcService(
       heartbeat_manager_io_service_, *gcs_heartbeat_manager_));
   rpc_server_.RegisterService(*heartbeat_info_service_);
 }
 
-void GcsServer::InitGcsResourceManager(const GcsInitData &gcs_init_data) {
+void GcsServer::InitGcsResourceManager() {
   RAY_CHECK(gcs_table_storage_ && gcs_publisher_);
   gcs_resource_manager_ = std::make_shared<GcsResourceManager>(
       main_service_, gcs_publisher_, gcs_table_storage_);
 
-  // Initialize by gcs tables data.
-  gcs_resource_manager_->Initialize(gcs_init_data);
   // Register service.
   node_resource_info_service_.reset(
       new rpc::NodeResourceInfoGrpcService(main_service_, *gcs_resource_manager_));
-  rpc_server_.RegisterService(*node_resource_info_service_);
+  rpc_server_.RegisterService(*node_resource_info_service_, /*accept_requests=*/false);
 }
 
 void GcsServer::InitGcsResourceScheduler() {
@@ -269,19 +339,18 @@ void GcsServer::InitGcsResourceScheduler() {
       std::make_shared<GcsResourceScheduler>(*gcs_resource_manager_);
 }
 
-void GcsServer::InitGcsJobManager(const GcsInitData &gcs_init_data) {
+void GcsServer::InitGcsJobManager() {
   RAY_CHECK(gcs_table_storage_ && gcs_publisher_);
   gcs_job_manager_ = std::make_unique<GcsJobManager>(
       gcs_table_storage_, gcs_publisher_, *runtime_env_manager_, *function_manager_);
-  gcs_job_manager_->Initialize(gcs_init_data);
 
   // Register service.
   job_info_service_ =
       std::make_unique<rpc::JobInfoGrpcService>(main_service_, *gcs_job_manager_);
-  rpc_server_.RegisterService(*job_info_service_);
+  rpc_server_.RegisterService(*job_info_service_, /*accept_requests=*/false);
 }
 
-void GcsServer::InitGcsActorManager(const GcsInitData &gcs_init_data) {
+void GcsServer::InitGcsActorManager() {
   RAY_CHECK(gcs_table_storage_ && gcs_publisher_ && gcs_node_manager_);
   std::unique_ptr<GcsActorSchedulerInterface> scheduler;
   auto schedule_failure_handler =
@@ -341,15 +410,13 @@ void GcsServer::InitGcsActorManager(const GcsInitData &gcs_init_data) {
         return std::make_shared<rpc::CoreWorkerClient>(address, client_call_manager_);
       });
 
-  // Initialize by gcs tables data.
-  gcs_actor_manager_->Initialize(gcs_init_data);
   // Register service.
   actor_info_service_.reset(
       new rpc::ActorInfoGrpcService(main_service_, *gcs_actor_manager_));
-  rpc_server_.RegisterService(*actor_info_service_);
+  rpc_server_.RegisterService(*actor_info_service_, /*accept_requests=*/false);
 }
 
-void GcsServer::InitGcsPlacementGroupManager(const GcsInitData &gcs_init_data) {
+void GcsServer::InitGcsPlacementGroupManager() {
   RAY_CHECK(gcs_table_storage_ && gcs_node_manager_);
   auto scheduler = std::make_shared<GcsPlacementGroupScheduler>(
       main_service_, gcs_table_storage_, *gcs_node_manager_, *gcs_resource_manager_,
@@ -360,12 +427,11 @@ void GcsServer::InitGcsPlacementGroupManager(const GcsInitData &gcs_init_data) {
       [this](const JobID &job_id) {
         return gcs_job_manager_->GetJobConfig(job_id)->ray_namespace();
       });
-  // Initialize by gcs tables data.
-  gcs_placement_group_manager_->Initialize(gcs_init_data);
   // Register service.
   placement_group_info_service_.reset(new rpc::PlacementGroupInfoGrpcService(
       main_service_, *gcs_placement_group_manager_));
-  rpc_server_.RegisterService(*placement_group_info_service_);
+  rpc_server_.RegisterService(*placement_group_info_service_,
+                              /*accept_requests=*/false);
 }
 
 std::string GcsServer::StorageType() const {
@@ -380,6 +446,11 @@ std::string GcsServer::StorageType() const {
     RAY_CHECK(!config_.redis_address.empty());
     return "redis";
   }
+  if (RayConfig::instance().gcs_storage() == "file") {
+    RAY_CHECK(!RayConfig::instance().gcs_storage_file_dir().empty())
+        << "gcs_storage_file_dir must be set when the GCS storage type is file.";
+    return "file";
+  }
   RAY_LOG(FATAL) << "Unsupported GCS storage type: "
                  << RayConfig::instance().gcs_storage();
   return RayConfig::instance().gcs_storage();
@@ -400,7 +471,7 @@ void GcsServer::StoreGcsServerAddressInRedis() {
   RAY_LOG(INFO) << "Finished setting gcs server address: " << address;
 }
 
-void GcsServer::InitRaySyncer(const GcsInitData &gcs_init_data) {
+void GcsServer::InitRaySyncer() {
   /*
     The current synchronization flow is:
         raylet -> syncer::poller --> syncer::update -> gcs_resource_manager
@@ -408,8 +479,6 @@ void GcsServer::InitRaySyncer(const GcsInitData &gcs_init_data) {
   */
   ray_syncer_ = std::make_unique<syncer::RaySyncer>(main_service_, raylet_client_pool_,
                                                     *gcs_resource_manager_);
-  ray_syncer_->Initialize(gcs_init_data);
-  ray_syncer_->Start();
 }
 
 void GcsServer::InitStatsHandler() {
@@ -417,26 +486,52 @@ void GcsServer::InitStatsHandler() {
   stats_handler_.reset(new rpc::DefaultStatsHandler(gcs_table_storage_));
   // Register service.
   stats_service_.reset(new rpc::StatsGrpcService(main_service_, *stats_handler_));
-  rpc_server_.RegisterService(*stats_service_);
+  rpc_server_.RegisterService(*stats_service_, /*accept_requests=*/false);
 }
 
 void GcsServer::InitFunctionManager() {
-  function_manager_ = std::make_unique<GcsFunctionManager>(kv_manager_->GetInstance());
+  function_manager_ = std::make_unique<GcsFunctionManager>(GetMainServiceKV());
+}
+
+InternalKVInterface &GcsServer::GetMainServiceKV() {
+  if (main_service_kv_) {
+    return *main_service_kv_;
+  }
+  return kv_manager_->GetInstance();
 }
 
 void GcsServer::InitKVManager() {
+  const bool dedicated_thread = RayConfig::instance().gcs_server_kv_dedicated_thread();
+  auto &kv_io_service = dedicated_thread ? kv_io_service_ : main_service_;
+  if (dedicated_thread) {
+    kv_io_service_thread_ = std::make_unique<std::thread>([this] {
+      SetThreadName("gcs_kv");
+      // Keep kv_io_service_ alive.
+      boost::asio::io_service::work kv_io_service_work(kv_io_service_);
+      kv_io_service_.run();
+    });
+  }
+
   std::unique_ptr<InternalKVInterface> instance;
   // TODO (yic): Use a factory with configs
   if (storage_type_ == "redis") {
     instance = std::make_unique<RedisInternalKV>(GetRedisClientOptions());
   } else if (storage_type_ == "memory") {
-    instance = std::make_unique<MemoryInternalKV>(main_service_);
+    instance = std::make_unique<MemoryInternalKV>(kv_io_service);
+  } else if (storage_type_ == "file") {
+    instance = std::make_unique<MemoryInternalKV>(kv_io_service, kv_store_client_,
+                                                  std::move(persisted_kv_));
+    persisted_kv_.clear();
   }
 
   kv_manager_ = std::make_unique<GcsInternalKVManager>(std::move(instance));
-  kv_service_ = std::make_unique<rpc::InternalKVGrpcService>(main_service_, *kv_manager_);
+  if (dedicated_thread) {
+    main_service_kv_ =
+        std::make_unique<ForwardingInternalKV>(kv_manager_->GetInstance(), main_service_);
+  }
+  kv_service_ = std::make_unique<rpc::InternalKVGrpcService>(kv_io_service, *kv_manager_);
   // Register service.
-  rpc_server_.RegisterService(*kv_service_);
+  rpc_server_.RegisterService(*kv_service_, /*accept_requests=*/false);
 }
 
 void GcsServer::InitPubSubHandler() {
@@ -445,7 +540,7 @@ void GcsServer::InitPubSubHandler() {
   pubsub_service_ = std::make_unique<rpc::InternalPubSubGrpcService>(pubsub_io_service_,
                                                                      *pubsub_handler_);
   // Register service.
-  rpc_server_.RegisterService(*pubsub_service_);
+  rpc_server_.RegisterService(*pubsub_service_, /*accept_requests=*/false);
 }
 
 void GcsServer::InitRuntimeEnvManager() {
@@ -471,7 +566,7 @@ void GcsServer::InitRuntimeEnvManager() {
             callback(true);
           } else {
             auto uri = plugin_uri.substr(protocol_pos);
-            this->kv_manager_->GetInstance().Del(
+            this->GetMainServiceKV().Del(
                 "" /* namespace */, uri /* key */, false /* del_by_prefix*/,
                 [callback = std::move(callback)](int64_t) { callback(false); });
           }
@@ -485,32 +580,15 @@ void GcsServer::InitGcsWorkerManager() {
   // Register service.
   worker_info_service_.reset(
       new rpc::WorkerInfoGrpcService(main_service_, *gcs_worker_manager_));
-  rpc_server_.RegisterService(*worker_info_service_);
+  rpc_server_.RegisterService(*worker_info_service_, /*accept_requests=*/false);
 }
 
 void GcsServer::InstallEventListeners() {
   // Install node event listeners.
-  gcs_node_manager_->AddNodeAddedListener([this](std::shared_ptr<rpc::GcsNodeInfo> node) {
-    // Because a new node has been added, we need to try to schedule the pending
-    // placement groups and the pending actors.
-    gcs_resource_manager_->OnNodeAdd(*node);
-    gcs_placement_group_manager_->OnNodeAdd(NodeID::FromBinary(node->node_id()));
-    gcs_actor_manager_->SchedulePendingActors();
-    gcs_heartbeat_manager_->AddNode(NodeID::FromBinary(node->node_id()));
-    ray_syncer_->AddNode(*node);
-  });
+  gcs_node_manager_->AddNodeAddedListener(
+      [this](std::shared_ptr<rpc::GcsNodeInfo> node) { OnNodeAdded(std::move(node)); });
   gcs_node_manager_->AddNodeRemovedListener(
-      [this](std::shared_ptr<rpc::GcsNodeInfo> node) {
-        auto node_id = NodeID::FromBinary(node->node_id());
-        const auto node_ip_address = node->node_manager_address();
-        // All of the related placement groups and actors should be reconstructed when a
-        // node is removed from the GCS.
-        gcs_resource_manager_->OnNodeDead(node_id);
-        gcs_placement_group_manager_->OnNodeDead(node_id);
-        gcs_actor_manager_->OnNodeDead(node_id, node_ip_address);
-        raylet_client_pool_->Disconnect(NodeID::FromBinary(node->node_id()));
-        ray_syncer_->RemoveNode(*node);
-      });
+      [this](std::shared_ptr<rpc::GcsNodeInfo> node) { OnNodeRemoved(std::move(node)); });
 
   // Install worker event listener.
   gcs_worker_manager_->AddWorkerDeadListener(
@@ -548,6 +626,27 @@ void GcsServer::InstallEventListeners() {
   }
 }
 
+void GcsServer::OnNodeAdded(std::shared_ptr<rpc::GcsNodeInfo> node) {
+  // Because a new node has been added, we need to try to schedule the pending
+  // placement groups and the pending actors.
+  gcs_resource_manager_->OnNodeAdd(*node);
+  gcs_placement_group_manager_->OnNodeAdd(NodeID::FromBinary(node->node_id()));
+  gcs_actor_manager_->SchedulePendingActors();
+  ray_syncer_->AddNode(*node);
+}
+
+void GcsServer::OnNodeRemoved(std::shared_ptr<rpc::GcsNodeInfo> node) {
+  auto node_id = NodeID::FromBinary(node->node_id());
+  const auto node_ip_address = node->node_manager_address();
+  // All of the related placement groups and actors should be reconstructed when a
+  // node is removed from the GCS.
+  gcs_resource_manager_->OnNodeDead(node_id);
+  gcs_placement_group_manager_->OnNodeDead(node_id);
+  gcs_actor_manager_->OnNodeDead(node_id, node_ip_address);
+  raylet_client_pool_->Disconnect(NodeID::FromBinary(node->node_id()));
+  ray_syncer_->RemoveNode(*node);
+}
+
 void GcsServer::RecordMetrics() const {
   gcs_actor_manager_->RecordMetrics();
   gcs_placement_group_manager_->RecordMetrics();
@@ -88,6 +88,12 @@ class GcsServer {
   /// Generate the redis client options
   RedisClientOptions GetRedisClientOptions() const;
 
+  /// Create the managers and start serving the node info and heartbeat services, once
+  /// the node table is loaded.
+  void StartNodeServices(const GcsInitData &gcs_init_data);
+
+  /// Initialize the managers by the other tables and start serving the other services,
+  /// once the other tables are loaded.
   void DoStart(const GcsInitData &gcs_init_data);
 
   /// Initialize gcs node manager.
@@ -97,22 +103,22 @@ class GcsServer {
   void InitGcsHeartbeatManager(const GcsInitData &gcs_init_data);
 
   /// Initialize gcs resource manager.
-  void InitGcsResourceManager(const GcsInitData &gcs_init_data);
+  void InitGcsResourceManager();
 
   /// Initialize synchronization service
-  void InitRaySyncer(const GcsInitData &gcs_init_data);
+  void InitRaySyncer();
 
   /// Initialize gcs resource scheduler.
   void InitGcsResourceScheduler();
 
   /// Initialize gcs job manager.
-  void InitGcsJobManager(const GcsInitData &gcs_init_data);
+  void InitGcsJobManager();
 
   /// Initialize gcs actor manager.
-  void InitGcsActorManager(const GcsInitData &gcs_init_data);
+  void InitGcsActorManager();
 
   /// Initialize gcs placement group manager.
-  void InitGcsPlacementGroupManager(const GcsInitData &gcs_init_data);
+  void InitGcsPlacementGroupManager();
 
   /// Initialize gcs worker manager.
   void InitGcsWorkerManager();
@@ -135,6 +141,12 @@ class GcsServer {
   /// Install event listeners.
   void InstallEventListeners();
 
+  /// Notify the managers that a node has been added.
+  void OnNodeAdded(std::shared_ptr<rpc::GcsNodeInfo> node);
+
+  /// Notify the managers that a node has been removed.
+  void OnNodeRemoved(std::shared_ptr<rpc::GcsNodeInfo> node);
+
  private:
   /// Gets the type of KV storage to use from config.
   std::string StorageType() const;
@@ -158,6 +170,10 @@ class GcsServer {
   /// Print the asio event loop stats for debugging.
   void PrintAsioStats();
 
+  /// Get the KV that the managers on the main thread use, whose callbacks are called
+  /// on the main thread.
+  InternalKVInterface &GetMainServiceKV();
+
   /// Get or connect to a redis server
   std::shared_ptr<RedisClient> GetOrConnectRedis();
 
@@ -172,6 +188,10 @@ class GcsServer {
   instrumented_io_context heartbeat_manager_io_service_;
   /// The io service used by Pubsub, for isolation from other workload.
   instrumented_io_context pubsub_io_service_;
+  /// The io service used by the internal KV when
+  /// `gcs_server_kv_dedicated_thread` is enabled, for isolation from the main thread.
+  instrumented_io_context kv_io_service_;
+  std::unique_ptr<std::thread> kv_io_service_thread_;
   /// The grpc server
   rpc::GrpcServer rpc_server_;
   /// The `ClientCallManager` object that is shared by all `NodeManagerWorkerClient`s.
@@ -219,6 +239,9 @@ class GcsServer {
   /// Global KV storage handler and service.
   std::unique_ptr<GcsInternalKVManager> kv_manager_;
   std::unique_ptr<rpc::InternalKVGrpcService> kv_service_;
+  /// The KV that the managers on the main thread use, when the KV runs on its own
+  /// thread.
+  std::unique_ptr<ForwardingInternalKV> main_service_kv_;
   /// GCS PubSub handler and service.
   std::unique_ptr<InternalPubSubHandler> pubsub_handler_;
   std::unique_ptr<rpc::InternalPubSubGrpcService> pubsub_service_;
@@ -232,7 +255,17 @@ class GcsServer {
   PeriodicalRunner periodical_runner_;
   /// The gcs table storage.
   std::shared_ptr<gcs::GcsTableStorage> gcs_table_storage_;
+  /// The store client that the internal KV is persisted to, which is shared with the
+  /// table storage, or nullptr if the KV isn't persisted by GCS.
+  std::shared_ptr<FileStoreClient> kv_store_client_;
+  /// The keys of the internal KV read from `kv_store_client_`, until the KV is created.
+  absl::flat_hash_map<std::string, std::string> persisted_kv_;
   std::unique_ptr<ray::RuntimeEnvManager> runtime_env_manager_;
+  /// Whether the tables other than the node table have been loaded.
+  bool other_tables_loaded_ = false;
+  /// The node changes made before the other tables were loaded, with whether the node
+  /// was added or removed, to replay once they are loaded.
+  std::vector<std::pair<std::shared_ptr<rpc::GcsNodeInfo>, bool>> pending_node_changes_;
   /// Gcs service state flag, which is used for ut.
   std::atomic<bool> is_started_;
   std::atomic<bool> is_stopped_;
@@ -28,6 +28,25 @@ Status GcsTable<Key, Data>::Put(const Key &key, const Data &value,
                                  callback);
 }
 
+template <typename Key, typename Data>
+Status GcsTable<Key, Data>::BatchPut(const std::vector<std::pair<Key, Data>> &entries,
+                                     const StatusCallback &callback) {
+  if (entries.empty()) {
+    if (callback) {
+      callback(Status::OK());
+    }
+    return Status::OK();
+  }
+  std::vector<BatchPutEntry> batch;
+  batch.reserve(entries.size());
+  for (const auto &entry : entries) {
+    batch.push_back(BatchPutEntry{table_name_, entry.first.Binary(),
+                                  GetIndexKey(entry.first),
+                                  entry.second.SerializeAsString()});
+  }
+  return store_client_->AsyncBatchPut(batch, callback);
+}
+
 template <typename Key, typename Data>
 Status GcsTable<Key, Data>::Get(const Key &key,
                                 const OptionalItemCallback<Data> &callback) {
@@ -58,6 +77,21 @@ Status GcsTable<Key, Data>::GetAll(const MapCallback<Key, Data> &callback) {
   return store_client_->AsyncGetAll(table_name_, on_done);
 }
 
+template <typename Key, typename Data>
+Status GcsTable<Key, Data>::GetAllPaged(const MapCallback<Key, Data> &on_page,
+                                        const StatusCallback &on_done) {
+  auto on_store_page = [on_page](absl::flat_hash_map<std::string, std::string> &&page) {
+    absl::flat_hash_map<Key, Data> values;
+    for (auto &item : page) {
+      if (!item.second.empty()) {
+        values[Key::FromBinary(item.first)].ParseFromString(item.second);
+      }
+    }
+    on_page(std::move(values));
+  };
+  return store_client_->AsyncGetAllPaged(table_name_, on_store_page, on_done);
+}
+
 template <typename Key, typename Data>
 Status GcsTable<Key, Data>::Delete(const Key &key, const StatusCallback &callback) {
   return store_client_->AsyncDelete(table_name_, key.Binary(), callback);
@@ -18,6 +18,9 @@
 #include <utility>
 
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/ray_config.h"
+#include "ray/gcs/store_client/file_store_client.h"
+#include "ray/gcs/store_client/group_commit_store_client.h"
 #include "ray/gcs/store_client/in_memory_store_client.h"
 #include "ray/gcs/store_client/redis_store_client.h"
 #include "src/ray/protobuf/gcs.pb.h"
@@ -61,6 +64,14 @@ class GcsTable {
   /// \return Status
   virtual Status Put(const Key &key, const Data &value, const StatusCallback &callback);
 
+  /// Write a batch of data to the table asynchronously.
+  ///
+  /// \param entries The keys and values that will be written to the table.
+  /// \param callback Callback that will be called after every write finishes.
+  /// \return Status
+  Status BatchPut(const std::vector<std::pair<Key, Data>> &entries,
+                  const StatusCallback &callback);
+
   /// Get data from the table asynchronously.
   ///
   /// \param key The key to lookup from the table.
@@ -74,6 +85,14 @@ class GcsTable {
   /// \return Status
   Status GetAll(const MapCallback<Key, Data> &callback);
 
+  /// Get all data from the table asynchronously, a page at a time.
+  ///
+  /// \param on_page Callback that will be called with every page of data.
+  /// \param on_done Callback that will be called after the last page.
+  /// \return Status
+  Status GetAllPaged(const MapCallback<Key, Data> &on_page,
+                     const StatusCallback &on_done);
+
   /// Delete data from the table asynchronously.
   ///
   /// \param key The key that will be deleted from the table.
@@ -90,6 +109,10 @@ class GcsTable {
                              const StatusCallback &callback);
 
  protected:
+  /// The secondary key that the data of a key is indexed by, or empty if the table
+  /// isn't indexed.
+  virtual std::string GetIndexKey(const Key &key) { return ""; }
+
   std::string table_name_;
   std::shared_ptr<StoreClient> store_client_;
 };
@@ -146,6 +169,10 @@ class GcsTableWithJobId : public GcsTable<Key, Data> {
 
  protected:
   virtual JobID GetJobIdFromKey(const Key &key) = 0;
+
+  std::string GetIndexKey(const Key &key) override {
+    return GetJobIdFromKey(key).Binary();
+  }
 };
 
 class GcsJobTable : public GcsTable<JobID, JobTableData> {
@@ -330,6 +357,26 @@ class RedisGcsTableStorage : public GcsTableStorage {
  public:
   explicit RedisGcsTableStorage(std::shared_ptr<RedisClient> redis_client)
       : GcsTableStorage(std::make_shared<RedisStoreClient>(std::move(redis_client))) {}
+
+  /// Group the writes to redis into batches written on `main_io_service`, if
+  /// `gcs_storage_group_commit_window_us` is set.
+  RedisGcsTableStorage(std::shared_ptr<RedisClient> redis_client,
+                       instrumented_io_context &main_io_service)
+      : GcsTableStorage(MakeStoreClient(std::move(redis_client), main_io_service)) {}
+
+ private:
+  static std::shared_ptr<StoreClient> MakeStoreClient(
+      std::shared_ptr<RedisClient> redis_client,
+      instrumented_io_context &main_io_service) {
+    auto store_client = std::make_shared<RedisStoreClient>(std::move(redis_client));
+    const auto window_us = RayConfig::instance().gcs_storage_group_commit_window_us();
+    if (window_us <= 0) {
+      return store_client;
+    }
+    return std::make_shared<GroupCommitStoreClient>(
+        std::move(store_client), main_io_service, window_us,
+        RayConfig::instance().gcs_storage_group_commit_max_entries());
+  }
 };
 
 /// \class InMemoryGcsTableStorage
@@ -341,5 +388,16 @@ class InMemoryGcsTableStorage : public GcsTableStorage {
       : GcsTableStorage(std::make_shared<InMemoryStoreClient>(main_io_service)) {}
 };
 
+/// \class FileGcsTableStorage
+/// FileGcsTableStorage is an implementation of `GcsTableStorage`
+/// that uses memory as storage, and persists it to a directory on local disk.
+class FileGcsTableStorage : public GcsTableStorage {
+ public:
+  /// \param store_client The store client of the directory, which the internal KV can
+  /// share.
+  explicit FileGcsTableStorage(std::shared_ptr<FileStoreClient> store_client)
+      : GcsTableStorage(std::move(store_client)) {}
+};
+
 }  // namespace gcs
 }  // namespace ray
@@ -14,6 +14,9 @@
 
 #include "ray/gcs/gcs_server/grpc_based_resource_broadcaster.h"
 
+#include <algorithm>
+
+#include "ray/common/ray_config.h"
 #include "ray/stats/metric_defs.h"
 
 namespace ray {
@@ -29,7 +32,10 @@ GrpcBasedResourceBroadcaster::GrpcBasedResourceBroadcaster(
     )
     : seq_no_(absl::GetCurrentTimeNanos()),
       raylet_client_pool_(raylet_client_pool),
-      send_batch_(send_batch) {}
+      send_batch_(send_batch),
+      snapshot_interval_(RayConfig::instance().resource_broadcast_snapshot_interval()),
+      view_(seq_no_),
+      regions_(RayConfig::instance().resource_dissemination_region_size()) {}
 
 GrpcBasedResourceBroadcaster::~GrpcBasedResourceBroadcaster() {}
 
@@ -48,7 +54,15 @@ void GrpcBasedResourceBroadcaster::HandleNodeAdded(const rpc::GcsNodeInfo &node_
   NodeID node_id = NodeID::FromBinary(node_info.node_id());
 
   absl::MutexLock guard(&mutex_);
-  nodes_[node_id] = std::move(address);
+  auto &receiver = nodes_[node_id];
+  receiver.address = std::move(address);
+  receiver.next_seq_no = seq_no_;
+  const auto aggregator_id = regions_.AddNode(node_id);
+  if (aggregator_id != node_id) {
+    // The aggregator forwards the same broadcast to its whole region, so the region
+    // needs a snapshot for the new node to catch up.
+    nodes_.at(aggregator_id).sent_version = -1;
+  }
 }
 
 void GrpcBasedResourceBroadcaster::HandleNodeRemoved(const rpc::GcsNodeInfo &node_info) {
@@ -56,6 +70,14 @@ void GrpcBasedResourceBroadcaster::HandleNodeRemoved(const rpc::GcsNodeInfo &nod
   {
     absl::MutexLock guard(&mutex_);
     nodes_.erase(node_id);
+    view_.RemoveNode(node_info.node_id());
+    const bool was_aggregator = regions_.IsAggregator(node_id);
+    const auto aggregator_id = regions_.RemoveNode(node_id);
+    if (was_aggregator && !aggregator_id.IsNil()) {
+      // The new aggregator only acknowledged the broadcasts for itself so far, not
+      // for its region.
+      nodes_.at(aggregator_id).sent_version = -1;
+    }
     RAY_LOG(DEBUG) << "Node removed (node_id: " << node_id
                    << ")# of remaining nodes: " << nodes_.size();
   }
@@ -63,35 +85,106 @@ void GrpcBasedResourceBroadcaster::HandleNodeRemoved(const rpc::GcsNodeInfo &nod
 
 std::string GrpcBasedResourceBroadcaster::DebugString() {
   size_t node_num = 0;
+  int64_t version = 0;
   {
     absl::MutexLock guard(&mutex_);
     node_num = nodes_.size();
+    version = view_.GetVersion();
   }
-  return absl::StrCat("GrpcBasedResourceBroadcaster:\n- Tracked nodes: ", node_num);
+  return absl::StrCat("GrpcBasedResourceBroadcaster:\n- Tracked nodes: ", node_num,
+                      "\n- Resource view version: ", version);
 }
 
 void GrpcBasedResourceBroadcaster::SendBroadcast(rpc::ResourceUsageBroadcastData batch) {
-  if (batch.batch_size() == 0) {
-    return;
+  absl::MutexLock guard(&mutex_);
+  // Resource reports are state and go into the view, while the other updates (i.e.
+  // placement group resource changes) are events that every node is sent once.
+  rpc::ResourceUsageBroadcastData events;
+  for (auto &update : *batch.mutable_batch()) {
+    if (update.has_data()) {
+      view_.Update(update.data());
+    } else {
+      events.add_batch()->Swap(&update);
+    }
   }
 
-  batch.set_seq_no(seq_no_++);
-
-  // Serializing is relatively expensive on large batches, so we should only do it once.
-  std::string serialized_batch = batch.SerializeAsString();
-  stats::OutboundHeartbeatSizeKB.Record((double)(serialized_batch.size() / 1024.0));
-
-  absl::MutexLock guard(&mutex_);
-  for (const auto &pair : nodes_) {
-    const auto &address = pair.second;
+  // Serializing is relatively expensive on large batches, so we should only do it once
+  // per version the nodes were last sent. Snapshots are keyed by -1.
+  absl::flat_hash_map<int64_t, std::string> serialized_batches;
+  for (auto &entry : nodes_) {
+    const auto &node_id = entry.first;
+    auto &receiver = entry.second;
+    if (!regions_.IsAggregator(node_id)) {
+      continue;
+    }
+    if (receiver.sent_version == view_.GetVersion() && events.batch_size() == 0) {
+      continue;
+    }
+    const bool snapshot = receiver.sent_version < 0 ||
+                          receiver.broadcasts_since_snapshot >= snapshot_interval_;
+    const int64_t base_version = snapshot ? -1 : receiver.sent_version;
+
+    auto it = serialized_batches.find(base_version);
+    if (it == serialized_batches.end()) {
+      rpc::ResourceUsageBroadcastData message;
+      message.mutable_batch()->CopyFrom(events.batch());
+      if (snapshot) {
+        view_.FillSnapshot(&message);
+      } else {
+        view_.FillDelta(base_version, &message);
+      }
+      it = serialized_batches.emplace(base_version, message.SerializeAsString()).first;
+      stats::OutboundHeartbeatSizeKB.Record((double)(it->second.size() / 1024.0));
+    }
+    // Concatenated messages parse as their merge, so the sequence number of the node
+    // and the rest of its region are appended to the shared batch instead of
+    // serializing the batch again.
+    rpc::ResourceUsageBroadcastData receiver_fields;
+    receiver_fields.set_seq_no(receiver.next_seq_no++);
+    for (const auto &member_id : regions_.GetMembers(node_id)) {
+      if (member_id != node_id) {
+        receiver_fields.add_forward_to()->CopyFrom(nodes_.at(member_id).address);
+      }
+    }
+    std::string serialized_batch = it->second + receiver_fields.SerializeAsString();
+
+    const int64_t sent_version = view_.GetVersion();
+    receiver.sent_version = sent_version;
+    receiver.broadcasts_since_snapshot =
+        snapshot ? 0 : receiver.broadcasts_since_snapshot + 1;
     double start_time = absl::GetCurrentTimeNanos();
-    auto callback = [start_time](const Status &status,
+    auto callback = [this, node_id, sent_version,
+                     start_time](const Status &status,
                                  const rpc::UpdateResourceUsageReply &reply) {
       double end_time = absl::GetCurrentTimeNanos();
       double lapsed_time_ms = static_cast<double>(end_time - start_time) / 1e6;
       ray::stats::GcsUpdateResourceUsageTime.Record(lapsed_time_ms);
+      HandleReply(node_id, sent_version, status, reply);
     };
-    send_batch_(address, raylet_client_pool_, serialized_batch, callback);
+    send_batch_(receiver.address, raylet_client_pool_, serialized_batch, callback);
+  }
+}
+
+void GrpcBasedResourceBroadcaster::HandleReply(
+    const NodeID &node_id, int64_t sent_version, const Status &status,
+    const rpc::UpdateResourceUsageReply &reply) {
+  absl::MutexLock guard(&mutex_);
+  auto it = nodes_.find(node_id);
+  if (it == nodes_.end()) {
+    return;
+  }
+  auto &receiver = it->second;
+  if (status.ok()) {
+    receiver.acked_version =
+        std::max(receiver.acked_version, reply.resource_view_version());
+  }
+  if (!status.ok() || reply.resource_view_version() < sent_version) {
+    // The node didn't apply the broadcast, so the next one should cover the changes
+    // since the version it did apply.
+    RAY_LOG(DEBUG) << "Node " << node_id << " didn't apply resource view version "
+                   << sent_version << ", resending the changes since version "
+                   << receiver.acked_version;
+    receiver.sent_version = std::min(receiver.sent_version, receiver.acked_version);
   }
 }
 
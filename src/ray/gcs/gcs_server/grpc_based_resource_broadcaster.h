@@ -16,12 +16,25 @@
 #include "absl/container/flat_hash_map.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/gcs/gcs_server/gcs_resource_manager.h"
+#include "ray/gcs/gcs_server/resource_regions.h"
+#include "ray/gcs/gcs_server/versioned_resource_view.h"
 #include "ray/rpc/node_manager/node_manager_client_pool.h"
 
 namespace ray {
 namespace gcs {
 
 /// Broadcasts resource report batches to raylets from a separate thread.
+///
+/// The broadcaster keeps a versioned view of the resources of every node. Each raylet
+/// is sent the resources of the nodes that changed since the version of the view it
+/// was last sent, and acknowledges the version it applied in the reply. A raylet that
+/// failed to apply a broadcast is sent the changes since its acknowledged version
+/// instead, and every raylet is periodically sent a snapshot of the whole view so that
+/// it recovers from any divergence.
+///
+/// When `resource_dissemination_region_size` is set, only the aggregator of every
+/// region of nodes is sent broadcasts. It forwards them to the rest of its region, and
+/// acknowledges the oldest version its region applied.
 class GrpcBasedResourceBroadcaster {
  public:
   GrpcBasedResourceBroadcaster(
@@ -51,10 +64,30 @@ class GrpcBasedResourceBroadcaster {
   void HandleNodeRemoved(const rpc::GcsNodeInfo &node_info) LOCKS_EXCLUDED(mutex_);
 
   std::string DebugString();
-  void SendBroadcast(rpc::ResourceUsageBroadcastData batch);
+
+  /// Apply the resource reports of the batch to the view and send every node the
+  /// changes it hasn't been sent yet, along with the other updates of the batch.
+  void SendBroadcast(rpc::ResourceUsageBroadcastData batch) LOCKS_EXCLUDED(mutex_);
 
  private:
-  // The sequence number of the next broadcast to send.
+  struct ReceiverState {
+    rpc::Address address;
+    /// The sequence number of the next broadcast to the node.
+    int64_t next_seq_no;
+    /// The version of the view the node acknowledged, or -1 if it acknowledged none.
+    int64_t acked_version = -1;
+    /// The version of the view the node was last sent, or -1 if it must be sent a
+    /// snapshot.
+    int64_t sent_version = -1;
+    /// The number of broadcasts to the node since its last snapshot.
+    uint64_t broadcasts_since_snapshot = 0;
+  };
+
+  /// Handle the reply of a node to a broadcast of the given version of the view.
+  void HandleReply(const NodeID &node_id, int64_t sent_version, const Status &status,
+                   const rpc::UpdateResourceUsageReply &reply) LOCKS_EXCLUDED(mutex_);
+
+  // The sequence number of the first broadcast to a node.
   int64_t seq_no_;
 
   // The shared, thread safe pool of raylet clients, which we use to minimize connections.
@@ -65,10 +98,18 @@ class GrpcBasedResourceBroadcaster {
                      const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &)>
       send_batch_;
 
+  /// The number of broadcasts to a node after which it is sent a snapshot.
+  const uint64_t snapshot_interval_;
+
   /// A lock to protect the data structures.
   absl::Mutex mutex_;
-  /// The set of nodes and their addresses which are subscribed to resource usage changes.
-  absl::flat_hash_map<NodeID, rpc::Address> nodes_ GUARDED_BY(mutex_);
+  /// The set of nodes which are subscribed to resource usage changes.
+  absl::flat_hash_map<NodeID, ReceiverState> nodes_ GUARDED_BY(mutex_);
+  /// The resources of every node, as broadcast so far.
+  VersionedResourceView view_ GUARDED_BY(mutex_);
+  /// The regions of the nodes. Every node is in a region of its own unless
+  /// `resource_dissemination_region_size` is set.
+  ResourceRegions regions_ GUARDED_BY(mutex_);
 
   friend class GrpcBasedResourceBroadcasterTest;
 };
@@ -20,6 +20,7 @@
 #include "ray/gcs/gcs_server/gcs_resource_manager.h"
 #include "ray/gcs/gcs_server/gcs_resource_report_poller.h"
 #include "ray/gcs/gcs_server/grpc_based_resource_broadcaster.h"
+#include "ray/gcs/gcs_server/versioned_resource_view.h"
 
 namespace ray {
 class GcsPlacementGroupSchedulerTest;
@@ -119,8 +120,10 @@ class RaySyncer {
         update.clear_resource_load();
         update.clear_resource_load_by_shape();
         update.clear_resources_normal_task();
-        auto &orig = resources_buffer_[update.node_id()];
-        orig.Swap(&update);
+        // Reports may only contain the sections that changed since the previous one,
+        // so merge them with the report that is still buffered.
+        ::ray::gcs::VersionedResourceView::Merge(update,
+                                                 &resources_buffer_[update.node_id()]);
       }
     }
   }
@@ -0,0 +1,83 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/resource_regions.h"
+
+#include <algorithm>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace gcs {
+
+ResourceRegions::ResourceRegions(size_t region_size)
+    : region_size_(std::max<size_t>(region_size, 1)) {}
+
+NodeID ResourceRegions::AddNode(const NodeID &node_id) {
+  auto it = node_regions_.find(node_id);
+  if (it != node_regions_.end()) {
+    return regions_[it->second].front();
+  }
+  if (regions_with_room_.empty()) {
+    regions_with_room_.insert(regions_.size());
+    regions_.emplace_back();
+  }
+  const size_t region = *regions_with_room_.begin();
+  auto &members = regions_[region];
+  members.push_back(node_id);
+  if (members.size() >= region_size_) {
+    regions_with_room_.erase(region);
+  }
+  node_regions_.emplace(node_id, region);
+  return members.front();
+}
+
+NodeID ResourceRegions::RemoveNode(const NodeID &node_id) {
+  auto it = node_regions_.find(node_id);
+  if (it == node_regions_.end()) {
+    return NodeID::Nil();
+  }
+  const size_t region = it->second;
+  node_regions_.erase(it);
+  auto &members = regions_[region];
+  auto member_it = std::find(members.begin(), members.end(), node_id);
+  RAY_CHECK(member_it != members.end());
+  members.erase(member_it);
+  regions_with_room_.insert(region);
+  return members.empty() ? NodeID::Nil() : members.front();
+}
+
+bool ResourceRegions::IsAggregator(const NodeID &node_id) const {
+  return !node_id.IsNil() && GetAggregator(node_id) == node_id;
+}
+
+NodeID ResourceRegions::GetAggregator(const NodeID &node_id) const {
+  auto it = node_regions_.find(node_id);
+  if (it == node_regions_.end()) {
+    return NodeID::Nil();
+  }
+  return regions_[it->second].front();
+}
+
+const std::vector<NodeID> &ResourceRegions::GetMembers(const NodeID &node_id) const {
+  static const std::vector<NodeID> kNoMembers;
+  auto it = node_regions_.find(node_id);
+  if (it == node_regions_.end()) {
+    return kNoMembers;
+  }
+  return regions_[it->second];
+}
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,77 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/id.h"
+
+namespace ray {
+namespace gcs {
+
+/// Groups the nodes of the cluster into regions of a bounded size, so that GCS only
+/// exchanges resources with one aggregator node per region, which exchanges them with
+/// the rest of its region.
+///
+/// Nodes join the first region with room left, and the aggregator of a region is its
+/// longest-lived member, so that regions and aggregators only change when nodes leave.
+/// The assignment only depends on the order in which nodes are added and removed, so
+/// components that see the same node events agree on it without coordinating.
+///
+/// This class is not thread safe.
+class ResourceRegions {
+ public:
+  /// \param region_size The maximum number of nodes of a region. 0 means that every
+  /// node is in a region of its own.
+  explicit ResourceRegions(size_t region_size);
+
+  /// Add a node to the first region with room left.
+  ///
+  /// \return The aggregator of the region of the node.
+  NodeID AddNode(const NodeID &node_id);
+
+  /// Remove a node from its region. No-op if the node isn't in any region.
+  ///
+  /// \return The aggregator of the region of the node once it is removed, or nil if
+  /// the region is left empty or the node isn't in any region.
+  NodeID RemoveNode(const NodeID &node_id);
+
+  /// Whether the node aggregates the resources of its region.
+  bool IsAggregator(const NodeID &node_id) const;
+
+  /// The aggregator of the region of a node, or nil if the node isn't in any region.
+  NodeID GetAggregator(const NodeID &node_id) const;
+
+  /// The nodes of the region of a node, aggregator first and then in the order they
+  /// joined. Empty if the node isn't in any region.
+  const std::vector<NodeID> &GetMembers(const NodeID &node_id) const;
+
+  size_t NumRegions() const { return regions_.size(); }
+
+ private:
+  const size_t region_size_;
+  /// The members of every region. Regions keep their index when they are left empty,
+  /// so that they can be refilled.
+  std::vector<std::vector<NodeID>> regions_;
+  /// The indexes of the regions with room left.
+  std::set<size_t> regions_with_room_;
+  /// The region of every node.
+  absl::flat_hash_map<NodeID, size_t> node_regions_;
+};
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,299 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/bundle_placement_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace gcs {
+
+class BundlePlacementEngineTest : public ::testing::Test {
+ public:
+  NodeID AddNode(const absl::flat_hash_map<std::string, double> &total,
+                 const absl::flat_hash_map<std::string, double> &available) {
+    auto node_id = NodeID::FromRandom();
+    cluster_resources_.emplace(
+        node_id, std::make_shared<Node>(ResourceMapToNodeResources(total, available)));
+    return node_id;
+  }
+
+  NodeID AddNode(const absl::flat_hash_map<std::string, double> &total) {
+    return AddNode(total, total);
+  }
+
+  static std::vector<ResourceRequest> MakeBundles(
+      const std::vector<absl::flat_hash_map<std::string, double>> &bundles) {
+    std::vector<ResourceRequest> resource_requests;
+    for (const auto &bundle : bundles) {
+      resource_requests.push_back(ResourceMapToResourceRequest(bundle, false));
+    }
+    return resource_requests;
+  }
+
+  SchedulingResult Place(
+      const std::vector<absl::flat_hash_map<std::string, double>> &bundles,
+      SchedulingType scheduling_type) {
+    BundlePlacementEngine engine(cluster_resources_);
+    return engine.PlaceAll({{MakeBundles(bundles), scheduling_type, nullptr}}).front();
+  }
+
+ protected:
+  absl::flat_hash_map<NodeID, std::shared_ptr<Node>> cluster_resources_;
+};
+
+TEST_F(BundlePlacementEngineTest, TestPackLocalSearch) {
+  const auto node_1 = AddNode({{"CPU", 4}});
+  AddNode({{"CPU", 3}});
+
+  // The greedy pass puts the big bundle on the node it fits most tightly and the small
+  // one on the other node, and the local search then moves the big bundle next to the
+  // small one.
+  auto result = Place({{{"CPU", 3}}, {{"CPU", 1}}}, PACK);
+  ASSERT_EQ(result.first, SchedulingResultStatus::SUCCESS);
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_1, node_1}));
+
+  // Bundles that don't fit on one node are still placed.
+  result = Place({{{"CPU", 3}}, {{"CPU", 3}}}, PACK);
+  ASSERT_EQ(result.first, SchedulingResultStatus::SUCCESS);
+  ASSERT_NE(result.second[0], result.second[1]);
+}
+
+TEST_F(BundlePlacementEngineTest, TestStrictSpreadAugment) {
+  const auto node_1 = AddNode({{"CPU", 2}, {"GPU", 1}});
+  const auto node_2 = AddNode({{"CPU", 2}});
+
+  // Whichever node the CPU bundle is placed on first, the GPU bundle ends up on the
+  // only node with a GPU and the CPU bundle on the other one.
+  auto result = Place({{{"CPU", 2}}, {{"GPU", 1}}}, STRICT_SPREAD);
+  ASSERT_EQ(result.first, SchedulingResultStatus::SUCCESS);
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_2, node_1}));
+
+  result = Place({{{"CPU", 1}}, {{"CPU", 1}}, {{"CPU", 1}}}, STRICT_SPREAD);
+  ASSERT_EQ(result.first, SchedulingResultStatus::INFEASIBLE);
+}
+
+TEST_F(BundlePlacementEngineTest, TestStrictPack) {
+  AddNode({{"CPU", 4}});
+  const auto node_2 = AddNode({{"CPU", 8}});
+
+  auto result = Place({{{"CPU", 2}}, {{"CPU", 2}}, {{"CPU", 2}}}, STRICT_PACK);
+  ASSERT_EQ(result.first, SchedulingResultStatus::SUCCESS);
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_2, node_2, node_2}));
+
+  result = Place({{{"CPU", 4}}, {{"CPU", 4}}, {{"CPU", 4}}}, STRICT_PACK);
+  ASSERT_EQ(result.first, SchedulingResultStatus::INFEASIBLE);
+}
+
+TEST_F(BundlePlacementEngineTest, TestInfeasibleAndFailed) {
+  AddNode({{"CPU", 4}}, {{"CPU", 1}});
+
+  // A bundle that is bigger than every node can never be placed.
+  ASSERT_EQ(Place({{{"CPU", 8}}}, PACK).first, SchedulingResultStatus::INFEASIBLE);
+  ASSERT_EQ(Place({{{"custom", 1}}}, SPREAD).first, SchedulingResultStatus::INFEASIBLE);
+  // A bundle that only needs resources to be released can be placed later.
+  ASSERT_EQ(Place({{{"CPU", 2}}}, PACK).first, SchedulingResultStatus::FAILED);
+
+  BundlePlacementEngine engine(cluster_resources_);
+  auto results = engine.PlaceAll({{MakeBundles({{{"CPU", 1}}}), PACK,
+                                   [](const NodeID &) { return false; }}});
+  ASSERT_EQ(results.front().first, SchedulingResultStatus::INFEASIBLE);
+}
+
+TEST_F(BundlePlacementEngineTest, TestPlaceAll) {
+  for (int i = 0; i < 3; i++) {
+    AddNode({{"CPU", 4}});
+  }
+
+  BundlePlacementEngine engine(cluster_resources_);
+  auto results = engine.PlaceAll({
+      {MakeBundles({{{"CPU", 4}}, {{"CPU", 4}}}), PACK, nullptr},
+      // Only one node is left, so the second bundle doesn't fit.
+      {MakeBundles({{{"CPU", 1}}, {{"CPU", 4}}}), SPREAD, nullptr},
+      // The resources of the failed group were given back.
+      {MakeBundles({{{"CPU", 4}}}), PACK, nullptr},
+      {MakeBundles({{{"CPU", 1}}}), PACK, nullptr},
+  });
+  ASSERT_EQ(results.size(), 4);
+  ASSERT_EQ(results[0].first, SchedulingResultStatus::SUCCESS);
+  ASSERT_NE(results[0].second[0], results[0].second[1]);
+  ASSERT_EQ(results[1].first, SchedulingResultStatus::FAILED);
+  ASSERT_EQ(results[2].first, SchedulingResultStatus::SUCCESS);
+  ASSERT_EQ(results[3].first, SchedulingResultStatus::FAILED);
+
+  // The engine doesn't modify the resources of the cluster.
+  for (const auto &entry : cluster_resources_) {
+    ASSERT_EQ(entry.second->GetLocalView().predefined_resources[CPU].available.Double(),
+              4);
+  }
+}
+
+TEST_F(BundlePlacementEngineTest, TestFragmentation) {
+  AddNode({{"CPU", 4}});
+  AddNode({{"CPU", 4}});
+
+  BundlePlacementEngine engine(cluster_resources_);
+  engine.PlaceAll({{MakeBundles({{{"CPU", 2}}}), PACK, nullptr}});
+  auto stats = engine.GetFragmentation();
+  ASSERT_DOUBLE_EQ(stats.free_fraction, 0.75);
+  ASSERT_DOUBLE_EQ(stats.fragmentation, 1 - 4.0 / 6);
+  ASSERT_EQ(stats.num_partially_used_nodes, 1);
+
+  engine.PlaceAll({{MakeBundles({{{"CPU", 4}}, {{"CPU", 4}}}), PACK, nullptr}});
+  stats = engine.GetFragmentation();
+  ASSERT_DOUBLE_EQ(stats.free_fraction, 0);
+  ASSERT_DOUBLE_EQ(stats.fragmentation, 0);
+  ASSERT_EQ(stats.num_partially_used_nodes, 0);
+}
+
+TEST_F(BundlePlacementEngineTest, TestPlaceNext) {
+  const auto node_1 = AddNode({{"CPU", 4}});
+  const auto node_2 = AddNode({{"CPU", 2}});
+
+  BundlePlacementEngine engine(cluster_resources_);
+  auto result = engine.PlaceNext({MakeBundles({{{"CPU", 2}}}), PACK, nullptr});
+  ASSERT_EQ(result.first, SchedulingResultStatus::SUCCESS);
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_2}));
+
+  // The bundle wasn't acquired, so its resources are still free.
+  result = engine.PlaceNext({MakeBundles({{{"CPU", 2}}}), PACK, nullptr});
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_2}));
+
+  // The resources acquired on a node are seen by the next placement.
+  cluster_resources_[node_2]->GetMutableLocalView()->predefined_resources[CPU].available =
+      0;
+  result = engine.PlaceNext({MakeBundles({{{"CPU", 2}}}), PACK, nullptr});
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_1}));
+
+  // So are new resources and new nodes.
+  const auto node_3 = AddNode({{"CPU", 1}, {"custom", 1}});
+  result = engine.PlaceNext({MakeBundles({{{"custom", 1}}}), PACK, nullptr});
+  ASSERT_EQ(result.second, std::vector<NodeID>({node_3}));
+  cluster_resources_.erase(node_3);
+  result = engine.PlaceNext({MakeBundles({{{"custom", 1}}}), PACK, nullptr});
+  ASSERT_EQ(result.first, SchedulingResultStatus::INFEASIBLE);
+}
+
+/// Places the bundles of a group the way `GcsResourceScheduler` does: on the node with
+/// the most free resources, followed by as many of the remaining bundles as fit there.
+bool PlaceOnMostFree(const std::vector<double> &bundles, std::vector<double> *free) {
+  std::vector<double> placed(free->size(), 0);
+  std::vector<bool> remaining(bundles.size(), true);
+  size_t num_remaining = bundles.size();
+  std::vector<bool> tried(free->size(), false);
+  while (num_remaining > 0) {
+    const double first =
+        bundles[std::find(remaining.begin(), remaining.end(), true) - remaining.begin()];
+    int64_t best_node = -1;
+    for (size_t node = 0; node < free->size(); node++) {
+      if (!tried[node] && (*free)[node] - placed[node] >= first &&
+          (best_node == -1 ||
+           (*free)[node] - placed[node] > (*free)[best_node] - placed[best_node])) {
+        best_node = node;
+      }
+    }
+    if (best_node == -1) {
+      return false;
+    }
+    tried[best_node] = true;
+    for (size_t i = 0; i < bundles.size(); i++) {
+      if (remaining[i] && (*free)[best_node] - placed[best_node] >= bundles[i]) {
+        placed[best_node] += bundles[i];
+        remaining[i] = false;
+        num_remaining--;
+      }
+    }
+  }
+  for (size_t node = 0; node < free->size(); node++) {
+    (*free)[node] -= placed[node];
+  }
+  return true;
+}
+
+TEST_F(BundlePlacementEngineTest, PlacementBenchmark) {
+  const int num_nodes = 1000;
+  const double node_cpus = 16;
+  for (int i = 0; i < num_nodes; i++) {
+    AddNode({{"CPU", node_cpus}});
+  }
+
+  // Groups of small bundles that take about a third of the cluster, followed by groups
+  // that each need a whole node.
+  std::mt19937 gen(0);
+  std::vector<std::vector<double>> groups;
+  std::vector<BundlePlacementEngine::Request> requests;
+  double requested_cpus = 0;
+  while (requested_cpus < num_nodes * node_cpus / 3) {
+    std::vector<double> bundles(std::uniform_int_distribution<int>(2, 64)(gen));
+    std::vector<absl::flat_hash_map<std::string, double>> bundle_maps;
+    for (auto &bundle : bundles) {
+      bundle = 1 << std::uniform_int_distribution<int>(0, 2)(gen);
+      requested_cpus += bundle;
+      bundle_maps.push_back({{"CPU", bundle}});
+    }
+    groups.push_back(bundles);
+    requests.push_back({MakeBundles(bundle_maps), PACK, nullptr});
+  }
+  const size_t num_small_groups = groups.size();
+  for (int i = 0; i < num_nodes; i++) {
+    groups.push_back({node_cpus});
+    requests.push_back({MakeBundles({{{"CPU", node_cpus}}}), STRICT_PACK, nullptr});
+  }
+
+  BundlePlacementEngine engine(cluster_resources_);
+  auto start = std::chrono::steady_clock::now();
+  const auto results = engine.PlaceAll(requests);
+  const auto engine_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  const auto stats = engine.GetFragmentation();
+
+  std::vector<double> free(num_nodes, node_cpus);
+  size_t baseline_small_placed = 0;
+  size_t baseline_whole_placed = 0;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < groups.size(); i++) {
+    if (PlaceOnMostFree(groups[i], &free)) {
+      (i < num_small_groups ? baseline_small_placed : baseline_whole_placed)++;
+    }
+  }
+  const auto baseline_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+  size_t small_placed = 0;
+  size_t whole_placed = 0;
+  for (size_t i = 0; i < results.size(); i++) {
+    if (results[i].first == SchedulingResultStatus::SUCCESS) {
+      (i < num_small_groups ? small_placed : whole_placed)++;
+    }
+  }
+  RAY_LOG(INFO) << "Bin-packing: placed " << small_placed << "/" << num_small_groups
+                << " small groups and " << whole_placed << " whole-node groups in "
+                << engine_us << "us, fragmentation " << stats.fragmentation
+                << ", partially used nodes " << stats.num_partially_used_nodes;
+  RAY_LOG(INFO) << "Most free node: placed " << baseline_small_placed << "/"
+                << num_small_groups << " small groups and " << baseline_whole_placed
+                << " whole-node groups in " << baseline_us << "us";
+  ASSERT_EQ(small_placed, num_small_groups);
+  ASSERT_EQ(baseline_small_placed, num_small_groups);
+  ASSERT_GT(whole_placed, baseline_whole_placed);
+}
+
+}  // namespace gcs
+}  // namespace ray
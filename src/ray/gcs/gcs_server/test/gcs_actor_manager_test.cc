@@ -34,6 +34,10 @@ class MockActorScheduler : public gcs::GcsActorSchedulerInterface {
   MockActorScheduler() {}
 
   void Schedule(std::shared_ptr<gcs::GcsActor> actor) { actors.push_back(actor); }
+  void ScheduleBatch(const std::vector<std::shared_ptr<gcs::GcsActor>> &batch) {
+    num_batches += 1;
+    actors.insert(actors.end(), batch.begin(), batch.end());
+  }
   void Reschedule(std::shared_ptr<gcs::GcsActor> actor) {}
   void ReleaseUnusedWorkers(
       const absl::flat_hash_map<NodeID, std::vector<WorkerID>> &node_to_workers) {}
@@ -46,6 +50,7 @@ class MockActorScheduler : public gcs::GcsActorSchedulerInterface {
                                      const TaskID &task_id));
 
   std::vector<std::shared_ptr<gcs::GcsActor>> actors;
+  int num_batches = 0;
 };
 
 class MockWorkerClient : public rpc::CoreWorkerClientInterface {
@@ -1134,6 +1139,114 @@ TEST_F(GcsActorManagerTest, TestActorTableDataDelayedGC) {
   }
 }
 
+TEST_F(GcsActorManagerTest, TestRegisterAndCreateActors) {
+  auto job_id = JobID::FromInt(1);
+  rpc::RegisterActorsRequest register_request;
+  for (int i = 0; i < 3; i++) {
+    register_request.add_task_specs()->CopyFrom(
+        Mocker::GenRegisterActorRequest(job_id, /*max_restarts=*/0, /*detached=*/false,
+                                        /*name=*/i == 0 ? "actor" : "")
+            .task_spec());
+  }
+  // An actor with a name that is already taken fails on its own.
+  register_request.add_task_specs()->CopyFrom(
+      Mocker::GenRegisterActorRequest(job_id, /*max_restarts=*/0, /*detached=*/false,
+                                      /*name=*/"actor")
+          .task_spec());
+
+  google::protobuf::Arena arena;
+  auto &register_reply =
+      *google::protobuf::Arena::CreateMessage<rpc::RegisterActorsReply>(&arena);
+  std::promise<void> registered;
+  io_service_.post(
+      [this, &register_request, &register_reply, &registered]() {
+        gcs_actor_manager_->HandleRegisterActors(
+            register_request, &register_reply,
+            [&registered](Status status, std::function<void()> success,
+                          std::function<void()> failure) { registered.set_value(); });
+      },
+      "test");
+  registered.get_future().get();
+  ASSERT_EQ(register_reply.status().code(), 0);
+  ASSERT_EQ(register_reply.statuses_size(), 4);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(register_reply.statuses(i).code(), 0);
+  }
+  ASSERT_NE(register_reply.statuses(3).code(), 0);
+
+  rpc::CreateActorsRequest create_request;
+  for (int i = 0; i < 3; i++) {
+    create_request.add_requests()->mutable_task_spec()->CopyFrom(
+        register_request.task_specs(i));
+  }
+  auto &create_reply =
+      *google::protobuf::Arena::CreateMessage<rpc::CreateActorsReply>(&arena);
+  std::promise<void> created;
+  std::promise<void> scheduled;
+  io_service_.post(
+      [this, &create_request, &create_reply, &created, &scheduled]() {
+        gcs_actor_manager_->HandleCreateActors(
+            create_request, &create_reply,
+            [&created](Status status, std::function<void()> success,
+                       std::function<void()> failure) { created.set_value(); });
+        scheduled.set_value();
+      },
+      "test");
+  scheduled.get_future().get();
+
+  // All of the actors are scheduled together.
+  ASSERT_EQ(mock_actor_scheduler_->num_batches, 1);
+  ASSERT_EQ(mock_actor_scheduler_->actors.size(), 3);
+  auto actors = mock_actor_scheduler_->actors;
+  mock_actor_scheduler_->actors.clear();
+  std::vector<rpc::Address> addresses;
+  for (auto &actor : actors) {
+    addresses.push_back(RandomAddress());
+    actor->UpdateAddress(addresses.back());
+  }
+
+  // The first actor to be created is replied to without waiting for the others.
+  gcs_actor_manager_->OnActorCreationSuccess(actors[1], rpc::PushTaskReply());
+  created.get_future().get();
+  ASSERT_EQ(create_reply.replies_size(), 1);
+  ASSERT_EQ(create_reply.replies(0).index(), 1);
+  ASSERT_EQ(create_reply.replies(0).reply().status().code(), 0);
+  ASSERT_EQ(create_reply.replies(0).reply().actor_address().worker_id(),
+            addresses[1].worker_id());
+  ASSERT_NE(create_reply.batch_id(), 0);
+
+  // The rest of them are polled for.
+  gcs_actor_manager_->OnActorCreationSuccess(actors[0], rpc::PushTaskReply());
+  gcs_actor_manager_->OnActorCreationSuccess(actors[2], rpc::PushTaskReply());
+  uint64_t batch_id = create_reply.batch_id();
+  int num_replies = 0;
+  while (batch_id != 0) {
+    rpc::CreateActorsRequest poll_request;
+    poll_request.set_batch_id(batch_id);
+    auto &poll_reply =
+        *google::protobuf::Arena::CreateMessage<rpc::CreateActorsReply>(&arena);
+    std::promise<void> polled;
+    io_service_.post(
+        [this, &poll_request, &poll_reply, &polled]() {
+          gcs_actor_manager_->HandleCreateActors(
+              poll_request, &poll_reply,
+              [&polled](Status status, std::function<void()> success,
+                        std::function<void()> failure) { polled.set_value(); });
+        },
+        "test");
+    polled.get_future().get();
+    for (const auto &actor_reply : poll_reply.replies()) {
+      ASSERT_NE(actor_reply.index(), 1);
+      ASSERT_EQ(actor_reply.reply().status().code(), 0);
+      ASSERT_EQ(actor_reply.reply().actor_address().worker_id(),
+                addresses[actor_reply.index()].worker_id());
+      num_replies++;
+    }
+    batch_id = poll_reply.batch_id();
+  }
+  ASSERT_EQ(num_replies, 2);
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
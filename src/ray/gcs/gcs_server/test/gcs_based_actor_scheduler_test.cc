@@ -621,6 +621,109 @@ TEST_F(GcsBasedActorSchedulerTest, TestReleaseUnusedWorkers) {
   ASSERT_EQ(raylet_client_->num_workers_requested, 1);
 }
 
+TEST_F(GcsBasedActorSchedulerTest, TestScheduleBatch) {
+  // Add two nodes, each with 10 memory units and 10 CPU.
+  std::vector<NodeID> node_ids;
+  for (int i = 0; i < 2; i++) {
+    std::unordered_map<std::string, double> node_resources = {{kMemory_ResourceLabel, 10},
+                                                              {kCPU_ResourceLabel, 10}};
+    node_ids.push_back(NodeID::FromBinary(AddNewNode(node_resources)->node_id()));
+  }
+
+  // Schedule 10 actors of the same shape and 1 actor of another shape at once.
+  std::vector<std::shared_ptr<gcs::GcsActor>> actors;
+  for (int i = 0; i < 10; i++) {
+    actors.push_back(NewGcsActor({{kMemory_ResourceLabel, 1}, {kCPU_ResourceLabel, 1}}));
+  }
+  actors.push_back(NewGcsActor({{kCPU_ResourceLabel, 2}}));
+  gcs_actor_scheduler_->ScheduleBatch(actors);
+
+  // The actors are spread over both nodes, and their workers are leased with a single
+  // request per node.
+  std::unordered_map<NodeID, int> sched_counts;
+  for (const auto &actor : actors) {
+    ASSERT_FALSE(actor->GetNodeID().IsNil());
+    sched_counts[actor->GetNodeID()]++;
+  }
+  ASSERT_EQ(sched_counts.size(), 2);
+  ASSERT_EQ(2, raylet_client_->num_batch_lease_requests);
+  ASSERT_EQ(11, raylet_client_->num_workers_requested);
+
+  for (size_t i = 0; i < actors.size(); i++) {
+    ASSERT_TRUE(raylet_client_->GrantWorkerLease());
+  }
+  for (size_t i = 0; i < actors.size(); i++) {
+    ASSERT_TRUE(worker_client_->ReplyPushTask());
+  }
+  ASSERT_EQ(0, failure_actors_.size());
+  ASSERT_EQ(actors.size(), success_actors_.size());
+}
+
+TEST_F(GcsBasedActorSchedulerTest, TestScheduleBatchNotEnoughClusterResources) {
+  // Add a node with 3 CPU.
+  AddNewNode({{kCPU_ResourceLabel, 3}});
+
+  // The actors that fit are still scheduled when not all of them do.
+  std::vector<std::shared_ptr<gcs::GcsActor>> actors;
+  for (int i = 0; i < 5; i++) {
+    actors.push_back(NewGcsActor({{kCPU_ResourceLabel, 1}}));
+  }
+  gcs_actor_scheduler_->ScheduleBatch(actors);
+
+  ASSERT_EQ(1, raylet_client_->num_batch_lease_requests);
+  ASSERT_EQ(3, raylet_client_->num_workers_requested);
+  ASSERT_EQ(2, failure_actors_.size());
+}
+
+TEST_F(GcsBasedActorSchedulerTest, ScheduleBatchBenchmark) {
+  const int num_nodes = 20;
+  const int num_actors = 2000;
+  for (int i = 0; i < num_nodes; i++) {
+    AddNewNode({{kCPU_ResourceLabel, 4 * num_actors / num_nodes}});
+  }
+
+  auto run = [&](bool batch) {
+    std::vector<std::shared_ptr<gcs::GcsActor>> actors;
+    for (int i = 0; i < num_actors; i++) {
+      actors.push_back(NewGcsActor({{kCPU_ResourceLabel, 1}}));
+    }
+    success_actors_.clear();
+    const int leases_before = raylet_client_->num_workers_requested;
+    const int batches_before = raylet_client_->num_batch_lease_requests;
+
+    auto start = absl::GetCurrentTimeNanos();
+    if (batch) {
+      gcs_actor_scheduler_->ScheduleBatch(actors);
+      while (raylet_client_->GrantWorkerLease()) {
+      }
+      while (worker_client_->ReplyPushTask()) {
+      }
+    } else {
+      for (const auto &actor : actors) {
+        gcs_actor_scheduler_->Schedule(actor);
+        RAY_CHECK(raylet_client_->GrantWorkerLease());
+        RAY_CHECK(worker_client_->ReplyPushTask());
+      }
+    }
+    auto elapsed_s = absl::ToDoubleSeconds(
+        absl::Nanoseconds(absl::GetCurrentTimeNanos() - start));
+    EXPECT_EQ(num_actors, success_actors_.size());
+
+    const int num_leases = raylet_client_->num_workers_requested - leases_before;
+    const int num_lease_rpcs =
+        batch ? raylet_client_->num_batch_lease_requests - batches_before : num_leases;
+    RAY_LOG(INFO) << (batch ? "Batched" : "Single") << " actor creation: "
+                  << num_actors / elapsed_s << " actors/s, " << num_lease_rpcs
+                  << " lease RPCs for " << num_leases << " leases";
+    return num_lease_rpcs;
+  };
+
+  auto single_rpcs = run(/*batch=*/false);
+  auto batch_rpcs = run(/*batch=*/true);
+  ASSERT_EQ(single_rpcs, num_actors);
+  ASSERT_LT(batch_rpcs, single_rpcs / 10);
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
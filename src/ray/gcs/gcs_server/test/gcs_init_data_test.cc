@@ -0,0 +1,152 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/gcs_init_data.h"
+
+#include <future>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/common/test_util.h"
+#include "ray/gcs/test/gcs_test_util.h"
+
+namespace ray {
+namespace gcs {
+
+class GcsInitDataTest : public ::testing::Test {
+ public:
+  GcsInitDataTest() {
+    io_service_pool_ = std::make_shared<IOServicePool>(1);
+    io_service_pool_->Run();
+    gcs_table_storage_ =
+        std::make_shared<InMemoryGcsTableStorage>(*(io_service_pool_->Get()));
+  }
+
+  ~GcsInitDataTest() { io_service_pool_->Stop(); }
+
+ protected:
+  template <typename TABLE, typename KEY, typename VALUE>
+  void Put(TABLE &table, const KEY &key, const VALUE &value) {
+    std::promise<void> promise;
+    RAY_CHECK_OK(
+        table.Put(key, value, [&promise](const Status &status) { promise.set_value(); }));
+    promise.get_future().get();
+  }
+
+  void Load(GcsInitData &gcs_init_data) {
+    std::promise<void> promise;
+    gcs_init_data.AsyncLoad([&promise]() { promise.set_value(); });
+    promise.get_future().get();
+  }
+
+  std::shared_ptr<IOServicePool> io_service_pool_;
+  std::shared_ptr<GcsTableStorage> gcs_table_storage_;
+};
+
+TEST_F(GcsInitDataTest, TestLoadAllTables) {
+  auto job_id = JobID::FromInt(1);
+  Put(gcs_table_storage_->JobTable(), job_id, *Mocker::GenJobTableData(job_id));
+  auto node = Mocker::GenNodeInfo();
+  auto node_id = NodeID::FromBinary(node->node_id());
+  Put(gcs_table_storage_->NodeTable(), node_id, *node);
+  Put(gcs_table_storage_->NodeResourceTable(), node_id, rpc::ResourceMap());
+  auto actor = Mocker::GenActorTableData(job_id);
+  auto actor_id = ActorID::FromBinary(actor->actor_id());
+  Put(gcs_table_storage_->ActorTable(), actor_id, *actor);
+
+  GcsInitData gcs_init_data(gcs_table_storage_);
+  Load(gcs_init_data);
+  ASSERT_EQ(gcs_init_data.Jobs().size(), 1);
+  ASSERT_EQ(gcs_init_data.Nodes().size(), 1);
+  ASSERT_EQ(gcs_init_data.ClusterResources().size(), 1);
+  ASSERT_EQ(gcs_init_data.PlacementGroups().size(), 0);
+  ASSERT_EQ(gcs_init_data.Actors().size(), 1);
+  ASSERT_TRUE(gcs_init_data.Actors().contains(actor_id));
+}
+
+TEST_F(GcsInitDataTest, TestLoadNodesBeforeOtherTables) {
+  auto job_id = JobID::FromInt(1);
+  Put(gcs_table_storage_->JobTable(), job_id, *Mocker::GenJobTableData(job_id));
+  auto node = Mocker::GenNodeInfo();
+  Put(gcs_table_storage_->NodeTable(), NodeID::FromBinary(node->node_id()), *node);
+
+  GcsInitData gcs_init_data(gcs_table_storage_);
+  std::promise<void> nodes_loaded;
+  gcs_init_data.AsyncLoadNodes([&nodes_loaded]() { nodes_loaded.set_value(); });
+  nodes_loaded.get_future().get();
+  ASSERT_EQ(gcs_init_data.Nodes().size(), 1);
+  ASSERT_EQ(gcs_init_data.Jobs().size(), 0);
+
+  std::promise<void> others_loaded;
+  gcs_init_data.AsyncLoadOtherTables([&others_loaded]() { others_loaded.set_value(); });
+  others_loaded.get_future().get();
+  ASSERT_EQ(gcs_init_data.Nodes().size(), 1);
+  ASSERT_EQ(gcs_init_data.Jobs().size(), 1);
+}
+
+TEST_F(GcsInitDataTest, TestOnlyRecentDeadActorsAreLoaded) {
+  auto &max_dead_actors =
+      RayConfig::instance().maximum_gcs_destroyed_actor_cached_count();
+  auto original_max_dead_actors = max_dead_actors;
+  max_dead_actors = 3;
+
+  auto job_id = JobID::FromInt(1);
+  std::vector<ActorID> alive_actor_ids;
+  for (int i = 0; i < 5; ++i) {
+    auto actor = Mocker::GenActorTableData(job_id);
+    alive_actor_ids.push_back(ActorID::FromBinary(actor->actor_id()));
+    Put(gcs_table_storage_->ActorTable(), alive_actor_ids.back(), *actor);
+  }
+  // Actors that died at times 0 to 9.
+  std::vector<ActorID> dead_actor_ids;
+  for (int i = 0; i < 10; ++i) {
+    auto actor = Mocker::GenActorTableData(job_id);
+    actor->set_state(rpc::ActorTableData::DEAD);
+    actor->set_timestamp(i);
+    dead_actor_ids.push_back(ActorID::FromBinary(actor->actor_id()));
+    Put(gcs_table_storage_->ActorTable(), dead_actor_ids.back(), *actor);
+  }
+
+  GcsInitData gcs_init_data(gcs_table_storage_);
+  Load(gcs_init_data);
+  const auto &actors = gcs_init_data.Actors();
+  ASSERT_EQ(actors.size(), 5 + 3);
+  for (const auto &actor_id : alive_actor_ids) {
+    ASSERT_TRUE(actors.contains(actor_id));
+  }
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(actors.contains(dead_actor_ids[i]), i >= 7);
+  }
+  // The dead actors that weren't loaded are deleted from the storage.
+  for (int i = 0; i < 10; ++i) {
+    std::promise<bool> promise;
+    RAY_CHECK_OK(gcs_table_storage_->ActorTable().Get(
+        dead_actor_ids[i],
+        [&promise](const Status &status,
+                   const boost::optional<rpc::ActorTableData> &result) {
+          promise.set_value(result.has_value());
+        }));
+    ASSERT_EQ(promise.get_future().get(), i >= 7);
+  }
+  max_dead_actors = original_max_dead_actors;
+}
+
+}  // namespace gcs
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
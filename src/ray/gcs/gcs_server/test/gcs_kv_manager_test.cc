@@ -14,10 +14,14 @@
 
 #include "ray/gcs/gcs_server/gcs_kv_manager.h"
 
+#include <filesystem>
 #include <memory>
 
 #include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/test_util.h"
+#include "ray/gcs/store_client/file_store_client.h"
+#include "ray/util/filesystem.h"
 
 class GcsKVManagerTest : public ::testing::TestWithParam<std::string> {
  public:
@@ -28,13 +32,19 @@ class GcsKVManagerTest : public ::testing::TestWithParam<std::string> {
       boost::asio::io_service::work work(io_service);
       io_service.run();
     });
-    ASSERT_TRUE(GetParam() == "redis" || GetParam() == "memory");
+    ASSERT_TRUE(GetParam() == "redis" || GetParam() == "memory" ||
+                GetParam() == "file");
     ray::gcs::RedisClientOptions redis_client_options(
         "127.0.0.1", ray::TEST_REDIS_SERVER_PORTS.front(), "", false);
     if (GetParam() == "redis") {
       kv_instance = std::make_unique<ray::gcs::RedisInternalKV>(redis_client_options);
     } else if (GetParam() == "memory") {
       kv_instance = std::make_unique<ray::gcs::MemoryInternalKV>(io_service);
+    } else if (GetParam() == "file") {
+      dir = ray::JoinPaths(ray::GetUserTempDir(),
+                           "gcs_kv_" + ray::UniqueID::FromRandom().Hex());
+      store_client = std::make_shared<ray::gcs::FileStoreClient>(io_service, dir);
+      kv_instance = std::make_unique<ray::gcs::MemoryInternalKV>(io_service, store_client);
     }
   }
 
@@ -43,12 +53,19 @@ class GcsKVManagerTest : public ::testing::TestWithParam<std::string> {
     thread_io_service->join();
     redis_client.reset();
     kv_instance.reset();
+    if (store_client) {
+      store_client.reset();
+      std::filesystem::remove_all(dir);
+    }
   }
 
   std::unique_ptr<ray::gcs::RedisClient> redis_client;
   std::unique_ptr<std::thread> thread_io_service;
   instrumented_io_context io_service;
   std::unique_ptr<ray::gcs::InternalKVInterface> kv_instance;
+  /// The directory and store client that the kv is persisted to, in file mode.
+  std::string dir;
+  std::shared_ptr<ray::gcs::FileStoreClient> store_client;
 };
 
 TEST_P(GcsKVManagerTest, TestInternalKV) {
@@ -97,8 +114,307 @@ TEST_P(GcsKVManagerTest, TestInternalKV) {
   }
 }
 
+TEST_P(GcsKVManagerTest, TestForwardingInternalKV) {
+  // The callbacks of the forwarding kv are called on its own event loop.
+  instrumented_io_context caller_io_service;
+  std::promise<std::thread::id> caller_thread_id;
+  std::thread caller_thread([&caller_io_service, &caller_thread_id] {
+    boost::asio::io_service::work work(caller_io_service);
+    caller_thread_id.set_value(std::this_thread::get_id());
+    caller_io_service.run();
+  });
+  auto caller_id = caller_thread_id.get_future().get();
+  ray::gcs::ForwardingInternalKV kv(*kv_instance, caller_io_service);
+
+  kv.Put("N1", "A", "B", false, [caller_id](auto b) {
+    ASSERT_EQ(caller_id, std::this_thread::get_id());
+    ASSERT_TRUE(b);
+  });
+  kv.Exists("N1", "A", [caller_id](auto b) {
+    ASSERT_EQ(caller_id, std::this_thread::get_id());
+    ASSERT_TRUE(b);
+  });
+  kv.Keys("N1", "A", [caller_id](std::vector<std::string> keys) {
+    ASSERT_EQ(caller_id, std::this_thread::get_id());
+    ASSERT_EQ(std::vector<std::string>{"A"}, keys);
+  });
+  kv.Get("N1", "A", [caller_id](auto b) {
+    ASSERT_EQ(caller_id, std::this_thread::get_id());
+    ASSERT_EQ("B", *b);
+  });
+  // Operations without a callback are forwarded as well.
+  kv.Put("N1", "A_1", "C", false, nullptr);
+  {
+    std::promise<void> p;
+    kv.Del("N1", "A", true, [&p, caller_id](auto b) {
+      ASSERT_EQ(caller_id, std::this_thread::get_id());
+      ASSERT_EQ(2, b);
+      p.set_value();
+    });
+    p.get_future().get();
+  }
+
+  caller_io_service.stop();
+  caller_thread.join();
+}
+
+TEST_P(GcsKVManagerTest, TestMultiGetAndMultiPut) {
+  {
+    std::promise<void> p;
+    kv_instance->MultiPut("N1", {{"A", "B"}, {"C", "D"}}, false, [&p](int64_t added) {
+      ASSERT_EQ(2, added);
+      p.set_value();
+    });
+    p.get_future().get();
+  }
+  {
+    // Only the key that doesn't exist is added.
+    std::promise<void> p;
+    kv_instance->MultiPut("N1", {{"A", "X"}, {"E", "F"}}, false, [&p](int64_t added) {
+      ASSERT_EQ(1, added);
+      p.set_value();
+    });
+    p.get_future().get();
+  }
+  {
+    std::promise<void> p;
+    kv_instance->MultiGet(
+        "N1", {"A", "C", "E", "G"},
+        [&p](absl::flat_hash_map<std::string, std::string> results) {
+          absl::flat_hash_map<std::string, std::string> expected = {
+              {"A", "B"}, {"C", "D"}, {"E", "F"}};
+          ASSERT_EQ(expected, results);
+          p.set_value();
+        });
+    p.get_future().get();
+  }
+  {
+    std::promise<void> p;
+    kv_instance->MultiGet("N2", {"A"},
+                          [&p](absl::flat_hash_map<std::string, std::string> results) {
+                            ASSERT_TRUE(results.empty());
+                            p.set_value();
+                          });
+    p.get_future().get();
+  }
+}
+
+TEST_P(GcsKVManagerTest, TestWatch) {
+  using Changes = std::vector<ray::gcs::InternalKVChange>;
+  auto watch = [this](const std::string &prefix, int64_t since_version) {
+    std::promise<std::tuple<ray::Status, int64_t, Changes>> p;
+    kv_instance->Watch("N1", prefix, since_version,
+                       [&p](ray::Status status, int64_t version, Changes changes) {
+                         p.set_value({status, version, std::move(changes)});
+                       });
+    return p.get_future().get();
+  };
+
+  if (GetParam() == "redis") {
+    ASSERT_TRUE(std::get<0>(watch("A", -1)).IsNotImplemented());
+    return;
+  }
+
+  auto [status, version, changes] = watch("A", -1);
+  ASSERT_TRUE(status.ok());
+  ASSERT_TRUE(changes.empty());
+
+  // The changes made before the watch are returned right away.
+  kv_instance->Put("N1", "A_1", "B", false, nullptr);
+  kv_instance->Put("N1", "X", "B", false, nullptr);
+  kv_instance->Put("N2", "A_2", "B", false, nullptr);
+  std::tie(status, version, changes) = watch("A", version);
+  ASSERT_TRUE(status.ok());
+  ASSERT_EQ(1, changes.size());
+  ASSERT_EQ("A_1", changes[0].key);
+  ASSERT_EQ("B", *changes[0].value);
+  ASSERT_EQ(version - 2, changes[0].version);
+
+  // A watch waits for the next change under its prefix.
+  std::promise<Changes> next_changes;
+  kv_instance->Watch("N1", "A", version,
+                     [&next_changes](ray::Status status, int64_t, Changes changes) {
+                       ASSERT_TRUE(status.ok());
+                       next_changes.set_value(std::move(changes));
+                     });
+  kv_instance->Put("N1", "X", "C", true, nullptr);
+  kv_instance->Del("N1", "A_1", false, nullptr);
+  changes = next_changes.get_future().get();
+  ASSERT_EQ(1, changes.size());
+  ASSERT_EQ("A_1", changes[0].key);
+  ASSERT_FALSE(changes[0].value.has_value());
+
+  // A version that is newer than the kv isn't valid.
+  ASSERT_TRUE(std::get<0>(watch("A", version + 100)).IsInvalid());
+}
+
+TEST_P(GcsKVManagerTest, TestRecoverFromFile) {
+  if (GetParam() != "file") {
+    return;
+  }
+  kv_instance->MultiPut("N1", {{"A_1", "B"}, {"A_2", "C"}, {"B", "D"}}, false, nullptr);
+  kv_instance->Put("N1", "A_1", "E", true, nullptr);
+  kv_instance->Del("N1", "A_2", false, nullptr);
+  {
+    // The callback is called once the change is persisted.
+    std::promise<void> p;
+    kv_instance->Put("N2", "A_1", "F", false, [&p](auto) { p.set_value(); });
+    p.get_future().get();
+  }
+
+  // Recover the kv from the directory, as GCS does when it restarts.
+  kv_instance.reset();
+  store_client.reset();
+  store_client = std::make_shared<ray::gcs::FileStoreClient>(io_service, dir);
+  std::promise<absl::flat_hash_map<std::string, std::string>> persisted;
+  RAY_CHECK_OK(store_client->AsyncGetAll(
+      ray::gcs::MemoryInternalKV::kStoreTableName,
+      [&persisted](auto &&result) { persisted.set_value(std::move(result)); }));
+  kv_instance = std::make_unique<ray::gcs::MemoryInternalKV>(
+      io_service, store_client, persisted.get_future().get());
+
+  std::promise<absl::flat_hash_map<std::string, std::string>> n1;
+  kv_instance->MultiGet("N1", {"A_1", "A_2", "B"},
+                        [&n1](auto result) { n1.set_value(std::move(result)); });
+  absl::flat_hash_map<std::string, std::string> expected{{"A_1", "E"}, {"B", "D"}};
+  ASSERT_EQ(expected, n1.get_future().get());
+  std::promise<std::optional<std::string>> n2;
+  kv_instance->Get("N2", "A_1", [&n2](auto value) { n2.set_value(value); });
+  ASSERT_EQ("F", *n2.get_future().get());
+}
+
+TEST_P(GcsKVManagerTest, TestWatchHistoryAndTimeout) {
+  if (GetParam() == "redis") {
+    return;
+  }
+  auto &history_size = RayConfig::instance().gcs_kv_watch_history_size();
+  auto &timeout_ms = RayConfig::instance().gcs_kv_watch_timeout_ms();
+  auto original_history_size = history_size;
+  auto original_timeout_ms = timeout_ms;
+  history_size = 2;
+  timeout_ms = 10;
+  ray::gcs::MemoryInternalKV kv(io_service);
+
+  for (int i = 0; i < 3; ++i) {
+    kv.Put("N1", "A_" + std::to_string(i), "B", false, nullptr);
+  }
+  {
+    // The first change is no longer kept.
+    std::promise<ray::Status> p;
+    kv.Watch("N1", "A", 0, [&p](ray::Status status, int64_t, auto) {
+      p.set_value(status);
+    });
+    ASSERT_TRUE(p.get_future().get().IsInvalid());
+  }
+  {
+    std::promise<size_t> p;
+    kv.Watch("N1", "A", 1,
+             [&p](ray::Status status, int64_t, auto changes) {
+               p.set_value(changes.size());
+             });
+    ASSERT_EQ(2, p.get_future().get());
+  }
+  {
+    // Without changes, the watch returns once it times out.
+    std::promise<size_t> p;
+    kv.Watch("N1", "A", 3, [&p](ray::Status status, int64_t version, auto changes) {
+      ASSERT_TRUE(status.ok());
+      ASSERT_EQ(3, version);
+      p.set_value(changes.size());
+    });
+    ASSERT_EQ(0, p.get_future().get());
+  }
+  {
+    // A key that changed twice is returned once, with its current value.
+    kv.Put("N1", "A_0", "C", true, nullptr);
+    kv.Put("N1", "A_0", "D", true, nullptr);
+    std::promise<std::vector<ray::gcs::InternalKVChange>> p;
+    kv.Watch("N1", "A", 3, [&p](ray::Status status, int64_t version, auto changes) {
+      ASSERT_TRUE(status.ok());
+      ASSERT_EQ(5, version);
+      p.set_value(std::move(changes));
+    });
+    auto changes = p.get_future().get();
+    ASSERT_EQ(1, changes.size());
+    ASSERT_EQ("A_0", changes[0].key);
+    ASSERT_EQ("D", *changes[0].value);
+    ASSERT_EQ(5, changes[0].version);
+  }
+  history_size = original_history_size;
+  timeout_ms = original_timeout_ms;
+}
+
+TEST_P(GcsKVManagerTest, BenchmarkPrefixAndBatchOperations) {
+  const int num_prefixes = 100;
+  const int num_keys_per_prefix = GetParam() == "redis" ? 20 : 1000;
+  const std::string value(100, 'x');
+  auto elapsed_us = [](std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - since)
+        .count();
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_prefixes; ++i) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (int j = 0; j < num_keys_per_prefix; ++j) {
+      entries.emplace_back(absl::StrCat("prefix_", i, ":key_", j), value);
+    }
+    std::promise<void> p;
+    kv_instance->MultiPut("bench", entries, true, [&p](int64_t) { p.set_value(); });
+    p.get_future().get();
+  }
+  auto put_us = elapsed_us(start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_prefixes; ++i) {
+    std::promise<void> p;
+    kv_instance->Keys("bench", absl::StrCat("prefix_", i, ":"),
+                      [&p, num_keys_per_prefix](std::vector<std::string> keys) {
+                        ASSERT_EQ(num_keys_per_prefix, keys.size());
+                        p.set_value();
+                      });
+    p.get_future().get();
+  }
+  auto keys_us = elapsed_us(start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_prefixes; ++i) {
+    std::vector<std::string> keys;
+    for (int j = 0; j < num_keys_per_prefix; ++j) {
+      keys.push_back(absl::StrCat("prefix_", i, ":key_", j));
+    }
+    std::promise<void> p;
+    kv_instance->MultiGet(
+        "bench", keys,
+        [&p, num_keys_per_prefix](absl::flat_hash_map<std::string, std::string> results) {
+          ASSERT_EQ(num_keys_per_prefix, results.size());
+          p.set_value();
+        });
+    p.get_future().get();
+  }
+  auto multi_get_us = elapsed_us(start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_prefixes; ++i) {
+    std::promise<void> p;
+    kv_instance->Del("bench", absl::StrCat("prefix_", i, ":"), true,
+                     [&p, num_keys_per_prefix](int64_t num_deleted) {
+                       ASSERT_EQ(num_keys_per_prefix, num_deleted);
+                       p.set_value();
+                     });
+    p.get_future().get();
+  }
+  auto del_us = elapsed_us(start);
+
+  RAY_LOG(INFO) << GetParam() << ": " << num_prefixes * num_keys_per_prefix
+                << " keys under " << num_prefixes << " prefixes. MultiPut " << put_us
+                << " us, Keys by prefix " << keys_us << " us, MultiGet " << multi_get_us
+                << " us, Del by prefix " << del_us << " us.";
+}
+
 INSTANTIATE_TEST_SUITE_P(GcsKVManagerTestFixture, GcsKVManagerTest,
-                         ::testing::Values("redis", "memory"));
+                         ::testing::Values("redis", "memory", "file"));
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
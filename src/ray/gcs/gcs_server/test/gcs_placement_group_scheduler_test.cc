@@ -991,6 +991,98 @@ TEST_F(GcsPlacementGroupSchedulerTest, TestNodeDeadDuringRescheduling) {
   WaitPlacementGroupPendingDone(1, GcsPlacementGroupStatus::FAILURE);
 }
 
+TEST_F(GcsPlacementGroupSchedulerTest, TestRescheduleUnpreparedBundles) {
+  auto &retry_rounds = RayConfig::instance().gcs_placement_group_prepare_retry_rounds();
+  const auto old_retry_rounds = retry_rounds;
+  retry_rounds = 1;
+  auto node0 = Mocker::GenNodeInfo(0);
+  auto node1 = Mocker::GenNodeInfo(1);
+  AddNode(node0);
+  AddNode(node1);
+
+  auto create_placement_group_request = Mocker::GenCreatePlacementGroupRequest();
+  auto placement_group =
+      std::make_shared<gcs::GcsPlacementGroup>(create_placement_group_request, "");
+  auto failure_handler = [this](std::shared_ptr<gcs::GcsPlacementGroup> placement_group,
+                                bool is_insfeasble) {
+    absl::MutexLock lock(&placement_group_requests_mutex_);
+    failure_placement_groups_.emplace_back(std::move(placement_group));
+  };
+  auto success_handler = [this](std::shared_ptr<gcs::GcsPlacementGroup> placement_group) {
+    absl::MutexLock lock(&placement_group_requests_mutex_);
+    success_placement_groups_.emplace_back(std::move(placement_group));
+  };
+
+  scheduler_->ScheduleUnplacedBundles(placement_group, failure_handler, success_handler);
+  ASSERT_TRUE(raylet_clients_[0]->GrantPrepareBundleResources());
+  const auto node1_id = NodeID::FromBinary(node1->node_id());
+  gcs_node_manager_->RemoveNode(node1_id);
+  gcs_resource_manager_->OnNodeDead(node1_id);
+  ASSERT_TRUE(raylet_clients_[1]->GrantPrepareBundleResources(false));
+
+  // Only the bundle that failed to prepare is prepared again, on the node left, and the
+  // prepared bundle isn't cancelled. It's prepared again after a backoff.
+  ASSERT_EQ(1, raylet_clients_[0]->num_lease_requested);
+  WaitPendingDone(raylet_clients_[0]->lease_callbacks, 1);
+  ASSERT_EQ(2, raylet_clients_[0]->num_lease_requested);
+  ASSERT_EQ(0, raylet_clients_[0]->num_return_requested);
+  CheckPlacementGroupSize(0, GcsPlacementGroupStatus::FAILURE);
+  ASSERT_TRUE(raylet_clients_[0]->GrantPrepareBundleResources());
+  WaitPendingDone(raylet_clients_[0]->commit_callbacks, 1);
+  ASSERT_TRUE(raylet_clients_[0]->GrantCommitBundleResources());
+  WaitPlacementGroupPendingDone(1, GcsPlacementGroupStatus::SUCCESS);
+  ASSERT_EQ(2, scheduler_->GetBundlesOnNode(NodeID::FromBinary(node0->node_id()))
+                   .at(placement_group->GetPlacementGroupID())
+                   .size());
+  retry_rounds = old_retry_rounds;
+}
+
+TEST_F(GcsPlacementGroupSchedulerTest, TestRescheduleUnpreparedBundlesExhausted) {
+  auto &retry_rounds = RayConfig::instance().gcs_placement_group_prepare_retry_rounds();
+  const auto old_retry_rounds = retry_rounds;
+  retry_rounds = 1;
+  AddNode(Mocker::GenNodeInfo(0));
+  AddNode(Mocker::GenNodeInfo(1));
+
+  auto create_placement_group_request = Mocker::GenCreatePlacementGroupRequest();
+  auto placement_group =
+      std::make_shared<gcs::GcsPlacementGroup>(create_placement_group_request, "");
+  auto failure_handler = [this](std::shared_ptr<gcs::GcsPlacementGroup> placement_group,
+                                bool is_insfeasble) {
+    absl::MutexLock lock(&placement_group_requests_mutex_);
+    failure_placement_groups_.emplace_back(std::move(placement_group));
+  };
+  auto success_handler = [this](std::shared_ptr<gcs::GcsPlacementGroup> placement_group) {
+    absl::MutexLock lock(&placement_group_requests_mutex_);
+    success_placement_groups_.emplace_back(std::move(placement_group));
+  };
+
+  scheduler_->ScheduleUnplacedBundles(placement_group, failure_handler, success_handler);
+  ASSERT_TRUE(raylet_clients_[0]->GrantPrepareBundleResources());
+  ASSERT_TRUE(raylet_clients_[1]->GrantPrepareBundleResources(false));
+  // The bundle is prepared again, and fails again wherever it was rescheduled to.
+  EXPECT_TRUE(WaitForCondition(
+      [this] {
+        return raylet_clients_[0]->lease_callbacks.size() +
+                   raylet_clients_[1]->lease_callbacks.size() ==
+               1;
+      },
+      timeout_ms_.count()));
+  ASSERT_EQ(3, raylet_clients_[0]->num_lease_requested +
+                   raylet_clients_[1]->num_lease_requested);
+  auto &retried_client = raylet_clients_[0]->lease_callbacks.empty() ? raylet_clients_[1]
+                                                                     : raylet_clients_[0];
+  ASSERT_TRUE(retried_client->GrantPrepareBundleResources(false));
+
+  // Once the retries are exhausted, the whole placement group is rescheduled and the
+  // prepared bundle is cancelled.
+  WaitPlacementGroupPendingDone(1, GcsPlacementGroupStatus::FAILURE);
+  ASSERT_EQ(1, raylet_clients_[0]->num_return_requested);
+  ASSERT_EQ(0, raylet_clients_[0]->commit_callbacks.size());
+  ASSERT_EQ(0, raylet_clients_[1]->commit_callbacks.size());
+  retry_rounds = old_retry_rounds;
+}
+
 TEST_F(GcsPlacementGroupSchedulerTest, TestPGCancelledDuringReschedulingCommit) {
   auto node0 = Mocker::GenNodeInfo(0);
   auto node1 = Mocker::GenNodeInfo(1);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
 
 #include "gtest/gtest.h"
@@ -32,11 +33,12 @@ class GcsResourceReportPollerTest : public ::testing::Test {
             [this]() { return current_time_; },
             [this](const rpc::Address &address,
                    std::shared_ptr<rpc::NodeManagerClientPool> &client_pool,
+                   const rpc::RequestResourceReportRequest &request,
                    std::function<void(const Status &,
                                       const rpc::RequestResourceReportReply &)>
                        callback) {
               if (request_report_) {
-                request_report_(address, client_pool, callback);
+                request_report_(address, client_pool, request, callback);
               }
             }
 
@@ -49,14 +51,25 @@ class GcsResourceReportPollerTest : public ::testing::Test {
     RAY_LOG(ERROR) << "Done";
   }
 
+  void RunPollingService(GcsResourceReportPoller &poller) {
+    poller.polling_service_.run();
+    poller.polling_service_.restart();
+  }
+
   void Tick(int64_t inc) {
     current_time_ += inc;
     gcs_resource_report_poller_.TryPullResourceReport();
   }
 
+  void Tick(GcsResourceReportPoller &poller, int64_t inc) {
+    current_time_ += inc;
+    poller.TryPullResourceReport();
+  }
+
   int64_t current_time_;
   std::function<void(
       const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+      const rpc::RequestResourceReportRequest &,
       std::function<void(const Status &, const rpc::RequestResourceReportReply &)>)>
       request_report_;
 
@@ -69,6 +82,7 @@ TEST_F(GcsResourceReportPollerTest, TestBasic) {
   request_report_ =
       [&rpc_sent](
           const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &,
           std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
               callback) {
         rpc_sent = true;
@@ -100,6 +114,7 @@ TEST_F(GcsResourceReportPollerTest, TestFailedRpc) {
   request_report_ =
       [&rpc_sent](
           const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &,
           std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
               callback) {
         RAY_LOG(ERROR) << "Requesting";
@@ -140,6 +155,7 @@ TEST_F(GcsResourceReportPollerTest, TestMaxInFlight) {
   int num_rpcs_sent = 0;
   request_report_ =
       [&](const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &,
           std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
               callback) {
         num_rpcs_sent++;
@@ -175,6 +191,7 @@ TEST_F(GcsResourceReportPollerTest, TestNodeRemoval) {
   int num_rpcs_sent = 0;
   request_report_ =
       [&](const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &,
           std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
               callback) {
         num_rpcs_sent++;
@@ -221,6 +238,7 @@ TEST_F(GcsResourceReportPollerTest, TestPrioritizeNewNodes) {
   int num_rpcs_sent = 0;
   request_report_ =
       [&](const rpc::Address &address, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &,
           std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
               callback) {
         num_rpcs_sent++;
@@ -266,5 +284,131 @@ TEST_F(GcsResourceReportPollerTest, TestPrioritizeNewNodes) {
   ASSERT_EQ(nodes_requested.size(), 200);
 }
 
+TEST_F(GcsResourceReportPollerTest, TestKnownVersion) {
+  std::vector<int64_t> known_versions;
+  Status reply_status = Status::OK();
+  int64_t next_version = 1;
+  request_report_ =
+      [&](const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &request,
+          std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
+              callback) {
+        known_versions.push_back(request.known_version());
+        rpc::RequestResourceReportReply reply;
+        reply.set_version(next_version++);
+        callback(reply_status, reply);
+      };
+
+  auto node_info = Mocker::GenNodeInfo();
+  gcs_resource_report_poller_.HandleNodeAdded(*node_info);
+  RunPollingService();
+  // The first pull asks for a full report, the next ones for the changes since the
+  // last report.
+  Tick(100);
+  RunPollingService();
+  ASSERT_EQ(known_versions, (std::vector<int64_t>{0, 1}));
+
+  // A failed pull is followed by a full report.
+  reply_status = Status::TimedOut("error");
+  Tick(100);
+  RunPollingService();
+  reply_status = Status::OK();
+  Tick(100);
+  RunPollingService();
+  ASSERT_EQ(known_versions, (std::vector<int64_t>{0, 1, 2, 0}));
+
+  // Full reports are pulled periodically.
+  known_versions.clear();
+  const auto interval = RayConfig::instance().gcs_resource_report_full_pull_interval();
+  for (uint64_t i = 0; i <= interval; i++) {
+    Tick(100);
+    RunPollingService();
+  }
+  ASSERT_EQ(known_versions.size(), interval + 1);
+  ASSERT_EQ(std::count(known_versions.begin(), known_versions.end(), 0), 1);
+}
+
+TEST_F(GcsResourceReportPollerTest, TestRegions) {
+  auto &region_size = RayConfig::instance().resource_dissemination_region_size();
+  const auto prev_region_size = region_size;
+  region_size = 3;
+  struct Pull {
+    NodeID node_id;
+    rpc::RequestResourceReportRequest request;
+    std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
+        callback;
+  };
+  std::vector<Pull> pulls;
+  std::vector<std::string> reported_node_ids;
+  GcsResourceReportPoller poller(
+      nullptr,
+      [&](const rpc::ResourcesData &data) { reported_node_ids.push_back(data.node_id()); },
+      [this]() { return current_time_; },
+      [&](const rpc::Address &address, std::shared_ptr<rpc::NodeManagerClientPool> &,
+          const rpc::RequestResourceReportRequest &request,
+          std::function<void(const Status &, const rpc::RequestResourceReportReply &)>
+              callback) {
+        pulls.push_back({NodeID::FromBinary(address.raylet_id()), request, callback});
+      });
+  region_size = prev_region_size;
+
+  std::vector<std::shared_ptr<rpc::GcsNodeInfo>> nodes;
+  for (int i = 0; i < 5; i++) {
+    nodes.emplace_back(Mocker::GenNodeInfo());
+    poller.HandleNodeAdded(*nodes.back());
+  }
+  auto node_id = [&nodes](int i) { return NodeID::FromBinary(nodes[i]->node_id()); };
+
+  // Only the aggregators of the regions are pulled from, along with the rest of their
+  // region.
+  RunPollingService(poller);
+  ASSERT_EQ(pulls.size(), 2);
+  std::sort(pulls.begin(), pulls.end(), [&](const Pull &a, const Pull &b) {
+    return a.request.region_members_size() > b.request.region_members_size();
+  });
+  ASSERT_EQ(pulls[0].node_id, node_id(0));
+  ASSERT_EQ(pulls[0].request.region_members_size(), 2);
+  ASSERT_EQ(pulls[0].request.region_members(0).address().raylet_id(), node_id(1).Binary());
+  ASSERT_EQ(pulls[0].request.region_members(1).address().raylet_id(), node_id(2).Binary());
+  ASSERT_EQ(pulls[1].node_id, node_id(3));
+  ASSERT_EQ(pulls[1].request.region_members_size(), 1);
+
+  // The reports of the whole region are applied, and the next pull is relative to
+  // their versions. The report of a member the aggregator couldn't pull is requested in
+  // full next time.
+  rpc::RequestResourceReportReply reply;
+  reply.set_version(1);
+  reply.mutable_resources()->set_node_id(node_id(0).Binary());
+  auto member_report = reply.add_region_reports();
+  member_report->set_version(5);
+  member_report->mutable_resources()->set_node_id(node_id(1).Binary());
+  reply.add_region_reports();
+  pulls[0].callback(Status::OK(), reply);
+  ASSERT_EQ(reported_node_ids,
+            (std::vector<std::string>{node_id(0).Binary(), node_id(1).Binary()}));
+  pulls.clear();
+  RunPollingService(poller);
+  Tick(poller, 100);
+  RunPollingService(poller);
+  ASSERT_EQ(pulls.size(), 1);
+  ASSERT_EQ(pulls[0].request.known_version(), 1);
+  ASSERT_EQ(pulls[0].request.region_members(0).known_version(), 5);
+  ASSERT_EQ(pulls[0].request.region_members(1).known_version(), 0);
+  reply.mutable_region_reports(1)->set_version(7);
+  pulls[0].callback(Status::OK(), reply);
+  RunPollingService(poller);
+
+  // The next member of the region takes over once the aggregator leaves.
+  pulls.clear();
+  poller.HandleNodeRemoved(*nodes[0]);
+  RunPollingService(poller);
+  ASSERT_EQ(pulls.size(), 1);
+  ASSERT_EQ(pulls[0].node_id, node_id(1));
+  ASSERT_EQ(pulls[0].request.known_version(), 5);
+  ASSERT_EQ(pulls[0].request.region_members_size(), 1);
+  ASSERT_EQ(pulls[0].request.region_members(0).address().raylet_id(), node_id(2).Binary());
+  ASSERT_EQ(pulls[0].request.region_members(0).known_version(), 7);
+}
+
 }  // namespace gcs
 }  // namespace ray
@@ -406,6 +406,141 @@ TEST_F(GcsServerTest, TestWorkerInfo) {
 }
 // TODO(sang): Add tests after adding asyncAdd
 
+/// Runs the GCS server with and without the dedicated KV thread.
+class GcsServerLoadTest : public GcsServerTest,
+                          public ::testing::WithParamInterface<bool> {
+ public:
+  void SetUp() override {
+    auto &dedicated_thread = RayConfig::instance().gcs_server_kv_dedicated_thread();
+    original_dedicated_thread_ = dedicated_thread;
+    dedicated_thread = GetParam();
+    GcsServerTest::SetUp();
+
+    // The load is sent by a client on a thread of its own, so that handling the replies
+    // doesn't compete with the server for its main thread.
+    load_client_thread_ = std::make_unique<std::thread>([this] {
+      boost::asio::io_service::work work(load_client_io_service_);
+      load_client_io_service_.run();
+    });
+    load_client_call_manager_ =
+        std::make_unique<rpc::ClientCallManager>(load_client_io_service_);
+    load_client_ = std::make_unique<rpc::GcsRpcClient>(
+        "0.0.0.0", gcs_server_->GetPort(), *load_client_call_manager_);
+  }
+
+  void TearDown() override {
+    load_client_io_service_.stop();
+    load_client_thread_->join();
+    GcsServerTest::TearDown();
+    RayConfig::instance().gcs_server_kv_dedicated_thread() = original_dedicated_thread_;
+  }
+
+ protected:
+  bool original_dedicated_thread_;
+  instrumented_io_context load_client_io_service_;
+  std::unique_ptr<std::thread> load_client_thread_;
+  std::unique_ptr<rpc::ClientCallManager> load_client_call_manager_;
+  std::unique_ptr<rpc::GcsRpcClient> load_client_;
+};
+
+TEST_P(GcsServerLoadTest, BenchmarkMixedKVActorAndHeartbeatLoad) {
+  const int num_kv_puts = 20000;
+  const int num_actors = 500;
+  const int num_heartbeats = 2000;
+
+  auto job_id = JobID::FromInt(1);
+  rpc::AddJobRequest add_job_request;
+  add_job_request.mutable_data()->CopyFrom(*Mocker::GenJobTableData(job_id));
+  ASSERT_TRUE(AddJob(add_job_request));
+  auto node_info = Mocker::GenNodeInfo();
+  rpc::RegisterNodeRequest register_node_request;
+  register_node_request.mutable_node_info()->CopyFrom(*node_info);
+  ASSERT_TRUE(RegisterNode(register_node_request));
+
+  // All the callbacks are called on the thread of the load client.
+  std::atomic<int> pending(num_kv_puts + num_actors + num_heartbeats);
+  std::atomic<int> failed(0);
+  std::promise<void> done;
+  auto on_reply = [&pending, &failed, &done](const Status &status) {
+    if (!status.ok()) {
+      ++failed;
+    }
+    if (--pending == 0) {
+      done.set_value();
+    }
+  };
+  std::vector<int64_t> actor_latencies_us;
+  std::vector<int64_t> heartbeat_latencies_us;
+
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed_us = [](std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - since)
+        .count();
+  };
+  const std::string value(1024, 'x');
+  for (int i = 0; i < num_kv_puts; ++i) {
+    rpc::InternalKVPutRequest put_request;
+    put_request.set_namespace_("load_test");
+    put_request.set_key("key_" + std::to_string(i));
+    put_request.set_value(value);
+    put_request.set_overwrite(true);
+    load_client_->InternalKVPut(
+        put_request, [&on_reply](const Status &status, const rpc::InternalKVPutReply &) {
+          on_reply(status);
+        });
+
+    if (i % (num_kv_puts / num_actors) == 0) {
+      auto register_actor_request = Mocker::GenRegisterActorRequest(
+          job_id, /*max_restarts=*/0, /*detached=*/true, /*name=*/"",
+          /*ray_namespace=*/"load_test");
+      auto sent = std::chrono::steady_clock::now();
+      load_client_->RegisterActor(
+          register_actor_request,
+          [&on_reply, &actor_latencies_us, elapsed_us, sent](
+              const Status &status, const rpc::RegisterActorReply &) {
+            actor_latencies_us.push_back(elapsed_us(sent));
+            on_reply(status);
+          });
+    }
+
+    if (i % (num_kv_puts / num_heartbeats) == 0) {
+      rpc::ReportHeartbeatRequest heartbeat_request;
+      heartbeat_request.mutable_heartbeat()->set_node_id(node_info->node_id());
+      auto sent = std::chrono::steady_clock::now();
+      load_client_->ReportHeartbeat(
+          heartbeat_request,
+          [&on_reply, &heartbeat_latencies_us, elapsed_us, sent](
+              const Status &status, const rpc::ReportHeartbeatReply &) {
+            heartbeat_latencies_us.push_back(elapsed_us(sent));
+            on_reply(status);
+          });
+    }
+  }
+  ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(120)),
+            std::future_status::ready);
+  auto total_ms = elapsed_us(start) / 1000;
+  ASSERT_EQ(failed, 0);
+
+  auto percentile_us = [](std::vector<int64_t> latencies, double percentile) {
+    std::sort(latencies.begin(), latencies.end());
+    return latencies[static_cast<size_t>(percentile * (latencies.size() - 1))];
+  };
+  RAY_LOG(INFO) << "KV on a dedicated thread: " << (GetParam() ? "yes" : "no") << ", "
+                << num_kv_puts << " KV puts, " << num_actors
+                << " actor registrations and " << num_heartbeats << " heartbeats in "
+                << total_ms << " ms. Actor registration latency p50 "
+                << percentile_us(actor_latencies_us, 0.5) << " us, p99 "
+                << percentile_us(actor_latencies_us, 0.99)
+                << " us. Heartbeat latency p50 "
+                << percentile_us(heartbeat_latencies_us, 0.5) << " us, p99 "
+                << percentile_us(heartbeat_latencies_us, 0.99) << " us.";
+}
+
+INSTANTIATE_TEST_SUITE_P(GcsServerLoadTestFixture, GcsServerLoadTest,
+                         ::testing::Values(false, true));
+
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
@@ -84,6 +84,19 @@ struct GcsServerMocker {
       callbacks.push_back(callback);
     }
 
+    /// WorkerLeaseInterface
+    void RequestWorkerLeases(
+        const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+        std::vector<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>> lease_callbacks)
+        override {
+      num_batch_lease_requests += 1;
+      // Every lease is replied to on its own by `GrantWorkerLease`.
+      for (auto &callback : lease_callbacks) {
+        num_workers_requested += 1;
+        callbacks.push_back(std::move(callback));
+      }
+    }
+
     /// WorkerLeaseInterface
     void ReleaseUnusedWorkers(
         const std::vector<WorkerID> &workers_in_use,
@@ -261,6 +274,7 @@ struct GcsServerMocker {
 
     /// ResourceUsageInterface
     void RequestResourceReport(
+        const rpc::RequestResourceReportRequest &request,
         const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback) override {
       RAY_CHECK(false) << "Unused";
     };
@@ -280,6 +294,7 @@ struct GcsServerMocker {
     ~MockRayletClient() {}
 
     int num_workers_requested = 0;
+    int num_batch_lease_requests = 0;
     int num_workers_returned = 0;
     int num_workers_disconnected = 0;
     int num_leases_canceled = 0;
@@ -15,8 +15,11 @@
 
 #include "ray/gcs/gcs_server/grpc_based_resource_broadcaster.h"
 
+#include <algorithm>
 #include <memory>
+#include <random>
 
+#include "absl/container/flat_hash_set.h"
 #include "gtest/gtest.h"
 #include "ray/gcs/test/gcs_test_util.h"
 
@@ -37,24 +40,40 @@ class GrpcBasedResourceBroadcasterTest : public ::testing::Test {
                    const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback) {
               num_batches_sent_++;
               callbacks_.push_back(callback);
+              rpc::ResourceUsageBroadcastData batch;
+              batch.ParseFromString(data);
+              batches_.push_back(std::move(batch));
             }) {}
 
-  void SendBroadcast() {
+  void SendBroadcast(NodeID node_id = NodeID::FromRandom()) {
     rpc::ResourceUsageBroadcastData batch;
     rpc::ResourceUpdate update;
-    NodeID node_id = NodeID::FromRandom();
     update.mutable_data()->set_node_id(node_id.Binary());
     batch.add_batch()->Swap(&update);
     broadcaster_.SendBroadcast(std::move(batch));
   }
 
+  /// Reply to the oldest outstanding broadcast, acknowledging the given version.
+  void Reply(const Status &status, int64_t version) {
+    rpc::UpdateResourceUsageReply reply;
+    reply.set_resource_view_version(version);
+    callbacks_.front()(status, reply);
+    callbacks_.pop_front();
+  }
+
   void AssertNoLeaks() {
     absl::MutexLock guard(&broadcaster_.mutex_);
     ASSERT_EQ(broadcaster_.nodes_.size(), 0);
   }
 
+  static int64_t GetViewVersion(GrpcBasedResourceBroadcaster &broadcaster) {
+    absl::MutexLock guard(&broadcaster.mutex_);
+    return broadcaster.view_.GetVersion();
+  }
+
   int num_batches_sent_;
   std::deque<rpc::ClientCallback<rpc::UpdateResourceUsageReply>> callbacks_;
+  std::deque<rpc::ResourceUsageBroadcastData> batches_;
 
   GrpcBasedResourceBroadcaster broadcaster_;
 };
@@ -86,5 +105,332 @@ TEST_F(GrpcBasedResourceBroadcasterTest, TestNodeRemoval) {
   AssertNoLeaks();
 }
 
+TEST_F(GrpcBasedResourceBroadcasterTest, TestDeltas) {
+  auto node_info = Mocker::GenNodeInfo();
+  broadcaster_.HandleNodeAdded(*node_info);
+  auto node_1 = NodeID::FromRandom();
+  auto node_2 = NodeID::FromRandom();
+  SendBroadcast(node_1);
+  SendBroadcast(node_2);
+  // A new node is sent a snapshot first, and then the changes since.
+  ASSERT_EQ(batches_.size(), 2);
+  ASSERT_TRUE(batches_[0].is_snapshot());
+  ASSERT_EQ(batches_[0].batch_size(), 1);
+  ASSERT_FALSE(batches_[1].is_snapshot());
+  ASSERT_EQ(batches_[1].base_version(), batches_[0].version());
+  ASSERT_EQ(batches_[1].batch_size(), 1);
+  ASSERT_EQ(batches_[1].batch(0).data().node_id(), node_2.Binary());
+  ASSERT_EQ(batches_[1].seq_no(), batches_[0].seq_no() + 1);
+  Reply(Status::OK(), batches_[0].version());
+  Reply(Status::OK(), batches_[1].version());
+
+  // Nothing is sent if nothing changed.
+  broadcaster_.SendBroadcast(rpc::ResourceUsageBroadcastData());
+  ASSERT_EQ(batches_.size(), 2);
+
+  // A failed broadcast is followed by the changes since the acknowledged version.
+  const int64_t acked_version = GetViewVersion(broadcaster_);
+  SendBroadcast(node_1);
+  Reply(Status::TimedOut("timeout"), 0);
+  SendBroadcast(node_2);
+  ASSERT_EQ(batches_.size(), 4);
+  ASSERT_EQ(batches_[3].base_version(), acked_version);
+  ASSERT_EQ(batches_[3].batch_size(), 2);
+
+  // Same if the node couldn't apply it.
+  Reply(Status::OK(), acked_version);
+  SendBroadcast(node_1);
+  ASSERT_EQ(batches_[4].base_version(), acked_version);
+  ASSERT_EQ(batches_[4].batch_size(), 2);
+  Reply(Status::OK(), batches_[4].version());
+
+  // Nodes are sent a snapshot periodically.
+  const auto interval = RayConfig::instance().resource_broadcast_snapshot_interval();
+  for (uint64_t i = 0; i < interval; i++) {
+    SendBroadcast(node_1);
+    Reply(Status::OK(), GetViewVersion(broadcaster_));
+  }
+  int num_snapshots = 0;
+  for (size_t i = 5; i < batches_.size(); i++) {
+    num_snapshots += batches_[i].is_snapshot();
+  }
+  ASSERT_EQ(num_snapshots, 1);
+}
+
+TEST_F(GrpcBasedResourceBroadcasterTest, TestEventsAreSentOnce) {
+  auto node_info = Mocker::GenNodeInfo();
+  broadcaster_.HandleNodeAdded(*node_info);
+  SendBroadcast();
+  Reply(Status::OK(), batches_.back().version());
+
+  rpc::ResourceUsageBroadcastData batch;
+  batch.add_batch()->mutable_change()->set_node_id(NodeID::FromRandom().Binary());
+  broadcaster_.SendBroadcast(std::move(batch));
+  ASSERT_EQ(batches_.size(), 2);
+  ASSERT_EQ(batches_.back().batch_size(), 1);
+  ASSERT_TRUE(batches_.back().batch(0).has_change());
+  Reply(Status::OK(), batches_.back().version());
+
+  broadcaster_.SendBroadcast(rpc::ResourceUsageBroadcastData());
+  ASSERT_EQ(batches_.size(), 2);
+}
+
+/// Simulate broadcasting the resources of clusters of different sizes, where a
+/// fraction of the nodes change their resources between broadcasts, both as snapshots
+/// (which is what every broadcast used to be) and as deltas.
+TEST_F(GrpcBasedResourceBroadcasterTest, BroadcastBenchmark) {
+  const int num_broadcasts = 10;
+  const double changed_fraction = 0.1;
+  const int64_t broadcasts_per_second =
+      1000 / RayConfig::instance().raylet_report_resources_period_milliseconds();
+  std::mt19937 gen(0);
+
+  auto simulate = [&](int num_nodes, bool snapshots, int64_t *bytes_per_second,
+                      double *cpu_per_second) {
+    std::vector<NodeID> node_ids;
+    int64_t bytes_sent = 0;
+    std::vector<rpc::ClientCallback<rpc::UpdateResourceUsageReply>> callbacks;
+    const auto snapshot_interval =
+        RayConfig::instance().resource_broadcast_snapshot_interval();
+    if (snapshots) {
+      RayConfig::instance().resource_broadcast_snapshot_interval() = 0;
+    }
+    GrpcBasedResourceBroadcaster broadcaster(
+        nullptr,
+        [&](const rpc::Address &, std::shared_ptr<rpc::NodeManagerClientPool> &,
+            std::string &data,
+            const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback) {
+          bytes_sent += data.size();
+          callbacks.push_back(callback);
+        });
+    RayConfig::instance().resource_broadcast_snapshot_interval() = snapshot_interval;
+
+    auto make_update = [&](const NodeID &node_id) {
+      rpc::ResourceUpdate update;
+      auto data = update.mutable_data();
+      data->set_node_id(node_id.Binary());
+      data->set_node_manager_address("10.0.0.1");
+      for (const auto &resource : {"CPU", "GPU", "memory", "object_store_memory"}) {
+        (*data->mutable_resources_total())[resource] = 64;
+        (*data->mutable_resources_available())[resource] =
+            std::uniform_int_distribution<int>(0, 64)(gen);
+      }
+      data->set_resources_available_changed(true);
+      return update;
+    };
+
+    rpc::ResourceUsageBroadcastData initial;
+    for (int i = 0; i < num_nodes; i++) {
+      auto node_info = Mocker::GenNodeInfo();
+      node_ids.push_back(NodeID::FromBinary(node_info->node_id()));
+      broadcaster.HandleNodeAdded(*node_info);
+      *initial.add_batch() = make_update(node_ids.back());
+    }
+    broadcaster.SendBroadcast(std::move(initial));
+
+    auto reply_all = [&]() {
+      rpc::UpdateResourceUsageReply reply;
+      reply.set_resource_view_version(GetViewVersion(broadcaster));
+      for (const auto &callback : callbacks) {
+        callback(Status::OK(), reply);
+      }
+      callbacks.clear();
+    };
+    reply_all();
+    bytes_sent = 0;
+
+    int64_t elapsed_ns = 0;
+    std::uniform_int_distribution<int> random_node(0, num_nodes - 1);
+    for (int i = 0; i < num_broadcasts; i++) {
+      rpc::ResourceUsageBroadcastData batch;
+      for (int j = 0; j < num_nodes * changed_fraction; j++) {
+        *batch.add_batch() = make_update(node_ids[random_node(gen)]);
+      }
+      int64_t start = absl::GetCurrentTimeNanos();
+      broadcaster.SendBroadcast(std::move(batch));
+      elapsed_ns += absl::GetCurrentTimeNanos() - start;
+      reply_all();
+    }
+    *bytes_per_second = bytes_sent * broadcasts_per_second / num_broadcasts;
+    *cpu_per_second = 1e-9 * elapsed_ns * broadcasts_per_second / num_broadcasts;
+  };
+
+  for (int num_nodes : {500, 1000, 2000}) {
+    int64_t snapshot_bytes, delta_bytes;
+    double snapshot_cpu, delta_cpu;
+    simulate(num_nodes, /*snapshots=*/true, &snapshot_bytes, &snapshot_cpu);
+    simulate(num_nodes, /*snapshots=*/false, &delta_bytes, &delta_cpu);
+    RAY_LOG(INFO) << "Broadcasting to " << num_nodes << " nodes with "
+                  << changed_fraction * 100 << "% of the nodes changing takes "
+                  << snapshot_bytes / 1024 / 1024 << "MB/s and " << snapshot_cpu * 100
+                  << "% of a CPU with snapshots, and " << delta_bytes / 1024 / 1024
+                  << "MB/s and " << delta_cpu * 100 << "% of a CPU with deltas.";
+    ASSERT_LT(delta_bytes, snapshot_bytes);
+  }
+}
+
+TEST_F(GrpcBasedResourceBroadcasterTest, TestRegions) {
+  auto &region_size = RayConfig::instance().resource_dissemination_region_size();
+  const auto prev_region_size = region_size;
+  region_size = 2;
+  std::vector<std::pair<NodeID, rpc::ResourceUsageBroadcastData>> sent;
+  GrpcBasedResourceBroadcaster broadcaster(
+      nullptr, [&](const rpc::Address &address,
+                   std::shared_ptr<rpc::NodeManagerClientPool> &, std::string &data,
+                   const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &) {
+        rpc::ResourceUsageBroadcastData batch;
+        batch.ParseFromString(data);
+        sent.emplace_back(NodeID::FromBinary(address.raylet_id()), std::move(batch));
+      });
+  region_size = prev_region_size;
+
+  std::vector<std::shared_ptr<rpc::GcsNodeInfo>> nodes;
+  for (int i = 0; i < 3; i++) {
+    nodes.emplace_back(Mocker::GenNodeInfo());
+    broadcaster.HandleNodeAdded(*nodes.back());
+  }
+  auto node_id = [&nodes](int i) { return NodeID::FromBinary(nodes[i]->node_id()); };
+
+  // Only the aggregators are sent broadcasts, along with the rest of their region.
+  rpc::ResourceUsageBroadcastData batch;
+  batch.add_batch()->mutable_data()->set_node_id(node_id(0).Binary());
+  broadcaster.SendBroadcast(batch);
+  ASSERT_EQ(sent.size(), 2);
+  std::sort(sent.begin(), sent.end(), [](const auto &a, const auto &b) {
+    return a.second.forward_to_size() > b.second.forward_to_size();
+  });
+  ASSERT_EQ(sent[0].first, node_id(0));
+  ASSERT_EQ(sent[0].second.forward_to_size(), 1);
+  ASSERT_EQ(sent[0].second.forward_to(0).raylet_id(), node_id(1).Binary());
+  ASSERT_EQ(sent[1].first, node_id(2));
+  ASSERT_EQ(sent[1].second.forward_to_size(), 0);
+
+  // The next member of a region takes over once the aggregator leaves, and is sent a
+  // snapshot.
+  sent.clear();
+  broadcaster.HandleNodeRemoved(*nodes[0]);
+  broadcaster.SendBroadcast(rpc::ResourceUsageBroadcastData());
+  ASSERT_EQ(sent.size(), 1);
+  ASSERT_EQ(sent[0].first, node_id(1));
+  ASSERT_TRUE(sent[0].second.is_snapshot());
+  ASSERT_EQ(sent[0].second.forward_to_size(), 0);
+
+  // A new node joins the first region with room left, which is sent a snapshot for
+  // it.
+  sent.clear();
+  auto node_info = Mocker::GenNodeInfo();
+  broadcaster.HandleNodeAdded(*node_info);
+  broadcaster.SendBroadcast(rpc::ResourceUsageBroadcastData());
+  ASSERT_EQ(sent.size(), 1);
+  ASSERT_EQ(sent[0].first, node_id(1));
+  ASSERT_TRUE(sent[0].second.is_snapshot());
+  ASSERT_EQ(sent[0].second.forward_to_size(), 1);
+  ASSERT_EQ(sent[0].second.forward_to(0).raylet_id(), node_info->node_id());
+}
+
+/// Simulate broadcasting the resources of a cluster to raylets that forward the
+/// broadcasts to their region, and measure how much GCS sends and how many network
+/// hops it takes until every raylet has the resources of every node.
+TEST_F(GrpcBasedResourceBroadcasterTest, RegionConvergenceBenchmark) {
+  struct Message {
+    NodeID to;
+    std::string data;
+    rpc::ClientCallback<rpc::UpdateResourceUsageReply> callback;
+  };
+
+  auto simulate = [&](int num_nodes, uint64_t region_size, int *gcs_sends,
+                      int64_t *gcs_bytes, int *hops) {
+    std::deque<Message> in_flight;
+    auto &config_region_size = RayConfig::instance().resource_dissemination_region_size();
+    const auto prev_region_size = config_region_size;
+    config_region_size = region_size;
+    GrpcBasedResourceBroadcaster broadcaster(
+        nullptr, [&](const rpc::Address &address,
+                     std::shared_ptr<rpc::NodeManagerClientPool> &, std::string &data,
+                     const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback) {
+          (*gcs_sends)++;
+          *gcs_bytes += data.size();
+          in_flight.push_back({NodeID::FromBinary(address.raylet_id()), data, callback});
+        });
+    config_region_size = prev_region_size;
+
+    absl::flat_hash_map<NodeID, absl::flat_hash_set<std::string>> views;
+    rpc::ResourceUsageBroadcastData initial;
+    for (int i = 0; i < num_nodes; i++) {
+      auto node_info = Mocker::GenNodeInfo();
+      broadcaster.HandleNodeAdded(*node_info);
+      views[NodeID::FromBinary(node_info->node_id())];
+      auto data = initial.add_batch()->mutable_data();
+      data->set_node_id(node_info->node_id());
+      (*data->mutable_resources_available())["CPU"] = 1;
+      data->set_resources_available_changed(true);
+    }
+    *gcs_sends = 0;
+    *gcs_bytes = 0;
+    broadcaster.SendBroadcast(std::move(initial));
+
+    // Every hop delivers the messages sent in the previous one. Raylets apply and
+    // forward broadcasts like `NodeManager::HandleUpdateResourceUsage` does.
+    *hops = 0;
+    while (!in_flight.empty()) {
+      (*hops)++;
+      std::deque<Message> delivering;
+      delivering.swap(in_flight);
+      for (auto &message : delivering) {
+        rpc::ResourceUsageBroadcastData batch;
+        batch.ParseFromString(message.data);
+        for (const auto &update : batch.batch()) {
+          views[message.to].insert(update.data().node_id());
+        }
+        rpc::UpdateResourceUsageReply reply;
+        reply.set_resource_view_version(batch.version());
+        if (batch.forward_to_size() == 0) {
+          message.callback(Status::OK(), reply);
+          continue;
+        }
+        google::protobuf::RepeatedPtrField<rpc::Address> forward_to;
+        forward_to.Swap(batch.mutable_forward_to());
+        const auto serialized_batch = batch.SerializeAsString();
+        auto num_pending = std::make_shared<int>(forward_to.size());
+        auto callback = message.callback;
+        for (const auto &address : forward_to) {
+          in_flight.push_back(
+              {NodeID::FromBinary(address.raylet_id()), serialized_batch,
+               [num_pending, callback, reply](const Status &,
+                                              const rpc::UpdateResourceUsageReply &) {
+                 if (--*num_pending == 0) {
+                   callback(Status::OK(), reply);
+                 }
+               }});
+        }
+      }
+    }
+    for (const auto &view : views) {
+      ASSERT_EQ(view.second.size(), static_cast<size_t>(num_nodes));
+    }
+  };
+
+  const int num_nodes = 1000;
+  const int64_t hop_latency_ms = 1;
+  for (uint64_t region_size : {0, 8, 32}) {
+    int gcs_sends;
+    int64_t gcs_bytes;
+    int hops;
+    simulate(num_nodes, region_size, &gcs_sends, &gcs_bytes, &hops);
+    RAY_LOG(INFO) << "Broadcasting to " << num_nodes << " nodes in regions of "
+                  << region_size << " nodes takes " << gcs_sends << " RPCs and "
+                  << gcs_bytes / 1024 / 1024 << "MB from GCS, and converges after "
+                  << hops << " hops (" << hops * hop_latency_ms << "ms at "
+                  << hop_latency_ms << "ms per hop).";
+    if (region_size == 0) {
+      ASSERT_EQ(gcs_sends, num_nodes);
+      ASSERT_EQ(hops, 1);
+    } else {
+      ASSERT_EQ(gcs_sends, (num_nodes + region_size - 1) / region_size);
+      ASSERT_EQ(hops, 2);
+    }
+  }
+}
+
 }  // namespace gcs
 }  // namespace ray
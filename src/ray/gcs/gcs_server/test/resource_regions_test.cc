@@ -0,0 +1,78 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/resource_regions.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace gcs {
+
+TEST(ResourceRegionsTest, TestAddAndRemove) {
+  ResourceRegions regions(2);
+  std::vector<NodeID> nodes;
+  for (int i = 0; i < 5; i++) {
+    nodes.push_back(NodeID::FromRandom());
+  }
+
+  // Nodes fill the regions in order, and the first node of a region aggregates it.
+  ASSERT_EQ(regions.AddNode(nodes[0]), nodes[0]);
+  ASSERT_EQ(regions.AddNode(nodes[1]), nodes[0]);
+  ASSERT_EQ(regions.AddNode(nodes[2]), nodes[2]);
+  ASSERT_EQ(regions.AddNode(nodes[3]), nodes[2]);
+  ASSERT_EQ(regions.AddNode(nodes[4]), nodes[4]);
+  ASSERT_EQ(regions.NumRegions(), 3);
+  ASSERT_TRUE(regions.IsAggregator(nodes[0]));
+  ASSERT_FALSE(regions.IsAggregator(nodes[1]));
+  ASSERT_EQ(regions.GetMembers(nodes[3]), (std::vector<NodeID>{nodes[2], nodes[3]}));
+  // Adding a node again doesn't move it.
+  ASSERT_EQ(regions.AddNode(nodes[1]), nodes[0]);
+  ASSERT_EQ(regions.GetMembers(nodes[0]).size(), 2);
+
+  // The next member takes over once the aggregator leaves, and new nodes fill the
+  // first region with room left.
+  ASSERT_EQ(regions.RemoveNode(nodes[2]), nodes[3]);
+  ASSERT_TRUE(regions.IsAggregator(nodes[3]));
+  ASSERT_EQ(regions.RemoveNode(nodes[1]), nodes[0]);
+  auto node = NodeID::FromRandom();
+  ASSERT_EQ(regions.AddNode(node), nodes[0]);
+  auto other_node = NodeID::FromRandom();
+  ASSERT_EQ(regions.AddNode(other_node), nodes[3]);
+  ASSERT_EQ(regions.NumRegions(), 3);
+
+  // Empty regions are refilled.
+  ASSERT_TRUE(regions.RemoveNode(nodes[4]).IsNil());
+  ASSERT_TRUE(regions.GetAggregator(nodes[4]).IsNil());
+  ASSERT_TRUE(regions.GetMembers(nodes[4]).empty());
+  ASSERT_TRUE(regions.RemoveNode(nodes[4]).IsNil());
+  auto last_node = NodeID::FromRandom();
+  ASSERT_EQ(regions.AddNode(last_node), last_node);
+  ASSERT_EQ(regions.NumRegions(), 3);
+}
+
+TEST(ResourceRegionsTest, TestNoRegions) {
+  // Every node is in a region of its own by default.
+  ResourceRegions regions(0);
+  for (int i = 0; i < 3; i++) {
+    auto node_id = NodeID::FromRandom();
+    ASSERT_EQ(regions.AddNode(node_id), node_id);
+    ASSERT_EQ(regions.GetMembers(node_id).size(), 1);
+  }
+  ASSERT_EQ(regions.NumRegions(), 3);
+}
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,136 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/versioned_resource_view.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ray/common/id.h"
+
+namespace ray {
+namespace gcs {
+
+rpc::ResourcesData MakeReport(const NodeID &node_id, double available_cpus) {
+  rpc::ResourcesData data;
+  data.set_node_id(node_id.Binary());
+  (*data.mutable_resources_available())["CPU"] = available_cpus;
+  data.set_resources_available_changed(true);
+  return data;
+}
+
+std::vector<std::string> NodesOf(const rpc::ResourceUsageBroadcastData &batch) {
+  std::vector<std::string> node_ids;
+  for (const auto &update : batch.batch()) {
+    node_ids.push_back(update.data().node_id());
+  }
+  std::sort(node_ids.begin(), node_ids.end());
+  return node_ids;
+}
+
+TEST(VersionedResourceViewTest, TestDeltaAndSnapshot) {
+  const int64_t initial_version = 1000;
+  VersionedResourceView view(initial_version);
+  auto node_1 = NodeID::FromRandom();
+  auto node_2 = NodeID::FromRandom();
+  view.Update(MakeReport(node_1, 1));
+  view.Update(MakeReport(node_2, 2));
+  ASSERT_EQ(view.NumNodes(), 2);
+  const int64_t version = view.GetVersion();
+  ASSERT_EQ(version, initial_version + 2);
+
+  {
+    rpc::ResourceUsageBroadcastData batch;
+    view.FillDelta(initial_version, &batch);
+    ASSERT_EQ(batch.batch_size(), 2);
+    ASSERT_EQ(batch.base_version(), initial_version);
+    ASSERT_EQ(batch.version(), version);
+    ASSERT_FALSE(batch.is_snapshot());
+  }
+
+  // Only the changes after the base version are in the delta, and every node is in
+  // the delta at most once.
+  view.Update(MakeReport(node_1, 3));
+  view.Update(MakeReport(node_1, 4));
+  {
+    rpc::ResourceUsageBroadcastData batch;
+    view.FillDelta(version, &batch);
+    ASSERT_EQ(NodesOf(batch), std::vector<std::string>{node_1.Binary()});
+    ASSERT_EQ(batch.batch(0).data().resources_available().at("CPU"), 4);
+  }
+  {
+    rpc::ResourceUsageBroadcastData batch;
+    view.FillDelta(view.GetVersion(), &batch);
+    ASSERT_EQ(batch.batch_size(), 0);
+  }
+
+  {
+    rpc::ResourceUsageBroadcastData batch;
+    view.FillSnapshot(&batch);
+    ASSERT_EQ(batch.batch_size(), 2);
+    ASSERT_TRUE(batch.is_snapshot());
+    ASSERT_EQ(batch.version(), view.GetVersion());
+  }
+
+  view.RemoveNode(node_1.Binary());
+  ASSERT_EQ(view.NumNodes(), 1);
+  {
+    rpc::ResourceUsageBroadcastData batch;
+    view.FillDelta(initial_version, &batch);
+    ASSERT_EQ(NodesOf(batch), std::vector<std::string>{node_2.Binary()});
+  }
+}
+
+TEST(VersionedResourceViewTest, TestMergePartialReports) {
+  VersionedResourceView view(0);
+  auto node_id = NodeID::FromRandom();
+  auto report = MakeReport(node_id, 1);
+  (*report.mutable_resources_total())["CPU"] = 8;
+  view.Update(report);
+
+  // A report without totals or available resources keeps the previous ones.
+  rpc::ResourcesData gc_request;
+  gc_request.set_node_id(node_id.Binary());
+  gc_request.set_should_global_gc(true);
+  view.Update(gc_request);
+
+  rpc::ResourceUsageBroadcastData batch;
+  view.FillDelta(0, &batch);
+  ASSERT_EQ(batch.batch_size(), 1);
+  const auto &data = batch.batch(0).data();
+  ASSERT_EQ(data.resources_total().at("CPU"), 8);
+  ASSERT_EQ(data.resources_available().at("CPU"), 1);
+  ASSERT_TRUE(data.resources_available_changed());
+  ASSERT_TRUE(data.should_global_gc());
+
+  // GC requests are only passed on with the change that carries them.
+  view.Update(MakeReport(node_id, 2));
+  batch.Clear();
+  view.FillDelta(0, &batch);
+  ASSERT_FALSE(batch.batch(0).data().should_global_gc());
+  ASSERT_EQ(batch.batch(0).data().resources_total().at("CPU"), 8);
+  ASSERT_EQ(batch.batch(0).data().resources_available().at("CPU"), 2);
+
+  // Merging buffered reports keeps GC requests.
+  rpc::ResourcesData buffered;
+  VersionedResourceView::Merge(gc_request, &buffered);
+  VersionedResourceView::Merge(MakeReport(node_id, 3), &buffered);
+  ASSERT_TRUE(buffered.should_global_gc());
+  ASSERT_EQ(buffered.resources_available().at("CPU"), 3);
+}
+
+}  // namespace gcs
+}  // namespace ray
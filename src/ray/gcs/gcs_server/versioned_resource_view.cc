@@ -0,0 +1,98 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/gcs_server/versioned_resource_view.h"
+
+namespace ray {
+namespace gcs {
+
+VersionedResourceView::VersionedResourceView(int64_t initial_version)
+    : version_(initial_version) {}
+
+void VersionedResourceView::Update(const rpc::ResourcesData &data) {
+  auto it = entries_.find(data.node_id());
+  if (it == entries_.end()) {
+    it = entries_.emplace(data.node_id(), Entry{rpc::ResourcesData(), 0}).first;
+  } else {
+    nodes_by_version_.erase(it->second.version);
+  }
+  Merge(data, &it->second.data);
+  // Only pass a GC request on with the change that carries it.
+  it->second.data.set_should_global_gc(data.should_global_gc());
+  it->second.version = ++version_;
+  nodes_by_version_.emplace(version_, data.node_id());
+}
+
+void VersionedResourceView::RemoveNode(const std::string &node_id) {
+  auto it = entries_.find(node_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  nodes_by_version_.erase(it->second.version);
+  entries_.erase(it);
+}
+
+void VersionedResourceView::FillDelta(int64_t base_version,
+                                      rpc::ResourceUsageBroadcastData *batch) const {
+  for (auto it = nodes_by_version_.upper_bound(base_version);
+       it != nodes_by_version_.end(); ++it) {
+    batch->add_batch()->mutable_data()->CopyFrom(entries_.at(it->second).data);
+  }
+  batch->set_base_version(base_version);
+  batch->set_version(version_);
+  batch->set_is_snapshot(false);
+}
+
+void VersionedResourceView::FillSnapshot(rpc::ResourceUsageBroadcastData *batch) const {
+  for (const auto &entry : entries_) {
+    auto data = batch->add_batch()->mutable_data();
+    data->CopyFrom(entry.second.data);
+    // GC requests are one-off events rather than state, don't replay them.
+    data->set_should_global_gc(false);
+  }
+  batch->set_base_version(0);
+  batch->set_version(version_);
+  batch->set_is_snapshot(true);
+}
+
+void VersionedResourceView::Merge(const rpc::ResourcesData &from,
+                                  rpc::ResourcesData *into) {
+  into->set_node_id(from.node_id());
+  if (!from.node_manager_address().empty()) {
+    into->set_node_manager_address(from.node_manager_address());
+  }
+  if (from.resources_total_size() > 0) {
+    *into->mutable_resources_total() = from.resources_total();
+  }
+  if (from.resources_available_changed()) {
+    *into->mutable_resources_available() = from.resources_available();
+    into->set_object_pulls_queued(from.object_pulls_queued());
+    into->set_resources_available_changed(true);
+  }
+  if (from.resource_load_changed()) {
+    *into->mutable_resource_load() = from.resource_load();
+    into->set_resource_load_changed(true);
+  }
+  if (from.resources_normal_task_changed()) {
+    *into->mutable_resources_normal_task() = from.resources_normal_task();
+    into->set_resources_normal_task_timestamp(from.resources_normal_task_timestamp());
+    into->set_resources_normal_task_changed(true);
+  }
+  *into->mutable_resource_load_by_shape() = from.resource_load_by_shape();
+  into->set_should_global_gc(into->should_global_gc() || from.should_global_gc());
+  into->set_cluster_full_of_actors_detected(from.cluster_full_of_actors_detected());
+}
+
+}  // namespace gcs
+}  // namespace ray
@@ -0,0 +1,78 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "src/ray/protobuf/gcs.pb.h"
+
+namespace ray {
+namespace gcs {
+
+/// The latest resources of every node of the cluster, where every change is stamped
+/// with an increasing version. This lets the resources be broadcast to a receiver as
+/// the changes since the last version it applied rather than as the resources of
+/// every node.
+///
+/// This class is not thread safe.
+class VersionedResourceView {
+ public:
+  /// \param initial_version The version of the empty view. Versions of a view that
+  /// replaces this one (e.g. after a GCS restart) should start above the versions of
+  /// this one, so that receivers don't mistake its changes for old ones.
+  explicit VersionedResourceView(int64_t initial_version);
+
+  /// Apply a resource report of a node, which may only contain the sections that
+  /// changed since the previous report, and bump the version of the view.
+  void Update(const rpc::ResourcesData &data);
+
+  /// Forget a node. Receivers learn about removed nodes from the node table.
+  void RemoveNode(const std::string &node_id);
+
+  /// The version of the latest change.
+  int64_t GetVersion() const { return version_; }
+
+  size_t NumNodes() const { return entries_.size(); }
+
+  /// Add the resources of every node that changed after `base_version` to the batch,
+  /// and stamp it with the versions it covers.
+  void FillDelta(int64_t base_version, rpc::ResourceUsageBroadcastData *batch) const;
+
+  /// Add the resources of every node to the batch, and stamp it as a snapshot.
+  void FillSnapshot(rpc::ResourceUsageBroadcastData *batch) const;
+
+  /// Merge the sections of a resource report into an older report of the same node,
+  /// the same way `GcsResourceManager` and raylets apply them. A GC request of either
+  /// report is kept.
+  static void Merge(const rpc::ResourcesData &from, rpc::ResourcesData *into);
+
+ private:
+  struct Entry {
+    rpc::ResourcesData data;
+    int64_t version;
+  };
+
+  int64_t version_;
+  /// The resources of every node, by node ID.
+  absl::flat_hash_map<std::string, Entry> entries_;
+  /// The node IDs by the version of their latest change, so that the changes since a
+  /// version are found without visiting every node.
+  std::map<int64_t, std::string> nodes_by_version_;
+};
+
+}  // namespace gcs
+}  // namespace ray
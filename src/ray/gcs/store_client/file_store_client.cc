@@ -0,0 +1,643 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/store_client/file_store_client.h"
+
+#include <fcntl.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "ray/common/ray_config.h"
+#include "ray/util/util.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define fsync _commit
+#define ftruncate _chsize_s
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+namespace ray {
+
+namespace gcs {
+
+namespace {
+
+/// A record is framed as its payload size and checksum, followed by the payload: the
+/// record type and the size and bytes of every field.
+constexpr size_t kRecordHeaderSize = 2 * sizeof(uint32_t);
+
+uint32_t Checksum(const char *data, size_t size) {
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void AppendUint32(std::string *buffer, uint32_t value) {
+  buffer->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+bool ReadUint32(const std::string &buffer, size_t *offset, size_t end, uint32_t *value) {
+  if (end - *offset < sizeof(uint32_t)) {
+    return false;
+  }
+  std::memcpy(value, buffer.data() + *offset, sizeof(uint32_t));
+  *offset += sizeof(uint32_t);
+  return true;
+}
+
+bool ReadField(const std::string &buffer, size_t *offset, size_t end,
+               std::string *field) {
+  uint32_t size;
+  if (!ReadUint32(buffer, offset, end, &size) || end - *offset < size) {
+    return false;
+  }
+  field->assign(buffer.data() + *offset, size);
+  *offset += size;
+  return true;
+}
+
+std::string ReadFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return "";
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+Status WriteAll(int fd, const std::string &buffer) {
+  size_t written = 0;
+  while (written < buffer.size()) {
+    auto n = write(fd, buffer.data() + written, buffer.size() - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status::IOError(std::strerror(errno));
+    }
+    written += n;
+  }
+  if (fsync(fd) != 0) {
+    return Status::IOError(std::strerror(errno));
+  }
+  return Status::OK();
+}
+
+/// Sync a directory, so that a rename in it survives a crash.
+Status SyncDirectory(const std::string &dir) {
+#ifdef _WIN32
+  // Directories can't be synced on Windows, where NTFS journals the renames.
+  return Status::OK();
+#else
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return Status::IOError(std::strerror(errno));
+  }
+  auto status = fsync(fd) == 0 ? Status::OK() : Status::IOError(std::strerror(errno));
+  close(fd);
+  return status;
+#endif
+}
+
+}  // namespace
+
+FileStoreClient::FileStoreClient(instrumented_io_context &main_io_service,
+                                 const std::string &dir)
+    : main_io_service_(main_io_service),
+      dir_(dir),
+      log_path_((std::filesystem::path(dir) / "gcs_storage.log").string()),
+      snapshot_path_((std::filesystem::path(dir) / "gcs_storage.snapshot").string()) {
+  std::filesystem::create_directories(dir_);
+  {
+    absl::MutexLock lock(&mutex_);
+    Recover();
+  }
+  writer_thread_ = std::thread([this]() {
+    SetThreadName("gcs.file_store");
+    WriterLoop();
+  });
+}
+
+FileStoreClient::~FileStoreClient() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+  }
+  writer_thread_.join();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
+Status FileStoreClient::AsyncPut(const std::string &table_name, const std::string &key,
+                                 const std::string &data,
+                                 const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  Put(table_name, key, data);
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncPutWithIndex(const std::string &table_name,
+                                          const std::string &key,
+                                          const std::string &index_key,
+                                          const std::string &data,
+                                          const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  PutIndex(table_name, index_key, key);
+  Put(table_name, key, data);
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                                      const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto &entry : entries) {
+    if (!entry.index_key.empty()) {
+      PutIndex(entry.table_name, entry.index_key, entry.key);
+    }
+    Put(entry.table_name, entry.key, entry.data);
+  }
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncGet(const std::string &table_name, const std::string &key,
+                                 const OptionalItemCallback<std::string> &callback) {
+  RAY_CHECK(callback != nullptr);
+  boost::optional<std::string> data;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto table_iter = tables_.find(table_name);
+    if (table_iter != tables_.end()) {
+      auto iter = table_iter->second.records.find(key);
+      if (iter != table_iter->second.records.end()) {
+        data = iter->second;
+      }
+    }
+  }
+  main_io_service_.post(
+      [callback, data = std::move(data)]() { callback(Status::OK(), data); },
+      "GcsFileStore.Get");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncGetByIndex(
+    const std::string &table_name, const std::string &index_key,
+    const MapCallback<std::string, std::string> &callback) {
+  RAY_CHECK(callback);
+  auto result = absl::flat_hash_map<std::string, std::string>();
+  {
+    absl::MutexLock lock(&mutex_);
+    auto table_iter = tables_.find(table_name);
+    if (table_iter != tables_.end()) {
+      const auto &table = table_iter->second;
+      auto iter = table.index_keys.find(index_key);
+      if (iter != table.index_keys.end()) {
+        for (const auto &key : iter->second) {
+          auto kv_iter = table.records.find(key);
+          if (kv_iter != table.records.end()) {
+            result[kv_iter->first] = kv_iter->second;
+          }
+        }
+      }
+    }
+  }
+  main_io_service_.post(
+      [result = std::move(result), callback]() mutable { callback(std::move(result)); },
+      "GcsFileStore.GetByIndex");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncGetAll(
+    const std::string &table_name,
+    const MapCallback<std::string, std::string> &callback) {
+  RAY_CHECK(callback);
+  auto result = absl::flat_hash_map<std::string, std::string>();
+  {
+    absl::MutexLock lock(&mutex_);
+    auto table_iter = tables_.find(table_name);
+    if (table_iter != tables_.end()) {
+      result = table_iter->second.records;
+    }
+  }
+  main_io_service_.post(
+      [result = std::move(result), callback]() mutable { callback(std::move(result)); },
+      "GcsFileStore.GetAll");
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncDelete(const std::string &table_name,
+                                    const std::string &key,
+                                    const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  Delete(table_name, key);
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncDeleteWithIndex(const std::string &table_name,
+                                             const std::string &key,
+                                             const std::string &index_key,
+                                             const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  Delete(table_name, key);
+  DeleteIndex(table_name, index_key, key);
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncBatchDelete(const std::string &table_name,
+                                         const std::vector<std::string> &keys,
+                                         const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto &key : keys) {
+    Delete(table_name, key);
+  }
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncBatchDeleteWithIndex(
+    const std::string &table_name, const std::vector<std::string> &keys,
+    const std::vector<std::string> &index_keys, const StatusCallback &callback) {
+  RAY_CHECK(keys.size() == index_keys.size());
+  absl::MutexLock lock(&mutex_);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    Delete(table_name, keys[i]);
+    DeleteIndex(table_name, index_keys[i], keys[i]);
+  }
+  AddCallback(callback);
+  return Status::OK();
+}
+
+Status FileStoreClient::AsyncDeleteByIndex(const std::string &table_name,
+                                           const std::string &index_key,
+                                           const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  auto table_iter = tables_.find(table_name);
+  if (table_iter != tables_.end()) {
+    auto iter = table_iter->second.index_keys.find(index_key);
+    if (iter != table_iter->second.index_keys.end()) {
+      // Copy the keys, because deleting the last one erases them.
+      auto keys = iter->second;
+      for (const auto &key : keys) {
+        Delete(table_name, key);
+        DeleteIndex(table_name, index_key, key);
+      }
+    }
+  }
+  AddCallback(callback);
+  return Status::OK();
+}
+
+int FileStoreClient::GetNextJobID() {
+  absl::MutexLock lock(&mutex_);
+  job_id_ += 1;
+  const auto value = std::to_string(job_id_);
+  AppendRecord(&pending_log_, RecordType::JOB_COUNTER, {&value});
+  return job_id_;
+}
+
+void FileStoreClient::WriteSnapshot() {
+  absl::MutexLock lock(&mutex_);
+  const auto requested = ++snapshots_requested_;
+  auto written = [this, requested]() EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return snapshots_written_ >= requested;
+  };
+  mutex_.Await(absl::Condition(&written));
+}
+
+void FileStoreClient::Put(const std::string &table_name, const std::string &key,
+                          const std::string &data) {
+  tables_[table_name].records[key] = data;
+  AppendRecord(&pending_log_, RecordType::PUT, {&table_name, &key, &data});
+}
+
+void FileStoreClient::PutIndex(const std::string &table_name,
+                               const std::string &index_key, const std::string &key) {
+  tables_[table_name].index_keys[index_key].insert(key);
+  AppendRecord(&pending_log_, RecordType::PUT_INDEX, {&table_name, &index_key, &key});
+}
+
+void FileStoreClient::Delete(const std::string &table_name, const std::string &key) {
+  auto table_iter = tables_.find(table_name);
+  if (table_iter == tables_.end() || table_iter->second.records.erase(key) == 0) {
+    return;
+  }
+  AppendRecord(&pending_log_, RecordType::DELETE, {&table_name, &key});
+}
+
+void FileStoreClient::DeleteIndex(const std::string &table_name,
+                                  const std::string &index_key, const std::string &key) {
+  auto table_iter = tables_.find(table_name);
+  if (table_iter == tables_.end()) {
+    return;
+  }
+  auto &index_keys = table_iter->second.index_keys;
+  auto iter = index_keys.find(index_key);
+  if (iter == index_keys.end() || iter->second.erase(key) == 0) {
+    return;
+  }
+  if (iter->second.empty()) {
+    index_keys.erase(iter);
+  }
+  AppendRecord(&pending_log_, RecordType::DELETE_INDEX, {&table_name, &index_key, &key});
+}
+
+void FileStoreClient::AddCallback(const StatusCallback &callback) {
+  if (callback == nullptr) {
+    return;
+  }
+  if (pending_log_.empty()) {
+    // Nothing was changed, so there is nothing to wait for.
+    main_io_service_.post([callback]() { callback(Status::OK()); },
+                          "GcsFileStore.NoOp");
+    return;
+  }
+  pending_callbacks_.push_back(callback);
+}
+
+void FileStoreClient::AppendRecord(std::string *buffer, RecordType type,
+                                   const std::vector<const std::string *> &fields) {
+  const size_t header_offset = buffer->size();
+  buffer->append(kRecordHeaderSize, '\0');
+  const size_t payload_offset = buffer->size();
+  buffer->push_back(static_cast<char>(type));
+  for (const auto *field : fields) {
+    AppendUint32(buffer, field->size());
+    buffer->append(*field);
+  }
+  const uint32_t payload_size = buffer->size() - payload_offset;
+  const uint32_t checksum = Checksum(buffer->data() + payload_offset, payload_size);
+  std::memcpy(&(*buffer)[header_offset], &payload_size, sizeof(uint32_t));
+  std::memcpy(&(*buffer)[header_offset + sizeof(uint32_t)], &checksum,
+              sizeof(uint32_t));
+}
+
+size_t FileStoreClient::ApplyRecords(const std::string &buffer, size_t *num_records) {
+  size_t offset = 0;
+  while (offset < buffer.size()) {
+    size_t cursor = offset;
+    uint32_t payload_size;
+    uint32_t checksum;
+    if (!ReadUint32(buffer, &cursor, buffer.size(), &payload_size) ||
+        !ReadUint32(buffer, &cursor, buffer.size(), &checksum) ||
+        buffer.size() - cursor < payload_size || payload_size == 0 ||
+        Checksum(buffer.data() + cursor, payload_size) != checksum) {
+      break;
+    }
+    const size_t end = cursor + payload_size;
+    const auto type = static_cast<RecordType>(buffer[cursor++]);
+    std::string table_name, first, second;
+    bool valid = true;
+    switch (type) {
+    case RecordType::PUT:
+      valid = ReadField(buffer, &cursor, end, &table_name) &&
+              ReadField(buffer, &cursor, end, &first) &&
+              ReadField(buffer, &cursor, end, &second);
+      if (valid) {
+        tables_[table_name].records[first] = std::move(second);
+      }
+      break;
+    case RecordType::DELETE:
+      valid = ReadField(buffer, &cursor, end, &table_name) &&
+              ReadField(buffer, &cursor, end, &first);
+      if (valid) {
+        tables_[table_name].records.erase(first);
+      }
+      break;
+    case RecordType::PUT_INDEX:
+      valid = ReadField(buffer, &cursor, end, &table_name) &&
+              ReadField(buffer, &cursor, end, &first) &&
+              ReadField(buffer, &cursor, end, &second);
+      if (valid) {
+        tables_[table_name].index_keys[first].insert(second);
+      }
+      break;
+    case RecordType::DELETE_INDEX:
+      valid = ReadField(buffer, &cursor, end, &table_name) &&
+              ReadField(buffer, &cursor, end, &first) &&
+              ReadField(buffer, &cursor, end, &second);
+      if (valid) {
+        auto &index_keys = tables_[table_name].index_keys;
+        auto iter = index_keys.find(first);
+        if (iter != index_keys.end()) {
+          iter->second.erase(second);
+          if (iter->second.empty()) {
+            index_keys.erase(iter);
+          }
+        }
+      }
+      break;
+    case RecordType::JOB_COUNTER:
+      valid = ReadField(buffer, &cursor, end, &first);
+      if (valid) {
+        job_id_ = std::max(job_id_, std::stoi(first));
+      }
+      break;
+    default:
+      valid = false;
+    }
+    if (!valid) {
+      break;
+    }
+    offset = end;
+    ++(*num_records);
+  }
+  return offset;
+}
+
+void FileStoreClient::Recover() {
+  const auto start_ms = current_time_ms();
+  size_t num_records = 0;
+  const auto snapshot = ReadFile(snapshot_path_);
+  RAY_CHECK(ApplyRecords(snapshot, &num_records) == snapshot.size())
+      << "The GCS storage snapshot " << snapshot_path_ << " is corrupted.";
+  const auto log = ReadFile(log_path_);
+  const size_t log_size = ApplyRecords(log, &num_records);
+  if (log_size < log.size()) {
+    // The tail of the log was torn by a crash while it was written. Its writes were
+    // never acknowledged, so they are dropped.
+    RAY_LOG(WARNING) << "Dropping " << log.size() - log_size
+                     << " bytes of torn records at the end of the GCS storage log "
+                     << log_path_;
+    std::filesystem::resize_file(log_path_, log_size);
+  }
+  log_fd_ = open(log_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_BINARY, 0644);
+  RAY_CHECK(log_fd_ >= 0) << "Failed to open the GCS storage log " << log_path_ << ": "
+                          << std::strerror(errno);
+  log_size_ = log_size;
+  RAY_LOG(INFO) << "Recovered " << num_records << " records of " << tables_.size()
+                << " tables from the GCS storage in " << dir_ << " in "
+                << current_time_ms() - start_ms << " ms.";
+}
+
+void FileStoreClient::WriterLoop() {
+  const uint64_t snapshot_threshold =
+      RayConfig::instance().gcs_file_storage_snapshot_threshold_bytes();
+  while (true) {
+    std::string buffer;
+    std::vector<StatusCallback> callbacks;
+    bool write_snapshot = false;
+    bool stopped = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto has_work = [this]() EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return stopped_ || !pending_log_.empty() ||
+               snapshots_requested_ > snapshots_written_;
+      };
+      mutex_.Await(absl::Condition(&has_work));
+      buffer.swap(pending_log_);
+      callbacks.swap(pending_callbacks_);
+      write_snapshot = snapshots_requested_ > snapshots_written_;
+      stopped = stopped_;
+    }
+    if (!buffer.empty()) {
+      PostCallbacks(std::move(callbacks), WriteToLog(buffer));
+    }
+    if (write_snapshot || (snapshot_threshold > 0 && log_size_ >= snapshot_threshold)) {
+      DoWriteSnapshot();
+    }
+    if (stopped) {
+      break;
+    }
+  }
+}
+
+Status FileStoreClient::WriteToLog(const std::string &buffer) {
+  auto status = WriteAll(log_fd_, buffer);
+  if (status.ok()) {
+    log_size_ += buffer.size();
+    return status;
+  }
+  RAY_LOG(ERROR) << "Failed to write to the GCS storage log " << log_path_ << ": "
+                 << status;
+  // Cut off the part of the buffer that was written. Otherwise the records appended
+  // after it would follow a torn record, and be dropped on recovery.
+  RAY_CHECK(ftruncate(log_fd_, log_size_) == 0 && fsync(log_fd_) == 0)
+      << "Failed to truncate the GCS storage log " << log_path_
+      << " after a failed write: " << std::strerror(errno);
+  return status;
+}
+
+void FileStoreClient::PostCallbacks(std::vector<StatusCallback> callbacks,
+                                    const Status &status) {
+  if (callbacks.empty()) {
+    return;
+  }
+  main_io_service_.post(
+      [callbacks = std::move(callbacks), status]() {
+        for (const auto &callback : callbacks) {
+          callback(status);
+        }
+      },
+      "GcsFileStore.Write");
+}
+
+void FileStoreClient::DoWriteSnapshot() {
+  const auto start_ms = current_time_ms();
+  std::string buffer;
+  std::vector<StatusCallback> callbacks;
+  absl::flat_hash_map<std::string, Table> tables;
+  int job_id;
+  uint64_t requested;
+  {
+    // Take the pending log together with a copy of the data, so that the snapshot
+    // contains every record of the log. The log is synced and the copy serialized
+    // after the lock is released, so that they don't block the writers.
+    absl::MutexLock lock(&mutex_);
+    buffer.swap(pending_log_);
+    callbacks.swap(pending_callbacks_);
+    tables = tables_;
+    job_id = job_id_;
+    requested = snapshots_requested_;
+  }
+  if (!buffer.empty()) {
+    PostCallbacks(std::move(callbacks), WriteToLog(buffer));
+  }
+
+  std::string snapshot;
+  for (const auto &[table_name, table] : tables) {
+    for (const auto &[key, data] : table.records) {
+      AppendRecord(&snapshot, RecordType::PUT, {&table_name, &key, &data});
+    }
+    for (const auto &[index_key, keys] : table.index_keys) {
+      for (const auto &key : keys) {
+        AppendRecord(&snapshot, RecordType::PUT_INDEX, {&table_name, &index_key, &key});
+      }
+    }
+  }
+  const auto job_id_value = std::to_string(job_id);
+  AppendRecord(&snapshot, RecordType::JOB_COUNTER, {&job_id_value});
+
+  // Replace the snapshot atomically. If GCS crashes before the log is started again,
+  // the log is replayed on top of the new snapshot, which is a no-op.
+  const auto tmp_path = snapshot_path_ + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+  auto status = fd >= 0 ? WriteAll(fd, snapshot) : Status::IOError(std::strerror(errno));
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (status.ok()) {
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, snapshot_path_, ec);
+    if (ec) {
+      status = Status::IOError(ec.message());
+    }
+  }
+  if (status.ok()) {
+    // The rename must be durable before the log is truncated. Otherwise a crash could
+    // leave the old snapshot next to the empty log, and lose the records in between.
+    status = SyncDirectory(dir_);
+  }
+  if (status.ok()) {
+    close(log_fd_);
+    log_fd_ = open(log_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_BINARY,
+                   0644);
+    RAY_CHECK(log_fd_ >= 0) << "Failed to open the GCS storage log " << log_path_
+                            << ": " << std::strerror(errno);
+    log_size_ = 0;
+    RAY_LOG(DEBUG) << "Wrote a snapshot of " << snapshot.size()
+                   << " bytes of the GCS storage in " << current_time_ms() - start_ms
+                   << " ms.";
+  } else {
+    // Keep appending to the current log, which still has every record since the last
+    // snapshot.
+    RAY_LOG(ERROR) << "Failed to write the GCS storage snapshot " << snapshot_path_
+                   << ": " << status;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  snapshots_written_ = std::max(snapshots_written_, requested);
+}
+
+}  // namespace gcs
+
+}  // namespace ray
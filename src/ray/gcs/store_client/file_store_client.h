@@ -0,0 +1,187 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/gcs/store_client/store_client.h"
+
+namespace ray {
+
+namespace gcs {
+
+/// \class FileStoreClient
+///
+/// A store client that keeps the data in memory and persists it to a directory on
+/// local disk, so that GCS can recover it after a restart without an external Redis.
+///
+/// Every write is applied in memory right away, and appended to a write-ahead log by a
+/// background thread, which writes and syncs the pending records in one go. The
+/// callback of a write is only called once its record is synced. When the log grows
+/// past `gcs_file_storage_snapshot_threshold_bytes`, a snapshot of the data is written
+/// and the log is started again. On construction, the data are recovered from the last
+/// snapshot and the log written after it, up to the first torn record.
+///
+/// Reads are served from memory, so they see every write made before them.
+///
+/// This class is thread safe.
+class FileStoreClient : public StoreClient {
+ public:
+  /// \param main_io_service The event loop that callbacks are posted to.
+  /// \param dir The directory of the snapshot and log. It's created if it doesn't
+  /// exist.
+  FileStoreClient(instrumented_io_context &main_io_service, const std::string &dir);
+
+  /// Syncs the pending writes and stops the background thread.
+  ~FileStoreClient();
+
+  Status AsyncPut(const std::string &table_name, const std::string &key,
+                  const std::string &data, const StatusCallback &callback) override;
+
+  Status AsyncPutWithIndex(const std::string &table_name, const std::string &key,
+                           const std::string &index_key, const std::string &data,
+                           const StatusCallback &callback) override;
+
+  Status AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                       const StatusCallback &callback) override;
+
+  Status AsyncGet(const std::string &table_name, const std::string &key,
+                  const OptionalItemCallback<std::string> &callback) override;
+
+  Status AsyncGetByIndex(const std::string &table_name, const std::string &index_key,
+                         const MapCallback<std::string, std::string> &callback) override;
+
+  Status AsyncGetAll(const std::string &table_name,
+                     const MapCallback<std::string, std::string> &callback) override;
+
+  Status AsyncDelete(const std::string &table_name, const std::string &key,
+                     const StatusCallback &callback) override;
+
+  Status AsyncDeleteWithIndex(const std::string &table_name, const std::string &key,
+                              const std::string &index_key,
+                              const StatusCallback &callback) override;
+
+  Status AsyncBatchDelete(const std::string &table_name,
+                          const std::vector<std::string> &keys,
+                          const StatusCallback &callback) override;
+
+  Status AsyncBatchDeleteWithIndex(const std::string &table_name,
+                                   const std::vector<std::string> &keys,
+                                   const std::vector<std::string> &index_keys,
+                                   const StatusCallback &callback) override;
+
+  Status AsyncDeleteByIndex(const std::string &table_name, const std::string &index_key,
+                            const StatusCallback &callback) override;
+
+  int GetNextJobID() override;
+
+  /// Write a snapshot of the data and start the log again, once the pending writes are
+  /// synced. Blocks until the snapshot is written.
+  void WriteSnapshot() LOCKS_EXCLUDED(mutex_);
+
+ private:
+  /// The mutations that are logged. Every record is one mutation of one table, or of
+  /// the job counter, and replaying a record that was already applied is a no-op, so
+  /// the log can be replayed on top of a snapshot that already contains it.
+  enum class RecordType : uint8_t {
+    PUT = 0,
+    DELETE = 1,
+    PUT_INDEX = 2,
+    DELETE_INDEX = 3,
+    JOB_COUNTER = 4,
+  };
+
+  struct Table {
+    /// Mapping from key to data.
+    absl::flat_hash_map<std::string, std::string> records;
+    /// Mapping from index key to keys.
+    absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>> index_keys;
+  };
+
+  /// Apply a mutation in memory and append its record to the pending log.
+  void Put(const std::string &table_name, const std::string &key,
+           const std::string &data) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void PutIndex(const std::string &table_name, const std::string &index_key,
+                const std::string &key) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Delete(const std::string &table_name, const std::string &key)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void DeleteIndex(const std::string &table_name, const std::string &index_key,
+                   const std::string &key) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Call the callback once the pending log, including the records appended so far,
+  /// is synced.
+  void AddCallback(const StatusCallback &callback) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Append a record to a log buffer.
+  static void AppendRecord(std::string *buffer, RecordType type,
+                           const std::vector<const std::string *> &fields);
+
+  /// Apply the records of a log buffer in memory, up to the first torn record.
+  ///
+  /// \return The number of bytes of the buffer that were applied.
+  size_t ApplyRecords(const std::string &buffer, size_t *num_records)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Recover the data from the snapshot and log, and open the log for appending.
+  void Recover() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// The loop of the background thread, which syncs the pending log.
+  void WriterLoop() LOCKS_EXCLUDED(mutex_);
+
+  /// Append a buffer to the log and sync it. If that fails, the log is truncated back
+  /// to its last synced record.
+  Status WriteToLog(const std::string &buffer);
+
+  /// Call the callbacks of synced records on the main event loop.
+  void PostCallbacks(std::vector<StatusCallback> callbacks, const Status &status);
+
+  /// Sync the pending log, then write a snapshot and start the log again. Must only be
+  /// called by the background thread.
+  void DoWriteSnapshot() LOCKS_EXCLUDED(mutex_);
+
+  instrumented_io_context &main_io_service_;
+  const std::string dir_;
+  const std::string log_path_;
+  const std::string snapshot_path_;
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, Table> tables_ GUARDED_BY(mutex_);
+  int job_id_ GUARDED_BY(mutex_) = 0;
+  /// The records that aren't written to the log yet.
+  std::string pending_log_ GUARDED_BY(mutex_);
+  /// The callbacks of the writes of the records in `pending_log_`.
+  std::vector<StatusCallback> pending_callbacks_ GUARDED_BY(mutex_);
+  /// The number of snapshots requested by `WriteSnapshot`, and written.
+  uint64_t snapshots_requested_ GUARDED_BY(mutex_) = 0;
+  uint64_t snapshots_written_ GUARDED_BY(mutex_) = 0;
+  bool stopped_ GUARDED_BY(mutex_) = false;
+
+  /// The log file, and its size. Only used by the background thread once the client is
+  /// constructed.
+  int log_fd_ = -1;
+  uint64_t log_size_ = 0;
+
+  std::thread writer_thread_;
+};
+
+}  // namespace gcs
+
+}  // namespace ray
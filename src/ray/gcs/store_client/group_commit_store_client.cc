@@ -0,0 +1,206 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/store_client/group_commit_store_client.h"
+
+#include <algorithm>
+
+#include "ray/common/asio/asio_util.h"
+
+namespace ray {
+
+namespace gcs {
+
+GroupCommitStoreClient::GroupCommitStoreClient(std::shared_ptr<StoreClient> store_client,
+                                               instrumented_io_context &io_service,
+                                               int64_t window_us, size_t max_entries)
+    : store_client_(std::move(store_client)),
+      io_service_(io_service),
+      window_us_(window_us),
+      max_entries_(std::max<size_t>(max_entries, 1)) {
+  RAY_CHECK(store_client_);
+}
+
+GroupCommitStoreClient::~GroupCommitStoreClient() {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+}
+
+Status GroupCommitStoreClient::AsyncPut(const std::string &table_name,
+                                        const std::string &key, const std::string &data,
+                                        const StatusCallback &callback) {
+  AddToBatch({BatchPutEntry{table_name, key, "", data}}, callback);
+  return Status::OK();
+}
+
+Status GroupCommitStoreClient::AsyncPutWithIndex(const std::string &table_name,
+                                                 const std::string &key,
+                                                 const std::string &index_key,
+                                                 const std::string &data,
+                                                 const StatusCallback &callback) {
+  RAY_CHECK(!index_key.empty());
+  AddToBatch({BatchPutEntry{table_name, key, index_key, data}}, callback);
+  return Status::OK();
+}
+
+Status GroupCommitStoreClient::AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                                             const StatusCallback &callback) {
+  AddToBatch(entries, callback);
+  return Status::OK();
+}
+
+Status GroupCommitStoreClient::AsyncGet(
+    const std::string &table_name, const std::string &key,
+    const OptionalItemCallback<std::string> &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncGet(table_name, key, callback);
+}
+
+Status GroupCommitStoreClient::AsyncGetByIndex(
+    const std::string &table_name, const std::string &index_key,
+    const MapCallback<std::string, std::string> &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncGetByIndex(table_name, index_key, callback);
+}
+
+Status GroupCommitStoreClient::AsyncGetAll(
+    const std::string &table_name,
+    const MapCallback<std::string, std::string> &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncGetAll(table_name, callback);
+}
+
+Status GroupCommitStoreClient::AsyncGetAllPaged(
+    const std::string &table_name, const MapCallback<std::string, std::string> &on_page,
+    const StatusCallback &on_done) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncGetAllPaged(table_name, on_page, on_done);
+}
+
+Status GroupCommitStoreClient::AsyncDelete(const std::string &table_name,
+                                           const std::string &key,
+                                           const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncDelete(table_name, key, callback);
+}
+
+Status GroupCommitStoreClient::AsyncDeleteWithIndex(const std::string &table_name,
+                                                    const std::string &key,
+                                                    const std::string &index_key,
+                                                    const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncDeleteWithIndex(table_name, key, index_key, callback);
+}
+
+Status GroupCommitStoreClient::AsyncBatchDelete(const std::string &table_name,
+                                                const std::vector<std::string> &keys,
+                                                const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncBatchDelete(table_name, keys, callback);
+}
+
+Status GroupCommitStoreClient::AsyncBatchDeleteWithIndex(
+    const std::string &table_name, const std::vector<std::string> &keys,
+    const std::vector<std::string> &index_keys, const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncBatchDeleteWithIndex(table_name, keys, index_keys,
+                                                  callback);
+}
+
+Status GroupCommitStoreClient::AsyncDeleteByIndex(const std::string &table_name,
+                                                  const std::string &index_key,
+                                                  const StatusCallback &callback) {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+  return store_client_->AsyncDeleteByIndex(table_name, index_key, callback);
+}
+
+int GroupCommitStoreClient::GetNextJobID() { return store_client_->GetNextJobID(); }
+
+void GroupCommitStoreClient::Flush() {
+  absl::MutexLock lock(&mutex_);
+  FlushLocked();
+}
+
+void GroupCommitStoreClient::AddToBatch(std::vector<BatchPutEntry> entries,
+                                        const StatusCallback &callback) {
+  if (entries.empty()) {
+    if (callback) {
+      io_service_.post([callback]() { callback(Status::OK()); },
+                       "GcsGroupCommitStore.EmptyBatch");
+    }
+    return;
+  }
+  absl::MutexLock lock(&mutex_);
+  if (entries_.empty()) {
+    auto seq_no = batch_seq_no_;
+    flush_timer_ = execute_after_us(
+        io_service_,
+        [this, seq_no]() {
+          absl::MutexLock lock(&mutex_);
+          if (seq_no == batch_seq_no_) {
+            FlushLocked();
+          }
+        },
+        window_us_);
+  }
+  entries_.insert(entries_.end(), std::make_move_iterator(entries.begin()),
+                  std::make_move_iterator(entries.end()));
+  if (callback) {
+    callbacks_.push_back(callback);
+  }
+  if (entries_.size() >= max_entries_) {
+    FlushLocked();
+  }
+}
+
+void GroupCommitStoreClient::FlushLocked() {
+  if (flush_timer_) {
+    flush_timer_->cancel();
+    flush_timer_.reset();
+  }
+  if (entries_.empty()) {
+    return;
+  }
+  ++batch_seq_no_;
+  std::vector<BatchPutEntry> entries;
+  entries.swap(entries_);
+  auto callbacks = std::make_shared<std::vector<StatusCallback>>();
+  callbacks->swap(callbacks_);
+  auto on_done = [callbacks](const Status &status) {
+    for (const auto &callback : *callbacks) {
+      callback(status);
+    }
+  };
+  auto status = store_client_->AsyncBatchPut(entries, on_done);
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to write a batch of " << entries.size()
+                     << " entries to the GCS storage: " << status;
+    // The callbacks may make more operations, so they can't be called with the lock held.
+    io_service_.post([on_done, status]() { on_done(status); },
+                     "GcsGroupCommitStore.FlushFailed");
+  }
+}
+
+}  // namespace gcs
+
+}  // namespace ray
@@ -0,0 +1,129 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <boost/asio/deadline_timer.hpp>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/gcs/store_client/store_client.h"
+
+namespace ray {
+
+namespace gcs {
+
+/// \class GroupCommitStoreClient
+///
+/// A store client that groups the writes made over a short window into one
+/// `AsyncBatchPut` of the store client it wraps, so that a burst of writes costs one
+/// round trip to the storage instead of one per write.
+///
+/// The callback of a write is only called once the batch that contains it is written.
+/// Every other operation writes the buffered batch before it is sent, so that the
+/// operations on a key are executed in the order they are made.
+///
+/// This class is thread safe.
+class GroupCommitStoreClient : public StoreClient {
+ public:
+  /// \param store_client The store client that the batches are written to.
+  /// \param io_service The event loop that the batches are written on when their window
+  /// ends.
+  /// \param window_us How long a batch waits for more writes after its first one.
+  /// \param max_entries The number of writes a batch is written at, before its window
+  /// ends.
+  GroupCommitStoreClient(std::shared_ptr<StoreClient> store_client,
+                         instrumented_io_context &io_service, int64_t window_us,
+                         size_t max_entries);
+
+  ~GroupCommitStoreClient();
+
+  Status AsyncPut(const std::string &table_name, const std::string &key,
+                  const std::string &data, const StatusCallback &callback) override;
+
+  Status AsyncPutWithIndex(const std::string &table_name, const std::string &key,
+                           const std::string &index_key, const std::string &data,
+                           const StatusCallback &callback) override;
+
+  Status AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                       const StatusCallback &callback) override;
+
+  Status AsyncGet(const std::string &table_name, const std::string &key,
+                  const OptionalItemCallback<std::string> &callback) override;
+
+  Status AsyncGetByIndex(const std::string &table_name, const std::string &index_key,
+                         const MapCallback<std::string, std::string> &callback) override;
+
+  Status AsyncGetAll(const std::string &table_name,
+                     const MapCallback<std::string, std::string> &callback) override;
+
+  Status AsyncGetAllPaged(const std::string &table_name,
+                          const MapCallback<std::string, std::string> &on_page,
+                          const StatusCallback &on_done) override;
+
+  Status AsyncDelete(const std::string &table_name, const std::string &key,
+                     const StatusCallback &callback) override;
+
+  Status AsyncDeleteWithIndex(const std::string &table_name, const std::string &key,
+                              const std::string &index_key,
+                              const StatusCallback &callback) override;
+
+  Status AsyncBatchDelete(const std::string &table_name,
+                          const std::vector<std::string> &keys,
+                          const StatusCallback &callback) override;
+
+  Status AsyncBatchDeleteWithIndex(const std::string &table_name,
+                                   const std::vector<std::string> &keys,
+                                   const std::vector<std::string> &index_keys,
+                                   const StatusCallback &callback) override;
+
+  Status AsyncDeleteByIndex(const std::string &table_name, const std::string &index_key,
+                            const StatusCallback &callback) override;
+
+  int GetNextJobID() override;
+
+  /// Write the buffered batch now, without waiting for its window to end.
+  void Flush() LOCKS_EXCLUDED(mutex_);
+
+ private:
+  /// Add writes to the buffered batch, and write it if it is full.
+  void AddToBatch(std::vector<BatchPutEntry> entries, const StatusCallback &callback)
+      LOCKS_EXCLUDED(mutex_);
+
+  void FlushLocked() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::shared_ptr<StoreClient> store_client_;
+  instrumented_io_context &io_service_;
+  const int64_t window_us_;
+  const size_t max_entries_;
+
+  /// Mutex to protect the buffered batch. It is held while an operation is sent to the
+  /// wrapped store client, so that operations are sent in the order they are made.
+  absl::Mutex mutex_;
+  /// The writes of the buffered batch, in the order they were made.
+  std::vector<BatchPutEntry> entries_ GUARDED_BY(mutex_);
+  /// The callbacks of the writes of the buffered batch.
+  std::vector<StatusCallback> callbacks_ GUARDED_BY(mutex_);
+  /// The sequence number of the buffered batch, so that the timer of a batch that was
+  /// written because it was full doesn't write the batch after it early.
+  uint64_t batch_seq_no_ GUARDED_BY(mutex_) = 0;
+  /// The timer that writes the buffered batch when its window ends.
+  std::shared_ptr<boost::asio::deadline_timer> flush_timer_ GUARDED_BY(mutex_);
+};
+
+}  // namespace gcs
+
+}  // namespace ray
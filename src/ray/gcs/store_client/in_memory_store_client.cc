@@ -47,6 +47,23 @@ Status InMemoryStoreClient::AsyncPutWithIndex(const std::string &table_name,
   return Status::OK();
 }
 
+Status InMemoryStoreClient::AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                                          const StatusCallback &callback) {
+  for (const auto &entry : entries) {
+    auto table = GetOrCreateTable(entry.table_name);
+    absl::MutexLock lock(&(table->mutex_));
+    table->records_[entry.key] = entry.data;
+    if (!entry.index_key.empty()) {
+      table->index_keys_[entry.index_key].emplace_back(entry.key);
+    }
+  }
+  if (callback != nullptr) {
+    main_io_service_.post([callback]() { callback(Status::OK()); },
+                          "GcsInMemoryStore.BatchPut");
+  }
+  return Status::OK();
+}
+
 Status InMemoryStoreClient::AsyncGet(const std::string &table_name,
                                      const std::string &key,
                                      const OptionalItemCallback<std::string> &callback) {
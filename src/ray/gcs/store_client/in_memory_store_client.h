@@ -39,6 +39,9 @@ class InMemoryStoreClient : public StoreClient {
                            const std::string &index_key, const std::string &data,
                            const StatusCallback &callback) override;
 
+  Status AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                       const StatusCallback &callback) override;
+
   Status AsyncGet(const std::string &table_name, const std::string &key,
                   const OptionalItemCallback<std::string> &callback) override;
 
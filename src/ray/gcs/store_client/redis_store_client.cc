@@ -58,6 +58,61 @@ Status RedisStoreClient::AsyncPutWithIndex(const std::string &table_name,
   return status;
 }
 
+Status RedisStoreClient::AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                                       const StatusCallback &callback) {
+  if (entries.empty()) {
+    if (callback) {
+      callback(Status::OK());
+    }
+    return Status::OK();
+  }
+  // Write the batch with one `MSET` per shard (or per `batch_size` writes). The commands
+  // of a shard are executed in order, and so are the writes of a command, so every key
+  // is written in the order of the entries, and indexes before their data as in
+  // `AsyncPutWithIndex`.
+  const size_t batch_size =
+      RayConfig::instance().maximum_gcs_storage_operation_batch_size();
+  absl::flat_hash_map<RedisContext *, std::list<std::vector<std::string>>>
+      commands_by_shards;
+  int total_count = 0;
+  auto add_write = [&](std::string redis_key, const std::string &data) {
+    auto &commands = commands_by_shards[redis_client_->GetShardContext(redis_key).get()];
+    if (commands.empty() || (commands.back().size() - 1) / 2 == batch_size) {
+      commands.emplace_back();
+      commands.back().push_back("MSET");
+      total_count++;
+    }
+    commands.back().push_back(std::move(redis_key));
+    commands.back().push_back(data);
+  };
+  for (const auto &entry : entries) {
+    if (!entry.index_key.empty()) {
+      add_write(GenRedisKey(entry.table_name, entry.key, entry.index_key), entry.key);
+    }
+    add_write(GenRedisKey(entry.table_name, entry.key), entry.data);
+  }
+
+  auto finished_count = std::make_shared<int>(0);
+  auto first_error = std::make_shared<Status>();
+  for (auto &command_list : commands_by_shards) {
+    for (auto &command : command_list.second) {
+      auto mset_callback = [finished_count, first_error, total_count,
+                            callback](const std::shared_ptr<CallbackReply> &reply) {
+        auto status = reply->ReadAsStatus();
+        if (!status.ok() && first_error->ok()) {
+          *first_error = status;
+        }
+        ++(*finished_count);
+        if (*finished_count == total_count && callback) {
+          callback(*first_error);
+        }
+      };
+      RAY_CHECK_OK(command_list.first->RunArgvAsync(command, mset_callback));
+    }
+  }
+  return Status::OK();
+}
+
 Status RedisStoreClient::AsyncGet(const std::string &table_name, const std::string &key,
                                   const OptionalItemCallback<std::string> &callback) {
   RAY_CHECK(callback != nullptr);
@@ -93,6 +148,23 @@ Status RedisStoreClient::AsyncGetAll(
   return scanner->ScanKeysAndValues(match_pattern, on_done);
 }
 
+Status RedisStoreClient::AsyncGetAllPaged(
+    const std::string &table_name, const MapCallback<std::string, std::string> &on_page,
+    const StatusCallback &on_done) {
+  RAY_CHECK(on_page && on_done);
+  auto scan = std::make_shared<PagedScan>();
+  scan->table_name = table_name;
+  scan->match_pattern = GenRedisMatchPattern(table_name);
+  scan->on_page = on_page;
+  scan->on_done = on_done;
+  const size_t num_shards = redis_client_->GetShardContexts().size();
+  scan->pending_shards = num_shards;
+  for (size_t shard_index = 0; shard_index < num_shards; ++shard_index) {
+    ScanPage(scan, shard_index, /*cursor=*/0);
+  }
+  return Status::OK();
+}
+
 Status RedisStoreClient::AsyncDelete(const std::string &table_name,
                                      const std::string &key,
                                      const StatusCallback &callback) {
@@ -202,6 +274,40 @@ Status RedisStoreClient::AsyncDeleteByIndex(const std::string &table_name,
   return scanner->ScanKeys(match_pattern, on_done);
 }
 
+void RedisStoreClient::ScanPage(const std::shared_ptr<PagedScan> &scan,
+                                size_t shard_index, size_t cursor) {
+  auto scan_callback = [this, scan,
+                        shard_index](const std::shared_ptr<CallbackReply> &reply) {
+    std::vector<std::string> keys;
+    size_t next_cursor = reply->ReadAsScanArray(&keys);
+    auto on_values = [this, scan, shard_index,
+                      next_cursor](absl::flat_hash_map<std::string, std::string> &&page) {
+      if (!page.empty()) {
+        absl::MutexLock lock(&scan->mutex);
+        scan->on_page(std::move(page));
+      }
+      // A cursor of 0 means that the scan of the shard is finished.
+      if (next_cursor != 0) {
+        ScanPage(scan, shard_index, next_cursor);
+      } else if (--scan->pending_shards == 0) {
+        scan->on_done(Status::OK());
+      }
+    };
+    if (keys.empty()) {
+      on_values({});
+    } else {
+      RAY_CHECK_OK(MGetValues(redis_client_, scan->table_name, keys, on_values));
+    }
+  };
+  std::vector<std::string> args = {
+      "SCAN",  std::to_string(cursor),
+      "MATCH", scan->match_pattern,
+      "COUNT", std::to_string(
+                   RayConfig::instance().maximum_gcs_storage_operation_batch_size())};
+  auto shard_context = redis_client_->GetShardContexts()[shard_index];
+  RAY_CHECK_OK(shard_context->RunArgvAsync(args, scan_callback));
+}
+
 Status RedisStoreClient::DoPut(const std::string &key, const std::string &data,
                                const StatusCallback &callback) {
   std::vector<std::string> args = {"SET", key, data};
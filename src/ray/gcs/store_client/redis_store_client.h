@@ -36,6 +36,9 @@ class RedisStoreClient : public StoreClient {
                            const std::string &index_key, const std::string &data,
                            const StatusCallback &callback) override;
 
+  Status AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                       const StatusCallback &callback) override;
+
   Status AsyncGet(const std::string &table_name, const std::string &key,
                   const OptionalItemCallback<std::string> &callback) override;
 
@@ -45,6 +48,10 @@ class RedisStoreClient : public StoreClient {
   Status AsyncGetAll(const std::string &table_name,
                      const MapCallback<std::string, std::string> &callback) override;
 
+  Status AsyncGetAllPaged(const std::string &table_name,
+                          const MapCallback<std::string, std::string> &on_page,
+                          const StatusCallback &on_done) override;
+
   Status AsyncDelete(const std::string &table_name, const std::string &key,
                      const StatusCallback &callback) override;
 
@@ -108,6 +115,23 @@ class RedisStoreClient : public StoreClient {
     std::shared_ptr<RedisClient> redis_client_;
   };
 
+  /// The state of an `AsyncGetAllPaged`, which scans the shards in parallel.
+  struct PagedScan {
+    std::string table_name;
+    std::string match_pattern;
+    MapCallback<std::string, std::string> on_page;
+    StatusCallback on_done;
+    /// Mutex to deliver one page at a time.
+    absl::Mutex mutex;
+    /// The number of shards whose scan isn't finished.
+    std::atomic<size_t> pending_shards{0};
+  };
+
+  /// Scan a page of keys of a shard from the cursor, get their values, and scan the
+  /// next page once they are delivered.
+  void ScanPage(const std::shared_ptr<PagedScan> &scan, size_t shard_index,
+                size_t cursor);
+
   Status DoPut(const std::string &key, const std::string &data,
                const StatusCallback &callback);
 
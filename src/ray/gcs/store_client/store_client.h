@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ray/common/asio/io_service_pool.h"
 #include "ray/common/id.h"
@@ -28,6 +29,15 @@ namespace ray {
 
 namespace gcs {
 
+/// A write of a batch that is passed to `StoreClient::AsyncBatchPut`.
+struct BatchPutEntry {
+  std::string table_name;
+  std::string key;
+  /// The secondary key the data is indexed by, or empty if it isn't indexed.
+  std::string index_key;
+  std::string data;
+};
+
 /// \class StoreClient
 /// Abstract interface of the storage client.
 class StoreClient {
@@ -56,6 +66,15 @@ class StoreClient {
                                    const std::string &index_key, const std::string &data,
                                    const StatusCallback &callback) = 0;
 
+  /// Write a batch of data, to any tables, asynchronously. The entries are written in
+  /// order, so the last write of a key wins.
+  ///
+  /// \param entries The data that will be written.
+  /// \param callback Callback that will be called after all the writes finish.
+  /// \return Status
+  virtual Status AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                               const StatusCallback &callback) = 0;
+
   /// Get data from the given table asynchronously.
   ///
   /// \param table_name The name of the table to be read.
@@ -83,6 +102,28 @@ class StoreClient {
   virtual Status AsyncGetAll(const std::string &table_name,
                              const MapCallback<std::string, std::string> &callback) = 0;
 
+  /// Get all data from the given table asynchronously, a page at a time, so that the
+  /// whole table doesn't have to be held in memory at once. The pages are never
+  /// delivered concurrently, and a key may be delivered in more than one page. By
+  /// default the whole table is delivered as one page.
+  ///
+  /// \param table_name The name of the table to be read.
+  /// \param on_page Callback that will be called with every page of data.
+  /// \param on_done Callback that will be called after the last page.
+  /// \return Status
+  virtual Status AsyncGetAllPaged(const std::string &table_name,
+                                  const MapCallback<std::string, std::string> &on_page,
+                                  const StatusCallback &on_done) {
+    return AsyncGetAll(table_name,
+                       [on_page, on_done](
+                           absl::flat_hash_map<std::string, std::string> &&result) {
+                         if (!result.empty()) {
+                           on_page(std::move(result));
+                         }
+                         on_done(Status::OK());
+                       });
+  }
+
   /// Delete data from the given table asynchronously.
   ///
   /// \param table_name The name of the table from which data is to be deleted.
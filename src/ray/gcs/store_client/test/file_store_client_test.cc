@@ -0,0 +1,191 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/store_client/file_store_client.h"
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+
+#include "ray/gcs/store_client/test/store_client_test_base.h"
+#include "ray/util/filesystem.h"
+
+namespace ray {
+
+namespace gcs {
+
+class FileStoreClientTest : public StoreClientTestBase {
+ public:
+  void InitStoreClient() override {
+    dir_ = JoinPaths(GetUserTempDir(), "gcs_file_store_" + UniqueID::FromRandom().Hex());
+    store_client_ = std::make_shared<FileStoreClient>(*(io_service_pool_->Get()), dir_);
+  }
+
+  void DisconnectStoreClient() override {
+    store_client_.reset();
+    std::filesystem::remove_all(dir_);
+  }
+
+ protected:
+  /// Destroy the store client and create one that recovers from its directory.
+  void Restart() {
+    store_client_.reset();
+    store_client_ = std::make_shared<FileStoreClient>(*(io_service_pool_->Get()), dir_);
+  }
+
+  FileStoreClient &GetFileStoreClient() {
+    return static_cast<FileStoreClient &>(*store_client_);
+  }
+
+  std::string dir_;
+};
+
+TEST_F(FileStoreClientTest, AsyncPutAndAsyncGetTest) { TestAsyncPutAndAsyncGet(); }
+
+TEST_F(FileStoreClientTest, AsyncPutAndDeleteWithIndexTest) {
+  TestAsyncPutAndDeleteWithIndex();
+}
+
+TEST_F(FileStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
+  TestAsyncGetAllAndBatchDelete();
+}
+
+TEST_F(FileStoreClientTest, TestAsyncGetAllPaged) { TestAsyncGetAllPaged(); }
+
+TEST_F(FileStoreClientTest, TestAsyncDeleteWithIndex) { TestAsyncDeleteWithIndex(); }
+
+TEST_F(FileStoreClientTest, TestAsyncBatchDeleteWithIndex) {
+  TestAsyncBatchDeleteWithIndex();
+}
+
+TEST_F(FileStoreClientTest, TestAsyncBatchPutWithIndex) { TestAsyncBatchPutWithIndex(); }
+
+TEST_F(FileStoreClientTest, TestRecoverFromLog) {
+  PutWithIndex();
+  Restart();
+  Get();
+  GetByIndex();
+  DeleteByIndex();
+  Restart();
+  // Every key was deleted by its index.
+  GetEmpty();
+}
+
+TEST_F(FileStoreClientTest, TestRecoverFromSnapshotAndLog) {
+  PutWithIndex();
+  GetFileStoreClient().WriteSnapshot();
+  // These deletes are only in the log written after the snapshot.
+  BatchDeleteWithIndex();
+  Restart();
+  GetEmpty();
+
+  Put();
+  GetFileStoreClient().WriteSnapshot();
+  Restart();
+  Get();
+  GetAll();
+}
+
+TEST_F(FileStoreClientTest, TestRecoverJobCounter) {
+  ASSERT_EQ(store_client_->GetNextJobID(), 1);
+  ASSERT_EQ(store_client_->GetNextJobID(), 2);
+  Restart();
+  ASSERT_EQ(store_client_->GetNextJobID(), 3);
+  GetFileStoreClient().WriteSnapshot();
+  Restart();
+  ASSERT_EQ(store_client_->GetNextJobID(), 4);
+}
+
+TEST_F(FileStoreClientTest, TestTornLogTailIsDropped) {
+  Put();
+  store_client_.reset();
+  {
+    // Append half a record, as if GCS crashed while writing it.
+    std::ofstream log(JoinPaths(dir_, "gcs_storage.log"),
+                      std::ios::binary | std::ios::app);
+    log << std::string("\x40\x00\x00\x00\x12\x34", 6);
+  }
+  store_client_ = std::make_shared<FileStoreClient>(*(io_service_pool_->Get()), dir_);
+  Get();
+  // The store keeps writing after the torn record was dropped.
+  Delete();
+  Restart();
+  GetEmpty();
+}
+
+#ifndef _WIN32
+TEST_F(FileStoreClientTest, TestFailedLogWriteIsTruncated) {
+  Put();
+  const auto log_path = JoinPaths(dir_, "gcs_storage.log");
+  const auto log_size = std::filesystem::file_size(log_path);
+
+  // Limit the size of the files of the process, so that the next write to the log is
+  // cut short, as if the disk filled up.
+  signal(SIGXFSZ, SIG_IGN);
+  struct rlimit old_limit;
+  ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &old_limit), 0);
+  struct rlimit limit = old_limit;
+  limit.rlim_cur = log_size + 16;
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+  std::promise<Status> promise;
+  RAY_CHECK_OK(store_client_->AsyncPut(
+      table_name_, "key", std::string(1024, 'x'),
+      [&promise](const Status &status) { promise.set_value(status); }));
+  const auto status = promise.get_future().get();
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &old_limit), 0);
+  ASSERT_TRUE(status.IsIOError());
+  // The part of the record that was written is truncated.
+  ASSERT_EQ(std::filesystem::file_size(log_path), log_size);
+
+  // The writes after the failed one are recovered.
+  Delete();
+  Restart();
+  GetEmpty();
+}
+#endif
+
+TEST_F(FileStoreClientTest, BenchmarkPutAndRecover) {
+  const size_t num_writes = 20000;
+  BenchmarkPutAndGetAll("file", num_writes);
+
+  auto start = std::chrono::steady_clock::now();
+  Restart();
+  auto recover_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  ++pending_count_;
+  RAY_CHECK_OK(store_client_->AsyncGetAll(
+      "benchmark_table",
+      [this, num_writes](const absl::flat_hash_map<std::string, std::string> &result) {
+        RAY_CHECK(result.size() == num_writes);
+        --pending_count_;
+      }));
+  WaitPendingDone();
+  RAY_LOG(INFO) << "file: recovered " << num_writes << " writes from the log in "
+                << recover_ms << " ms.";
+}
+
+}  // namespace gcs
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,182 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/gcs/store_client/group_commit_store_client.h"
+
+#include <future>
+#include <thread>
+
+#include "ray/gcs/store_client/in_memory_store_client.h"
+#include "ray/gcs/store_client/test/store_client_test_base.h"
+
+namespace ray {
+
+namespace gcs {
+
+/// An in-memory store client that counts the batches written to it, and holds their
+/// callbacks back until they are released.
+class CountingStoreClient : public InMemoryStoreClient {
+ public:
+  explicit CountingStoreClient(instrumented_io_context &main_io_service)
+      : InMemoryStoreClient(main_io_service) {}
+
+  Status AsyncBatchPut(const std::vector<BatchPutEntry> &entries,
+                       const StatusCallback &callback) override {
+    absl::MutexLock lock(&mutex_);
+    batch_sizes_.push_back(entries.size());
+    if (hold_callbacks_) {
+      held_callbacks_.push_back(callback);
+      return InMemoryStoreClient::AsyncBatchPut(entries, nullptr);
+    }
+    return InMemoryStoreClient::AsyncBatchPut(entries, callback);
+  }
+
+  std::vector<size_t> BatchSizes() {
+    absl::MutexLock lock(&mutex_);
+    return batch_sizes_;
+  }
+
+  void HoldCallbacks() {
+    absl::MutexLock lock(&mutex_);
+    hold_callbacks_ = true;
+  }
+
+  void ReleaseCallbacks() {
+    std::vector<StatusCallback> callbacks;
+    {
+      absl::MutexLock lock(&mutex_);
+      callbacks.swap(held_callbacks_);
+      hold_callbacks_ = false;
+    }
+    for (const auto &callback : callbacks) {
+      callback(Status::OK());
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<size_t> batch_sizes_ GUARDED_BY(mutex_);
+  bool hold_callbacks_ GUARDED_BY(mutex_) = false;
+  std::vector<StatusCallback> held_callbacks_ GUARDED_BY(mutex_);
+};
+
+class GroupCommitStoreClientTest : public StoreClientTestBase {
+ public:
+  void InitStoreClient() override {
+    counting_store_client_ =
+        std::make_shared<CountingStoreClient>(*(io_service_pool_->Get()));
+    group_commit_store_client_ = std::make_shared<GroupCommitStoreClient>(
+        counting_store_client_, *(io_service_pool_->Get()), window_us_, max_entries_);
+    store_client_ = group_commit_store_client_;
+  }
+
+  void DisconnectStoreClient() override {}
+
+ protected:
+  int64_t window_us_ = 100 * 1000;
+  size_t max_entries_ = 100;
+  std::shared_ptr<CountingStoreClient> counting_store_client_;
+  std::shared_ptr<GroupCommitStoreClient> group_commit_store_client_;
+};
+
+TEST_F(GroupCommitStoreClientTest, AsyncPutAndAsyncGetTest) {
+  TestAsyncPutAndAsyncGet();
+}
+
+TEST_F(GroupCommitStoreClientTest, AsyncPutAndDeleteWithIndexTest) {
+  TestAsyncPutAndDeleteWithIndex();
+}
+
+TEST_F(GroupCommitStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
+  TestAsyncGetAllAndBatchDelete();
+}
+
+TEST_F(GroupCommitStoreClientTest, TestAsyncGetAllPaged) { TestAsyncGetAllPaged(); }
+
+TEST_F(GroupCommitStoreClientTest, TestAsyncDeleteWithIndex) {
+  TestAsyncDeleteWithIndex();
+}
+
+TEST_F(GroupCommitStoreClientTest, TestAsyncBatchDeleteWithIndex) {
+  TestAsyncBatchDeleteWithIndex();
+}
+
+TEST_F(GroupCommitStoreClientTest, TestAsyncBatchPutWithIndex) {
+  TestAsyncBatchPutWithIndex();
+}
+
+TEST_F(GroupCommitStoreClientTest, TestWritesAreGrouped) {
+  // 250 writes are written as two full batches and one written when its window ends.
+  std::atomic<int> num_done(0);
+  for (int i = 0; i < 250; ++i) {
+    RAY_CHECK_OK(store_client_->AsyncPut(table_name_, std::to_string(i), "value",
+                                         [&num_done](const Status &status) {
+                                           RAY_CHECK_OK(status);
+                                           ++num_done;
+                                         }));
+  }
+  EXPECT_TRUE(WaitForCondition([&num_done]() { return num_done == 250; }, 5000));
+  EXPECT_EQ(counting_store_client_->BatchSizes(), (std::vector<size_t>{100, 100, 50}));
+}
+
+TEST_F(GroupCommitStoreClientTest, TestCallbacksWaitForTheBatch) {
+  counting_store_client_->HoldCallbacks();
+  std::atomic<int> num_done(0);
+  for (int i = 0; i < 10; ++i) {
+    RAY_CHECK_OK(store_client_->AsyncPut(table_name_, std::to_string(i), "value",
+                                         [&num_done](const Status &status) {
+                                           RAY_CHECK_OK(status);
+                                           ++num_done;
+                                         }));
+  }
+  group_commit_store_client_->Flush();
+  EXPECT_EQ(counting_store_client_->BatchSizes(), std::vector<size_t>{10});
+  // The batch is sent, but none of the writes is acknowledged before it is written.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(num_done, 0);
+  counting_store_client_->ReleaseCallbacks();
+  EXPECT_EQ(num_done, 10);
+}
+
+TEST_F(GroupCommitStoreClientTest, TestWritesAreOrderedWithOtherOperations) {
+  // A delete and a get made after a write see the write, although it isn't written
+  // before the window ends.
+  group_commit_store_client_ = std::make_shared<GroupCommitStoreClient>(
+      counting_store_client_, *(io_service_pool_->Get()),
+      /*window_us=*/60 * 1000 * 1000, max_entries_);
+  store_client_ = group_commit_store_client_;
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key", "old", nullptr));
+  RAY_CHECK_OK(store_client_->AsyncDelete(table_name_, "key", nullptr));
+  RAY_CHECK_OK(store_client_->AsyncPut(table_name_, "key", "new", nullptr));
+  std::promise<boost::optional<std::string>> result;
+  RAY_CHECK_OK(store_client_->AsyncGet(
+      table_name_, "key",
+      [&result](const Status &status, const boost::optional<std::string> &data) {
+        RAY_CHECK_OK(status);
+        result.set_value(data);
+      }));
+  auto data = result.get_future().get();
+  ASSERT_TRUE(data);
+  EXPECT_EQ(*data, "new");
+  EXPECT_EQ(counting_store_client_->BatchSizes(), (std::vector<size_t>{1, 1}));
+}
+
+}  // namespace gcs
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -39,12 +39,18 @@ TEST_F(InMemoryStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
   TestAsyncGetAllAndBatchDelete();
 }
 
+TEST_F(InMemoryStoreClientTest, TestAsyncGetAllPaged) { TestAsyncGetAllPaged(); }
+
 TEST_F(InMemoryStoreClientTest, TestAsyncDeleteWithIndex) { TestAsyncDeleteWithIndex(); }
 
 TEST_F(InMemoryStoreClientTest, TestAsyncBatchDeleteWithIndex) {
   TestAsyncBatchDeleteWithIndex();
 }
 
+TEST_F(InMemoryStoreClientTest, TestAsyncBatchPutWithIndex) {
+  TestAsyncBatchPutWithIndex();
+}
+
 }  // namespace gcs
 
 }  // namespace ray
@@ -57,12 +57,20 @@ TEST_F(RedisStoreClientTest, AsyncGetAllAndBatchDeleteTest) {
   TestAsyncGetAllAndBatchDelete();
 }
 
+TEST_F(RedisStoreClientTest, TestAsyncGetAllPaged) { TestAsyncGetAllPaged(); }
+
 TEST_F(RedisStoreClientTest, TestAsyncDeleteWithIndex) { TestAsyncDeleteWithIndex(); }
 
 TEST_F(RedisStoreClientTest, TestAsyncBatchDeleteWithIndex) {
   TestAsyncBatchDeleteWithIndex();
 }
 
+TEST_F(RedisStoreClientTest, TestAsyncBatchPutWithIndex) { TestAsyncBatchPutWithIndex(); }
+
+TEST_F(RedisStoreClientTest, BenchmarkPutAndGetAll) {
+  BenchmarkPutAndGetAll("redis", 20000);
+}
+
 }  // namespace gcs
 
 }  // namespace ray
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <memory>
@@ -141,6 +142,23 @@ class StoreClientTestBase : public ::testing::Test {
     WaitPendingDone();
   }
 
+  void BatchPutWithIndex() {
+    auto put_calllback = [this](const Status &status) {
+      RAY_CHECK_OK(status);
+      --pending_count_;
+    };
+    std::vector<BatchPutEntry> entries;
+    for (const auto &[key, value] : key_to_value_) {
+      // Write a stale value first, to check that the last write of a key wins.
+      entries.push_back(BatchPutEntry{table_name_, key.Binary(), "", ""});
+      entries.push_back(BatchPutEntry{table_name_, key.Binary(), key_to_index_[key].Hex(),
+                                      value.SerializeAsString()});
+    }
+    ++pending_count_;
+    RAY_CHECK_OK(store_client_->AsyncBatchPut(entries, put_calllback));
+    WaitPendingDone();
+  }
+
   void GetByIndex() {
     auto get_calllback =
         [this](const absl::flat_hash_map<std::string, std::string> &result) {
@@ -177,7 +195,7 @@ class StoreClientTestBase : public ::testing::Test {
   void GetAll() {
     auto get_all_callback =
         [this](const absl::flat_hash_map<std::string, std::string> &result) {
-          static std::unordered_set<ActorID> received_keys;
+          std::unordered_set<ActorID> received_keys;
           for (const auto &item : result) {
             const ActorID &actor_id = ActorID::FromBinary(item.first);
             auto it = received_keys.find(actor_id);
@@ -196,6 +214,27 @@ class StoreClientTestBase : public ::testing::Test {
     WaitPendingDone();
   }
 
+  void GetAllPaged() {
+    std::unordered_set<ActorID> received_keys;
+    std::atomic<bool> done(false);
+    auto on_page = [this, &received_keys](
+                       const absl::flat_hash_map<std::string, std::string> &page) {
+      for (const auto &item : page) {
+        const ActorID &actor_id = ActorID::FromBinary(item.first);
+        RAY_CHECK(key_to_value_.contains(actor_id));
+        received_keys.emplace(actor_id);
+      }
+    };
+    auto on_done = [&done](const Status &status) {
+      RAY_CHECK_OK(status);
+      done = true;
+    };
+    RAY_CHECK_OK(store_client_->AsyncGetAllPaged(table_name_, on_page, on_done));
+    EXPECT_TRUE(WaitForCondition([&done]() { return done.load(); },
+                                 wait_pending_timeout_.count()));
+    RAY_CHECK(received_keys.size() == key_to_value_.size());
+  }
+
   void BatchDelete() {
     auto delete_calllback = [this](const Status &status) {
       RAY_CHECK_OK(status);
@@ -289,6 +328,20 @@ class StoreClientTestBase : public ::testing::Test {
     GetEmpty();
   }
 
+  void TestAsyncGetAllPaged() {
+    // AsyncPut
+    Put();
+
+    // AsyncGetAllPaged
+    GetAllPaged();
+
+    // AsyncBatchDelete
+    BatchDelete();
+
+    // AsyncGet
+    GetEmpty();
+  }
+
   void TestAsyncDeleteWithIndex() {
     // AsyncPut with index
     PutWithIndex();
@@ -317,6 +370,62 @@ class StoreClientTestBase : public ::testing::Test {
     GetEmpty();
   }
 
+  void TestAsyncBatchPutWithIndex() {
+    // AsyncBatchPut with index
+    BatchPutWithIndex();
+
+    // AsyncGet
+    Get();
+
+    // AsyncGet with index
+    GetByIndex();
+
+    // AsyncBatchDeleteWithIndex
+    BatchDeleteWithIndex();
+
+    // AsyncGet
+    GetEmpty();
+  }
+
+  /// Write `num_writes` values of the size of an actor table entry, and log the write
+  /// throughput and the time to read them all back, which is what loading a table
+  /// costs when GCS restarts.
+  void BenchmarkPutAndGetAll(const std::string &backend, size_t num_writes) {
+    const std::string table_name = "benchmark_table";
+    const std::string value = key_to_value_.begin()->second.SerializeAsString();
+    auto put_calllback = [this](const Status &status) {
+      RAY_CHECK_OK(status);
+      --pending_count_;
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_writes; ++i) {
+      ++pending_count_;
+      RAY_CHECK_OK(store_client_->AsyncPut(table_name, std::to_string(i), value,
+                                           put_calllback));
+    }
+    WaitPendingDone(pending_count_);
+    auto write_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    start = std::chrono::steady_clock::now();
+    ++pending_count_;
+    RAY_CHECK_OK(store_client_->AsyncGetAll(
+        table_name,
+        [this, num_writes](const absl::flat_hash_map<std::string, std::string> &result) {
+          RAY_CHECK(result.size() == num_writes);
+          --pending_count_;
+        }));
+    WaitPendingDone(pending_count_);
+    auto read_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    RAY_LOG(INFO) << backend << ": " << num_writes << " writes of " << value.size()
+                  << " bytes in " << write_ms << " ms ("
+                  << num_writes * 1000 / std::max<int64_t>(write_ms, 1)
+                  << " writes/s), read back in " << read_ms << " ms.";
+  }
+
   void GenTestData() {
     for (size_t i = 0; i < key_count_; i++) {
       rpc::ActorTableData actor;
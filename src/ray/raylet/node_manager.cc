@@ -14,6 +14,7 @@
 
 #include "ray/raylet/node_manager.h"
 
+#include <algorithm>
 #include <cctype>
 #include <csignal>
 #include <fstream>
@@ -77,6 +78,40 @@ std::vector<ray::rpc::ObjectReference> FlatbufferToObjectReference(
   return refs;
 }
 
+bool ResourceMapEquals(const google::protobuf::Map<std::string, double> &lhs,
+                       const google::protobuf::Map<std::string, double> &rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (const auto &entry : lhs) {
+    auto it = rhs.find(entry.first);
+    if (it == rhs.end() || it->second != entry.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Clear the sections of a resource report that are the same as in the last report,
+/// which GCS keeps when they are left out.
+void OmitUnchangedReportSections(const ray::rpc::ResourcesData &last_report,
+                                 ray::rpc::ResourcesData *report) {
+  if (ResourceMapEquals(report->resources_available(),
+                        last_report.resources_available()) &&
+      report->object_pulls_queued() == last_report.object_pulls_queued()) {
+    report->clear_resources_available();
+    report->clear_object_pulls_queued();
+    report->set_resources_available_changed(false);
+  }
+  if (ResourceMapEquals(report->resources_total(), last_report.resources_total())) {
+    report->clear_resources_total();
+  }
+  if (ResourceMapEquals(report->resource_load(), last_report.resource_load())) {
+    report->clear_resource_load();
+    report->set_resource_load_changed(false);
+  }
+}
+
 }  // namespace
 
 namespace ray {
@@ -307,7 +342,8 @@ NodeManager::NodeManager(instrumented_io_context &io_service, const NodeID &self
       global_gc_throttler_(RayConfig::instance().global_gc_min_interval_s() * 1e9),
       local_gc_interval_ns_(RayConfig::instance().local_gc_interval_s() * 1e9),
       record_metrics_period_ms_(config.record_metrics_period_ms),
-      next_resource_seq_no_(0) {
+      next_resource_seq_no_(0),
+      region_client_pool_(client_call_manager_) {
   RAY_LOG(INFO) << "Initializing NodeManager with ID " << self_node_id_;
   RAY_CHECK(RayConfig::instance().raylet_heartbeat_period_milliseconds() > 0);
   SchedulingResources local_resources(config.resource_config);
@@ -848,6 +884,7 @@ void NodeManager::NodeRemoved(const NodeID &node_id) {
   if (node_entry != remote_node_manager_addresses_.end()) {
     remote_node_manager_addresses_.erase(node_entry);
   }
+  region_client_pool_.Disconnect(node_id);
 
   // Notify the object directory that the node has been removed so that it
   // can remove it from any cached locations.
@@ -1485,23 +1522,35 @@ void NodeManager::HandleUpdateResourceUsage(
   rpc::ResourceUsageBroadcastData resource_usage_batch;
   resource_usage_batch.ParseFromString(request.serialized_resource_usage_batch());
   // When next_resource_seq_no_ == 0 it means it just started.
-  // TODO: Fetch a snapshot from gcs for lightweight resource broadcasting
   if (next_resource_seq_no_ != 0 &&
       resource_usage_batch.seq_no() != next_resource_seq_no_) {
-    // TODO (Alex): Ideally we would be really robust, and potentially eagerly
-    // pull a full resource "snapshot" from gcs to make sure our state doesn't
-    // diverge from GCS.
+    // Missed broadcasts are recovered from, since GCS resends the changes since the
+    // version of its resource view we acknowledged, or a snapshot of it.
     RAY_LOG(WARNING)
         << "Raylet may have missed a resource broadcast. This either means that GCS has "
            "restarted, the network is heavily congested and is dropping, reordering, or "
            "duplicating packets. Expected seq#: "
         << next_resource_seq_no_ << ", but got: " << resource_usage_batch.seq_no() << ".";
-    if (resource_usage_batch.seq_no() < next_resource_seq_no_) {
+    // Snapshots are always applied, since they are sent whenever the sequence of
+    // broadcasts changes, e.g. when another raylet starts forwarding them to us.
+    if (resource_usage_batch.seq_no() < next_resource_seq_no_ &&
+        !resource_usage_batch.is_snapshot()) {
       RAY_LOG(WARNING) << "Discard the the resource update since local version is newer";
+      reply->set_resource_view_version(resource_view_version_);
+      send_reply_callback(Status::OK(), nullptr, nullptr);
       return;
     }
   }
   next_resource_seq_no_ = resource_usage_batch.seq_no() + 1;
+  // A batch of changes only brings our view up to date if it already includes the
+  // changes the batch is relative to. Otherwise we keep acknowledging the version we
+  // have, so that GCS resends the missing changes.
+  if (resource_usage_batch.is_snapshot()) {
+    resource_view_version_ = resource_usage_batch.version();
+  } else if (resource_usage_batch.base_version() <= resource_view_version_) {
+    resource_view_version_ =
+        std::max(resource_view_version_, resource_usage_batch.version());
+  }
 
   for (const auto &resource_change_or_data : resource_usage_batch.batch()) {
     if (resource_change_or_data.has_data()) {
@@ -1526,9 +1575,68 @@ void NodeManager::HandleUpdateResourceUsage(
       }
     }
   }
+  if (resource_usage_batch.forward_to_size() > 0) {
+    ForwardResourceUsage(std::move(resource_usage_batch), reply, send_reply_callback);
+    return;
+  }
+  reply->set_resource_view_version(resource_view_version_);
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
+void NodeManager::ForwardResourceUsage(
+    rpc::ResourceUsageBroadcastData resource_usage_batch,
+    rpc::UpdateResourceUsageReply *reply, rpc::SendReplyCallback send_reply_callback) {
+  google::protobuf::RepeatedPtrField<rpc::Address> forward_to;
+  forward_to.Swap(resource_usage_batch.mutable_forward_to());
+  auto serialized_batch =
+      std::make_shared<std::string>(resource_usage_batch.SerializeAsString());
+  auto num_pending = std::make_shared<int>(forward_to.size());
+  auto region_version = std::make_shared<int64_t>(resource_view_version_);
+  // The members that don't reply in time are treated as failed, so that a hung member
+  // doesn't hold back the region.
+  auto replied = std::make_shared<bool>(false);
+  auto timer = execute_after(
+      io_service_,
+      [num_pending, replied, reply, send_reply_callback]() {
+        if (*replied) {
+          return;
+        }
+        RAY_LOG(DEBUG) << *num_pending
+                       << " region members didn't apply the resource broadcast in time.";
+        *replied = true;
+        reply->set_resource_view_version(0);
+        send_reply_callback(Status::OK(), nullptr, nullptr);
+      },
+      RayConfig::instance().resource_dissemination_member_timeout_ms());
+  for (const auto &address : forward_to) {
+    auto node_id = NodeID::FromBinary(address.raylet_id());
+    auto client = region_client_pool_.GetOrConnectByAddress(address);
+    client->UpdateResourceUsage(
+        *serialized_batch,
+        [serialized_batch, num_pending, region_version, replied, timer, node_id, reply,
+         send_reply_callback](const Status &status,
+                              const rpc::UpdateResourceUsageReply &member_reply) {
+          if (!status.ok()) {
+            RAY_LOG(DEBUG) << "Failed to forward the resource broadcast to node "
+                           << node_id << ": " << status.ToString();
+          }
+          if (*replied) {
+            return;
+          }
+          // A member that didn't apply the broadcast holds the region back, so that
+          // GCS resends the changes it missed.
+          *region_version = std::min(
+              *region_version, status.ok() ? member_reply.resource_view_version() : 0);
+          if (--*num_pending == 0) {
+            *replied = true;
+            timer->cancel();
+            reply->set_resource_view_version(*region_version);
+            send_reply_callback(Status::OK(), nullptr, nullptr);
+          }
+        });
+  }
+}
+
 void NodeManager::HandleRequestResourceReport(
     const rpc::RequestResourceReportRequest &request,
     rpc::RequestResourceReportReply *reply, rpc::SendReplyCallback send_reply_callback) {
@@ -1536,7 +1644,67 @@ void NodeManager::HandleRequestResourceReport(
   FillResourceReport(*resources_data);
   resources_data->set_cluster_full_of_actors_detected(resource_deadlock_warned_ >= 1);
 
-  send_reply_callback(Status::OK(), nullptr, nullptr);
+  rpc::ResourcesData full_report = *resources_data;
+  // GCS already has the sections of our last report that didn't change since.
+  if (request.known_version() != 0 &&
+      request.known_version() == resource_report_version_) {
+    OmitUnchangedReportSections(last_resource_report_, resources_data);
+  }
+  last_resource_report_.Swap(&full_report);
+  reply->set_version(++resource_report_version_);
+
+  if (request.region_members_size() == 0) {
+    send_reply_callback(Status::OK(), nullptr, nullptr);
+    return;
+  }
+  // We aggregate the resources of our region, so pull the reports of the rest of it
+  // and reply with them all. A member that can't be pulled from, or doesn't reply in
+  // time, is left with an empty report, which GCS follows up with a full pull.
+  auto num_pending = std::make_shared<int>(request.region_members_size());
+  for (int i = 0; i < request.region_members_size(); i++) {
+    reply->add_region_reports();
+  }
+  auto replied = std::make_shared<bool>(false);
+  auto timer = execute_after(
+      io_service_,
+      [num_pending, replied, send_reply_callback]() {
+        if (*replied) {
+          return;
+        }
+        RAY_LOG(DEBUG) << *num_pending
+                       << " region members didn't send their resource reports in time.";
+        *replied = true;
+        send_reply_callback(Status::OK(), nullptr, nullptr);
+      },
+      RayConfig::instance().resource_dissemination_member_timeout_ms());
+  for (int i = 0; i < request.region_members_size(); i++) {
+    const auto &member = request.region_members(i);
+    rpc::RequestResourceReportRequest member_request;
+    member_request.set_known_version(member.known_version());
+    auto node_id = NodeID::FromBinary(member.address().raylet_id());
+    auto client = region_client_pool_.GetOrConnectByAddress(member.address());
+    client->RequestResourceReport(
+        member_request,
+        [i, num_pending, replied, timer, node_id, reply, send_reply_callback](
+            const Status &status, const rpc::RequestResourceReportReply &member_reply) {
+          if (!status.ok()) {
+            RAY_LOG(DEBUG) << "Failed to pull the resource report of node " << node_id
+                           << ": " << status.ToString();
+          }
+          // The reply may be gone once it's sent.
+          if (*replied) {
+            return;
+          }
+          if (status.ok()) {
+            reply->mutable_region_reports(i)->CopyFrom(member_reply);
+          }
+          if (--*num_pending == 0) {
+            *replied = true;
+            timer->cancel();
+            send_reply_callback(Status::OK(), nullptr, nullptr);
+          }
+        });
+  }
 }
 
 void NodeManager::HandleReportWorkerBacklog(
@@ -1615,6 +1783,19 @@ void NodeManager::HandleRequestWorkerLease(const rpc::RequestWorkerLeaseRequest
                                               reply, send_reply_callback_wrapper);
 }
 
+void NodeManager::HandleRequestWorkerLeases(
+    const rpc::RequestWorkerLeasesRequest &request, rpc::RequestWorkerLeasesReply *reply,
+    rpc::SendReplyCallback send_reply_callback) {
+  worker_lease_batches_.HandleBatch(
+      request, reply, std::move(send_reply_callback),
+      [this](const rpc::RequestWorkerLeaseRequest &lease_request,
+             rpc::RequestWorkerLeaseReply *lease_reply,
+             rpc::SendReplyCallback send_lease_reply_callback) {
+        HandleRequestWorkerLease(lease_request, lease_reply,
+                                 std::move(send_lease_reply_callback));
+      });
+}
+
 void NodeManager::HandlePrepareBundleResources(
     const rpc::PrepareBundleResourcesRequest &request,
     rpc::PrepareBundleResourcesReply *reply, rpc::SendReplyCallback send_reply_callback) {
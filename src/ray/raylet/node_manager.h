@@ -15,9 +15,11 @@
 #pragma once
 
 // clang-format off
+#include "ray/rpc/batched_request_handler.h"
 #include "ray/rpc/grpc_client.h"
 #include "ray/rpc/node_manager/node_manager_server.h"
 #include "ray/rpc/node_manager/node_manager_client.h"
+#include "ray/rpc/node_manager/node_manager_client_pool.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task.h"
 #include "ray/common/ray_object.h"
@@ -466,6 +468,12 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
                                  rpc::UpdateResourceUsageReply *reply,
                                  rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Forward a resource broadcast to the rest of the region we aggregate resources
+  /// for, and reply with the oldest version of the resource view the region applied.
+  void ForwardResourceUsage(rpc::ResourceUsageBroadcastData resource_usage_batch,
+                            rpc::UpdateResourceUsageReply *reply,
+                            rpc::SendReplyCallback send_reply_callback);
+
   /// Handle a `RequestResourceReport` request.
   void HandleRequestResourceReport(const rpc::RequestResourceReportRequest &request,
                                    rpc::RequestResourceReportReply *reply,
@@ -491,6 +499,13 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
                                 rpc::RequestWorkerLeaseReply *reply,
                                 rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Handle a `WorkerLeases` request. Every lease of the batch is handled like it was
+  /// requested on its own. The batch is replied to as soon as any of its leases is, and
+  /// the caller then polls for the replies to the rest of the leases.
+  void HandleRequestWorkerLeases(const rpc::RequestWorkerLeasesRequest &request,
+                                 rpc::RequestWorkerLeasesReply *reply,
+                                 rpc::SendReplyCallback send_reply_callback) override;
+
   /// Handle a `ReportWorkerBacklog` request.
   void HandleReportWorkerBacklog(const rpc::ReportWorkerBacklogRequest &request,
                                  rpc::ReportWorkerBacklogReply *reply,
@@ -717,6 +732,12 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   std::shared_ptr<LocalTaskManager> local_task_manager_;
   std::shared_ptr<ClusterTaskManagerInterface> cluster_task_manager_;
 
+  /// The `RequestWorkerLeases` batches whose leases haven't all been replied to yet.
+  rpc::BatchedRequestHandler<rpc::RequestWorkerLeaseRequest, rpc::RequestWorkerLeaseReply,
+                             rpc::RequestWorkerLeasesRequest,
+                             rpc::RequestWorkerLeasesReply>
+      worker_lease_batches_;
+
   absl::flat_hash_map<ObjectID, std::unique_ptr<RayObject>> pinned_objects_;
 
   // TODO(swang): Evict entries from these caches.
@@ -755,6 +776,16 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// indicate network issues (dropped/duplicated/ooo packets, etc).
   int64_t next_resource_seq_no_;
 
+  /// The version of the resource view of GCS that we have applied.
+  int64_t resource_view_version_ = 0;
+
+  /// The version of the last resource report pulled by GCS, and the report itself.
+  int64_t resource_report_version_ = 0;
+  rpc::ResourcesData last_resource_report_;
+
+  /// Clients of the other raylets of the region we aggregate resources for.
+  rpc::NodeManagerClientPool region_client_pool_;
+
   /// Whether or not if the node draining process has already received.
   bool is_node_drained_ = false;
 };
@@ -14,6 +14,8 @@
 
 #include "ray/raylet/scheduling/cluster_resource_data.h"
 
+#include <algorithm>
+
 #include "ray/common/bundle_spec.h"
 #include "ray/common/task/scheduling_resources.h"
 
@@ -424,6 +426,55 @@ bool NodeResources::HasGPU() const {
   return predefined_resources[GPU].total > 0;
 }
 
+PackedResourceRequest::PackedResourceRequest(const ResourceRequest &resource_request)
+    : requires_object_store_memory(resource_request.requires_object_store_memory),
+      is_empty(resource_request.IsEmpty()) {
+  for (size_t i = 0;
+       i < PredefinedResources_MAX && i < resource_request.predefined_resources.size();
+       i++) {
+    predefined_resources[i] = resource_request.predefined_resources[i].Raw();
+  }
+  std::vector<std::pair<int64_t, int64_t>> custom;
+  custom.reserve(resource_request.custom_resources.size());
+  for (const auto &entry : resource_request.custom_resources) {
+    custom.emplace_back(entry.first, entry.second.Raw());
+  }
+  std::sort(custom.begin(), custom.end());
+  custom_resource_ids.reserve(custom.size());
+  custom_resources.reserve(custom.size());
+  for (const auto &entry : custom) {
+    custom_resource_ids.push_back(entry.first);
+    custom_resources.push_back(entry.second);
+  }
+}
+
+PackedNodeResources::PackedNodeResources(const NodeResources &node_resources)
+    : object_pulls_queued(node_resources.object_pulls_queued),
+      critical_resource_utilization(
+          node_resources.CalculateCriticalResourceUtilization()) {
+  for (size_t i = 0;
+       i < PredefinedResources_MAX && i < node_resources.predefined_resources.size();
+       i++) {
+    available[i] = node_resources.predefined_resources[i].available.Raw();
+    total[i] = node_resources.predefined_resources[i].total.Raw();
+  }
+  std::vector<std::pair<int64_t, const ResourceCapacity *>> custom;
+  custom.reserve(node_resources.custom_resources.size());
+  for (const auto &entry : node_resources.custom_resources) {
+    custom.emplace_back(entry.first, &entry.second);
+  }
+  std::sort(custom.begin(), custom.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  custom_resource_ids.reserve(custom.size());
+  custom_available.reserve(custom.size());
+  custom_total.reserve(custom.size());
+  for (const auto &entry : custom) {
+    custom_resource_ids.push_back(entry.first);
+    custom_available.push_back(entry.second->available.Raw());
+    custom_total.push_back(entry.second->total.Raw());
+  }
+}
+
 bool NodeResourceInstances::operator==(const NodeResourceInstances &other) {
   for (size_t i = 0; i < PredefinedResources_MAX; i++) {
     if (!EqualVectors(this->predefined_resources[i].total,
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <array>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -177,6 +178,111 @@ class NodeResources {
   bool HasGPU() const;
 };
 
+/// A compact copy of a resource request, laid out so that it can be checked against
+/// `PackedNodeResources` with a few vector instructions: the predefined resources are
+/// a fixed-width array of raw fixed point values, and the custom resources are sorted
+/// by ID.
+class PackedResourceRequest {
+ public:
+  PackedResourceRequest() {}
+  explicit PackedResourceRequest(const ResourceRequest &resource_request);
+
+  alignas(32) std::array<int64_t, PredefinedResources_MAX> predefined_resources{};
+  /// IDs of the requested custom resources, in ascending order.
+  std::vector<int64_t> custom_resource_ids;
+  /// Demand for each resource of `custom_resource_ids`.
+  std::vector<int64_t> custom_resources;
+  bool requires_object_store_memory = false;
+  bool is_empty = true;
+};
+
+/// A compact copy of `NodeResources` in structure-of-arrays layout. Checking a request
+/// against it gives the same answer as `NodeResources`, but costs a few nanoseconds
+/// instead of a walk over vectors and hash maps. The critical resource utilization is
+/// computed once, when the copy is made.
+class PackedNodeResources {
+ public:
+  PackedNodeResources() {}
+  explicit PackedNodeResources(const NodeResources &node_resources);
+
+  alignas(32) std::array<int64_t, PredefinedResources_MAX> available{};
+  alignas(32) std::array<int64_t, PredefinedResources_MAX> total{};
+  /// IDs of the custom resources of the node, in ascending order.
+  std::vector<int64_t> custom_resource_ids;
+  /// Available and total capacity of each resource of `custom_resource_ids`.
+  std::vector<int64_t> custom_available;
+  std::vector<int64_t> custom_total;
+  bool object_pulls_queued = false;
+  float critical_resource_utilization = 0;
+
+  /// Same as `NodeResources::IsAvailable`.
+  bool IsAvailable(const PackedResourceRequest &resource_request,
+                   bool ignore_pull_manager_at_capacity = false) const;
+  /// Same as `NodeResources::IsFeasible`.
+  bool IsFeasible(const PackedResourceRequest &resource_request) const;
+  /// Same as `NodeResources::HasGPU`.
+  bool HasGPU() const { return total[GPU] > 0; }
+
+ private:
+  /// Whether the capacities cover the demand of every requested resource.
+  static bool Covers(const std::array<int64_t, PredefinedResources_MAX> &capacities,
+                     const std::vector<int64_t> &custom_capacities,
+                     const std::vector<int64_t> &custom_resource_ids,
+                     const PackedResourceRequest &resource_request);
+};
+
+// The checks are defined here so that they are inlined into the loops over nodes.
+inline bool PackedNodeResources::Covers(
+    const std::array<int64_t, PredefinedResources_MAX> &capacities,
+    const std::vector<int64_t> &custom_capacities,
+    const std::vector<int64_t> &custom_resource_ids,
+    const PackedResourceRequest &resource_request) {
+  // No branches over the predefined resources, so that the compiler can vectorize the
+  // comparisons.
+  int64_t num_short = 0;
+  for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+    num_short += capacities[i] < resource_request.predefined_resources[i];
+  }
+  if (num_short != 0) {
+    return false;
+  }
+
+  // Both lists of custom resources are sorted by ID, so one pass merges them.
+  const auto &request_ids = resource_request.custom_resource_ids;
+  size_t j = 0;
+  for (size_t i = 0; i < request_ids.size(); i++) {
+    while (j < custom_resource_ids.size() && custom_resource_ids[j] < request_ids[i]) {
+      j++;
+    }
+    if (j == custom_resource_ids.size() || custom_resource_ids[j] != request_ids[i] ||
+        custom_capacities[j] < resource_request.custom_resources[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline bool PackedNodeResources::IsAvailable(
+    const PackedResourceRequest &resource_request,
+    bool ignore_pull_manager_at_capacity) const {
+  if (!ignore_pull_manager_at_capacity &&
+      resource_request.requires_object_store_memory && object_pulls_queued) {
+    return false;
+  }
+  if (resource_request.is_empty) {
+    return true;
+  }
+  return Covers(available, custom_available, custom_resource_ids, resource_request);
+}
+
+inline bool PackedNodeResources::IsFeasible(
+    const PackedResourceRequest &resource_request) const {
+  if (resource_request.is_empty) {
+    return true;
+  }
+  return Covers(total, custom_total, custom_resource_ids, resource_request);
+}
+
 /// Total and available capacities of each resource instance.
 /// This is used to describe the resources of the local node.
 class NodeResourceInstances {
@@ -201,10 +307,17 @@ class NodeResourceInstances {
 struct Node {
   Node(const NodeResources &resources) : local_view_(resources) {}
 
-  NodeResources *GetMutableLocalView() { return &local_view_; }
+  NodeResources *GetMutableLocalView() {
+    local_view_version_++;
+    return &local_view_;
+  }
 
   const NodeResources &GetLocalView() const { return local_view_; }
 
+  /// The number of times the local view has been handed out for modification, so
+  /// that a copy of it can tell whether it is stale.
+  uint64_t GetLocalViewVersion() const { return local_view_version_; }
+
  private:
   /// Our local view of the remote node's resources. This may be dirty
   /// because it includes any resource requests that we allocated to this
@@ -213,6 +326,7 @@ struct Node {
   /// make sure that our local view does not skew too much from the actual
   /// resources when light heartbeats are enabled.
   NodeResources local_view_;
+  uint64_t local_view_version_ = 0;
 };
 
 /// \request Conversion result to a ResourceRequest data structure.
@@ -22,7 +22,8 @@
 
 namespace ray {
 
-ClusterResourceManager::ClusterResourceManager() : nodes_{} {}
+ClusterResourceManager::ClusterResourceManager()
+    : nodes_{}, node_index_(RayConfig::instance().scheduler_spread_threshold()) {}
 
 void ClusterResourceManager::AddOrUpdateNode(
     scheduling::NodeID node_id,
@@ -45,6 +46,7 @@ void ClusterResourceManager::AddOrUpdateNode(scheduling::NodeID node_id,
     // This node exists, so update its resources.
     it->second = Node(node_resources);
   }
+  node_index_.AddOrUpdateNode(node_id, node_resources);
 }
 
 bool ClusterResourceManager::UpdateNode(scheduling::NodeID node_id,
@@ -93,6 +95,7 @@ bool ClusterResourceManager::RemoveNode(scheduling::NodeID node_id) {
     return false;
   } else {
     nodes_.erase(it);
+    node_index_.RemoveNode(node_id);
     return true;
   }
 }
@@ -158,6 +161,7 @@ void ClusterResourceManager::UpdateResourceCapacity(scheduling::NodeID node_id,
       local_view->custom_resources.emplace(resource_id.ToInt(), resource_capacity);
     }
   }
+  node_index_.AddOrUpdateNode(node_id, *local_view);
 }
 
 void ClusterResourceManager::DeleteResource(scheduling::NodeID node_id,
@@ -179,6 +183,7 @@ void ClusterResourceManager::DeleteResource(scheduling::NodeID node_id,
       local_view->custom_resources.erase(itr);
     }
   }
+  node_index_.AddOrUpdateNode(node_id, *local_view);
 }
 
 std::string ClusterResourceManager::GetNodeResourceViewString(
@@ -196,6 +201,10 @@ const absl::flat_hash_map<scheduling::NodeID, Node>
   return nodes_;
 }
 
+const NodeResourceIndex &ClusterResourceManager::GetNodeIndex() const {
+  return node_index_;
+}
+
 bool ClusterResourceManager::SubtractNodeAvailableResources(
     scheduling::NodeID node_id, const ResourceRequest &resource_request) {
   auto it = nodes_.find(node_id);
@@ -225,9 +234,59 @@ bool ClusterResourceManager::SubtractNodeAvailableResources(
   // arguments. Right now we do not modify object_pulls_queued in case of
   // performance regressions in spillback.
 
+  node_index_.AddOrUpdateNode(node_id, *resources);
   return true;
 }
 
+int64_t ClusterResourceManager::BulkSubtractNodeAvailableResources(
+    scheduling::NodeID node_id, const ResourceRequest &resource_request,
+    int64_t max_requests) {
+  if (max_requests <= 0 || !HasSufficientResource(node_id, resource_request,
+                                                  /*ignore_object_store_memory_requirement*/
+                                                  false)) {
+    return 0;
+  }
+  NodeResources *resources = nodes_.at(node_id).GetMutableLocalView();
+
+  // The number of copies that fit is limited by every requested resource.
+  int64_t num_requests = max_requests;
+  auto limit_by = [&num_requests](const FixedPoint &available, const FixedPoint &demand) {
+    if (demand <= FixedPoint(0)) {
+      return;
+    }
+    // Start from the floating point estimate and correct it with exact arithmetic.
+    num_requests = std::min(
+        num_requests, static_cast<int64_t>(available.Double() / demand.Double()) + 1);
+    while (num_requests > 0 && demand * num_requests > available) {
+      num_requests--;
+    }
+  };
+  for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+    limit_by(resources->predefined_resources[i].available,
+             resource_request.predefined_resources[i]);
+  }
+  for (const auto &task_req_custom_resource : resource_request.custom_resources) {
+    auto it = resources->custom_resources.find(task_req_custom_resource.first);
+    if (it != resources->custom_resources.end()) {
+      limit_by(it->second.available, task_req_custom_resource.second);
+    }
+  }
+
+  for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+    resources->predefined_resources[i].available -=
+        resource_request.predefined_resources[i] * num_requests;
+  }
+  for (const auto &task_req_custom_resource : resource_request.custom_resources) {
+    auto it = resources->custom_resources.find(task_req_custom_resource.first);
+    if (it != resources->custom_resources.end()) {
+      it->second.available -= task_req_custom_resource.second * num_requests;
+    }
+  }
+
+  node_index_.AddOrUpdateNode(node_id, *resources);
+  return num_requests;
+}
+
 bool ClusterResourceManager::HasSufficientResource(
     scheduling::NodeID node_id, const ResourceRequest &resource_request,
     bool ignore_object_store_memory_requirement) const {
@@ -25,6 +25,7 @@
 #include "ray/raylet/scheduling/cluster_resource_data.h"
 #include "ray/raylet/scheduling/fixed_point.h"
 #include "ray/raylet/scheduling/local_resource_manager.h"
+#include "ray/raylet/scheduling/node_resource_index.h"
 #include "ray/util/logging.h"
 #include "src/ray/protobuf/gcs.pb.h"
 
@@ -42,6 +43,10 @@ class ClusterResourceManager {
   /// Get the resource view of the cluster.
   const absl::flat_hash_map<scheduling::NodeID, Node> &GetResourceView() const;
 
+  /// Get the index over the resource view of the cluster, which is kept in sync with
+  /// it.
+  const NodeResourceIndex &GetNodeIndex() const;
+
   // Mapping from predefined resource indexes to resource strings
   std::string GetResourceNameFromIndex(int64_t res_idx);
 
@@ -85,6 +90,17 @@ class ClusterResourceManager {
   bool SubtractNodeAvailableResources(scheduling::NodeID node_id,
                                       const ResourceRequest &resource_request);
 
+  /// Subtract the resources of up to `max_requests` copies of a resource request from a
+  /// given node, as many copies as the node has available.
+  ///
+  /// \param node_id: the id of the node.
+  /// \param resource_request: the request of every copy.
+  /// \param max_requests: the maximum number of copies to subtract.
+  /// \return the number of copies subtracted.
+  int64_t BulkSubtractNodeAvailableResources(scheduling::NodeID node_id,
+                                             const ResourceRequest &resource_request,
+                                             int64_t max_requests);
+
   /// Check if we have sufficient resource to fullfill resource request for an given node.
   ///
   /// \param node_id: the id of the node.
@@ -119,8 +135,12 @@ class ClusterResourceManager {
   /// The key of the map is the node ID.
   absl::flat_hash_map<scheduling::NodeID, Node> nodes_;
 
+  /// Index over `nodes_`. Must be updated on every change to the resources of a node.
+  NodeResourceIndex node_index_;
+
   friend class ClusterResourceSchedulerTest;
   friend struct ClusterResourceManagerTest;
+  FRIEND_TEST(ClusterResourceManagerTest, BulkSubtractNodeAvailableResourcesTest);
   friend class raylet::ClusterTaskManagerTest;
   FRIEND_TEST(ClusterResourceSchedulerTest, SchedulingDeleteClusterNodeTest);
   FRIEND_TEST(ClusterResourceSchedulerTest, SchedulingModifyClusterNodeTest);
@@ -85,4 +85,29 @@ TEST_F(ClusterResourceManagerTest, HasSufficientResourceTest) {
                                    /*requires_object_store_memory=*/true),
       /*ignore_object_store_memory_requirement*/ true));
 }
+
+TEST_F(ClusterResourceManagerTest, BulkSubtractNodeAvailableResourcesTest) {
+  manager->AddOrUpdateNode(
+      node3, CreateNodeResources(/*available_cpu*/ 1, /*total_cpu*/ 1,
+                                 /*available_custom*/ 10, /*total_custom*/ 10));
+  auto request = ResourceMapToResourceRequest({{"CPU", 0.3}, {"CUSTOM", 2}},
+                                              /*requires_object_store_memory=*/false);
+  // The CPU limits the node to 3 copies, even though it has CUSTOM for 5.
+  ASSERT_EQ(manager->BulkSubtractNodeAvailableResources(node3, request, 10), 3);
+  const auto &resources = manager->GetNodeResources(node3);
+  ASSERT_EQ(resources.predefined_resources[CPU].available, FixedPoint(0.1));
+  ASSERT_EQ(resources.custom_resources.at(scheduling::ResourceID("CUSTOM").ToInt())
+                .available,
+            FixedPoint(4));
+  ASSERT_EQ(manager->BulkSubtractNodeAvailableResources(node3, request, 10), 0);
+  // Nodes waiting for object pulls don't take requests that need object store memory.
+  ASSERT_EQ(manager->BulkSubtractNodeAvailableResources(
+                node2,
+                ResourceMapToResourceRequest({{"CPU", 1}},
+                                             /*requires_object_store_memory=*/true),
+                10),
+            0);
+  ASSERT_EQ(manager->BulkSubtractNodeAvailableResources(node0, request, 0), 0);
+}
+
 }  // namespace ray
@@ -37,7 +37,8 @@ ClusterResourceScheduler::ClusterResourceScheduler()
   scheduling_policy_ =
       std::make_unique<raylet_scheduling_policy::CompositeSchedulingPolicy>(
           local_node_id_, cluster_resource_manager_->GetResourceView(),
-          [this](auto node_id) { return this->NodeAlive(node_id); });
+          [this](auto node_id) { return this->NodeAlive(node_id); },
+          &cluster_resource_manager_->GetNodeIndex());
 }
 
 ClusterResourceScheduler::ClusterResourceScheduler(
@@ -55,7 +56,8 @@ ClusterResourceScheduler::ClusterResourceScheduler(
   scheduling_policy_ =
       std::make_unique<raylet_scheduling_policy::CompositeSchedulingPolicy>(
           local_node_id_, cluster_resource_manager_->GetResourceView(),
-          [this](auto node_id) { return this->NodeAlive(node_id); });
+          [this](auto node_id) { return this->NodeAlive(node_id); },
+          &cluster_resource_manager_->GetNodeIndex());
 }
 
 ClusterResourceScheduler::ClusterResourceScheduler(
@@ -76,7 +78,8 @@ ClusterResourceScheduler::ClusterResourceScheduler(
   scheduling_policy_ =
       std::make_unique<raylet_scheduling_policy::CompositeSchedulingPolicy>(
           local_node_id_, cluster_resource_manager_->GetResourceView(),
-          [this](auto node_id) { return this->NodeAlive(node_id); });
+          [this](auto node_id) { return this->NodeAlive(node_id); },
+          &cluster_resource_manager_->GetNodeIndex());
 }
 
 bool ClusterResourceScheduler::NodeAlive(scheduling::NodeID node_id) const {
@@ -180,6 +183,16 @@ bool ClusterResourceScheduler::AllocateRemoteTaskResources(
   return SubtractRemoteNodeAvailableResources(node_id, resource_request);
 }
 
+int64_t ClusterResourceScheduler::AllocateRemoteTaskResources(
+    scheduling::NodeID node_id,
+    const absl::flat_hash_map<std::string, double> &task_resources, int64_t num_tasks) {
+  ResourceRequest resource_request = ResourceMapToResourceRequest(
+      task_resources, /*requires_object_store_memory=*/false);
+  RAY_CHECK(node_id != local_node_id_);
+  return cluster_resource_manager_->BulkSubtractNodeAvailableResources(
+      node_id, resource_request, num_tasks);
+}
+
 bool ClusterResourceScheduler::IsSchedulableOnNode(
     scheduling::NodeID node_id, const absl::flat_hash_map<std::string, double> &shape) {
   auto resource_request =
@@ -207,4 +220,35 @@ scheduling::NodeID ClusterResourceScheduler::GetBestSchedulableNode(
       task_spec.IsActorCreationTask(), exclude_local_node, &_unused, is_infeasible);
 }
 
+bool ClusterResourceScheduler::IsBatchSchedulable(
+    const TaskSpecification &task_spec) const {
+  // Actor creation tasks are placed by their placement resources but checked against
+  // the local node by their required resources, and spread scheduling deliberately
+  // doesn't follow the resources reserved by previous decisions.
+  return !task_spec.IsActorCreationTask() &&
+         task_spec.GetMessage().scheduling_strategy().scheduling_strategy_case() !=
+             rpc::SchedulingStrategy::SchedulingStrategyCase::kSpreadSchedulingStrategy;
+}
+
+std::vector<std::pair<scheduling::NodeID, int64_t>>
+ClusterResourceScheduler::GetBestSchedulableNodes(const TaskSpecification &task_spec,
+                                                  int64_t num_tasks,
+                                                  bool prioritize_local_node,
+                                                  bool *is_infeasible) {
+  RAY_CHECK(IsBatchSchedulable(task_spec));
+  ResourceRequest resource_request = ResourceMapToResourceRequest(
+      task_spec.GetRequiredResources().GetResourceMap(),
+      /*requires_object_store_memory=*/false);
+  auto placements = scheduling_policy_->ScheduleBatch(
+      resource_request, num_tasks,
+      SchedulingOptions::Hybrid(/*avoid_local_node*/ false,
+                                /*require_node_available*/ false),
+      prioritize_local_node);
+  *is_infeasible = placements.empty();
+  RAY_LOG(DEBUG) << "Batch scheduling decision for " << num_tasks << " tasks of "
+                 << task_spec.GetSchedulingClass() << ": " << placements.size()
+                 << " nodes, is infeasible: " << *is_infeasible;
+  return placements;
+}
+
 }  // namespace ray
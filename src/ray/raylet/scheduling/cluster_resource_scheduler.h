@@ -81,6 +81,28 @@ class ClusterResourceScheduler {
                                             bool requires_object_store_memory,
                                             bool *is_infeasible);
 
+  /// Find the nodes to schedule a batch of tasks of the same scheduling class on, in one
+  /// pass over the cluster. The tasks are placed as if `GetBestSchedulableNode` was
+  /// called for each of them in turn, with the resources of every task reserved on its
+  /// node before the next call. Must only be called for tasks for which
+  /// `IsBatchSchedulable` is true.
+  ///
+  ///  \param task_spec: A task of the batch.
+  ///  \param num_tasks: The number of tasks in the batch.
+  ///  \param prioritize_local_node: true if we want to try out local node first.
+  ///  \param is_infeasible[out]: It is set true if the tasks are not schedulable because
+  ///  they are infeasible.
+  ///
+  ///  \return The number of tasks to schedule on each node, in the order the nodes were
+  ///  picked. The counts add up to less than `num_tasks` if the rest of the tasks can't
+  ///  be scheduled right now.
+  std::vector<std::pair<scheduling::NodeID, int64_t>> GetBestSchedulableNodes(
+      const TaskSpecification &task_spec, int64_t num_tasks, bool prioritize_local_node,
+      bool *is_infeasible);
+
+  /// Whether tasks like the given one can be scheduled with `GetBestSchedulableNodes`.
+  bool IsBatchSchedulable(const TaskSpecification &task_spec) const;
+
   /// Subtract the resources required by a given resource request (resource_request) from
   /// a given remote node.
   ///
@@ -92,6 +114,18 @@ class ClusterResourceScheduler {
       scheduling::NodeID node_id,
       const absl::flat_hash_map<std::string, double> &resource_request);
 
+  /// Subtract the resources required by up to `num_tasks` copies of a resource request
+  /// from a given remote node, as many as the node has available.
+  ///
+  /// \param node_id Remote node whose resources we allocate.
+  /// \param resource_request Task for which we allocate resources.
+  /// \param num_tasks The number of copies of the task.
+  /// \return The number of copies the remote node had enough resources for.
+  int64_t AllocateRemoteTaskResources(
+      scheduling::NodeID node_id,
+      const absl::flat_hash_map<std::string, double> &resource_request,
+      int64_t num_tasks);
+
   /// Return human-readable string for this scheduler state.
   std::string DebugString() const;
 
@@ -15,6 +15,8 @@
 // clang-format off
 #include "ray/raylet/scheduling/cluster_resource_scheduler.h"
 
+#include <chrono>
+#include <random>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -1583,6 +1585,115 @@ TEST_F(ClusterResourceSchedulerTest, TaskResourceInstancesSerializedStringTest)
   )");
 }
 
+NodeResources RandomNodeResources(std::mt19937 &gen) {
+  std::uniform_int_distribution<int> capacity(0, 8);
+  std::uniform_int_distribution<int> num_custom(0, 4);
+  std::uniform_int_distribution<int> custom_id(100, 110);
+  NodeResources node_resources;
+  node_resources.predefined_resources.resize(PredefinedResources_MAX);
+  for (auto &resource : node_resources.predefined_resources) {
+    resource.total = capacity(gen);
+    resource.available = std::uniform_int_distribution<int>(0, 8)(gen) *
+                         resource.total.Double() / 8;
+  }
+  for (int i = num_custom(gen); i > 0; i--) {
+    auto &resource = node_resources.custom_resources[custom_id(gen)];
+    resource.total = capacity(gen);
+    resource.available = resource.total.Double() / 2;
+  }
+  node_resources.object_pulls_queued = gen() % 4 == 0;
+  return node_resources;
+}
+
+ResourceRequest RandomResourceRequest(std::mt19937 &gen) {
+  std::uniform_real_distribution<double> demand(0, 4);
+  std::uniform_int_distribution<int> num_custom(0, 2);
+  std::uniform_int_distribution<int> custom_id(100, 110);
+  ResourceRequest resource_request;
+  resource_request.predefined_resources.resize(PredefinedResources_MAX);
+  for (auto &resource : resource_request.predefined_resources) {
+    resource = gen() % 2 == 0 ? 0 : demand(gen);
+  }
+  for (int i = num_custom(gen); i > 0; i--) {
+    resource_request.custom_resources[custom_id(gen)] = demand(gen);
+  }
+  resource_request.requires_object_store_memory = gen() % 2 == 0;
+  return resource_request;
+}
+
+TEST_F(ClusterResourceSchedulerTest, PackedResourcesMatchNodeResourcesTest) {
+  std::mt19937 gen(0);
+  std::vector<NodeResources> nodes;
+  for (int i = 0; i < 200; i++) {
+    nodes.push_back(RandomNodeResources(gen));
+  }
+  // A node that doesn't know all predefined resources.
+  nodes.emplace_back();
+  nodes.back().predefined_resources.resize(CPU + 1);
+  nodes.back().predefined_resources[CPU].total = 4;
+  std::vector<ResourceRequest> requests = {ResourceRequest()};
+  for (int i = 0; i < 200; i++) {
+    requests.push_back(RandomResourceRequest(gen));
+  }
+
+  for (const auto &node : nodes) {
+    PackedNodeResources packed_node(node);
+    ASSERT_EQ(packed_node.critical_resource_utilization,
+              node.CalculateCriticalResourceUtilization());
+    ASSERT_EQ(packed_node.HasGPU(), node.HasGPU());
+    for (const auto &request : requests) {
+      PackedResourceRequest packed_request(request);
+      ASSERT_EQ(packed_node.IsFeasible(packed_request), node.IsFeasible(request))
+          << node.DebugString() << " " << request.DebugString();
+      for (bool ignore_pull_manager_at_capacity : {false, true}) {
+        ASSERT_EQ(
+            packed_node.IsAvailable(packed_request, ignore_pull_manager_at_capacity),
+            node.IsAvailable(request, ignore_pull_manager_at_capacity))
+            << node.DebugString() << " " << request.DebugString();
+      }
+    }
+  }
+}
+
+TEST_F(ClusterResourceSchedulerTest, PackedResourcesBenchmark) {
+  // Compares the cost of checking a request against a node in both layouts.
+  std::mt19937 gen(0);
+  std::vector<NodeResources> nodes;
+  std::vector<PackedNodeResources> packed_nodes;
+  for (int i = 0; i < 1000; i++) {
+    nodes.push_back(RandomNodeResources(gen));
+    packed_nodes.emplace_back(nodes.back());
+  }
+  auto request = ResourceMapToResourceRequest({{"CPU", 1}, {"memory", 2}}, false);
+  PackedResourceRequest packed_request(request);
+  const int num_rounds = 1000;
+
+  auto time_checks = [&](auto &&check) {
+    int64_t num_available = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < num_rounds; round++) {
+      for (size_t i = 0; i < nodes.size(); i++) {
+        num_available += check(i);
+      }
+    }
+    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    return std::make_pair(num_available, elapsed_ns / (num_rounds * nodes.size()));
+  };
+  auto [num_available, ns_per_check] = time_checks([&](size_t i) {
+    return nodes[i].IsAvailable(request) && nodes[i].IsFeasible(request);
+  });
+  auto [packed_num_available, packed_ns_per_check] = time_checks([&](size_t i) {
+    return packed_nodes[i].IsAvailable(packed_request) &&
+           packed_nodes[i].IsFeasible(packed_request);
+  });
+  RAY_LOG(INFO) << "Checking a request against a node took " << ns_per_check
+                << "ns with NodeResources and " << packed_ns_per_check
+                << "ns with PackedNodeResources.";
+  ASSERT_EQ(num_available, packed_num_available);
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {
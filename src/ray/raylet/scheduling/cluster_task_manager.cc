@@ -67,6 +67,11 @@ void ClusterTaskManager::ScheduleAndDispatchTasks() {
        shapes_it != tasks_to_schedule_.end();) {
     auto &work_queue = shapes_it->second;
     bool is_infeasible = false;
+    // Large queues are placed in one batch. Whatever is left of them can't be scheduled
+    // right now, which the loop below finds out with a single decision.
+    if (ShouldScheduleInBatch(work_queue)) {
+      ScheduleBatch(work_queue, &is_infeasible);
+    }
     for (auto work_it = work_queue.begin(); work_it != work_queue.end();) {
       // Check every task in task_to_schedule queue to see
       // whether it can be scheduled. This avoids head-of-line
@@ -287,10 +292,8 @@ void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
     return;
   }
 
-  internal_stats_.TaskSpilled();
   const auto &task = work->task;
   const auto &task_spec = task.GetTaskSpecification();
-  RAY_LOG(DEBUG) << "Spilling task " << task_spec.TaskId() << " to node " << spillback_to;
 
   if (!cluster_resource_scheduler_->AllocateRemoteTaskResources(
           scheduling::NodeID(spillback_to.Binary()),
@@ -303,13 +306,92 @@ void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
   RAY_CHECK(node_info_ptr)
       << "Spilling back to a node manager, but no GCS info found for node "
       << spillback_to;
+  Spillback(spillback_to, *node_info_ptr, work);
+}
+
+bool ClusterTaskManager::ShouldScheduleInBatch(
+    const std::deque<std::shared_ptr<internal::Work>> &work_queue) const {
+  const auto min_tasks = RayConfig::instance().scheduler_batch_scheduling_min_tasks();
+  if (min_tasks == 0 || work_queue.size() < min_tasks ||
+      !cluster_resource_scheduler_->IsBatchSchedulable(
+          work_queue.front()->task.GetTaskSpecification())) {
+    return false;
+  }
+  // Requests that must be granted or rejected don't reserve remote resources when they
+  // are rejected, and the local node is only prioritized for the whole batch.
+  const bool prioritize_local_node = work_queue.front()->PrioritizeLocalNode();
+  for (const auto &work : work_queue) {
+    if (work->grant_or_reject || work->PrioritizeLocalNode() != prioritize_local_node) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ClusterTaskManager::ScheduleBatch(
+    std::deque<std::shared_ptr<internal::Work>> &work_queue, bool *is_infeasible) {
+  const auto &work = work_queue.front();
+  RAY_LOG(DEBUG) << "Scheduling " << work_queue.size() << " pending tasks of class "
+                 << work->task.GetTaskSpecification().GetSchedulingClass()
+                 << " in a batch";
+  auto placements = cluster_resource_scheduler_->GetBestSchedulableNodes(
+      work->task.GetTaskSpecification(), work_queue.size(), work->PrioritizeLocalNode(),
+      is_infeasible);
+
+  // The tasks are identical, so each node takes the next tasks from the front of the
+  // queue.
+  for (const auto &[scheduling_node_id, num_tasks] : placements) {
+    std::vector<std::shared_ptr<internal::Work>> works(work_queue.begin(),
+                                                       work_queue.begin() + num_tasks);
+    work_queue.erase(work_queue.begin(), work_queue.begin() + num_tasks);
+    ScheduleOnNode(NodeID::FromBinary(scheduling_node_id.Binary()), works);
+  }
+}
+
+void ClusterTaskManager::ScheduleOnNode(
+    const NodeID &spillback_to,
+    const std::vector<std::shared_ptr<internal::Work>> &works) {
+  if (works.empty()) {
+    return;
+  }
+  if (spillback_to == self_node_id_ && local_task_manager_) {
+    local_task_manager_->QueueAndScheduleTasks(works);
+    return;
+  }
+
+  const auto &task_spec = works.front()->task.GetTaskSpecification();
+  auto num_allocated = cluster_resource_scheduler_->AllocateRemoteTaskResources(
+      scheduling::NodeID(spillback_to.Binary()),
+      task_spec.GetRequiredResources().GetResourceMap(), works.size());
+  if (num_allocated < static_cast<int64_t>(works.size())) {
+    RAY_LOG(DEBUG) << "Tried to allocate resources for " << works.size()
+                   << " requests of class " << task_spec.GetSchedulingClass()
+                   << " on a remote node, but only " << num_allocated
+                   << " of them are available";
+  }
+
+  auto node_info_ptr = get_node_info_(spillback_to);
+  RAY_CHECK(node_info_ptr)
+      << "Spilling back to a node manager, but no GCS info found for node "
+      << spillback_to;
+  for (const auto &work : works) {
+    Spillback(spillback_to, *node_info_ptr, work);
+  }
+}
+
+void ClusterTaskManager::Spillback(const NodeID &spillback_to,
+                                   const rpc::GcsNodeInfo &node_info,
+                                   const std::shared_ptr<internal::Work> &work) {
+  internal_stats_.TaskSpilled();
+  RAY_LOG(DEBUG) << "Spilling task " << work->task.GetTaskSpecification().TaskId()
+                 << " to node " << spillback_to;
   auto reply = work->reply;
   reply->mutable_retry_at_raylet_address()->set_ip_address(
-      node_info_ptr->node_manager_address());
-  reply->mutable_retry_at_raylet_address()->set_port(node_info_ptr->node_manager_port());
+      node_info.node_manager_address());
+  reply->mutable_retry_at_raylet_address()->set_port(node_info.node_manager_port());
   reply->mutable_retry_at_raylet_address()->set_raylet_id(spillback_to.Binary());
 
-  send_reply_callback();
+  work->callback();
 }
 }  // namespace raylet
 }  // namespace ray
@@ -135,6 +135,29 @@ class ClusterTaskManager : public ClusterTaskManagerInterface {
   void ScheduleOnNode(const NodeID &node_to_schedule,
                       const std::shared_ptr<internal::Work> &work);
 
+  /// Whether a queue of tasks of the same scheduling class should be scheduled with
+  /// one batch decision instead of one decision per task.
+  bool ShouldScheduleInBatch(
+      const std::deque<std::shared_ptr<internal::Work>> &work_queue) const;
+
+  /// Place as many tasks of the queue as possible on the cluster in one batch, and
+  /// remove them from the queue.
+  ///
+  /// \param work_queue: The queue of tasks of the same scheduling class.
+  /// \param is_infeasible[out]: Set to true if the tasks are infeasible.
+  void ScheduleBatch(std::deque<std::shared_ptr<internal::Work>> &work_queue,
+                     bool *is_infeasible);
+
+  /// Schedule a batch of tasks of the same scheduling class onto a node (which could be
+  /// either remote or local). Resources on a remote node are reserved for all the tasks
+  /// at once.
+  void ScheduleOnNode(const NodeID &node_to_schedule,
+                      const std::vector<std::shared_ptr<internal::Work>> &works);
+
+  /// Reply to a lease request with the node to retry it at.
+  void Spillback(const NodeID &spillback_to, const rpc::GcsNodeInfo &node_info,
+                 const std::shared_ptr<internal::Work> &work);
+
   /// Recompute the debug stats.
   /// It is needed because updating the debug state is expensive for cluster_task_manager.
   /// TODO(sang): Update the internal states value dynamically instead of iterating the
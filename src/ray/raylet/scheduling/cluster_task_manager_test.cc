@@ -2286,6 +2286,48 @@ TEST_F(ClusterTaskManagerTestWithoutCPUsAtHead, OneCpuInfeasibleTask) {
   }
 }
 
+TEST_F(ClusterTaskManagerTestWithoutCPUsAtHead, BatchScheduleIdenticalTasks) {
+  RayConfig::instance().scheduler_batch_scheduling_min_tasks() = 4;
+  int num_callbacks = 0;
+  auto callback = [&](Status, std::function<void()>, std::function<void()>) {
+    num_callbacks++;
+  };
+
+  // The tasks are infeasible until the remote nodes join, so they queue up.
+  const int num_tasks = 12;
+  std::vector<rpc::RequestWorkerLeaseReply> replies(num_tasks);
+  for (int i = 0; i < num_tasks; i++) {
+    RayTask task = CreateTask({{ray::kCPU_ResourceLabel, 1}});
+    task_manager_.QueueAndScheduleTask(task, false, false, &replies[i], callback);
+  }
+  ASSERT_EQ(num_callbacks, 0);
+
+  auto small_node_id = NodeID::FromRandom();
+  auto large_node_id = NodeID::FromRandom();
+  AddNode(small_node_id, 4);
+  AddNode(large_node_id, 8);
+  task_manager_.ScheduleAndDispatchTasks();
+
+  // All the tasks are spilled back in one batch, which exactly fills both nodes.
+  ASSERT_EQ(num_callbacks, num_tasks);
+  absl::flat_hash_map<std::string, int> num_spilled;
+  for (const auto &reply : replies) {
+    num_spilled[reply.retry_at_raylet_address().raylet_id()]++;
+  }
+  ASSERT_EQ(num_spilled.size(), 2);
+  ASSERT_EQ(num_spilled[small_node_id.Binary()], 4);
+  ASSERT_EQ(num_spilled[large_node_id.Binary()], 8);
+  // The node info is looked up once per node rather than once per task.
+  ASSERT_EQ(node_info_calls_, 2);
+  for (const auto &node_id : {small_node_id, large_node_id}) {
+    const auto &resources = scheduler_->GetClusterResourceManager().GetNodeResources(
+        scheduling::NodeID(node_id.Binary()));
+    ASSERT_EQ(resources.predefined_resources[CPU].available, 0);
+  }
+  AssertNoLeaks();
+  RayConfig::instance().scheduler_batch_scheduling_min_tasks() = 0;
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
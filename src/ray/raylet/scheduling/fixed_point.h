@@ -81,6 +81,12 @@ class FixedPoint {
     return res;
   }
 
+  FixedPoint operator*(int64_t const n) const {
+    FixedPoint res;
+    res.i_ = i_ * n;
+    return res;
+  }
+
   FixedPoint operator=(double const d) {
     i_ = static_cast<int64_t>(d * RESOURCE_UNIT_SCALING);
     return *this;
@@ -105,6 +111,9 @@ class FixedPoint {
 
   [[nodiscard]] double Double() const { return round(i_) / RESOURCE_UNIT_SCALING; };
 
+  /// The value in units of 1 / RESOURCE_UNIT_SCALING.
+  [[nodiscard]] int64_t Raw() const { return i_; };
+
   friend std::ostream &operator<<(std::ostream &out, FixedPoint const &ru1);
 };
 
@@ -57,6 +57,14 @@ void LocalTaskManager::QueueAndScheduleTask(std::shared_ptr<internal::Work> work
   ScheduleAndDispatchTasks();
 }
 
+void LocalTaskManager::QueueAndScheduleTasks(
+    const std::vector<std::shared_ptr<internal::Work>> &works) {
+  for (const auto &work : works) {
+    WaitForTaskArgsRequests(work);
+  }
+  ScheduleAndDispatchTasks();
+}
+
 bool LocalTaskManager::WaitForTaskArgsRequests(std::shared_ptr<internal::Work> work) {
   const auto &task = work->task;
   const auto &task_id = task.GetTaskSpecification().TaskId();
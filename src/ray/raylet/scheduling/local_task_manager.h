@@ -92,6 +92,9 @@ class LocalTaskManager {
   /// Queue task and schedule.
   void QueueAndScheduleTask(std::shared_ptr<internal::Work> work);
 
+  /// Queue a batch of tasks and schedule them all at once.
+  void QueueAndScheduleTasks(const std::vector<std::shared_ptr<internal::Work>> &works);
+
   // Schedule and dispatch tasks.
   void ScheduleAndDispatchTasks();
 
@@ -0,0 +1,118 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/scheduling/node_resource_index.h"
+
+namespace ray {
+
+namespace {
+
+void EraseOne(std::multiset<int64_t> &values, int64_t value) {
+  auto it = values.find(value);
+  RAY_CHECK(it != values.end());
+  values.erase(it);
+}
+
+void Replace(std::multiset<int64_t> &values, int64_t old_value, int64_t new_value) {
+  if (old_value != new_value) {
+    EraseOne(values, old_value);
+    values.insert(new_value);
+  }
+}
+
+}  // namespace
+
+NodeResourceIndex::NodeResourceIndex(float spread_threshold)
+    : spread_threshold_(spread_threshold) {}
+
+void NodeResourceIndex::AddOrUpdateNode(scheduling::NodeID node_id,
+                                        const NodeResources &node_resources) {
+  PackedNodeResources entry(node_resources);
+
+  auto it = entries_.find(node_id);
+  if (it == entries_.end()) {
+    for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+      available_[i].insert(entry.available[i]);
+      total_[i].insert(entry.total[i]);
+    }
+    it = entries_.emplace(node_id, std::move(entry)).first;
+  } else {
+    auto &old_entry = it->second;
+    for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+      Replace(available_[i], old_entry.available[i], entry.available[i]);
+      Replace(total_[i], old_entry.total[i], entry.total[i]);
+    }
+    const float old_utilization = old_entry.critical_resource_utilization;
+    old_entry = std::move(entry);
+    if (old_utilization == old_entry.critical_resource_utilization) {
+      return;
+    }
+    if (old_utilization < spread_threshold_) {
+      nodes_below_threshold_.erase(node_id);
+    } else {
+      nodes_above_threshold_.erase({old_utilization, node_id});
+    }
+  }
+
+  const float utilization = it->second.critical_resource_utilization;
+  if (utilization < spread_threshold_) {
+    nodes_below_threshold_.insert(node_id);
+  } else {
+    nodes_above_threshold_.emplace(utilization, node_id);
+  }
+}
+
+void NodeResourceIndex::RemoveNode(scheduling::NodeID node_id) {
+  auto it = entries_.find(node_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  const auto &entry = it->second;
+  for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+    EraseOne(available_[i], entry.available[i]);
+    EraseOne(total_[i], entry.total[i]);
+  }
+  if (entry.critical_resource_utilization < spread_threshold_) {
+    nodes_below_threshold_.erase(node_id);
+  } else {
+    nodes_above_threshold_.erase({entry.critical_resource_utilization, node_id});
+  }
+  entries_.erase(it);
+}
+
+bool NodeResourceIndex::MayBeAvailable(const ResourceRequest &resource_request) const {
+  return FitsLargest(resource_request, available_);
+}
+
+bool NodeResourceIndex::MayBeFeasible(const ResourceRequest &resource_request) const {
+  return FitsLargest(resource_request, total_);
+}
+
+bool NodeResourceIndex::FitsLargest(
+    const ResourceRequest &resource_request,
+    const std::array<std::multiset<int64_t>, PredefinedResources_MAX> &capacities)
+    const {
+  if (entries_.empty()) {
+    return false;
+  }
+  const auto &demands = resource_request.predefined_resources;
+  for (size_t i = 0; i < PredefinedResources_MAX && i < demands.size(); i++) {
+    if (demands[i].Raw() > *capacities[i].rbegin()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace ray
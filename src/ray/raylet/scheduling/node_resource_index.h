@@ -0,0 +1,100 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/raylet/scheduling/cluster_resource_data.h"
+#include "ray/raylet/scheduling/fixed_point.h"
+#include "ray/raylet/scheduling/scheduling_ids.h"
+
+namespace ray {
+
+/// An index over the resource view of the cluster that lets the hybrid scheduling
+/// policy find the best node without scanning and sorting every node of the cluster
+/// on every scheduling decision. It is maintained incrementally by
+/// `ClusterResourceManager` whenever the resources of a node change.
+///
+/// Nodes are kept in the priority order of `HybridSchedulingPolicy`: first the nodes
+/// whose critical resource utilization is below the spread threshold, by node ID, and
+/// then the others, by utilization and node ID. The index also tracks, per predefined
+/// resource, the largest available and total capacity of any node, so that requests
+/// that no node can fit are rejected without visiting any node. A packed copy of the
+/// resources of every node lets visited nodes be checked without chasing pointers.
+///
+/// This class is not thread safe.
+class NodeResourceIndex {
+ public:
+  /// \param spread_threshold The critical resource utilization below which nodes are
+  /// treated as equally utilized.
+  explicit NodeResourceIndex(float spread_threshold);
+
+  /// Add a new node or update the resources of an existing node.
+  void AddOrUpdateNode(scheduling::NodeID node_id, const NodeResources &node_resources);
+
+  /// Remove a node. No-op if the node isn't indexed.
+  void RemoveNode(scheduling::NodeID node_id);
+
+  float GetSpreadThreshold() const { return spread_threshold_; }
+
+  /// Whether any node could have enough available predefined resources for the
+  /// request. If false, the request isn't available on any node.
+  bool MayBeAvailable(const ResourceRequest &resource_request) const;
+
+  /// Whether any node could have enough total predefined resources for the request.
+  /// If false, the request is infeasible on every node.
+  bool MayBeFeasible(const ResourceRequest &resource_request) const;
+
+  /// Nodes whose critical resource utilization is below the spread threshold, ordered
+  /// by node ID.
+  const std::set<scheduling::NodeID> &GetNodesBelowThreshold() const {
+    return nodes_below_threshold_;
+  }
+
+  /// Nodes whose critical resource utilization is at or above the spread threshold,
+  /// ordered by utilization and then node ID.
+  const std::set<std::pair<float, scheduling::NodeID>> &GetNodesAboveThreshold() const {
+    return nodes_above_threshold_;
+  }
+
+  /// The packed resources of a node, or null if the node isn't indexed.
+  const PackedNodeResources *GetPackedResources(scheduling::NodeID node_id) const {
+    auto it = entries_.find(node_id);
+    return it == entries_.end() ? nullptr : &it->second;
+  }
+
+  size_t NumNodes() const { return entries_.size(); }
+
+ private:
+  /// Whether the request fits into the largest capacity of any node, per resource.
+  bool FitsLargest(
+      const ResourceRequest &resource_request,
+      const std::array<std::multiset<int64_t>, PredefinedResources_MAX> &capacities)
+      const;
+
+  const float spread_threshold_;
+  absl::flat_hash_map<scheduling::NodeID, PackedNodeResources> entries_;
+  std::set<scheduling::NodeID> nodes_below_threshold_;
+  std::set<std::pair<float, scheduling::NodeID>> nodes_above_threshold_;
+  /// The available and total capacities of every node, per predefined resource.
+  std::array<std::multiset<int64_t>, PredefinedResources_MAX> available_;
+  std::array<std::multiset<int64_t>, PredefinedResources_MAX> total_;
+};
+
+}  // namespace ray
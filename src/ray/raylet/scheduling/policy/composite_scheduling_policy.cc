@@ -40,5 +40,15 @@ scheduling::NodeID CompositeSchedulingPolicy::Schedule(
   UNREACHABLE;
 }
 
+std::vector<std::pair<scheduling::NodeID, int64_t>>
+CompositeSchedulingPolicy::ScheduleBatch(const ResourceRequest &resource_request,
+                                         int64_t num_requests, SchedulingOptions options,
+                                         bool prioritize_local_node) {
+  RAY_CHECK(options.scheduling_type == SchedulingType::HYBRID)
+      << "Batch scheduling is only supported by the hybrid policy.";
+  return hybrid_policy_.ScheduleBatch(resource_request, num_requests, options,
+                                      prioritize_local_node);
+}
+
 }  // namespace raylet_scheduling_policy
 }  // namespace ray
@@ -29,14 +29,19 @@ class CompositeSchedulingPolicy : public ISchedulingPolicy {
  public:
   CompositeSchedulingPolicy(scheduling::NodeID local_node_id,
                             const absl::flat_hash_map<scheduling::NodeID, Node> &nodes,
-                            std::function<bool(scheduling::NodeID)> is_node_available)
-      : hybrid_policy_(local_node_id, nodes, is_node_available),
+                            std::function<bool(scheduling::NodeID)> is_node_available,
+                            const NodeResourceIndex *node_index = nullptr)
+      : hybrid_policy_(local_node_id, nodes, is_node_available, node_index),
         random_policy_(local_node_id, nodes, is_node_available),
         spread_policy_(local_node_id, nodes, is_node_available) {}
 
   scheduling::NodeID Schedule(const ResourceRequest &resource_request,
                               SchedulingOptions options) override;
 
+  std::vector<std::pair<scheduling::NodeID, int64_t>> ScheduleBatch(
+      const ResourceRequest &resource_request, int64_t num_requests,
+      SchedulingOptions options, bool prioritize_local_node) override;
+
  private:
   HybridSchedulingPolicy hybrid_policy_;
   RandomSchedulingPolicy random_policy_;
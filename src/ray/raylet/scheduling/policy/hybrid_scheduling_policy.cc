@@ -15,6 +15,9 @@
 #include "ray/raylet/scheduling/policy/hybrid_scheduling_policy.h"
 
 #include <functional>
+#include <optional>
+#include <set>
+#include <tuple>
 
 #include "ray/util/container_util.h"
 #include "ray/util/util.h"
@@ -23,6 +26,21 @@ namespace ray {
 
 namespace raylet_scheduling_policy {
 
+bool HybridSchedulingPolicy::IsNodeSelectable(scheduling::NodeID node_id, bool has_gpu,
+                                              NodeFilter node_filter) const {
+  if (!is_node_available_(node_id)) {
+    return false;
+  }
+  if (node_filter == NodeFilter::kAny) {
+    return true;
+  }
+  if (node_filter == NodeFilter::kGPU) {
+    return has_gpu;
+  }
+  RAY_CHECK(node_filter == NodeFilter::kNonGpu);
+  return !has_gpu;
+}
+
 scheduling::NodeID HybridSchedulingPolicy::HybridPolicyWithFilter(
     const ResourceRequest &resource_request, float spread_threshold, bool force_spillback,
     bool require_node_available, NodeFilter node_filter) {
@@ -35,18 +53,7 @@ scheduling::NodeID HybridSchedulingPolicy::HybridPolicyWithFilter(
   RAY_CHECK(local_it != nodes_.end());
   auto predicate = [this, node_filter](scheduling::NodeID node_id,
                                        const NodeResources &node_resources) {
-    if (!is_node_available_(node_id)) {
-      return false;
-    }
-    if (node_filter == NodeFilter::kAny) {
-      return true;
-    }
-    const bool has_gpu = node_resources.HasGPU();
-    if (node_filter == NodeFilter::kGPU) {
-      return has_gpu;
-    }
-    RAY_CHECK(node_filter == NodeFilter::kNonGpu);
-    return !has_gpu;
+    return IsNodeSelectable(node_id, node_resources.HasGPU(), node_filter);
   };
 
   const auto &local_node_view = local_it->second.GetLocalView();
@@ -133,28 +140,265 @@ scheduling::NodeID HybridSchedulingPolicy::HybridPolicyWithFilter(
   return best_node_id;
 }
 
+scheduling::NodeID HybridSchedulingPolicy::IndexedHybridPolicyWithFilter(
+    const ResourceRequest &resource_request, bool force_spillback,
+    bool require_node_available, NodeFilter node_filter) {
+  const auto *local_node_resources = node_index_->GetPackedResources(local_node_id_);
+  RAY_CHECK(local_node_resources != nullptr);
+  if (!node_index_->MayBeFeasible(resource_request)) {
+    return scheduling::NodeID::Nil();
+  }
+  // If no node can be available, the first feasible node in priority order wins.
+  const bool may_be_available = node_index_->MayBeAvailable(resource_request);
+  if (!may_be_available && require_node_available) {
+    return scheduling::NodeID::Nil();
+  }
+
+  // Nodes are checked against the packed copies of the index, which is much cheaper
+  // than going through their `NodeResources`.
+  const PackedResourceRequest packed_request(resource_request);
+  scheduling::NodeID selected_node_id = scheduling::NodeID::Nil();
+  scheduling::NodeID first_feasible_node_id = scheduling::NodeID::Nil();
+  // Returns true if the search is over, with the node to schedule on in
+  // `selected_node_id`.
+  auto visit = [&](scheduling::NodeID node_id,
+                   const PackedNodeResources &node_resources) {
+    if (!IsNodeSelectable(node_id, node_resources.HasGPU(), node_filter) ||
+        !node_resources.IsFeasible(packed_request)) {
+      return false;
+    }
+    // It's okay if the local node's pull manager is at capacity because we will
+    // eventually spill the task back from the waiting queue if its args cannot be
+    // pulled.
+    if (!may_be_available ||
+        node_resources.IsAvailable(packed_request,
+                                   /*ignore_pull_manager_at_capacity*/ node_id ==
+                                       local_node_id_)) {
+      selected_node_id = node_id;
+      return true;
+    }
+    if (first_feasible_node_id.IsNil()) {
+      first_feasible_node_id = node_id;
+    }
+    return false;
+  };
+  auto visit_remote = [&](scheduling::NodeID node_id) {
+    if (node_id == local_node_id_) {
+      return false;
+    }
+    const auto *node_resources = node_index_->GetPackedResources(node_id);
+    RAY_CHECK(node_resources != nullptr);
+    return visit(node_id, *node_resources);
+  };
+
+  // The local node comes first among the nodes with the same (truncated) utilization.
+  const auto &local_node_view = *local_node_resources;
+  const float local_utilization = local_node_view.critical_resource_utilization;
+  bool local_visited = force_spillback;
+  if (!local_visited && local_utilization < node_index_->GetSpreadThreshold()) {
+    local_visited = true;
+    if (visit(local_node_id_, local_node_view)) {
+      return selected_node_id;
+    }
+  }
+  for (const auto &node_id : node_index_->GetNodesBelowThreshold()) {
+    if (visit_remote(node_id)) {
+      return selected_node_id;
+    }
+  }
+  for (const auto &[utilization, node_id] : node_index_->GetNodesAboveThreshold()) {
+    if (!local_visited && local_utilization <= utilization) {
+      local_visited = true;
+      if (visit(local_node_id_, local_node_view)) {
+        return selected_node_id;
+      }
+    }
+    if (visit_remote(node_id)) {
+      return selected_node_id;
+    }
+  }
+  if (!local_visited && visit(local_node_id_, local_node_view)) {
+    return selected_node_id;
+  }
+
+  return require_node_available ? scheduling::NodeID::Nil() : first_feasible_node_id;
+}
+
 scheduling::NodeID HybridSchedulingPolicy::Schedule(
     const ResourceRequest &resource_request, SchedulingOptions options) {
   RAY_CHECK(options.scheduling_type == SchedulingType::HYBRID)
       << "HybridPolicy policy requires type = HYBRID";
-  if (!options.avoid_gpu_nodes || resource_request.IsGPURequest()) {
+  auto schedule = [this, &resource_request, &options](bool require_node_available,
+                                                      NodeFilter node_filter) {
+    if (node_index_ != nullptr &&
+        node_index_->GetSpreadThreshold() == options.spread_threshold) {
+      return IndexedHybridPolicyWithFilter(resource_request, options.avoid_local_node,
+                                           require_node_available, node_filter);
+    }
     return HybridPolicyWithFilter(resource_request, options.spread_threshold,
-                                  options.avoid_local_node,
-                                  options.require_node_available);
+                                  options.avoid_local_node, require_node_available,
+                                  node_filter);
+  };
+
+  if (!options.avoid_gpu_nodes || resource_request.IsGPURequest()) {
+    return schedule(options.require_node_available, NodeFilter::kAny);
   }
 
   // Try schedule on non-GPU nodes.
-  auto best_node_id = HybridPolicyWithFilter(
-      resource_request, options.spread_threshold, options.avoid_local_node,
-      /*require_node_available*/ true, NodeFilter::kNonGpu);
+  auto best_node_id = schedule(/*require_node_available*/ true, NodeFilter::kNonGpu);
   if (!best_node_id.IsNil()) {
     return best_node_id;
   }
 
   // If we cannot find any available node from non-gpu nodes, fallback to the original
   // scheduling
-  return HybridPolicyWithFilter(resource_request, options.spread_threshold,
-                                options.avoid_local_node, options.require_node_available);
+  return schedule(options.require_node_available, NodeFilter::kAny);
+}
+
+const NodeResources &HybridSchedulingPolicy::GetBatchView(
+    const BatchState &state, scheduling::NodeID node_id) const {
+  auto it = state.reserved_views.find(node_id);
+  if (it != state.reserved_views.end()) {
+    return it->second;
+  }
+  return nodes_.at(node_id).GetLocalView();
+}
+
+void HybridSchedulingPolicy::PlaceBatchRequest(BatchState *state,
+                                               scheduling::NodeID node_id,
+                                               const ResourceRequest &resource_request,
+                                               int64_t count) {
+  auto index_it = state->placement_index.find(node_id);
+  if (index_it == state->placement_index.end()) {
+    index_it =
+        state->placement_index.emplace(node_id, state->placements.size()).first;
+    state->placements.emplace_back(node_id, 0);
+  }
+  state->placements[index_it->second].second += count;
+  state->num_pending -= count;
+
+  // Like the spillback path of the cluster task manager, only reserve resources that
+  // are available, so that requests queued on a saturated node don't change its view.
+  if (!GetBatchView(*state, node_id)
+           .IsAvailable(resource_request,
+                        /*ignore_pull_manager_at_capacity*/ node_id == local_node_id_)) {
+    return;
+  }
+  auto view_it = state->reserved_views.find(node_id);
+  if (view_it == state->reserved_views.end()) {
+    view_it =
+        state->reserved_views.emplace(node_id, nodes_.at(node_id).GetLocalView()).first;
+  }
+  auto &resources = view_it->second;
+  for (size_t i = 0; i < resources.predefined_resources.size() &&
+                     i < resource_request.predefined_resources.size();
+       i++) {
+    resources.predefined_resources[i].available =
+        std::max(FixedPoint(0), resources.predefined_resources[i].available -
+                                    resource_request.predefined_resources[i]);
+  }
+  for (const auto &[resource_id, demand] : resource_request.custom_resources) {
+    auto it = resources.custom_resources.find(resource_id);
+    if (it != resources.custom_resources.end()) {
+      it->second.available = std::max(FixedPoint(0), it->second.available - demand);
+    }
+  }
+}
+
+void HybridSchedulingPolicy::HybridPolicyBatchWithFilter(
+    const ResourceRequest &resource_request, float spread_threshold, bool force_spillback,
+    bool require_node_available, NodeFilter node_filter, BatchState *state) {
+  if (state->num_pending == 0) {
+    return;
+  }
+  // Nodes are ordered the same way `HybridPolicyWithFilter` breaks ties: by truncated
+  // critical resource utilization, then the local node, then node ID.
+  using Priority = std::tuple<float, bool, scheduling::NodeID>;
+  auto priority_of = [this, state, spread_threshold](scheduling::NodeID node_id) {
+    float utilization =
+        GetBatchView(*state, node_id).CalculateCriticalResourceUtilization();
+    if (utilization < spread_threshold) {
+      utilization = 0;
+    }
+    return Priority(utilization, node_id != local_node_id_, node_id);
+  };
+  auto is_available = [this, state, &resource_request](scheduling::NodeID node_id) {
+    return GetBatchView(*state, node_id)
+        .IsAvailable(resource_request,
+                     /*ignore_pull_manager_at_capacity*/ node_id == local_node_id_);
+  };
+
+  std::vector<scheduling::NodeID> feasible_nodes;
+  std::set<Priority> available_nodes;
+  for (const auto &[node_id, node] : nodes_) {
+    if ((force_spillback && node_id == local_node_id_) ||
+        !IsNodeSelectable(node_id, node.GetLocalView().HasGPU(), node_filter) ||
+        !node.GetLocalView().IsFeasible(resource_request)) {
+      continue;
+    }
+    feasible_nodes.push_back(node_id);
+    if (is_available(node_id)) {
+      available_nodes.insert(priority_of(node_id));
+    }
+  }
+
+  // Place one request at a time on the best available node. Reserving resources can
+  // only move a node back in the order, so it's reinserted at its new priority.
+  while (state->num_pending > 0 && !available_nodes.empty()) {
+    const auto node_id = std::get<2>(*available_nodes.begin());
+    available_nodes.erase(available_nodes.begin());
+    PlaceBatchRequest(state, node_id, resource_request);
+    if (is_available(node_id)) {
+      available_nodes.insert(priority_of(node_id));
+    }
+  }
+
+  // Once no node is available, every remaining request would pick the same best
+  // feasible node, since queuing requests there doesn't change its view.
+  if (state->num_pending > 0 && !require_node_available && !feasible_nodes.empty()) {
+    std::optional<Priority> best;
+    for (const auto &node_id : feasible_nodes) {
+      auto priority = priority_of(node_id);
+      if (!best || priority < *best) {
+        best = priority;
+      }
+    }
+    PlaceBatchRequest(state, std::get<2>(*best), resource_request, state->num_pending);
+  }
+}
+
+std::vector<std::pair<scheduling::NodeID, int64_t>> HybridSchedulingPolicy::ScheduleBatch(
+    const ResourceRequest &resource_request, int64_t num_requests,
+    SchedulingOptions options, bool prioritize_local_node) {
+  RAY_CHECK(options.scheduling_type == SchedulingType::HYBRID)
+      << "HybridPolicy policy requires type = HYBRID";
+  BatchState state;
+  state.num_pending = num_requests;
+
+  if (prioritize_local_node && !options.avoid_local_node) {
+    while (state.num_pending > 0 &&
+           GetBatchView(state, local_node_id_)
+               .IsAvailable(resource_request, /*ignore_pull_manager_at_capacity*/ true)) {
+      PlaceBatchRequest(&state, local_node_id_, resource_request);
+    }
+  }
+
+  if (!options.avoid_gpu_nodes || resource_request.IsGPURequest()) {
+    HybridPolicyBatchWithFilter(resource_request, options.spread_threshold,
+                                options.avoid_local_node, options.require_node_available,
+                                NodeFilter::kAny, &state);
+  } else {
+    // Requests go to non-GPU nodes while any of them is available, and then fall back
+    // to the original scheduling, as in `Schedule`.
+    HybridPolicyBatchWithFilter(resource_request, options.spread_threshold,
+                                options.avoid_local_node,
+                                /*require_node_available*/ true, NodeFilter::kNonGpu,
+                                &state);
+    HybridPolicyBatchWithFilter(resource_request, options.spread_threshold,
+                                options.avoid_local_node, options.require_node_available,
+                                NodeFilter::kAny, &state);
+  }
+  return std::move(state.placements);
 }
 
 }  // namespace raylet_scheduling_policy
@@ -14,8 +14,10 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
+#include "ray/raylet/scheduling/node_resource_index.h"
 #include "ray/raylet/scheduling/policy/scheduling_policy.h"
 
 namespace ray {
@@ -45,18 +47,31 @@ namespace raylet_scheduling_policy {
 /// We call this a hybrid policy because below the threshold, the traversal and
 /// truncation properties will lead to packing of nodes. Above the threshold, the policy
 /// will act like a traditional weighted round robin.
+///
+/// If a `NodeResourceIndex` over `nodes` is given, nodes are visited in priority order
+/// instead, so that the search stops at the first available node rather than scanning
+/// and sorting the whole cluster. Both ways pick the same node.
 class HybridSchedulingPolicy : public ISchedulingPolicy {
  public:
   HybridSchedulingPolicy(scheduling::NodeID local_node_id,
                          const absl::flat_hash_map<scheduling::NodeID, Node> &nodes,
-                         std::function<bool(scheduling::NodeID)> is_node_available)
+                         std::function<bool(scheduling::NodeID)> is_node_available,
+                         const NodeResourceIndex *node_index = nullptr)
       : local_node_id_(local_node_id),
         nodes_(nodes),
-        is_node_available_(is_node_available) {}
+        is_node_available_(is_node_available),
+        node_index_(node_index) {}
 
   scheduling::NodeID Schedule(const ResourceRequest &resource_request,
                               SchedulingOptions options) override;
 
+  /// Schedule a batch of identical requests in one pass over the cluster. Nodes are
+  /// kept in the priority order of the policy as resources are reserved on them, so
+  /// that every request costs a logarithmic number of steps instead of a scan.
+  std::vector<std::pair<scheduling::NodeID, int64_t>> ScheduleBatch(
+      const ResourceRequest &resource_request, int64_t num_requests,
+      SchedulingOptions options, bool prioritize_local_node) override;
+
  private:
   /// Identifier of local node.
   const scheduling::NodeID local_node_id_;
@@ -67,6 +82,9 @@ class HybridSchedulingPolicy : public ISchedulingPolicy {
   /// Function Checks if node is alive.
   std::function<bool(scheduling::NodeID)> is_node_available_;
 
+  /// Index over `nodes_` in priority order. Null if the policy should scan all nodes.
+  const NodeResourceIndex *node_index_;
+
   enum class NodeFilter {
     /// Default scheduling.
     kAny,
@@ -89,6 +107,44 @@ class HybridSchedulingPolicy : public ISchedulingPolicy {
                                             float spread_threshold, bool force_spillback,
                                             bool require_available,
                                             NodeFilter node_filter = NodeFilter::kAny);
+
+  /// Same as `HybridPolicyWithFilter`, but visits nodes in priority order using
+  /// `node_index_`, whose spread threshold must be `spread_threshold`.
+  scheduling::NodeID IndexedHybridPolicyWithFilter(
+      const ResourceRequest &resource_request, bool force_spillback,
+      bool require_available, NodeFilter node_filter);
+
+  /// The state of a batch scheduled by `ScheduleBatch`.
+  struct BatchState {
+    /// The number of requests left to place.
+    int64_t num_pending;
+    /// The resources of the nodes that requests were placed on, after reserving the
+    /// resources of those requests.
+    absl::flat_hash_map<scheduling::NodeID, NodeResources> reserved_views;
+    /// The number of requests placed on each node, in the order the nodes were picked.
+    std::vector<std::pair<scheduling::NodeID, int64_t>> placements;
+    absl::flat_hash_map<scheduling::NodeID, size_t> placement_index;
+  };
+
+  /// The resources of a node, including the reservations of the batch.
+  const NodeResources &GetBatchView(const BatchState &state,
+                                    scheduling::NodeID node_id) const;
+
+  /// Place a request of the batch on the node, reserving its resources only if the node
+  /// has them available.
+  void PlaceBatchRequest(BatchState *state, scheduling::NodeID node_id,
+                         const ResourceRequest &resource_request, int64_t count = 1);
+
+  /// Same as `HybridPolicyWithFilter`, but places the pending requests of the batch
+  /// until no node passing the filter can take more of them.
+  void HybridPolicyBatchWithFilter(const ResourceRequest &resource_request,
+                                   float spread_threshold, bool force_spillback,
+                                   bool require_available, NodeFilter node_filter,
+                                   BatchState *state);
+
+  /// Whether a node passes the filter and is alive.
+  bool IsNodeSelectable(scheduling::NodeID node_id, bool has_gpu,
+                        NodeFilter node_filter) const;
 };
 }  // namespace raylet_scheduling_policy
 }  // namespace ray
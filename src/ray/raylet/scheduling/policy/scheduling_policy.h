@@ -14,11 +14,13 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "ray/raylet/scheduling/cluster_resource_data.h"
 #include "ray/raylet/scheduling/policy/scheduling_options.h"
 #include "ray/raylet/scheduling/scheduling_ids.h"
+#include "ray/util/logging.h"
 
 namespace ray {
 namespace raylet_scheduling_policy {
@@ -35,6 +37,26 @@ class ISchedulingPolicy {
   /// to schedule on.
   virtual scheduling::NodeID Schedule(const ResourceRequest &resource_request,
                                       SchedulingOptions options) = 0;
+
+  /// Schedule `num_requests` identical resource requests at once. The result is the
+  /// same as scheduling them one by one with `Schedule`, where the resources of each
+  /// request are reserved on its node before scheduling the next one.
+  ///
+  /// \param resource_request: The resource request of every request of the batch.
+  /// \param num_requests: The number of requests in the batch.
+  /// \param scheduling_options: scheduling options.
+  /// \param prioritize_local_node: Whether to place requests on the local node for as
+  /// long as it's available, before applying the policy.
+  ///
+  /// \return The number of requests to schedule on each node, in the order the nodes
+  /// were picked. The counts add up to less than `num_requests` if the rest of the
+  /// requests can't be scheduled.
+  virtual std::vector<std::pair<scheduling::NodeID, int64_t>> ScheduleBatch(
+      const ResourceRequest &resource_request, int64_t num_requests,
+      SchedulingOptions options, bool prioritize_local_node) {
+    RAY_LOG(FATAL) << "Batch scheduling isn't supported by this policy.";
+    return {};
+  }
 };
 }  // namespace raylet_scheduling_policy
 }  // namespace ray
@@ -12,8 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <random>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "ray/raylet/scheduling/node_resource_index.h"
 #include "ray/raylet/scheduling/policy/composite_scheduling_policy.h"
 
 namespace ray {
@@ -418,6 +422,192 @@ TEST_F(SchedulingPolicyTest, NonGpuNodePreferredSchedulingTest) {
   ASSERT_EQ(to_schedule, remote_node);
 }
 
+/// Build a cluster of `num_nodes` nodes with random resources, including the local node.
+void CreateRandomCluster(int num_nodes, std::mt19937 &gen,
+                         absl::flat_hash_map<scheduling::NodeID, Node> &nodes,
+                         NodeResourceIndex &node_index) {
+  std::uniform_int_distribution<int> cpus(0, 16);
+  std::uniform_int_distribution<int> gpus(0, 4);
+  std::uniform_real_distribution<double> used_fraction(0, 1);
+  for (int i = 0; i < num_nodes; i++) {
+    int total_cpu = cpus(gen);
+    // A quarter of the nodes have GPUs.
+    int total_gpu = i % 4 == 0 ? gpus(gen) : 0;
+    int total_memory = 4 * total_cpu;
+    auto resources = CreateNodeResources(
+        std::floor(total_cpu * (1 - used_fraction(gen))), total_cpu,
+        std::floor(total_memory * (1 - used_fraction(gen))), total_memory,
+        std::floor(total_gpu * (1 - used_fraction(gen))), total_gpu);
+    resources.predefined_resources.resize(PredefinedResources_MAX);
+    nodes.emplace(scheduling::NodeID(i), resources);
+    node_index.AddOrUpdateNode(scheduling::NodeID(i), resources);
+  }
+}
+
+TEST_F(SchedulingPolicyTest, IndexedHybridPolicyMatchesScanTest) {
+  std::mt19937 gen(42);
+  NodeResourceIndex node_index(RayConfig::instance().scheduler_spread_threshold());
+  CreateRandomCluster(200, gen, nodes, node_index);
+  auto is_node_alive = [](scheduling::NodeID node_id) { return node_id.ToInt() % 7 != 3; };
+  HybridSchedulingPolicy scan_policy(local_node, nodes, is_node_alive);
+  HybridSchedulingPolicy indexed_policy(local_node, nodes, is_node_alive, &node_index);
+
+  std::vector<ResourceRequest> requests = {
+      ResourceMapToResourceRequest({{"CPU", 1}}, false),
+      ResourceMapToResourceRequest({{"CPU", 4}, {"memory", 8}}, false),
+      ResourceMapToResourceRequest({{"CPU", 1}, {"GPU", 1}}, false),
+      ResourceMapToResourceRequest({{"CPU", 32}}, false),
+      ResourceMapToResourceRequest({}, false)};
+  std::uniform_int_distribution<int> pick(0, requests.size() - 1);
+  for (int i = 0; i < 2000; i++) {
+    const auto &req = requests[pick(gen)];
+    auto options = HybridOptions(0.5, /*avoid_local_node*/ i % 5 == 0,
+                                 /*require_node_available*/ i % 3 == 0,
+                                 /*avoid_gpu_nodes*/ i % 2 == 0);
+    auto expected = scan_policy.Schedule(req, options);
+    ASSERT_EQ(indexed_policy.Schedule(req, options), expected) << "iteration " << i;
+    // Allocate the request, so that the index is updated as it would be by the
+    // cluster resource manager.
+    if (!expected.IsNil()) {
+      auto &node = nodes.at(expected);
+      auto *resources = node.GetMutableLocalView();
+      for (size_t r = 0; r < PredefinedResources_MAX; r++) {
+        resources->predefined_resources[r].available = std::max(
+            FixedPoint(0),
+            resources->predefined_resources[r].available - req.predefined_resources[r]);
+      }
+      node_index.AddOrUpdateNode(expected, *resources);
+    }
+  }
+}
+
+TEST_F(SchedulingPolicyTest, HybridPolicyLargeClusterBenchmark) {
+  // Compares the time of scheduling decisions with and without the node index in a
+  // large, mostly saturated cluster.
+  const int num_nodes = 2000;
+  const int num_decisions = 2000;
+  std::mt19937 gen(0);
+  NodeResourceIndex node_index(RayConfig::instance().scheduler_spread_threshold());
+  CreateRandomCluster(num_nodes, gen, nodes, node_index);
+  HybridSchedulingPolicy scan_policy(local_node, nodes, [](auto) { return true; });
+  HybridSchedulingPolicy indexed_policy(local_node, nodes, [](auto) { return true; },
+                                        &node_index);
+  auto req = ResourceMapToResourceRequest({{"CPU", 12}}, false);
+  auto options = HybridOptions(0.5, false, false);
+
+  auto time_decisions = [&](HybridSchedulingPolicy &policy) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_decisions; i++) {
+      policy.Schedule(req, options);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  auto scan_us = time_decisions(scan_policy);
+  auto indexed_us = time_decisions(indexed_policy);
+  RAY_LOG(INFO) << num_decisions << " scheduling decisions on " << num_nodes
+                << " nodes took " << scan_us << "us by scanning all nodes and "
+                << indexed_us << "us with the node index.";
+  ASSERT_EQ(indexed_policy.Schedule(req, options), scan_policy.Schedule(req, options));
+}
+
+TEST_F(SchedulingPolicyTest, HybridPolicyBatchMatchesSequentialTest) {
+  auto is_node_alive = [](scheduling::NodeID node_id) { return node_id.ToInt() % 7 != 3; };
+  std::vector<ResourceRequest> requests = {
+      ResourceMapToResourceRequest({{"CPU", 1}}, false),
+      ResourceMapToResourceRequest({{"CPU", 0.5}, {"memory", 3}}, false),
+      ResourceMapToResourceRequest({{"CPU", 1}, {"GPU", 1}}, false),
+      ResourceMapToResourceRequest({{"CPU", 32}}, false)};
+  for (int i = 0; i < 32; i++) {
+    std::mt19937 gen(i);
+    NodeResourceIndex node_index(RayConfig::instance().scheduler_spread_threshold());
+    nodes.clear();
+    CreateRandomCluster(50, gen, nodes, node_index);
+    const auto &req = requests[i % requests.size()];
+    const int64_t num_requests = 1 + i * 17;
+    auto options = HybridOptions(0.5, /*avoid_local_node*/ i % 5 == 0,
+                                 /*require_node_available*/ i % 3 == 0,
+                                 /*avoid_gpu_nodes*/ i % 2 == 0);
+    const bool prioritize_local_node = i % 4 == 1;
+
+    HybridSchedulingPolicy policy(local_node, nodes, is_node_alive);
+    auto placements =
+        policy.ScheduleBatch(req, num_requests, options, prioritize_local_node);
+
+    // Schedule the requests one by one, reserving the resources of every request on
+    // its node if they are available, like the cluster task manager does.
+    absl::flat_hash_map<scheduling::NodeID, int64_t> expected;
+    for (int64_t r = 0; r < num_requests; r++) {
+      auto node_id = scheduling::NodeID::Nil();
+      if (prioritize_local_node && !options.avoid_local_node &&
+          nodes.at(local_node).GetLocalView().IsAvailable(req, true)) {
+        node_id = local_node;
+      } else {
+        node_id = policy.Schedule(req, options);
+      }
+      if (node_id.IsNil()) {
+        break;
+      }
+      expected[node_id]++;
+      auto *resources = nodes.at(node_id).GetMutableLocalView();
+      if (resources->IsAvailable(req, node_id == local_node)) {
+        for (size_t k = 0; k < PredefinedResources_MAX; k++) {
+          resources->predefined_resources[k].available -= req.predefined_resources[k];
+        }
+      }
+    }
+
+    absl::flat_hash_map<scheduling::NodeID, int64_t> actual;
+    for (const auto &[node_id, count] : placements) {
+      ASSERT_GT(count, 0);
+      ASSERT_TRUE(actual.emplace(node_id, count).second);
+    }
+    ASSERT_EQ(actual, expected) << "case " << i;
+  }
+}
+
+TEST_F(SchedulingPolicyTest, HybridPolicyBatchBenchmark) {
+  // Compares the time of placing a large batch of identical requests one by one and in
+  // one batch.
+  const int num_nodes = 1000;
+  const int64_t num_requests = 20000;
+  std::mt19937 gen(0);
+  NodeResourceIndex node_index(RayConfig::instance().scheduler_spread_threshold());
+  CreateRandomCluster(num_nodes, gen, nodes, node_index);
+  HybridSchedulingPolicy policy(local_node, nodes, [](auto) { return true; },
+                                &node_index);
+  auto req = ResourceMapToResourceRequest({{"CPU", 1}}, false);
+  auto options = HybridOptions(0.5, false, false);
+
+  auto start = std::chrono::steady_clock::now();
+  auto placements = policy.ScheduleBatch(req, num_requests, options, false);
+  auto batch_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  int64_t num_placed = 0;
+  for (const auto &placement : placements) {
+    num_placed += placement.second;
+  }
+  ASSERT_EQ(num_placed, num_requests);
+
+  start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < num_requests; i++) {
+    auto node_id = policy.Schedule(req, options);
+    auto *resources = nodes.at(node_id).GetMutableLocalView();
+    if (resources->IsAvailable(req, node_id == local_node)) {
+      resources->predefined_resources[CPU].available -= req.predefined_resources[CPU];
+      node_index.AddOrUpdateNode(node_id, *resources);
+    }
+  }
+  auto sequential_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  RAY_LOG(INFO) << "Placing " << num_requests << " requests on " << num_nodes
+                << " nodes took " << sequential_us << "us one by one and " << batch_us
+                << "us in one batch.";
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,174 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/worker_demand_forecaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "ray/stats/metric.h"
+#include "ray/util/logging.h"
+
+DEFINE_stats(worker_demand_forecast,
+             "The forecasted number of workers needed by a scheduling class.",
+             ("SchedulingClass"), (), ray::stats::GAUGE);
+DEFINE_stats(worker_demand_arrival_rate,
+             "The moving average of worker requests per second of a scheduling class.",
+             ("SchedulingClass"), (), ray::stats::GAUGE);
+
+namespace {
+
+// Demand below this is treated as zero. This keeps the tail of the moving average from
+// pinning a warm worker forever.
+constexpr double kDemandEpsilon = 0.1;
+
+// Windows beyond this many without any update leave nothing of the moving averages,
+// so there is no point in folding them one by one.
+constexpr int64_t kMaxWindowsToFold = 64;
+
+}  // namespace
+
+namespace ray {
+
+namespace raylet {
+
+WorkerDemandForecaster::WorkerDemandForecaster(int64_t window_ms, double ewma_alpha)
+    : window_ms_(window_ms), ewma_alpha_(ewma_alpha) {
+  RAY_CHECK(window_ms_ > 0);
+  RAY_CHECK(ewma_alpha_ > 0 && ewma_alpha_ <= 1);
+}
+
+void WorkerDemandForecaster::RecordArrival(const TaskSpecification &task_spec,
+                                           int64_t now_ms) {
+  if (window_start_ms_ < 0) {
+    window_start_ms_ = now_ms;
+  }
+  Update(now_ms);
+  auto &stats =
+      demand_[{task_spec.GetSchedulingClass(), task_spec.GetRuntimeEnvHash()}];
+  stats.task_spec = task_spec;
+  stats.window_arrivals++;
+}
+
+void WorkerDemandForecaster::RecordWorkerLeased(const TaskSpecification &task_spec,
+                                                const WorkerID &worker_id) {
+  DemandKey key = {task_spec.GetSchedulingClass(), task_spec.GetRuntimeEnvHash()};
+  if (!leased_workers_.emplace(worker_id, key).second) {
+    return;
+  }
+  auto &stats = demand_[key];
+  if (stats.task_spec.GetMessage().task_id().empty()) {
+    stats.task_spec = task_spec;
+  }
+  stats.num_leased++;
+  stats.window_peak_leased = std::max(stats.window_peak_leased, stats.num_leased);
+}
+
+void WorkerDemandForecaster::RecordWorkerReturned(const WorkerID &worker_id) {
+  auto it = leased_workers_.find(worker_id);
+  if (it == leased_workers_.end()) {
+    return;
+  }
+  auto stats_it = demand_.find(it->second);
+  RAY_CHECK(stats_it != demand_.end());
+  RAY_CHECK(stats_it->second.num_leased > 0);
+  stats_it->second.num_leased--;
+  leased_workers_.erase(it);
+}
+
+void WorkerDemandForecaster::Update(int64_t now_ms) {
+  if (window_start_ms_ < 0 || now_ms - window_start_ms_ < window_ms_) {
+    return;
+  }
+  int64_t num_windows = (now_ms - window_start_ms_) / window_ms_;
+  window_start_ms_ += num_windows * window_ms_;
+  num_windows = std::min(num_windows, kMaxWindowsToFold);
+
+  for (auto it = demand_.begin(); it != demand_.end();) {
+    auto &stats = it->second;
+    for (int64_t i = 0; i < num_windows; i++) {
+      stats.ewma_arrivals =
+          ewma_alpha_ * stats.window_arrivals + (1 - ewma_alpha_) * stats.ewma_arrivals;
+      stats.ewma_peak_leased = ewma_alpha_ * stats.window_peak_leased +
+                               (1 - ewma_alpha_) * stats.ewma_peak_leased;
+      // Windows after the first one saw no arrivals, and the workers leased at the
+      // end of the first one stayed leased throughout.
+      stats.window_arrivals = 0;
+      stats.window_peak_leased = stats.num_leased;
+    }
+    if (stats.num_leased == 0 && stats.ewma_arrivals < kDemandEpsilon &&
+        stats.ewma_peak_leased < kDemandEpsilon) {
+      demand_.erase(it++);
+    } else {
+      it++;
+    }
+  }
+}
+
+int64_t WorkerDemandForecaster::GetForecast(const DemandKey &key) const {
+  auto it = demand_.find(key);
+  if (it == demand_.end()) {
+    return 0;
+  }
+  return static_cast<int64_t>(
+      std::max(0.0, std::ceil(it->second.ewma_peak_leased - kDemandEpsilon)));
+}
+
+double WorkerDemandForecaster::GetArrivalRate(const DemandKey &key) const {
+  auto it = demand_.find(key);
+  if (it == demand_.end()) {
+    return 0;
+  }
+  return it->second.ewma_arrivals * 1000 / window_ms_;
+}
+
+std::vector<std::pair<TaskSpecification, int64_t>> WorkerDemandForecaster::GetForecasts()
+    const {
+  std::vector<std::pair<TaskSpecification, int64_t>> forecasts;
+  for (const auto &entry : demand_) {
+    auto forecast = GetForecast(entry.first);
+    if (forecast > 0 && !entry.second.task_spec.GetMessage().task_id().empty()) {
+      forecasts.emplace_back(entry.second.task_spec, forecast);
+    }
+  }
+  return forecasts;
+}
+
+void WorkerDemandForecaster::RecordMetrics() const {
+  for (const auto &entry : demand_) {
+    auto scheduling_class = std::to_string(entry.first.first);
+    STATS_worker_demand_forecast.Record(GetForecast(entry.first), scheduling_class);
+    STATS_worker_demand_arrival_rate.Record(GetArrivalRate(entry.first),
+                                            scheduling_class);
+  }
+}
+
+std::string WorkerDemandForecaster::DebugString() const {
+  std::stringstream result;
+  result << "WorkerDemandForecaster:";
+  result << "\n- num tracked scheduling classes: " << demand_.size();
+  result << "\n- num leased workers: " << leased_workers_.size();
+  for (const auto &entry : demand_) {
+    result << "\n- scheduling class " << entry.first.first << ", runtime env hash "
+           << entry.first.second << ": arrival rate " << GetArrivalRate(entry.first)
+           << "/s, leased " << entry.second.num_leased << ", forecast "
+           << GetForecast(entry.first);
+  }
+  return result.str();
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,108 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "ray/common/id.h"
+#include "ray/common/task/task_spec.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// \class WorkerDemandForecaster
+///
+/// Tracks the demand for workers per scheduling class and runtime env, and forecasts
+/// how many workers each of them will need, so that the worker pool can keep that
+/// many workers warm instead of repeatedly killing and restarting them under
+/// periodic load.
+///
+/// Demand is measured as the peak number of workers concurrently leased to a class
+/// within a window. By Little's law, this accounts for both the arrival rate and the
+/// duration of the tasks. The peaks (and arrival counts, for reporting) of finished
+/// windows are folded into exponentially weighted moving averages.
+class WorkerDemandForecaster {
+ public:
+  /// Demand is tracked per scheduling class and runtime env hash.
+  using DemandKey = std::pair<SchedulingClass, int>;
+
+  /// \param window_ms The length of a demand aggregation window.
+  /// \param ewma_alpha The weight of the latest window in the moving averages.
+  WorkerDemandForecaster(int64_t window_ms, double ewma_alpha);
+
+  /// Record that a worker was requested for the given task.
+  ///
+  /// \param task_spec The task that needs a worker.
+  /// \param now_ms The current time.
+  void RecordArrival(const TaskSpecification &task_spec, int64_t now_ms);
+
+  /// Record that a worker was leased to the given task.
+  void RecordWorkerLeased(const TaskSpecification &task_spec, const WorkerID &worker_id);
+
+  /// Record that a worker was returned to the pool or disconnected. No-op if the
+  /// worker wasn't leased through `RecordWorkerLeased`.
+  void RecordWorkerReturned(const WorkerID &worker_id);
+
+  /// Fold the windows that finished before `now_ms` into the moving averages, and
+  /// forget classes whose demand has decayed to zero.
+  void Update(int64_t now_ms);
+
+  /// The forecasted number of workers needed by the given class.
+  int64_t GetForecast(const DemandKey &key) const;
+
+  /// The moving average of the arrival rate of the given class, in tasks per second.
+  double GetArrivalRate(const DemandKey &key) const;
+
+  /// The forecasted number of workers of every class with nonzero demand, along with
+  /// the latest task of that class to start workers for.
+  std::vector<std::pair<TaskSpecification, int64_t>> GetForecasts() const;
+
+  /// Record the arrival rate and forecast of every class as metrics.
+  void RecordMetrics() const;
+
+  std::string DebugString() const;
+
+ private:
+  struct DemandStats {
+    /// The latest task of this class.
+    TaskSpecification task_spec;
+    /// The number of workers requested in the current window.
+    int64_t window_arrivals = 0;
+    /// The number of workers currently leased.
+    int64_t num_leased = 0;
+    /// The peak number of workers leased at once in the current window.
+    int64_t window_peak_leased = 0;
+    /// The moving average of arrivals per window.
+    double ewma_arrivals = 0;
+    /// The moving average of the per-window peak of leased workers.
+    double ewma_peak_leased = 0;
+  };
+
+  const int64_t window_ms_;
+  const double ewma_alpha_;
+  /// The start time of the current window. -1 before the first arrival.
+  int64_t window_start_ms_ = -1;
+  absl::flat_hash_map<DemandKey, DemandStats> demand_;
+  /// The class each currently leased worker was leased to.
+  absl::flat_hash_map<WorkerID, DemandKey> leased_workers_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,141 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/worker_demand_forecaster.h"
+
+#include "gtest/gtest.h"
+
+namespace ray {
+
+namespace raylet {
+
+const int64_t kWindowMs = 1000;
+
+static inline TaskSpecification ExampleTaskSpec(double num_cpus) {
+  rpc::TaskSpec message;
+  message.set_job_id(JobID::FromInt(1).Binary());
+  message.set_language(Language::PYTHON);
+  message.set_task_id(TaskID::FromRandom(JobID::FromInt(1)).Binary());
+  message.set_type(TaskType::NORMAL_TASK);
+  (*message.mutable_required_resources())["CPU"] = num_cpus;
+  return TaskSpecification(std::move(message));
+}
+
+class WorkerDemandForecasterTest : public ::testing::Test {
+ public:
+  WorkerDemandForecasterTest() : forecaster_(kWindowMs, /*ewma_alpha=*/0.5) {}
+
+  WorkerDemandForecaster::DemandKey KeyOf(const TaskSpecification &task_spec) {
+    return {task_spec.GetSchedulingClass(), task_spec.GetRuntimeEnvHash()};
+  }
+
+  /// Lease `num_workers` workers to the given task, and return them all.
+  std::vector<WorkerID> Lease(const TaskSpecification &task_spec, int num_workers,
+                              int64_t now_ms) {
+    std::vector<WorkerID> worker_ids;
+    for (int i = 0; i < num_workers; i++) {
+      forecaster_.RecordArrival(task_spec, now_ms);
+      worker_ids.push_back(WorkerID::FromRandom());
+      forecaster_.RecordWorkerLeased(task_spec, worker_ids.back());
+    }
+    return worker_ids;
+  }
+
+  void Return(const std::vector<WorkerID> &worker_ids) {
+    for (const auto &worker_id : worker_ids) {
+      forecaster_.RecordWorkerReturned(worker_id);
+    }
+  }
+
+ protected:
+  WorkerDemandForecaster forecaster_;
+};
+
+TEST_F(WorkerDemandForecasterTest, TestForecastFollowsPeakConcurrency) {
+  auto task_spec = ExampleTaskSpec(1);
+  auto key = KeyOf(task_spec);
+  ASSERT_EQ(forecaster_.GetForecast(key), 0);
+
+  // The forecast only changes once a window finishes.
+  Return(Lease(task_spec, 4, 0));
+  ASSERT_EQ(forecaster_.GetForecast(key), 0);
+  forecaster_.Update(kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 2);
+  ASSERT_DOUBLE_EQ(forecaster_.GetArrivalRate(key), 2);
+
+  // Another window with the same peak moves the forecast towards it.
+  Return(Lease(task_spec, 4, kWindowMs));
+  forecaster_.Update(2 * kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 3);
+
+  auto forecasts = forecaster_.GetForecasts();
+  ASSERT_EQ(forecasts.size(), 1);
+  ASSERT_EQ(forecasts[0].first.GetSchedulingClass(), task_spec.GetSchedulingClass());
+  ASSERT_EQ(forecasts[0].second, 3);
+}
+
+TEST_F(WorkerDemandForecasterTest, TestLongRunningLeasesKeepDemand) {
+  auto task_spec = ExampleTaskSpec(1);
+  auto key = KeyOf(task_spec);
+  auto worker_ids = Lease(task_spec, 2, 0);
+  // Workers that stay leased count towards the peak of every window.
+  forecaster_.Update(10 * kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 2);
+  ASSERT_LT(forecaster_.GetArrivalRate(key), 0.01);
+
+  Return(worker_ids);
+  // Returning the same worker twice is a no-op.
+  Return(worker_ids);
+  // The current window still saw both leases, the next one doesn't.
+  forecaster_.Update(12 * kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 1);
+}
+
+TEST_F(WorkerDemandForecasterTest, TestDemandDecaysAndIsForgotten) {
+  auto task_spec = ExampleTaskSpec(1);
+  auto key = KeyOf(task_spec);
+  Return(Lease(task_spec, 8, 0));
+  forecaster_.Update(kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 4);
+
+  forecaster_.Update(2 * kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 2);
+
+  // Long idle periods decay the demand to zero and drop the class.
+  forecaster_.Update(100 * kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(key), 0);
+  ASSERT_TRUE(forecaster_.GetForecasts().empty());
+}
+
+TEST_F(WorkerDemandForecasterTest, TestClassesAreTrackedSeparately) {
+  auto small_task = ExampleTaskSpec(1);
+  auto large_task = ExampleTaskSpec(2);
+  ASSERT_NE(small_task.GetSchedulingClass(), large_task.GetSchedulingClass());
+
+  Return(Lease(small_task, 2, 0));
+  Return(Lease(large_task, 6, 0));
+  forecaster_.Update(kWindowMs);
+  ASSERT_EQ(forecaster_.GetForecast(KeyOf(small_task)), 1);
+  ASSERT_EQ(forecaster_.GetForecast(KeyOf(large_task)), 3);
+  ASSERT_EQ(forecaster_.GetForecasts().size(), 2);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
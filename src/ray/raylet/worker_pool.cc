@@ -26,6 +26,7 @@
 #include "ray/core_worker/common.h"
 #include "ray/gcs/pb_util.h"
 #include "ray/stats/metric_defs.h"
+#include "ray/util/filesystem.h"
 #include "ray/util/logging.h"
 #include "ray/util/util.h"
 
@@ -38,6 +39,9 @@ namespace {
 // duplicate with other ids.
 static const std::string kWorkerSetupTokenPrefix = "worker_startup_token:";
 
+// The prefix of the runtime env URI references held by worker zygotes.
+static const std::string kWorkerZygotePrefix = "worker_zygote:";
+
 // A helper function to get a worker from a list.
 std::shared_ptr<ray::raylet::WorkerInterface> GetWorker(
     const std::unordered_set<std::shared_ptr<ray::raylet::WorkerInterface>> &worker_pool,
@@ -138,6 +142,16 @@ WorkerPool::WorkerPool(instrumented_io_context &io_service, const NodeID node_id
         RayConfig::instance().kill_idle_workers_interval_ms(),
         "RayletWorkerPool.deadline_timer.kill_idle_workers");
   }
+  if (RayConfig::instance().enable_adaptive_worker_prestart()) {
+    demand_forecaster_ = std::make_unique<WorkerDemandForecaster>(
+        RayConfig::instance().adaptive_worker_prestart_window_ms(),
+        RayConfig::instance().adaptive_worker_prestart_ewma_alpha());
+    auto interval_ms = RayConfig::instance().kill_idle_workers_interval_ms() > 0
+                           ? RayConfig::instance().kill_idle_workers_interval_ms()
+                           : RayConfig::instance().adaptive_worker_prestart_window_ms();
+    periodical_runner_.RunFnPeriodically([this] { MaintainWarmPool(); }, interval_ms,
+                                         "RayletWorkerPool.deadline_timer.warm_pool");
+  }
 }
 
 WorkerPool::~WorkerPool() {
@@ -200,11 +214,12 @@ void WorkerPool::update_worker_startup_token_counter() {
 void WorkerPool::AddStartingWorkerProcess(
     State &state, const int workers_to_start, const rpc::WorkerType worker_type,
     const Process &proc, const std::chrono::high_resolution_clock::time_point &start,
-    const rpc::RuntimeEnvInfo &runtime_env_info) {
+    const rpc::RuntimeEnvInfo &runtime_env_info, const JobID &job_id,
+    const int runtime_env_hash) {
   state.starting_worker_processes.emplace(
       worker_startup_token_counter_,
       StartingWorkerProcessInfo{workers_to_start, workers_to_start, worker_type, proc,
-                                start, runtime_env_info});
+                                start, runtime_env_info, job_id, runtime_env_hash});
   runtime_env_manager_.AddURIReference(
       kWorkerSetupTokenPrefix + std::to_string(worker_startup_token_counter_),
       runtime_env_info);
@@ -446,18 +461,30 @@ std::tuple<Process, StartupToken> WorkerPool::StartWorkerProcess(
 
   // Start a process and measure the startup time.
   auto start = std::chrono::high_resolution_clock::now();
-  Process proc = StartProcess(worker_command_args, env);
-  auto end = std::chrono::high_resolution_clock::now();
-  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-  stats::ProcessStartupTimeMs.Record(duration.count());
+  std::shared_ptr<WorkerZygote> zygote;
+  if (IsZygoteEligible(language, worker_type, dynamic_options)) {
+    zygote = GetOrStartZygote(state, runtime_env_hash, runtime_env_info,
+                              worker_command_args, env);
+  }
+  // A worker forked from a zygote has a null process until the zygote replies.
+  Process proc;
+  if (zygote == nullptr) {
+    proc = StartProcess(worker_command_args, env);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    stats::ProcessStartupTimeMs.Record(duration.count());
+    RAY_LOG(INFO) << "Started worker process of " << workers_to_start
+                  << " worker(s) with pid " << proc.GetId() << ", the token "
+                  << worker_startup_token_counter_;
+  }
   stats::NumWorkersStarted.Record(1);
-  RAY_LOG(INFO) << "Started worker process of " << workers_to_start
-                << " worker(s) with pid " << proc.GetId() << ", the token "
-                << worker_startup_token_counter_;
-  MonitorStartingWorkerProcess(proc, worker_startup_token_counter_, language,
-                               worker_type);
+  MonitorStartingWorkerProcess(worker_startup_token_counter_, language, worker_type);
   AddStartingWorkerProcess(state, workers_to_start, worker_type, proc, start,
-                           runtime_env_info);
+                           runtime_env_info, job_id, runtime_env_hash);
+  if (zygote != nullptr) {
+    ForkWorkerProcessFromZygote(*zygote, language, worker_startup_token_counter_,
+                                worker_command_args, env);
+  }
   StartupToken worker_startup_token = worker_startup_token_counter_;
   update_worker_startup_token_counter();
   if (IsIOWorkerType(worker_type)) {
@@ -467,15 +494,14 @@ std::tuple<Process, StartupToken> WorkerPool::StartWorkerProcess(
   return {proc, worker_startup_token};
 }
 
-void WorkerPool::MonitorStartingWorkerProcess(const Process &proc,
-                                              StartupToken proc_startup_token,
+void WorkerPool::MonitorStartingWorkerProcess(StartupToken proc_startup_token,
                                               const Language &language,
                                               const rpc::WorkerType worker_type) {
   auto timer = std::make_shared<boost::asio::deadline_timer>(
       *io_service_, boost::posix_time::seconds(
                         RayConfig::instance().worker_register_timeout_seconds()));
   // Capture timer in lambda to copy it once, so that it can avoid destructing timer.
-  timer->async_wait([timer, language, proc = proc, proc_startup_token, worker_type,
+  timer->async_wait([timer, language, proc_startup_token, worker_type,
                      this](const boost::system::error_code e) mutable {
     // check the error code.
     auto &state = this->GetStateForLanguage(language);
@@ -483,6 +509,7 @@ void WorkerPool::MonitorStartingWorkerProcess(const Process &proc,
     // to avoid the zombie worker.
     auto it = state.starting_worker_processes.find(proc_startup_token);
     if (it != state.starting_worker_processes.end()) {
+      auto proc = it->second.proc;
       RAY_LOG(ERROR)
           << "Some workers of the worker process(" << proc.GetId()
           << ") have not registered within the timeout. "
@@ -567,6 +594,123 @@ Process WorkerPool::StartProcess(const std::vector<std::string> &worker_command_
   return child;
 }
 
+bool WorkerPool::IsZygoteEligible(const Language &language,
+                                  const rpc::WorkerType worker_type,
+                                  const std::vector<std::string> &dynamic_options) const {
+#ifdef _WIN32
+  return false;
+#else
+  return RayConfig::instance().worker_zygote_enabled() &&
+         language == Language::PYTHON && worker_type == rpc::WorkerType::WORKER &&
+         dynamic_options.empty();
+#endif
+}
+
+std::shared_ptr<WorkerZygote> WorkerPool::GetOrStartZygote(
+    State &state, const int runtime_env_hash, const rpc::RuntimeEnvInfo &runtime_env_info,
+    const std::vector<std::string> &worker_command_args, const ProcessEnvironment &env) {
+  auto it = state.zygotes.find(runtime_env_hash);
+  if (it != state.zygotes.end() && !it->second->IsAlive()) {
+    RAY_LOG(WARNING) << "Zygote " << it->second->GetProcess().GetId()
+                     << " for runtime env hash " << runtime_env_hash
+                     << " died, restarting it.";
+    runtime_env_manager_.RemoveURIReference(kWorkerZygotePrefix +
+                                            std::to_string(runtime_env_hash));
+    state.zygotes.erase(it);
+    it = state.zygotes.end();
+  }
+  state.zygote_last_used_time_ms[runtime_env_hash] = get_time_();
+
+  if (it == state.zygotes.end()) {
+    // Start the zygote in the background. It takes as long as a regular worker to
+    // initialize, so this worker is started from scratch.
+    auto socket_path =
+        (boost::filesystem::path(GetUserTempDir()) /
+         ("ray_zygote_" + std::to_string(GetPID()) + "_" +
+          std::to_string(worker_startup_token_counter_) + ".sock"))
+            .string();
+    auto zygote_proc =
+        StartProcess(WorkerZygote::BuildCommand(worker_command_args, socket_path), env);
+    RAY_LOG(INFO) << "Started worker zygote with pid " << zygote_proc.GetId()
+                  << " for runtime env hash " << runtime_env_hash << " at "
+                  << socket_path;
+    runtime_env_manager_.AddURIReference(
+        kWorkerZygotePrefix + std::to_string(runtime_env_hash), runtime_env_info);
+    state.zygotes.emplace(runtime_env_hash,
+                          std::make_shared<WorkerZygote>(zygote_proc, socket_path,
+                                                         runtime_env_hash));
+    return nullptr;
+  }
+  return it->second;
+}
+
+void WorkerPool::ForkWorkerProcessFromZygote(
+    const WorkerZygote &zygote, const Language &language, StartupToken startup_token,
+    const std::vector<std::string> &worker_command_args, const ProcessEnvironment &env) {
+  ForkFromZygote(
+      zygote, worker_command_args, env,
+      [this, language, startup_token, worker_command_args, env](Process proc) {
+        auto &state = GetStateForLanguage(language);
+        auto it = state.starting_worker_processes.find(startup_token);
+        if (it == state.starting_worker_processes.end()) {
+          // The forked worker registered before the zygote's reply arrived, or the
+          // start timed out, in which case the worker is rejected when it registers.
+          return;
+        }
+        if (proc.IsNull()) {
+          // The zygote couldn't serve the request, so start the worker from scratch.
+          proc = StartProcess(worker_command_args, env);
+        } else {
+          num_workers_forked_from_zygote_++;
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - it->second.start_time);
+        stats::ProcessStartupTimeMs.Record(duration.count());
+        RAY_LOG(INFO) << "Started worker process with pid " << proc.GetId()
+                      << ", the token " << startup_token;
+        it->second.proc = proc;
+      });
+}
+
+void WorkerPool::ForkFromZygote(const WorkerZygote &zygote,
+                                const std::vector<std::string> &worker_command_args,
+                                const ProcessEnvironment &env,
+                                std::function<void(Process)> callback) {
+  zygote.AsyncFork(*io_service_, worker_command_args, env, std::move(callback));
+}
+
+void WorkerPool::TryKillingIdleZygotes() {
+  int64_t now = get_time_();
+  for (auto &entry : states_by_lang_) {
+    auto &state = entry.second;
+    if (state.zygotes.empty()) {
+      continue;
+    }
+    absl::flat_hash_set<int> runtime_envs_in_use;
+    for (const auto &worker : state.registered_workers) {
+      if (!worker->IsDead()) {
+        runtime_envs_in_use.insert(worker->GetRuntimeEnvHash());
+      }
+    }
+    for (auto it = state.zygotes.begin(); it != state.zygotes.end();) {
+      const int runtime_env_hash = it->first;
+      if (runtime_envs_in_use.count(runtime_env_hash) ||
+          now - state.zygote_last_used_time_ms[runtime_env_hash] <
+              RayConfig::instance().idle_worker_killing_time_threshold_ms()) {
+        it++;
+        continue;
+      }
+      RAY_LOG(DEBUG) << "Killing zygote " << it->second->GetProcess().GetId()
+                     << " since no worker with runtime env hash " << runtime_env_hash
+                     << " is left.";
+      runtime_env_manager_.RemoveURIReference(kWorkerZygotePrefix +
+                                              std::to_string(runtime_env_hash));
+      state.zygote_last_used_time_ms.erase(runtime_env_hash);
+      state.zygotes.erase(it++);
+    }
+  }
+}
+
 Status WorkerPool::GetNextFreePort(int *port) {
   if (!free_ports_) {
     *port = 0;
@@ -902,6 +1046,9 @@ void WorkerPool::PushWorker(const std::shared_ptr<WorkerInterface> &worker) {
   // Since the worker is now idle, unset its assigned task ID.
   RAY_CHECK(worker->GetAssignedTaskId().IsNil())
       << "Idle workers cannot have an assigned task ID";
+  if (demand_forecaster_) {
+    demand_forecaster_->RecordWorkerReturned(worker->WorkerId());
+  }
   auto &state = GetStateForLanguage(worker->GetLanguage());
   bool found;
   bool used;
@@ -934,6 +1081,7 @@ void WorkerPool::PushWorker(const std::shared_ptr<WorkerInterface> &worker) {
 
 void WorkerPool::TryKillingIdleWorkers() {
   RAY_CHECK(idle_of_all_languages_.size() == idle_of_all_languages_map_.size());
+  TryKillingIdleZygotes();
 
   int64_t now = get_time_();
   size_t running_size = 0;
@@ -946,6 +1094,29 @@ void WorkerPool::TryKillingIdleWorkers() {
   // idle workers that it needs to.
   RAY_CHECK(running_size >= pending_exit_idle_workers_.size());
   running_size -= pending_exit_idle_workers_.size();
+
+  // The number of idle workers to keep warm per warm pool, i.e., the target of the pool
+  // minus its busy workers.
+  absl::flat_hash_map<WarmPoolKey, int64_t> num_warm_idle_workers;
+  for (const auto &entry : GetWarmPoolTargets()) {
+    num_warm_idle_workers[entry.first] = entry.second.second;
+  }
+  if (!num_warm_idle_workers.empty()) {
+    for (const auto &entry : states_by_lang_) {
+      for (const auto &worker : entry.second.registered_workers) {
+        if (worker->IsDead() || worker->GetWorkerType() != rpc::WorkerType::WORKER ||
+            entry.second.idle.count(worker)) {
+          continue;
+        }
+        auto it = num_warm_idle_workers.find(
+            {entry.first, worker->GetAssignedJobId(), worker->GetRuntimeEnvHash()});
+        if (it != num_warm_idle_workers.end()) {
+          it->second--;
+        }
+      }
+    }
+  }
+
   // Kill idle workers in FIFO order.
   for (const auto &idle_pair : idle_of_all_languages_) {
     const auto &idle_worker = idle_pair.first;
@@ -968,6 +1139,14 @@ void WorkerPool::TryKillingIdleWorkers() {
       // This is possible because a Java worker process may hold multiple workers.
       continue;
     }
+
+    auto warm_it = num_warm_idle_workers.find(
+        {idle_worker->GetLanguage(), job_id, idle_worker->GetRuntimeEnvHash()});
+    if (warm_it != num_warm_idle_workers.end() && warm_it->second > 0) {
+      // Keep this worker warm for the forecasted demand.
+      warm_it->second--;
+      continue;
+    }
     auto worker_startup_token = idle_worker->GetStartupToken();
     auto &worker_state = GetStateForLanguage(idle_worker->GetLanguage());
 
@@ -1084,12 +1263,29 @@ void WorkerPool::TryKillingIdleWorkers() {
 }
 
 void WorkerPool::PopWorker(const TaskSpecification &task_spec,
-                           const PopWorkerCallback &callback,
+                           const PopWorkerCallback &original_callback,
                            const std::string &allocated_instances_serialized_json) {
   RAY_LOG(DEBUG) << "Pop worker for task " << task_spec.TaskId() << " task name "
                  << task_spec.FunctionDescriptor()->ToString();
   auto &state = GetStateForLanguage(task_spec.GetLanguage());
 
+  PopWorkerCallback callback = original_callback;
+  if (demand_forecaster_ && !task_spec.IsActorTask() &&
+      !(task_spec.IsActorCreationTask() && !task_spec.DynamicWorkerOptions().empty())) {
+    // Track the demand of tasks that can run on shared workers. Workers for tasks with
+    // dynamic options are dedicated to them, so there is no point in keeping them warm.
+    demand_forecaster_->RecordArrival(task_spec, get_time_());
+    callback = [this, task_spec, original_callback](
+                   const std::shared_ptr<WorkerInterface> worker, PopWorkerStatus status,
+                   const std::string &runtime_env_setup_error_message) {
+      bool used = original_callback(worker, status, runtime_env_setup_error_message);
+      if (worker && used) {
+        demand_forecaster_->RecordWorkerLeased(task_spec, worker->WorkerId());
+      }
+      return used;
+    };
+  }
+
   std::shared_ptr<WorkerInterface> worker = nullptr;
   auto start_worker_process_fn = [this, allocated_instances_serialized_json](
                                      const TaskSpecification &task_spec, State &state,
@@ -1104,7 +1300,7 @@ void WorkerPool::PopWorker(const TaskSpecification &task_spec,
         dynamic_options, task_spec.GetRuntimeEnvHash(), serialized_runtime_env_context,
         allocated_instances_serialized_json, task_spec.RuntimeEnvInfo());
     if (status == PopWorkerStatus::OK) {
-      RAY_CHECK(proc.IsValid());
+      RAY_CHECK(proc.IsValid() || proc.IsNull());
       WarnAboutSize();
       auto task_info = TaskWaitingForWorkerInfo{task_spec.TaskId(), callback};
       if (dedicated) {
@@ -1267,9 +1463,184 @@ void WorkerPool::PrestartWorkers(const TaskSpecification &task_spec, int64_t bac
   }
 }
 
+absl::flat_hash_map<WorkerPool::WarmPoolKey, std::pair<TaskSpecification, int64_t>>
+WorkerPool::GetWarmPoolTargets() const {
+  absl::flat_hash_map<WarmPoolKey, std::pair<TaskSpecification, int64_t>> targets;
+  if (!demand_forecaster_) {
+    return targets;
+  }
+  auto forecasts = demand_forecaster_->GetForecasts();
+  // Serve the classes with the highest demand first if the warm pool is capped.
+  std::sort(forecasts.begin(), forecasts.end(),
+            [](const auto &a, const auto &b) { return a.second > b.second; });
+  int64_t max_warm_workers =
+      RayConfig::instance().adaptive_worker_prestart_max_warm_workers();
+  for (const auto &[task_spec, forecast] : forecasts) {
+    const auto job_id = task_spec.JobId();
+    if (!all_jobs_.contains(job_id) || finished_jobs_.contains(job_id)) {
+      continue;
+    }
+    int64_t num_workers = forecast;
+    if (max_warm_workers >= 0) {
+      num_workers = std::min(num_workers, max_warm_workers);
+      max_warm_workers -= num_workers;
+    }
+    if (num_workers == 0) {
+      break;
+    }
+    auto &target = targets[{task_spec.GetLanguage(), job_id,
+                            task_spec.GetRuntimeEnvHash()}];
+    target.first = task_spec;
+    target.second += num_workers;
+  }
+  return targets;
+}
+
+void WorkerPool::MaintainWarmPool() {
+  demand_forecaster_->Update(get_time_());
+  demand_forecaster_->RecordMetrics();
+  auto targets = GetWarmPoolTargets();
+  for (auto it = warm_pool_runtime_env_backoff_.begin();
+       it != warm_pool_runtime_env_backoff_.end();) {
+    if (!targets.contains(it->first)) {
+      warm_pool_runtime_env_backoff_.erase(it++);
+    } else {
+      it++;
+    }
+  }
+  if (targets.empty()) {
+    return;
+  }
+
+  // Count the workers of every warm pool, whether they're idle, leased or starting.
+  auto num_workers = warm_workers_pending_runtime_env_;
+  for (const auto &entry : states_by_lang_) {
+    for (const auto &worker : entry.second.registered_workers) {
+      if (!worker->IsDead() && worker->GetWorkerType() == rpc::WorkerType::WORKER &&
+          !pending_exit_idle_workers_.contains(worker->WorkerId())) {
+        num_workers[{entry.first, worker->GetAssignedJobId(),
+                     worker->GetRuntimeEnvHash()}]++;
+      }
+    }
+    for (const auto &starting : entry.second.starting_worker_processes) {
+      if (starting.second.worker_type == rpc::WorkerType::WORKER) {
+        num_workers[{entry.first, starting.second.job_id,
+                     starting.second.runtime_env_hash}] +=
+            starting.second.num_starting_workers;
+      }
+    }
+  }
+
+  for (const auto &[key, target] : targets) {
+    for (int64_t i = num_workers[key]; i < target.second; i++) {
+      auto backoff_it = warm_pool_runtime_env_backoff_.find(key);
+      if (backoff_it != warm_pool_runtime_env_backoff_.end() &&
+          get_time_() < backoff_it->second.second) {
+        // Creating the runtime env of this pool failed recently.
+        break;
+      }
+      if (!PrestartWarmWorker(target.first)) {
+        return;
+      }
+    }
+  }
+}
+
+bool WorkerPool::PrestartWarmWorker(const TaskSpecification &task_spec) {
+  if (task_spec.HasRuntimeEnv()) {
+    // The worker is only started once its runtime env is created, so the workers that
+    // are waiting for theirs count against the startup concurrency too. Otherwise
+    // runtime envs would keep being created for workers that can't be started.
+    int64_t num_starting = 0;
+    for (const auto &[pending_key, num_pending] : warm_workers_pending_runtime_env_) {
+      if (std::get<0>(pending_key) == task_spec.GetLanguage()) {
+        num_starting += num_pending;
+      }
+    }
+    for (const auto &entry :
+         GetStateForLanguage(task_spec.GetLanguage()).starting_worker_processes) {
+      if (entry.second.worker_type == rpc::WorkerType::WORKER) {
+        num_starting += entry.second.num_starting_workers;
+      }
+    }
+    if (num_starting >= maximum_startup_concurrency_) {
+      process_failed_rate_limited_++;
+      return false;
+    }
+
+    WarmPoolKey key = {task_spec.GetLanguage(), task_spec.JobId(),
+                       task_spec.GetRuntimeEnvHash()};
+    warm_workers_pending_runtime_env_[key]++;
+    CreateRuntimeEnv(
+        task_spec.SerializedRuntimeEnv(), task_spec.JobId(),
+        [this, key, task_spec](bool successful,
+                               const std::string &serialized_runtime_env_context,
+                               const std::string &setup_error_message) {
+          auto it = warm_workers_pending_runtime_env_.find(key);
+          RAY_CHECK(it != warm_workers_pending_runtime_env_.end());
+          if (--it->second == 0) {
+            warm_workers_pending_runtime_env_.erase(it);
+          }
+          if (!successful) {
+            process_failed_runtime_env_setup_failed_++;
+            // Back off exponentially, so that a runtime env that can't be created
+            // isn't created again on every round. The creations that were already
+            // in flight when the backoff started don't extend it.
+            auto &[backoff_ms, retry_at_ms] = warm_pool_runtime_env_backoff_[key];
+            const auto now = get_time_();
+            if (now >= retry_at_ms) {
+              backoff_ms =
+                  backoff_ms == 0
+                      ? RayConfig::instance()
+                            .adaptive_worker_prestart_runtime_env_backoff_ms()
+                      : std::min<double>(
+                            2 * backoff_ms,
+                            RayConfig::instance()
+                                .adaptive_worker_prestart_max_runtime_env_backoff_ms());
+              retry_at_ms = now + backoff_ms;
+            }
+            RAY_LOG(DEBUG) << "Couldn't create the runtime env of a warm worker for job "
+                           << task_spec.JobId() << ", not retrying for "
+                           << retry_at_ms - now << "ms: " << setup_error_message;
+            return;
+          }
+          warm_pool_runtime_env_backoff_.erase(key);
+          PopWorkerStatus status;
+          StartWorkerProcess(task_spec.GetLanguage(), rpc::WorkerType::WORKER,
+                             task_spec.JobId(), &status, {},
+                             task_spec.GetRuntimeEnvHash(),
+                             serialized_runtime_env_context, "{}",
+                             task_spec.RuntimeEnvInfo());
+          if (status != PopWorkerStatus::OK) {
+            // The startup concurrency was checked before creating the runtime env, but
+            // other workers may have started in the meantime.
+            RAY_LOG(DEBUG) << "Couldn't start a warm worker for job " << task_spec.JobId()
+                           << " after creating its runtime env, status "
+                           << static_cast<int>(status);
+            num_warm_workers_failed_to_start_++;
+            return;
+          }
+          num_workers_prestarted_for_demand_++;
+        });
+    return true;
+  }
+
+  PopWorkerStatus status;
+  StartWorkerProcess(task_spec.GetLanguage(), rpc::WorkerType::WORKER, task_spec.JobId(),
+                     &status);
+  if (status != PopWorkerStatus::OK) {
+    return false;
+  }
+  num_workers_prestarted_for_demand_++;
+  return true;
+}
+
 bool WorkerPool::DisconnectWorker(const std::shared_ptr<WorkerInterface> &worker,
                                   rpc::WorkerExitType disconnect_type) {
   runtime_env_manager_.RemoveURIReference(worker->WorkerId().Hex());
+  if (demand_forecaster_) {
+    demand_forecaster_->RecordWorkerReturned(worker->WorkerId());
+  }
   auto &state = GetStateForLanguage(worker->GetLanguage());
   RAY_CHECK(RemoveWorker(state.registered_workers, worker));
   RAY_UNUSED(RemoveWorker(state.pending_disconnection_workers, worker));
@@ -1474,6 +1845,11 @@ std::string WorkerPool::DebugString() const {
          << process_failed_pending_registration_;
   result << "\n- process_failed_runtime_env_setup_failed: "
          << process_failed_runtime_env_setup_failed_;
+  result << "\n- num workers forked from zygote: " << num_workers_forked_from_zygote_;
+  result << "\n- num workers prestarted for forecasted demand: "
+         << num_workers_prestarted_for_demand_;
+  result << "\n- num warm workers failed to start after creating their runtime env: "
+         << num_warm_workers_failed_to_start_;
   for (const auto &entry : states_by_lang_) {
     result << "\n- num " << Language_Name(entry.first)
            << " workers: " << entry.second.registered_workers.size();
@@ -1485,9 +1861,14 @@ std::string WorkerPool::DebugString() const {
            << entry.second.restore_io_worker_state.pending_io_tasks.size();
     result << "\n- num util functions queued: "
            << entry.second.util_io_worker_state.pending_io_tasks.size();
+    result << "\n- num " << Language_Name(entry.first)
+           << " zygotes: " << entry.second.zygotes.size();
   }
   result << "\n- num idle workers: " << idle_of_all_languages_.size();
   result << "\n" << runtime_env_manager_.DebugString();
+  if (demand_forecaster_) {
+    result << "\n" << demand_forecaster_->DebugString();
+  }
   return result.str();
 }
 
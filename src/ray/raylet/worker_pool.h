@@ -20,6 +20,7 @@
 #include <boost/asio/io_service.hpp>
 #include <boost/functional/hash.hpp>
 #include <queue>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -34,6 +35,8 @@
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/raylet/agent_manager.h"
 #include "ray/raylet/worker.h"
+#include "ray/raylet/worker_demand_forecaster.h"
+#include "ray/raylet/worker_zygote.h"
 
 namespace ray {
 
@@ -414,7 +417,8 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   //  json string.
   /// \param runtime_env_info The raw runtime env info.
   /// \return The process that we started and a token. If the token is less than 0,
-  /// we didn't start a process.
+  /// we didn't start a process. The process is null if it's being forked from a
+  /// zygote.
   std::tuple<Process, StartupToken> StartWorkerProcess(
       const Language &language, const rpc::WorkerType worker_type, const JobID &job_id,
       PopWorkerStatus *status /*output*/,
@@ -435,6 +439,18 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   virtual Process StartProcess(const std::vector<std::string> &worker_command_args,
                                const ProcessEnvironment &env);
 
+  /// Fork a new worker process from a zygote without blocking. Virtual for unit tests.
+  ///
+  /// \param zygote The zygote to fork the worker process from.
+  /// \param worker_command_args The command arguments of new worker process.
+  /// \param[in] env Additional environment variables to be set on the forked process.
+  /// \param callback Called with the forked worker process, or a null process if the
+  /// zygote could not serve the request.
+  virtual void ForkFromZygote(const WorkerZygote &zygote,
+                              const std::vector<std::string> &worker_command_args,
+                              const ProcessEnvironment &env,
+                              std::function<void(Process)> callback);
+
   /// Push an warning message to user if worker pool is getting to big.
   virtual void WarnAboutSize();
 
@@ -474,6 +490,10 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
     std::chrono::high_resolution_clock::time_point start_time;
     /// The runtime env Info.
     rpc::RuntimeEnvInfo runtime_env_info;
+    /// The job the worker process was started for.
+    JobID job_id;
+    /// The hash of the runtime env.
+    int runtime_env_hash;
   };
 
   struct TaskWaitingForWorkerInfo {
@@ -524,6 +544,11 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
     /// The last size at which a warning about the number of registered workers
     /// was generated.
     int64_t last_warning_multiple;
+    /// Pre-initialized template processes that new workers are forked from, keyed by
+    /// runtime env hash. Only used when `worker_zygote_enabled` is set.
+    absl::flat_hash_map<int, std::shared_ptr<WorkerZygote>> zygotes;
+    /// The last time a worker was forked from the zygote of a runtime env hash.
+    absl::flat_hash_map<int, int64_t> zygote_last_used_time_ms;
   };
 
   /// Pool states per language.
@@ -545,7 +570,7 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   /// (due to worker process crash or any other reasons), remove them
   /// from `starting_worker_processes`. Otherwise if we'll mistakenly
   /// think there are unregistered workers, and won't start new workers.
-  void MonitorStartingWorkerProcess(const Process &proc, StartupToken proc_startup_token,
+  void MonitorStartingWorkerProcess(StartupToken proc_startup_token,
                                     const Language &language,
                                     const rpc::WorkerType worker_type);
 
@@ -634,10 +659,66 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
   void AddStartingWorkerProcess(
       State &state, const int workers_to_start, const rpc::WorkerType worker_type,
       const Process &proc, const std::chrono::high_resolution_clock::time_point &start,
-      const rpc::RuntimeEnvInfo &runtime_env_info);
+      const rpc::RuntimeEnvInfo &runtime_env_info, const JobID &job_id,
+      const int runtime_env_hash);
 
   void RemoveStartingWorkerProcess(State &state, const StartupToken &proc_startup_token);
 
+  /// Whether workers of the given kind can be forked from a zygote. Only plain Python
+  /// workers are supported: I/O workers and workers with dynamic options need their
+  /// own command line, and other runtimes (e.g., the JVM) are not fork-safe.
+  bool IsZygoteEligible(const Language &language, const rpc::WorkerType worker_type,
+                        const std::vector<std::string> &dynamic_options) const;
+
+  /// Get the zygote of the given runtime env to fork a worker process from. If there
+  /// is no zygote for the runtime env yet, one is started from the given command line
+  /// and nullptr is returned so that the caller starts this worker normally.
+  ///
+  /// \param state The pool state of the worker's language.
+  /// \param runtime_env_hash The hash of the worker's runtime env.
+  /// \param runtime_env_info The worker's runtime env info.
+  /// \param worker_command_args The command arguments of the new worker process.
+  /// \param env Additional environment variables of the new worker process.
+  /// \return The zygote, or nullptr if it was just started.
+  std::shared_ptr<WorkerZygote> GetOrStartZygote(
+      State &state, const int runtime_env_hash,
+      const rpc::RuntimeEnvInfo &runtime_env_info,
+      const std::vector<std::string> &worker_command_args, const ProcessEnvironment &env);
+
+  /// Fork a worker process from a zygote in the background, and set it as the process
+  /// of the starting worker process with the given startup token. If the zygote can't
+  /// serve the request, the worker process is started from scratch instead.
+  void ForkWorkerProcessFromZygote(const WorkerZygote &zygote, const Language &language,
+                                   StartupToken startup_token,
+                                   const std::vector<std::string> &worker_command_args,
+                                   const ProcessEnvironment &env);
+
+  /// Kill zygotes whose runtime env has had no workers for a while, so that the
+  /// runtime env resources they hold can be released.
+  void TryKillingIdleZygotes();
+
+  /// Workers are kept warm per language, job and runtime env hash, since those decide
+  /// which tasks a worker can run.
+  using WarmPoolKey = std::tuple<Language, JobID, int>;
+
+  /// Get the number of workers to keep warm for each language, job and runtime env,
+  /// from the forecasted demand of the scheduling classes that run on them. Each
+  /// target comes with a task to start the workers for.
+  absl::flat_hash_map<WarmPoolKey, std::pair<TaskSpecification, int64_t>>
+  GetWarmPoolTargets() const;
+
+  /// Start workers for every warm pool that has fewer workers (idle, leased or
+  /// starting) than its target. Only used when `enable_adaptive_worker_prestart` is
+  /// set.
+  void MaintainWarmPool();
+
+  /// Start a worker to keep warm for the given task, creating its runtime env first if
+  /// needed.
+  ///
+  /// \return False if the worker couldn't be started, e.g., because too many workers
+  /// are starting already or waiting for their runtime env to be created.
+  bool PrestartWarmWorker(const TaskSpecification &task_spec);
+
   /// For Process class for managing subprocesses (e.g. reaping zombies).
   instrumented_io_context *io_service_;
   /// Node ID of the current node.
@@ -842,11 +923,27 @@ class WorkerPool : public WorkerPoolInterface, public IOWorkerPoolInterface {
 
   RuntimeEnvManager runtime_env_manager_;
 
+  /// Forecasts the demand for workers of each scheduling class. Null unless
+  /// `enable_adaptive_worker_prestart` is set.
+  std::unique_ptr<WorkerDemandForecaster> demand_forecaster_;
+
+  /// The number of warm workers waiting for their runtime env to be created, per warm
+  /// pool.
+  absl::flat_hash_map<WarmPoolKey, int64_t> warm_workers_pending_runtime_env_;
+
+  /// How long to back off after failing to create the runtime env of the warm workers
+  /// of a pool, and the time until which no more are created, per warm pool.
+  absl::flat_hash_map<WarmPoolKey, std::pair<double, double>>
+      warm_pool_runtime_env_backoff_;
+
   /// Stats
   int64_t process_failed_job_config_missing_ = 0;
   int64_t process_failed_rate_limited_ = 0;
   int64_t process_failed_pending_registration_ = 0;
   int64_t process_failed_runtime_env_setup_failed_ = 0;
+  int64_t num_workers_forked_from_zygote_ = 0;
+  int64_t num_workers_prestarted_for_demand_ = 0;
+  int64_t num_warm_workers_failed_to_start_ = 0;
 
   friend class WorkerPoolTest;
 };
@@ -150,6 +150,12 @@ class WorkerPoolMock : public WorkerPool {
 
   Process StartProcess(const std::vector<std::string> &worker_command_args,
                        const ProcessEnvironment &env) override {
+    if (worker_command_args.back().rfind(kWorkerZygoteSocketFlag, 0) == 0) {
+      // Zygotes never register as workers, so don't track them as worker processes.
+      zygote_commands_.push_back(worker_command_args);
+      return Process::FromPid(static_cast<pid_t>(PID_MAX_LIMIT * 2 + 1 +
+                                                 zygote_commands_.size()));
+    }
     // Use a bogus process ID that won't conflict with those in the system
     pid_t pid = static_cast<pid_t>(PID_MAX_LIMIT + 1 + worker_commands_by_proc_.size());
     last_worker_process_ = Process::FromPid(pid);
@@ -159,10 +165,31 @@ class WorkerPoolMock : public WorkerPool {
     return last_worker_process_;
   }
 
+  void ForkFromZygote(const WorkerZygote &zygote,
+                      const std::vector<std::string> &worker_command_args,
+                      const ProcessEnvironment &env,
+                      std::function<void(Process)> callback) override {
+    num_zygote_forks_++;
+    // Reply right away, as if the zygote forked the worker immediately.
+    callback(fail_zygote_forks_ ? Process() : StartProcess(worker_command_args, env));
+  }
+
+  void SetFailZygoteForks(bool fail) { fail_zygote_forks_ = fail; }
+
   void WarnAboutSize() override {}
 
   Process LastStartedWorkerProcess() const { return last_worker_process_; }
 
+  int NumZygotes(const Language &language = Language::PYTHON) const {
+    return states_by_lang_.find(language)->second.zygotes.size();
+  }
+
+  int NumZygoteForks() const { return num_zygote_forks_; }
+
+  const std::vector<std::vector<std::string>> &GetZygoteCommands() const {
+    return zygote_commands_;
+  }
+
   const std::vector<std::string> &GetWorkerCommand(Process proc) {
     return worker_commands_by_proc_[proc];
   }
@@ -349,6 +376,9 @@ class WorkerPoolMock : public WorkerPool {
   // The worker commands by process.
   absl::flat_hash_map<Process, std::vector<std::string>> worker_commands_by_proc_;
   absl::flat_hash_map<Process, StartupToken> startup_tokens_by_proc_;
+  std::vector<std::vector<std::string>> zygote_commands_;
+  int num_zygote_forks_ = 0;
+  bool fail_zygote_forks_ = false;
   double current_time_ms_ = 0;
   absl::flat_hash_map<Process, std::vector<std::string>> pushedProcesses_;
   instrumented_io_context &instrumented_io_service_;
@@ -390,6 +420,12 @@ class WorkerPoolTest : public ::testing::Test {
 
   void AssertNoLeaks() { ASSERT_EQ(worker_pool_->pending_exit_idle_workers_.size(), 0); }
 
+  void MaintainWarmPool() { worker_pool_->MaintainWarmPool(); }
+
+  int64_t NumRuntimeEnvSetupFailures() {
+    return worker_pool_->process_failed_runtime_env_setup_failed_;
+  }
+
   ~WorkerPoolTest() {
     io_service_.stop();
     thread_io_service_->join();
@@ -626,6 +662,139 @@ TEST_F(WorkerPoolTest, TestPrestartingWorkers) {
   ASSERT_EQ(worker_pool_->NumWorkerProcessesStarting(), 5);
 }
 
+TEST_F(WorkerPoolTest, StartWorkersFromZygote) {
+  RayConfig::instance().initialize(
+      R"({"worker_zygote_enabled": true, "object_spilling_config": "dummy"})");
+  // The first worker is started from scratch, and a zygote is started alongside it.
+  auto worker1 = worker_pool_->PopWorkerSync(ExampleTaskSpec());
+  ASSERT_NE(worker1, nullptr);
+  ASSERT_EQ(worker_pool_->NumZygotes(), 1);
+  ASSERT_EQ(worker_pool_->NumZygoteForks(), 0);
+  const auto &zygote_command = worker_pool_->GetZygoteCommands().front();
+  ASSERT_EQ(zygote_command.front(), "dummy_py_worker_command");
+  ASSERT_NE(std::find(zygote_command.begin(), zygote_command.end(), "--startup-token=-1"),
+            zygote_command.end());
+
+  // Later workers of the same runtime env are forked from the zygote.
+  auto worker2 = worker_pool_->PopWorkerSync(ExampleTaskSpec());
+  ASSERT_NE(worker2, nullptr);
+  ASSERT_NE(worker1, worker2);
+  ASSERT_EQ(worker_pool_->NumZygotes(), 1);
+  ASSERT_EQ(worker_pool_->NumZygoteForks(), 1);
+
+  // If the zygote can't serve the fork request, the worker is started from scratch.
+  worker_pool_->SetFailZygoteForks(true);
+  auto worker3 = worker_pool_->PopWorkerSync(ExampleTaskSpec());
+  ASSERT_NE(worker3, nullptr);
+  ASSERT_EQ(worker_pool_->NumZygoteForks(), 2);
+  ASSERT_EQ(worker_pool_->NumZygotes(), 1);
+
+  // Java workers are never forked from a zygote.
+  worker_pool_->PopWorkerSync(ExampleTaskSpec(ActorID::Nil(), Language::JAVA));
+  ASSERT_EQ(worker_pool_->NumZygotes(Language::JAVA), 0);
+
+  // Once no workers of the runtime env are left, the zygote is killed.
+  worker_pool_->DisconnectWorker(worker1, rpc::WorkerExitType::INTENDED_EXIT);
+  worker_pool_->DisconnectWorker(worker2, rpc::WorkerExitType::INTENDED_EXIT);
+  worker_pool_->DisconnectWorker(worker3, rpc::WorkerExitType::INTENDED_EXIT);
+  worker_pool_->SetCurrentTimeMs(
+      RayConfig::instance().idle_worker_killing_time_threshold_ms() + 1);
+  worker_pool_->TryKillingIdleWorkers();
+  ASSERT_EQ(worker_pool_->NumZygotes(), 0);
+}
+
+TEST_F(WorkerPoolTest, KeepWorkersWarmForForecastedDemand) {
+  RayConfig::instance().initialize(
+      R"({"enable_adaptive_worker_prestart": true,
+          "adaptive_worker_prestart_window_ms": 1000,
+          "adaptive_worker_prestart_ewma_alpha": 1.0,
+          "object_spilling_config": "dummy"})");
+  SetWorkerCommands({{Language::PYTHON, {"dummy_py_worker_command"}}});
+
+  // A burst of tasks leases more workers than the soft limit.
+  int num_workers = POOL_SIZE_SOFT_LIMIT + 2;
+  std::vector<std::shared_ptr<WorkerInterface>> workers;
+  for (int i = 0; i < num_workers; i++) {
+    workers.push_back(worker_pool_->PopWorkerSync(ExampleTaskSpec()));
+    ASSERT_NE(workers.back(), nullptr);
+  }
+  for (const auto &worker : workers) {
+    worker_pool_->PushWorker(worker);
+  }
+  ASSERT_EQ(worker_pool_->GetIdleWorkerSize(), num_workers);
+
+  // Once the window of the burst finishes, all of its workers are kept warm even
+  // though they have been idle for long enough to be killed.
+  worker_pool_->SetCurrentTimeMs(1000);
+  MaintainWarmPool();
+  ASSERT_EQ(worker_pool_->NumWorkersStarting(), 0);
+  worker_pool_->TryKillingIdleWorkers();
+  for (const auto &worker : workers) {
+    ASSERT_FALSE(mock_worker_rpc_clients_[worker->WorkerId()]->ExitReplySucceed());
+  }
+
+  // A warm worker that dies is replaced.
+  worker_pool_->DisconnectWorker(workers[0], rpc::WorkerExitType::INTENDED_EXIT);
+  MaintainWarmPool();
+  ASSERT_EQ(worker_pool_->NumWorkersStarting(), 1);
+
+  // Without further demand, idle workers are killed down to the soft limit again.
+  worker_pool_->SetCurrentTimeMs(2000);
+  MaintainWarmPool();
+  worker_pool_->TryKillingIdleWorkers();
+  auto mock_rpc_client_it = mock_worker_rpc_clients_.find(
+      worker_pool_->GetIdleWorkers().front().first->WorkerId());
+  ASSERT_TRUE(mock_rpc_client_it->second->ExitReplySucceed());
+  worker_pool_->TryKillingIdleWorkers();
+  ASSERT_EQ(worker_pool_->GetIdleWorkerSize(), num_workers - 2);
+}
+
+TEST_F(WorkerPoolTest, BackOffWarmWorkersWhoseRuntimeEnvFails) {
+  RayConfig::instance().initialize(
+      R"({"enable_adaptive_worker_prestart": true,
+          "adaptive_worker_prestart_window_ms": 1000,
+          "adaptive_worker_prestart_ewma_alpha": 1.0,
+          "adaptive_worker_prestart_runtime_env_backoff_ms": 100,
+          "object_spilling_config": "dummy"})");
+  SetWorkerCommands({{Language::PYTHON, {"dummy_py_worker_command"}}});
+
+  const auto task_spec =
+      ExampleTaskSpec(ActorID::Nil(), Language::PYTHON, JOB_ID, ActorID::Nil(), {},
+                      TaskID::FromRandom(JobID::Nil()),
+                      ExampleRuntimeEnvInfoFromString("mock_runtime_env_1"));
+  auto worker1 = worker_pool_->PopWorkerSync(task_spec);
+  auto worker2 = worker_pool_->PopWorkerSync(task_spec);
+  ASSERT_NE(worker1, nullptr);
+  ASSERT_NE(worker2, nullptr);
+  worker_pool_->DisconnectWorker(worker1, rpc::WorkerExitType::INTENDED_EXIT);
+  worker_pool_->DisconnectWorker(worker2, rpc::WorkerExitType::INTENDED_EXIT);
+
+  // Both workers need to be replaced, but once creating the runtime env fails, it
+  // isn't tried again until the backoff is over.
+  const auto original_bad_runtime_env = BAD_RUNTIME_ENV;
+  BAD_RUNTIME_ENV = "mock_runtime_env_1";
+  worker_pool_->SetCurrentTimeMs(1000);
+  MaintainWarmPool();
+  ASSERT_EQ(NumRuntimeEnvSetupFailures(), 1);
+  worker_pool_->SetCurrentTimeMs(1099);
+  MaintainWarmPool();
+  ASSERT_EQ(NumRuntimeEnvSetupFailures(), 1);
+
+  // The backoff doubles with every failure.
+  worker_pool_->SetCurrentTimeMs(1100);
+  MaintainWarmPool();
+  ASSERT_EQ(NumRuntimeEnvSetupFailures(), 2);
+  worker_pool_->SetCurrentTimeMs(1299);
+  MaintainWarmPool();
+  ASSERT_EQ(NumRuntimeEnvSetupFailures(), 2);
+
+  BAD_RUNTIME_ENV = original_bad_runtime_env;
+  worker_pool_->SetCurrentTimeMs(1300);
+  MaintainWarmPool();
+  ASSERT_EQ(NumRuntimeEnvSetupFailures(), 2);
+  ASSERT_EQ(worker_pool_->NumWorkersStarting(), 2);
+}
+
 TEST_F(WorkerPoolTest, HandleWorkerPushPop) {
   std::shared_ptr<WorkerInterface> popped_worker;
   const auto task_spec = ExampleTaskSpec();
@@ -0,0 +1,213 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/raylet/worker_zygote.h"
+
+#ifndef _WIN32
+#include <sys/un.h>
+#endif
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <cstdio>
+#include <istream>
+#include <memory>
+
+#include "nlohmann/json.hpp"
+#include "ray/common/ray_config.h"
+#include "ray/util/logging.h"
+
+using json = nlohmann::json;
+
+namespace ray {
+
+namespace raylet {
+
+#ifndef _WIN32
+namespace {
+
+namespace local = boost::asio::local;
+
+/// A fork request in flight. It's kept alive by the handlers of its async operations,
+/// and calls the callback once, when the zygote replied or the request failed.
+class ForkRequest : public std::enable_shared_from_this<ForkRequest> {
+ public:
+  ForkRequest(instrumented_io_context &io_service, pid_t zygote_pid, std::string payload,
+              std::function<void(Process)> callback)
+      : socket_(io_service),
+        timer_(io_service),
+        zygote_pid_(zygote_pid),
+        payload_(std::move(payload)),
+        callback_(std::move(callback)) {}
+
+  void Start(const std::string &socket_path) {
+    auto self = shared_from_this();
+    timer_.expires_from_now(boost::posix_time::milliseconds(
+        RayConfig::instance().worker_zygote_fork_timeout_ms()));
+    timer_.async_wait([self](const boost::system::error_code &error) {
+      if (!error && !self->Done()) {
+        RAY_LOG(WARNING) << "Zygote " << self->zygote_pid_
+                         << " didn't reply to the fork request in time.";
+        self->Finish(Process());
+      }
+    });
+    socket_.async_connect(
+        local::stream_protocol::endpoint(socket_path),
+        [self, socket_path](const boost::system::error_code &error) {
+          if (self->Done()) {
+            return;
+          }
+          if (error) {
+            // The zygote hasn't finished initializing yet.
+            RAY_LOG(DEBUG) << "Zygote at " << socket_path
+                           << " is not ready: " << error.message();
+            self->Finish(Process());
+            return;
+          }
+          self->SendRequest();
+        });
+  }
+
+ private:
+  void SendRequest() {
+    auto self = shared_from_this();
+    boost::asio::async_write(
+        socket_, boost::asio::buffer(payload_),
+        [self](const boost::system::error_code &error, size_t) {
+          if (self->Done()) {
+            return;
+          }
+          if (error) {
+            RAY_LOG(WARNING) << "Failed to send fork request to zygote "
+                             << self->zygote_pid_ << ": " << error.message();
+            self->Finish(Process());
+            return;
+          }
+          self->ReadReply();
+        });
+  }
+
+  void ReadReply() {
+    auto self = shared_from_this();
+    boost::asio::async_read_until(
+        socket_, reply_, '\n', [self](const boost::system::error_code &error, size_t) {
+          if (self->Done()) {
+            return;
+          }
+          if (error) {
+            RAY_LOG(WARNING) << "Zygote " << self->zygote_pid_
+                             << " didn't reply to the fork request: " << error.message();
+            self->Finish(Process());
+            return;
+          }
+          std::istream stream(&self->reply_);
+          std::string reply;
+          std::getline(stream, reply);
+          pid_t pid = static_cast<pid_t>(std::strtol(reply.c_str(), nullptr, 10));
+          if (pid <= 0) {
+            RAY_LOG(WARNING) << "Zygote " << self->zygote_pid_
+                             << " failed to fork a worker: " << reply;
+            self->Finish(Process());
+            return;
+          }
+          self->Finish(Process::FromPid(pid));
+        });
+  }
+
+  bool Done() const { return callback_ == nullptr; }
+
+  /// Cancel the pending operations and call the callback.
+  void Finish(Process proc) {
+    timer_.cancel();
+    boost::system::error_code error;
+    socket_.close(error);
+    auto callback = std::move(callback_);
+    callback_ = nullptr;
+    callback(std::move(proc));
+  }
+
+  local::stream_protocol::socket socket_;
+  boost::asio::deadline_timer timer_;
+  const pid_t zygote_pid_;
+  const std::string payload_;
+  boost::asio::streambuf reply_;
+  std::function<void(Process)> callback_;
+};
+
+}  // namespace
+#endif
+
+WorkerZygote::WorkerZygote(Process proc, std::string socket_path, int runtime_env_hash)
+    : proc_(std::move(proc)),
+      socket_path_(std::move(socket_path)),
+      runtime_env_hash_(runtime_env_hash) {}
+
+WorkerZygote::~WorkerZygote() {
+  if (proc_.IsValid()) {
+    proc_.Kill();
+  }
+  std::remove(socket_path_.c_str());
+}
+
+std::vector<std::string> WorkerZygote::BuildCommand(
+    const std::vector<std::string> &worker_command_args, const std::string &socket_path) {
+  std::vector<std::string> command;
+  command.reserve(worker_command_args.size() + 1);
+  for (const auto &arg : worker_command_args) {
+    // The zygote never registers with the raylet itself, so it must not hold the
+    // startup token of the worker it was derived from.
+    if (arg.rfind("--startup-token=", 0) == 0) {
+      command.push_back("--startup-token=-1");
+    } else {
+      command.push_back(arg);
+    }
+  }
+  command.push_back(kWorkerZygoteSocketFlag + socket_path);
+  return command;
+}
+
+void WorkerZygote::AsyncFork(instrumented_io_context &io_service,
+                             const std::vector<std::string> &worker_command_args,
+                             const ProcessEnvironment &env,
+                             std::function<void(Process)> callback) const {
+#ifdef _WIN32
+  // Windows has no fork(), so workers are always started from scratch.
+  io_service.post([callback = std::move(callback)]() { callback(Process()); },
+                  "WorkerZygote.Fork");
+#else
+  if (socket_path_.size() >= sizeof(sockaddr_un().sun_path)) {
+    RAY_LOG(WARNING) << "Zygote socket path " << socket_path_ << " is too long.";
+    io_service.post([callback = std::move(callback)]() { callback(Process()); },
+                    "WorkerZygote.Fork");
+    return;
+  }
+
+  json request;
+  request["args"] = worker_command_args;
+  request["env"] = json::object();
+  for (const auto &entry : env) {
+    request["env"][entry.first] = entry.second;
+  }
+  std::make_shared<ForkRequest>(io_service, proc_.GetId(), request.dump() + "\n",
+                                std::move(callback))
+      ->Start(socket_path_);
+#endif
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,100 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/util/process.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// The command line flag that puts a worker process into zygote mode. A zygote
+/// finishes interpreter startup and imports, then listens on the given unix socket
+/// and forks a new worker process for every request it receives.
+constexpr char kWorkerZygoteSocketFlag[] = "--zygote-socket=";
+
+/// \class WorkerZygote
+///
+/// A pre-initialized template process that new worker processes are forked from.
+/// Forking skips interpreter startup and imports, so that only the per-worker
+/// identity (startup token, job ID, ...) needs to be handed over.
+///
+/// Fork requests are newline-terminated JSON objects of the form
+/// `{"args": [...], "env": {...}}`, where `args` is the full command line the worker
+/// would have been started with. The zygote replies with the PID of the forked worker
+/// followed by a newline.
+class WorkerZygote {
+ public:
+  /// Create a zygote handle.
+  ///
+  /// \param proc The zygote process.
+  /// \param socket_path The unix socket the zygote listens on for fork requests.
+  /// \param runtime_env_hash The hash of the runtime env the zygote was started in.
+  WorkerZygote(Process proc, std::string socket_path, int runtime_env_hash);
+
+  /// Kills the zygote process and removes its socket. Workers that were already
+  /// forked from it are not affected.
+  ~WorkerZygote();
+
+  /// Fork a new worker process from the zygote without blocking.
+  ///
+  /// \param io_service The event loop that the request runs on and that the callback
+  /// is called on.
+  /// \param worker_command_args The command line of the worker process.
+  /// \param env Environment variables to set in the forked worker process.
+  /// \param callback Called with the forked worker process, or a null process if the
+  /// zygote isn't ready yet, failed to serve the request or didn't reply within
+  /// `worker_zygote_fork_timeout_ms`.
+  void AsyncFork(instrumented_io_context &io_service,
+                 const std::vector<std::string> &worker_command_args,
+                 const ProcessEnvironment &env,
+                 std::function<void(Process)> callback) const;
+
+  /// Whether the zygote process is still alive.
+  bool IsAlive() const { return proc_.IsAlive(); }
+
+  const Process &GetProcess() const { return proc_; }
+
+  const std::string &GetSocketPath() const { return socket_path_; }
+
+  int GetRuntimeEnvHash() const { return runtime_env_hash_; }
+
+  /// Build the command line of a zygote from the command line of a regular worker.
+  ///
+  /// \param worker_command_args The command line of a regular worker of the same
+  /// language and runtime env.
+  /// \param socket_path The unix socket the zygote should listen on.
+  /// \return The command line of the zygote process.
+  static std::vector<std::string> BuildCommand(
+      const std::vector<std::string> &worker_command_args,
+      const std::string &socket_path);
+
+ private:
+  /// The zygote process.
+  Process proc_;
+  /// The unix socket the zygote listens on.
+  const std::string socket_path_;
+  /// The hash of the runtime env the zygote was started in.
+  const int runtime_env_hash_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -19,6 +19,7 @@
 #include "ray/common/ray_config.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/raylet/format/node_manager_generated.h"
+#include "ray/rpc/batched_request_handler.h"
 #include "ray/util/logging.h"
 #include "ray/util/util.h"
 
@@ -303,6 +304,51 @@ void raylet::RayletClient::RequestWorkerLease(
   grpc_client_->RequestWorkerLease(*request, callback);
 }
 
+namespace {
+
+/// Send a batch of lease requests, or a poll for the rest of a batch, and call back
+/// every lease as soon as the raylet replies to it. The raylet is polled for as long as
+/// some leases of the batch haven't been replied to.
+void SendWorkerLeasesRequest(
+    std::shared_ptr<ray::rpc::NodeManagerWorkerClient> grpc_client,
+    const rpc::RequestWorkerLeasesRequest &request,
+    std::shared_ptr<std::vector<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>>>
+        callbacks) {
+  grpc_client->RequestWorkerLeases(
+      request, [grpc_client, callbacks](const Status &status,
+                                        const rpc::RequestWorkerLeasesReply &reply) {
+        if (status.ok() && reply.batch_id() != 0) {
+          rpc::RequestWorkerLeasesRequest poll_request;
+          poll_request.set_batch_id(reply.batch_id());
+          SendWorkerLeasesRequest(grpc_client, poll_request, callbacks);
+        }
+        rpc::CallBackBatchedRequests(status, reply, callbacks.get());
+      });
+}
+
+}  // namespace
+
+void raylet::RayletClient::RequestWorkerLeases(
+    const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+    std::vector<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>> callbacks) {
+  RAY_CHECK(task_specs.size() == callbacks.size());
+  google::protobuf::Arena arena;
+  auto request =
+      google::protobuf::Arena::CreateMessage<rpc::RequestWorkerLeasesRequest>(&arena);
+  for (const auto *task_spec : task_specs) {
+    // The task specs outlive the request, see `RequestWorkerLease`.
+    auto lease_request = request->add_requests();
+    lease_request->unsafe_arena_set_allocated_resource_spec(
+        const_cast<rpc::TaskSpec *>(task_spec));
+    lease_request->set_grant_or_reject(grant_or_reject);
+    lease_request->set_backlog_size(0);
+  }
+  SendWorkerLeasesRequest(
+      grpc_client_, *request,
+      std::make_shared<std::vector<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>>>(
+          std::move(callbacks)));
+}
+
 /// Spill objects to external storage.
 void raylet::RayletClient::RequestObjectSpillage(
     const ObjectID &object_id,
@@ -465,8 +511,8 @@ void raylet::RayletClient::UpdateResourceUsage(
 }
 
 void raylet::RayletClient::RequestResourceReport(
+    const rpc::RequestResourceReportRequest &request,
     const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback) {
-  rpc::RequestResourceReportRequest request;
   grpc_client_->RequestResourceReport(request, callback);
 }
 
@@ -72,6 +72,19 @@ class WorkerLeaseInterface {
       const int64_t backlog_size = -1,
       const bool is_selected_based_on_locality = false) = 0;
 
+  /// Requests workers from the raylet for several tasks with a single request. The
+  /// leases are handled by the raylet as if they were requested one by one.
+  /// \param task_specs Resources that should be allocated for every worker. They are
+  ///                   only used until the call returns.
+  /// \param grant_or_reject: True if we we should either grant or reject the requests
+  ///                         but no spillback.
+  /// \param callbacks: The callback of every request, in the order of the task specs.
+  ///                   Each is called as soon as its own request finishes.
+  virtual void RequestWorkerLeases(
+      const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+      std::vector<ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply>>
+          callbacks) = 0;
+
   /// Returns a worker to the raylet.
   /// \param worker_port The local port of the worker on the raylet node.
   /// \param worker_id The unique worker id of the worker on the raylet node.
@@ -159,7 +172,13 @@ class ResourceTrackingInterface {
       std::string &serialized_resource_usage_batch,
       const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback) = 0;
 
+  /// Request the resource report of the raylet.
+  ///
+  /// \param request The versions of the reports the caller has applied, and the
+  /// region members whose reports the raylet should pull as well.
+  /// \param callback The callback to call with the report.
   virtual void RequestResourceReport(
+      const rpc::RequestResourceReportRequest &request,
       const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback) = 0;
 
   virtual ~ResourceTrackingInterface(){};
@@ -367,6 +386,12 @@ class RayletClient : public RayletClientInterface {
       const ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply> &callback,
       const int64_t backlog_size, const bool is_selected_based_on_locality) override;
 
+  /// Implements WorkerLeaseInterface.
+  void RequestWorkerLeases(
+      const std::vector<const rpc::TaskSpec *> &task_specs, bool grant_or_reject,
+      std::vector<ray::rpc::ClientCallback<ray::rpc::RequestWorkerLeaseReply>> callbacks)
+      override;
+
   /// Implements WorkerLeaseInterface.
   ray::Status ReturnWorker(int worker_port, const WorkerID &worker_id,
                            bool disconnect_worker, bool worker_exiting) override;
@@ -429,6 +454,7 @@ class RayletClient : public RayletClientInterface {
       const rpc::ClientCallback<rpc::UpdateResourceUsageReply> &callback) override;
 
   void RequestResourceReport(
+      const rpc::RequestResourceReportRequest &request,
       const rpc::ClientCallback<rpc::RequestResourceReportReply> &callback) override;
 
   // Subscribe to receive notification on plasma object
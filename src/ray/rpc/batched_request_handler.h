@@ -0,0 +1,285 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/ray_config.h"
+#include "ray/common/status.h"
+#include "ray/rpc/client_call.h"
+#include "ray/rpc/server_call.h"
+#include "ray/util/logging.h"
+#include "ray/util/util.h"
+
+namespace ray {
+namespace rpc {
+
+/// \class BatchedRequestHandler
+///
+/// Handles the requests of an RPC that carries a batch of requests of another RPC, such
+/// as PushTasks for PushTask. Every request of a batch is handled like it was sent on
+/// its own, and is replied to as soon as it is handled, so that it never waits for the
+/// other requests of its batch.
+///
+/// The request that sends a batch is replied to as soon as any of its requests is. If
+/// some requests of the batch are still pending, the reply carries an ID that the
+/// caller polls for the rest of them with, and each poll is again replied to as soon as
+/// any of them is handled. There is always a request of the caller waiting for the
+/// pending requests, so they fail on the caller if this process dies. A batch that
+/// isn't polled for `batched_request_unpolled_timeout_ms` is dropped, in case its
+/// caller died.
+///
+/// The batch request has `repeated Request requests` and `uint64 batch_id`, where a
+/// nonzero `batch_id` means a poll. The batch reply has `uint64 batch_id` and
+/// `repeated ... replies`, each of which has `Reply reply`, `int32 index`, and
+/// `string error_code` and `error_message` for a request that failed.
+///
+/// This class is thread safe.
+template <typename Request, typename Reply, typename BatchRequest, typename BatchReply>
+class BatchedRequestHandler {
+ public:
+  using HandleRequestFn =
+      std::function<void(const Request &request, Reply *reply, SendReplyCallback)>;
+
+  /// \param get_time_ms Returns the current time in milliseconds.
+  explicit BatchedRequestHandler(std::function<int64_t()> get_time_ms = current_time_ms)
+      : get_time_ms_(std::move(get_time_ms)) {}
+
+  /// Handle a batch of requests, or a poll for the replies to the rest of a batch.
+  ///
+  /// \param[in] request The batch of requests, or the poll.
+  /// \param[in] reply The reply to the batch or the poll.
+  /// \param[in] send_reply_callback Sends the reply.
+  /// \param[in] handle_request Handles one request of a batch. The request may be
+  /// replied to from any thread.
+  void HandleBatch(const BatchRequest &request, BatchReply *reply,
+                   SendReplyCallback send_reply_callback,
+                   const HandleRequestFn &handle_request) LOCKS_EXCLUDED(mu_) {
+    if (request.batch_id() != 0) {
+      SendReplyCallback send_poll_reply;
+      {
+        absl::MutexLock lock(&mu_);
+        auto it = batches_.find(request.batch_id());
+        if (it == batches_.end() || it->second->poll_reply != nullptr) {
+          send_reply_callback(Status::Invalid("Unknown or already polled batch " +
+                                              std::to_string(request.batch_id())),
+                              nullptr, nullptr);
+          return;
+        }
+        it->second->poll_reply = reply;
+        it->second->poll_send_reply_callback = std::move(send_reply_callback);
+        send_poll_reply = FlushReplies(request.batch_id(), it->second.get());
+      }
+      if (send_poll_reply) {
+        send_poll_reply(Status::OK(), nullptr, nullptr);
+      }
+      return;
+    }
+
+    if (request.requests_size() == 0) {
+      send_reply_callback(Status::OK(), nullptr, nullptr);
+      return;
+    }
+    // The batch request itself waits for the first replies, so that the first request
+    // to be handled is replied to without waiting for the others.
+    auto batch = std::make_shared<Batch>(request.requests_size());
+    batch->poll_reply = reply;
+    batch->poll_send_reply_callback = std::move(send_reply_callback);
+    uint64_t batch_id;
+    {
+      absl::MutexLock lock(&mu_);
+      DropUnpolledBatches();
+      batch_id = next_batch_id_++;
+      batches_.emplace(batch_id, batch);
+    }
+    for (int i = 0; i < request.requests_size(); i++) {
+      handle_request(
+          request.requests(i), &batch->replies[i],
+          [this, batch_id, batch, i](Status status, std::function<void()> success,
+                                     std::function<void()> failure) {
+            SendReplyCallback send_poll_reply;
+            {
+              absl::MutexLock lock(&mu_);
+              batch->finished.emplace_back(i, status);
+              batch->num_pending--;
+              send_poll_reply = FlushReplies(batch_id, batch.get());
+            }
+            if (send_poll_reply) {
+              send_poll_reply(Status::OK(), nullptr, nullptr);
+            }
+          });
+    }
+    SendReplyCallback send_poll_reply;
+    {
+      absl::MutexLock lock(&mu_);
+      batch->dispatching = false;
+      send_poll_reply = FlushReplies(batch_id, batch.get());
+    }
+    if (send_poll_reply) {
+      send_poll_reply(Status::OK(), nullptr, nullptr);
+    }
+  }
+
+  /// Returns the number of batches whose requests haven't all been replied to.
+  size_t NumBatches() const LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return batches_.size();
+  }
+
+ private:
+  /// The requests of a batch that haven't all been replied to yet.
+  struct Batch {
+    explicit Batch(int num_requests) : replies(num_requests), num_pending(num_requests) {}
+    /// The replies that the requests are handled into, by index in the batch.
+    std::vector<Reply> replies;
+    /// The index and status of the requests that were handled but not replied to yet.
+    std::vector<std::pair<int, Status>> finished;
+    /// The number of requests that haven't been handled yet.
+    int num_pending;
+    /// Whether the requests are still being handed to the handler. The batch request,
+    /// which they are read from, can't be replied to until they all are.
+    bool dispatching = true;
+    /// The reply to the request of the caller waiting for the handled requests, if any.
+    BatchReply *poll_reply = nullptr;
+    SendReplyCallback poll_send_reply_callback;
+    /// The time the last reply to the caller was sent, if it hasn't polled since.
+    int64_t unpolled_since_ms = 0;
+  };
+
+  /// Move the replies to the handled requests of a batch into the reply to the request
+  /// waiting for them, if there are both. The batch is forgotten once all of its
+  /// requests are replied to.
+  ///
+  /// \return The callback that sends the reply, or nullptr if there is none to send.
+  /// It must be called without holding mu_.
+  SendReplyCallback FlushReplies(uint64_t batch_id, Batch *batch)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (batch->dispatching || batch->poll_reply == nullptr || batch->finished.empty()) {
+      return nullptr;
+    }
+    for (auto &finished : batch->finished) {
+      auto entry = batch->poll_reply->add_replies();
+      entry->set_index(finished.first);
+      entry->mutable_reply()->Swap(&batch->replies[finished.first]);
+      const auto &status = finished.second;
+      if (!status.ok()) {
+        entry->set_error_code(status.CodeAsString());
+        entry->set_error_message(status.message());
+      }
+    }
+    batch->finished.clear();
+    SendReplyCallback send_poll_reply;
+    send_poll_reply.swap(batch->poll_send_reply_callback);
+    if (batch->num_pending > 0) {
+      batch->poll_reply->set_batch_id(batch_id);
+      batch->poll_reply = nullptr;
+      batch->unpolled_since_ms = get_time_ms_();
+    } else {
+      // This may destroy the batch.
+      batches_.erase(batch_id);
+    }
+    return send_poll_reply;
+  }
+
+  /// Drop the batches that their callers haven't polled for within the timeout. The
+  /// batches are only checked once per timeout, so that this is cheap enough to do
+  /// for every batch.
+  void DropUnpolledBatches() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t timeout_ms =
+        RayConfig::instance().batched_request_unpolled_timeout_ms();
+    const int64_t now_ms = get_time_ms_();
+    if (now_ms - last_drop_time_ms_ < timeout_ms) {
+      return;
+    }
+    last_drop_time_ms_ = now_ms;
+    for (auto it = batches_.begin(); it != batches_.end();) {
+      const auto &batch = it->second;
+      if (batch->poll_reply == nullptr &&
+          now_ms - batch->unpolled_since_ms > timeout_ms) {
+        RAY_LOG(WARNING) << "Dropping batch " << it->first << " with "
+                         << batch->num_pending + batch->finished.size()
+                         << " pending replies, which its caller hasn't polled for in "
+                         << timeout_ms << " ms.";
+        // The handlers of its remaining requests still hold the batch, and discard
+        // their replies.
+        batches_.erase(it++);
+      } else {
+        it++;
+      }
+    }
+  }
+
+  const std::function<int64_t()> get_time_ms_;
+
+  mutable absl::Mutex mu_;
+
+  /// The batches whose requests haven't all been replied to, by the ID the caller polls
+  /// for them with.
+  absl::flat_hash_map<uint64_t, std::shared_ptr<Batch>> batches_ GUARDED_BY(mu_);
+
+  /// The last time the unpolled batches were dropped.
+  int64_t last_drop_time_ms_ GUARDED_BY(mu_) = 0;
+
+  /// The ID assigned to the next batch.
+  uint64_t next_batch_id_ GUARDED_BY(mu_) = 1;
+};
+
+/// Call back the requests of a batch that a reply to the batch, or to a poll for it,
+/// carries, each with its own status and reply. If the RPC failed, every request that
+/// wasn't called back yet fails with its status. The callback of a request is reset
+/// once it is called.
+///
+/// The caller should poll for the rest of the batch first if `reply.batch_id()` is
+/// nonzero, so that the next replies can be sent as soon as they are ready.
+template <typename Reply, typename BatchReply>
+void CallBackBatchedRequests(const Status &status, const BatchReply &reply,
+                             std::vector<ClientCallback<Reply>> *callbacks) {
+  if (!status.ok()) {
+    for (auto &callback : *callbacks) {
+      if (callback) {
+        auto failed_callback = std::move(callback);
+        callback = nullptr;
+        failed_callback(status, Reply());
+      }
+    }
+    return;
+  }
+  for (const auto &entry : reply.replies()) {
+    if (entry.index() < 0 || entry.index() >= static_cast<int>(callbacks->size()) ||
+        !(*callbacks)[entry.index()]) {
+      RAY_LOG(WARNING) << "Ignoring unexpected reply to request " << entry.index()
+                       << " of a batch of " << callbacks->size() << " requests.";
+      continue;
+    }
+    auto callback = std::move((*callbacks)[entry.index()]);
+    (*callbacks)[entry.index()] = nullptr;
+    if (entry.error_code().empty()) {
+      callback(Status::OK(), entry.reply());
+    } else {
+      callback(Status(Status::StringToCode(entry.error_code()), entry.error_message()),
+               entry.reply());
+    }
+  }
+}
+
+}  // namespace rpc
+}  // namespace ray
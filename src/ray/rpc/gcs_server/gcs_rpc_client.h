@@ -193,6 +193,14 @@ class GcsRpcClient {
   VOID_GCS_RPC_CLIENT_METHOD(ActorInfoGcsService, CreateActor, actor_info_grpc_client_,
                              /*method_timeout_ms*/ -1, )
 
+  /// Register many actors at once via GCS Service.
+  VOID_GCS_RPC_CLIENT_METHOD(ActorInfoGcsService, RegisterActors, actor_info_grpc_client_,
+                             /*method_timeout_ms*/ -1, )
+
+  /// Create many actors at once via GCS Service.
+  VOID_GCS_RPC_CLIENT_METHOD(ActorInfoGcsService, CreateActors, actor_info_grpc_client_,
+                             /*method_timeout_ms*/ -1, )
+
   /// Get actor data from GCS Service.
   VOID_GCS_RPC_CLIENT_METHOD(ActorInfoGcsService, GetActorInfo, actor_info_grpc_client_,
                              /*method_timeout_ms*/ -1, )
@@ -317,6 +325,12 @@ class GcsRpcClient {
                              internal_kv_grpc_client_, /*method_timeout_ms*/ -1, )
   VOID_GCS_RPC_CLIENT_METHOD(InternalKVGcsService, InternalKVKeys,
                              internal_kv_grpc_client_, /*method_timeout_ms*/ -1, )
+  VOID_GCS_RPC_CLIENT_METHOD(InternalKVGcsService, InternalKVMultiGet,
+                             internal_kv_grpc_client_, /*method_timeout_ms*/ -1, )
+  VOID_GCS_RPC_CLIENT_METHOD(InternalKVGcsService, InternalKVMultiPut,
+                             internal_kv_grpc_client_, /*method_timeout_ms*/ -1, )
+  VOID_GCS_RPC_CLIENT_METHOD(InternalKVGcsService, InternalKVWatch,
+                             internal_kv_grpc_client_, /*method_timeout_ms*/ -1, )
 
   /// Operations for pubsub
   VOID_GCS_RPC_CLIENT_METHOD(InternalPubSubGcsService, GcsPublish,
@@ -138,6 +138,14 @@ class ActorInfoGcsServiceHandler {
                                  CreateActorReply *reply,
                                  SendReplyCallback send_reply_callback) = 0;
 
+  virtual void HandleRegisterActors(const RegisterActorsRequest &request,
+                                    RegisterActorsReply *reply,
+                                    SendReplyCallback send_reply_callback) = 0;
+
+  virtual void HandleCreateActors(const CreateActorsRequest &request,
+                                  CreateActorsReply *reply,
+                                  SendReplyCallback send_reply_callback) = 0;
+
   virtual void HandleGetActorInfo(const GetActorInfoRequest &request,
                                   GetActorInfoReply *reply,
                                   SendReplyCallback send_reply_callback) = 0;
@@ -179,6 +187,8 @@ class ActorInfoGrpcService : public GrpcService {
     /// distributed deadlock.
     ACTOR_INFO_SERVICE_RPC_HANDLER(RegisterActor, -1);
     ACTOR_INFO_SERVICE_RPC_HANDLER(CreateActor, -1);
+    ACTOR_INFO_SERVICE_RPC_HANDLER(RegisterActors, -1);
+    ACTOR_INFO_SERVICE_RPC_HANDLER(CreateActors, -1);
 
     /// Others need back pressure.
     ACTOR_INFO_SERVICE_RPC_HANDLER(
@@ -508,6 +518,18 @@ class InternalKVGcsServiceHandler {
   virtual void HandleInternalKVExists(const InternalKVExistsRequest &request,
                                       InternalKVExistsReply *reply,
                                       SendReplyCallback send_reply_callback) = 0;
+
+  virtual void HandleInternalKVMultiGet(const InternalKVMultiGetRequest &request,
+                                        InternalKVMultiGetReply *reply,
+                                        SendReplyCallback send_reply_callback) = 0;
+
+  virtual void HandleInternalKVMultiPut(const InternalKVMultiPutRequest &request,
+                                        InternalKVMultiPutReply *reply,
+                                        SendReplyCallback send_reply_callback) = 0;
+
+  virtual void HandleInternalKVWatch(const InternalKVWatchRequest &request,
+                                     InternalKVWatchReply *reply,
+                                     SendReplyCallback send_reply_callback) = 0;
 };
 
 class InternalKVGrpcService : public GrpcService {
@@ -526,6 +548,9 @@ class InternalKVGrpcService : public GrpcService {
     INTERNAL_KV_SERVICE_RPC_HANDLER(InternalKVDel);
     INTERNAL_KV_SERVICE_RPC_HANDLER(InternalKVExists);
     INTERNAL_KV_SERVICE_RPC_HANDLER(InternalKVKeys);
+    INTERNAL_KV_SERVICE_RPC_HANDLER(InternalKVMultiGet);
+    INTERNAL_KV_SERVICE_RPC_HANDLER(InternalKVMultiPut);
+    INTERNAL_KV_SERVICE_RPC_HANDLER(InternalKVWatch);
   }
 
  private:
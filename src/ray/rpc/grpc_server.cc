@@ -104,18 +104,7 @@ void GrpcServer::Run() {
 
   // Create calls for all the server call factories.
   for (auto &entry : server_call_factories_) {
-    for (int i = 0; i < num_threads_; i++) {
-      // Create a buffer of 100 calls for each RPC handler.
-      // TODO(edoakes): a small buffer should be fine and seems to have better
-      // performance, but we don't currently handle backpressure on the client.
-      int buffer_size = 100;
-      if (entry->GetMaxActiveRPCs() != -1) {
-        buffer_size = entry->GetMaxActiveRPCs();
-      }
-      for (int j = 0; j < buffer_size; j++) {
-        entry->CreateCall();
-      }
-    }
+    CreateCalls(*entry);
   }
   // Start threads that polls incoming requests.
   for (int i = 0; i < num_threads_; i++) {
@@ -125,11 +114,39 @@ void GrpcServer::Run() {
   is_closed_ = false;
 }
 
-void GrpcServer::RegisterService(GrpcService &service) {
+void GrpcServer::RegisterService(GrpcService &service, bool accept_requests) {
   services_.emplace_back(service.GetGrpcService());
 
   for (int i = 0; i < num_threads_; i++) {
-    service.InitServerCallFactories(cqs_[i], &server_call_factories_);
+    service.InitServerCallFactories(cqs_[i], accept_requests
+                                                 ? &server_call_factories_
+                                                 : &deferred_server_call_factories_);
+  }
+}
+
+void GrpcServer::AcceptDeferredRequests() {
+  RAY_CHECK(!is_closed_);
+  // The requests that arrived before are queued by gRPC until there are calls to
+  // accept them.
+  for (auto &entry : deferred_server_call_factories_) {
+    CreateCalls(*entry);
+    server_call_factories_.push_back(std::move(entry));
+  }
+  deferred_server_call_factories_.clear();
+}
+
+void GrpcServer::CreateCalls(ServerCallFactory &server_call_factory) {
+  for (int i = 0; i < num_threads_; i++) {
+    // Create a buffer of 100 calls for each RPC handler.
+    // TODO(edoakes): a small buffer should be fine and seems to have better
+    // performance, but we don't currently handle backpressure on the client.
+    int buffer_size = 100;
+    if (server_call_factory.GetMaxActiveRPCs() != -1) {
+      buffer_size = server_call_factory.GetMaxActiveRPCs();
+    }
+    for (int j = 0; j < buffer_size; j++) {
+      server_call_factory.CreateCall();
+    }
   }
 }
 
@@ -97,7 +97,15 @@ class GrpcServer {
   /// `GrpcServer`, as it holds the underlying `grpc::Service`.
   ///
   /// \param[in] service A `GrpcService` to register to this server.
-  void RegisterService(GrpcService &service);
+  /// \param[in] accept_requests Whether the requests to the service are accepted as
+  /// soon as the server runs. If false, they wait until `AcceptDeferredRequests` is
+  /// called, so that the service can be served once its handler is ready while the
+  /// other services already are.
+  void RegisterService(GrpcService &service, bool accept_requests = true);
+
+  /// Start accepting the requests to the services registered with
+  /// `accept_requests = false`. Must be called after `Run`.
+  void AcceptDeferredRequests();
 
  protected:
   /// This function runs in a background thread. It keeps polling events from the
@@ -105,6 +113,9 @@ class GrpcServer {
   /// via the `ServerCall` objects.
   void PollEventsFromCompletionQueue(int index);
 
+  /// Create the calls that accept the requests of a server call factory.
+  void CreateCalls(ServerCallFactory &server_call_factory);
+
   /// Name of this server, used for logging and debugging purpose.
   const std::string name_;
   /// Port of this server.
@@ -118,6 +129,9 @@ class GrpcServer {
   std::vector<std::reference_wrapper<grpc::Service>> services_;
   /// The `ServerCallFactory` objects.
   std::vector<std::unique_ptr<ServerCallFactory>> server_call_factories_;
+  /// The `ServerCallFactory` objects of the services whose requests aren't accepted
+  /// until `AcceptDeferredRequests` is called.
+  std::vector<std::unique_ptr<ServerCallFactory>> deferred_server_call_factories_;
   /// The number of completion queues the server is polling from.
   int num_threads_;
   /// The `ServerCompletionQueue` object used for polling events.
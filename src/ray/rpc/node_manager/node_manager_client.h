@@ -83,6 +83,10 @@ class NodeManagerWorkerClient
   VOID_RPC_CLIENT_METHOD(NodeManagerService, RequestWorkerLease, grpc_client_,
                          /*method_timeout_ms*/ -1, )
 
+  /// Request several worker leases at once.
+  VOID_RPC_CLIENT_METHOD(NodeManagerService, RequestWorkerLeases, grpc_client_,
+                         /*method_timeout_ms*/ -1, )
+
   /// Report task backlog information
   VOID_RPC_CLIENT_METHOD(NodeManagerService, ReportWorkerBacklog, grpc_client_,
                          /*method_timeout_ms*/ -1, )
@@ -28,6 +28,7 @@ namespace rpc {
   RPC_SERVICE_HANDLER(NodeManagerService, UpdateResourceUsage, -1)    \
   RPC_SERVICE_HANDLER(NodeManagerService, RequestResourceReport, -1)  \
   RPC_SERVICE_HANDLER(NodeManagerService, RequestWorkerLease, -1)     \
+  RPC_SERVICE_HANDLER(NodeManagerService, RequestWorkerLeases, -1)    \
   RPC_SERVICE_HANDLER(NodeManagerService, ReportWorkerBacklog, -1)    \
   RPC_SERVICE_HANDLER(NodeManagerService, ReturnWorker, -1)           \
   RPC_SERVICE_HANDLER(NodeManagerService, ReleaseUnusedWorkers, -1)   \
@@ -72,6 +73,10 @@ class NodeManagerServiceHandler {
                                         RequestWorkerLeaseReply *reply,
                                         SendReplyCallback send_reply_callback) = 0;
 
+  virtual void HandleRequestWorkerLeases(const RequestWorkerLeasesRequest &request,
+                                         RequestWorkerLeasesReply *reply,
+                                         SendReplyCallback send_reply_callback) = 0;
+
   virtual void HandleReportWorkerBacklog(const ReportWorkerBacklogRequest &request,
                                          ReportWorkerBacklogReply *reply,
                                          SendReplyCallback send_reply_callback) = 0;
@@ -0,0 +1,340 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/batched_request_handler.h"
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/rpc/grpc_server.h"
+#include "ray/rpc/worker/core_worker_client.h"
+
+namespace ray {
+namespace rpc {
+
+using PushTasksBatches = BatchedRequestHandler<PushTaskRequest, PushTaskReply,
+                                               PushTasksRequest, PushTasksReply>;
+
+class BatchedRequestHandlerTest : public ::testing::Test {
+ public:
+  /// Push a batch of tasks, whose callbacks are kept in task_callbacks_.
+  void PushTasks(int num_tasks) {
+    PushTasksRequest request;
+    for (int i = 0; i < num_tasks; i++) {
+      request.add_requests();
+    }
+    HandlePushTasks(request);
+  }
+
+  /// Poll for the rest of a batch.
+  void Poll(uint64_t batch_id) {
+    PushTasksRequest request;
+    request.set_batch_id(batch_id);
+    HandlePushTasks(request);
+  }
+
+  /// Reply to the task with the given index in the batch.
+  void ReplyTask(int index, Status status = Status::OK()) {
+    task_callbacks_[index](status, nullptr, nullptr);
+  }
+
+  /// The reply to a push or poll, or nullptr if the reply wasn't sent yet.
+  std::unique_ptr<PushTasksReply> &Reply(int i) { return replies_[i]; }
+
+  /// The task indices that the reply to a push or poll carries.
+  std::vector<int> RepliedTasks(int i) {
+    std::vector<int> indices;
+    for (const auto &task_reply : replies_[i]->replies()) {
+      indices.push_back(task_reply.index());
+    }
+    return indices;
+  }
+
+ private:
+  void HandlePushTasks(const PushTasksRequest &request) {
+    auto reply = std::make_shared<PushTasksReply>();
+    int i = replies_.size();
+    replies_.emplace_back();
+    batches_.HandleBatch(
+        request, reply.get(),
+        [this, reply, i](Status status, std::function<void()> success,
+                         std::function<void()> failure) {
+          ASSERT_FALSE(replies_[i]);
+          statuses_.push_back(status);
+          replies_[i] = std::make_unique<PushTasksReply>(*reply);
+        },
+        [this](const PushTaskRequest &request, PushTaskReply *reply,
+               SendReplyCallback send_reply_callback) {
+          if (reply_while_dispatching_) {
+            send_reply_callback(Status::OK(), nullptr, nullptr);
+            // The push isn't replied to before all its tasks are handed over.
+            ASSERT_FALSE(replies_.back());
+            return;
+          }
+          task_callbacks_.push_back(std::move(send_reply_callback));
+        });
+  }
+
+ protected:
+  bool reply_while_dispatching_ = false;
+  int64_t current_time_ms_ = 0;
+  PushTasksBatches batches_{[this]() { return current_time_ms_; }};
+  std::vector<SendReplyCallback> task_callbacks_;
+  std::vector<std::unique_ptr<PushTasksReply>> replies_;
+  std::vector<Status> statuses_;
+};
+
+TEST_F(BatchedRequestHandlerTest, TestReplyAsSoonAsAnyTaskFinishes) {
+  PushTasks(3);
+  ASSERT_EQ(task_callbacks_.size(), 3);
+  ASSERT_FALSE(Reply(0));
+  ASSERT_EQ(batches_.NumBatches(), 1);
+
+  // The batch is replied to as soon as one of its tasks is, even if it isn't the first.
+  ReplyTask(1);
+  ASSERT_TRUE(Reply(0));
+  ASSERT_EQ(RepliedTasks(0), std::vector<int>({1}));
+  auto batch_id = Reply(0)->batch_id();
+  ASSERT_NE(batch_id, 0);
+
+  // The tasks that finish before the caller polls again are sent back together.
+  ReplyTask(0, Status::Invalid("task failed"));
+  Poll(batch_id);
+  ASSERT_TRUE(Reply(1));
+  ASSERT_EQ(RepliedTasks(1), std::vector<int>({0}));
+  ASSERT_EQ(Reply(1)->replies(0).error_code(), Status::Invalid("").CodeAsString());
+  ASSERT_EQ(Reply(1)->replies(0).error_message(), "task failed");
+  ASSERT_EQ(Reply(1)->batch_id(), batch_id);
+
+  // A poll waits for the next task to finish. The last task ends the batch.
+  Poll(batch_id);
+  ASSERT_FALSE(Reply(2));
+  ReplyTask(2);
+  ASSERT_TRUE(Reply(2));
+  ASSERT_EQ(RepliedTasks(2), std::vector<int>({2}));
+  ASSERT_EQ(Reply(2)->batch_id(), 0);
+  ASSERT_EQ(batches_.NumBatches(), 0);
+  for (const auto &status : statuses_) {
+    ASSERT_TRUE(status.ok());
+  }
+}
+
+TEST_F(BatchedRequestHandlerTest, TestPollUnknownBatch) {
+  Poll(1);
+  ASSERT_TRUE(Reply(0));
+  ASSERT_TRUE(statuses_[0].IsInvalid());
+
+  // A batch can only be polled by one request at a time.
+  PushTasks(2);
+  ReplyTask(0);
+  auto batch_id = Reply(1)->batch_id();
+  Poll(batch_id);
+  Poll(batch_id);
+  ASSERT_TRUE(Reply(3));
+  ASSERT_TRUE(statuses_[2].IsInvalid());
+  ReplyTask(1);
+  ASSERT_TRUE(Reply(2));
+  ASSERT_EQ(RepliedTasks(2), std::vector<int>({1}));
+  ASSERT_EQ(batches_.NumBatches(), 0);
+}
+
+TEST_F(BatchedRequestHandlerTest, TestTasksFinishedWhileDispatching) {
+  reply_while_dispatching_ = true;
+  PushTasks(3);
+  ASSERT_TRUE(Reply(0));
+  ASSERT_EQ(RepliedTasks(0), std::vector<int>({0, 1, 2}));
+  ASSERT_EQ(Reply(0)->batch_id(), 0);
+  ASSERT_EQ(batches_.NumBatches(), 0);
+}
+
+TEST_F(BatchedRequestHandlerTest, TestDropUnpolledBatch) {
+  const int64_t timeout_ms = RayConfig::instance().batched_request_unpolled_timeout_ms();
+  current_time_ms_ = timeout_ms;
+  PushTasks(2);
+  ReplyTask(0);
+  auto batch_id = Reply(0)->batch_id();
+  ASSERT_NE(batch_id, 0);
+
+  // A batch that its caller hasn't polled for yet is kept until the timeout.
+  current_time_ms_ += timeout_ms;
+  PushTasks(1);
+  ASSERT_EQ(batches_.NumBatches(), 2);
+
+  // The caller of the first batch never polls for it again, as if it died.
+  current_time_ms_ += 1;
+  ReplyTask(1);
+  current_time_ms_ += timeout_ms;
+  PushTasks(1);
+  ASSERT_EQ(batches_.NumBatches(), 2);
+  Poll(batch_id);
+  ASSERT_TRUE(statuses_.back().IsInvalid());
+
+  // The batches that are still waiting for their first reply are kept.
+  ReplyTask(2);
+  ReplyTask(3);
+  ASSERT_EQ(batches_.NumBatches(), 0);
+}
+
+/// Handles the tasks pushed to it like an actor with an empty method, one at a time on
+/// its own thread.
+class PingPongActorHandler {
+ public:
+  PingPongActorHandler() {
+    execution_thread_ = std::thread([this]() {
+      boost::asio::io_service::work work(execution_service_);
+      execution_service_.run();
+    });
+  }
+
+  ~PingPongActorHandler() {
+    execution_service_.stop();
+    execution_thread_.join();
+  }
+
+  void HandlePushTask(const PushTaskRequest &request, PushTaskReply *reply,
+                      SendReplyCallback send_reply_callback) {
+    execution_service_.post(
+        [send_reply_callback = std::move(send_reply_callback)]() {
+          send_reply_callback(Status::OK(), nullptr, nullptr);
+        },
+        "PingPongActor.Task");
+  }
+
+  void HandlePushTasks(const PushTasksRequest &request, PushTasksReply *reply,
+                       SendReplyCallback send_reply_callback) {
+    batches_.HandleBatch(request, reply, std::move(send_reply_callback),
+                         [this](const PushTaskRequest &request, PushTaskReply *reply,
+                                SendReplyCallback send_reply_callback) {
+                           HandlePushTask(request, reply, std::move(send_reply_callback));
+                         });
+  }
+
+ private:
+  PushTasksBatches batches_;
+  instrumented_io_context execution_service_;
+  std::thread execution_thread_;
+};
+
+class PingPongActorGrpcService : public GrpcService {
+ public:
+  PingPongActorGrpcService(instrumented_io_context &main_service,
+                           PingPongActorHandler &handler)
+      : GrpcService(main_service), handler_(handler) {}
+
+ protected:
+  grpc::Service &GetGrpcService() override { return service_; }
+
+  void InitServerCallFactories(
+      const std::unique_ptr<grpc::ServerCompletionQueue> &cq,
+      std::vector<std::unique_ptr<ServerCallFactory>> *server_call_factories) override {
+    server_call_factories->emplace_back(
+        std::make_unique<ServerCallFactoryImpl<CoreWorkerService, PingPongActorHandler,
+                                               PushTaskRequest, PushTaskReply>>(
+            service_, &CoreWorkerService::AsyncService::RequestPushTask, handler_,
+            &PingPongActorHandler::HandlePushTask, cq, main_service_,
+            "CoreWorkerService.grpc_server.PushTask", -1));
+    server_call_factories->emplace_back(
+        std::make_unique<ServerCallFactoryImpl<CoreWorkerService, PingPongActorHandler,
+                                               PushTasksRequest, PushTasksReply>>(
+            service_, &CoreWorkerService::AsyncService::RequestPushTasks, handler_,
+            &PingPongActorHandler::HandlePushTasks, cq, main_service_,
+            "CoreWorkerService.grpc_server.PushTasks", -1));
+  }
+
+ private:
+  CoreWorkerService::AsyncService service_;
+  PingPongActorHandler &handler_;
+};
+
+/// Calls an actor with an empty method over gRPC, like the "1:1 actor calls async"
+/// microbenchmark, with and without batching.
+TEST(PushTasksBenchmarkTest, BenchmarkPingPongActor) {
+  instrumented_io_context server_io_service;
+  std::thread server_thread([&server_io_service]() {
+    boost::asio::io_service::work work(server_io_service);
+    server_io_service.run();
+  });
+  PingPongActorHandler handler;
+  PingPongActorGrpcService service(server_io_service, handler);
+  GrpcServer server("ping_pong_actor", 0, true);
+  server.RegisterService(service);
+  server.Run();
+  while (server.GetPort() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  instrumented_io_context client_io_service;
+  std::thread client_thread([&client_io_service]() {
+    boost::asio::io_service::work work(client_io_service);
+    client_io_service.run();
+  });
+  ClientCallManager client_call_manager(client_io_service);
+  rpc::Address address;
+  address.set_ip_address("127.0.0.1");
+  address.set_port(server.GetPort());
+
+  auto &max_push_task_batch_size = RayConfig::instance().max_push_task_batch_size();
+  auto original_max_push_task_batch_size = max_push_task_batch_size;
+  const int num_calls = 20000;
+  for (uint32_t batch_size : {1, 8, 32}) {
+    for (int calls_in_flight : {1, 1000}) {
+      max_push_task_batch_size = batch_size;
+      auto client = std::make_shared<CoreWorkerClient>(address, client_call_manager);
+      std::atomic<int> num_replied(0);
+      auto start = std::chrono::steady_clock::now();
+      for (int submitted = 0; submitted < num_calls; submitted += calls_in_flight) {
+        // Submit the calls together, like an actor submit queue does with the tasks
+        // that become sendable at once, and wait for them to finish.
+        std::vector<PushTaskRequestAndCallback> requests;
+        for (int i = 0; i < calls_in_flight; i++) {
+          auto request = std::make_unique<PushTaskRequest>();
+          request->set_sequence_number(submitted + i);
+          request->mutable_task_spec()->set_type(TaskType::ACTOR_TASK);
+          requests.emplace_back(std::move(request),
+                                [&num_replied](Status status, const PushTaskReply &) {
+                                  RAY_CHECK_OK(status);
+                                  num_replied++;
+                                });
+        }
+        client->PushActorTasks(std::move(requests));
+        while (num_replied < submitted + calls_in_flight) {
+          std::this_thread::yield();
+        }
+      }
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+      RAY_LOG(INFO) << "Batch size " << batch_size << ", " << calls_in_flight
+                    << " calls in flight: " << num_calls * 1000000L / us
+                    << " calls/s, " << us / (num_calls / calls_in_flight)
+                    << " us per round.";
+    }
+  }
+  max_push_task_batch_size = original_max_push_task_batch_size;
+
+  server.Shutdown();
+  client_io_service.stop();
+  client_thread.join();
+  server_io_service.stop();
+  server_thread.join();
+}
+
+}  // namespace rpc
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -305,6 +305,39 @@ TEST_F(TestGrpcServerClientFixture, TestTimeoutMacro) {
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
   }
 }
+
+TEST_F(TestGrpcServerClientFixture, TestDeferredRequests) {
+  // A server whose service doesn't accept requests until it is told to.
+  TestServiceHandler deferred_handler;
+  TestGrpcService deferred_service(handler_io_service_, deferred_handler);
+  GrpcServer deferred_server("deferred", 0, true);
+  deferred_server.RegisterService(deferred_service, /*accept_requests=*/false);
+  deferred_server.Run();
+  auto deferred_client = std::make_unique<GrpcClient<TestService>>(
+      "127.0.0.1", deferred_server.GetPort(), *client_call_manager_);
+
+  PingRequest request;
+  std::atomic<bool> done(false);
+  INVOKE_RPC_CALL(
+      TestService, Ping, request,
+      [&done](const Status &status, const PingReply &reply) {
+        ASSERT_TRUE(status.ok());
+        done = true;
+      },
+      deferred_client, /*method_timeout_ms*/ -1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  ASSERT_EQ(deferred_handler.request_count, 0);
+  ASSERT_FALSE(done);
+
+  // The request that waited is handled once the requests are accepted.
+  deferred_server.AcceptDeferredRequests();
+  while (!done) {
+    RAY_LOG(INFO) << "waiting";
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(deferred_handler.request_count, 1);
+  deferred_client.reset();
+}
 }  // namespace rpc
 }  // namespace ray
 
@@ -0,0 +1,304 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/task_spec_template.h"
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "ray/common/id.h"
+#include "ray/common/ray_config.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace rpc {
+
+class TaskSpecTemplateTest : public ::testing::Test {
+ public:
+  TaskSpecTemplateTest() {
+    caller_address_.set_raylet_id(NodeID::FromRandom().Binary());
+    caller_address_.set_ip_address("127.0.0.1");
+    caller_address_.set_port(12345);
+    caller_address_.set_worker_id(WorkerID::FromRandom().Binary());
+  }
+
+ protected:
+  /// Make the request of a task of a function, which differs from the other tasks of
+  /// the function in its IDs and argument.
+  PushTaskRequest MakeRequest(const std::string &function_name, int arg) {
+    const auto job_id = JobID::FromInt(1);
+    PushTaskRequest request;
+    request.set_intended_worker_id(WorkerID::FromRandom().Binary());
+    auto *spec = request.mutable_task_spec();
+    spec->set_type(TaskType::NORMAL_TASK);
+    spec->set_name(function_name);
+    spec->set_language(Language::PYTHON);
+    auto *function_descriptor =
+        spec->mutable_function_descriptor()->mutable_python_function_descriptor();
+    function_descriptor->set_module_name("benchmark.module");
+    function_descriptor->set_function_name(function_name);
+    function_descriptor->set_function_hash(std::string(40, 'f'));
+    spec->set_job_id(job_id.Binary());
+    spec->set_task_id(TaskID::FromRandom(job_id).Binary());
+    spec->set_parent_task_id(TaskID::ForDriverTask(job_id).Binary());
+    spec->set_parent_counter(arg);
+    spec->set_caller_id(TaskID::ForDriverTask(job_id).Binary());
+    spec->mutable_caller_address()->CopyFrom(caller_address_);
+    spec->add_args()->set_data(std::to_string(arg));
+    spec->set_num_returns(1);
+    (*spec->mutable_required_resources())["CPU"] = 1;
+    (*spec->mutable_required_resources())["memory"] = 1024 * 1024 * 1024;
+    (*spec->mutable_required_placement_resources())["CPU"] = 1;
+    spec->set_max_retries(3);
+    spec->mutable_runtime_env_info()->set_serialized_runtime_env(
+        "{\"pip\": [\"requests\"], \"env_vars\": {\"OMP_NUM_THREADS\": \"1\"}}");
+    spec->mutable_scheduling_strategy()->mutable_default_scheduling_strategy();
+    spec->set_depth(1);
+    return request;
+  }
+
+  /// Encode a request, and decode it like the worker does after receiving it.
+  TaskSpecTemplateEncoder::EncodedTask EncodeAndDecode(TaskSpecTemplateEncoder &encoder,
+                                                       TaskSpecTemplateDecoder &decoder,
+                                                       const PushTaskRequest &request) {
+    PushTaskRequest encoded = request;
+    auto encoded_task = encoder.Encode(&encoded);
+    PushTaskRequest received;
+    RAY_CHECK(received.ParseFromString(encoded.SerializeAsString()));
+    RAY_CHECK_OK(decoder.Decode(&received));
+    EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(received, request));
+    return encoded_task;
+  }
+
+  Address caller_address_;
+};
+
+TEST_F(TaskSpecTemplateTest, TestEncodeAndDecode) {
+  TaskSpecTemplateEncoder encoder(/*max_templates=*/10);
+  TaskSpecTemplateDecoder decoder;
+
+  // The template is sent along with the tasks until it's registered.
+  auto request = MakeRequest("f", 0);
+  PushTaskRequest encoded = request;
+  auto encoded_task = encoder.Encode(&encoded);
+  const auto template_id = encoded_task.template_id;
+  ASSERT_NE(template_id, 0);
+  ASSERT_EQ(encoded.task_spec_template_id(), template_id);
+  ASSERT_TRUE(encoded.has_task_spec_template());
+  ASSERT_FALSE(encoded.task_spec().has_function_descriptor());
+  ASSERT_TRUE(encoded.task_spec().required_resources().empty());
+  ASSERT_EQ(encoded.task_spec().args_size(), 1);
+  ASSERT_EQ(EncodeAndDecode(encoder, decoder, MakeRequest("f", 1)).template_id,
+            template_id);
+  ASSERT_EQ(decoder.NumTemplates(), 1);
+
+  // Once it is registered, the tasks only carry its ID.
+  encoder.OnTaskReplied(encoded_task, /*success=*/true);
+  request = MakeRequest("f", 2);
+  encoded = request;
+  ASSERT_EQ(encoder.Encode(&encoded).template_id, template_id);
+  ASSERT_EQ(encoded.task_spec_template_id(), template_id);
+  ASSERT_FALSE(encoded.has_task_spec_template());
+  ASSERT_LT(encoded.ByteSizeLong(), request.ByteSizeLong() / 2);
+  ASSERT_TRUE(decoder.Decode(&encoded).ok());
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(encoded, request));
+
+  // A task of another function uses another template.
+  auto other_template_id =
+      EncodeAndDecode(encoder, decoder, MakeRequest("g", 0)).template_id;
+  ASSERT_NE(other_template_id, 0);
+  ASSERT_NE(other_template_id, template_id);
+  ASSERT_EQ(decoder.NumTemplates(), 2);
+  // Switching back to the first function finds its template again.
+  ASSERT_EQ(EncodeAndDecode(encoder, decoder, MakeRequest("f", 3)).template_id,
+            template_id);
+}
+
+TEST_F(TaskSpecTemplateTest, TestUnregisteredTemplate) {
+  TaskSpecTemplateEncoder encoder(/*max_templates=*/10);
+  TaskSpecTemplateDecoder decoder;
+  encoder.OnTaskReplied(EncodeAndDecode(encoder, decoder, MakeRequest("f", 0)),
+                        /*success=*/true);
+
+  // A worker that didn't register the template, such as a restarted one, rejects the
+  // task instead of running it with the wrong spec.
+  auto encoded = MakeRequest("f", 1);
+  ASSERT_FALSE(encoded.has_task_spec_template());
+  ASSERT_NE(encoder.Encode(&encoded).template_id, 0);
+  TaskSpecTemplateDecoder other_decoder;
+  ASSERT_TRUE(other_decoder.Decode(&encoded).IsInvalid());
+}
+
+TEST_F(TaskSpecTemplateTest, TestEvictTemplates) {
+  TaskSpecTemplateEncoder encoder(/*max_templates=*/1);
+  TaskSpecTemplateDecoder decoder;
+  auto f_task = EncodeAndDecode(encoder, decoder, MakeRequest("f", 0));
+  ASSERT_NE(f_task.template_id, 0);
+
+  // The task specs that would need another template while the only one is used by a
+  // task in flight are pushed whole.
+  auto request = MakeRequest("g", 0);
+  PushTaskRequest encoded = request;
+  ASSERT_EQ(encoder.Encode(&encoded).template_id, 0);
+  ASSERT_EQ(encoded.task_spec_template_id(), 0);
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(encoded, request));
+
+  // Once the task is replied to, its template is evicted for the next function, and
+  // the worker is told to drop it until a task that says so is replied to.
+  encoder.OnTaskReplied(f_task, /*success=*/true);
+  encoded = MakeRequest("g", 1);
+  auto g_task = encoder.Encode(&encoded);
+  ASSERT_NE(g_task.template_id, 0);
+  ASSERT_NE(g_task.template_id, f_task.template_id);
+  ASSERT_EQ(encoded.evicted_task_spec_template_ids_size(), 1);
+  ASSERT_EQ(encoded.evicted_task_spec_template_ids(0), f_task.template_id);
+  ASSERT_TRUE(decoder.Decode(&encoded).ok());
+  ASSERT_EQ(decoder.NumTemplates(), 1);
+  encoder.OnTaskReplied(g_task, /*success=*/false);
+  encoded = MakeRequest("g", 2);
+  g_task = encoder.Encode(&encoded);
+  ASSERT_EQ(encoded.evicted_task_spec_template_ids_size(), 1);
+  ASSERT_TRUE(encoded.has_task_spec_template());
+  encoder.OnTaskReplied(g_task, /*success=*/true);
+  encoded = MakeRequest("g", 3);
+  encoder.Encode(&encoded);
+  ASSERT_EQ(encoded.evicted_task_spec_template_ids_size(), 0);
+  ASSERT_FALSE(encoded.has_task_spec_template());
+
+  // Templates can be disabled.
+  TaskSpecTemplateEncoder disabled_encoder(/*max_templates=*/0);
+  encoded = request;
+  ASSERT_EQ(disabled_encoder.Encode(&encoded).template_id, 0);
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(encoded, request));
+}
+
+TEST_F(TaskSpecTemplateTest, TestTemplatesPerSender) {
+  TaskSpecTemplateEncoder encoder(/*max_templates=*/1);
+  TaskSpecTemplateEncoder other_encoder(/*max_templates=*/1);
+  TaskSpecTemplateDecoder decoder;
+  auto f_task = EncodeAndDecode(encoder, decoder, MakeRequest("f", 0));
+  encoder.OnTaskReplied(f_task, /*success=*/true);
+  const auto caller_address = caller_address_;
+  caller_address_.set_worker_id(WorkerID::FromRandom().Binary());
+  auto other_f_task = EncodeAndDecode(other_encoder, decoder, MakeRequest("f", 0));
+  other_encoder.OnTaskReplied(other_f_task, /*success=*/true);
+  ASSERT_EQ(decoder.NumSenders(), 2);
+  ASSERT_EQ(decoder.NumTemplates(), 2);
+
+  // Evicting the template of one sender doesn't drop the template of the other one.
+  auto g_task = EncodeAndDecode(other_encoder, decoder, MakeRequest("g", 0));
+  ASSERT_NE(g_task.template_id, 0);
+  ASSERT_EQ(decoder.NumTemplates(), 2);
+  caller_address_ = caller_address;
+  auto request = MakeRequest("f", 1);
+  PushTaskRequest encoded = request;
+  ASSERT_EQ(encoder.Encode(&encoded).template_id, f_task.template_id);
+  ASSERT_FALSE(encoded.has_task_spec_template());
+  ASSERT_TRUE(decoder.Decode(&encoded).ok());
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(encoded, request));
+}
+
+TEST_F(TaskSpecTemplateTest, TestDropIdleSenders) {
+  const int64_t timeout_ms = RayConfig::instance().task_spec_template_idle_timeout_ms();
+  int64_t now_ms = 0;
+  auto get_time_ms = [&now_ms]() { return now_ms; };
+  TaskSpecTemplateEncoder encoder(/*max_templates=*/10, get_time_ms);
+  TaskSpecTemplateEncoder other_encoder(/*max_templates=*/10, get_time_ms);
+  TaskSpecTemplateDecoder decoder(get_time_ms);
+  encoder.OnTaskReplied(EncodeAndDecode(encoder, decoder, MakeRequest("f", 0)),
+                        /*success=*/true);
+  auto late_task = EncodeAndDecode(encoder, decoder, MakeRequest("f", 1));
+  const auto caller_address = caller_address_;
+  caller_address_.set_worker_id(WorkerID::FromRandom().Binary());
+  other_encoder.OnTaskReplied(
+      EncodeAndDecode(other_encoder, decoder, MakeRequest("f", 0)), /*success=*/true);
+  ASSERT_EQ(decoder.NumSenders(), 2);
+
+  // The templates of a sender that keeps pushing tasks are kept, and the templates of
+  // one that stopped, such as one that died, are dropped.
+  now_ms += timeout_ms / 2;
+  EncodeAndDecode(other_encoder, decoder, MakeRequest("f", 1));
+  now_ms += timeout_ms / 2;
+  EncodeAndDecode(other_encoder, decoder, MakeRequest("f", 2));
+  ASSERT_EQ(decoder.NumSenders(), 1);
+  ASSERT_EQ(decoder.NumTemplates(), 1);
+
+  // A sender that was idle for long enough that its templates may have been dropped
+  // sends them again, even if a task pushed before that is replied to after.
+  caller_address_ = caller_address;
+  auto request = MakeRequest("f", 2);
+  PushTaskRequest encoded = request;
+  auto encoded_task = encoder.Encode(&encoded);
+  ASSERT_TRUE(encoded.has_task_spec_template());
+  ASSERT_TRUE(decoder.Decode(&encoded).ok());
+  ASSERT_TRUE(google::protobuf::util::MessageDifferencer::Equals(encoded, request));
+  encoder.OnTaskReplied(late_task, /*success=*/true);
+  encoded = MakeRequest("f", 3);
+  encoder.OnTaskReplied(encoder.Encode(&encoded), /*success=*/true);
+  ASSERT_TRUE(encoded.has_task_spec_template());
+  encoder.OnTaskReplied(encoded_task, /*success=*/true);
+  encoded = MakeRequest("f", 4);
+  ASSERT_NE(encoder.Encode(&encoded).template_id, 0);
+  ASSERT_FALSE(encoded.has_task_spec_template());
+}
+
+TEST_F(TaskSpecTemplateTest, BenchmarkRequestBytes) {
+  const int num_tasks = 100000;
+  std::vector<PushTaskRequest> requests;
+  for (int i = 0; i < num_tasks; i++) {
+    requests.push_back(MakeRequest("f", i));
+  }
+
+  for (size_t max_templates : {0, 1}) {
+    TaskSpecTemplateEncoder encoder(max_templates);
+    TaskSpecTemplateDecoder decoder;
+    size_t total_bytes = 0;
+    std::chrono::steady_clock::duration encode_time{0};
+    std::chrono::steady_clock::duration decode_time{0};
+    for (auto &request : requests) {
+      // Encode and serialize the request like the client does, and parse and decode it
+      // like the worker does.
+      auto start = std::chrono::steady_clock::now();
+      auto encoded_task = encoder.Encode(&request);
+      auto serialized = request.SerializeAsString();
+      encode_time += std::chrono::steady_clock::now() - start;
+      total_bytes += serialized.size();
+      start = std::chrono::steady_clock::now();
+      PushTaskRequest received;
+      ASSERT_TRUE(received.ParseFromString(serialized));
+      ASSERT_TRUE(decoder.Decode(&received).ok());
+      decode_time += std::chrono::steady_clock::now() - start;
+      encoder.OnTaskReplied(encoded_task, /*success=*/true);
+      request.Swap(&received);
+    }
+    auto to_ms = [](std::chrono::steady_clock::duration duration) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    };
+    RAY_LOG(INFO) << (max_templates == 0 ? "Whole task specs" : "Task spec templates")
+                  << ": " << total_bytes / num_tasks << " bytes per request, "
+                  << to_ms(encode_time) << " ms to encode and serialize and "
+                  << to_ms(decode_time) << " ms to parse and decode " << num_tasks
+                  << " requests.";
+  }
+}
+
+}  // namespace rpc
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -26,12 +26,15 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/hash/hash.h"
 #include "ray/common/status.h"
 #include "ray/pubsub/subscriber.h"
+#include "ray/rpc/batched_request_handler.h"
 #include "ray/rpc/grpc_client.h"
+#include "ray/rpc/worker/task_spec_template.h"
 #include "ray/util/logging.h"
 #include "src/ray/protobuf/core_worker.grpc.pb.h"
 #include "src/ray/protobuf/core_worker.pb.h"
@@ -54,6 +57,10 @@ const static int64_t RequestSizeInBytes(const PushTaskRequest &request) {
   return size;
 }
 
+/// A task to push, and the callback that handles its reply.
+using PushTaskRequestAndCallback =
+    std::pair<std::unique_ptr<PushTaskRequest>, ClientCallback<PushTaskReply>>;
+
 // Shared between direct actor and task submitters.
 /* class CoreWorkerClientInterface; */
 
@@ -117,6 +124,27 @@ class CoreWorkerClientInterface : public pubsub::SubscriberClientInterface {
   virtual void PushNormalTask(std::unique_ptr<PushTaskRequest> request,
                               const ClientCallback<PushTaskReply> &callback) {}
 
+  /// Push actor tasks that don't skip the task queue, in order. This is the same as
+  /// calling PushActorTask for each of them, except that the client can send them in
+  /// fewer RPCs.
+  ///
+  /// \param[in] requests The requests and the callbacks that handle their replies.
+  virtual void PushActorTasks(std::vector<PushTaskRequestAndCallback> requests) {
+    for (auto &request : requests) {
+      PushActorTask(std::move(request.first), /*skip_queue=*/false, request.second);
+    }
+  }
+
+  /// Push non-actor tasks. This is the same as calling PushNormalTask for each of them,
+  /// except that the client can send them in fewer RPCs.
+  ///
+  /// \param[in] requests The requests and the callbacks that handle their replies.
+  virtual void PushNormalTasks(std::vector<PushTaskRequestAndCallback> requests) {
+    for (auto &request : requests) {
+      PushNormalTask(std::move(request.first), request.second);
+    }
+  }
+
   /// Notify a wait has completed for direct actor call arguments.
   ///
   /// \param[in] request The request message.
@@ -211,7 +239,11 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   /// \param[in] port Port of the worker server.
   /// \param[in] client_call_manager The `ClientCallManager` used for managing requests.
   CoreWorkerClient(const rpc::Address &address, ClientCallManager &client_call_manager)
-      : addr_(address) {
+      : addr_(address),
+        max_push_task_batch_size_(
+            std::max<size_t>(::RayConfig::instance().max_push_task_batch_size(), 1)),
+        task_spec_templates_(std::make_shared<TaskSpecTemplateEncoder>(
+            ::RayConfig::instance().max_task_spec_templates_per_worker())) {
     grpc_client_ = std::make_unique<GrpcClient<CoreWorkerService>>(
         addr_.ip_address(), addr_.port(), client_call_manager);
   };
@@ -282,7 +314,8 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
       // processing this request. We could also set it to max_finished_seq_no_,
       // but we just set it to the default of -1 to avoid taking the lock.
       request->set_client_processed_up_to(-1);
-      INVOKE_RPC_CALL(CoreWorkerService, PushTask, *request, callback, grpc_client_,
+      auto rpc_callback = EncodeTaskSpec(request.get(), callback);
+      INVOKE_RPC_CALL(CoreWorkerService, PushTask, *request, rpc_callback, grpc_client_,
                       /*method_timeout_ms*/ -1);
       return;
     }
@@ -296,14 +329,45 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
     SendRequests();
   }
 
+  void PushActorTasks(std::vector<PushTaskRequestAndCallback> requests) override {
+    {
+      absl::MutexLock lock(&mutex_);
+      for (auto &request : requests) {
+        send_queue_.push_back(std::move(request));
+      }
+    }
+    SendRequests();
+  }
+
   void PushNormalTask(std::unique_ptr<PushTaskRequest> request,
                       const ClientCallback<PushTaskReply> &callback) override {
     request->set_sequence_number(-1);
     request->set_client_processed_up_to(-1);
-    INVOKE_RPC_CALL(CoreWorkerService, PushTask, *request, callback, grpc_client_,
+    auto rpc_callback = EncodeTaskSpec(request.get(), callback);
+    INVOKE_RPC_CALL(CoreWorkerService, PushTask, *request, rpc_callback, grpc_client_,
                     /*method_timeout_ms*/ -1);
   }
 
+  void PushNormalTasks(std::vector<PushTaskRequestAndCallback> requests) override {
+    for (size_t start = 0; start < requests.size(); start += max_push_task_batch_size_) {
+      size_t end = std::min(requests.size(), start + max_push_task_batch_size_);
+      if (end - start == 1) {
+        PushNormalTask(std::move(requests[start].first), requests[start].second);
+        continue;
+      }
+      PushTasksRequest batch_request;
+      auto callbacks = std::make_shared<std::vector<ClientCallback<PushTaskReply>>>();
+      for (size_t i = start; i < end; i++) {
+        auto task_request = batch_request.add_requests();
+        task_request->Swap(requests[i].first.get());
+        task_request->set_sequence_number(-1);
+        task_request->set_client_processed_up_to(-1);
+        callbacks->push_back(EncodeTaskSpec(task_request, requests[i].second));
+      }
+      PushTasks(batch_request, std::move(callbacks));
+    }
+  }
+
   /// Send as many pending tasks as possible. This method is thread-safe.
   ///
   /// The client will guarantee no more than kMaxBytesInFlight bytes of RPCs are being
@@ -314,33 +378,51 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
     auto this_ptr = this->shared_from_this();
 
     while (!send_queue_.empty() && rpc_bytes_in_flight_ < kMaxBytesInFlight) {
-      auto pair = std::move(*send_queue_.begin());
-      send_queue_.pop_front();
-
-      auto request = std::move(pair.first);
-      int64_t task_size = RequestSizeInBytes(*request);
-      int64_t seq_no = request->sequence_number();
-      request->set_client_processed_up_to(max_finished_seq_no_);
-      rpc_bytes_in_flight_ += task_size;
-
-      auto rpc_callback = [this, this_ptr, seq_no, task_size,
-                           callback = std::move(pair.second)](
-                              Status status, const rpc::PushTaskReply &reply) {
-        {
-          absl::MutexLock lock(&mutex_);
-          if (seq_no > max_finished_seq_no_) {
-            max_finished_seq_no_ = seq_no;
+      // Take as many queued requests as fit in a batch and in the bytes in flight.
+      std::vector<PushTaskRequestAndCallback> batch;
+      int64_t batch_bytes = 0;
+      while (!send_queue_.empty() && batch.size() < max_push_task_batch_size_ &&
+             rpc_bytes_in_flight_ + batch_bytes < kMaxBytesInFlight) {
+        auto &request = *send_queue_.front().first;
+        int64_t task_size = RequestSizeInBytes(request);
+        int64_t seq_no = request.sequence_number();
+        batch_bytes += task_size;
+        request.set_client_processed_up_to(max_finished_seq_no_);
+        auto on_replied = [this, this_ptr, seq_no, task_size]() {
+          {
+            absl::MutexLock lock(&mutex_);
+            if (seq_no > max_finished_seq_no_) {
+              max_finished_seq_no_ = seq_no;
+            }
+            rpc_bytes_in_flight_ -= task_size;
+            RAY_CHECK(rpc_bytes_in_flight_ >= 0);
           }
-          rpc_bytes_in_flight_ -= task_size;
-          RAY_CHECK(rpc_bytes_in_flight_ >= 0);
+          SendRequests();
+        };
+        send_queue_.front().second = EncodeTaskSpec(
+            &request, [on_replied, callback = std::move(send_queue_.front().second)](
+                          Status status, const rpc::PushTaskReply &reply) {
+              on_replied();
+              callback(status, reply);
+            });
+        batch.push_back(std::move(send_queue_.front()));
+        send_queue_.pop_front();
+      }
+      rpc_bytes_in_flight_ += batch_bytes;
+
+      if (batch.size() == 1) {
+        RAY_UNUSED(INVOKE_RPC_CALL(CoreWorkerService, PushTask, *batch[0].first,
+                                   std::move(batch[0].second), grpc_client_,
+                                   /*method_timeout_ms*/ -1));
+      } else {
+        PushTasksRequest batch_request;
+        auto callbacks = std::make_shared<std::vector<ClientCallback<PushTaskReply>>>();
+        for (auto &request : batch) {
+          batch_request.add_requests()->Swap(request.first.get());
+          callbacks->push_back(std::move(request.second));
         }
-        SendRequests();
-        callback(status, reply);
-      };
-
-      RAY_UNUSED(INVOKE_RPC_CALL(CoreWorkerService, PushTask, *request,
-                                 std::move(rpc_callback), grpc_client_,
-                                 /*method_timeout_ms*/ -1));
+        PushTasks(batch_request, std::move(callbacks));
+      }
     }
 
     if (!send_queue_.empty()) {
@@ -355,6 +437,50 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   }
 
  private:
+  /// Leave out the fields of the task spec of a request that its template holds, and
+  /// wrap the callback of the task so that the encoder learns about the reply.
+  ClientCallback<PushTaskReply> EncodeTaskSpec(PushTaskRequest *request,
+                                               ClientCallback<PushTaskReply> callback) {
+    auto encoded_task = task_spec_templates_->Encode(request);
+    if (encoded_task.template_id == 0 &&
+        request->evicted_task_spec_template_ids_size() == 0) {
+      return callback;
+    }
+    return [task_spec_templates = task_spec_templates_, encoded_task,
+            callback = std::move(callback)](Status status, const PushTaskReply &reply) {
+      task_spec_templates->OnTaskReplied(encoded_task, status.ok());
+      callback(status, reply);
+    };
+  }
+
+  /// Send a batch of tasks in one PushTasks RPC, and call the callback of every task
+  /// with its own reply as soon as the worker sends it back. As long as some tasks of
+  /// the batch haven't been replied to, the worker is polled for their replies. If an
+  /// RPC fails, every task that wasn't replied to yet fails with its status.
+  ///
+  /// \param[in] request The batch of tasks, or the poll for the rest of a batch.
+  /// \param[in] callbacks The callbacks of the tasks, in the order of the batch. The
+  /// callback of a task is reset once it is called.
+  void PushTasks(const PushTasksRequest &request,
+                 std::shared_ptr<std::vector<ClientCallback<PushTaskReply>>> callbacks) {
+    auto this_ptr = this->shared_from_this();
+    auto rpc_callback = [this, this_ptr, callbacks = std::move(callbacks)](
+                            Status status, const rpc::PushTasksReply &reply) {
+      // Poll for the rest of the batch before calling back, so that the worker can
+      // send the next replies as soon as they are ready.
+      if (status.ok() && reply.batch_id() != 0) {
+        PushTasksRequest poll_request;
+        poll_request.set_batch_id(reply.batch_id());
+        poll_request.set_intended_worker_id(addr_.worker_id());
+        PushTasks(poll_request, callbacks);
+      }
+      CallBackBatchedRequests(status, reply, callbacks.get());
+    };
+    RAY_UNUSED(INVOKE_RPC_CALL(CoreWorkerService, PushTasks, request,
+                               std::move(rpc_callback), grpc_client_,
+                               /*method_timeout_ms*/ -1));
+  }
+
   /// Protects against unsafe concurrent access from the callback thread.
   absl::Mutex mutex_;
 
@@ -373,6 +499,12 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
 
   /// The max sequence number we have processed responses for.
   int64_t max_finished_seq_no_ GUARDED_BY(mutex_) = -1;
+
+  /// The max number of tasks that are sent in one PushTasks RPC.
+  const size_t max_push_task_batch_size_;
+
+  /// The task spec templates of the tasks pushed to the worker.
+  std::shared_ptr<TaskSpecTemplateEncoder> task_spec_templates_;
 };
 
 typedef std::function<std::shared_ptr<CoreWorkerClientInterface>(const rpc::Address &)>
@@ -0,0 +1,304 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/task_spec_template.h"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
+#include "ray/common/ray_config.h"
+
+namespace ray {
+namespace rpc {
+
+namespace {
+
+/// Swap a message field of two task specs, without creating it where it's not set.
+template <typename T>
+void SwapMessageField(TaskSpec *a, TaskSpec *b, T *(TaskSpec::*release)(),
+                      void (TaskSpec::*set_allocated)(T *)) {
+  T *a_field = (a->*release)();
+  (a->*set_allocated)((b->*release)());
+  (b->*set_allocated)(a_field);
+}
+
+/// Swap the fields of two task specs that are moved to the template of a task spec.
+/// This uses the generated accessors rather than reflection, since it's done for every
+/// task.
+void SwapTemplateFields(TaskSpec *spec, TaskSpec *task_template) {
+  auto type = spec->type();
+  spec->set_type(task_template->type());
+  task_template->set_type(type);
+  auto language = spec->language();
+  spec->set_language(task_template->language());
+  task_template->set_language(language);
+  auto num_returns = spec->num_returns();
+  spec->set_num_returns(task_template->num_returns());
+  task_template->set_num_returns(num_returns);
+  auto max_retries = spec->max_retries();
+  spec->set_max_retries(task_template->max_retries());
+  task_template->set_max_retries(max_retries);
+  auto retry_exceptions = spec->retry_exceptions();
+  spec->set_retry_exceptions(task_template->retry_exceptions());
+  task_template->set_retry_exceptions(retry_exceptions);
+  auto depth = spec->depth();
+  spec->set_depth(task_template->depth());
+  task_template->set_depth(depth);
+  spec->mutable_name()->swap(*task_template->mutable_name());
+  spec->mutable_job_id()->swap(*task_template->mutable_job_id());
+  spec->mutable_concurrency_group_name()->swap(
+      *task_template->mutable_concurrency_group_name());
+  spec->mutable_required_resources()->swap(*task_template->mutable_required_resources());
+  spec->mutable_required_placement_resources()->swap(
+      *task_template->mutable_required_placement_resources());
+  SwapMessageField(spec, task_template, &TaskSpec::release_function_descriptor,
+                   &TaskSpec::set_allocated_function_descriptor);
+  SwapMessageField(spec, task_template, &TaskSpec::release_caller_address,
+                   &TaskSpec::set_allocated_caller_address);
+  SwapMessageField(spec, task_template, &TaskSpec::release_runtime_env_info,
+                   &TaskSpec::set_allocated_runtime_env_info);
+  SwapMessageField(spec, task_template, &TaskSpec::release_scheduling_strategy,
+                   &TaskSpec::set_allocated_scheduling_strategy);
+}
+
+/// Append the entries of a map to a key, sorted so that equal maps append the same.
+void AppendSortedEntries(const google::protobuf::Map<std::string, double> &map,
+                         std::string *key) {
+  absl::InlinedVector<const google::protobuf::MapPair<std::string, double> *, 8> entries;
+  for (const auto &entry : map) {
+    entries.push_back(&entry);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const auto *a, const auto *b) { return a->first < b->first; });
+  for (const auto *entry : entries) {
+    absl::StrAppend(key, entry->first.size(), ":", entry->first);
+    key->append(reinterpret_cast<const char *>(&entry->second), sizeof(entry->second));
+  }
+  key->append(";");
+}
+
+/// Serialize a template, so that equal templates have equal keys. The maps are sorted
+/// by hand, since the deterministic serialization of protobuf sorts them much more
+/// slowly, and the rest of the template has no maps.
+void TemplateKey(TaskSpec *task_template, std::string *key) {
+  google::protobuf::Map<std::string, double> required_resources;
+  google::protobuf::Map<std::string, double> required_placement_resources;
+  required_resources.swap(*task_template->mutable_required_resources());
+  required_placement_resources.swap(
+      *task_template->mutable_required_placement_resources());
+  task_template->SerializeToString(key);
+  AppendSortedEntries(required_resources, key);
+  AppendSortedEntries(required_placement_resources, key);
+  required_resources.swap(*task_template->mutable_required_resources());
+  required_placement_resources.swap(
+      *task_template->mutable_required_placement_resources());
+}
+
+/// Generate a random template ID, so that the IDs of the templates of different
+/// encoders don't collide on the worker.
+uint64_t GenerateTemplateId() {
+  thread_local absl::BitGen generator;
+  uint64_t template_id = 0;
+  while (template_id == 0) {
+    template_id = absl::Uniform<uint64_t>(generator);
+  }
+  return template_id;
+}
+
+}  // namespace
+
+TaskSpecTemplateEncoder::TaskSpecTemplateEncoder(size_t max_templates,
+                                                 std::function<int64_t()> get_time_ms)
+    : max_templates_(max_templates), get_time_ms_(std::move(get_time_ms)) {}
+
+TaskSpecTemplateEncoder::EncodedTask TaskSpecTemplateEncoder::Encode(
+    PushTaskRequest *request) {
+  EncodedTask encoded_task;
+  if (max_templates_ == 0) {
+    return encoded_task;
+  }
+  auto *spec = request->mutable_task_spec();
+  // The caller address is a template field, so the sender ID is taken before it's
+  // left out.
+  request->set_task_spec_template_sender_id(spec->caller_address().worker_id());
+  TaskSpec fields;
+  SwapTemplateFields(spec, &fields);
+  // The key is serialized into a buffer that is reused, to save allocating it.
+  thread_local std::string key;
+  TemplateKey(&fields, &key);
+
+  absl::MutexLock lock(&mu_);
+  const int64_t now_ms = get_time_ms_();
+  if (now_ms - last_encode_ms_ >
+      RayConfig::instance().task_spec_template_idle_timeout_ms() / 2) {
+    // The worker may drop the templates soon, if it didn't already.
+    for (auto &entry : templates_) {
+      entry.second.registered = false;
+    }
+    num_resets_++;
+  }
+  last_encode_ms_ = now_ms;
+  const auto template_id = GetOrAddTemplate(key);
+  if (template_id == 0) {
+    // Push the task spec whole.
+    SwapTemplateFields(spec, &fields);
+  } else {
+    auto &task_template = templates_[template_id];
+    task_template.num_tasks_in_flight++;
+    task_template.last_used = ++num_uses_;
+    last_template_id_ = template_id;
+    request->set_task_spec_template_id(template_id);
+    if (!task_template.registered) {
+      request->mutable_task_spec_template()->Swap(&fields);
+    }
+    encoded_task.template_id = template_id;
+  }
+  for (const auto &eviction : evictions_) {
+    request->add_evicted_task_spec_template_ids(eviction.second);
+  }
+  if (template_id == 0 && evictions_.empty()) {
+    request->clear_task_spec_template_sender_id();
+  }
+  encoded_task.num_evictions_sent = num_evictions_;
+  encoded_task.num_resets = num_resets_;
+  return encoded_task;
+}
+
+uint64_t TaskSpecTemplateEncoder::GetOrAddTemplate(const std::string &key) {
+  // The tasks pushed one after another are often of the same function.
+  auto last_it = templates_.find(last_template_id_);
+  if (last_it != templates_.end() && last_it->second.key == key) {
+    return last_template_id_;
+  }
+  auto it = template_ids_.find(key);
+  if (it != template_ids_.end()) {
+    return it->second;
+  }
+  if (templates_.size() >= max_templates_ && !EvictTemplate()) {
+    return 0;
+  }
+  const auto template_id = GenerateTemplateId();
+  template_ids_.emplace(key, template_id);
+  templates_[template_id].key = key;
+  return template_id;
+}
+
+bool TaskSpecTemplateEncoder::EvictTemplate() {
+  auto evicted_it = templates_.end();
+  for (auto it = templates_.begin(); it != templates_.end(); ++it) {
+    if (it->second.num_tasks_in_flight == 0 &&
+        (evicted_it == templates_.end() ||
+         it->second.last_used < evicted_it->second.last_used)) {
+      evicted_it = it;
+    }
+  }
+  if (evicted_it == templates_.end()) {
+    return false;
+  }
+  // The worker may have registered the template even if no task that used it was
+  // replied to successfully, so it's always told to drop it.
+  evictions_.emplace_back(++num_evictions_, evicted_it->first);
+  template_ids_.erase(evicted_it->second.key);
+  if (last_template_id_ == evicted_it->first) {
+    last_template_id_ = 0;
+  }
+  templates_.erase(evicted_it);
+  return true;
+}
+
+void TaskSpecTemplateEncoder::OnTaskReplied(const EncodedTask &encoded_task,
+                                            bool success) {
+  absl::MutexLock lock(&mu_);
+  auto it = templates_.find(encoded_task.template_id);
+  if (it != templates_.end()) {
+    it->second.num_tasks_in_flight--;
+    it->second.registered |= success && encoded_task.num_resets == num_resets_;
+  }
+  while (success && !evictions_.empty() &&
+         evictions_.front().first <= encoded_task.num_evictions_sent) {
+    evictions_.pop_front();
+  }
+}
+
+TaskSpecTemplateDecoder::TaskSpecTemplateDecoder(std::function<int64_t()> get_time_ms)
+    : get_time_ms_(std::move(get_time_ms)) {}
+
+Status TaskSpecTemplateDecoder::Decode(PushTaskRequest *request) {
+  const int64_t now_ms = get_time_ms_();
+  DropIdleSenders(now_ms);
+  const auto template_id = request->task_spec_template_id();
+  if (request->task_spec_template_sender_id().empty()) {
+    if (template_id == 0) {
+      return Status::OK();
+    }
+    return Status::Invalid("The task spec template " + std::to_string(template_id) +
+                           " has no sender.");
+  }
+  auto &sender = senders_[request->task_spec_template_sender_id()];
+  sender.last_request_ms = now_ms;
+  request->clear_task_spec_template_sender_id();
+  for (const auto evicted_template_id : request->evicted_task_spec_template_ids()) {
+    sender.templates.erase(evicted_template_id);
+  }
+  request->clear_evicted_task_spec_template_ids();
+  if (template_id == 0) {
+    return Status::OK();
+  }
+  if (request->has_task_spec_template()) {
+    // Registering a template twice is a no-op, since its ID is only ever used for the
+    // same fields.
+    sender.templates.emplace(template_id,
+                             std::move(*request->mutable_task_spec_template()));
+  }
+  auto it = sender.templates.find(template_id);
+  if (it == sender.templates.end()) {
+    return Status::Invalid("The task spec template " + std::to_string(template_id) +
+                           " is not registered on this worker.");
+  }
+  request->mutable_task_spec()->MergeFrom(it->second);
+  request->clear_task_spec_template_id();
+  request->clear_task_spec_template();
+  return Status::OK();
+}
+
+size_t TaskSpecTemplateDecoder::NumTemplates() const {
+  size_t num_templates = 0;
+  for (const auto &entry : senders_) {
+    num_templates += entry.second.templates.size();
+  }
+  return num_templates;
+}
+
+void TaskSpecTemplateDecoder::DropIdleSenders(int64_t now_ms) {
+  const int64_t timeout_ms = RayConfig::instance().task_spec_template_idle_timeout_ms();
+  if (now_ms - last_idle_check_ms_ < timeout_ms) {
+    return;
+  }
+  last_idle_check_ms_ = now_ms;
+  for (auto it = senders_.begin(); it != senders_.end();) {
+    if (now_ms - it->second.last_request_ms >= timeout_ms) {
+      senders_.erase(it++);
+    } else {
+      it++;
+    }
+  }
+}
+
+}  // namespace rpc
+}  // namespace ray
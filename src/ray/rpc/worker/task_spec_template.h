@@ -0,0 +1,192 @@
+// Copyright 2022 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/status.h"
+#include "ray/util/util.h"
+#include "src/ray/protobuf/core_worker.pb.h"
+
+namespace ray {
+namespace rpc {
+
+/// \class TaskSpecTemplateEncoder
+///
+/// Leaves out the fields of the task specs pushed to one worker that are the same for
+/// many tasks, such as the function descriptor, resources, runtime env and owner
+/// address, and sends them once as a template instead.
+///
+/// A template is sent along with the tasks that use it until one of those tasks is
+/// replied to successfully, since the worker registered the template before handling
+/// the task. After that, the tasks only carry the ID of the template. A worker that is
+/// restarted has a new worker ID and thus a new encoder, so it never sees the ID of a
+/// template it didn't register.
+///
+/// Once there are as many templates as allowed, the least recently used one that no
+/// task in flight uses is evicted to make room for a new one, and its ID is sent along
+/// with the next tasks until one of them is replied to successfully, so that the
+/// worker drops it too. Since no task that uses the template is in flight by then, the
+/// worker has handled all of them before it drops the template.
+///
+/// The worker drops all the templates of a sender that pushes no tasks to it for
+/// `task_spec_template_idle_timeout_ms`, so once no task was pushed for half of that,
+/// the templates are sent along with the next tasks again.
+///
+/// This class is thread safe.
+class TaskSpecTemplateEncoder {
+ public:
+  /// What the request of a task was encoded with, to pass to `OnTaskReplied`.
+  struct EncodedTask {
+    /// The ID of the template of the task spec, or 0 if the task spec is pushed whole.
+    uint64_t template_id = 0;
+    /// The number of template evictions, up to the last one whose ID the request
+    /// carries.
+    uint64_t num_evictions_sent = 0;
+    /// The number of times the templates were sent again after the sender was idle,
+    /// so that replies to the tasks pushed before that don't count as registrations.
+    uint64_t num_resets = 0;
+  };
+
+  /// \param max_templates The max number of templates. The task specs that would need
+  /// another one while all of them are used by tasks in flight are pushed whole. 0
+  /// disables templates.
+  /// \param get_time_ms Returns the current time in milliseconds.
+  explicit TaskSpecTemplateEncoder(
+      size_t max_templates, std::function<int64_t()> get_time_ms = current_time_ms);
+
+  /// Replace the template fields of the task spec of a request with the ID of their
+  /// template, and add the template to the request if the worker may not have
+  /// registered it yet, along with the IDs of the evicted templates.
+  ///
+  /// The template fields are serialized to look up their template, but that takes
+  /// about as long as serializing them as part of the request would have.
+  ///
+  /// \param request The request to encode.
+  /// \return What the request was encoded with, to pass to `OnTaskReplied` once the
+  /// task is replied to.
+  EncodedTask Encode(PushTaskRequest *request) LOCKS_EXCLUDED(mu_);
+
+  /// Handle the reply to a task. If it's successful, the template of the task is no
+  /// longer sent, and neither are the IDs of the evictions the request carried.
+  ///
+  /// \param encoded_task What the request of the task was encoded with.
+  /// \param success Whether the worker handled the task.
+  void OnTaskReplied(const EncodedTask &encoded_task, bool success) LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Template {
+    /// The serialized template fields.
+    std::string key;
+    /// Whether the worker has registered the template.
+    bool registered = false;
+    /// The number of tasks in flight that use the template.
+    uint64_t num_tasks_in_flight = 0;
+    /// When the template was last used, to evict the least recently used one.
+    uint64_t last_used = 0;
+  };
+
+  /// Find the template of some serialized template fields, or add one if there's room.
+  ///
+  /// \return The ID of the template, or 0 if there's no room for another one.
+  uint64_t GetOrAddTemplate(const std::string &key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Evict the least recently used template that no task in flight uses.
+  ///
+  /// \return Whether a template was evicted.
+  bool EvictTemplate() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const size_t max_templates_;
+  const std::function<int64_t()> get_time_ms_;
+
+  absl::Mutex mu_;
+  /// Mapping from template ID to the template.
+  absl::flat_hash_map<uint64_t, Template> templates_ GUARDED_BY(mu_);
+  /// Mapping from the serialized template fields to the ID of their template.
+  absl::flat_hash_map<std::string, uint64_t> template_ids_ GUARDED_BY(mu_);
+  /// The ID of the template that was used last, or 0.
+  uint64_t last_template_id_ GUARDED_BY(mu_) = 0;
+  /// The number of times a template was used.
+  uint64_t num_uses_ GUARDED_BY(mu_) = 0;
+  /// The IDs of the evicted templates that the worker may not have dropped yet, by the
+  /// number of evictions up to them.
+  std::deque<std::pair<uint64_t, uint64_t>> evictions_ GUARDED_BY(mu_);
+  /// The number of templates evicted so far.
+  uint64_t num_evictions_ GUARDED_BY(mu_) = 0;
+  /// When a task was last encoded.
+  int64_t last_encode_ms_ GUARDED_BY(mu_) = 0;
+  /// The number of times the templates were marked as not registered after the sender
+  /// was idle.
+  uint64_t num_resets_ GUARDED_BY(mu_) = 0;
+};
+
+/// \class TaskSpecTemplateDecoder
+///
+/// Registers the task spec templates sent by `TaskSpecTemplateEncoder`, and fills in
+/// the fields that the task specs pushed to this worker left out.
+///
+/// The templates are registered per sender. The templates of a sender that sends no
+/// requests for `task_spec_template_idle_timeout_ms` are dropped, since the worker
+/// isn't told when a sender dies.
+///
+/// This class is not thread safe.
+class TaskSpecTemplateDecoder {
+ public:
+  /// \param get_time_ms Returns the current time in milliseconds.
+  explicit TaskSpecTemplateDecoder(
+      std::function<int64_t()> get_time_ms = current_time_ms);
+
+  /// Drop the templates that a request says were evicted, register the template of the
+  /// request if it carries it, and fill in the fields of its task spec from the
+  /// template. The request is decoded in place, so that its args aren't copied.
+  ///
+  /// \param request The request to decode.
+  /// \return Status::Invalid if the template of the request is not registered.
+  Status Decode(PushTaskRequest *request);
+
+  /// The number of registered templates, of all senders.
+  size_t NumTemplates() const;
+
+  /// The number of senders with registered templates.
+  size_t NumSenders() const { return senders_.size(); }
+
+ private:
+  struct Sender {
+    /// Mapping from template ID to the template fields of the task spec.
+    absl::flat_hash_map<uint64_t, TaskSpec> templates;
+    /// When the sender last sent a request.
+    int64_t last_request_ms = 0;
+  };
+
+  /// Drop the templates of the senders that sent no request for
+  /// `task_spec_template_idle_timeout_ms`. Done at most once per timeout.
+  void DropIdleSenders(int64_t now_ms);
+
+  const std::function<int64_t()> get_time_ms_;
+  /// Mapping from the worker ID of a sender to its templates.
+  absl::flat_hash_map<std::string, Sender> senders_;
+  /// When idle senders were last dropped.
+  int64_t last_idle_check_ms_ = 0;
+};
+
+}  // namespace rpc
+}  // namespace ray
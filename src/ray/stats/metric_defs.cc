@@ -128,10 +128,23 @@ DEFINE_stats(gcs_placement_group_creation_latency_ms,
 DEFINE_stats(gcs_placement_group_scheduling_latency_ms,
              "scheduling latency of placement groups", (),
              ({0.1, 1, 10, 100, 1000, 10000}, ), ray::stats::HISTOGRAM);
+// The time from the prepare requests of a placement group are sent <-> all bundles
+// are prepared, including the bundles prepared again, from the commit requests are
+// sent <-> all of them have returned, and from the creation request is received <->
+// all bundles are committed.
+DEFINE_stats(gcs_placement_group_two_phase_commit_latency_ms,
+             "latency of the {Prepare, Commit, CreationToCommit} phases of placement "
+             "group creation",
+             ("Phase"), ({0.1, 1, 10, 100, 1000, 10000}, ), ray::stats::HISTOGRAM);
 DEFINE_stats(gcs_placement_group_count,
              "Number of placement groups broken down by state in {Registered, Pending, "
              "Infeasible}",
              ("State"), (), ray::stats::GAUGE);
+// How scattered the free resources of the cluster are after placing a placement group
+// with the bin-packing engine, from 0 (all on one node) to 1.
+DEFINE_stats(gcs_placement_group_resource_fragmentation,
+             "Fragmentation of the free resources requested by placement groups", (),
+             (), ray::stats::GAUGE);
 
 /// GCS Actor Manager
 DEFINE_stats(gcs_actors_count,
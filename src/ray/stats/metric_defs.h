@@ -87,7 +87,9 @@ DECLARE_stats(gcs_new_resource_creation_latency_ms);
 /// Placement Group
 DECLARE_stats(gcs_placement_group_creation_latency_ms);
 DECLARE_stats(gcs_placement_group_scheduling_latency_ms);
+DECLARE_stats(gcs_placement_group_two_phase_commit_latency_ms);
 DECLARE_stats(gcs_placement_group_count);
+DECLARE_stats(gcs_placement_group_resource_fragmentation);
 
 DECLARE_stats(gcs_actors_count);
 
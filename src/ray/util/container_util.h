@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include <sstream>
@@ -22,6 +23,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "ray/util/logging.h"
 
 namespace ray {
@@ -96,4 +98,67 @@ typename C::mapped_type &map_find_or_die(C &c, const typename C::key_type &k) {
       map_find_or_die(const_cast<const C &>(c), k));
 }
 
+/// A set that keeps up to N elements inline and searches them linearly. It is meant for
+/// the sets that most entries of a large table have, which hold 0 to a few elements,
+/// and where an empty or single-element hash set would cost more memory than the
+/// elements themselves.
+template <typename T, size_t N>
+class InlinedSet {
+ public:
+  using const_iterator = typename absl::InlinedVector<T, N>::const_iterator;
+
+  InlinedSet() = default;
+
+  template <typename InputIterator>
+  InlinedSet(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  const_iterator begin() const { return elements_.begin(); }
+  const_iterator end() const { return elements_.end(); }
+  size_t size() const { return elements_.size(); }
+  bool empty() const { return elements_.empty(); }
+
+  const_iterator find(const T &value) const {
+    return std::find(elements_.begin(), elements_.end(), value);
+  }
+
+  bool contains(const T &value) const { return find(value) != end(); }
+  size_t count(const T &value) const { return contains(value) ? 1 : 0; }
+
+  std::pair<const_iterator, bool> insert(const T &value) {
+    auto it = find(value);
+    if (it != end()) {
+      return {it, false};
+    }
+    elements_.push_back(value);
+    return {elements_.end() - 1, true};
+  }
+
+  std::pair<const_iterator, bool> emplace(const T &value) { return insert(value); }
+
+  size_t erase(const T &value) {
+    auto it = std::find(elements_.begin(), elements_.end(), value);
+    if (it == elements_.end()) {
+      return 0;
+    }
+    // The order of the elements doesn't matter, so fill the hole with the last one.
+    *it = std::move(elements_.back());
+    elements_.pop_back();
+    return 1;
+  }
+
+  void clear() { elements_.clear(); }
+
+ private:
+  absl::InlinedVector<T, N> elements_;
+};
+
+template <typename T, size_t N>
+std::string debug_string(const InlinedSet<T, N> &c) {
+  return _container_debug_string(c);
+}
+
 }  // namespace ray
@@ -36,6 +36,28 @@ TEST(ContainerUtilTest, TestMapFindOrDie) {
   }
 }
 
+TEST(ContainerUtilTest, TestInlinedSet) {
+  InlinedSet<int, 2> set;
+  ASSERT_TRUE(set.empty());
+  ASSERT_TRUE(set.insert(1).second);
+  ASSERT_FALSE(set.insert(1).second);
+  ASSERT_TRUE(set.emplace(2).second);
+  // Elements past the inline capacity are kept too.
+  ASSERT_TRUE(set.insert(3).second);
+  ASSERT_EQ(set.size(), 3);
+  ASSERT_TRUE(set.contains(3));
+  ASSERT_EQ(set.count(4), 0);
+
+  ASSERT_EQ(set.erase(1), 1);
+  ASSERT_EQ(set.erase(1), 0);
+  ASSERT_EQ(absl::flat_hash_set<int>(set.begin(), set.end()),
+            (absl::flat_hash_set<int>{2, 3}));
+  std::vector<int> elements{5, 5};
+  ASSERT_EQ(debug_string(InlinedSet<int, 2>(elements.begin(), elements.end())), "[5]");
+  set.clear();
+  ASSERT_TRUE(set.empty());
+}
+
 }  // namespace ray
 
 int main(int argc, char **argv) {